@@ -11,6 +11,7 @@
 #define HAL_DISPLAY_H
 
 #include "hal.h"
+#include "hal_font.h"
 
 /* Display configuration from tweakngeek_config.h */
 #define DISPLAY_WIDTH       HAL_DISPLAY_WIDTH
@@ -22,9 +23,9 @@
  */
 typedef enum {
     HAL_DISPLAY_FORMAT_MONO = 0,    /**< Monochrome 1-bit per pixel */
-    HAL_DISPLAY_FORMAT_GRAY2,       /**< 2-bit grayscale */
-    HAL_DISPLAY_FORMAT_GRAY4,       /**< 4-bit grayscale */
-    HAL_DISPLAY_FORMAT_RGB565,      /**< 16-bit RGB565 */
+    HAL_DISPLAY_FORMAT_GRAY2,       /**< 2-bit grayscale (temporal bitplanes) */
+    HAL_DISPLAY_FORMAT_GRAY4,       /**< 4-bit grayscale (temporal bitplanes) */
+    HAL_DISPLAY_FORMAT_RGB565,      /**< 16-bit RGB565 (not supported by the panel) */
     HAL_DISPLAY_FORMAT_MAX
 } hal_display_format_t;
 
@@ -50,6 +51,16 @@ typedef enum {
     HAL_DISPLAY_BACKLIGHT_MAX
 } hal_display_backlight_t;
 
+/**
+ * @brief Frame buffering modes
+ */
+typedef enum {
+    HAL_DISPLAY_BUFFERING_SINGLE = 0,   /**< Draw into the buffer being transmitted */
+    HAL_DISPLAY_BUFFERING_COPY,         /**< Back buffer is copied to the front buffer on update */
+    HAL_DISPLAY_BUFFERING_SWAP,         /**< Back and front buffers are swapped on update */
+    HAL_DISPLAY_BUFFERING_MAX
+} hal_display_buffering_t;
+
 /**
  * @brief Input button types
  */
@@ -98,12 +109,34 @@ typedef enum {
  * @brief Font sizes
  */
 typedef enum {
-    HAL_FONT_SIZE_SMALL = 0,        /**< Small font (6x8) */
-    HAL_FONT_SIZE_MEDIUM,           /**< Medium font (8x12) */
-    HAL_FONT_SIZE_LARGE,            /**< Large font (12x16) */
+    HAL_FONT_SIZE_SMALL = 0,        /**< Small font (fixed 6x8 cell) */
+    HAL_FONT_SIZE_MEDIUM,           /**< Medium font (proportional, 8 px, kerned) */
+    HAL_FONT_SIZE_LARGE,            /**< Large font (fixed 12x16 cell) */
     HAL_FONT_SIZE_MAX
 } hal_font_size_t;
 
+/**
+ * @brief Bitmap source formats
+ */
+typedef enum {
+    HAL_BITMAP_FORMAT_PAGE_MAJOR = 0,   /**< Native: bytes are 8 vertical pixels, LSB at top, one page row after another */
+    HAL_BITMAP_FORMAT_ROW_MAJOR,        /**< Bytes are 8 horizontal pixels, LSB first, rows padded to whole bytes (XBM) */
+    HAL_BITMAP_FORMAT_RLE,              /**< Page-major data, run-length encoded */
+    HAL_BITMAP_FORMAT_MAX
+} hal_bitmap_format_t;
+
+/**
+ * @brief Bitmap blit modes
+ */
+typedef enum {
+    HAL_BLIT_MODE_TRANSPARENT = 0,      /**< Set pixels where the bitmap is set, keep the background */
+    HAL_BLIT_MODE_OPAQUE,               /**< Copy set and clear pixels over the whole bitmap area */
+    HAL_BLIT_MODE_INVERT,               /**< Invert pixels where the bitmap is set */
+    HAL_BLIT_MODE_ERASE,                /**< Clear pixels where the bitmap is set */
+    HAL_BLIT_MODE_MASK,                 /**< Copy bitmap pixels where the mask is set */
+    HAL_BLIT_MODE_MAX
+} hal_blit_mode_t;
+
 /**
  * @brief Display configuration structure
  */
@@ -117,6 +150,44 @@ typedef struct {
     bool invert;                        /**< Invert display colors */
 } hal_display_config_t;
 
+/**
+ * @brief Bitmap descriptor
+ *
+ * RLE streams are a sequence of control bytes: 0x00-0x7F is followed by
+ * (ctrl + 1) literal bytes, 0x80-0xFF by one byte repeated (ctrl - 0x80 + 2)
+ * times. The decoded bytes are page-major with stride equal to the width.
+ */
+typedef struct {
+    const uint8_t *data;                /**< Pixel data */
+    const uint8_t *mask;                /**< Mask in the same format as data (MASK mode only) */
+    uint32_t data_size;                 /**< Size of data in bytes (RLE only) */
+    uint32_t mask_size;                 /**< Size of mask in bytes (RLE only) */
+    uint16_t width;                     /**< Width in pixels */
+    uint16_t height;                    /**< Height in pixels */
+    uint16_t stride;                    /**< Bytes per page row or pixel row, 0 for tightly packed */
+    hal_bitmap_format_t format;         /**< Data and mask format */
+} hal_bitmap_t;
+
+/**
+ * @brief Dithering methods for grayscale images
+ */
+typedef enum {
+    HAL_DITHER_NONE = 0,                /**< Round to the nearest level */
+    HAL_DITHER_ORDERED,                 /**< 8x8 Bayer matrix, anchored at the image origin */
+    HAL_DITHER_FLOYD_STEINBERG,         /**< Error diffusion, left to right */
+    HAL_DITHER_MAX
+} hal_dither_t;
+
+/**
+ * @brief 8-bit grayscale image (0 = black, 255 = white)
+ */
+typedef struct {
+    const uint8_t *pixels;              /**< Row-major luminance, one byte per pixel */
+    uint16_t width;                     /**< Width in pixels */
+    uint16_t height;                    /**< Height in pixels */
+    uint16_t stride;                    /**< Bytes per row, 0 for width */
+} hal_gray_image_t;
+
 /**
  * @brief Point structure
  */
@@ -135,6 +206,25 @@ typedef struct {
     uint16_t height;                    /**< Height */
 } hal_rect_t;
 
+/**
+ * @brief Offscreen drawing surface
+ *
+ * Canvases use the frame buffer layout: byte (y / 8) * stride + x holds
+ * eight vertical pixels of column x, LSB at top. The buffer must hold
+ * stride * ((height + 7) / 8) bytes. Primitives drawing into a canvas are
+ * clipped to its clip rectangle and ignore the display's gray level.
+ */
+typedef struct {
+    uint8_t *buffer;                    /**< Pixel data */
+    uint16_t width;                     /**< Width in pixels, at most the panel width */
+    uint16_t height;                    /**< Height in pixels */
+    uint16_t stride;                    /**< Bytes per page row */
+    hal_rect_t clip;                    /**< Drawing is limited to this rectangle */
+} hal_canvas_t;
+
+/* Canvas argument that selects the screen */
+#define HAL_CANVAS_SCREEN               NULL
+
 /**
  * @brief Input event structure
  */
@@ -153,6 +243,13 @@ typedef struct {
  */
 typedef void (*hal_input_event_callback_t)(const hal_input_event_data_t *event, void *user_data);
 
+/**
+ * @brief Frame transfer completion callback (called from interrupt context)
+ * @param frame Number of frames completed since initialization
+ * @param user_data User-provided data pointer
+ */
+typedef void (*hal_display_vsync_callback_t)(uint32_t frame, void *user_data);
+
 /**
  * @brief Initialize Display HAL
  * @return HAL_OK on success, error code otherwise
@@ -191,6 +288,93 @@ hal_result_t hal_display_clear(void);
  */
 hal_result_t hal_display_update(void);
 
+/**
+ * @brief Start transmitting the current frame without waiting for it
+ *
+ * In COPY mode the back buffer is copied to the front buffer, in SWAP mode
+ * the buffers are exchanged; drawing can continue in the (new) back buffer
+ * while the front buffer streams out. In SWAP mode the new back buffer
+ * holds an older frame and must be redrawn completely.
+ *
+ * @return HAL_OK on success, HAL_ERROR_RESOURCE_BUSY if the previous frame
+ *         is still being transmitted
+ */
+hal_result_t hal_display_update_async(void);
+
+/**
+ * @brief Update only the part of the display covered by a rectangle
+ *
+ * Transfers the pages and columns the rectangle touches and waits for
+ * completion.
+ *
+ * @param rect Damaged area in display coordinates
+ * @return HAL_OK on success, error code otherwise
+ */
+hal_result_t hal_display_update_rect(const hal_rect_t *rect);
+
+/**
+ * @brief Start a partial update without waiting for it
+ *
+ * In double-buffered modes the area is copied into the front buffer
+ * (SWAP mode does not swap for partial updates).
+ *
+ * @param rect Damaged area in display coordinates
+ * @return HAL_OK on success, HAL_ERROR_RESOURCE_BUSY if a transfer is in progress
+ */
+hal_result_t hal_display_update_rect_async(const hal_rect_t *rect);
+
+/**
+ * @brief Wait until the frame in flight has been transmitted
+ * @param timeout_ms Maximum time to wait
+ * @return HAL_OK on success, HAL_ERROR_TIMEOUT on timeout
+ */
+hal_result_t hal_display_wait_idle(uint32_t timeout_ms);
+
+/**
+ * @brief Check whether a frame transfer is in progress
+ * @return true while the panel is being written
+ */
+bool hal_display_is_busy(void);
+
+/**
+ * @brief Select single or double buffering
+ * @param mode Buffering mode
+ * @return HAL_OK on success, HAL_ERROR_NOT_SUPPORTED if double buffering
+ *         is disabled, HAL_ERROR_RESOURCE_BUSY during a transfer
+ */
+hal_result_t hal_display_set_buffering(hal_display_buffering_t mode);
+
+/**
+ * @brief Register frame completion callback
+ * @param callback Callback function, NULL to remove
+ * @param user_data User data to pass to callback
+ * @return HAL_OK on success, error code otherwise
+ */
+hal_result_t hal_display_register_vsync_callback(hal_display_vsync_callback_t callback, void *user_data);
+
+/**
+ * @brief Advance the grayscale refresh by one subframe
+ *
+ * In GRAY2/GRAY4 formats the panel shows the bitplanes in turn, plane n
+ * for 2^n of every (2^bits - 1) subframes, each sent by DMA straight from
+ * its plane. Call from a periodic timer at the subframe rate (about 180 Hz
+ * for GRAY2, 900 Hz for GRAY4); a tick that finds the previous subframe
+ * still in flight is skipped. Does nothing in MONO format.
+ */
+void hal_display_gray_tick(void);
+
+/**
+ * @brief Select the gray level drawn by the graphics primitives
+ *
+ * In grayscale formats SET mode paints this level, CLEAR paints level 0
+ * and INVERT maps level n to (levels - 1 - n). Entering a grayscale
+ * format selects the darkest level.
+ *
+ * @param level Gray level, 0 (white) to 2^bits - 1 (black)
+ * @return HAL_OK on success, HAL_ERROR_NOT_SUPPORTED in MONO format
+ */
+hal_result_t hal_graphics_set_gray_level(uint8_t level);
+
 /**
  * @brief Set display backlight level
  * @param level Backlight level
@@ -212,8 +396,23 @@ hal_result_t hal_display_set_contrast(uint8_t contrast);
  */
 hal_result_t hal_display_set_invert(bool invert);
 
+/**
+ * @brief Set display rotation
+ *
+ * 90 and 270 degrees switch the drawing area to 64x128; switching between
+ * landscape and portrait clears the frame buffers.
+ *
+ * @param rotation Display rotation
+ * @return HAL_OK on success, HAL_ERROR_RESOURCE_BUSY during a transfer
+ */
+hal_result_t hal_display_set_rotation(hal_display_rotation_t rotation);
+
 /**
  * @brief Get display buffer pointer
+ *
+ * Returns the buffer primitives currently draw into; in SWAP mode this
+ * changes on every update.
+ *
  * @param buffer Pointer to store buffer address
  * @param size Pointer to store buffer size
  * @return HAL_OK on success, error code otherwise
@@ -222,6 +421,17 @@ hal_result_t hal_display_get_buffer(uint8_t **buffer, uint32_t *size);
 
 /* Graphics Primitives */
 
+/**
+ * @brief Restrict drawing to a rectangle
+ *
+ * All primitives, text and bitmaps are clipped to the rectangle (and the
+ * screen). Changing rotation resets the clip.
+ *
+ * @param rect Clip rectangle, NULL for the whole screen
+ * @return HAL_OK on success, error code otherwise
+ */
+hal_result_t hal_graphics_set_clip(const hal_rect_t *rect);
+
 /**
  * @brief Set pixel in display buffer
  * @param x X coordinate
@@ -276,6 +486,62 @@ hal_result_t hal_graphics_draw_circle(const hal_point_t *center, uint16_t radius
  */
 hal_result_t hal_graphics_fill_circle(const hal_point_t *center, uint16_t radius, hal_graphics_mode_t mode);
 
+/**
+ * @brief Draw rounded rectangle outline in display buffer
+ * @param rect Rectangle coordinates and size
+ * @param radius Corner radius (clamped to fit the rectangle)
+ * @param mode Drawing mode
+ * @return HAL_OK on success, error code otherwise
+ */
+hal_result_t hal_graphics_draw_round_rect(const hal_rect_t *rect, uint16_t radius, hal_graphics_mode_t mode);
+
+/**
+ * @brief Fill rounded rectangle in display buffer
+ * @param rect Rectangle coordinates and size
+ * @param radius Corner radius (clamped to fit the rectangle)
+ * @param mode Drawing mode
+ * @return HAL_OK on success, error code otherwise
+ */
+hal_result_t hal_graphics_fill_round_rect(const hal_rect_t *rect, uint16_t radius, hal_graphics_mode_t mode);
+
+/**
+ * @brief Draw ellipse outline in display buffer
+ * @param center Ellipse center point
+ * @param radius_x Horizontal radius
+ * @param radius_y Vertical radius
+ * @param mode Drawing mode
+ * @return HAL_OK on success, error code otherwise
+ */
+hal_result_t hal_graphics_draw_ellipse(const hal_point_t *center, uint16_t radius_x, uint16_t radius_y,
+                                       hal_graphics_mode_t mode);
+
+/**
+ * @brief Fill ellipse in display buffer
+ * @param center Ellipse center point
+ * @param radius_x Horizontal radius
+ * @param radius_y Vertical radius
+ * @param mode Drawing mode
+ * @return HAL_OK on success, error code otherwise
+ */
+hal_result_t hal_graphics_fill_ellipse(const hal_point_t *center, uint16_t radius_x, uint16_t radius_y,
+                                       hal_graphics_mode_t mode);
+
+/**
+ * @brief Draw circular arc in display buffer
+ *
+ * Angles are in degrees with 0 at 3 o'clock, increasing clockwise on screen.
+ * A sweep of 360 or more draws the full circle.
+ *
+ * @param center Arc center point
+ * @param radius Arc radius
+ * @param start_angle Start angle in degrees
+ * @param sweep_angle Clockwise sweep in degrees
+ * @param mode Drawing mode
+ * @return HAL_OK on success, error code otherwise
+ */
+hal_result_t hal_graphics_draw_arc(const hal_point_t *center, uint16_t radius, int16_t start_angle,
+                                   uint16_t sweep_angle, hal_graphics_mode_t mode);
+
 /**
  * @brief Draw text in display buffer
  * @param text Text string to draw
@@ -287,8 +553,23 @@ hal_result_t hal_graphics_fill_circle(const hal_point_t *center, uint16_t radius
 hal_result_t hal_graphics_draw_text(const char *text, const hal_point_t *position, 
                                     hal_font_size_t font_size, hal_graphics_mode_t mode);
 
+/**
+ * @brief Draw text in display buffer using an explicit font
+ * @param text Text string to draw ('\n' starts a new line)
+ * @param position Top-left corner of the first glyph
+ * @param font Font descriptor
+ * @param mode Drawing mode
+ * @return HAL_OK on success, error code otherwise
+ */
+hal_result_t hal_graphics_draw_text_font(const char *text, const hal_point_t *position,
+                                         const hal_font_t *font, hal_graphics_mode_t mode);
+
 /**
  * @brief Draw bitmap in display buffer
+ *
+ * The bitmap is a continuous row-major bit stream (pixel n at bit n % 8 of
+ * byte n / 8, rows not padded). Only set bits are drawn.
+ *
  * @param bitmap Bitmap data
  * @param position Bitmap position
  * @param width Bitmap width
@@ -299,6 +580,122 @@ hal_result_t hal_graphics_draw_text(const char *text, const hal_point_t *positio
 hal_result_t hal_graphics_draw_bitmap(const uint8_t *bitmap, const hal_point_t *position,
                                       uint16_t width, uint16_t height, hal_graphics_mode_t mode);
 
+/**
+ * @brief Blit a bitmap into the display buffer
+ *
+ * The bitmap is clipped to the screen once and may be placed at any
+ * position, including partly off screen.
+ *
+ * @param bitmap Bitmap descriptor
+ * @param position Top-left corner of the bitmap
+ * @param mode Blit mode
+ * @return HAL_OK on success, error code otherwise
+ */
+hal_result_t hal_graphics_blit(const hal_bitmap_t *bitmap, const hal_point_t *position, hal_blit_mode_t mode);
+
+/**
+ * @brief Draw a grayscale image, quantized to the current display format
+ *
+ * In MONO format pixels are dithered to black and white, in grayscale
+ * formats to the available gray levels. The image is drawn opaque and
+ * clipped like the other primitives. Integer arithmetic only.
+ *
+ * @param image Image descriptor
+ * @param position Top-left corner of the image
+ * @param dither Dithering method
+ * @return HAL_OK on success, error code otherwise
+ */
+hal_result_t hal_graphics_draw_gray(const hal_gray_image_t *image, const hal_point_t *position,
+                                    hal_dither_t dither);
+
+/* Canvas Functions */
+
+/*
+ * Every hal_canvas_* primitive behaves like its hal_graphics_* counterpart
+ * but draws into the given canvas; HAL_CANVAS_SCREEN draws into the
+ * display buffer. They require the display to be initialized.
+ */
+
+/**
+ * @brief Set up a canvas over caller memory
+ *
+ * The clip is reset to the whole canvas; the buffer is not cleared.
+ *
+ * @param canvas Canvas to initialize
+ * @param buffer Pixel buffer of at least stride * ((height + 7) / 8) bytes
+ * @param width Width in pixels (1 to the panel width)
+ * @param height Height in pixels
+ * @param stride Bytes per page row, 0 for width
+ * @return HAL_OK on success, error code otherwise
+ */
+hal_result_t hal_canvas_init(hal_canvas_t *canvas, uint8_t *buffer, uint16_t width, uint16_t height,
+                             uint16_t stride);
+
+/**
+ * @brief Clear a whole canvas, regardless of its clip
+ * @param canvas Canvas, or HAL_CANVAS_SCREEN for hal_display_clear()
+ * @return HAL_OK on success, error code otherwise
+ */
+hal_result_t hal_canvas_clear(hal_canvas_t *canvas);
+
+/**
+ * @brief Restrict drawing into a canvas to a rectangle
+ * @param canvas Canvas or HAL_CANVAS_SCREEN
+ * @param rect Clip rectangle, NULL for the whole canvas
+ * @return HAL_OK on success, error code otherwise
+ */
+hal_result_t hal_canvas_set_clip(hal_canvas_t *canvas, const hal_rect_t *rect);
+
+hal_result_t hal_canvas_set_pixel(hal_canvas_t *canvas, int16_t x, int16_t y, hal_graphics_mode_t mode);
+hal_result_t hal_canvas_draw_line(hal_canvas_t *canvas, int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                                  hal_graphics_mode_t mode);
+hal_result_t hal_canvas_draw_rect(hal_canvas_t *canvas, const hal_rect_t *rect, hal_graphics_mode_t mode);
+hal_result_t hal_canvas_fill_rect(hal_canvas_t *canvas, const hal_rect_t *rect, hal_graphics_mode_t mode);
+hal_result_t hal_canvas_draw_circle(hal_canvas_t *canvas, const hal_point_t *center, uint16_t radius,
+                                    hal_graphics_mode_t mode);
+hal_result_t hal_canvas_fill_circle(hal_canvas_t *canvas, const hal_point_t *center, uint16_t radius,
+                                    hal_graphics_mode_t mode);
+hal_result_t hal_canvas_draw_round_rect(hal_canvas_t *canvas, const hal_rect_t *rect, uint16_t radius,
+                                        hal_graphics_mode_t mode);
+hal_result_t hal_canvas_fill_round_rect(hal_canvas_t *canvas, const hal_rect_t *rect, uint16_t radius,
+                                        hal_graphics_mode_t mode);
+hal_result_t hal_canvas_draw_ellipse(hal_canvas_t *canvas, const hal_point_t *center, uint16_t radius_x,
+                                     uint16_t radius_y, hal_graphics_mode_t mode);
+hal_result_t hal_canvas_fill_ellipse(hal_canvas_t *canvas, const hal_point_t *center, uint16_t radius_x,
+                                     uint16_t radius_y, hal_graphics_mode_t mode);
+hal_result_t hal_canvas_draw_arc(hal_canvas_t *canvas, const hal_point_t *center, uint16_t radius,
+                                 int16_t start_angle, uint16_t sweep_angle, hal_graphics_mode_t mode);
+hal_result_t hal_canvas_draw_text(hal_canvas_t *canvas, const char *text, const hal_point_t *position,
+                                  hal_font_size_t font_size, hal_graphics_mode_t mode);
+hal_result_t hal_canvas_draw_text_font(hal_canvas_t *canvas, const char *text, const hal_point_t *position,
+                                       const hal_font_t *font, hal_graphics_mode_t mode);
+hal_result_t hal_canvas_draw_bitmap(hal_canvas_t *canvas, const uint8_t *bitmap, const hal_point_t *position,
+                                    uint16_t width, uint16_t height, hal_graphics_mode_t mode);
+hal_result_t hal_canvas_blit(hal_canvas_t *canvas, const hal_bitmap_t *bitmap, const hal_point_t *position,
+                             hal_blit_mode_t mode);
+hal_result_t hal_canvas_draw_gray(hal_canvas_t *canvas, const hal_gray_image_t *image,
+                                  const hal_point_t *position, hal_dither_t dither);
+
+/**
+ * @brief Composite part of a canvas into another canvas or the screen
+ *
+ * Works like hal_graphics_blit() with the source canvas as a page-major
+ * bitmap, so cached widgets, text and icons can be drawn in one pass with
+ * any blit mode. In MASK mode, pixels are copied where the mask canvas
+ * (same size as the source, same coordinates) is set. The source area may
+ * start on any row. Source and destination must not share memory.
+ *
+ * @param dst Destination canvas or HAL_CANVAS_SCREEN
+ * @param src Source canvas
+ * @param src_rect Area of the source to copy, NULL for all of it
+ * @param mask Mask canvas (MASK mode only)
+ * @param position Destination of the area's top-left corner
+ * @param mode Blit mode
+ * @return HAL_OK on success, error code otherwise
+ */
+hal_result_t hal_canvas_composite(hal_canvas_t *dst, const hal_canvas_t *src, const hal_rect_t *src_rect,
+                                  const hal_canvas_t *mask, const hal_point_t *position, hal_blit_mode_t mode);
+
 /* Input Functions */
 
 /**
@@ -372,6 +769,21 @@ uint8_t hal_graphics_get_char_height(hal_font_size_t font_size);
  */
 uint16_t hal_graphics_get_text_width(const char *text, hal_font_size_t font_size);
 
+/**
+ * @brief Calculate text width for an explicit font
+ * @param text Text string
+ * @param font Font descriptor
+ * @return Width of the widest line in pixels
+ */
+uint16_t hal_graphics_get_text_width_font(const char *text, const hal_font_t *font);
+
+/**
+ * @brief Get the font descriptor behind a font size
+ * @param font_size Font size
+ * @return Font descriptor, NULL if font_size is invalid
+ */
+const hal_font_t *hal_graphics_get_font(hal_font_size_t font_size);
+
 /**
  * @brief Get button name string
  * @param button Button type
@@ -0,0 +1,59 @@
+/**
+ * @file hal_font.h
+ * @brief Bitmap Font Definitions
+ *
+ * This file defines the packed glyph atlas format used by the display HAL
+ * text renderer. Atlases are column-major with the same page layout as the
+ * display buffer: each glyph is stored as (height + 7) / 8 rows of one byte
+ * per column, least significant bit at the top. Font data is generated from
+ * BDF sources by scripts/bdf2font.py.
+ */
+
+#ifndef HAL_FONT_H
+#define HAL_FONT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Font flags */
+#define HAL_FONT_FLAG_PROPORTIONAL  (1 << 0)    /**< Glyph advances differ per character */
+
+/**
+ * @brief Glyph descriptor
+ */
+typedef struct {
+    uint16_t offset;                    /**< Offset of the glyph columns in the atlas */
+    uint8_t width;                      /**< Glyph width in columns */
+    uint8_t advance;                    /**< Horizontal advance in pixels */
+} hal_font_glyph_t;
+
+/**
+ * @brief Kerning pair
+ */
+typedef struct {
+    uint16_t pair;                      /**< (left << 8) | right character codes */
+    int8_t adjust;                      /**< Advance adjustment in pixels */
+} hal_font_kern_t;
+
+/**
+ * @brief Font descriptor
+ */
+typedef struct {
+    uint8_t height;                     /**< Glyph height in pixels */
+    uint8_t cell_width;                 /**< Nominal (maximum) character advance */
+    uint8_t first_char;                 /**< First encoded character */
+    uint8_t last_char;                  /**< Last encoded character */
+    uint8_t default_char;               /**< Substitute for characters outside the range */
+    uint8_t flags;                      /**< HAL_FONT_FLAG_* */
+    uint16_t kerning_count;             /**< Number of kerning pairs */
+    const hal_font_glyph_t *glyphs;     /**< Glyph descriptors, first_char..last_char */
+    const uint8_t *bitmap;              /**< Column-major glyph atlas */
+    const hal_font_kern_t *kerning;     /**< Kerning pairs sorted by pair */
+} hal_font_t;
+
+/* Built-in fonts (generated into hal_font_data.c) */
+extern const hal_font_t hal_font_small;     /**< Fixed 5x7 glyphs in a 6x8 cell */
+extern const hal_font_t hal_font_medium;    /**< Proportional 8 px font with kerning */
+extern const hal_font_t hal_font_large;     /**< Fixed 10x14 glyphs in a 12x16 cell */
+
+#endif /* HAL_FONT_H */
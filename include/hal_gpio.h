@@ -188,11 +188,17 @@ hal_result_t hal_gpio_get_pins(uint64_t pin_mask, uint64_t *state_mask);
 
 /**
  * @brief Enable GPIO pin interrupt
+ *
+ * Pins with the same number on different ports share one EXTI line, so
+ * only one of them can have an interrupt at a time. The callback runs in
+ * interrupt context.
+ *
  * @param pin Pin number (0-63)
- * @param trigger Interrupt trigger type
+ * @param trigger Interrupt trigger type; edges only
  * @param callback Callback function to call on interrupt
  * @param user_data User data to pass to callback
- * @return HAL_OK on success, error code otherwise
+ * @return HAL_OK on success, HAL_ERROR_NOT_SUPPORTED for level triggers,
+ *         HAL_ERROR_RESOURCE_BUSY if another port's pin holds the line
  */
 hal_result_t hal_gpio_enable_interrupt(uint32_t pin, hal_gpio_trigger_t trigger,
                                        hal_gpio_interrupt_callback_t callback, void *user_data);
@@ -0,0 +1,188 @@
+/**
+ * @file hal_ipcc.h
+ * @brief Mailbox transport to the wireless coprocessor (CPU2)
+ *
+ * The BLE stack runs on the Cortex-M0+ core. HCI packets travel between
+ * the cores through ST's transport layer mailbox in shared SRAM: a
+ * reference table at the start of SRAM2A points CPU2 at the device info
+ * table and at the BLE, system and memory manager tables, which hold the
+ * command buffers and the event queues. The IPCC channel flags say which
+ * core owns a buffer or queue at any time.
+ *
+ * Nothing is copied on either side: a sender fills the command or ACL
+ * buffer in place, a receiver reads the event buffer CPU2 filled and
+ * hands it back when done.
+ *
+ * Doorbells are coalesced both ways. An incoming doorbell masks its
+ * channel until hal_ipcc_process() has drained the queue, so a burst of
+ * events costs one interrupt and one batch, and released buffers go back
+ * to CPU2 in one batch per memory manager doorbell.
+ */
+
+#ifndef HAL_IPCC_H
+#define HAL_IPCC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "hal.h"
+
+/* Transport limits */
+#define HAL_IPCC_BUFFER_PAYLOAD     260         /**< HCI packet bytes per buffer, indicator excluded */
+
+/**
+ * @brief HCI packet indicators
+ */
+typedef enum {
+    HAL_IPCC_PACKET_COMMAND = 0x01,     /**< HCI command (to CPU2) */
+    HAL_IPCC_PACKET_ACL = 0x02,         /**< HCI ACL data (both ways) */
+    HAL_IPCC_PACKET_EVENT = 0x04        /**< HCI event (from CPU2) */
+} hal_ipcc_packet_type_t;
+
+/**
+ * @brief Queue link at the start of every mailbox packet (ST's tListNode)
+ */
+typedef struct hal_ipcc_node {
+    struct hal_ipcc_node *next;
+    struct hal_ipcc_node *prev;
+} hal_ipcc_node_t;
+
+/**
+ * @brief Mailbox packet, in shared SRAM (ST's TL_CmdPacket_t/TL_EvtPacket_t)
+ *
+ * Byte fields follow the link, so the layout matches ST's packed one
+ * without packing. The HCI header in data gives the packet length; see
+ * hal_ipcc_length().
+ */
+typedef struct {
+    hal_ipcc_node_t header;             /**< Queue link, used by whichever core holds the packet */
+    uint8_t type;                       /**< hal_ipcc_packet_type_t */
+    uint8_t data[HAL_IPCC_BUFFER_PAYLOAD]; /**< HCI packet after the indicator */
+} hal_ipcc_buffer_t;
+
+/**
+ * @brief Batch of received buffers, all owned by the callee until released
+ * @param buffers Buffers filled by CPU2, oldest first
+ * @param count Number of buffers
+ * @param user_data User data from registration
+ */
+typedef void (*hal_ipcc_receive_callback_t)(hal_ipcc_buffer_t *const *buffers, uint32_t count, void *user_data);
+
+/**
+ * @brief Interrupt-context hook: a batch is waiting for hal_ipcc_process()
+ */
+typedef void (*hal_ipcc_wakeup_t)(void *user_data);
+
+/**
+ * @brief Transport counters
+ */
+typedef struct {
+    uint32_t packets_sent;              /**< Buffers passed to CPU2 */
+    uint32_t packets_received;          /**< Buffers received from CPU2 */
+    uint32_t doorbells_rung;            /**< IPCC channels set towards CPU2 */
+    uint32_t doorbells_coalesced;       /**< Releases that found the memory manager doorbell still pending */
+    uint32_t interrupts;                /**< Receive interrupts taken */
+    uint32_t batches;                   /**< Receive callbacks */
+    uint32_t batch_max;                 /**< Largest batch */
+    uint32_t send_busy;                 /**< Allocations that found the buffer still with CPU2 */
+    uint32_t rejected;                  /**< Frees and releases of buffers the caller did not hold */
+    uint32_t wireless_version;          /**< Wireless stack version from the device info table, 0 until it runs */
+} hal_ipcc_stats_t;
+
+/**
+ * @brief Start the transport and release CPU2
+ *
+ * Lays out the mailbox on first use, enables the receive interrupt and
+ * sets C2BOOT. HCI commands can be allocated once CPU2 has reported
+ * ready and accepted the BLE stack configuration; hal_ipcc_process()
+ * handles both. Safe to call again.
+ *
+ * @return HAL_OK on success, error code otherwise
+ */
+hal_result_t hal_ipcc_init(void);
+
+/**
+ * @brief Stop taking doorbells
+ *
+ * CPU2 keeps running and the mailbox stays as it is, so a later
+ * hal_ipcc_init() carries on where this stopped.
+ *
+ * @return HAL_OK on success, error code otherwise
+ */
+hal_result_t hal_ipcc_deinit(void);
+
+/**
+ * @brief Take the command or ACL buffer to fill and send
+ *
+ * There is one buffer of each kind. It is free again once CPU2 has
+ * taken the previous packet out of it.
+ *
+ * @param type HAL_IPCC_PACKET_COMMAND or HAL_IPCC_PACKET_ACL
+ * @return Buffer with type set, NULL if it is still with CPU2 or the stack is not ready
+ */
+hal_ipcc_buffer_t *hal_ipcc_alloc(hal_ipcc_packet_type_t type);
+
+/**
+ * @brief Give a filled buffer to CPU2
+ * @param buffer Buffer from hal_ipcc_alloc() with its HCI header filled in
+ * @return HAL_OK on success, error code otherwise
+ */
+hal_result_t hal_ipcc_send(hal_ipcc_buffer_t *buffer);
+
+/**
+ * @brief Return an allocated buffer without sending it
+ * @param buffer Buffer from hal_ipcc_alloc()
+ */
+void hal_ipcc_free(hal_ipcc_buffer_t *buffer);
+
+/**
+ * @brief Hand a received buffer back to CPU2 for reuse
+ *
+ * May be called inside the receive callback or any time later; CPU2 runs
+ * short of buffers while they are held.
+ *
+ * @param buffer Buffer from a receive batch
+ */
+void hal_ipcc_release(hal_ipcc_buffer_t *buffer);
+
+/**
+ * @brief HCI packet length of a buffer, indicator excluded
+ * @param buffer Mailbox buffer
+ * @return Bytes of data in use, 0 for an unknown packet type
+ */
+uint32_t hal_ipcc_length(const hal_ipcc_buffer_t *buffer);
+
+/**
+ * @brief Register the receive callback and the interrupt wakeup hook
+ * @param callback Batch consumer, called from hal_ipcc_process()
+ * @param wakeup Called from the interrupt when a batch is waiting (may be NULL)
+ * @param user_data User data for both
+ * @return HAL_OK on success, error code otherwise
+ */
+hal_result_t hal_ipcc_register_callback(hal_ipcc_receive_callback_t callback, hal_ipcc_wakeup_t wakeup,
+                                        void *user_data);
+
+/**
+ * @brief Bring up the stack, deliver received events and return released buffers
+ *
+ * Call from a task after the wakeup hook fires, or periodically.
+ *
+ * @return Number of buffers delivered
+ */
+uint32_t hal_ipcc_process(void);
+
+/**
+ * @brief Get transport counters
+ * @param stats Pointer to store the counters
+ * @return HAL_OK on success, error code otherwise
+ */
+hal_result_t hal_ipcc_get_stats(hal_ipcc_stats_t *stats);
+
+/**
+ * @brief IPCC receive interrupt handler
+ *
+ * Masks the ringing channels and calls the wakeup hook. hal_ipcc_init()
+ * installs it for the IPCC C1 RX interrupt.
+ */
+void hal_ipcc_rx_irq_handler(void);
+
+#endif /* HAL_IPCC_H */
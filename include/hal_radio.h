@@ -87,6 +87,100 @@ typedef struct {
     bool whitening_enabled;             /**< Data whitening enable flag */
 } hal_radio_config_t;
 
+/**
+ * @brief Precomputed Sub-GHz configuration profiles
+ *
+ * All use a 0xD391 sync word and variable length packets with CRC.
+ */
+typedef enum {
+    HAL_RADIO_PRESET_OOK_270KHZ = 0,    /**< OOK, 270 kHz RX bandwidth, 3.79 kBaud (AM270) */
+    HAL_RADIO_PRESET_OOK_650KHZ,        /**< OOK, 650 kHz RX bandwidth, 3.79 kBaud (AM650) */
+    HAL_RADIO_PRESET_2FSK_DEV2_38KHZ,   /**< 2-FSK, 2.38 kHz deviation, 4.8 kBaud (FM238) */
+    HAL_RADIO_PRESET_2FSK_DEV47_6KHZ,   /**< 2-FSK, 47.6 kHz deviation, 4.8 kBaud (FM476) */
+    HAL_RADIO_PRESET_GFSK_38K4,         /**< GFSK, 20.6 kHz deviation, 38.4 kBaud */
+    HAL_RADIO_PRESET_MAX
+} hal_radio_preset_t;
+
+/** RSSI reported for channels the radio cannot tune to */
+#define HAL_RADIO_RSSI_INVALID  INT8_MIN
+
+/**
+ * @brief Channel plan for hopping and spectrum sweeps
+ *
+ * Channel n is at start_hz + n * step_hz. Channels outside the radio's
+ * bands stay in the plan but cannot be hopped to.
+ */
+typedef struct {
+    uint32_t start_hz;                  /**< Frequency of channel 0 */
+    uint32_t step_hz;                   /**< Channel spacing */
+    uint16_t channel_count;             /**< Number of channels (1-HAL_RADIO_CHANNELS) */
+    uint16_t dwell_us;                  /**< RSSI measurement time per channel in a sweep */
+} hal_radio_scan_plan_t;
+
+/**
+ * @brief Spectrum sweep result for one channel
+ */
+typedef struct {
+    uint32_t frequency_hz;              /**< Channel frequency */
+    int8_t rssi_dbm;                    /**< Average RSSI over the dwell, or HAL_RADIO_RSSI_INVALID */
+    int8_t peak_dbm;                    /**< Highest RSSI sample in the dwell */
+} hal_radio_sweep_point_t;
+
+/**
+ * @brief Raw capture buffer, lent to the consumer by reference
+ *
+ * Each entry is one demodulator pulse in microseconds: positive for a
+ * high level, negative for a low level.
+ */
+typedef struct {
+    const int32_t *edges;               /**< Pulse durations */
+    uint32_t count;                     /**< Number of pulses */
+    uint32_t sequence;                  /**< Buffer number within the capture */
+} hal_radio_capture_buffer_t;
+
+/**
+ * @brief Raw capture counters
+ */
+typedef struct {
+    uint32_t edges_captured;            /**< Pulses stored */
+    uint32_t edges_dropped;             /**< Pulses lost because every buffer was in use */
+    uint32_t buffers_filled;            /**< Buffers handed to the consumer */
+    uint32_t buffers_spilled;           /**< Buffers passed to a spill sink */
+    uint32_t max_buffers_in_use;        /**< Pool high-water mark */
+} hal_radio_capture_stats_t;
+
+/**
+ * @brief Spill sink for raw capture buffers, e.g. a file writer
+ * @param buffer Capture buffer, valid until the sink returns
+ * @param user_data User-provided data pointer
+ * @return HAL_OK to continue, error code to stop spilling
+ */
+typedef hal_result_t (*hal_radio_capture_sink_t)(const hal_radio_capture_buffer_t *buffer, void *user_data);
+
+/**
+ * @brief Wake-on-radio (duty-cycled receive) settings
+ *
+ * Power goes roughly with the duty cycle, wake-up latency with the
+ * interval; the RX window has to cover the transmitter's preamble.
+ */
+typedef struct {
+    uint32_t interval_ms;               /**< Wake period, 10 to 60000 ms */
+    uint32_t rx_window_us;              /**< Minimum listening time per wake; rounded up to a chip step */
+    bool carrier_sense;                 /**< End the window early when no carrier is sensed */
+    uint8_t carrier_sense_relative_db;  /**< Carrier sense on an RSSI rise of 6, 10 or 14 dB (0 = off) */
+    int8_t carrier_sense_absolute_db;   /**< Carrier sense threshold in dB from the AGC target, -7 to 7 (-8 = off) */
+    uint8_t preamble_quality;           /**< Stay awake past the window on a preamble of this quality, 1 to 7 (0 = on a sync word) */
+} hal_radio_wor_config_t;
+
+/**
+ * @brief Wake-on-radio timing the chip was actually programmed with
+ */
+typedef struct {
+    uint32_t interval_us;               /**< Wake period */
+    uint32_t rx_window_us;              /**< Listening time per wake */
+    uint32_t duty_ppm;                  /**< Receiver on-time, per million */
+} hal_radio_wor_timing_t;
+
 /**
  * @brief Radio packet structure
  */
@@ -110,6 +204,12 @@ typedef struct {
     uint32_t sync_errors;               /**< Sync word error count */
     int8_t last_rssi;                   /**< Last measured RSSI */
     uint8_t last_lqi;                   /**< Last measured LQI */
+    uint32_t scheduled_tx;              /**< Transmissions started at a requested time */
+    uint32_t scheduled_late;            /**< Scheduled transmissions whose time had passed (not in jitter) */
+    uint32_t tx_jitter_last_us;         /**< Strobe delay after the requested time, last transmission
+                                             (channel checks and backoffs included with listen-before-talk) */
+    uint32_t tx_jitter_max_us;          /**< Strobe delay after the requested time, worst case */
+    uint32_t tx_jitter_total_us;        /**< Sum of strobe delays, for the average over on-time transmissions */
 } hal_radio_stats_t;
 
 /**
@@ -123,9 +223,37 @@ typedef enum {
     HAL_RADIO_EVENT_SYNC_DETECTED,      /**< Sync word detected */
     HAL_RADIO_EVENT_FIFO_OVERFLOW,      /**< FIFO overflow */
     HAL_RADIO_EVENT_FIFO_UNDERFLOW,     /**< FIFO underflow */
+    HAL_RADIO_EVENT_GRANTED,            /**< Arbiter gave the radio to a client (data: hal_radio_client_t *) */
+    HAL_RADIO_EVENT_REVOKED,            /**< Arbiter is taking the radio from a client (data: hal_radio_client_t *) */
     HAL_RADIO_EVENT_MAX
 } hal_radio_event_t;
 
+/** Async request handle; HAL_RADIO_REQUEST_NONE is never issued */
+typedef uint32_t hal_radio_request_t;
+#define HAL_RADIO_REQUEST_NONE  0
+
+/**
+ * @brief Options for an async request; NULL selects all defaults (zero)
+ */
+typedef struct {
+    uint32_t delay_us;                  /**< Start this long after the previous request ends (0 = at once) */
+    uint32_t window_us;                 /**< RX: time to wait for a sync word (0 = until a packet arrives) */
+    bool listen_before_talk;            /**< TX: only transmit on a clear channel */
+    int8_t cca_threshold_dbm;           /**< TX: channel is clear below this RSSI */
+    uint8_t cca_retries;                /**< TX: extra channel checks after random backoff */
+    bool at_time;                       /**< Start at start_us instead of after delay_us */
+    uint32_t start_us;                  /**< Absolute start time on the hal_radio_get_time() clock */
+} hal_radio_request_options_t;
+
+/**
+ * @brief Event data for the completion of an async request
+ */
+typedef struct {
+    hal_radio_request_t request;        /**< Completed request */
+    hal_result_t result;                /**< Outcome; HAL_ERROR_RESOURCE_BUSY if the channel stayed busy */
+    hal_radio_packet_t *packet;         /**< Packet given with the request */
+} hal_radio_completion_t;
+
 /**
  * @brief Radio event callback function type
  * @param radio_id Radio device ID
@@ -136,6 +264,180 @@ typedef enum {
 typedef void (*hal_radio_event_callback_t)(uint32_t radio_id, hal_radio_event_t event, 
                                            void *data, void *user_data);
 
+/** Arbiter client handle; HAL_RADIO_CLIENT_NONE is never issued */
+typedef uint32_t hal_radio_client_t;
+#define HAL_RADIO_CLIENT_NONE   0
+
+/**
+ * @brief Arbiter client declaration
+ */
+typedef struct {
+    uint8_t priority;                   /**< Higher takes the radio from lower outside reserved slots */
+    uint32_t period_ms;                 /**< Reservation period (0 = no reservation) */
+    uint32_t slot_ms;                   /**< Radio time guaranteed once per period */
+    hal_radio_event_callback_t callback; /**< Radio events while the owner, plus GRANTED and REVOKED */
+    void *user_data;                    /**< User data for the callback */
+} hal_radio_client_config_t;
+
+/**
+ * @brief Arbiter client counters
+ */
+typedef struct {
+    uint32_t grants;                    /**< Times the client got the radio */
+    uint32_t preemptions;               /**< Times the radio was taken before the client released it */
+    uint32_t slots;                     /**< Reserved slots started */
+    uint32_t slots_late;                /**< Reserved slots that started a whole period late */
+    uint64_t held_us;                   /**< Total time as the owner */
+    uint32_t switch_us_last;            /**< Context switch to this client, last grant */
+    uint32_t switch_us_max;             /**< Context switch to this client, worst case */
+} hal_radio_client_stats_t;
+
+/* BLE advertising and scanning */
+#define HAL_RADIO_ADV_DATA_MAX  31      /**< Legacy advertising and scan response payload */
+
+/**
+ * @brief BLE advertising PDU types (HCI advertising type codes)
+ */
+typedef enum {
+    HAL_RADIO_ADV_CONNECTABLE = 0x00,   /**< ADV_IND: connectable and scannable */
+    HAL_RADIO_ADV_SCANNABLE = 0x02,     /**< ADV_SCAN_IND: scannable, not connectable */
+    HAL_RADIO_ADV_NONCONNECTABLE = 0x03 /**< ADV_NONCONN_IND: broadcast only */
+} hal_radio_adv_type_t;
+
+/**
+ * @brief BLE advertising set
+ */
+typedef struct {
+    hal_radio_adv_type_t type;          /**< PDU type */
+    uint16_t interval_ms;               /**< Advertising interval, 20 to 10240 */
+    uint16_t duration_ms;               /**< Time on air per turn when several sets rotate */
+    uint8_t data_length;                /**< Bytes used in data */
+    uint8_t data[HAL_RADIO_ADV_DATA_MAX]; /**< Advertising data (AD structures) */
+    uint8_t scan_response_length;       /**< Bytes used in scan_response */
+    uint8_t scan_response[HAL_RADIO_ADV_DATA_MAX]; /**< Scan response data */
+} hal_radio_adv_set_t;
+
+/**
+ * @brief BLE advertising report
+ */
+typedef struct {
+    uint8_t address[6];                 /**< Advertiser address, least significant byte first */
+    uint8_t address_type;               /**< 0 public, 1 random */
+    uint8_t event_type;                 /**< 0 ADV_IND, 1 ADV_DIRECT_IND, 2 ADV_SCAN_IND, 3 ADV_NONCONN_IND, 4 SCAN_RSP */
+    int8_t rssi_dbm;                    /**< Signal strength */
+    uint8_t data_length;                /**< Bytes used in data */
+    uint8_t data[HAL_RADIO_ADV_DATA_MAX]; /**< Advertising or scan response data */
+} hal_radio_scan_report_t;
+
+/**
+ * @brief Batch of scan reports
+ * @param reports Reports, oldest first, valid during the call
+ * @param count Number of reports
+ * @param user_data User data from the scan configuration
+ */
+typedef void (*hal_radio_scan_callback_t)(const hal_radio_scan_report_t *reports, uint32_t count,
+                                          void *user_data);
+
+/**
+ * @brief BLE scan configuration
+ */
+typedef struct {
+    bool active;                        /**< Send scan requests to collect scan responses */
+    uint16_t interval_ms;               /**< Scan interval, 3 to 10240 */
+    uint16_t window_ms;                 /**< Listening time per interval, at most interval_ms */
+    int8_t rssi_threshold_dbm;          /**< Reports weaker than this are dropped */
+    uint32_t refresh_ms;                /**< Report an unchanged device again after this long (0 = never) */
+    uint16_t batch_size;                /**< Reports per callback, 1 to HAL_RADIO_SCAN_BATCH (0 = maximum) */
+    uint32_t batch_timeout_ms;          /**< Deliver a partial batch this long after its first report */
+    hal_radio_scan_callback_t callback; /**< Report consumer */
+    void *user_data;                    /**< User data for the callback */
+} hal_radio_scan_config_t;
+
+/**
+ * @brief BLE controller counters
+ */
+typedef struct {
+    uint32_t hci_commands;              /**< HCI commands sent */
+    uint32_t hci_command_errors;        /**< Commands the controller rejected */
+    uint32_t hci_events;                /**< HCI events received */
+    uint32_t adv_rotations;             /**< Advertising set switches */
+    uint32_t adv_refused;               /**< Advertising enables refused with Command Disallowed */
+    uint32_t scan_reports;              /**< Advertising reports received */
+    uint32_t scan_weak;                 /**< Reports below the RSSI threshold */
+    uint32_t scan_duplicates;           /**< Reports of unchanged, recently reported devices */
+    uint32_t scan_evictions;            /**< Devices dropped from the full device table */
+    uint32_t scan_devices;              /**< Devices in the table now */
+    uint32_t scan_delivered;            /**< Reports passed to the callback */
+    uint32_t scan_batches;              /**< Callback invocations */
+    uint32_t acl_sent;                  /**< ACL data packets given to the controller */
+    uint32_t acl_received;              /**< ACL data packets from the controller */
+    uint16_t link_tx_octets;            /**< Link layer payload per packet, transmit (27 without DLE) */
+    uint16_t link_rx_octets;            /**< Link layer payload per packet, receive */
+    uint8_t link_tx_phy;                /**< 1 LE 1M, 2 LE 2M, 3 LE Coded */
+    uint8_t link_rx_phy;                /**< 1 LE 1M, 2 LE 2M, 3 LE Coded */
+} hal_radio_bluetooth_stats_t;
+
+/** L2CAP channel handle; HAL_RADIO_CHANNEL_NONE is never issued */
+typedef uint32_t hal_radio_channel_t;
+#define HAL_RADIO_CHANNEL_NONE  0
+
+/**
+ * @brief One piece of an SDU to send
+ */
+typedef struct {
+    const void *data;                   /**< Bytes, valid until HAL_RADIO_L2CAP_SENT */
+    uint32_t length;                    /**< Number of bytes */
+} hal_radio_segment_t;
+
+/**
+ * @brief L2CAP channel events
+ */
+typedef enum {
+    HAL_RADIO_L2CAP_OPENED = 0,         /**< Channel connected (data NULL) */
+    HAL_RADIO_L2CAP_CLOSED,             /**< Channel or link gone; queued SDUs are dropped (data NULL) */
+    HAL_RADIO_L2CAP_RECEIVED,           /**< SDU received (data: bytes in rx_buffer, valid during the call) */
+    HAL_RADIO_L2CAP_SENT                /**< SDU handed to the controller (data: its segment array, free again) */
+} hal_radio_l2cap_event_t;
+
+/**
+ * @brief L2CAP channel event callback
+ * @param channel Channel handle
+ * @param event Event type
+ * @param data Event data, see hal_radio_l2cap_event_t
+ * @param length SDU length for RECEIVED and SENT
+ * @param user_data User data from the channel configuration
+ */
+typedef void (*hal_radio_l2cap_callback_t)(hal_radio_channel_t channel, hal_radio_l2cap_event_t event,
+                                           const void *data, uint32_t length, void *user_data);
+
+/**
+ * @brief L2CAP LE credit based channel configuration
+ */
+typedef struct {
+    uint16_t psm;                       /**< LE_PSM, 0x0001 to 0x00FF (0x0080 and up for custom services) */
+    uint16_t mtu;                       /**< Largest SDU accepted, at least 23 */
+    uint8_t *rx_buffer;                 /**< SDU reassembly buffer of mtu bytes */
+    uint16_t rx_credits;                /**< K-frames the peer may send ahead (0 = one full SDU) */
+    hal_radio_l2cap_callback_t callback; /**< Channel events */
+    void *user_data;                    /**< User data for the callback */
+} hal_radio_l2cap_config_t;
+
+/**
+ * @brief L2CAP channel counters
+ */
+typedef struct {
+    uint32_t sdus_sent;                 /**< SDUs handed to the controller */
+    uint32_t sdus_received;             /**< SDUs delivered to the callback */
+    uint32_t sdus_dropped;              /**< Received SDUs cut off by a protocol violation (channel closed) */
+    uint32_t frames_sent;               /**< K-frames sent */
+    uint32_t frames_received;           /**< K-frames received */
+    uint64_t bytes_sent;                /**< SDU bytes sent */
+    uint64_t bytes_received;            /**< SDU bytes received */
+    uint16_t tx_credits;                /**< K-frames the peer accepts now */
+    uint16_t peer_mtu;                  /**< Largest SDU the peer accepts */
+    uint16_t peer_mps;                  /**< Largest K-frame payload the peer accepts */
+} hal_radio_l2cap_stats_t;
+
 /**
  * @brief Initialize Radio HAL
  * @return HAL_OK on success, error code otherwise
@@ -203,6 +505,65 @@ hal_result_t hal_radio_set_power(uint32_t radio_id, hal_radio_power_t power_leve
  */
 hal_result_t hal_radio_set_modulation(uint32_t radio_id, hal_radio_modulation_t modulation);
 
+/**
+ * @brief Switch to a precomputed configuration profile
+ *
+ * Faster than hal_radio_configure(): the register values are computed at
+ * build time and only registers that differ from the current setup are
+ * written. The power level is kept; the radio configuration is updated
+ * to describe the preset.
+ *
+ * @param radio_id Radio device ID
+ * @param preset Configuration profile
+ * @param frequency_hz Operating frequency in Hz
+ * @return HAL_OK on success, HAL_ERROR_NOT_SUPPORTED for radios without presets
+ */
+hal_result_t hal_radio_apply_preset(uint32_t radio_id, hal_radio_preset_t preset, uint32_t frequency_hz);
+
+/**
+ * @brief Set the channel plan and calibrate every channel in it
+ *
+ * Runs one synthesizer calibration per channel and caches the results, so
+ * hal_radio_hop() and hal_radio_sweep() retune without recalibrating. A
+ * full plan of HAL_RADIO_CHANNELS takes a few hundred milliseconds.
+ *
+ * @param radio_id Radio device ID
+ * @param plan Channel plan
+ * @return HAL_OK on success, HAL_ERROR_NOT_SUPPORTED for radios without hopping
+ */
+hal_result_t hal_radio_set_scan_plan(uint32_t radio_id, const hal_radio_scan_plan_t *plan);
+
+/**
+ * @brief Retune to a plan channel using its cached calibration
+ *
+ * Leaves the radio receiving on the new channel. The next
+ * hal_radio_configure() or preset returns to calibrating on every RX/TX.
+ *
+ * @param radio_id Radio device ID
+ * @param channel Channel index in the plan
+ * @return HAL_OK on success, HAL_ERROR_INVALID_PARAM for channels outside the radio's bands
+ */
+hal_result_t hal_radio_hop(uint32_t radio_id, uint16_t channel);
+
+/**
+ * @brief Read the current RSSI
+ * @param radio_id Radio device ID
+ * @param rssi_dbm Pointer to store RSSI in dBm
+ * @return HAL_OK on success, error code otherwise
+ */
+hal_result_t hal_radio_get_rssi(uint32_t radio_id, int8_t *rssi_dbm);
+
+/**
+ * @brief Sweep the plan, measuring RSSI on each channel for its dwell time
+ * @param radio_id Radio device ID
+ * @param points Array for one result per plan channel
+ * @param max_points Size of points
+ * @param count Pointer to store the number of results written
+ * @return HAL_OK on success, error code otherwise
+ */
+hal_result_t hal_radio_sweep(uint32_t radio_id, hal_radio_sweep_point_t *points, uint16_t max_points,
+                             uint16_t *count);
+
 /**
  * @brief Transmit data packet
  * @param radio_id Radio device ID
@@ -213,6 +574,15 @@ hal_result_t hal_radio_transmit(uint32_t radio_id, const hal_radio_packet_t *pac
 
 /**
  * @brief Receive data packet
+ *
+ * On entry packet->data and packet->length give the receive buffer and its
+ * size; on return packet->length holds the received length. Variable
+ * length packets longer than the buffer are dropped.
+ *
+ * Bluetooth receives the next ACL packet on the current connection, the
+ * counterpart of hal_radio_transmit(): HAL_ERROR_NOT_INITIALIZED without
+ * a connection, HAL_ERROR_NO_MEMORY if the packet does not fit.
+ *
  * @param radio_id Radio device ID
  * @param packet Buffer to store received packet
  * @param timeout_ms Timeout in milliseconds (0 = no timeout)
@@ -220,6 +590,88 @@ hal_result_t hal_radio_transmit(uint32_t radio_id, const hal_radio_packet_t *pac
  */
 hal_result_t hal_radio_receive(uint32_t radio_id, hal_radio_packet_t *packet, uint32_t timeout_ms);
 
+/**
+ * @brief Queue a packet for transmission without waiting for it
+ *
+ * Requests run one after another in submission order, driven from
+ * interrupts. Each ends with exactly one event whose data is a
+ * hal_radio_completion_t, valid during the callback: TX_COMPLETE for
+ * transmissions, RX_COMPLETE or RX_TIMEOUT for receptions. A non-zero
+ * delay_us makes the radio idle with the synthesizer running after the
+ * previous request and strobe exactly delay_us after it ended; delays
+ * shorter than the synthesizer calibration (~800 us) stretch to it.
+ *
+ * The packet must stay valid until its request completes. While requests
+ * are queued the blocking calls return HAL_ERROR_RESOURCE_BUSY.
+ *
+ * @param radio_id Radio device ID
+ * @param packet Packet to transmit
+ * @param options Request options (may be NULL)
+ * @param request Pointer to store the request handle (may be NULL)
+ * @return HAL_OK on success, HAL_ERROR_NO_MEMORY if the queue is full
+ */
+hal_result_t hal_radio_transmit_async(uint32_t radio_id, const hal_radio_packet_t *packet,
+                                      const hal_radio_request_options_t *options, hal_radio_request_t *request);
+
+/**
+ * @brief Transmit a packet at an absolute time
+ *
+ * Shorthand for hal_radio_transmit_async() with at_time set. The FIFO is
+ * loaded and the synthesizer calibrated ahead of time; the strobe is
+ * issued from a timer compare, so the transmission starts within a few
+ * microseconds of start_us (see the jitter counters in
+ * hal_radio_stats_t). Allow at least a millisecond of lead time, and
+ * more if other requests are queued before this one.
+ *
+ * @param radio_id Radio device ID
+ * @param packet Packet to transmit, valid until the request completes
+ * @param start_us Start time on the hal_radio_get_time() clock
+ * @param request Pointer to store the request handle (may be NULL)
+ * @return HAL_OK on success, error code otherwise
+ */
+hal_result_t hal_radio_transmit_at(uint32_t radio_id, const hal_radio_packet_t *packet, uint32_t start_us,
+                                   hal_radio_request_t *request);
+
+/**
+ * @brief Get the radio clock
+ *
+ * A free-running microsecond counter shared by all radios; it wraps every
+ * 2^32 us (about 71 minutes), so compare times by signed difference.
+ *
+ * @param time_us Pointer to store the current time
+ * @return HAL_OK on success, error code otherwise
+ */
+hal_result_t hal_radio_get_time(uint32_t *time_us);
+
+/**
+ * @brief Queue a receive window without waiting for it
+ *
+ * Buffer semantics are those of hal_radio_receive(); completion is as for
+ * hal_radio_transmit_async(). A packet whose sync word arrived inside the
+ * window is always received in full.
+ *
+ * @param radio_id Radio device ID
+ * @param packet Buffer to store the received packet
+ * @param options Request options (may be NULL)
+ * @param request Pointer to store the request handle (may be NULL)
+ * @return HAL_OK on success, HAL_ERROR_NO_MEMORY if the queue is full
+ */
+hal_result_t hal_radio_receive_async(uint32_t radio_id, hal_radio_packet_t *packet,
+                                     const hal_radio_request_options_t *options, hal_radio_request_t *request);
+
+/**
+ * @brief Withdraw an async request that is not on air yet
+ *
+ * The request is dropped without an event. hal_radio_set_idle() and other
+ * state changes drop every queued request the same way.
+ *
+ * @param radio_id Radio device ID
+ * @param request Request handle
+ * @return HAL_OK on success, HAL_ERROR_RESOURCE_BUSY if it is on air,
+ *         HAL_ERROR_RESOURCE_NOT_FOUND if it already completed
+ */
+hal_result_t hal_radio_cancel(uint32_t radio_id, hal_radio_request_t request);
+
 /**
  * @brief Start continuous transmission
  * @param radio_id Radio device ID
@@ -231,11 +683,38 @@ hal_result_t hal_radio_start_tx_continuous(uint32_t radio_id, const uint8_t *dat
 
 /**
  * @brief Start continuous reception
+ *
+ * On the CC1101 this is a raw capture: the demodulator output is timed
+ * edge by edge into the capture pool (HAL_RADIO_CAPTURE_BUFFERS buffers of
+ * HAL_RADIO_CAPTURE_EDGES pulses) until hal_radio_stop_continuous().
+ * Starting a capture reclaims every pool buffer; it fails with
+ * HAL_ERROR_RESOURCE_BUSY while buffers from the last capture are still
+ * acquired and not released.
+ *
  * @param radio_id Radio device ID
  * @return HAL_OK on success, error code otherwise
  */
 hal_result_t hal_radio_start_rx_continuous(uint32_t radio_id);
 
+/**
+ * @brief Start duty-cycled reception (wake-on-radio)
+ *
+ * The radio sleeps and polls the channel on its own timer; the MCU is
+ * only interrupted once a sync word arrives, so it can stay in Stop mode
+ * in between. Each packet is reported with HAL_RADIO_EVENT_RX_COMPLETE
+ * (or HAL_RADIO_EVENT_CRC_ERROR) in the same packet buffer, which is
+ * reused for the next one as soon as the callback returns. Runs until
+ * hal_radio_stop_continuous().
+ *
+ * @param radio_id Radio device ID
+ * @param config Wake-on-radio settings
+ * @param packet Receive buffer: data and length give its capacity
+ * @param timing Pointer to store the programmed timing (may be NULL)
+ * @return HAL_OK on success, error code otherwise
+ */
+hal_result_t hal_radio_start_wor(uint32_t radio_id, const hal_radio_wor_config_t *config,
+                                 hal_radio_packet_t *packet, hal_radio_wor_timing_t *timing);
+
 /**
  * @brief Stop continuous operation
  * @param radio_id Radio device ID
@@ -243,6 +722,273 @@ hal_result_t hal_radio_start_rx_continuous(uint32_t radio_id);
  */
 hal_result_t hal_radio_stop_continuous(uint32_t radio_id);
 
+/**
+ * @brief Take the oldest filled capture buffer
+ *
+ * The buffer stays owned by the consumer until hal_radio_capture_release();
+ * holding buffers too long makes the capture drop pulses.
+ *
+ * @param radio_id Radio device ID
+ * @param buffer Pointer to store the buffer, NULL if none is ready
+ * @return HAL_OK on success, error code otherwise
+ */
+hal_result_t hal_radio_capture_acquire(uint32_t radio_id, const hal_radio_capture_buffer_t **buffer);
+
+/**
+ * @brief Return a capture buffer to the pool
+ * @param radio_id Radio device ID
+ * @param buffer Buffer from hal_radio_capture_acquire()
+ * @return HAL_OK on success, HAL_ERROR_INVALID_PARAM if the buffer is not
+ *         currently acquired
+ */
+hal_result_t hal_radio_capture_release(uint32_t radio_id, const hal_radio_capture_buffer_t *buffer);
+
+/**
+ * @brief Pass every filled capture buffer to a sink and release it
+ *
+ * Call periodically from a task to stream a long capture to storage; the
+ * pool bounds memory use however long the capture runs.
+ *
+ * @param radio_id Radio device ID
+ * @param sink Function receiving each buffer
+ * @param user_data User data for the sink
+ * @param spilled Pointer to store the number of buffers spilled (may be NULL)
+ * @return HAL_OK on success, the sink's error otherwise
+ */
+hal_result_t hal_radio_capture_spill(uint32_t radio_id, hal_radio_capture_sink_t sink, void *user_data,
+                                     uint32_t *spilled);
+
+/**
+ * @brief Get raw capture counters
+ * @param radio_id Radio device ID
+ * @param stats Pointer to store the counters
+ * @return HAL_OK on success, error code otherwise
+ */
+hal_result_t hal_radio_capture_get_stats(uint32_t radio_id, hal_radio_capture_stats_t *stats);
+
+/**
+ * @brief Start sampling the demodulator output for software demodulation
+ *
+ * The radio's data output is read by DMA at a fixed rate into a ring of
+ * HAL_RADIO_SAMPLE_BUFFER samples, two halves that fill alternately. Feed
+ * the halves from hal_radio_sample_acquire() to hal_radio_dsp_process().
+ * Runs until hal_radio_stop_continuous().
+ *
+ * @param radio_id Radio device ID
+ * @param sample_rate_hz Sample rate, at least four times the bit rate
+ * @return HAL_OK on success, error code otherwise
+ */
+hal_result_t hal_radio_start_sampling(uint32_t radio_id, uint32_t sample_rate_hz);
+
+/**
+ * @brief Take the most recently filled half of the sample ring
+ *
+ * Samples are 0 or HAL_RADIO_DSP_LEVEL_HIGH and stay valid until the DMA
+ * comes round to the same half again, one half-ring time later.
+ *
+ * @param radio_id Radio device ID
+ * @param samples Pointer to store the samples, NULL if no half is ready
+ * @param count Pointer to store the number of samples
+ * @param missed Pointer to store the halves overwritten since the last call (may be NULL)
+ * @return HAL_OK on success, error code otherwise
+ */
+hal_result_t hal_radio_sample_acquire(uint32_t radio_id, const int16_t **samples, uint32_t *count,
+                                      uint32_t *missed);
+
+/**
+ * @brief Register a client sharing a radio through the arbiter
+ *
+ * Clients get the radio in turn and use the normal radio API with the
+ * shared radio_id only between HAL_RADIO_EVENT_GRANTED and
+ * HAL_RADIO_EVENT_REVOKED. Each keeps its own configuration, register
+ * settings and event callback, restored on every grant; the scan plan is
+ * shared. A client starts from the radio's current configuration.
+ *
+ * A client with a reservation gets slot_ms of radio time every period_ms
+ * while it wants the radio, even against higher priorities. Reservations
+ * on one radio may add up to HAL_RADIO_ARBITER_RESERVE_PERCENT. Slots
+ * start and end on time from the radio task; no polling is needed.
+ *
+ * On a Bluetooth radio a client keeps its configuration and callback;
+ * losing the radio stops its advertising and scanning, which it starts
+ * again after its next GRANTED.
+ *
+ * @param radio_id Radio device ID
+ * @param config Client declaration
+ * @param client Pointer to store the client handle
+ * @return HAL_OK on success, HAL_ERROR_RESOURCE_BUSY if the reservation does not fit
+ */
+hal_result_t hal_radio_arbiter_register(uint32_t radio_id, const hal_radio_client_config_t *config,
+                                        hal_radio_client_t *client);
+
+/**
+ * @brief Remove a client, giving up the radio if it holds it
+ * @param client Client handle
+ * @return HAL_OK on success, error code otherwise
+ */
+hal_result_t hal_radio_arbiter_unregister(hal_radio_client_t client);
+
+/**
+ * @brief Ask for the radio; HAL_RADIO_EVENT_GRANTED follows when it is the client's turn
+ * @param client Client handle
+ * @return HAL_OK on success, error code otherwise
+ */
+hal_result_t hal_radio_arbiter_request(hal_radio_client_t client);
+
+/**
+ * @brief Stop wanting the radio, handing it on if the client holds it
+ * @param client Client handle
+ * @return HAL_OK on success, error code otherwise
+ */
+hal_result_t hal_radio_arbiter_release(hal_radio_client_t client);
+
+/**
+ * @brief Check whether a client holds its radio
+ * @param client Client handle
+ * @return true if the client is the owner
+ */
+bool hal_radio_arbiter_is_owner(hal_radio_client_t client);
+
+/**
+ * @brief Run the arbiter's time-based decisions now
+ *
+ * Starts and ends reserved slots that are due. The radio task already
+ * does this at every slot boundary, and requests and releases are handled
+ * at once, so calling it is optional.
+ */
+void hal_radio_arbiter_poll(void);
+
+/**
+ * @brief Get arbiter counters for a client
+ * @param client Client handle
+ * @param stats Pointer to store the counters
+ * @return HAL_OK on success, error code otherwise
+ */
+hal_result_t hal_radio_arbiter_get_stats(hal_radio_client_t client, hal_radio_client_stats_t *stats);
+
+/**
+ * @brief Set, replace or remove a BLE advertising set
+ *
+ * Sets take turns on air for their duration_ms, in index order; a single
+ * set advertises continuously. A set changed while on air is reprogrammed
+ * at the next hal_radio_bluetooth_poll().
+ *
+ * @param radio_id Radio device ID
+ * @param index Set slot, below HAL_RADIO_ADV_SETS
+ * @param set Set to copy, NULL to remove the slot
+ * @return HAL_OK on success, error code otherwise
+ */
+hal_result_t hal_radio_set_adv_set(uint32_t radio_id, uint8_t index, const hal_radio_adv_set_t *set);
+
+/**
+ * @brief Start advertising the configured sets
+ * @param radio_id Radio device ID
+ * @return HAL_OK on success, HAL_ERROR_RESOURCE_NOT_FOUND if no set is configured
+ */
+hal_result_t hal_radio_start_advertising(uint32_t radio_id);
+
+/**
+ * @brief Stop advertising
+ * @param radio_id Radio device ID
+ * @return HAL_OK on success, error code otherwise
+ */
+hal_result_t hal_radio_stop_advertising(uint32_t radio_id);
+
+/**
+ * @brief Start scanning for advertisers
+ *
+ * Reports pass an RSSI threshold and a duplicate filter before they are
+ * batched for the callback. The filter tracks up to HAL_RADIO_SCAN_DEVICES
+ * advertisers by address, with a hash of their advertising and scan
+ * response data; a device is reported again only when its data changes or
+ * after refresh_ms. When the table is full the least recently heard device
+ * is forgotten, so a crowded environment costs fixed memory and at worst
+ * repeats reports for devices that were evicted.
+ *
+ * @param radio_id Radio device ID
+ * @param config Scan configuration, copied
+ * @return HAL_OK on success, error code otherwise
+ */
+hal_result_t hal_radio_start_scan(uint32_t radio_id, const hal_radio_scan_config_t *config);
+
+/**
+ * @brief Stop scanning, delivering any partial batch
+ * @param radio_id Radio device ID
+ * @return HAL_OK on success, error code otherwise
+ */
+hal_result_t hal_radio_stop_scan(uint32_t radio_id);
+
+/**
+ * @brief Get BLE controller counters
+ * @param radio_id Radio device ID
+ * @param stats Pointer to store the counters
+ * @return HAL_OK on success, error code otherwise
+ */
+hal_result_t hal_radio_bluetooth_get_stats(uint32_t radio_id, hal_radio_bluetooth_stats_t *stats);
+
+/**
+ * @brief Run the Bluetooth controller interface
+ *
+ * Handles events and data from the controller, delivers scan batches,
+ * rotates advertising sets, sends queued HCI commands and moves L2CAP
+ * channel data as credits allow. The radio task started by
+ * hal_radio_init() calls it continuously; scan callbacks and L2CAP
+ * events therefore run in that task.
+ */
+void hal_radio_bluetooth_poll(void);
+
+/**
+ * @brief Open an L2CAP LE credit based channel
+ *
+ * A listening channel accepts the peer's connection request for its PSM;
+ * otherwise the channel connects to the peer's PSM. Either way it is
+ * (re)established on every BLE connection until hal_radio_l2cap_close(),
+ * and HAL_RADIO_L2CAP_OPENED reports when it is up.
+ *
+ * Incoming SDUs are reassembled straight into rx_buffer. Credits for an
+ * SDU's K-frames go back to the peer once the callback has returned.
+ *
+ * @param radio_id Radio device ID
+ * @param config Channel configuration, copied
+ * @param listen Wait for the peer to connect rather than connecting
+ * @param channel Pointer to store the channel handle
+ * @return HAL_OK on success, HAL_ERROR_NO_MEMORY if all channels are in use
+ */
+hal_result_t hal_radio_l2cap_open(uint32_t radio_id, const hal_radio_l2cap_config_t *config, bool listen,
+                                  hal_radio_channel_t *channel);
+
+/**
+ * @brief Queue an SDU gathered from segments
+ *
+ * The segment array and the bytes it points to are read as the link takes
+ * data and must stay untouched until HAL_RADIO_L2CAP_SENT returns the
+ * array; the data is written once, straight into the controller mailbox.
+ * SDUs are cut into K-frames of the peer's MPS and sent as the peer's
+ * credits and the controller's buffers allow.
+ *
+ * @param channel Channel handle
+ * @param segments SDU pieces, in order
+ * @param count Number of segments
+ * @return HAL_OK on success, HAL_ERROR_RESOURCE_BUSY if HAL_RADIO_L2CAP_QUEUE SDUs are waiting
+ */
+hal_result_t hal_radio_l2cap_send(hal_radio_channel_t channel, const hal_radio_segment_t *segments,
+                                  uint32_t count);
+
+/**
+ * @brief Disconnect and release a channel; queued SDUs are dropped
+ * @param channel Channel handle
+ * @return HAL_OK on success, error code otherwise
+ */
+hal_result_t hal_radio_l2cap_close(hal_radio_channel_t channel);
+
+/**
+ * @brief Get L2CAP channel counters
+ * @param channel Channel handle
+ * @param stats Pointer to store the counters
+ * @return HAL_OK on success, error code otherwise
+ */
+hal_result_t hal_radio_l2cap_get_stats(hal_radio_channel_t channel, hal_radio_l2cap_stats_t *stats);
+
 /**
  * @brief Get radio state
  * @param radio_id Radio device ID
@@ -253,6 +999,10 @@ hal_result_t hal_radio_get_state(uint32_t radio_id, hal_radio_state_t *state);
 
 /**
  * @brief Set radio to idle state
+ *
+ * Bluetooth stops advertising and scanning (they must be started again);
+ * a connection stays up.
+ *
  * @param radio_id Radio device ID
  * @return HAL_OK on success, error code otherwise
  */
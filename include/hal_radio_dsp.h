@@ -0,0 +1,121 @@
+/**
+ * @file hal_radio_dsp.h
+ * @brief Fixed-point demodulation of sampled radio baseband
+ *
+ * A software path for signals the CC1101 packet engine cannot handle:
+ * baseband samples (the sampled GDO data output, see
+ * hal_radio_start_sampling(), or any other Q15 source) go through a FIR
+ * low-pass filter, envelope detection (OOK), an adaptive slicer that tracks
+ * the signal's high and low levels, and clock recovery that re-times the
+ * sliced signal into bits at the configured rate.
+ *
+ * All arithmetic is Q15 fixed point. On cores with the DSP extension the
+ * filter uses SMLAD (two taps per instruction) and the level trackers
+ * saturate with QADD; elsewhere plain C computes the same results.
+ */
+
+#ifndef HAL_RADIO_DSP_H
+#define HAL_RADIO_DSP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "hal.h"
+
+/* Pipeline limits */
+#define HAL_RADIO_DSP_TAPS          16          /**< FIR length (even) */
+#define HAL_RADIO_DSP_LEVEL_HIGH    16384       /**< Sample value of a high GDO level */
+
+/**
+ * @brief Demodulation modes
+ */
+typedef enum {
+    HAL_RADIO_DSP_OOK = 0,          /**< Samples are signal amplitude; the envelope is sliced */
+    HAL_RADIO_DSP_FSK,              /**< Samples are a frequency (or data) level; the level is sliced */
+    HAL_RADIO_DSP_MODE_MAX
+} hal_radio_dsp_mode_t;
+
+/**
+ * @brief Pipeline configuration
+ */
+typedef struct {
+    hal_radio_dsp_mode_t mode;      /**< Demodulation mode */
+    uint32_t sample_rate_hz;        /**< Input sample rate */
+    uint32_t bit_rate_bps;          /**< Symbol rate to recover, at most sample_rate_hz / 4 */
+    const int16_t *taps;            /**< Q15 FIR taps, HAL_RADIO_DSP_TAPS of them; NULL for a moving average */
+    uint8_t envelope_shift;         /**< OOK envelope smoothing, 2^-shift per sample */
+    uint8_t decay_shift;            /**< Level tracker decay, 2^-shift per sample */
+    uint8_t clock_gain_shift;       /**< Clock correction per transition, 2^-shift of the phase error */
+    int16_t squelch;                /**< Minimum high-low level span that yields bits */
+} hal_radio_dsp_config_t;
+
+/**
+ * @brief Pipeline counters
+ */
+typedef struct {
+    uint32_t samples;               /**< Samples processed */
+    uint32_t bits;                  /**< Bits recovered */
+    uint32_t bits_dropped;          /**< Bits that did not fit the output buffer */
+    uint32_t transitions;           /**< Slicer transitions, each a clock correction */
+    int16_t level_high;             /**< Current tracked high level */
+    int16_t level_low;              /**< Current tracked low level */
+} hal_radio_dsp_stats_t;
+
+/**
+ * @brief Pipeline state
+ */
+typedef struct {
+    hal_radio_dsp_config_t config;
+    union {
+        uint32_t align;
+        int16_t values[HAL_RADIO_DSP_TAPS];     /**< Taps, reversed to run oldest sample first */
+    } taps;
+    int16_t history[2 * HAL_RADIO_DSP_TAPS];    /**< Delay line, each sample stored twice */
+    uint32_t position;              /**< Delay line write index */
+    int32_t envelope;               /**< OOK envelope */
+    int32_t high;                   /**< Tracked high level */
+    int32_t low;                    /**< Tracked low level */
+    uint32_t phase;                 /**< Bit clock phase, one bit per 2^32 */
+    uint32_t phase_step;            /**< Phase advance per sample */
+    bool level;                     /**< Current sliced level */
+    hal_radio_dsp_stats_t stats;
+} hal_radio_dsp_t;
+
+/**
+ * @brief Set up a pipeline
+ * @param dsp Pipeline state
+ * @param config Configuration, copied (the taps are copied too)
+ * @return HAL_OK on success, HAL_ERROR_INVALID_PARAM for unusable rates
+ */
+hal_result_t hal_radio_dsp_init(hal_radio_dsp_t *dsp, const hal_radio_dsp_config_t *config);
+
+/**
+ * @brief Clear filter, levels and clock, e.g. after retuning
+ * @param dsp Pipeline state
+ */
+void hal_radio_dsp_reset(hal_radio_dsp_t *dsp);
+
+/**
+ * @brief Demodulate a block of samples
+ *
+ * Recovered bits are packed into bits, first bit in the most significant
+ * position of bits[0]. State carries over between calls, so a stream can
+ * be fed in blocks of any size.
+ *
+ * @param dsp Pipeline state
+ * @param samples Q15 samples
+ * @param count Number of samples
+ * @param bits Output buffer for packed bits
+ * @param max_bits Capacity of bits, in bits
+ * @return Number of bits written
+ */
+uint32_t hal_radio_dsp_process(hal_radio_dsp_t *dsp, const int16_t *samples, uint32_t count,
+                               uint8_t *bits, uint32_t max_bits);
+
+/**
+ * @brief Copy the pipeline counters
+ * @param dsp Pipeline state
+ * @param stats Receives the counters
+ */
+void hal_radio_dsp_get_stats(const hal_radio_dsp_t *dsp, hal_radio_dsp_stats_t *stats);
+
+#endif /* HAL_RADIO_DSP_H */
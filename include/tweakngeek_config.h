@@ -37,8 +37,24 @@
 /* Hardware Abstraction Layer Configuration */
 #define HAL_GPIO_PINS                   64
 #define HAL_RADIO_CHANNELS              256
+#define HAL_RADIO_CAPTURE_BUFFERS       8               /* Raw capture pool buffers (power of two) */
+#define HAL_RADIO_CAPTURE_EDGES         256             /* Pulse durations per capture buffer */
+#define HAL_RADIO_REQUEST_QUEUE         8               /* Queued async TX/RX requests per radio */
+#define HAL_RADIO_SAMPLE_BUFFER         1024            /* Baseband sample ring, two halves (even) */
+#define HAL_RADIO_ARBITER_CLIENTS       4               /* Clients sharing radios through the arbiter */
+#define HAL_RADIO_ARBITER_RESERVE_PERCENT 50            /* Radio time reservations may take, per radio */
+#define HAL_IPCC_EVENT_BUFFERS          24              /* Mailbox event pool CPU2 delivers into */
+#define HAL_IPCC_BATCH                  8               /* Received buffers per callback */
+#define HAL_RADIO_ADV_SETS              4               /* BLE advertising sets in rotation */
+#define HAL_RADIO_SCAN_DEVICES          128             /* BLE scan duplicate filter entries (power of two, at most 128) */
+#define HAL_RADIO_SCAN_BATCH            16              /* BLE scan reports per callback */
+#define HAL_RADIO_L2CAP_CHANNELS        2               /* BLE L2CAP credit based channels */
+#define HAL_RADIO_L2CAP_QUEUE           4               /* Queued SDUs per L2CAP channel */
+#define HAL_RADIO_TASK_STACK            1024            /* Radio task: BLE events, advertising, L2CAP */
 #define HAL_DISPLAY_WIDTH               128
 #define HAL_DISPLAY_HEIGHT              64
+#define HAL_DISPLAY_DOUBLE_BUFFER       1               /* Second frame buffer for DMA flush */
+#define HAL_DISPLAY_GRAY_PLANES         4               /* Bitplanes for GRAY2/GRAY4, 0 to disable */
 
 /* Application Runtime Configuration */
 #define APP_MAX_MEMORY_SIZE             (64 * 1024)     /* 64KB per app */
@@ -49,6 +65,13 @@
 #define WIFI_EMU_MAX_CONNECTIONS        4
 #define WIFI_EMU_BUFFER_SIZE            1024
 #define WIFI_EMU_CHANNEL_DEFAULT        6
+#define WIFI_EMU_POOL_BUFFERS           12              /* Frame buffers shared by all connections */
+#define WIFI_EMU_TX_QUEUE               4               /* Queued frames per connection */
+
+/* Network Stack Configuration */
+#define NET_SOCKETS                     6               /* UDP and TCP sockets, unaccepted connections included */
+#define NET_BUFFERS                     24              /* Buffer descriptors, each viewing a WiFi emulation frame */
+#define NET_SOCKET_QUEUE                4               /* Buffers queued per socket and direction */
 
 /* Debug Configuration */
 #ifdef DEBUG
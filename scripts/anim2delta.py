@@ -0,0 +1,130 @@
+#!/usr/bin/env python3
+"""
+TweaknGeek animation encoder
+
+Converts a sequence of PBM/PGM frames into the XOR-delta animation format
+played by src/applications/anim_player.c. Frames are dithered like
+img2bitmap.py, converted to the page-major display layout and stored as
+the byte-wise XOR against the previous frame (the first against a blank
+area), coded as skips, literals and runs (see anim_player.h).
+
+Usage:
+    anim2delta.py [--loop] [--frame-ms MS] [--dither none|ordered|fs]
+                  -n NAME -o OUTPUT.h FRAME.pnm [FRAME.pnm ...]
+"""
+
+import argparse
+import sys
+
+from img2bitmap import dither, emit_array, header_lines, read_pnm, to_pages
+
+MAX_SHORT = 64          # skip and literal counts of the one-byte codes
+MAX_RUN = 65            # longest run of one repeated XOR byte
+MAX_LONG_SKIP = 16384
+
+
+def encode_delta(delta):
+    out = []
+    i = 0
+    n = len(delta)
+
+    # Trailing unchanged bytes need no code at all
+    while n > 0 and delta[n - 1] == 0:
+        n -= 1
+
+    while i < n:
+        if delta[i] == 0:
+            run = 1
+            while i + run < n and delta[i + run] == 0 and run < MAX_LONG_SKIP:
+                run += 1
+            if run <= MAX_SHORT:
+                out.append(run - 1)
+            else:
+                out += [0xC0 | ((run - 1) >> 8), (run - 1) & 0xFF]
+            i += run
+            continue
+
+        run = 1
+        while i + run < n and delta[i + run] == delta[i] and run < MAX_RUN:
+            run += 1
+        if run >= 3:
+            out += [0x80 | (run - 2), delta[i]]
+            i += run
+            continue
+
+        # Literals until a zero or a worthwhile run starts
+        start = i
+        while i < n and i - start < MAX_SHORT and delta[i] != 0:
+            if i + 2 < n and delta[i] == delta[i + 1] == delta[i + 2]:
+                break
+            i += 1
+        out.append(0x40 | (i - start - 1))
+        out += delta[start:i]
+
+    if len(out) > 0xFFFF:
+        sys.exit("error: frame delta exceeds 64 KiB")
+    return [len(out) & 0xFF, len(out) >> 8] + out
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Encode TweaknGeek XOR-delta animations")
+    parser.add_argument("-n", "--name", required=True, help="C identifier for the animation")
+    parser.add_argument("-o", "--output", required=True, help="output header file")
+    parser.add_argument("--loop", action="store_true", help="restart after the last frame")
+    parser.add_argument("--frame-ms", type=int, default=100, help="frame period in ms (default 100)")
+    parser.add_argument("--dither", choices=("none", "ordered", "fs"), default="none",
+                        help="dithering for grayscale frames (default: none)")
+    parser.add_argument("frames", nargs="+", help="input PBM/PGM frames, in order")
+    args = parser.parse_args()
+    if not 0 < args.frame_ms <= 0xFFFF:
+        sys.exit("error: --frame-ms must be between 1 and 65535")
+
+    frames = []
+    size = None
+    for path in args.frames:
+        width, height, pixels = read_pnm(path)
+        if size is None:
+            size = (width, height)
+        elif (width, height) != size:
+            sys.exit("error: %s is %dx%d, expected %dx%d" % (path, width, height, size[0], size[1]))
+        frames.append(to_pages(width, height, dither(width, height, pixels, args.dither)))
+
+    width, height = size
+    pages = (height + 7) // 8
+    blank = [0] * (width * pages)
+
+    data = []
+    previous = blank
+    for frame in frames:
+        data += encode_delta([a ^ b for a, b in zip(previous, frame)])
+        previous = frame
+    if args.loop:
+        data += encode_delta([a ^ b for a, b in zip(previous, frames[0])])
+
+    guard, lines = header_lines(args.frames[0], args.output)
+    lines.insert(6, "#include \"anim_player.h\"")
+    lines += emit_array("%s_data" % args.name, data)
+    lines += [
+        "",
+        "static const anim_t %s = {" % args.name,
+        "    .width = %d," % width,
+        "    .pages = %d," % pages,
+        "    .flags = %s," % ("ANIM_FLAG_LOOP" if args.loop else "0"),
+        "    .frame_count = %d," % len(frames),
+        "    .frame_ms = %d," % args.frame_ms,
+        "    .data = %s_data," % args.name,
+        "    .data_size = sizeof(%s_data)," % args.name,
+        "};",
+        "",
+        "#endif /* %s */" % guard,
+    ]
+
+    with open(args.output, "w") as f:
+        f.write("\n".join(lines) + "\n")
+
+    raw = len(frames) * width * pages
+    print("%s: %d frames, %d bytes (%d raw)" % (args.name, len(frames), len(data), raw))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,322 @@
+#!/usr/bin/env python3
+"""
+TweaknGeek BDF font converter
+
+Converts BDF bitmap fonts into the packed column-major glyph atlases used by
+the display HAL (see include/hal_font.h). Each glyph is stored as
+(height + 7) / 8 page rows of one byte per column, LSB at the top, so glyphs
+can be copied straight into the page-major display buffer.
+
+Usage:
+    bdf2font.py -o OUTPUT.c NAME:FONT.bdf[:OPTION,...] [NAME:FONT.bdf ...]
+
+Options per font:
+    proportional    Trim blank columns and give each glyph its own advance
+    kern            Generate kerning pairs from glyph profiles (proportional)
+    scale=N         Scale glyphs up by an integer factor
+    spacing=N       Columns between proportional glyphs (default 1)
+    space=N         Advance of the space character in proportional fonts
+    first=N         First character to include (default 32)
+    last=N          Last character to include (default 126)
+"""
+
+import argparse
+import sys
+
+
+class Glyph:
+    def __init__(self, code):
+        self.code = code
+        self.advance = 0
+        self.rows = []      # list of rows, each a list of 0/1 over the cell width
+        self.width = 0
+
+
+class Font:
+    def __init__(self):
+        self.glyphs = {}
+        self.height = 0
+        self.ascent = 0
+        self.default_char = None
+
+
+def parse_bdf(path):
+    font = Font()
+    box_w = box_h = box_x = box_y = 0
+    glyph = None
+    bitmap = None
+    bbx = None
+
+    with open(path, "r", encoding="latin-1") as f:
+        for line in f:
+            parts = line.split()
+            if not parts:
+                continue
+            key = parts[0]
+
+            if bitmap is not None:
+                if key == "ENDCHAR":
+                    w, h, xoff, yoff = bbx
+                    cell = [[0] * box_w for _ in range(font.height)]
+                    top = font.ascent - (yoff + h)
+                    for r, value in enumerate(bitmap):
+                        nbits = len(value) * 4
+                        bits = int(value, 16)
+                        for c in range(w):
+                            if bits >> (nbits - 1 - c) & 1:
+                                y = top + r
+                                x = xoff - box_x + c
+                                if 0 <= y < font.height and 0 <= x < box_w:
+                                    cell[y][x] = 1
+                    glyph.rows = cell
+                    glyph.width = box_w
+                    font.glyphs[glyph.code] = glyph
+                    glyph = None
+                    bitmap = None
+                else:
+                    bitmap.append(key)
+                continue
+
+            if key == "FONTBOUNDINGBOX":
+                box_w, box_h, box_x, box_y = map(int, parts[1:5])
+            elif key == "FONT_ASCENT":
+                font.ascent = int(parts[1])
+            elif key == "FONT_DESCENT":
+                font.height = font.ascent + int(parts[1])
+            elif key == "DEFAULT_CHAR":
+                font.default_char = int(parts[1])
+            elif key == "STARTCHAR":
+                glyph = Glyph(-1)
+            elif key == "ENCODING":
+                glyph.code = int(parts[1])
+            elif key == "DWIDTH":
+                glyph.advance = int(parts[1])
+            elif key == "BBX":
+                bbx = tuple(map(int, parts[1:5]))
+            elif key == "BITMAP":
+                bitmap = []
+
+    if font.height == 0:
+        font.ascent = box_h + box_y
+        font.height = box_h
+    return font
+
+
+def scale_glyph(glyph, factor):
+    rows = []
+    for row in glyph.rows:
+        scaled = [bit for bit in row for _ in range(factor)]
+        rows.extend([list(scaled) for _ in range(factor)])
+    glyph.rows = rows
+    glyph.width *= factor
+    glyph.advance *= factor
+
+
+def trim_glyph(glyph, spacing, space_advance):
+    used = [c for c in range(glyph.width) if any(row[c] for row in glyph.rows)]
+    if not used:
+        glyph.rows = [[] for _ in glyph.rows]
+        glyph.width = 0
+        glyph.advance = space_advance
+        return
+    left, right = used[0], used[-1]
+    glyph.rows = [row[left:right + 1] for row in glyph.rows]
+    glyph.width = right - left + 1
+    glyph.advance = glyph.width + spacing
+
+
+def fixed_glyph(glyph):
+    # Keep the advance from the BDF but drop trailing blank columns beyond the ink box
+    used = [c for c in range(glyph.width) if any(row[c] for row in glyph.rows)]
+    width = glyph.width if used else 0
+    glyph.rows = [row[:width] for row in glyph.rows]
+    glyph.width = width
+
+
+def profile(glyph, from_right):
+    """Blank columns between the glyph edge and its ink, per row (None = empty row)."""
+    result = []
+    for row in glyph.rows:
+        cols = [c for c, bit in enumerate(row) if bit]
+        if not cols:
+            result.append(None)
+        elif from_right:
+            result.append(glyph.width - 1 - cols[-1])
+        else:
+            result.append(cols[0])
+    return result
+
+
+def kerning_pairs(glyphs, spacing, candidates):
+    """Tighten pairs by one column where no row (or diagonal neighbour) would touch."""
+    pairs = []
+    for left in candidates:
+        lp = profile(glyphs[left], True)
+        for right in candidates:
+            rp = profile(glyphs[right], False)
+            gaps = []
+            for r in range(len(lp)):
+                for dr in (-1, 0, 1):
+                    rr = r + dr
+                    if 0 <= rr < len(rp) and lp[r] is not None and rp[rr] is not None:
+                        gaps.append(lp[r] + rp[rr] + spacing)
+            if len(gaps) >= 3 and min(gaps) >= spacing + 1:
+                pairs.append(((left << 8) | right, -1))
+    return pairs
+
+
+def pack_glyph(glyph, height):
+    pages = (height + 7) // 8
+    data = []
+    for page in range(pages):
+        for c in range(glyph.width):
+            value = 0
+            for bit in range(8):
+                y = page * 8 + bit
+                if y < height and glyph.rows[y][c]:
+                    value |= 1 << bit
+            data.append(value)
+    return data
+
+
+def char_comment(code):
+    if code == 0x5C:
+        return "backslash"
+    if code == 0x20:
+        return "space"
+    if code == 0x27:
+        return "apostrophe"
+    return "'%c'" % code
+
+
+def convert(name, path, options):
+    font = parse_bdf(path)
+    first = int(options.get("first", 32))
+    last = int(options.get("last", 126))
+    scale = int(options.get("scale", 1))
+    spacing = int(options.get("spacing", 1)) * scale
+    proportional = "proportional" in options
+    space = int(options.get("space", 3)) * scale
+    height = font.height * scale
+
+    glyphs = {}
+    for code in range(first, last + 1):
+        glyph = font.glyphs.get(code)
+        if glyph is None:
+            glyph = Glyph(code)
+            glyph.rows = [[] for _ in range(font.height)]
+        if scale > 1:
+            scale_glyph(glyph, scale)
+        if proportional:
+            trim_glyph(glyph, spacing, space)
+        else:
+            fixed_glyph(glyph)
+        glyphs[code] = glyph
+
+    kerning = []
+    if "kern" in options:
+        candidates = [c for c in range(first, last + 1)
+                      if chr(c).isalnum() or chr(c) in ".,:;'\"-"]
+        kerning = kerning_pairs(glyphs, spacing, candidates)
+
+    default_char = font.default_char if font.default_char is not None else first
+    if not first <= default_char <= last:
+        default_char = first
+
+    lines = []
+    lines.append("/* %s: %s, %d px, %s */" % (name, path.split("/")[-1], height,
+                                              "proportional" if proportional else "fixed"))
+    lines.append("static const uint8_t %s_bitmap[] = {" % name)
+    descriptors = []
+    offset = 0
+    for code in range(first, last + 1):
+        glyph = glyphs[code]
+        data = pack_glyph(glyph, height)
+        descriptors.append((offset, glyph.width, glyph.advance, code))
+        if data:
+            lines.append("    /* %s */" % char_comment(code))
+            for i in range(0, len(data), 12):
+                lines.append("    " + ", ".join("0x%02X" % b for b in data[i:i + 12]) + ",")
+        offset += len(data)
+    if offset == 0:
+        lines.append("    0x00")
+    lines.append("};")
+    lines.append("")
+
+    if offset > 0xFFFF:
+        sys.exit("error: %s atlas exceeds 64 KiB" % name)
+
+    lines.append("static const hal_font_glyph_t %s_glyphs[] = {" % name)
+    for off, width, advance, code in descriptors:
+        lines.append("    { %5d, %2d, %2d },  /* %s */" % (off, width, advance, char_comment(code)))
+    lines.append("};")
+    lines.append("")
+
+    if kerning:
+        lines.append("static const hal_font_kern_t %s_kerning[] = {" % name)
+        for pair, adjust in sorted(kerning):
+            lines.append("    { 0x%04X, %d },  /* %s %s */" % (pair, adjust,
+                                                         char_comment(pair >> 8),
+                                                         char_comment(pair & 0xFF)))
+        lines.append("};")
+        lines.append("")
+
+    cell_width = max(g.advance for g in glyphs.values())
+    lines.append("const hal_font_t %s = {" % ("hal_font_" + name))
+    lines.append("    .height = %d," % height)
+    lines.append("    .cell_width = %d," % cell_width)
+    lines.append("    .first_char = %d," % first)
+    lines.append("    .last_char = %d," % last)
+    lines.append("    .default_char = %d," % default_char)
+    lines.append("    .flags = %s," % ("HAL_FONT_FLAG_PROPORTIONAL" if proportional else "0"))
+    lines.append("    .kerning_count = %d," % len(kerning))
+    lines.append("    .glyphs = %s_glyphs," % name)
+    lines.append("    .bitmap = %s_bitmap," % name)
+    lines.append("    .kerning = %s," % ("%s_kerning" % name if kerning else "NULL"))
+    lines.append("};")
+    return "\n".join(lines)
+
+
+def parse_spec(spec):
+    parts = spec.split(":")
+    if len(parts) < 2:
+        sys.exit("error: font spec must be NAME:FILE[:OPTIONS], got '%s'" % spec)
+    options = {}
+    if len(parts) > 2 and parts[2]:
+        for opt in parts[2].split(","):
+            key, _, value = opt.partition("=")
+            options[key] = value if value else True
+    return parts[0], parts[1], options
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Convert BDF fonts to TweaknGeek glyph atlases")
+    parser.add_argument("-o", "--output", required=True, help="output C file")
+    parser.add_argument("fonts", nargs="+", help="NAME:FILE.bdf[:OPTION,...]")
+    args = parser.parse_args()
+
+    sections = []
+    for spec in args.fonts:
+        name, path, options = parse_spec(spec)
+        sections.append(convert(name, path, options))
+
+    header = [
+        "/**",
+        " * @file %s" % args.output.split("/")[-1],
+        " * @brief Built-in font atlases",
+        " *",
+        " * Generated by scripts/bdf2font.py from the BDF sources in src/hal/fonts.",
+        " * Do not edit by hand; regenerate with the 'fonts' build target.",
+        " */",
+        "",
+        "#include \"hal_font.h\"",
+        "#include <stddef.h>",
+        "",
+    ]
+
+    with open(args.output, "w") as f:
+        f.write("\n".join(header) + "\n" + "\n\n".join(sections) + "\n")
+
+
+if __name__ == "__main__":
+    main()
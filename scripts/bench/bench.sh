@@ -0,0 +1,63 @@
+#!/bin/bash
+
+# TweaknGeek host benchmarks
+# Builds the hardware-independent modules with the host compiler and runs
+# them against fixed inputs. Not part of the firmware build.
+#
+# Usage: bash scripts/bench/bench.sh [dsp|display|ipcc|cc1101|wifi|net|all]
+
+set -e
+
+ROOT="$(cd "$(dirname "$0")/../.." && pwd)"
+OUT_DIR="$ROOT/_bench"
+CC=${CC:-cc}
+CFLAGS="-std=c11 -O2 -Wall -Wextra -D_POSIX_C_SOURCE=199309L -I$ROOT/include -I$ROOT/src"
+WHICH=${1:-all}
+
+mkdir -p "$OUT_DIR"
+
+if [ "$WHICH" = "dsp" ] || [ "$WHICH" = "all" ]; then
+    echo "== Baseband demodulator (samples/s, bit errors, reference match) =="
+    $CC $CFLAGS -I"$ROOT/src/hal" -o "$OUT_DIR/dsp_bench" \
+        "$ROOT/scripts/bench/dsp_bench.c" "$ROOT/src/hal/hal_radio_dsp.c"
+    "$OUT_DIR/dsp_bench" "$ROOT"/scripts/bench/samples/*.tngs
+    if command -v python3 &> /dev/null; then
+        python3 "$ROOT/scripts/dsp_reference.py" decode "$ROOT"/scripts/bench/samples/*.tngs
+    fi
+fi
+
+if [ "$WHICH" = "display" ] || [ "$WHICH" = "all" ]; then
+    echo "== Display rectangle and line fills (pixels/s, model match) =="
+    $CC $CFLAGS -I"$ROOT/src/hal" -o "$OUT_DIR/display_bench" \
+        "$ROOT/scripts/bench/display_bench.c" "$ROOT/src/hal/hal_display.c" "$ROOT/src/hal/hal_font_data.c"
+    "$OUT_DIR/display_bench"
+fi
+
+if [ "$WHICH" = "ipcc" ] || [ "$WHICH" = "all" ]; then
+    echo "== Mailbox transport against a simulated CPU2 (round trips, events/s, coalescing) =="
+    $CC $CFLAGS -DHAL_IPCC_SIMULATOR -I"$ROOT/src/hal" -I"$ROOT/scripts/bench" -o "$OUT_DIR/ipcc_bench" \
+        "$ROOT/scripts/bench/ipcc_bench.c" "$ROOT/scripts/bench/ipcc_sim.c" "$ROOT/src/hal/hal_ipcc.c"
+    "$OUT_DIR/ipcc_bench"
+fi
+
+if [ "$WHICH" = "cc1101" ] || [ "$WHICH" = "all" ]; then
+    echo "== CC1101 driver against a simulated chip (packets past the FIFO, length switch, register deltas) =="
+    $CC $CFLAGS -DHAL_CC1101_SIMULATOR -I"$ROOT/src/hal" -I"$ROOT/scripts/bench" -o "$OUT_DIR/cc1101_bench" \
+        "$ROOT/scripts/bench/cc1101_bench.c" "$ROOT/scripts/bench/cc1101_sim.c" "$ROOT/src/hal/hal_radio_cc1101.c"
+    "$OUT_DIR/cc1101_bench"
+fi
+
+if [ "$WHICH" = "wifi" ] || [ "$WHICH" = "all" ]; then
+    echo "== WiFi emulation over a loopback link (frames/s, fragment echo, sharing, link drop) =="
+    $CC $CFLAGS -I"$ROOT/src/applications" -I"$ROOT/scripts/bench" -o "$OUT_DIR/wifi_bench" \
+        "$ROOT/scripts/bench/wifi_bench.c" "$ROOT/scripts/bench/l2cap_loop.c" "$ROOT/src/applications/wifi_emu.c"
+    "$OUT_DIR/wifi_bench"
+fi
+
+if [ "$WHICH" = "net" ] || [ "$WHICH" = "all" ]; then
+    echo "== TCP over the WiFi emulation loopback (goodput under frame loss, window probes, reset on close) =="
+    $CC $CFLAGS -I"$ROOT/src/applications" -I"$ROOT/scripts/bench" -o "$OUT_DIR/net_bench" \
+        "$ROOT/scripts/bench/net_bench.c" "$ROOT/scripts/bench/l2cap_loop.c" \
+        "$ROOT/src/applications/wifi_emu.c" "$ROOT/src/applications/net_stack.c" "$ROOT/src/applications/net_tcp.c"
+    "$OUT_DIR/net_bench"
+fi
@@ -0,0 +1,383 @@
+/**
+ * @file cc1101_bench.c
+ * @brief Host benchmark for the CC1101 driver against a model of the chip
+ *
+ * Runs src/hal/hal_radio_cc1101.c built with HAL_CC1101_SIMULATOR (see
+ * cc1101_sim.h) through reset, configuration and packets longer than the
+ * 64-byte FIFOs in variable, fixed and infinite length mode, each way.
+ * Checks the bytes on air and in the caller's buffer, that the FIFO
+ * threshold interrupts kept up, that packets over 255 bytes switched to
+ * fixed length once, that lengths needing PKTLEN = 0 are refused before
+ * any FIFO traffic, and that configuration and per-packet register writes
+ * only touch what changed. Host numbers show driver cost per packet only;
+ * link times come from the model's byte clock.
+ *
+ * Usage: cc1101_bench [-n COUNT]
+ */
+
+#include "hal_radio_internal.h"
+#include "cc1101_sim.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_MAX_PACKET            1000
+#define BENCH_RX_TIMEOUT_MS         1000
+
+/**
+ * @brief One packet case
+ */
+typedef struct {
+    const char *name;
+    hal_radio_packet_format_t format;
+    uint16_t length;
+    uint32_t length_switches;       /* Expected infinite to fixed switches */
+} bench_case_t;
+
+static const bench_case_t bench_cases[] = {
+    { "variable 200", HAL_RADIO_PACKET_VARIABLE_LENGTH, 200, 0 },
+    { "variable 255", HAL_RADIO_PACKET_VARIABLE_LENGTH, 255, 0 },
+    { "fixed 65", HAL_RADIO_PACKET_FIXED_LENGTH, 65, 0 },
+    { "fixed 200", HAL_RADIO_PACKET_FIXED_LENGTH, 200, 0 },
+    { "infinite 600", HAL_RADIO_PACKET_FIXED_LENGTH, 600, 1 },
+    { "infinite 1000", HAL_RADIO_PACKET_FIXED_LENGTH, 1000, 1 }
+};
+
+static hal_radio_instance_t bench_radio;
+static uint8_t bench_payload[BENCH_MAX_PACKET];
+static uint8_t bench_buffer[BENCH_MAX_PACKET];
+static uint8_t bench_air[BENCH_MAX_PACKET + 1];
+static uint32_t bench_events[HAL_RADIO_EVENT_MAX];
+
+/* Static function prototypes */
+static void bench_event(uint32_t radio_id, hal_radio_event_t event, void *data, void *user_data);
+static void bench_fill(uint16_t length, uint32_t seed);
+static int bench_configure(const hal_radio_config_t *config);
+static int bench_transmit(const bench_case_t *test);
+static int bench_receive(const bench_case_t *test);
+static int bench_pktlen_zero(void);
+static int bench_repeat(uint32_t count);
+static double bench_now(void);
+
+int main(int argc, char **argv)
+{
+    uint32_t count = 200;
+    int failed = 0;
+
+    if (argc == 3 && strcmp(argv[1], "-n") == 0) {
+        count = (uint32_t)strtoul(argv[2], NULL, 0);
+    } else if (argc != 1) {
+        fprintf(stderr, "usage: %s [-n COUNT]\n", argv[0]);
+        return 2;
+    }
+    if (count == 0) {
+        return 2;
+    }
+
+    hal_radio_config_t config = {
+        .type = HAL_RADIO_TYPE_CC1101,
+        .frequency_hz = 433920000,
+        .data_rate_bps = 38400,
+        .modulation = HAL_RADIO_MODULATION_GFSK,
+        .power_level = HAL_RADIO_POWER_HIGH,
+        .deviation_hz = 20000,
+        .bandwidth_hz = 100000,
+        .packet_format = HAL_RADIO_PACKET_VARIABLE_LENGTH,
+        .sync_word = { 0xD3, 0x91 },
+        .sync_word_length = 2,
+        .crc_enabled = true,
+        .whitening_enabled = false
+    };
+    cc1101_sim_stats_t sim;
+
+    bench_radio.type = HAL_RADIO_TYPE_CC1101;
+    bench_radio.callback = bench_event;
+    if (cc1101_init(&bench_radio) != HAL_OK) {
+        fprintf(stderr, "cc1101_init failed\n");
+        return 1;
+    }
+    cc1101_sim_get_stats(&sim);
+    printf("reset and register file: %u SPI frames, %u registers in %u bursts\n", (unsigned)sim.transactions,
+           (unsigned)sim.register_writes, (unsigned)sim.register_bursts);
+
+    failed |= bench_configure(&config);
+
+    for (uint32_t i = 0; i < sizeof(bench_cases) / sizeof(bench_cases[0]); i++) {
+        failed |= bench_transmit(&bench_cases[i]);
+    }
+    for (uint32_t i = 0; i < sizeof(bench_cases) / sizeof(bench_cases[0]); i++) {
+        failed |= bench_receive(&bench_cases[i]);
+    }
+    failed |= bench_pktlen_zero();
+    failed |= bench_repeat(count);
+
+    cc1101_sim_get_stats(&sim);
+    if (sim.fifo_misuse != 0) {
+        fprintf(stderr, "%u writes to a full TX FIFO or reads from an empty RX FIFO\n", (unsigned)sim.fifo_misuse);
+        failed = 1;
+    }
+
+    cc1101_deinit(&bench_radio);
+    return failed;
+}
+
+/* Static helper functions */
+
+static void bench_event(uint32_t radio_id, hal_radio_event_t event, void *data, void *user_data)
+{
+    (void)radio_id;
+    (void)data;
+    (void)user_data;
+
+    if (event < HAL_RADIO_EVENT_MAX) {
+        bench_events[event]++;
+    }
+}
+
+static void bench_fill(uint16_t length, uint32_t seed)
+{
+    uint32_t x = seed * 2654435761UL + length;
+
+    for (uint32_t i = 0; i < length; i++) {
+        x = x * 1664525UL + 1013904223UL;
+        bench_payload[i] = (uint8_t)(x >> 24);
+    }
+}
+
+/**
+ * @brief First configuration, then the same again, then deltas
+ */
+static int bench_configure(const hal_radio_config_t *config)
+{
+    hal_radio_config_t changed = *config;
+    cc1101_sim_stats_t sim;
+    uint8_t before[HAL_RADIO_CONTEXT_REGISTERS];
+    uint32_t differing = 0;
+
+    cc1101_sim_reset_stats();
+    if (cc1101_configure(&bench_radio, config) != HAL_OK) {
+        fprintf(stderr, "configure: refused\n");
+        return 1;
+    }
+    bench_radio.config = *config;
+    cc1101_sim_get_stats(&sim);
+    printf("configure: %u registers in %u bursts, %u PATABLE bytes\n", (unsigned)sim.register_writes,
+           (unsigned)sim.register_bursts, (unsigned)sim.patable_writes);
+
+    /* Nothing changed: no SPI traffic at all */
+    cc1101_sim_reset_stats();
+    cc1101_configure(&bench_radio, config);
+    cc1101_sim_get_stats(&sim);
+    printf("configure unchanged: %u SPI frames\n", (unsigned)sim.transactions);
+    if (sim.transactions != 0) {
+        fprintf(stderr, "configure unchanged: expected no SPI traffic\n");
+        return 1;
+    }
+
+    /* New frequency in the same band: only the frequency word, in one burst */
+    for (uint8_t addr = 0; addr < HAL_RADIO_CONTEXT_REGISTERS; addr++) {
+        before[addr] = cc1101_sim_register(addr);
+    }
+    changed.frequency_hz = 433000000;
+    cc1101_sim_reset_stats();
+    cc1101_configure(&bench_radio, &changed);
+    cc1101_sim_get_stats(&sim);
+    for (uint8_t addr = 0; addr < HAL_RADIO_CONTEXT_REGISTERS; addr++) {
+        differing += (cc1101_sim_register(addr) != before[addr]);
+    }
+    printf("configure frequency: %u registers in %u bursts for %u changed, %u PATABLE bytes\n",
+           (unsigned)sim.register_writes, (unsigned)sim.register_bursts, (unsigned)differing,
+           (unsigned)sim.patable_writes);
+    if (differing == 0 || sim.register_writes != differing || sim.register_bursts != 1 || sim.patable_writes != 0) {
+        fprintf(stderr, "configure frequency: expected only the changed registers in one burst\n");
+        return 1;
+    }
+
+    /* New power level: PATABLE only */
+    changed.power_level = HAL_RADIO_POWER_MAX;
+    cc1101_sim_reset_stats();
+    cc1101_configure(&bench_radio, &changed);
+    cc1101_sim_get_stats(&sim);
+    printf("configure power: %u registers, %u PATABLE bytes\n", (unsigned)sim.register_writes,
+           (unsigned)sim.patable_writes);
+    if (sim.register_writes != 0 || sim.patable_writes != 2) {
+        fprintf(stderr, "configure power: expected a PATABLE write only\n");
+        return 1;
+    }
+
+    if (cc1101_configure(&bench_radio, config) != HAL_OK) {
+        fprintf(stderr, "configure: refused going back\n");
+        return 1;
+    }
+    return 0;
+}
+
+static int bench_transmit(const bench_case_t *test)
+{
+    hal_radio_packet_t packet = { .data = bench_payload, .length = test->length };
+    bool variable = (test->format == HAL_RADIO_PACKET_VARIABLE_LENGTH);
+    cc1101_sim_stats_t sim;
+    const uint8_t *air;
+    uint32_t air_length;
+    uint32_t start = DWT_CYCCNT;
+
+    bench_fill(test->length, 1);
+    bench_radio.config.packet_format = test->format;
+    cc1101_sim_reset_stats();
+
+    hal_result_t result = cc1101_transmit(&bench_radio, &packet);
+    uint32_t cycles = DWT_CYCCNT - start;
+    cc1101_sim_get_stats(&sim);
+    air_length = cc1101_sim_tx_air(&air);
+
+    printf("TX %-13s %5.1f ms, %2u refills, FIFO peak %2u, %u length switch(es)\n", test->name,
+           cycles / (CPU_FREQUENCY_HZ / 1000.0), (unsigned)sim.gdo0_interrupts, (unsigned)sim.tx_fifo_peak,
+           (unsigned)sim.length_switches);
+
+    if (result != HAL_OK || sim.tx_packets != 1 || sim.tx_underflows != 0) {
+        fprintf(stderr, "TX %s: result %d, %u packets, %u underflows\n", test->name, (int)result,
+                (unsigned)sim.tx_packets, (unsigned)sim.tx_underflows);
+        return 1;
+    }
+    if (air_length != test->length + (variable ? 1U : 0U) || (variable && air[0] != test->length) ||
+        memcmp(&air[variable ? 1 : 0], bench_payload, test->length) != 0) {
+        fprintf(stderr, "TX %s: %u bytes on air do not match the packet\n", test->name, (unsigned)air_length);
+        return 1;
+    }
+    if (sim.length_switches != test->length_switches || sim.gdo0_interrupts == 0) {
+        fprintf(stderr, "TX %s: expected %u length switch(es) and threshold refills\n", test->name,
+                (unsigned)test->length_switches);
+        return 1;
+    }
+    return 0;
+}
+
+static int bench_receive(const bench_case_t *test)
+{
+    hal_radio_packet_t packet = { .data = bench_buffer, .length = test->length };
+    bool variable = (test->format == HAL_RADIO_PACKET_VARIABLE_LENGTH);
+    uint32_t completes = bench_events[HAL_RADIO_EVENT_RX_COMPLETE];
+    cc1101_sim_stats_t sim;
+    uint32_t start;
+
+    bench_fill(test->length, 2);
+    bench_air[0] = (uint8_t)test->length;
+    memcpy(&bench_air[variable ? 1 : 0], bench_payload, test->length);
+    memset(bench_buffer, 0, sizeof(bench_buffer));
+    if (variable) {
+        packet.length = 255;
+    }
+    bench_radio.config.packet_format = test->format;
+    cc1101_sim_queue_rx(bench_air, test->length + (variable ? 1U : 0U), true);
+    cc1101_sim_reset_stats();
+
+    start = DWT_CYCCNT;
+    hal_result_t result = cc1101_receive(&bench_radio, &packet, BENCH_RX_TIMEOUT_MS);
+    uint32_t cycles = DWT_CYCCNT - start;
+    cc1101_sim_get_stats(&sim);
+
+    printf("RX %-13s %5.1f ms, %2u drains, FIFO peak %2u, %u length switch(es)\n", test->name,
+           cycles / (CPU_FREQUENCY_HZ / 1000.0), (unsigned)sim.gdo0_interrupts, (unsigned)sim.rx_fifo_peak,
+           (unsigned)sim.length_switches);
+
+    if (result != HAL_OK || sim.rx_packets != 1 || sim.rx_overflows != 0 || sim.rx_filler != 0) {
+        fprintf(stderr, "RX %s: result %d, %u packets, %u overflows, %u bytes past the end\n", test->name,
+                (int)result, (unsigned)sim.rx_packets, (unsigned)sim.rx_overflows, (unsigned)sim.rx_filler);
+        return 1;
+    }
+    if (packet.length != test->length || memcmp(bench_buffer, bench_payload, test->length) != 0 ||
+        !packet.crc_ok || bench_events[HAL_RADIO_EVENT_RX_COMPLETE] != completes + 1U) {
+        fprintf(stderr, "RX %s: %u bytes received do not match the packet\n", test->name, (unsigned)packet.length);
+        return 1;
+    }
+    if (sim.length_switches != test->length_switches || sim.gdo0_interrupts == 0) {
+        fprintf(stderr, "RX %s: expected %u length switch(es) and threshold drains\n", test->name,
+                (unsigned)test->length_switches);
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Fixed lengths that are a multiple of 256 would need PKTLEN = 0
+ */
+static int bench_pktlen_zero(void)
+{
+    static const uint16_t lengths[] = { 256, 512 };
+    cc1101_sim_stats_t sim;
+    int failed = 0;
+
+    bench_radio.config.packet_format = HAL_RADIO_PACKET_FIXED_LENGTH;
+    for (uint32_t i = 0; i < sizeof(lengths) / sizeof(lengths[0]); i++) {
+        hal_radio_packet_t tx = { .data = bench_payload, .length = lengths[i] };
+        hal_radio_packet_t rx = { .data = bench_buffer, .length = lengths[i] };
+
+        cc1101_sim_reset_stats();
+        hal_result_t tx_result = cc1101_transmit(&bench_radio, &tx);
+        hal_result_t rx_result = cc1101_receive(&bench_radio, &rx, BENCH_RX_TIMEOUT_MS);
+        cc1101_sim_get_stats(&sim);
+
+        printf("PKTLEN 0 (%u bytes): TX %d, RX %d, %u FIFO bytes\n", (unsigned)lengths[i], (int)tx_result,
+               (int)rx_result, (unsigned)(sim.fifo_writes + sim.fifo_reads));
+        if (tx_result != HAL_ERROR_INVALID_PARAM || rx_result != HAL_ERROR_INVALID_PARAM ||
+            sim.fifo_writes != 0 || sim.fifo_reads != 0 || sim.tx_packets != 0) {
+            fprintf(stderr, "PKTLEN 0 (%u bytes): expected a refusal before any FIFO traffic\n",
+                    (unsigned)lengths[i]);
+            failed = 1;
+        }
+        if (cc1101_sim_register(0x06) == 0) {
+            fprintf(stderr, "PKTLEN 0 (%u bytes): PKTLEN was written\n", (unsigned)lengths[i]);
+            failed = 1;
+        }
+    }
+    return failed;
+}
+
+/**
+ * @brief The same packet back to back: no register writes after the first
+ */
+static int bench_repeat(uint32_t count)
+{
+    hal_radio_packet_t packet = { .data = bench_payload, .length = 600 };
+    cc1101_sim_stats_t sim;
+    uint64_t air_cycles = 0;
+
+    bench_fill(packet.length, 3);
+    bench_radio.config.packet_format = HAL_RADIO_PACKET_FIXED_LENGTH;
+    if (cc1101_transmit(&bench_radio, &packet) != HAL_OK) {
+        fprintf(stderr, "repeat: first packet failed\n");
+        return 1;
+    }
+
+    cc1101_sim_reset_stats();
+    double start = bench_now();
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t cycles = DWT_CYCCNT;
+        if (cc1101_transmit(&bench_radio, &packet) != HAL_OK) {
+            fprintf(stderr, "repeat: packet %u failed\n", (unsigned)i);
+            return 1;
+        }
+        air_cycles += DWT_CYCCNT - cycles;
+    }
+    double elapsed = bench_now() - start;
+    cc1101_sim_get_stats(&sim);
+
+    /* Each packet switches to fixed length at the end and back to infinite at the start */
+    printf("repeat 600 x %u: %.0f packets/s host, %.1f ms link, %u SPI frames and %u register writes per packet\n",
+           (unsigned)count, count / elapsed, air_cycles / (CPU_FREQUENCY_HZ / 1000.0) / count,
+           (unsigned)(sim.transactions / count), (unsigned)(sim.register_writes / count));
+    if (sim.tx_packets != count || sim.tx_underflows != 0 || sim.register_writes != 2U * count) {
+        fprintf(stderr, "repeat: expected only the length mode written, twice per packet\n");
+        return 1;
+    }
+    return 0;
+}
+
+static double bench_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
@@ -0,0 +1,878 @@
+/**
+ * @file cc1101_sim.c
+ * @brief Host model of the CC1101 register file, FIFOs and packet engine
+ *
+ * SPI follows the CC1101 header byte: strobes are single bytes, a burst
+ * walks consecutive registers or stays on the FIFO, and a single access
+ * takes one data byte before the next header. Status registers are read
+ * with the burst bit set. The packet engine sends or receives one byte
+ * per byte time after the preamble and sync word, and ends a packet on the
+ * length byte (variable), when the byte count modulo 256 reaches PKTLEN
+ * (fixed), or never (infinite), looking at PKTCTRL0 on every byte so a
+ * switch to fixed length mid-packet takes effect as on the chip. Two CRC
+ * byte times follow when CRC_EN is set; received packets then get the
+ * appended RSSI and LQI/CRC_OK bytes. The TX FIFO running dry underflows,
+ * the RX FIFO filling up overflows.
+ *
+ * GDO0 and GDO2 follow IOCFG0/IOCFG2 for the settings the driver uses:
+ * FIFO thresholds per FIFOTHR, and sync word until the end of the packet.
+ */
+
+#include "cc1101_sim.h"
+#include "hal_radio_internal.h"
+#include "hal_gpio.h"
+#include <string.h>
+
+/* Board wiring, as in hal_radio_cc1101.c */
+#define SIM_PIN_MISO                20
+#define SIM_PIN_CS                  48
+#define SIM_PIN_GDO0                1
+#define SIM_PIN_GDO2                2
+
+/* Registers and commands */
+#define SIM_IOCFG2                  0x00
+#define SIM_IOCFG0                  0x02
+#define SIM_FIFOTHR                 0x03
+#define SIM_PKTLEN                  0x06
+#define SIM_PKTCTRL1                0x07
+#define SIM_PKTCTRL0                0x08
+#define SIM_MDMCFG4                 0x10
+#define SIM_MDMCFG3                 0x11
+#define SIM_MDMCFG2                 0x12
+#define SIM_MDMCFG1                 0x13
+#define SIM_REGISTERS               0x2F
+#define SIM_SRES                    0x30
+#define SIM_SFSTXON                 0x31
+#define SIM_SXOFF                   0x32
+#define SIM_SCAL                    0x33
+#define SIM_SRX                     0x34
+#define SIM_STX                     0x35
+#define SIM_SIDLE                   0x36
+#define SIM_SWOR                    0x38
+#define SIM_SPWD                    0x39
+#define SIM_SFRX                    0x3A
+#define SIM_SFTX                    0x3B
+#define SIM_SNOP                    0x3D
+#define SIM_PARTNUM                 0x30
+#define SIM_VERSION                 0x31
+#define SIM_LQI                     0x33
+#define SIM_RSSI                    0x34
+#define SIM_MARCSTATE               0x35
+#define SIM_TXBYTES                 0x3A
+#define SIM_RXBYTES                 0x3B
+#define SIM_PATABLE                 0x3E
+#define SIM_FIFO                    0x3F
+
+#define SIM_LENGTH_MASK             0x03
+#define SIM_LENGTH_FIXED            0x00
+#define SIM_LENGTH_VARIABLE         0x01
+#define SIM_CRC_EN                  0x04
+#define SIM_APPEND_STATUS           0x04
+#define SIM_CRC_OK                  0x80
+#define SIM_FIFO_SIZE               64
+#define SIM_XOSC_HZ                 26000000ULL
+#define SIM_CHIP_VERSION            0x14
+
+/* MARCSTATE values the model goes through */
+#define SIM_MARC_SLEEP              0x00
+#define SIM_MARC_IDLE               0x01
+#define SIM_MARC_RX                 0x0D
+#define SIM_MARC_RXFIFO_OVERFLOW    0x11
+#define SIM_MARC_FSTXON             0x12
+#define SIM_MARC_TX                 0x13
+#define SIM_MARC_TXFIFO_UNDERFLOW   0x16
+
+#define SIM_RSSI_RAW                0xE8    /* -86 dBm: a clear channel */
+#define SIM_LQI_VALUE               0x12
+
+/* Time per driver step, in core cycles */
+#define SIM_POLL_CYCLES             64                              /* One cycle counter read */
+#define SIM_SPI_BYTE_CYCLES         (CPU_FREQUENCY_HZ / 500000UL)  /* 8 bits at 4 MHz */
+
+/**
+ * @brief Where the packet engine is
+ */
+typedef enum {
+    SIM_AIR_OFF = 0,
+    SIM_AIR_LISTEN,                 /* RX with nothing queued to arrive */
+    SIM_AIR_SYNC,                   /* Preamble and sync word */
+    SIM_AIR_DATA,
+    SIM_AIR_CRC
+} sim_air_t;
+
+/**
+ * @brief GDO line wired to an EXTI input
+ */
+typedef struct {
+    uint32_t pin;
+    uint8_t iocfg;                  /* Register that drives it */
+    bool level;
+    bool pending;
+    hal_gpio_trigger_t trigger;
+    hal_gpio_interrupt_callback_t callback;
+    void *user_data;
+} sim_line_t;
+
+/* Chip */
+static uint8_t sim_regs[SIM_REGISTERS];
+static uint8_t sim_patable[8];
+static uint8_t sim_state = SIM_MARC_IDLE;
+
+/* SPI */
+static bool sim_selected;
+static bool sim_header_next;
+static uint8_t sim_addr;
+static bool sim_read;
+static bool sim_burst;
+static bool sim_frame_registers;    /* This frame has written a configuration register */
+static uint8_t sim_patable_index;
+
+/* FIFOs */
+static uint8_t sim_tx_fifo[SIM_FIFO_SIZE];
+static uint8_t sim_rx_fifo[SIM_FIFO_SIZE];
+static uint32_t sim_tx_head;
+static uint32_t sim_tx_count;
+static uint32_t sim_rx_head;
+static uint32_t sim_rx_count;
+static bool sim_tx_underflow;
+static bool sim_rx_overflow;
+
+/* Packet engine */
+static uint64_t sim_clock;
+static uint8_t sim_air;
+static bool sim_air_tx;
+static uint64_t sim_air_due;
+static uint32_t sim_byte_cycles;
+static uint32_t sim_air_count;      /* Bytes since the sync word */
+static uint32_t sim_air_end;        /* Variable length: 1 + length byte, once known */
+static uint32_t sim_crc_left;
+static uint8_t sim_tx_air[CC1101_SIM_AIR_MAX];
+static uint32_t sim_tx_air_length;
+static uint8_t sim_rx_air[CC1101_SIM_AIR_MAX];
+static uint32_t sim_rx_air_length;
+static bool sim_rx_pending;
+static bool sim_rx_crc_ok;
+
+/* Interrupts and the deadline timer */
+static sim_line_t sim_lines[] = {
+    { SIM_PIN_GDO0, SIM_IOCFG0, false, false, HAL_GPIO_TRIGGER_NONE, NULL, NULL },
+    { SIM_PIN_GDO2, SIM_IOCFG2, false, false, HAL_GPIO_TRIGGER_NONE, NULL, NULL }
+};
+static bool sim_locked;
+static bool sim_in_irq;
+static struct {
+    bool armed;
+    uint32_t at_us;
+    hal_radio_timer_callback_t callback;
+    void *user_data;
+} sim_timers[HAL_RADIO_TIMER_CHANNELS];
+
+static cc1101_sim_stats_t sim_stats;
+
+/* Register values after SRES */
+static const uint8_t sim_reset_registers[SIM_REGISTERS] = {
+    0x29, 0x2E, 0x3F, 0x07, 0xD3, 0x91, 0xFF, 0x04, 0x45, 0x00, 0x00, 0x0F,
+    0x00, 0x1E, 0xC4, 0xEC, 0x8C, 0x22, 0x02, 0x22, 0xF8, 0x47, 0x07, 0x30,
+    0x04, 0x36, 0x6C, 0x03, 0x40, 0x91, 0x87, 0x6B, 0xF8, 0x56, 0x10, 0xA9,
+    0x0A, 0x20, 0x0D, 0x41, 0x00, 0x59, 0x7F, 0x3F, 0x88, 0x31, 0x0B
+};
+
+/* Static function prototypes */
+static void sim_advance(uint32_t cycles);
+static void sim_dispatch(void);
+static void sim_strobe(uint8_t command);
+static uint8_t sim_data(uint8_t value);
+static uint8_t sim_status_byte(void);
+static uint8_t sim_status_register(uint8_t addr);
+static void sim_write_register(uint8_t addr, uint8_t value);
+static void sim_start(bool tx);
+static void sim_stop(uint8_t state);
+static void sim_run_air(void);
+static void sim_tx_byte(void);
+static void sim_rx_byte(void);
+static void sim_byte_done(uint8_t value);
+static void sim_end_packet(void);
+static void sim_update_lines(void);
+static bool sim_gdo_level(uint8_t iocfg);
+static sim_line_t *sim_line(uint32_t pin);
+
+uint32_t cc1101_sim_cycles(void)
+{
+    sim_advance(SIM_POLL_CYCLES);
+    return (uint32_t)sim_clock;
+}
+
+uint8_t cc1101_sim_exchange(uint8_t value)
+{
+    sim_advance(SIM_SPI_BYTE_CYCLES);
+    if (!sim_selected) {
+        return 0xFF;
+    }
+
+    if (sim_header_next) {
+        uint8_t status;
+
+        sim_addr = value & 0x3F;
+        sim_read = (value & 0x80) != 0;
+        sim_burst = (value & 0x40) != 0;
+        sim_patable_index = 0;
+        status = sim_status_byte();
+        sim_header_next = false;
+
+        if (sim_addr >= SIM_SRES && sim_addr <= SIM_SNOP && !sim_burst) {
+            sim_stats.strobes++;
+            sim_strobe(sim_addr);
+            sim_header_next = true;
+        }
+        return status;
+    }
+
+    uint8_t out = sim_data(value);
+    if (!sim_burst) {
+        sim_header_next = true;
+    }
+    return out;
+}
+
+uint32_t cc1101_sim_tx_air(const uint8_t **data)
+{
+    *data = sim_tx_air;
+    return sim_tx_air_length;
+}
+
+void cc1101_sim_queue_rx(const uint8_t *air, uint32_t length, bool crc_ok)
+{
+    if (length > CC1101_SIM_AIR_MAX) {
+        length = CC1101_SIM_AIR_MAX;
+    }
+    memcpy(sim_rx_air, air, length);
+    sim_rx_air_length = length;
+    sim_rx_crc_ok = crc_ok;
+    sim_rx_pending = true;
+}
+
+uint8_t cc1101_sim_register(uint8_t addr)
+{
+    return (addr < SIM_REGISTERS) ? sim_regs[addr] : 0;
+}
+
+void cc1101_sim_get_stats(cc1101_sim_stats_t *stats)
+{
+    *stats = sim_stats;
+}
+
+void cc1101_sim_reset_stats(void)
+{
+    memset(&sim_stats, 0, sizeof(sim_stats));
+}
+
+/* GPIO calls hal_radio_cc1101.c makes: chip select frames SPI accesses, MISO is CHIP_RDYn */
+
+hal_result_t hal_gpio_reserve_pin(uint32_t pin, const char *owner_name)
+{
+    (void)pin;
+    (void)owner_name;
+    return HAL_OK;
+}
+
+hal_result_t hal_gpio_release_pin(uint32_t pin)
+{
+    (void)pin;
+    return HAL_OK;
+}
+
+hal_result_t hal_gpio_configure_pin(const hal_gpio_config_t *config)
+{
+    return (config != NULL) ? HAL_OK : HAL_ERROR_INVALID_PARAM;
+}
+
+hal_result_t hal_gpio_set_pin(uint32_t pin, hal_gpio_state_t state)
+{
+    if (pin != SIM_PIN_CS) {
+        return HAL_OK;
+    }
+
+    if (state == HAL_GPIO_STATE_LOW) {
+        if (!sim_selected) {
+            sim_stats.transactions++;
+        }
+        sim_selected = true;
+        sim_header_next = true;
+        sim_frame_registers = false;
+        if (sim_state == SIM_MARC_SLEEP) {
+            /* Chip select wakes the chip */
+            sim_state = SIM_MARC_IDLE;
+        }
+    } else {
+        sim_selected = false;
+        sim_dispatch();
+    }
+    return HAL_OK;
+}
+
+hal_result_t hal_gpio_get_pin(uint32_t pin, hal_gpio_state_t *state)
+{
+    const sim_line_t *line = sim_line(pin);
+
+    if (pin == SIM_PIN_MISO) {
+        *state = sim_selected ? HAL_GPIO_STATE_LOW : HAL_GPIO_STATE_HIGH;
+    } else if (line != NULL) {
+        *state = line->level ? HAL_GPIO_STATE_HIGH : HAL_GPIO_STATE_LOW;
+    } else {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+    return HAL_OK;
+}
+
+hal_result_t hal_gpio_enable_interrupt(uint32_t pin, hal_gpio_trigger_t trigger,
+                                       hal_gpio_interrupt_callback_t callback, void *user_data)
+{
+    sim_line_t *line = sim_line(pin);
+
+    if (line == NULL || callback == NULL) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+    line->trigger = trigger;
+    line->callback = callback;
+    line->user_data = user_data;
+    line->pending = false;
+    return HAL_OK;
+}
+
+hal_result_t hal_gpio_disable_interrupt(uint32_t pin)
+{
+    sim_line_t *line = sim_line(pin);
+
+    if (line == NULL) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+    line->callback = NULL;
+    line->pending = false;
+    return HAL_OK;
+}
+
+/* Radio HAL calls the driver makes; raw capture and sampling are not modelled */
+
+void hal_radio_notify(hal_radio_instance_t *instance, hal_radio_event_t event, void *data)
+{
+    if (instance->callback != NULL) {
+        instance->callback(instance->radio_id, event, data, instance->callback_user_data);
+    }
+}
+
+uint32_t hal_radio_lock(void)
+{
+    uint32_t state = sim_locked;
+
+    sim_locked = true;
+    return state;
+}
+
+void hal_radio_unlock(uint32_t primask)
+{
+    sim_locked = (primask != 0);
+    sim_dispatch();
+}
+
+uint32_t hal_radio_timer_now(void)
+{
+    sim_advance(SIM_POLL_CYCLES);
+    return (uint32_t)(sim_clock / (CPU_FREQUENCY_HZ / 1000000UL));
+}
+
+void hal_radio_timer_arm(uint32_t channel, uint32_t at_us, hal_radio_timer_callback_t callback, void *user_data)
+{
+    if (channel < HAL_RADIO_TIMER_CHANNELS) {
+        sim_timers[channel].at_us = at_us;
+        sim_timers[channel].callback = callback;
+        sim_timers[channel].user_data = user_data;
+        sim_timers[channel].armed = true;
+    }
+}
+
+void hal_radio_timer_cancel(uint32_t channel)
+{
+    if (channel < HAL_RADIO_TIMER_CHANNELS) {
+        sim_timers[channel].armed = false;
+    }
+}
+
+hal_result_t hal_radio_capture_begin(hal_radio_instance_t *instance)
+{
+    (void)instance;
+    return HAL_ERROR_NOT_SUPPORTED;
+}
+
+void hal_radio_capture_end(hal_radio_instance_t *instance)
+{
+    (void)instance;
+}
+
+void hal_radio_capture_edge(bool high, uint32_t duration_us)
+{
+    (void)high;
+    (void)duration_us;
+}
+
+hal_result_t hal_radio_sampler_begin(hal_radio_instance_t *instance, uint32_t pin, uint32_t sample_rate_hz)
+{
+    (void)instance;
+    (void)pin;
+    (void)sample_rate_hz;
+    return HAL_ERROR_NOT_SUPPORTED;
+}
+
+void hal_radio_sampler_end(hal_radio_instance_t *instance)
+{
+    (void)instance;
+}
+
+/* Static helper functions */
+
+/**
+ * @brief Move time on, let the packet engine catch up and take interrupts
+ */
+static void sim_advance(uint32_t cycles)
+{
+    sim_clock += cycles;
+    sim_run_air();
+    sim_dispatch();
+}
+
+/**
+ * @brief Run pending GDO and timer interrupts, one at a time, unless held off
+ */
+static void sim_dispatch(void)
+{
+    bool again = true;
+
+    while (again && !sim_selected && !sim_locked && !sim_in_irq) {
+        uint32_t now_us = (uint32_t)(sim_clock / (CPU_FREQUENCY_HZ / 1000000UL));
+
+        again = false;
+        for (uint32_t i = 0; i < sizeof(sim_lines) / sizeof(sim_lines[0]) && !again; i++) {
+            sim_line_t *line = &sim_lines[i];
+            if (line->pending && line->callback != NULL) {
+                line->pending = false;
+                if (line->pin == SIM_PIN_GDO0) {
+                    sim_stats.gdo0_interrupts++;
+                } else {
+                    sim_stats.gdo2_interrupts++;
+                }
+                sim_in_irq = true;
+                line->callback(line->pin, line->user_data);
+                sim_in_irq = false;
+                again = true;
+            }
+        }
+        for (uint32_t i = 0; i < HAL_RADIO_TIMER_CHANNELS && !again; i++) {
+            if (sim_timers[i].armed && (int32_t)(now_us - sim_timers[i].at_us) >= 0) {
+                sim_timers[i].armed = false;
+                sim_in_irq = true;
+                sim_timers[i].callback(sim_timers[i].user_data);
+                sim_in_irq = false;
+                again = true;
+            }
+        }
+    }
+}
+
+static void sim_strobe(uint8_t command)
+{
+    switch (command) {
+        case SIM_SRES:
+            memcpy(sim_regs, sim_reset_registers, sizeof(sim_regs));
+            memset(sim_patable, 0, sizeof(sim_patable));
+            sim_patable[0] = 0xC6;
+            sim_tx_count = 0;
+            sim_rx_count = 0;
+            sim_tx_underflow = false;
+            sim_rx_overflow = false;
+            sim_stop(SIM_MARC_IDLE);
+            break;
+
+        case SIM_SFSTXON:
+            if (sim_state == SIM_MARC_IDLE) {
+                sim_state = SIM_MARC_FSTXON;
+            }
+            break;
+
+        case SIM_SRX:
+        case SIM_SWOR:
+            /* Wake-on-radio is modelled as receiving straight away */
+            if (sim_state == SIM_MARC_IDLE || sim_state == SIM_MARC_FSTXON) {
+                sim_start(false);
+            }
+            break;
+
+        case SIM_STX:
+            /* From RX the channel is always clear */
+            if (sim_state == SIM_MARC_IDLE || sim_state == SIM_MARC_FSTXON || sim_state == SIM_MARC_RX) {
+                sim_start(true);
+            }
+            break;
+
+        case SIM_SIDLE:
+            sim_stop(SIM_MARC_IDLE);
+            break;
+
+        case SIM_SXOFF:
+        case SIM_SPWD:
+            if (sim_state == SIM_MARC_IDLE) {
+                sim_state = SIM_MARC_SLEEP;
+            }
+            break;
+
+        case SIM_SFRX:
+            if (sim_state == SIM_MARC_IDLE || sim_state == SIM_MARC_RXFIFO_OVERFLOW) {
+                sim_rx_count = 0;
+                sim_rx_overflow = false;
+                sim_state = SIM_MARC_IDLE;
+            }
+            break;
+
+        case SIM_SFTX:
+            if (sim_state == SIM_MARC_IDLE || sim_state == SIM_MARC_TXFIFO_UNDERFLOW) {
+                sim_tx_count = 0;
+                sim_tx_underflow = false;
+                sim_state = SIM_MARC_IDLE;
+            }
+            break;
+
+        case SIM_SCAL:
+        case SIM_SNOP:
+        default:
+            break;
+    }
+
+    sim_update_lines();
+}
+
+/**
+ * @brief One data byte of an access
+ */
+static uint8_t sim_data(uint8_t value)
+{
+    uint8_t out = sim_status_byte();
+
+    if (sim_addr == SIM_FIFO) {
+        if (sim_read) {
+            if (sim_rx_count == 0) {
+                sim_stats.fifo_misuse++;
+                return 0;
+            }
+            out = sim_rx_fifo[sim_rx_head];
+            sim_rx_head = (sim_rx_head + 1) % SIM_FIFO_SIZE;
+            sim_rx_count--;
+            sim_stats.fifo_reads++;
+        } else if (sim_tx_count == SIM_FIFO_SIZE) {
+            sim_stats.fifo_misuse++;
+        } else {
+            sim_tx_fifo[(sim_tx_head + sim_tx_count) % SIM_FIFO_SIZE] = value;
+            sim_tx_count++;
+            sim_stats.fifo_writes++;
+            if (sim_state == SIM_MARC_TX && sim_tx_count > sim_stats.tx_fifo_peak) {
+                sim_stats.tx_fifo_peak = sim_tx_count;
+            }
+        }
+        sim_update_lines();
+        return out;
+    }
+
+    if (sim_addr == SIM_PATABLE) {
+        uint8_t index = sim_patable_index++ & 7;
+        if (sim_read) {
+            return sim_patable[index];
+        }
+        sim_patable[index] = value;
+        sim_stats.patable_writes++;
+        return out;
+    }
+
+    if (sim_addr >= SIM_SRES) {
+        sim_stats.status_reads++;
+        out = sim_read ? sim_status_register(sim_addr) : out;
+    } else if (sim_addr < SIM_REGISTERS) {
+        if (sim_read) {
+            out = sim_regs[sim_addr];
+        } else {
+            if (!sim_frame_registers) {
+                sim_frame_registers = true;
+                sim_stats.register_bursts++;
+            }
+            sim_write_register(sim_addr, value);
+        }
+    }
+
+    if (sim_burst && sim_addr < SIM_SRES) {
+        sim_addr++;
+    }
+    return out;
+}
+
+/**
+ * @brief Chip status byte: CHIP_RDYn low, state, FIFO bytes available
+ */
+static uint8_t sim_status_byte(void)
+{
+    uint8_t state;
+    uint32_t available;
+
+    switch (sim_state) {
+        case SIM_MARC_RX:               state = 1; break;
+        case SIM_MARC_TX:               state = 2; break;
+        case SIM_MARC_FSTXON:           state = 3; break;
+        case SIM_MARC_RXFIFO_OVERFLOW:  state = 6; break;
+        case SIM_MARC_TXFIFO_UNDERFLOW: state = 7; break;
+        default:                        state = 0; break;
+    }
+
+    available = sim_read ? sim_rx_count : SIM_FIFO_SIZE - sim_tx_count;
+    return (uint8_t)((state << 4) | ((available > 15) ? 15 : available));
+}
+
+static uint8_t sim_status_register(uint8_t addr)
+{
+    switch (addr) {
+        case SIM_PARTNUM:   return 0x00;
+        case SIM_VERSION:   return SIM_CHIP_VERSION;
+        case SIM_LQI:       return SIM_LQI_VALUE | (sim_rx_crc_ok ? SIM_CRC_OK : 0);
+        case SIM_RSSI:      return SIM_RSSI_RAW;
+        case SIM_MARCSTATE: return sim_state;
+        case SIM_TXBYTES:   return (uint8_t)((sim_tx_underflow ? 0x80 : 0) | sim_tx_count);
+        case SIM_RXBYTES:   return (uint8_t)((sim_rx_overflow ? 0x80 : 0) | sim_rx_count);
+        default:            return 0;
+    }
+}
+
+static void sim_write_register(uint8_t addr, uint8_t value)
+{
+    bool on_air = (sim_air == SIM_AIR_SYNC || sim_air == SIM_AIR_DATA);
+
+    if (addr == SIM_PKTCTRL0 && on_air && ((sim_regs[addr] ^ value) & SIM_LENGTH_MASK) != 0) {
+        sim_stats.length_switches++;
+    }
+    sim_regs[addr] = value;
+    sim_stats.register_writes++;
+    sim_update_lines();
+}
+
+/**
+ * @brief Enter TX or RX: preamble and sync word first
+ */
+static void sim_start(bool tx)
+{
+    static const uint8_t preamble[8] = { 2, 3, 4, 6, 8, 12, 16, 24 };
+    uint32_t e = sim_regs[SIM_MDMCFG4] & 0x0F;
+    uint64_t rate = (((256ULL + sim_regs[SIM_MDMCFG3]) << e) * SIM_XOSC_HZ) >> 28;
+    uint32_t sync_mode = sim_regs[SIM_MDMCFG2] & 0x03;
+    uint32_t header = preamble[(sim_regs[SIM_MDMCFG1] >> 4) & 0x07] + ((sync_mode == 3) ? 4U : (sync_mode ? 2U : 0U));
+
+    sim_byte_cycles = (uint32_t)((uint64_t)CPU_FREQUENCY_HZ * 8 / (rate ? rate : 1));
+    sim_air_tx = tx;
+    sim_air_count = 0;
+    sim_air_end = 0;
+    sim_air_due = sim_clock + (uint64_t)header * sim_byte_cycles;
+    sim_state = tx ? SIM_MARC_TX : SIM_MARC_RX;
+
+    if (tx) {
+        sim_tx_air_length = 0;
+        sim_air = SIM_AIR_SYNC;
+    } else {
+        sim_air = sim_rx_pending ? SIM_AIR_SYNC : SIM_AIR_LISTEN;
+    }
+    sim_update_lines();
+}
+
+static void sim_stop(uint8_t state)
+{
+    sim_air = SIM_AIR_OFF;
+    sim_state = state;
+    sim_update_lines();
+}
+
+static void sim_run_air(void)
+{
+    while ((sim_air == SIM_AIR_SYNC || sim_air == SIM_AIR_DATA || sim_air == SIM_AIR_CRC) &&
+           sim_clock >= sim_air_due) {
+        sim_air_due += sim_byte_cycles;
+
+        if (sim_air == SIM_AIR_SYNC) {
+            sim_air = SIM_AIR_DATA;
+            sim_update_lines();
+        } else if (sim_air == SIM_AIR_CRC) {
+            if (--sim_crc_left == 0) {
+                sim_end_packet();
+            }
+        } else if (sim_air_tx) {
+            sim_tx_byte();
+        } else {
+            sim_rx_byte();
+        }
+    }
+}
+
+static void sim_tx_byte(void)
+{
+    if (sim_tx_count == 0) {
+        sim_tx_underflow = true;
+        sim_stats.tx_underflows++;
+        sim_stop(SIM_MARC_TXFIFO_UNDERFLOW);
+        return;
+    }
+
+    uint8_t value = sim_tx_fifo[sim_tx_head];
+    sim_tx_head = (sim_tx_head + 1) % SIM_FIFO_SIZE;
+    sim_tx_count--;
+    if (sim_tx_air_length < CC1101_SIM_AIR_MAX) {
+        sim_tx_air[sim_tx_air_length++] = value;
+    }
+    sim_byte_done(value);
+}
+
+static void sim_rx_byte(void)
+{
+    uint8_t value = 0;
+
+    if (sim_air_count < sim_rx_air_length) {
+        value = sim_rx_air[sim_air_count];
+    } else {
+        sim_stats.rx_filler++;
+    }
+
+    if (sim_rx_count == SIM_FIFO_SIZE) {
+        sim_rx_overflow = true;
+        sim_rx_pending = false;
+        sim_stats.rx_overflows++;
+        sim_stop(SIM_MARC_RXFIFO_OVERFLOW);
+        return;
+    }
+
+    /* A length byte over PKTLEN drops the packet and the chip keeps listening */
+    if (sim_air_count == 0 && (sim_regs[SIM_PKTCTRL0] & SIM_LENGTH_MASK) == SIM_LENGTH_VARIABLE &&
+        value > sim_regs[SIM_PKTLEN]) {
+        sim_rx_pending = false;
+        sim_air = SIM_AIR_LISTEN;
+        sim_update_lines();
+        return;
+    }
+
+    sim_rx_fifo[(sim_rx_head + sim_rx_count) % SIM_FIFO_SIZE] = value;
+    sim_rx_count++;
+    if (sim_rx_count > sim_stats.rx_fifo_peak) {
+        sim_stats.rx_fifo_peak = sim_rx_count;
+    }
+    sim_byte_done(value);
+}
+
+/**
+ * @brief Count a byte against the length mode in force now
+ */
+static void sim_byte_done(uint8_t value)
+{
+    uint8_t mode = sim_regs[SIM_PKTCTRL0] & SIM_LENGTH_MASK;
+    bool done;
+
+    sim_air_count++;
+    if (mode == SIM_LENGTH_VARIABLE) {
+        if (sim_air_count == 1) {
+            sim_air_end = 1U + value;
+        }
+        done = (sim_air_count == sim_air_end);
+    } else if (mode == SIM_LENGTH_FIXED) {
+        done = ((sim_air_count & 0xFF) == sim_regs[SIM_PKTLEN]);
+    } else {
+        done = false;
+    }
+
+    if (done) {
+        if (sim_regs[SIM_PKTCTRL0] & SIM_CRC_EN) {
+            sim_crc_left = 2;
+            sim_air = SIM_AIR_CRC;
+        } else {
+            sim_end_packet();
+        }
+    }
+    sim_update_lines();
+}
+
+/**
+ * @brief Packet over: status bytes after RX, then IDLE as MCSM1 asks for
+ */
+static void sim_end_packet(void)
+{
+    if (sim_air_tx) {
+        sim_stats.tx_packets++;
+    } else {
+        uint8_t status[2] = { SIM_RSSI_RAW, (uint8_t)(SIM_LQI_VALUE | (sim_rx_crc_ok ? SIM_CRC_OK : 0)) };
+
+        sim_rx_pending = false;
+        sim_stats.rx_packets++;
+        for (uint32_t i = 0; i < sizeof(status) && (sim_regs[SIM_PKTCTRL1] & SIM_APPEND_STATUS); i++) {
+            if (sim_rx_count < SIM_FIFO_SIZE) {
+                sim_rx_fifo[(sim_rx_head + sim_rx_count) % SIM_FIFO_SIZE] = status[i];
+                sim_rx_count++;
+            }
+        }
+    }
+
+    sim_stop(SIM_MARC_IDLE);
+}
+
+/**
+ * @brief Work out the GDO levels and latch edges for enabled interrupts
+ */
+static void sim_update_lines(void)
+{
+    for (uint32_t i = 0; i < sizeof(sim_lines) / sizeof(sim_lines[0]); i++) {
+        sim_line_t *line = &sim_lines[i];
+        bool level = sim_gdo_level(sim_regs[line->iocfg]);
+
+        if (level == line->level) {
+            continue;
+        }
+        line->level = level;
+        if (line->callback != NULL &&
+            (line->trigger == HAL_GPIO_TRIGGER_BOTH ||
+             (line->trigger == HAL_GPIO_TRIGGER_RISING && level) ||
+             (line->trigger == HAL_GPIO_TRIGGER_FALLING && !level))) {
+            line->pending = true;
+        }
+    }
+}
+
+static bool sim_gdo_level(uint8_t iocfg)
+{
+    uint32_t threshold = sim_regs[SIM_FIFOTHR] & 0x0F;
+    bool level;
+
+    switch (iocfg & 0x3F) {
+        case 0x00:
+            /* RX FIFO at or above the threshold: 4, 8 .. 64 bytes */
+            level = sim_rx_count >= 4U * (threshold + 1U);
+            break;
+        case 0x02:
+            /* TX FIFO at or above the threshold: 61, 57 .. 1 bytes */
+            level = sim_tx_count >= 61U - 4U * threshold;
+            break;
+        case 0x06:
+            /* Sync word sent or received, until the end of the packet */
+            level = (sim_air == SIM_AIR_DATA || sim_air == SIM_AIR_CRC);
+            break;
+        default:
+            level = false;
+            break;
+    }
+
+    return (iocfg & 0x40) ? !level : level;
+}
+
+static sim_line_t *sim_line(uint32_t pin)
+{
+    for (uint32_t i = 0; i < sizeof(sim_lines) / sizeof(sim_lines[0]); i++) {
+        if (sim_lines[i].pin == pin) {
+            return &sim_lines[i];
+        }
+    }
+    return NULL;
+}
@@ -0,0 +1,75 @@
+/**
+ * @file cc1101_sim.h
+ * @brief Host model of the CC1101 behind SPI1, its GDO lines and the cycle counter
+ *
+ * src/hal/hal_radio_cc1101.c includes this instead of touching registers
+ * when it is built with HAL_CC1101_SIMULATOR. Time only moves when the
+ * driver reads the cycle counter or clocks an SPI byte; the air side of
+ * the chip (preamble, sync word, one payload byte per byte time at the
+ * rate in MDMCFG4/3) catches up on each step. GDO edges are taken as
+ * interrupts between SPI accesses, unless the driver holds its lock or is
+ * already in a handler, and then as soon as it lets go, as on the target.
+ */
+
+#ifndef CC1101_SIM_H
+#define CC1101_SIM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Hooks for hal_radio_cc1101.c */
+#define DWT_CYCCNT                  cc1101_sim_cycles()
+
+uint32_t cc1101_sim_cycles(void);
+uint8_t cc1101_sim_exchange(uint8_t value);
+
+#define CC1101_SIM_AIR_MAX          1024
+
+/**
+ * @brief What the simulated chip has seen and done
+ */
+typedef struct {
+    uint32_t transactions;              /* Chip select frames */
+    uint32_t strobes;
+    uint32_t status_reads;              /* Status register bytes read */
+    uint32_t register_bursts;           /* Accesses that wrote configuration registers */
+    uint32_t register_writes;           /* Configuration register bytes written */
+    uint32_t patable_writes;            /* PATABLE bytes written */
+    uint32_t fifo_writes;               /* TX FIFO bytes written */
+    uint32_t fifo_reads;                /* RX FIFO bytes read */
+    uint32_t gdo0_interrupts;
+    uint32_t gdo2_interrupts;
+    uint32_t length_switches;           /* Length mode changed while a packet was on air */
+    uint32_t tx_packets;                /* Packets sent to the end */
+    uint32_t rx_packets;                /* Injected packets received to the end */
+    uint32_t tx_underflows;
+    uint32_t rx_overflows;
+    uint32_t fifo_misuse;               /* Writes to a full TX FIFO, reads from an empty RX FIFO */
+    uint32_t rx_filler;                 /* Bytes received past the end of the injected packet */
+    uint32_t tx_fifo_peak;              /* Most bytes the TX FIFO held while transmitting */
+    uint32_t rx_fifo_peak;              /* Most bytes the RX FIFO held while receiving */
+} cc1101_sim_stats_t;
+
+/**
+ * @brief Bytes of the last packet sent, from the first byte after the sync word
+ *
+ * In variable length mode that is the length byte; the CRC is not included.
+ */
+uint32_t cc1101_sim_tx_air(const uint8_t **data);
+
+/**
+ * @brief Have a packet arrive on the next SRX
+ * @param air Bytes after the sync word (length byte first in variable length mode)
+ * @param crc_ok CRC_OK bit of the appended status byte
+ */
+void cc1101_sim_queue_rx(const uint8_t *air, uint32_t length, bool crc_ok);
+
+/**
+ * @brief Configuration register as the chip holds it
+ */
+uint8_t cc1101_sim_register(uint8_t addr);
+
+void cc1101_sim_get_stats(cc1101_sim_stats_t *stats);
+void cc1101_sim_reset_stats(void);
+
+#endif /* CC1101_SIM_H */
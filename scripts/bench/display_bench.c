@@ -0,0 +1,361 @@
+/**
+ * @file display_bench.c
+ * @brief Host benchmark for the display HAL's rectangle and line fills
+ *
+ * Runs src/hal/hal_display.c against its own frame buffer. Checks
+ * hal_graphics_fill_rect(), hal_graphics_draw_rect() and
+ * hal_graphics_draw_line() pixel for pixel against a one-pixel-at-a-time
+ * model of the page-major buffer, with shapes that hang off every edge,
+ * in all three modes. Then reports pixels per second of host time for
+ * full-screen and small fills, horizontal and vertical lines, diagonal
+ * lines and, for comparison, the same full screen drawn with
+ * hal_graphics_set_pixel() one pixel at a time. Also checks the display
+ * installs its DMA page-flush interrupt at init and removes it at deinit.
+ *
+ * Usage: display_bench [-n SHAPES]
+ */
+
+#include "hal_display.h"
+#include "kernel/interrupt.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_MIN_SECONDS           0.2         /* Host time per measurement */
+
+/**
+ * @brief One measured primitive
+ */
+typedef struct {
+    const char *name;
+    uint32_t pixels;                /* Pixels touched per call */
+    void (*draw)(uint32_t i);
+} bench_case_t;
+
+static uint8_t bench_model[DISPLAY_BUFFER_SIZE];
+static uint32_t bench_random = 0x9E3779B9;
+static irq_handler_t bench_dma_handler = NULL;
+static bool bench_dma_enabled = false;
+
+/* Static function prototypes */
+static uint32_t bench_next(uint32_t range);
+static void bench_model_pixel(int32_t x, int32_t y, hal_graphics_mode_t mode);
+static int bench_compare(const char *name, uint32_t shape);
+static int bench_check_rects(uint32_t count);
+static int bench_check_lines(uint32_t count);
+static void bench_full_fill(uint32_t i);
+static void bench_small_fill(uint32_t i);
+static void bench_hline(uint32_t i);
+static void bench_vline(uint32_t i);
+static void bench_diagonal(uint32_t i);
+static void bench_set_pixels(uint32_t i);
+static void bench_measure(const bench_case_t *bench_case);
+static double bench_now(void);
+
+int main(int argc, char **argv)
+{
+    uint32_t count = 20000;
+    int failed = 0;
+
+    if (argc == 3 && strcmp(argv[1], "-n") == 0) {
+        count = (uint32_t)strtoul(argv[2], NULL, 0);
+    } else if (argc != 1) {
+        fprintf(stderr, "usage: %s [-n SHAPES]\n", argv[0]);
+        return 2;
+    }
+
+    if (hal_display_init() != HAL_OK) {
+        fprintf(stderr, "hal_display_init failed\n");
+        return 1;
+    }
+    if (bench_dma_handler == NULL || !bench_dma_enabled) {
+        fprintf(stderr, "init: DMA1 channel 1 interrupt not installed\n");
+        failed = 1;
+    }
+
+    failed |= bench_check_rects(count);
+    failed |= bench_check_lines(count);
+
+    const bench_case_t cases[] = {
+        { "fill full screen", DISPLAY_WIDTH * DISPLAY_HEIGHT, bench_full_fill },
+        { "fill 16x16", 16 * 16, bench_small_fill },
+        { "horizontal line", DISPLAY_WIDTH, bench_hline },
+        { "vertical line", DISPLAY_HEIGHT, bench_vline },
+        { "diagonal line", DISPLAY_HEIGHT, bench_diagonal },
+        { "set_pixel full screen", DISPLAY_WIDTH * DISPLAY_HEIGHT, bench_set_pixels },
+    };
+    for (uint32_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        bench_measure(&cases[i]);
+    }
+
+    hal_display_deinit();
+    if (bench_dma_handler != NULL || bench_dma_enabled) {
+        fprintf(stderr, "deinit: DMA1 channel 1 interrupt still installed\n");
+        failed = 1;
+    }
+    return failed;
+}
+
+/* Kernel interrupt calls hal_display.c makes; only the DMA1 channel 1 line exists here */
+
+kernel_status_t interrupt_register(irq_number_t irq, irq_handler_t handler, irq_priority_t priority,
+                                   const char *name)
+{
+    (void)priority;
+    (void)name;
+    if (irq != IRQ_DMA1_CH1 || handler == NULL || bench_dma_handler != NULL) {
+        return KERNEL_ERROR;
+    }
+    bench_dma_handler = handler;
+    return KERNEL_OK;
+}
+
+kernel_status_t interrupt_unregister(irq_number_t irq)
+{
+    if (irq != IRQ_DMA1_CH1) {
+        return KERNEL_ERROR;
+    }
+    bench_dma_handler = NULL;
+    bench_dma_enabled = false;
+    return KERNEL_OK;
+}
+
+kernel_status_t interrupt_enable(irq_number_t irq)
+{
+    if (irq != IRQ_DMA1_CH1 || bench_dma_handler == NULL) {
+        return KERNEL_ERROR;
+    }
+    bench_dma_enabled = true;
+    return KERNEL_OK;
+}
+
+kernel_status_t interrupt_disable(irq_number_t irq)
+{
+    if (irq != IRQ_DMA1_CH1) {
+        return KERNEL_ERROR;
+    }
+    bench_dma_enabled = false;
+    return KERNEL_OK;
+}
+
+/* Static helper functions */
+
+static uint32_t bench_next(uint32_t range)
+{
+    bench_random ^= bench_random << 13;
+    bench_random ^= bench_random >> 17;
+    bench_random ^= bench_random << 5;
+    return bench_random % range;
+}
+
+/**
+ * @brief The reference: one bit of the page-major buffer, clipped to the screen
+ */
+static void bench_model_pixel(int32_t x, int32_t y, hal_graphics_mode_t mode)
+{
+    if (x < 0 || x >= DISPLAY_WIDTH || y < 0 || y >= DISPLAY_HEIGHT) {
+        return;
+    }
+
+    uint8_t *byte = &bench_model[(y / 8) * DISPLAY_WIDTH + x];
+    uint8_t bit = (uint8_t)(1U << (y % 8));
+    if (mode == HAL_GRAPHICS_MODE_SET) {
+        *byte |= bit;
+    } else if (mode == HAL_GRAPHICS_MODE_CLEAR) {
+        *byte &= (uint8_t)~bit;
+    } else {
+        *byte ^= bit;
+    }
+}
+
+static int bench_compare(const char *name, uint32_t shape)
+{
+    uint8_t *buffer;
+    uint32_t size;
+
+    hal_display_get_buffer(&buffer, &size);
+    if (size != sizeof(bench_model) || memcmp(buffer, bench_model, size) != 0) {
+        fprintf(stderr, "%s: buffer differs from the model after shape %u\n", name, (unsigned)shape);
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Filled and outlined rectangles, partly or wholly off screen
+ */
+static int bench_check_rects(uint32_t count)
+{
+    hal_display_clear();
+    memset(bench_model, 0, sizeof(bench_model));
+
+    for (uint32_t i = 0; i < count; i++) {
+        hal_graphics_mode_t mode = (hal_graphics_mode_t)bench_next(3);
+        hal_rect_t rect = {
+            .x = (int16_t)((int32_t)bench_next(DISPLAY_WIDTH + 80) - 40),
+            .y = (int16_t)((int32_t)bench_next(DISPLAY_HEIGHT + 60) - 30),
+            .width = (uint16_t)bench_next(DISPLAY_WIDTH + 20),
+            .height = (uint16_t)bench_next(DISPLAY_HEIGHT + 20)
+        };
+        int32_t right = rect.x + rect.width - 1;
+        int32_t bottom = rect.y + rect.height - 1;
+
+        if (bench_next(2)) {
+            hal_graphics_fill_rect(&rect, mode);
+            for (int32_t y = rect.y; y <= bottom; y++) {
+                for (int32_t x = rect.x; x <= right; x++) {
+                    bench_model_pixel(x, y, mode);
+                }
+            }
+        } else {
+            hal_graphics_draw_rect(&rect, mode);
+            if (rect.width > 0 && rect.height > 0) {
+                /* Corners once each, so INVERT outlines stay closed */
+                for (int32_t x = rect.x; x <= right; x++) {
+                    bench_model_pixel(x, rect.y, mode);
+                    if (bottom != rect.y) {
+                        bench_model_pixel(x, bottom, mode);
+                    }
+                }
+                for (int32_t y = rect.y + 1; y < bottom; y++) {
+                    bench_model_pixel(rect.x, y, mode);
+                    if (right != rect.x) {
+                        bench_model_pixel(right, y, mode);
+                    }
+                }
+            }
+        }
+        if (bench_compare("rect", i) != 0) {
+            return 1;
+        }
+    }
+
+    printf("rects: %u filled and outlined rectangles match the model\n", (unsigned)count);
+    return 0;
+}
+
+/**
+ * @brief Lines of every slope, half of them horizontal or vertical
+ */
+static int bench_check_lines(uint32_t count)
+{
+    hal_display_clear();
+    memset(bench_model, 0, sizeof(bench_model));
+
+    for (uint32_t i = 0; i < count; i++) {
+        hal_graphics_mode_t mode = (hal_graphics_mode_t)bench_next(3);
+        int32_t x0 = (int32_t)bench_next(DISPLAY_WIDTH + 32) - 16;
+        int32_t y0 = (int32_t)bench_next(DISPLAY_HEIGHT + 32) - 16;
+        int32_t x1 = (int32_t)bench_next(DISPLAY_WIDTH + 32) - 16;
+        int32_t y1 = (int32_t)bench_next(DISPLAY_HEIGHT + 32) - 16;
+        uint32_t kind = bench_next(4);
+
+        if (kind == 0) {
+            y1 = y0;
+        } else if (kind == 1) {
+            x1 = x0;
+        }
+        hal_graphics_draw_line((int16_t)x0, (int16_t)y0, (int16_t)x1, (int16_t)y1, mode);
+
+        int32_t dx = abs(x1 - x0);
+        int32_t dy = abs(y1 - y0);
+        int32_t sx = x0 < x1 ? 1 : -1;
+        int32_t sy = y0 < y1 ? 1 : -1;
+        int32_t error = dx - dy;
+        for (int32_t x = x0, y = y0;;) {
+            bench_model_pixel(x, y, mode);
+            if (x == x1 && y == y1) {
+                break;
+            }
+            int32_t e2 = 2 * error;
+            if (e2 > -dy) {
+                error -= dy;
+                x += sx;
+            }
+            if (e2 < dx) {
+                error += dx;
+                y += sy;
+            }
+        }
+        if (bench_compare("line", i) != 0) {
+            return 1;
+        }
+    }
+
+    printf("lines: %u lines match the model\n", (unsigned)count);
+    return 0;
+}
+
+static void bench_full_fill(uint32_t i)
+{
+    (void)i;
+    hal_rect_t rect = { 0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT };
+    hal_graphics_fill_rect(&rect, HAL_GRAPHICS_MODE_INVERT);
+}
+
+static void bench_small_fill(uint32_t i)
+{
+    /* Odd steps put the rectangle across page and word boundaries */
+    hal_rect_t rect = {
+        (int16_t)((i * 7) % (DISPLAY_WIDTH - 16)), (int16_t)((i * 3) % (DISPLAY_HEIGHT - 16)), 16, 16
+    };
+    hal_graphics_fill_rect(&rect, HAL_GRAPHICS_MODE_INVERT);
+}
+
+static void bench_hline(uint32_t i)
+{
+    int16_t y = (int16_t)(i % DISPLAY_HEIGHT);
+    hal_graphics_draw_line(0, y, DISPLAY_WIDTH - 1, y, HAL_GRAPHICS_MODE_INVERT);
+}
+
+static void bench_vline(uint32_t i)
+{
+    int16_t x = (int16_t)(i % DISPLAY_WIDTH);
+    hal_graphics_draw_line(x, 0, x, DISPLAY_HEIGHT - 1, HAL_GRAPHICS_MODE_INVERT);
+}
+
+static void bench_diagonal(uint32_t i)
+{
+    int16_t x = (int16_t)(i % (DISPLAY_WIDTH - DISPLAY_HEIGHT));
+    hal_graphics_draw_line(x, 0, (int16_t)(x + DISPLAY_HEIGHT - 1), DISPLAY_HEIGHT - 1, HAL_GRAPHICS_MODE_INVERT);
+}
+
+static void bench_set_pixels(uint32_t i)
+{
+    (void)i;
+    for (int16_t y = 0; y < DISPLAY_HEIGHT; y++) {
+        for (int16_t x = 0; x < DISPLAY_WIDTH; x++) {
+            hal_graphics_set_pixel(x, y, HAL_GRAPHICS_MODE_INVERT);
+        }
+    }
+}
+
+/**
+ * @brief Call a primitive until BENCH_MIN_SECONDS have passed, report pixels/s
+ */
+static void bench_measure(const bench_case_t *bench_case)
+{
+    uint32_t calls = 0;
+    uint32_t batch = 64;
+    double start = bench_now();
+    double elapsed = 0;
+
+    while (elapsed < BENCH_MIN_SECONDS) {
+        for (uint32_t i = 0; i < batch; i++) {
+            bench_case->draw(calls + i);
+        }
+        calls += batch;
+        elapsed = bench_now() - start;
+    }
+
+    printf("%-22s %8.1f Mpixels/s, %8.0f ns per call\n", bench_case->name,
+           (double)calls * bench_case->pixels / elapsed / 1e6, elapsed / calls * 1e9);
+}
+
+static double bench_now(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
@@ -0,0 +1,282 @@
+/**
+ * @file dsp_bench.c
+ * @brief Host benchmark and reference check for the baseband demodulator
+ *
+ * Runs src/hal/hal_radio_dsp.c over sample files written by
+ * scripts/dsp_reference.py, fed in blocks the size of a sampler ring half
+ * as the firmware does. For each file it checks that the recovered bits
+ * match the reference model exactly, counts payload bit errors against
+ * what was transmitted, and reports the throughput. Host numbers show
+ * relative cost only; the SMLAD/QADD path is compiled for the target.
+ *
+ * Usage: dsp_bench [-r REPEAT] FILE.tngs [FILE.tngs ...]
+ */
+
+#include "hal_radio_dsp.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_HEADER_SIZE           64
+#define BENCH_BLOCK                 (HAL_RADIO_SAMPLE_BUFFER / 2U)
+#define BENCH_PREAMBLE_BITS         32
+#define BENCH_SYNC                  0xD391U
+#define BENCH_SYNC_BITS             16
+
+/**
+ * @brief One sample file
+ */
+typedef struct {
+    hal_radio_dsp_config_t config;
+    int16_t taps[HAL_RADIO_DSP_TAPS];
+    uint32_t sample_count;
+    uint32_t sent_bits;
+    uint32_t reference_bits;
+    uint8_t *sent;
+    uint8_t *reference;
+    int16_t *samples;
+    uint8_t *data;
+} bench_capture_t;
+
+/* Static function prototypes */
+static int bench_load(const char *path, bench_capture_t *capture);
+static void bench_free(bench_capture_t *capture);
+static uint32_t bench_get16(const uint8_t *p);
+static uint32_t bench_get32(const uint8_t *p);
+static uint32_t bench_bit(const uint8_t *bits, uint32_t index);
+static long bench_payload_errors(const bench_capture_t *capture, const uint8_t *bits, uint32_t count);
+static uint32_t bench_run(const bench_capture_t *capture, hal_radio_dsp_t *dsp, uint8_t *bits, uint32_t max_bits);
+static double bench_now(void);
+
+int main(int argc, char **argv)
+{
+    int repeat = 50;
+    int first = 1;
+    int failed = 0;
+
+    if (argc > 2 && strcmp(argv[1], "-r") == 0) {
+        repeat = atoi(argv[2]);
+        first = 3;
+    }
+    if (first >= argc || repeat <= 0) {
+        fprintf(stderr, "usage: %s [-r REPEAT] FILE.tngs [FILE.tngs ...]\n", argv[0]);
+        return 2;
+    }
+
+    for (int i = first; i < argc; i++) {
+        bench_capture_t capture;
+        hal_radio_dsp_t dsp;
+
+        if (bench_load(argv[i], &capture) != 0) {
+            failed = 1;
+            continue;
+        }
+
+        uint32_t max_bits = capture.sample_count / 4U + 8U;
+        uint8_t *bits = calloc((max_bits + 7U) / 8U, 1);
+        if (bits == NULL || hal_radio_dsp_init(&dsp, &capture.config) != HAL_OK) {
+            fprintf(stderr, "%s: unusable pipeline settings\n", argv[i]);
+            free(bits);
+            bench_free(&capture);
+            failed = 1;
+            continue;
+        }
+
+        uint32_t count = bench_run(&capture, &dsp, bits, max_bits);
+
+        double start = bench_now();
+        for (int r = 0; r < repeat; r++) {
+            bench_run(&capture, &dsp, bits, max_bits);
+        }
+        double elapsed = bench_now() - start;
+
+        bool exact = (count == capture.reference_bits);
+        for (uint32_t b = 0; exact && b < count; b++) {
+            exact = (bench_bit(bits, b) == bench_bit(capture.reference, b));
+        }
+
+        long errors = bench_payload_errors(&capture, bits, count);
+        double rate = (double)capture.sample_count * repeat / elapsed;
+
+        printf("%s: %u samples, %u bits, ", argv[i], (unsigned)capture.sample_count, (unsigned)count);
+        if (errors < 0) {
+            printf("sync not found");
+        } else {
+            printf("%ld/%u payload bit errors", errors,
+                   (unsigned)(capture.sent_bits - BENCH_PREAMBLE_BITS - BENCH_SYNC_BITS));
+        }
+        printf(", %s reference\n", exact ? "matches" : "DIFFERS FROM");
+        printf("    %.2f Msamples/s, %.1f ns/sample, %.0fx real time at %u Hz\n",
+               rate / 1e6, 1e9 / rate, rate / capture.config.sample_rate_hz,
+               (unsigned)capture.config.sample_rate_hz);
+
+        if (!exact) {
+            failed = 1;
+        }
+        free(bits);
+        bench_free(&capture);
+    }
+
+    return failed;
+}
+
+/* Static helper functions */
+
+/**
+ * @brief Read a sample file; see scripts/dsp_reference.py for the layout
+ */
+static int bench_load(const char *path, bench_capture_t *capture)
+{
+    FILE *file = fopen(path, "rb");
+    long size;
+
+    memset(capture, 0, sizeof(*capture));
+    if (file == NULL) {
+        perror(path);
+        return -1;
+    }
+    if (fseek(file, 0, SEEK_END) != 0 || (size = ftell(file)) < BENCH_HEADER_SIZE || fseek(file, 0, SEEK_SET) != 0) {
+        fprintf(stderr, "%s: truncated header\n", path);
+        fclose(file);
+        return -1;
+    }
+
+    capture->data = malloc((size_t)size);
+    if (capture->data == NULL || fread(capture->data, 1, (size_t)size, file) != (size_t)size) {
+        fprintf(stderr, "%s: read failed\n", path);
+        fclose(file);
+        free(capture->data);
+        return -1;
+    }
+    fclose(file);
+
+    const uint8_t *p = capture->data;
+    if (memcmp(p, "TNGS", 4) != 0 || p[4] != 1) {
+        fprintf(stderr, "%s: not a version 1 sample file\n", path);
+        free(capture->data);
+        return -1;
+    }
+
+    capture->config.mode = (hal_radio_dsp_mode_t)p[5];
+    capture->config.envelope_shift = p[6];
+    capture->config.decay_shift = p[7];
+    capture->config.clock_gain_shift = p[8];
+    capture->config.squelch = (int16_t)bench_get16(&p[10]);
+    capture->config.sample_rate_hz = bench_get32(&p[12]);
+    capture->config.bit_rate_bps = bench_get32(&p[16]);
+    for (uint32_t i = 0; i < HAL_RADIO_DSP_TAPS; i++) {
+        capture->taps[i] = (int16_t)bench_get16(&p[20 + 2 * i]);
+    }
+    capture->config.taps = capture->taps;
+    capture->sample_count = bench_get32(&p[52]);
+    capture->sent_bits = bench_get32(&p[56]);
+    capture->reference_bits = bench_get32(&p[60]);
+
+    size_t sent_size = (capture->sent_bits + 7U) / 8U;
+    size_t reference_size = (capture->reference_bits + 7U) / 8U;
+    if ((size_t)size != BENCH_HEADER_SIZE + sent_size + reference_size + 2U * capture->sample_count) {
+        fprintf(stderr, "%s: size does not match the header\n", path);
+        free(capture->data);
+        return -1;
+    }
+
+    capture->sent = capture->data + BENCH_HEADER_SIZE;
+    capture->reference = capture->sent + sent_size;
+
+    /* Samples are little-endian on disk and may be unaligned; convert them */
+    const uint8_t *raw = capture->reference + reference_size;
+    capture->samples = malloc(2U * capture->sample_count + 2U);
+    if (capture->samples == NULL) {
+        free(capture->data);
+        return -1;
+    }
+    for (uint32_t i = 0; i < capture->sample_count; i++) {
+        capture->samples[i] = (int16_t)bench_get16(&raw[2 * i]);
+    }
+    return 0;
+}
+
+static void bench_free(bench_capture_t *capture)
+{
+    free(capture->samples);
+    free(capture->data);
+}
+
+static uint32_t bench_get16(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8);
+}
+
+static uint32_t bench_get32(const uint8_t *p)
+{
+    return bench_get16(p) | (bench_get16(&p[2]) << 16);
+}
+
+static uint32_t bench_bit(const uint8_t *bits, uint32_t index)
+{
+    return (bits[index >> 3] >> (7U - (index & 7U))) & 1U;
+}
+
+/**
+ * @brief Errors in the bits after the first sync word, -1 if it is never found
+ */
+static long bench_payload_errors(const bench_capture_t *capture, const uint8_t *bits, uint32_t count)
+{
+    uint32_t payload = capture->sent_bits - BENCH_PREAMBLE_BITS - BENCH_SYNC_BITS;
+    uint32_t window = 0;
+
+    for (uint32_t i = 0; i < count; i++) {
+        window = ((window << 1) | bench_bit(bits, i)) & 0xFFFFU;
+        if (i + 1U < BENCH_SYNC_BITS || window != BENCH_SYNC) {
+            continue;
+        }
+
+        long errors = 0;
+        for (uint32_t b = 0; b < payload; b++) {
+            uint32_t at = i + 1U + b;
+            if (at >= count ||
+                bench_bit(bits, at) != bench_bit(capture->sent, BENCH_PREAMBLE_BITS + BENCH_SYNC_BITS + b)) {
+                errors++;
+            }
+        }
+        return errors;
+    }
+    return -1;
+}
+
+/**
+ * @brief Demodulate the whole file from a reset pipeline, one ring half at a time
+ */
+static uint32_t bench_run(const bench_capture_t *capture, hal_radio_dsp_t *dsp, uint8_t *bits, uint32_t max_bits)
+{
+    uint32_t written = 0;
+
+    hal_radio_dsp_reset(dsp);
+    for (uint32_t offset = 0; offset < capture->sample_count; offset += BENCH_BLOCK) {
+        uint32_t block = capture->sample_count - offset;
+        if (block > BENCH_BLOCK) {
+            block = BENCH_BLOCK;
+        }
+
+        /* Bits are packed per call from bit 0, so keep later calls byte aligned */
+        uint8_t spill[BENCH_BLOCK / 4U / 8U + 2U];
+        uint32_t n = hal_radio_dsp_process(dsp, &capture->samples[offset], block, spill, sizeof(spill) * 8U);
+        for (uint32_t b = 0; b < n && written < max_bits; b++, written++) {
+            uint8_t mask = (uint8_t)(0x80U >> (written & 7U));
+            if (bench_bit(spill, b)) {
+                bits[written >> 3] |= mask;
+            } else {
+                bits[written >> 3] &= (uint8_t)~mask;
+            }
+        }
+    }
+    return written;
+}
+
+static double bench_now(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
@@ -0,0 +1,346 @@
+/**
+ * @file ipcc_bench.c
+ * @brief Host benchmark for the mailbox transport against a simulated CPU2
+ *
+ * Runs src/hal/hal_ipcc.c built with HAL_IPCC_SIMULATOR (see ipcc_sim.h)
+ * through bring-up, HCI command round trips, a burst of advertising
+ * reports and ACL packets echoed by CPU2. Checks ordering, that misused
+ * frees and releases are refused, and that every buffer ends up back
+ * with CPU2. Host numbers show transport cost per packet only.
+ *
+ * Usage: ipcc_bench [-n COUNT]
+ */
+
+#include "hal_ipcc.h"
+#include "ipcc_sim.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_SPIN                  1000        /* CPU2 passes before a wait counts as stuck */
+#define BENCH_ACL_PAYLOAD           251
+
+/**
+ * @brief What the receive callback has seen
+ */
+typedef struct {
+    uint32_t command_completes;
+    uint16_t last_opcode;
+    uint32_t reports;
+    uint32_t reports_out_of_order;
+    uint32_t completed_packets;
+    uint32_t acl_echoes;
+    uint32_t acl_mismatches;
+    uint32_t wakeups;
+    hal_ipcc_buffer_t *hold;        /* Next buffer to keep instead of releasing */
+    bool hold_next;
+} bench_state_t;
+
+static bench_state_t bench;
+static uint8_t bench_acl[BENCH_ACL_PAYLOAD];
+
+/* Static function prototypes */
+static void bench_receive(hal_ipcc_buffer_t *const *buffers, uint32_t count, void *user_data);
+static void bench_wakeup(void *user_data);
+static void bench_step(void);
+static hal_ipcc_buffer_t *bench_alloc(hal_ipcc_packet_type_t type);
+static int bench_commands(uint32_t count);
+static int bench_reports(uint32_t count);
+static int bench_acl_packets(uint32_t count);
+static int bench_misuse(void);
+static double bench_now(void);
+
+int main(int argc, char **argv)
+{
+    uint32_t count = 20000;
+    int failed = 0;
+
+    if (argc == 3 && strcmp(argv[1], "-n") == 0) {
+        count = (uint32_t)strtoul(argv[2], NULL, 0);
+    } else if (argc != 1) {
+        fprintf(stderr, "usage: %s [-n COUNT]\n", argv[0]);
+        return 2;
+    }
+    if (count == 0) {
+        return 2;
+    }
+
+    ipcc_sim_stats_t sim;
+    hal_ipcc_stats_t stats;
+
+    if (hal_ipcc_init() != HAL_OK) {
+        fprintf(stderr, "hal_ipcc_init failed\n");
+        return 1;
+    }
+    hal_ipcc_register_callback(bench_receive, bench_wakeup, NULL);
+    ipcc_sim_get_stats(&sim);
+    printf("receive interrupt %s\n", sim.irq_enabled ? "installed and enabled" : "NOT ENABLED");
+    failed |= !sim.irq_enabled;
+
+    for (uint32_t i = 0; i < BENCH_SPIN && (hal_ipcc_get_stats(&stats), stats.wireless_version == 0); i++) {
+        bench_step();
+    }
+    ipcc_sim_get_stats(&sim);
+    if (stats.wireless_version == 0 || !sim.ble_running) {
+        fprintf(stderr, "CPU2 never became ready\n");
+        return 1;
+    }
+    printf("CPU2 ready, wireless stack %u.%u.%u, %u event buffers\n", (unsigned)(stats.wireless_version >> 24),
+           (unsigned)((stats.wireless_version >> 16) & 0xFF), (unsigned)((stats.wireless_version >> 8) & 0xFF),
+           (unsigned)sim.buffers);
+
+    failed |= bench_commands(count);
+    failed |= bench_reports(count * 5U);
+    failed |= bench_acl_packets(count);
+    failed |= bench_misuse();
+
+    /* Everything delivered must be back with CPU2 */
+    for (uint32_t i = 0; i < 4; i++) {
+        bench_step();
+    }
+    ipcc_sim_get_stats(&sim);
+    printf("buffers with CPU2 at the end: %u/%u\n", (unsigned)sim.buffers_free, (unsigned)sim.buffers);
+    failed |= (sim.buffers_free != sim.buffers);
+
+    hal_ipcc_deinit();
+    return failed;
+}
+
+/* Static helper functions */
+
+static void bench_receive(hal_ipcc_buffer_t *const *buffers, uint32_t count, void *user_data)
+{
+    (void)user_data;
+
+    for (uint32_t i = 0; i < count; i++) {
+        const hal_ipcc_buffer_t *buffer = buffers[i];
+
+        if (buffer->type == HAL_IPCC_PACKET_EVENT && buffer->data[0] == 0x0E) {
+            bench.command_completes++;
+            bench.last_opcode = (uint16_t)(buffer->data[3] | (buffer->data[4] << 8));
+        } else if (buffer->type == HAL_IPCC_PACKET_EVENT && buffer->data[0] == 0x3E) {
+            uint32_t sequence;
+            memcpy(&sequence, &buffer->data[13], sizeof(sequence));
+            if (sequence != bench.reports) {
+                bench.reports_out_of_order++;
+            }
+            bench.reports++;
+        } else if (buffer->type == HAL_IPCC_PACKET_EVENT && buffer->data[0] == 0x13) {
+            bench.completed_packets += buffer->data[5];
+        } else if (buffer->type == HAL_IPCC_PACKET_ACL) {
+            if (hal_ipcc_length(buffer) != 4U + BENCH_ACL_PAYLOAD ||
+                memcmp(&buffer->data[4], bench_acl, BENCH_ACL_PAYLOAD) != 0) {
+                bench.acl_mismatches++;
+            }
+            bench.acl_echoes++;
+        }
+
+        if (bench.hold_next) {
+            bench.hold = buffers[i];
+            bench.hold_next = false;
+        } else {
+            hal_ipcc_release(buffers[i]);
+        }
+    }
+}
+
+static void bench_wakeup(void *user_data)
+{
+    (void)user_data;
+    bench.wakeups++;
+}
+
+/**
+ * @brief One CPU2 pass, then CPU1's task
+ */
+static void bench_step(void)
+{
+    ipcc_sim_run();
+    hal_ipcc_process();
+}
+
+static hal_ipcc_buffer_t *bench_alloc(hal_ipcc_packet_type_t type)
+{
+    for (uint32_t i = 0; i < BENCH_SPIN; i++) {
+        hal_ipcc_buffer_t *buffer = hal_ipcc_alloc(type);
+        if (buffer != NULL) {
+            return buffer;
+        }
+        bench_step();
+    }
+    return NULL;
+}
+
+/**
+ * @brief Send commands one at a time, each waiting for its Command Complete
+ */
+static int bench_commands(uint32_t count)
+{
+    static const uint16_t opcodes[] = { 0x0C03, 0x2002, 0x0C01, 0x2001 };
+    double start = bench_now();
+
+    for (uint32_t i = 0; i < count; i++) {
+        hal_ipcc_buffer_t *buffer = bench_alloc(HAL_IPCC_PACKET_COMMAND);
+        uint16_t opcode = opcodes[i % 4U];
+        uint32_t completes = bench.command_completes;
+
+        if (buffer == NULL) {
+            fprintf(stderr, "commands: command buffer never came back\n");
+            return 1;
+        }
+        buffer->data[0] = (uint8_t)opcode;
+        buffer->data[1] = (uint8_t)(opcode >> 8);
+        buffer->data[2] = 0;
+        if (hal_ipcc_send(buffer) != HAL_OK) {
+            fprintf(stderr, "commands: send refused\n");
+            return 1;
+        }
+        for (uint32_t spin = 0; spin < BENCH_SPIN && bench.command_completes == completes; spin++) {
+            bench_step();
+        }
+        if (bench.command_completes == completes || bench.last_opcode != opcode) {
+            fprintf(stderr, "commands: no Command Complete for 0x%04X\n", opcode);
+            return 1;
+        }
+    }
+
+    double elapsed = bench_now() - start;
+    printf("commands: %u round trips, %.0f/s, %.2f us each\n", (unsigned)count, count / elapsed,
+           elapsed * 1e6 / count);
+    return 0;
+}
+
+/**
+ * @brief Unsolicited events as fast as CPU2 can produce them
+ */
+static int bench_reports(uint32_t count)
+{
+    hal_ipcc_stats_t before;
+    hal_ipcc_stats_t after;
+    ipcc_sim_stats_t sim_before;
+    ipcc_sim_stats_t sim_after;
+
+    hal_ipcc_get_stats(&before);
+    ipcc_sim_get_stats(&sim_before);
+    uint32_t wakeups = bench.wakeups;
+    bench.reports = 0;
+    bench.reports_out_of_order = 0;
+
+    double start = bench_now();
+    ipcc_sim_queue_reports(count);
+    for (uint32_t spin = 0; spin < count * 4U && bench.reports < count; spin++) {
+        bench_step();
+    }
+    double elapsed = bench_now() - start;
+
+    hal_ipcc_get_stats(&after);
+    ipcc_sim_get_stats(&sim_after);
+    uint32_t interrupts = after.interrupts - before.interrupts;
+    uint32_t batches = after.batches - before.batches;
+    uint32_t doorbells = after.doorbells_rung - before.doorbells_rung;
+
+    printf("reports: %u events, %.2f M/s, %.1f per interrupt, %.1f per batch (max %u), "
+           "%.1f released per doorbell, CPU2 out of buffers on %u passes\n",
+           (unsigned)bench.reports, bench.reports / elapsed / 1e6,
+           interrupts ? (double)bench.reports / interrupts : 0.0, batches ? (double)bench.reports / batches : 0.0,
+           (unsigned)after.batch_max, doorbells ? (double)bench.reports / doorbells : 0.0,
+           (unsigned)(sim_after.stalls - sim_before.stalls));
+
+    if (bench.reports != count || bench.reports_out_of_order != 0 || bench.wakeups - wakeups != interrupts) {
+        fprintf(stderr, "reports: %u of %u, %u out of order, %u wakeups for %u interrupts\n",
+                (unsigned)bench.reports, (unsigned)count, (unsigned)bench.reports_out_of_order,
+                (unsigned)(bench.wakeups - wakeups), (unsigned)interrupts);
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Full-size ACL packets, each echoed back by CPU2
+ */
+static int bench_acl_packets(uint32_t count)
+{
+    for (uint32_t i = 0; i < BENCH_ACL_PAYLOAD; i++) {
+        bench_acl[i] = (uint8_t)(i * 7U + 3U);
+    }
+    bench.acl_echoes = 0;
+    bench.completed_packets = 0;
+
+    double start = bench_now();
+    for (uint32_t i = 0; i < count; i++) {
+        hal_ipcc_buffer_t *buffer = bench_alloc(HAL_IPCC_PACKET_ACL);
+        if (buffer == NULL) {
+            fprintf(stderr, "acl: ACL buffer never came back\n");
+            return 1;
+        }
+        buffer->data[0] = 0x40;
+        buffer->data[1] = 0x20;         /* Handle 0x040, first fragment */
+        buffer->data[2] = (uint8_t)BENCH_ACL_PAYLOAD;
+        buffer->data[3] = 0;
+        memcpy(&buffer->data[4], bench_acl, BENCH_ACL_PAYLOAD);
+        if (hal_ipcc_send(buffer) != HAL_OK) {
+            fprintf(stderr, "acl: send refused\n");
+            return 1;
+        }
+        bench_step();
+    }
+    for (uint32_t spin = 0; spin < BENCH_SPIN && bench.acl_echoes < count; spin++) {
+        bench_step();
+    }
+    double elapsed = bench_now() - start;
+
+    printf("acl: %u packets of %u bytes, %.0f/s, %.1f MB/s each way\n", (unsigned)bench.acl_echoes,
+           (unsigned)BENCH_ACL_PAYLOAD, bench.acl_echoes / elapsed, bench.acl_echoes * BENCH_ACL_PAYLOAD / elapsed / 1e6);
+
+    if (bench.acl_echoes != count || bench.completed_packets != count || bench.acl_mismatches != 0) {
+        fprintf(stderr, "acl: %u echoed, %u completed, %u corrupted\n", (unsigned)bench.acl_echoes,
+                (unsigned)bench.completed_packets, (unsigned)bench.acl_mismatches);
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Frees of unheld buffers and double releases must be refused
+ */
+static int bench_misuse(void)
+{
+    hal_ipcc_stats_t before;
+    hal_ipcc_stats_t after;
+
+    hal_ipcc_get_stats(&before);
+
+    /* Free a buffer twice, and one that is not a send buffer */
+    hal_ipcc_buffer_t *buffer = bench_alloc(HAL_IPCC_PACKET_ACL);
+    hal_ipcc_free(buffer);
+    hal_ipcc_free(buffer);
+    hal_ipcc_free(NULL);
+
+    /* Keep one received buffer, release it twice */
+    bench.hold = NULL;
+    bench.hold_next = true;
+    ipcc_sim_queue_reports(1);
+    for (uint32_t spin = 0; spin < BENCH_SPIN && bench.hold == NULL; spin++) {
+        bench_step();
+    }
+    if (bench.hold == NULL) {
+        fprintf(stderr, "misuse: no report to hold\n");
+        return 1;
+    }
+    hal_ipcc_release(bench.hold);
+    hal_ipcc_release(bench.hold);
+    bench.hold = NULL;
+
+    hal_ipcc_get_stats(&after);
+    uint32_t rejected = after.rejected - before.rejected;
+    printf("misuse: %u of 3 bad frees and releases refused\n", (unsigned)rejected);
+    return rejected != 3;
+}
+
+static double bench_now(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
@@ -0,0 +1,401 @@
+/**
+ * @file ipcc_sim.c
+ * @brief Host model of the IPCC and of CPU2 answering HCI over the mailbox
+ *
+ * Registers follow the STM32WB IPCC: C1SCR clears CPU2's flags in its low
+ * bits and sets CPU1's in its high bits, and the receive interrupt is
+ * pending while a CPU2 flag is up and unmasked. CPU2 boots on C2BOOT,
+ * carves the event pool, reports ready on the system queue and accepts
+ * SHCI_C2_BLE_Init. After that it answers every HCI command with Command
+ * Complete (LE Read Buffer Size gets 251 bytes x 8), and for every ACL
+ * packet sends Number Of Completed Packets and the packet back.
+ *
+ * A command or ACL packet is only taken off its channel when CPU2 has the
+ * buffers for its answer, so a short pool shows up as CPU1 finding the
+ * channel busy, as it would on the target.
+ */
+
+#include "ipcc_sim.h"
+#include "hal_ipcc_mailbox.h"
+#include "kernel/interrupt.h"
+#include <stddef.h>
+#include <string.h>
+
+#define SIM_C1CR                    0x00
+#define SIM_C1MR                    0x04
+#define SIM_C1SCR                   0x08
+#define SIM_C1TOC2SR                0x0C
+#define SIM_C2TOC1SR                0x1C
+#define SIM_RXOIE                   (1UL << 0)
+#define SIM_BIT(channel)            (1UL << ((channel) - 1))
+#define SIM_CHANNELS                0x3FUL
+
+#define SIM_WIRELESS_VERSION        0x010D0000UL    /* 1.13.0 */
+#define SIM_STRIDE                  ((sizeof(hal_ipcc_buffer_t) + 3U) & ~3U)
+#define SIM_REPORT_DATA             20
+
+/* Registers */
+static uint32_t sim_c1cr;
+static uint32_t sim_c1mr;
+static uint32_t sim_c1toc2;
+static uint32_t sim_c2toc1;
+static bool sim_locked;
+static bool sim_in_irq;
+static irq_handler_t sim_handler;
+static bool sim_enabled;
+
+/* CPU2 */
+static ipcc_ref_table_t *sim_table;
+static hal_ipcc_node_t sim_free;
+static hal_ipcc_node_t sim_events;          /* Waiting for the BLE event channel */
+static hal_ipcc_node_t sim_system_events;   /* Waiting for the system event channel */
+static uint32_t sim_reports_left;
+static uint32_t sim_report_next;
+static ipcc_sim_stats_t sim_stats;
+
+/* Static function prototypes */
+static void sim_interrupt(void);
+static hal_ipcc_buffer_t *sim_take(void);
+static hal_ipcc_buffer_t *sim_event(hal_ipcc_node_t *queue, uint8_t type, uint8_t code, uint8_t length);
+static void sim_command(void);
+static void sim_acl(void);
+static void sim_system_command(void);
+static void sim_publish(hal_ipcc_node_t *pending, hal_ipcc_node_t *queue, uint32_t channel);
+static void sim_list_init(hal_ipcc_node_t *head);
+static bool sim_list_empty(const hal_ipcc_node_t *head);
+static void sim_list_insert_tail(hal_ipcc_node_t *head, hal_ipcc_node_t *node);
+static hal_ipcc_node_t *sim_list_remove_head(hal_ipcc_node_t *head);
+
+uint32_t ipcc_sim_read(uint32_t offset)
+{
+    switch (offset) {
+    case SIM_C1CR:
+        return sim_c1cr;
+    case SIM_C1MR:
+        return sim_c1mr;
+    case SIM_C1TOC2SR:
+        return sim_c1toc2;
+    case SIM_C2TOC1SR:
+        return sim_c2toc1;
+    default:
+        return 0;
+    }
+}
+
+void ipcc_sim_write(uint32_t offset, uint32_t value)
+{
+    switch (offset) {
+    case SIM_C1CR:
+        sim_c1cr = value;
+        break;
+    case SIM_C1MR:
+        sim_c1mr = value;
+        break;
+    case SIM_C1SCR:
+        sim_c2toc1 &= ~(value & SIM_CHANNELS);
+        sim_c1toc2 |= (value >> 16) & SIM_CHANNELS;
+        break;
+    default:
+        break;
+    }
+    sim_interrupt();
+}
+
+void ipcc_sim_boot(const void *ref_table)
+{
+    sim_table = (ipcc_ref_table_t *)(uintptr_t)ref_table;
+    sim_table->device_info->wireless_version = SIM_WIRELESS_VERSION;
+
+    sim_list_init(&sim_free);
+    sim_list_init(&sim_events);
+    sim_list_init(&sim_system_events);
+    for (uint32_t offset = 0; offset + sizeof(hal_ipcc_buffer_t) <= sim_table->mm->ble_pool_size;
+         offset += SIM_STRIDE) {
+        sim_list_insert_tail(&sim_free, (hal_ipcc_node_t *)(void *)&sim_table->mm->ble_pool[offset]);
+        sim_stats.buffers++;
+        sim_stats.buffers_free++;
+    }
+
+    /* Ready, wireless stack running */
+    hal_ipcc_buffer_t *ready = sim_event(&sim_system_events, IPCC_PACKET_SYSTEM_EVENT, SHCI_EVENT_VENDOR, 3);
+    ready->data[2] = (uint8_t)SHCI_SUBEVENT_READY;
+    ready->data[3] = (uint8_t)(SHCI_SUBEVENT_READY >> 8);
+    ready->data[4] = 0;
+}
+
+uint32_t ipcc_sim_lock(void)
+{
+    uint32_t state = sim_locked;
+
+    sim_locked = true;
+    return state;
+}
+
+void ipcc_sim_unlock(uint32_t state)
+{
+    sim_locked = (state != 0);
+    sim_interrupt();
+}
+
+void ipcc_sim_run(void)
+{
+    if (sim_table == NULL) {
+        return;
+    }
+
+    if (sim_c1toc2 & SIM_BIT(IPCC_CH_MM)) {
+        hal_ipcc_node_t *queue = sim_table->mm->free_queue;
+        while (!sim_list_empty(queue)) {
+            sim_list_insert_tail(&sim_free, sim_list_remove_head(queue));
+            sim_stats.buffers_free++;
+        }
+        sim_stats.free_returns++;
+        sim_c1toc2 &= ~SIM_BIT(IPCC_CH_MM);
+    }
+
+    if (sim_c1toc2 & SIM_BIT(IPCC_CH_SYSTEM)) {
+        sim_system_command();
+    }
+    if ((sim_c1toc2 & SIM_BIT(IPCC_CH_BLE)) && sim_stats.buffers_free >= 1) {
+        sim_command();
+    }
+    if ((sim_c1toc2 & SIM_BIT(IPCC_CH_ACL)) && sim_stats.buffers_free >= 2) {
+        sim_acl();
+    }
+
+    while (sim_reports_left > 0 && sim_stats.buffers_free > 0) {
+        hal_ipcc_buffer_t *report = sim_event(&sim_events, HAL_IPCC_PACKET_EVENT, 0x3E, 12 + SIM_REPORT_DATA);
+        report->data[2] = 0x02;             /* LE Advertising Report */
+        report->data[3] = 1;
+        report->data[4] = 0;                /* ADV_IND */
+        report->data[5] = 0;
+        memset(&report->data[6], 0xC0, 6);
+        report->data[12] = SIM_REPORT_DATA;
+        memset(&report->data[13], 0, SIM_REPORT_DATA);
+        memcpy(&report->data[13], &sim_report_next, sizeof(sim_report_next));
+        report->data[13 + SIM_REPORT_DATA] = (uint8_t)-60;
+        sim_report_next++;
+        sim_reports_left--;
+    }
+    if (sim_reports_left > 0) {
+        sim_stats.stalls++;
+    }
+
+    sim_publish(&sim_system_events, sim_table->sys->system_queue, IPCC_CH_SYSTEM);
+    sim_publish(&sim_events, sim_table->ble->event_queue, IPCC_CH_BLE);
+}
+
+void ipcc_sim_queue_reports(uint32_t count)
+{
+    sim_reports_left += count;
+}
+
+void ipcc_sim_get_stats(ipcc_sim_stats_t *stats)
+{
+    *stats = sim_stats;
+    stats->irq_enabled = sim_enabled && sim_handler != NULL;
+}
+
+/* Kernel interrupt calls hal_ipcc.c makes; only the IPCC receive line exists here */
+
+kernel_status_t interrupt_register(irq_number_t irq, irq_handler_t handler, irq_priority_t priority,
+                                   const char *name)
+{
+    (void)priority;
+    (void)name;
+    if (irq != IRQ_IPCC_C1_RX || handler == NULL || sim_handler != NULL) {
+        return KERNEL_ERROR;
+    }
+    sim_handler = handler;
+    return KERNEL_OK;
+}
+
+kernel_status_t interrupt_unregister(irq_number_t irq)
+{
+    if (irq != IRQ_IPCC_C1_RX) {
+        return KERNEL_ERROR;
+    }
+    sim_handler = NULL;
+    sim_enabled = false;
+    return KERNEL_OK;
+}
+
+kernel_status_t interrupt_enable(irq_number_t irq)
+{
+    if (irq != IRQ_IPCC_C1_RX || sim_handler == NULL) {
+        return KERNEL_ERROR;
+    }
+    sim_enabled = true;
+    sim_interrupt();
+    return KERNEL_OK;
+}
+
+kernel_status_t interrupt_disable(irq_number_t irq)
+{
+    if (irq != IRQ_IPCC_C1_RX) {
+        return KERNEL_ERROR;
+    }
+    sim_enabled = false;
+    return KERNEL_OK;
+}
+
+/* Static helper functions */
+
+/**
+ * @brief Take the receive interrupt if it is pending and CPU1 can take it
+ */
+static void sim_interrupt(void)
+{
+    if (sim_locked || sim_in_irq || !sim_enabled || sim_handler == NULL || (sim_c1cr & SIM_RXOIE) == 0 ||
+        (sim_c2toc1 & ~sim_c1mr & SIM_CHANNELS) == 0) {
+        return;
+    }
+
+    sim_in_irq = true;
+    sim_handler();
+    sim_in_irq = false;
+}
+
+static hal_ipcc_buffer_t *sim_take(void)
+{
+    sim_stats.buffers_free--;
+    return (hal_ipcc_buffer_t *)(void *)sim_list_remove_head(&sim_free);
+}
+
+/**
+ * @brief Queue an event with its header filled in; the caller checked for a free buffer
+ */
+static hal_ipcc_buffer_t *sim_event(hal_ipcc_node_t *queue, uint8_t type, uint8_t code, uint8_t length)
+{
+    hal_ipcc_buffer_t *event = sim_take();
+
+    event->type = type;
+    event->data[0] = code;
+    event->data[1] = length;
+    sim_list_insert_tail(queue, (hal_ipcc_node_t *)(void *)event);
+    sim_stats.events++;
+    return event;
+}
+
+/**
+ * @brief Answer the HCI command in the command buffer with Command Complete
+ */
+static void sim_command(void)
+{
+    const hal_ipcc_buffer_t *command = sim_table->ble->command_buffer;
+    uint16_t opcode = (uint16_t)(command->data[0] | (command->data[1] << 8));
+    bool buffer_size = (opcode == 0x2002);
+    hal_ipcc_buffer_t *event = sim_event(&sim_events, HAL_IPCC_PACKET_EVENT, 0x0E, buffer_size ? 7 : 4);
+
+    event->data[2] = 1;
+    event->data[3] = (uint8_t)opcode;
+    event->data[4] = (uint8_t)(opcode >> 8);
+    event->data[5] = (command->type == HAL_IPCC_PACKET_COMMAND) ? 0x00 : 0x12;
+    if (buffer_size) {
+        event->data[6] = 251;
+        event->data[7] = 0;
+        event->data[8] = 8;
+    }
+
+    sim_stats.commands++;
+    sim_c1toc2 &= ~SIM_BIT(IPCC_CH_BLE);
+}
+
+/**
+ * @brief Take the ACL packet: complete it and send it back
+ */
+static void sim_acl(void)
+{
+    const hal_ipcc_buffer_t *acl = sim_table->ble->acl_buffer;
+    uint32_t length = 4U + (uint32_t)(acl->data[2] | (acl->data[3] << 8));
+
+    hal_ipcc_buffer_t *completed = sim_event(&sim_events, HAL_IPCC_PACKET_EVENT, 0x13, 5);
+    completed->data[2] = 1;
+    completed->data[3] = acl->data[0];
+    completed->data[4] = (uint8_t)(acl->data[1] & 0x0F);
+    completed->data[5] = 1;
+    completed->data[6] = 0;
+
+    hal_ipcc_buffer_t *echo = sim_take();
+    echo->type = HAL_IPCC_PACKET_ACL;
+    memcpy(echo->data, acl->data, length);
+    sim_list_insert_tail(&sim_events, (hal_ipcc_node_t *)(void *)echo);
+    sim_stats.events++;
+
+    sim_stats.acl_packets++;
+    sim_stats.acl_bytes += length - 4U;
+    sim_c1toc2 &= ~SIM_BIT(IPCC_CH_ACL);
+}
+
+/**
+ * @brief Answer the system command in place
+ */
+static void sim_system_command(void)
+{
+    hal_ipcc_buffer_t *buffer = sim_table->sys->command_buffer;
+    uint16_t opcode = (uint16_t)(buffer->data[0] | (buffer->data[1] << 8));
+    uint8_t status = 0x01;      /* Unknown command */
+
+    if (buffer->type == IPCC_PACKET_SYSTEM_COMMAND && opcode == SHCI_OPCODE_BLE_INIT) {
+        const ipcc_ble_init_t *init = (const ipcc_ble_init_t *)(const void *)&buffer->data[3];
+        bool valid = buffer->data[2] == sizeof(ipcc_ble_init_t) && (init->options & SHCI_BLE_OPTIONS_LL_ONLY);
+        status = valid ? 0x00 : 0x12;
+        sim_stats.ble_running = valid;
+    }
+
+    buffer->type = IPCC_PACKET_SYSTEM_RESPONSE;
+    buffer->data[0] = SHCI_EVENT_COMMAND_COMPLETE;
+    buffer->data[1] = 4;
+    buffer->data[2] = 1;
+    buffer->data[3] = (uint8_t)opcode;
+    buffer->data[4] = (uint8_t)(opcode >> 8);
+    buffer->data[5] = status;
+    sim_c1toc2 &= ~SIM_BIT(IPCC_CH_SYSTEM);
+}
+
+/**
+ * @brief Move pending events onto a queue CPU2 owns and set its channel
+ */
+static void sim_publish(hal_ipcc_node_t *pending, hal_ipcc_node_t *queue, uint32_t channel)
+{
+    if ((sim_c2toc1 & SIM_BIT(channel)) != 0 || sim_list_empty(pending)) {
+        return;
+    }
+
+    while (!sim_list_empty(pending)) {
+        sim_list_insert_tail(queue, sim_list_remove_head(pending));
+    }
+    sim_c2toc1 |= SIM_BIT(channel);
+    if (channel == IPCC_CH_BLE) {
+        sim_stats.publishes++;
+    }
+    sim_interrupt();
+}
+
+static void sim_list_init(hal_ipcc_node_t *head)
+{
+    head->next = head;
+    head->prev = head;
+}
+
+static bool sim_list_empty(const hal_ipcc_node_t *head)
+{
+    return head->next == head;
+}
+
+static void sim_list_insert_tail(hal_ipcc_node_t *head, hal_ipcc_node_t *node)
+{
+    node->next = head;
+    node->prev = head->prev;
+    head->prev->next = node;
+    head->prev = node;
+}
+
+static hal_ipcc_node_t *sim_list_remove_head(hal_ipcc_node_t *head)
+{
+    hal_ipcc_node_t *node = head->next;
+
+    head->next = node->next;
+    node->next->prev = head;
+    return node;
+}
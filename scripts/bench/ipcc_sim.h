@@ -0,0 +1,61 @@
+/**
+ * @file ipcc_sim.h
+ * @brief Host model of the IPCC and of CPU2's side of the mailbox
+ *
+ * src/hal/hal_ipcc.c includes this instead of touching registers when it
+ * is built with HAL_IPCC_SIMULATOR. CPU2 does not run on its own: the
+ * bench calls ipcc_sim_run() between CPU1 calls, and each pass does what
+ * CPU2 would do with the channels set since the last one. The receive
+ * interrupt is taken at once unless CPU1 holds its lock, and then on
+ * unlock, as on the target.
+ */
+
+#ifndef IPCC_SIM_H
+#define IPCC_SIM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Hooks for hal_ipcc.c */
+#define IPCC_READ(offset)           ipcc_sim_read(offset)
+#define IPCC_WRITE(offset, value)   ipcc_sim_write((offset), (value))
+#define IPCC_CLOCK_ENABLE()         ((void)0)
+#define IPCC_BOOT_CPU2(table)       ipcc_sim_boot(table)
+#define IPCC_BARRIER()              __atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+uint32_t ipcc_sim_read(uint32_t offset);
+void ipcc_sim_write(uint32_t offset, uint32_t value);
+void ipcc_sim_boot(const void *ref_table);
+uint32_t ipcc_sim_lock(void);
+void ipcc_sim_unlock(uint32_t state);
+
+/**
+ * @brief What the simulated CPU2 has done
+ */
+typedef struct {
+    uint32_t commands;                  /* HCI commands answered */
+    uint32_t acl_packets;               /* ACL packets taken (and echoed) */
+    uint32_t acl_bytes;
+    uint32_t events;                    /* Events put on the queues */
+    uint32_t publishes;                 /* Times the BLE event channel was set */
+    uint32_t free_returns;              /* Free queue batches taken back */
+    uint32_t stalls;                    /* Passes that found no free buffer */
+    uint32_t buffers;                   /* Buffers carved from the pool */
+    uint32_t buffers_free;              /* Of those, with CPU2 now */
+    bool ble_running;                   /* SHCI_C2_BLE_Init accepted */
+    bool irq_enabled;                   /* CPU1 installed and enabled the receive interrupt */
+} ipcc_sim_stats_t;
+
+/**
+ * @brief One CPU2 pass: take commands, ACL and free buffers, publish events
+ */
+void ipcc_sim_run(void);
+
+/**
+ * @brief Have CPU2 send this many LE Advertising Reports, numbered from 0
+ */
+void ipcc_sim_queue_reports(uint32_t count);
+
+void ipcc_sim_get_stats(ipcc_sim_stats_t *stats);
+
+#endif /* IPCC_SIM_H */
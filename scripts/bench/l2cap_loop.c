@@ -0,0 +1,260 @@
+/**
+ * @file l2cap_loop.c
+ * @brief Host model of one L2CAP credit based channel to the phone bridge
+ *
+ * One channel, listening or not, is open at a time. The device's SDUs
+ * wait on a queue of HAL_RADIO_L2CAP_QUEUE entries as on the target;
+ * credits are not modelled, the per-event SDU budget stands in for them.
+ */
+
+#include "l2cap_loop.h"
+#include <string.h>
+
+#define LOOP_CHANNEL                1
+
+/**
+ * @brief SDU queued by the device, gathered when the link takes it
+ */
+typedef struct {
+    const hal_radio_segment_t *segments;
+    uint32_t count;
+    uint32_t length;
+} loop_sdu_t;
+
+/**
+ * @brief SDU from the bridge, copied in
+ */
+typedef struct {
+    uint8_t data[L2CAP_LOOP_SDU_MAX];
+    uint32_t length;
+} loop_delivery_t;
+
+static l2cap_loop_config_t loop_config;
+static hal_radio_l2cap_config_t loop_channel;
+static bool loop_allocated = false;
+static bool loop_up = false;
+static loop_sdu_t loop_queue[HAL_RADIO_L2CAP_QUEUE];
+static uint32_t loop_queue_head = 0;
+static uint32_t loop_queue_tail = 0;
+static loop_delivery_t loop_down[L2CAP_LOOP_BRIDGE_QUEUE];
+static uint32_t loop_down_head = 0;
+static uint32_t loop_down_tail = 0;
+static uint32_t loop_budget = 0;            /* SDUs the device may still send this event */
+static uint32_t loop_now = 0;
+static uint8_t loop_gather[L2CAP_LOOP_SDU_MAX];
+static l2cap_loop_stats_t loop_stats;
+
+/* Static function prototypes */
+static void loop_take(void);
+static void loop_event(hal_radio_l2cap_event_t event, const void *data, uint32_t length);
+
+void l2cap_loop_configure(const l2cap_loop_config_t *config)
+{
+    loop_config = *config;
+    loop_up = false;
+    loop_queue_head = loop_queue_tail = 0;
+    loop_down_head = loop_down_tail = 0;
+    loop_budget = 0;
+    memset(&loop_stats, 0, sizeof(loop_stats));
+}
+
+void l2cap_loop_open(void)
+{
+    if (!loop_allocated || loop_up) {
+        return;
+    }
+    loop_up = true;
+    loop_budget = loop_config.sdus_per_event;
+    loop_event(HAL_RADIO_L2CAP_OPENED, NULL, 0);
+}
+
+void l2cap_loop_close(void)
+{
+    if (!loop_up) {
+        return;
+    }
+    loop_up = false;
+    loop_stats.dropped_on_close += loop_queue_head - loop_queue_tail;
+    loop_queue_head = loop_queue_tail = 0;
+    loop_down_head = loop_down_tail = 0;
+    loop_event(HAL_RADIO_L2CAP_CLOSED, NULL, 0);
+}
+
+bool l2cap_loop_deliver(const uint8_t *sdu, uint32_t length)
+{
+    if (loop_down_head - loop_down_tail >= L2CAP_LOOP_BRIDGE_QUEUE || length > L2CAP_LOOP_SDU_MAX ||
+        length > loop_channel.mtu) {
+        loop_stats.bridge_dropped++;
+        return false;
+    }
+
+    loop_delivery_t *delivery = &loop_down[loop_down_head % L2CAP_LOOP_BRIDGE_QUEUE];
+    memcpy(delivery->data, sdu, length);
+    delivery->length = length;
+    loop_down_head++;
+    return true;
+}
+
+void l2cap_loop_run(void)
+{
+    loop_now += loop_config.interval_us;
+    loop_stats.events++;
+    if (!loop_up) {
+        return;
+    }
+
+    /* Device to bridge, in what inline sends left of this event */
+    while (loop_budget > 0 && loop_queue_tail != loop_queue_head && loop_up) {
+        loop_take();
+    }
+
+    /* Bridge to device, each SDU through the channel's receive buffer */
+    for (uint32_t i = 0; i < loop_config.sdus_per_event && loop_down_tail != loop_down_head && loop_up; i++) {
+        loop_delivery_t *delivery = &loop_down[loop_down_tail % L2CAP_LOOP_BRIDGE_QUEUE];
+        loop_down_tail++;
+        memcpy(loop_channel.rx_buffer, delivery->data, delivery->length);
+        loop_stats.sdus_down++;
+        loop_stats.bytes_down += delivery->length;
+        loop_event(HAL_RADIO_L2CAP_RECEIVED, loop_channel.rx_buffer, delivery->length);
+    }
+
+    /* The next event's buffers; inline sends draw on them until it runs */
+    loop_budget = loop_config.sdus_per_event;
+}
+
+uint32_t l2cap_loop_now_us(void)
+{
+    return loop_now;
+}
+
+void l2cap_loop_get_stats(l2cap_loop_stats_t *stats)
+{
+    *stats = loop_stats;
+}
+
+/* Radio HAL stand-ins */
+
+hal_result_t hal_radio_get_time(uint32_t *time_us)
+{
+    if (!time_us) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+    *time_us = loop_now;
+    return HAL_OK;
+}
+
+hal_result_t hal_radio_l2cap_open(uint32_t radio_id, const hal_radio_l2cap_config_t *config, bool listen,
+                                  hal_radio_channel_t *channel)
+{
+    (void)radio_id;
+    (void)listen;
+
+    if (!config || !channel || !config->rx_buffer || !config->callback) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+    if (loop_allocated) {
+        return HAL_ERROR_NO_MEMORY;
+    }
+
+    loop_channel = *config;
+    loop_allocated = true;
+    *channel = LOOP_CHANNEL;
+    return HAL_OK;
+}
+
+hal_result_t hal_radio_l2cap_send(hal_radio_channel_t channel, const hal_radio_segment_t *segments,
+                                  uint32_t count)
+{
+    if (channel != LOOP_CHANNEL || !loop_allocated || !segments || count == 0) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+    if (!loop_up) {
+        return HAL_ERROR_NOT_INITIALIZED;
+    }
+
+    uint32_t length = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        length += segments[i].length;
+    }
+    if (length > loop_config.peer_mtu || length > L2CAP_LOOP_SDU_MAX) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+    if (loop_queue_head - loop_queue_tail >= HAL_RADIO_L2CAP_QUEUE) {
+        loop_stats.send_busy++;
+        return HAL_ERROR_RESOURCE_BUSY;
+    }
+
+    loop_sdu_t *sdu = &loop_queue[loop_queue_head % HAL_RADIO_L2CAP_QUEUE];
+    sdu->segments = segments;
+    sdu->count = count;
+    sdu->length = length;
+    loop_queue_head++;
+
+    if (loop_config.sent_inline && loop_budget > 0 && loop_queue_tail + 1 == loop_queue_head) {
+        loop_take();
+    }
+    return HAL_OK;
+}
+
+hal_result_t hal_radio_l2cap_close(hal_radio_channel_t channel)
+{
+    if (channel != LOOP_CHANNEL || !loop_allocated) {
+        return HAL_ERROR_RESOURCE_NOT_FOUND;
+    }
+
+    /* Queued SDUs are dropped without an event, as on the target */
+    loop_allocated = false;
+    loop_up = false;
+    loop_queue_head = loop_queue_tail = 0;
+    loop_down_head = loop_down_tail = 0;
+    return HAL_OK;
+}
+
+hal_result_t hal_radio_l2cap_get_stats(hal_radio_channel_t channel, hal_radio_l2cap_stats_t *stats)
+{
+    if (channel != LOOP_CHANNEL || !loop_allocated || !stats) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    memset(stats, 0, sizeof(*stats));
+    stats->sdus_sent = loop_stats.sdus_up;
+    stats->sdus_received = loop_stats.sdus_down;
+    stats->bytes_sent = loop_stats.bytes_up;
+    stats->bytes_received = loop_stats.bytes_down;
+    stats->peer_mtu = loop_config.peer_mtu;
+    stats->peer_mps = loop_config.peer_mps;
+    return HAL_OK;
+}
+
+/* Static helper functions */
+
+/**
+ * @brief Gather the oldest device SDU, hand it to the bridge and report it sent
+ */
+static void loop_take(void)
+{
+    loop_sdu_t *sdu = &loop_queue[loop_queue_tail % HAL_RADIO_L2CAP_QUEUE];
+    const hal_radio_segment_t *segments = sdu->segments;
+    uint32_t length = 0;
+
+    for (uint32_t i = 0; i < sdu->count; i++) {
+        memcpy(&loop_gather[length], segments[i].data, segments[i].length);
+        length += segments[i].length;
+    }
+    loop_queue_tail++;
+    loop_budget--;
+    loop_stats.sdus_up++;
+    loop_stats.bytes_up += length;
+
+    if (loop_config.bridge) {
+        loop_config.bridge(loop_gather, length, loop_config.user_data);
+    } else {
+        l2cap_loop_deliver(loop_gather, length);
+    }
+    loop_event(HAL_RADIO_L2CAP_SENT, segments, length);
+}
+
+static void loop_event(hal_radio_l2cap_event_t event, const void *data, uint32_t length)
+{
+    loop_channel.callback(LOOP_CHANNEL, event, data, length, loop_channel.user_data);
+}
@@ -0,0 +1,97 @@
+/**
+ * @file l2cap_loop.h
+ * @brief Host model of one L2CAP credit based channel to the phone bridge
+ *
+ * Stands in for hal_radio_l2cap_*() and hal_radio_get_time() so the
+ * services above the radio HAL build on the host. The link runs on a
+ * virtual clock: each l2cap_loop_run() is one connection event that
+ * moves a fixed number of SDUs each way and advances the clock by one
+ * connection interval. SDUs queued by the device are gathered from their
+ * segments only then, as the real link does, so a sender that lets go of
+ * its bytes early shows up as corrupted data.
+ *
+ * The bridge gets every SDU the device sends. Without a bridge callback
+ * it echoes them back, which loops the device onto itself.
+ */
+
+#ifndef L2CAP_LOOP_H
+#define L2CAP_LOOP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "hal_radio.h"
+
+/* Model limits */
+#define L2CAP_LOOP_SDU_MAX          512         /* Largest SDU the model carries */
+#define L2CAP_LOOP_BRIDGE_QUEUE     64          /* SDUs the bridge may have waiting for the device */
+
+/**
+ * @brief Bridge side of the link: an SDU the device sent
+ * @param sdu SDU bytes, valid during the call
+ * @param length SDU length
+ * @param user_data User data from the configuration
+ */
+typedef void (*l2cap_loop_bridge_t)(const uint8_t *sdu, uint32_t length, void *user_data);
+
+/**
+ * @brief Link model configuration
+ */
+typedef struct {
+    uint16_t peer_mtu;                  /* Largest SDU the bridge accepts */
+    uint16_t peer_mps;                  /* Largest K-frame payload the bridge accepts */
+    uint32_t interval_us;               /* Virtual time per connection event */
+    uint32_t sdus_per_event;            /* SDUs moved each way per event */
+    bool sent_inline;                   /* Report SENT from inside hal_radio_l2cap_send(), as a link with free controller buffers does */
+    l2cap_loop_bridge_t bridge;         /* Bridge for device SDUs, NULL to echo them */
+    void *user_data;                    /* User data for the bridge */
+} l2cap_loop_config_t;
+
+/**
+ * @brief What went over the link
+ */
+typedef struct {
+    uint32_t events;                    /* Connection events run */
+    uint32_t sdus_up;                   /* SDUs from the device to the bridge */
+    uint32_t sdus_down;                 /* SDUs from the bridge to the device */
+    uint64_t bytes_up;
+    uint64_t bytes_down;
+    uint32_t send_busy;                 /* hal_radio_l2cap_send() calls refused with a full queue */
+    uint32_t bridge_dropped;            /* Bridge SDUs refused with a full queue or over the device's MTU */
+    uint32_t dropped_on_close;          /* Queued device SDUs lost to l2cap_loop_close() */
+} l2cap_loop_stats_t;
+
+/**
+ * @brief Set up the model; the channel stays down until l2cap_loop_open()
+ * @param config Model configuration, copied
+ */
+void l2cap_loop_configure(const l2cap_loop_config_t *config);
+
+/**
+ * @brief The bridge connected: report HAL_RADIO_L2CAP_OPENED
+ */
+void l2cap_loop_open(void);
+
+/**
+ * @brief The link dropped: queued SDUs are lost, report HAL_RADIO_L2CAP_CLOSED
+ */
+void l2cap_loop_close(void);
+
+/**
+ * @brief Queue an SDU from the bridge for the device
+ * @return false if the queue is full or the SDU is over the device's MTU
+ */
+bool l2cap_loop_deliver(const uint8_t *sdu, uint32_t length);
+
+/**
+ * @brief One connection event
+ */
+void l2cap_loop_run(void);
+
+/**
+ * @brief Virtual time in microseconds, as hal_radio_get_time() reports it
+ */
+uint32_t l2cap_loop_now_us(void);
+
+void l2cap_loop_get_stats(l2cap_loop_stats_t *stats);
+
+#endif /* L2CAP_LOOP_H */
@@ -0,0 +1,406 @@
+/**
+ * @file net_bench.c
+ * @brief Host benchmark for TCP over the WiFi emulation link, with loss
+ *
+ * Runs src/applications/net_stack.c and net_tcp.c on wifi_emu.c and
+ * l2cap_loop.c. The bridge loops every frame back, so a client and a
+ * server socket on the one stack talk to each other over the link; it
+ * drops a share of whole frames, all fragments together, in both
+ * directions. Reports goodput on link time and host time with the
+ * retransmissions it took, checks the stream byte for byte, stalls the
+ * reader long enough that window probes counted as losses would reset
+ * the connection, closes the reader with data still arriving and checks
+ * the sender is reset, and checks that every frame ends up back in the
+ * pool.
+ *
+ * Usage: net_bench [-n BYTES]
+ */
+
+#include "net_stack.h"
+#include "l2cap_loop.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_INTERVAL_US           7500
+#define BENCH_SDUS_PER_EVENT        8
+#define BENCH_PEER_MTU              512
+#define BENCH_PEER_MPS              247
+#define BENCH_ADDRESS               NET_ADDRESS(10, 0, 0, 2)
+#define BENCH_PORT                  5001
+#define BENCH_SPIN                  2000000     /* Link events before a run counts as stuck */
+#define BENCH_STALL_MS              60000       /* Reader stall, longer than every retry put together */
+#define BENCH_STALL_BYTES           (64 * 1024) /* Stream for the stall, well over one window */
+#define BENCH_CHUNK                 2048
+
+/**
+ * @brief One transfer from the client socket to the server socket
+ */
+typedef struct {
+    net_socket_t listener;
+    net_socket_t client;
+    net_socket_t server;
+    uint32_t total;                 /* Stream bytes to send */
+    uint32_t sent;
+    uint32_t received;
+    uint32_t corrupted;
+    bool reading;                   /* Server reads; false stalls it */
+    bool eof;                       /* Server saw the client's FIN */
+    hal_result_t error;             /* First error either socket returned */
+} bench_transfer_t;
+
+static bench_transfer_t bench;
+static uint32_t bench_loss_permille = 0;
+static uint32_t bench_random = 0x2545F491;
+static bool bench_dropping = false;
+static uint32_t bench_frames_dropped = 0;
+
+/* Static function prototypes */
+static void bench_bridge(const uint8_t *sdu, uint32_t length, void *user_data);
+static int bench_start(uint32_t loss_permille, uint32_t total);
+static int bench_stop(const char *name);
+static void bench_event(void);
+static void bench_pump(void);
+static uint8_t bench_byte(uint32_t offset);
+static int bench_bulk(uint32_t loss_permille, uint32_t total);
+static int bench_stall(void);
+static int bench_close_reader(void);
+static double bench_now(void);
+
+int main(int argc, char **argv)
+{
+    uint32_t total = 256 * 1024;
+    int failed = 0;
+
+    if (argc == 3 && strcmp(argv[1], "-n") == 0) {
+        total = (uint32_t)strtoul(argv[2], NULL, 0);
+    } else if (argc != 1) {
+        fprintf(stderr, "usage: %s [-n BYTES]\n", argv[0]);
+        return 2;
+    }
+    if (total == 0) {
+        return 2;
+    }
+
+    printf("link model: %u SDUs each way per %u us event, peer MTU %u, MPS %u; pool %u x %u bytes, MSS %u\n",
+           (unsigned)BENCH_SDUS_PER_EVENT, (unsigned)BENCH_INTERVAL_US, (unsigned)BENCH_PEER_MTU,
+           (unsigned)BENCH_PEER_MPS, (unsigned)WIFI_EMU_POOL_BUFFERS, (unsigned)WIFI_EMU_BUFFER_SIZE,
+           (unsigned)NET_TCP_MSS);
+
+    failed |= bench_bulk(0, total);
+    failed |= bench_bulk(10, total);
+    failed |= bench_bulk(50, total);
+    failed |= bench_stall();
+    failed |= bench_close_reader();
+    return failed;
+}
+
+/* Static helper functions */
+
+/**
+ * @brief Loop fragments back, dropping whole frames at the configured rate
+ */
+static void bench_bridge(const uint8_t *sdu, uint32_t length, void *user_data)
+{
+    (void)user_data;
+
+    /* Fragment header: first, last, connection in the low nibble */
+    if (sdu[0] & 0x80) {
+        bench_random ^= bench_random << 13;
+        bench_random ^= bench_random >> 17;
+        bench_random ^= bench_random << 5;
+        bench_dropping = (bench_random % 1000) < bench_loss_permille;
+        if (bench_dropping) {
+            bench_frames_dropped++;
+        }
+    }
+    if (!bench_dropping) {
+        l2cap_loop_deliver(sdu, length);
+    }
+}
+
+/**
+ * @brief Bring up the link, the stack and a connected pair of sockets
+ */
+static int bench_start(uint32_t loss_permille, uint32_t total)
+{
+    l2cap_loop_config_t link = {
+        .peer_mtu = BENCH_PEER_MTU,
+        .peer_mps = BENCH_PEER_MPS,
+        .interval_us = BENCH_INTERVAL_US,
+        .sdus_per_event = BENCH_SDUS_PER_EVENT,
+        .sent_inline = false,
+        .bridge = bench_bridge,
+        .user_data = NULL
+    };
+    wifi_emu_config_t config = {
+        .radio_id = 0,
+        .psm = 0x0080,
+        .receive = net_input,
+        .user_data = NULL
+    };
+    net_config_t stack = {
+        .connection = 0,
+        .address = BENCH_ADDRESS,
+        .iss_key = { 0x6B8B4567, 0x327B23C6, 0x643C9869, 0x66334873 }
+    };
+    uint8_t connection;
+
+    bench_loss_permille = 0;
+    bench_dropping = false;
+    bench_frames_dropped = 0;
+    memset(&bench, 0, sizeof(bench));
+    bench.total = total;
+    bench.reading = true;
+
+    l2cap_loop_configure(&link);
+    if (wifi_emu_init(&config) != HAL_OK) {
+        fprintf(stderr, "wifi_emu_init failed\n");
+        return 1;
+    }
+    l2cap_loop_open();
+    if (wifi_emu_connect("bench", 0, &connection) != HAL_OK || connection != stack.connection ||
+        net_init(&stack) != HAL_OK) {
+        fprintf(stderr, "link bring-up failed\n");
+        return 1;
+    }
+
+    if (net_socket_open(NET_TCP, &bench.listener) != HAL_OK ||
+        net_socket_bind(bench.listener, BENCH_PORT) != HAL_OK || net_socket_listen(bench.listener) != HAL_OK ||
+        net_socket_open(NET_TCP, &bench.client) != HAL_OK ||
+        net_socket_connect(bench.client, BENCH_ADDRESS, BENCH_PORT) != HAL_OK) {
+        fprintf(stderr, "socket setup failed\n");
+        return 1;
+    }
+    for (uint32_t spin = 0; spin < BENCH_SPIN && bench.server == NET_SOCKET_NONE; spin++) {
+        bench_event();
+        net_socket_accept(bench.listener, &bench.server);
+    }
+    if (bench.server == NET_SOCKET_NONE || net_socket_get_state(bench.client) != NET_TCP_ESTABLISHED) {
+        fprintf(stderr, "connection setup failed\n");
+        return 1;
+    }
+
+    /* Handshake without loss, so every run starts from the same RTO */
+    bench_loss_permille = loss_permille;
+    return 0;
+}
+
+/**
+ * @brief Take everything down and check the pool is whole again
+ */
+static int bench_stop(const char *name)
+{
+    net_deinit();
+    wifi_emu_disconnect(0);
+    wifi_emu_deinit();
+
+    if (wifi_emu_available() != WIFI_EMU_POOL_BUFFERS) {
+        fprintf(stderr, "%s: %u of %u buffers back in the pool\n", name, (unsigned)wifi_emu_available(),
+                (unsigned)WIFI_EMU_POOL_BUFFERS);
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief One link event, the service's task, then the stack's timers
+ */
+static void bench_event(void)
+{
+    l2cap_loop_run();
+    wifi_emu_poll();
+    net_poll(l2cap_loop_now_us() / 1000);
+}
+
+/**
+ * @brief Client writes what the stream has room for, server reads and checks it
+ */
+static void bench_pump(void)
+{
+    static uint8_t data[BENCH_CHUNK];
+    hal_result_t result;
+
+    while (bench.sent < bench.total && bench.error == HAL_OK) {
+        uint32_t length = bench.total - bench.sent < BENCH_CHUNK ? bench.total - bench.sent : BENCH_CHUNK;
+        uint32_t sent = 0;
+        for (uint32_t i = 0; i < length; i++) {
+            data[i] = bench_byte(bench.sent + i);
+        }
+        result = net_socket_send(bench.client, data, length, &sent);
+        if (result != HAL_OK) {
+            if (result != HAL_ERROR_RESOURCE_BUSY) {
+                bench.error = result;
+            }
+            break;
+        }
+        bench.sent += sent;
+        if (bench.sent == bench.total) {
+            net_socket_close(bench.client);
+            bench.client = NET_SOCKET_NONE;
+        }
+    }
+
+    while (bench.reading && !bench.eof && bench.error == HAL_OK) {
+        uint32_t received = 0;
+        result = net_socket_recv(bench.server, data, sizeof(data), &received);
+        if (result != HAL_OK) {
+            if (result != HAL_ERROR_RESOURCE_BUSY) {
+                bench.error = result;
+            }
+            break;
+        }
+        if (received == 0) {
+            bench.eof = true;
+            break;
+        }
+        for (uint32_t i = 0; i < received; i++) {
+            if (data[i] != bench_byte(bench.received + i)) {
+                bench.corrupted++;
+            }
+        }
+        bench.received += received;
+    }
+}
+
+/**
+ * @brief Stream byte at an offset; a period prime to the segment size catches misplaced segments
+ */
+static uint8_t bench_byte(uint32_t offset)
+{
+    return (uint8_t)((offset % 251) ^ (offset >> 11));
+}
+
+/**
+ * @brief One stream through the link at a loss rate, closed by the sender
+ */
+static int bench_bulk(uint32_t loss_permille, uint32_t total)
+{
+    if (bench_start(loss_permille, total) != 0) {
+        return 1;
+    }
+
+    uint32_t link_start = l2cap_loop_now_us();
+    double start = bench_now();
+    for (uint32_t spin = 0; spin < BENCH_SPIN && !bench.eof && bench.error == HAL_OK; spin++) {
+        bench_pump();
+        bench_event();
+    }
+    double elapsed = bench_now() - start;
+    double link = (l2cap_loop_now_us() - link_start) / 1e6;
+
+    net_stats_t stats;
+    net_get_stats(&stats);
+    printf("loss %4.1f%%: %u bytes in %.1f s link (%.1f kB/s), %.0f kB/s host, %u frames dropped, "
+           "%u segments sent, %u timeouts, %u fast retransmits, %u ahead of a gap, %u window probes\n",
+           loss_permille / 10.0, (unsigned)bench.received, link, link > 0 ? bench.received / link / 1e3 : 0.0,
+           elapsed > 0 ? bench.received / elapsed / 1e3 : 0.0, (unsigned)bench_frames_dropped,
+           (unsigned)stats.tcp_sent, (unsigned)stats.tcp_retransmits, (unsigned)stats.tcp_fast_retransmits,
+           (unsigned)stats.tcp_out_of_order, (unsigned)stats.tcp_window_probes);
+
+    net_socket_close(bench.server);
+    net_socket_close(bench.listener);
+    int failed = bench_stop("bulk");
+    if (!bench.eof || bench.received != total || bench.corrupted != 0 || bench.error != HAL_OK ||
+        stats.tcp_resets != 0) {
+        fprintf(stderr, "bulk: %u of %u bytes, %u corrupted, eof %d, error %d, %u resets\n",
+                (unsigned)bench.received, (unsigned)total, (unsigned)bench.corrupted, (int)bench.eof,
+                (int)bench.error, (unsigned)stats.tcp_resets);
+        failed = 1;
+    }
+    return failed;
+}
+
+/**
+ * @brief The reader stops long enough for the window to close, then carries on
+ *
+ * Window probes back off on their own and never count as retries: the
+ * connection must outlive a stall longer than every retry put together.
+ */
+static int bench_stall(void)
+{
+    uint32_t total = BENCH_STALL_BYTES;
+
+    if (bench_start(0, total) != 0) {
+        return 1;
+    }
+
+    for (uint32_t spin = 0; spin < BENCH_SPIN && bench.received < total / 4; spin++) {
+        bench_pump();
+        bench_event();
+    }
+    bench.reading = false;
+    uint32_t stall_start = l2cap_loop_now_us();
+    while (l2cap_loop_now_us() - stall_start < BENCH_STALL_MS * 1000U && bench.error == HAL_OK) {
+        bench_pump();
+        bench_event();
+    }
+    bench.reading = true;
+    for (uint32_t spin = 0; spin < BENCH_SPIN && !bench.eof && bench.error == HAL_OK; spin++) {
+        bench_pump();
+        bench_event();
+    }
+
+    net_stats_t stats;
+    net_get_stats(&stats);
+    printf("stall %u s: %u window probes, %u timeouts, %u bytes after resuming\n",
+           (unsigned)(BENCH_STALL_MS / 1000), (unsigned)stats.tcp_window_probes,
+           (unsigned)stats.tcp_retransmits, (unsigned)(bench.received - total / 4));
+
+    net_socket_close(bench.server);
+    net_socket_close(bench.listener);
+    int failed = bench_stop("stall");
+    if (!bench.eof || bench.received != total || bench.corrupted != 0 || bench.error != HAL_OK ||
+        stats.tcp_window_probes == 0 || stats.tcp_resets != 0) {
+        fprintf(stderr, "stall: %u of %u bytes, %u corrupted, error %d, %u probes, %u resets\n",
+                (unsigned)bench.received, (unsigned)total, (unsigned)bench.corrupted, (int)bench.error,
+                (unsigned)stats.tcp_window_probes, (unsigned)stats.tcp_resets);
+        failed = 1;
+    }
+    return failed;
+}
+
+/**
+ * @brief The reader closes with data still arriving: the sender must be reset, not left waiting
+ */
+static int bench_close_reader(void)
+{
+    if (bench_start(0, UINT32_MAX) != 0) {
+        return 1;
+    }
+
+    for (uint32_t spin = 0; spin < BENCH_SPIN && bench.received < 16 * 1024; spin++) {
+        bench_pump();
+        bench_event();
+    }
+    net_socket_close(bench.server);
+    bench.reading = false;
+
+    uint32_t spin = 0;
+    for (; spin < BENCH_SPIN && bench.error == HAL_OK; spin++) {
+        bench_pump();
+        bench_event();
+    }
+
+    net_stats_t stats;
+    net_get_stats(&stats);
+    printf("close reader: sender reset after %u link events (%s), %u resets\n", (unsigned)spin,
+           bench.error == HAL_ERROR ? "HAL_ERROR" : "no reset", (unsigned)stats.tcp_resets);
+
+    net_socket_close(bench.client);
+    net_socket_close(bench.listener);
+    int failed = bench_stop("close reader");
+    if (bench.error != HAL_ERROR) {
+        fprintf(stderr, "close reader: sender error %d, expected a reset\n", (int)bench.error);
+        failed = 1;
+    }
+    return failed;
+}
+
+static double bench_now(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
@@ -0,0 +1,438 @@
+/**
+ * @file wifi_bench.c
+ * @brief Host benchmark for the WiFi emulation service over a loopback link
+ *
+ * Runs src/applications/wifi_emu.c on l2cap_loop.c with the bridge
+ * echoing every fragment back, so each frame a station sends comes back
+ * to it reassembled. Reports frames per second of host time (service
+ * cost) and of link time (the modelled BLE link, 8 SDUs per 7.5 ms
+ * event), checks every echoed frame byte for byte and in order, checks
+ * that short frames do not queue behind a full-size sender, drops the
+ * link mid-frame, and checks that every buffer ends up back in the pool.
+ *
+ * Usage: wifi_bench [-n FRAMES]
+ */
+
+#include "wifi_emu.h"
+#include "l2cap_loop.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_INTERVAL_US           7500
+#define BENCH_SDUS_PER_EVENT        8
+#define BENCH_PEER_MTU              512
+#define BENCH_PEER_MPS              247
+#define BENCH_SPIN                  100000      /* Link events before a run counts as stuck */
+#define BENCH_IN_FLIGHT             ((WIFI_EMU_POOL_BUFFERS - WIFI_EMU_MAX_CONNECTIONS) / WIFI_EMU_MAX_CONNECTIONS)
+#define BENCH_SHARE_US              2000000     /* Link time for the sharing run */
+
+/**
+ * @brief One station's traffic
+ */
+typedef struct {
+    uint8_t connection;
+    uint16_t size;                  /* Frame size sent */
+    uint32_t target;                /* Frames to send, 0 for no limit */
+    uint32_t sent;                  /* Frames accepted by wifi_emu_send() */
+    uint32_t received;              /* Frames echoed back */
+    uint64_t received_bytes;
+    uint32_t next;                  /* Frame number expected next */
+    uint32_t gaps;                  /* Frames skipped (lost to a link drop) */
+    uint32_t reordered;
+    uint32_t corrupted;
+} bench_station_t;
+
+static bench_station_t bench_stations[WIFI_EMU_MAX_CONNECTIONS];
+
+/* Static function prototypes */
+static void bench_receive(uint8_t connection, wifi_emu_buffer_t *frame, void *user_data);
+static int bench_start(bool sent_inline);
+static int bench_stop(const char *name);
+static void bench_fill(void);
+static void bench_event(void);
+static void bench_pattern(uint8_t *data, uint32_t length, uint8_t connection, uint32_t number);
+static int bench_echo(uint16_t size, uint32_t count, bool sent_inline);
+static int bench_share(void);
+static int bench_link_drop(uint32_t count);
+static int bench_double_free(void);
+static double bench_now(void);
+
+int main(int argc, char **argv)
+{
+    uint32_t count = 2000;
+    int failed = 0;
+
+    if (argc == 3 && strcmp(argv[1], "-n") == 0) {
+        count = (uint32_t)strtoul(argv[2], NULL, 0);
+    } else if (argc != 1) {
+        fprintf(stderr, "usage: %s [-n FRAMES]\n", argv[0]);
+        return 2;
+    }
+    if (count == 0) {
+        return 2;
+    }
+
+    printf("link model: %u SDUs each way per %u us event, peer MTU %u, MPS %u; pool %u x %u bytes\n",
+           (unsigned)BENCH_SDUS_PER_EVENT, (unsigned)BENCH_INTERVAL_US, (unsigned)BENCH_PEER_MTU,
+           (unsigned)BENCH_PEER_MPS, (unsigned)WIFI_EMU_POOL_BUFFERS, (unsigned)WIFI_EMU_BUFFER_SIZE);
+
+    failed |= bench_echo(64, count, false);
+    failed |= bench_echo(576, count, false);
+    failed |= bench_echo(WIFI_EMU_BUFFER_SIZE, count, false);
+    failed |= bench_echo(WIFI_EMU_BUFFER_SIZE, count, true);
+    failed |= bench_share();
+    failed |= bench_link_drop(count);
+    failed |= bench_double_free();
+    return failed;
+}
+
+/* Static helper functions */
+
+static void bench_receive(uint8_t connection, wifi_emu_buffer_t *frame, void *user_data)
+{
+    (void)user_data;
+
+    bench_station_t *station = &bench_stations[connection];
+    uint32_t number = 0;
+
+    if (frame->length >= sizeof(number)) {
+        memcpy(&number, frame->data, sizeof(number));
+    }
+    if (frame->length != station->size) {
+        station->corrupted++;
+    } else {
+        static uint8_t expected[WIFI_EMU_BUFFER_SIZE];
+        bench_pattern(expected, frame->length, connection, number);
+        if (memcmp(expected, frame->data, frame->length) != 0) {
+            station->corrupted++;
+        }
+    }
+
+    if (number < station->next) {
+        station->reordered++;
+    } else {
+        station->gaps += number - station->next;
+        station->next = number + 1;
+    }
+    station->received++;
+    station->received_bytes += frame->length;
+    wifi_emu_free(frame);
+}
+
+/**
+ * @brief Bring up the link and the four stations
+ */
+static int bench_start(bool sent_inline)
+{
+    l2cap_loop_config_t link = {
+        .peer_mtu = BENCH_PEER_MTU,
+        .peer_mps = BENCH_PEER_MPS,
+        .interval_us = BENCH_INTERVAL_US,
+        .sdus_per_event = BENCH_SDUS_PER_EVENT,
+        .sent_inline = sent_inline,
+        .bridge = NULL,
+        .user_data = NULL
+    };
+    wifi_emu_config_t config = {
+        .radio_id = 0,
+        .psm = 0x0080,
+        .receive = bench_receive,
+        .user_data = NULL
+    };
+
+    l2cap_loop_configure(&link);
+    if (wifi_emu_init(&config) != HAL_OK) {
+        fprintf(stderr, "wifi_emu_init failed\n");
+        return 1;
+    }
+    l2cap_loop_open();
+
+    memset(bench_stations, 0, sizeof(bench_stations));
+    for (uint32_t i = 0; i < WIFI_EMU_MAX_CONNECTIONS; i++) {
+        uint8_t connection;
+        if (wifi_emu_connect("bench", 0, &connection) != HAL_OK || connection != i) {
+            fprintf(stderr, "wifi_emu_connect failed\n");
+            return 1;
+        }
+        bench_stations[i].connection = connection;
+    }
+    return 0;
+}
+
+/**
+ * @brief Take the service down and check the pool is whole again
+ */
+static int bench_stop(const char *name)
+{
+    for (uint32_t i = 0; i < WIFI_EMU_MAX_CONNECTIONS; i++) {
+        wifi_emu_disconnect((uint8_t)i);
+    }
+    wifi_emu_deinit();
+
+    if (wifi_emu_available() != WIFI_EMU_POOL_BUFFERS) {
+        fprintf(stderr, "%s: %u of %u buffers back in the pool\n", name, (unsigned)wifi_emu_available(),
+                (unsigned)WIFI_EMU_POOL_BUFFERS);
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Queue frames round robin, BENCH_IN_FLIGHT per station, keeping a buffer per station for reassembly
+ */
+static void bench_fill(void)
+{
+    bool progress = true;
+
+    while (progress) {
+        progress = false;
+        for (uint32_t i = 0; i < WIFI_EMU_MAX_CONNECTIONS; i++) {
+            bench_station_t *station = &bench_stations[i];
+            wifi_emu_stats_t stats;
+
+            if (station->size == 0 || (station->target && station->sent >= station->target) ||
+                wifi_emu_available() <= WIFI_EMU_MAX_CONNECTIONS) {
+                continue;
+            }
+            wifi_emu_get_stats(station->connection, &stats);
+            if (station->sent - stats.tx_frames >= BENCH_IN_FLIGHT) {
+                continue;
+            }
+
+            wifi_emu_buffer_t *frame = wifi_emu_alloc();
+            frame->length = station->size;
+            bench_pattern(frame->data, frame->length, station->connection, station->sent);
+            if (wifi_emu_send(station->connection, frame) != HAL_OK) {
+                wifi_emu_free(frame);
+                continue;
+            }
+            station->sent++;
+            progress = true;
+        }
+    }
+}
+
+/**
+ * @brief One link event, then the service's task
+ */
+static void bench_event(void)
+{
+    l2cap_loop_run();
+    wifi_emu_poll();
+}
+
+/**
+ * @brief Frame bytes: the frame number, then a pattern unique to station and frame
+ */
+static void bench_pattern(uint8_t *data, uint32_t length, uint8_t connection, uint32_t number)
+{
+    for (uint32_t i = 0; i < length; i++) {
+        data[i] = (uint8_t)(i * 13U + number * 7U + connection * 61U + (i >> 8));
+    }
+    if (length >= sizeof(number)) {
+        memcpy(data, &number, sizeof(number));
+    }
+}
+
+/**
+ * @brief Every station sends count frames of one size, all echoed back
+ */
+static int bench_echo(uint16_t size, uint32_t count, bool sent_inline)
+{
+    if (bench_start(sent_inline) != 0) {
+        return 1;
+    }
+    for (uint32_t i = 0; i < WIFI_EMU_MAX_CONNECTIONS; i++) {
+        bench_stations[i].size = size;
+        bench_stations[i].target = count;
+    }
+
+    uint32_t total = count * WIFI_EMU_MAX_CONNECTIONS;
+    uint32_t received = 0;
+    uint32_t link_start = l2cap_loop_now_us();
+    double start = bench_now();
+    for (uint32_t spin = 0; spin < BENCH_SPIN && received < total; spin++) {
+        bench_fill();
+        bench_event();
+        received = 0;
+        for (uint32_t i = 0; i < WIFI_EMU_MAX_CONNECTIONS; i++) {
+            received += bench_stations[i].received;
+        }
+    }
+    double elapsed = bench_now() - start;
+    double link = (l2cap_loop_now_us() - link_start) / 1e6;
+
+    uint32_t fragments = 0;
+    uint32_t latency_avg = 0;
+    uint32_t latency_max = 0;
+    uint32_t errors = 0;
+    for (uint32_t i = 0; i < WIFI_EMU_MAX_CONNECTIONS; i++) {
+        wifi_emu_stats_t stats;
+        wifi_emu_get_stats((uint8_t)i, &stats);
+        fragments += stats.tx_fragments;
+        latency_avg += stats.latency_avg_us / WIFI_EMU_MAX_CONNECTIONS;
+        latency_max = (stats.latency_max_us > latency_max) ? stats.latency_max_us : latency_max;
+        errors += bench_stations[i].gaps + bench_stations[i].reordered + bench_stations[i].corrupted +
+                  stats.rx_dropped;
+    }
+
+    printf("echo %4u bytes%s: %u frames, %.0f frames/s host, %.0f frames/s link (%.1f kB/s each way), "
+           "%.1f fragments/frame, latency avg %.1f ms max %.1f ms\n",
+           (unsigned)size, sent_inline ? " inline" : "", (unsigned)received, received / elapsed,
+           link > 0 ? received / link : 0.0, link > 0 ? received * (double)size / link / 1e3 : 0.0,
+           received ? (double)fragments / received : 0.0, latency_avg / 1e3, latency_max / 1e3);
+
+    int failed = bench_stop("echo");
+    if (received != total || errors != 0) {
+        fprintf(stderr, "echo: %u of %u frames back, %u lost, reordered, corrupted or dropped\n",
+                (unsigned)received, (unsigned)total, (unsigned)errors);
+        failed = 1;
+    }
+    return failed;
+}
+
+/**
+ * @brief One station sends full-size frames, three send short ones
+ *
+ * Round robin at fragment granularity keeps a short frame from waiting
+ * behind a whole full-size one: it must go out within two link events.
+ */
+static int bench_share(void)
+{
+    if (bench_start(false) != 0) {
+        return 1;
+    }
+    for (uint32_t i = 0; i < WIFI_EMU_MAX_CONNECTIONS; i++) {
+        bench_stations[i].size = (i == 0) ? WIFI_EMU_BUFFER_SIZE : 64;
+    }
+
+    uint32_t link_start = l2cap_loop_now_us();
+    while (l2cap_loop_now_us() - link_start < BENCH_SHARE_US) {
+        bench_fill();
+        bench_event();
+    }
+
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < WIFI_EMU_MAX_CONNECTIONS; i++) {
+        total += bench_stations[i].received_bytes;
+    }
+
+    int failed = 0;
+    printf("share: ");
+    for (uint32_t i = 0; i < WIFI_EMU_MAX_CONNECTIONS; i++) {
+        wifi_emu_stats_t stats;
+        wifi_emu_get_stats((uint8_t)i, &stats);
+        printf("%s%u x %u bytes (%.0f%%) latency max %.1f ms", i ? ", " : "", (unsigned)bench_stations[i].received,
+               (unsigned)bench_stations[i].size,
+               total ? bench_stations[i].received_bytes * 100.0 / total : 0.0, stats.latency_max_us / 1e3);
+        if (i > 0 && (bench_stations[i].received == 0 || stats.latency_max_us > 2U * BENCH_INTERVAL_US)) {
+            failed = 1;
+        }
+    }
+    printf("\n");
+
+    failed |= bench_stop("share");
+    if (failed) {
+        fprintf(stderr, "share: a short frame waited more than two link events\n");
+    }
+    return failed;
+}
+
+/**
+ * @brief Drop the link with fragments in flight, then carry on
+ */
+static int bench_link_drop(uint32_t count)
+{
+    if (bench_start(false) != 0) {
+        return 1;
+    }
+    for (uint32_t i = 0; i < WIFI_EMU_MAX_CONNECTIONS; i++) {
+        bench_stations[i].size = WIFI_EMU_BUFFER_SIZE;
+        bench_stations[i].target = count;
+    }
+
+    for (uint32_t i = 0; i < 3; i++) {
+        bench_fill();
+        bench_event();
+    }
+    l2cap_loop_close();
+    bench_fill();
+    bench_event();
+    l2cap_loop_open();
+
+    /* Frames lost with the link show up as gaps in the numbers echoed after it */
+    uint32_t received = 0;
+    uint32_t lost = 0;
+    for (uint32_t spin = 0; spin < BENCH_SPIN && received + lost < count * WIFI_EMU_MAX_CONNECTIONS; spin++) {
+        bench_fill();
+        bench_event();
+        received = 0;
+        lost = 0;
+        for (uint32_t i = 0; i < WIFI_EMU_MAX_CONNECTIONS; i++) {
+            received += bench_stations[i].received;
+            lost += bench_stations[i].gaps;
+        }
+    }
+
+    uint32_t reordered = 0;
+    uint32_t corrupted = 0;
+    for (uint32_t i = 0; i < WIFI_EMU_MAX_CONNECTIONS; i++) {
+        reordered += bench_stations[i].reordered;
+        corrupted += bench_stations[i].corrupted;
+    }
+    l2cap_loop_stats_t link;
+    l2cap_loop_get_stats(&link);
+    printf("link drop: %u fragments lost with the link, %u frames lost, %u frames back after reopening\n",
+           (unsigned)link.dropped_on_close, (unsigned)lost, (unsigned)received);
+
+    int failed = bench_stop("link drop");
+    if (received + lost != count * WIFI_EMU_MAX_CONNECTIONS || reordered != 0 || corrupted != 0) {
+        fprintf(stderr, "link drop: %u back and %u lost of %u, %u reordered, %u corrupted\n", (unsigned)received,
+                (unsigned)lost, (unsigned)(count * WIFI_EMU_MAX_CONNECTIONS), (unsigned)reordered,
+                (unsigned)corrupted);
+        failed = 1;
+    }
+    return failed;
+}
+
+/**
+ * @brief A second free of the same buffer must leave the pool alone
+ */
+static int bench_double_free(void)
+{
+    if (bench_start(false) != 0) {
+        return 1;
+    }
+
+    uint32_t available = wifi_emu_available();
+    wifi_emu_buffer_t *buffer = wifi_emu_alloc();
+    wifi_emu_free(buffer);
+    wifi_emu_free(buffer);
+    wifi_emu_ref(buffer);
+    wifi_emu_free(buffer);
+    uint32_t after = wifi_emu_available();
+
+    wifi_emu_buffer_t *first = wifi_emu_alloc();
+    wifi_emu_buffer_t *second = wifi_emu_alloc();
+    bool distinct = (first != NULL && second != NULL && first != second);
+    wifi_emu_free(first);
+    wifi_emu_free(second);
+
+    printf("double free: pool %u -> %u, next two buffers %s\n", (unsigned)available, (unsigned)after,
+           distinct ? "distinct" : "THE SAME");
+
+    int failed = bench_stop("double free");
+    if (after != available || !distinct) {
+        failed = 1;
+    }
+    return failed;
+}
+
+static double bench_now(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
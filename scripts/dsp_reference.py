@@ -0,0 +1,356 @@
+#!/usr/bin/env python3
+"""
+TweaknGeek baseband demodulator reference
+
+A bit-exact model of the fixed-point pipeline in src/hal/hal_radio_dsp.c
+(FIR low-pass, OOK envelope, adaptive slicer, clock recovery), plus the
+sample files scripts/bench/dsp_bench.c runs against. Integer arithmetic
+follows the C code step by step, so for any sample file the model and the
+firmware must recover exactly the same bits.
+
+Sample files (.tngs) are little-endian:
+
+    0   "TNGS", version, mode (0 OOK, 1 FSK), envelope_shift, decay_shift
+    8   clock_gain_shift, reserved, squelch (int16)
+    12  sample_rate_hz, bit_rate_bps (uint32)
+    20  16 Q15 FIR taps (int16), in hal_radio_dsp_config_t order
+    52  sample_count, sent_bits, reference_bits (uint32)
+    64  sent bits, packed MSB first: what was transmitted, for error counts
+        reference bits, packed MSB first: what this model recovers
+        samples (int16)
+
+Usage:
+    dsp_reference.py synth SCENARIO -o OUTPUT.tngs [--seed N]
+    dsp_reference.py pack RAW.s16 -o OUTPUT.tngs --mode ook|fsk --rate HZ --bit-rate BPS
+                     [--sent HEXBITS] [pipeline options]
+    dsp_reference.py decode FILE.tngs [--update]
+
+synth writes a synthesized capture (see SCENARIOS); pack wraps a raw
+capture (int16 samples, e.g. dumped from hal_radio_sample_acquire()) with
+the pipeline settings; decode runs the model, checks the stored reference
+bits and counts payload errors, and with --update rewrites the reference.
+"""
+
+import argparse
+import math
+import random
+import struct
+import sys
+
+MAGIC = b"TNGS"
+VERSION = 1
+HEADER = struct.Struct("<4sBBBBBBhII16hIII")
+TAPS = 16                   # HAL_RADIO_DSP_TAPS
+LEVEL_HIGH = 16384          # HAL_RADIO_DSP_LEVEL_HIGH
+HYSTERESIS_SHIFT = 3        # DSP_HYSTERESIS_SHIFT
+MODE_OOK = 0
+MODE_FSK = 1
+
+PREAMBLE = [0xAA] * 4
+SYNC = [0xD3, 0x91]
+PAYLOAD_BYTES = 32
+IDLE_BITS = 24              # noise before and after the packet
+
+INT32_MIN = -(1 << 31)
+INT32_MAX = (1 << 31) - 1
+
+
+def qadd(a, b):
+    return max(INT32_MIN, min(INT32_MAX, a + b))
+
+
+def to_int32(value):
+    value &= 0xFFFFFFFF
+    return value - (1 << 32) if value & 0x80000000 else value
+
+
+class Pipeline:
+    """hal_radio_dsp_t and hal_radio_dsp_process()"""
+
+    def __init__(self, mode, sample_rate, bit_rate, taps, envelope_shift, decay_shift, clock_gain_shift, squelch):
+        if bit_rate == 0 or sample_rate < 4 * bit_rate:
+            raise ValueError("sample rate must be at least four times the bit rate")
+        self.mode = mode
+        self.taps = list(reversed(taps))
+        self.envelope_shift = envelope_shift
+        self.decay_shift = decay_shift
+        self.clock_gain_shift = clock_gain_shift
+        self.squelch = squelch
+        self.phase_step = (bit_rate << 32) // sample_rate
+        self.history = [0] * (2 * TAPS)
+        self.position = 0
+        self.envelope = 0
+        self.high = 0
+        self.low = 0
+        self.phase = 0
+        self.level = False
+
+    def fir(self):
+        window = self.history[self.position:self.position + TAPS]
+        acc = sum(x * h for x, h in zip(window, self.taps)) >> 15
+        return max(-32768, min(32767, acc))
+
+    def slice(self, value):
+        if value > self.high:
+            self.high = value
+        else:
+            self.high = qadd(self.high, -((self.high - value) >> self.decay_shift))
+        if value < self.low:
+            self.low = value
+        else:
+            self.low = qadd(self.low, (value - self.low) >> self.decay_shift)
+
+        middle = (self.high + self.low) >> 1
+        hysteresis = (self.high - self.low) >> HYSTERESIS_SHIFT
+        self.level = value > middle - hysteresis if self.level else value > middle + hysteresis
+        return self.level
+
+    def process(self, samples):
+        bits = []
+        for sample in samples:
+            self.history[self.position] = sample
+            self.history[self.position + TAPS] = sample
+            self.position = (self.position + 1) % TAPS
+
+            value = self.fir()
+            if self.mode == MODE_OOK:
+                self.envelope = qadd(self.envelope, (abs(value) - self.envelope) >> self.envelope_shift)
+                value = self.envelope
+
+            previous = self.level
+            level = self.slice(value)
+            if level != previous:
+                self.phase = (self.phase - (to_int32(self.phase) >> self.clock_gain_shift)) & 0xFFFFFFFF
+
+            before = self.phase
+            self.phase = (self.phase + self.phase_step) & 0xFFFFFFFF
+            if before < 0x80000000 <= self.phase and self.high - self.low >= self.squelch:
+                bits.append(1 if level else 0)
+        return bits
+
+
+def pack_bits(bits):
+    out = bytearray((len(bits) + 7) // 8)
+    for i, bit in enumerate(bits):
+        if bit:
+            out[i >> 3] |= 0x80 >> (i & 7)
+    return bytes(out)
+
+
+def unpack_bits(data, count):
+    return [(data[i >> 3] >> (7 - (i & 7))) & 1 for i in range(count)]
+
+
+def byte_bits(values):
+    return [(value >> (7 - i)) & 1 for value in values for i in range(8)]
+
+
+def payload_errors(sent, received):
+    """Errors in the bits after the sync word, or None if it is never found"""
+    sync = byte_bits(SYNC)
+    start = len(byte_bits(PREAMBLE)) + len(sync)
+    for i in range(len(received) - len(sync) + 1):
+        if received[i:i + len(sync)] == sync:
+            expected = sent[start:]
+            got = received[i + len(sync):i + len(sync) + len(expected)]
+            return sum(a != b for a, b in zip(expected, got)) + len(expected) - len(got)
+    return None
+
+
+def lowpass_taps(cutoff):
+    """Hamming-windowed sinc, cutoff as a fraction of the sample rate, unity gain in Q15"""
+    raw = []
+    for n in range(TAPS):
+        t = n - (TAPS - 1) / 2
+        sinc = 2 * cutoff if t == 0 else math.sin(2 * math.pi * cutoff * t) / (math.pi * t)
+        raw.append(sinc * (0.54 - 0.46 * math.cos(2 * math.pi * n / (TAPS - 1))))
+    scale = 32768 / sum(raw)
+    taps = [int(round(value * scale)) for value in raw]
+    taps[TAPS // 2] += 32768 - sum(taps)
+    return taps
+
+
+def clamp16(value):
+    return max(-32768, min(32767, int(round(value))))
+
+
+def waveform(bits, samples_per_bit, edge_jitter, rng):
+    """Bit level per sample, with the edges moved by up to edge_jitter samples"""
+    levels = []
+    position = 0.0
+    for bit in bits:
+        position += samples_per_bit
+        end = int(round(position + rng.uniform(-edge_jitter, edge_jitter)))
+        levels += [bit] * max(0, end - len(levels))
+    return levels
+
+
+# name: (mode, sample rate, bit rate, bit rate error, edge jitter, taps, envelope, decay, clock gain, squelch)
+SCENARIOS = {
+    "gdo-clean": "GDO data output as the DMA sampler delivers it: 0 / LEVEL_HIGH, edge jitter",
+    "ook-noisy": "OOK amplitude (RSSI-like) with white noise and a DC offset",
+    "ook-fading": "OOK amplitude fading to a third of full scale across the packet, with noise",
+    "fsk-drift": "FSK discriminator level with carrier drift (a DC ramp), noise and a 1% clock error",
+}
+
+
+def synthesize(name, seed):
+    rng = random.Random(seed)
+    sample_rate = 76800
+    bit_rate = 2400
+    spb = sample_rate / bit_rate
+
+    payload = [rng.randrange(256) for _ in range(PAYLOAD_BYTES)]
+    sent = byte_bits(PREAMBLE + SYNC + payload)
+    idle = [rng.randrange(2) for _ in range(IDLE_BITS)]
+    settings = dict(envelope_shift=3, decay_shift=10, clock_gain_shift=2, squelch=2000,
+                    taps=lowpass_taps(bit_rate / sample_rate))
+
+    if name == "gdo-clean":
+        levels = waveform([0] * IDLE_BITS + sent + [0] * IDLE_BITS, spb, 1.5, rng)
+        samples = [LEVEL_HIGH if level else 0 for level in levels]
+        mode = MODE_FSK
+        settings["taps"] = [32768 // TAPS] * TAPS
+    elif name in ("ook-noisy", "ook-fading"):
+        levels = waveform([0] * IDLE_BITS + sent + [0] * IDLE_BITS, spb, 0.5, rng)
+        samples = []
+        for n, level in enumerate(levels):
+            gain = 1.0
+            if name == "ook-fading":
+                gain = 1.0 - 0.67 * n / len(levels)
+            samples.append(clamp16(1500 + level * 12000 * gain + rng.gauss(0, 2500)))
+        mode = MODE_OOK
+    elif name == "fsk-drift":
+        spb *= 1.01
+        levels = waveform(idle + sent + idle, spb, 0.5, rng)
+        samples = []
+        for n, level in enumerate(levels):
+            drift = 4000 * n / len(levels) - 2000
+            samples.append(clamp16((1 if level else -1) * 6000 + drift + rng.gauss(0, 1500)))
+        mode = MODE_FSK
+        settings["decay_shift"] = 9
+    else:
+        raise ValueError("unknown scenario %s" % name)
+
+    return dict(mode=mode, sample_rate=sample_rate, bit_rate=bit_rate, sent=sent, samples=samples, **settings)
+
+
+def run_model(capture):
+    pipeline = Pipeline(capture["mode"], capture["sample_rate"], capture["bit_rate"], capture["taps"],
+                        capture["envelope_shift"], capture["decay_shift"], capture["clock_gain_shift"],
+                        capture["squelch"])
+    return pipeline.process(capture["samples"])
+
+
+def write_capture(path, capture):
+    reference = capture.get("reference", [])
+    header = HEADER.pack(MAGIC, VERSION, capture["mode"], capture["envelope_shift"], capture["decay_shift"],
+                         capture["clock_gain_shift"], 0, capture["squelch"], capture["sample_rate"],
+                         capture["bit_rate"], *capture["taps"], len(capture["samples"]), len(capture["sent"]),
+                         len(reference))
+    with open(path, "wb") as f:
+        f.write(header)
+        f.write(pack_bits(capture["sent"]))
+        f.write(pack_bits(reference))
+        f.write(struct.pack("<%dh" % len(capture["samples"]), *capture["samples"]))
+
+
+def read_capture(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    if len(data) < HEADER.size:
+        sys.exit("error: %s: truncated header" % path)
+    fields = HEADER.unpack_from(data)
+    if fields[0] != MAGIC or fields[1] != VERSION:
+        sys.exit("error: %s: not a version %d sample file" % (path, VERSION))
+    count, sent_count, reference_count = fields[-3:]
+    offset = HEADER.size
+    sent_size = (sent_count + 7) // 8
+    reference_size = (reference_count + 7) // 8
+    if len(data) != offset + sent_size + reference_size + 2 * count:
+        sys.exit("error: %s: size does not match the header" % path)
+    sent = unpack_bits(data[offset:offset + sent_size], sent_count)
+    offset += sent_size
+    reference = unpack_bits(data[offset:offset + reference_size], reference_count)
+    offset += reference_size
+    return dict(mode=fields[2], envelope_shift=fields[3], decay_shift=fields[4], clock_gain_shift=fields[5],
+                squelch=fields[7], sample_rate=fields[8], bit_rate=fields[9], taps=list(fields[10:26]),
+                sent=sent, reference=reference,
+                samples=list(struct.unpack_from("<%dh" % count, data, offset)))
+
+
+def report(path, capture, bits):
+    errors = payload_errors(capture["sent"], bits)
+    payload = len(capture["sent"]) - len(byte_bits(PREAMBLE + SYNC))
+    result = "sync not found" if errors is None else "%d/%d payload bit errors" % (errors, payload)
+    print("%s: %d samples, %d bits, %s" % (path, len(capture["samples"]), len(bits), result))
+
+
+def add_pipeline_options(parser):
+    parser.add_argument("--envelope-shift", type=int, default=3, help="OOK envelope smoothing (default 3)")
+    parser.add_argument("--decay-shift", type=int, default=10, help="level tracker decay (default 10)")
+    parser.add_argument("--clock-gain-shift", type=int, default=2, help="clock correction (default 2)")
+    parser.add_argument("--squelch", type=int, default=2000, help="minimum level span (default 2000)")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="TweaknGeek baseband demodulator reference")
+    commands = parser.add_subparsers(dest="command", required=True)
+
+    synth = commands.add_parser("synth", help="write a synthesized capture")
+    synth.add_argument("scenario", choices=sorted(SCENARIOS))
+    synth.add_argument("-o", "--output", required=True, help="output sample file")
+    synth.add_argument("--seed", type=int, default=1, help="noise and payload seed (default 1)")
+
+    pack = commands.add_parser("pack", help="wrap a raw int16 capture in a sample file")
+    pack.add_argument("raw", help="little-endian int16 samples")
+    pack.add_argument("-o", "--output", required=True, help="output sample file")
+    pack.add_argument("--mode", choices=("ook", "fsk"), required=True)
+    pack.add_argument("--rate", type=int, required=True, help="sample rate in Hz")
+    pack.add_argument("--bit-rate", type=int, required=True, help="bit rate in bps")
+    pack.add_argument("--sent", default="", help="transmitted bytes in hex, preamble and sync included")
+    add_pipeline_options(pack)
+
+    decode = commands.add_parser("decode", help="run the model on a sample file")
+    decode.add_argument("files", nargs="+")
+    decode.add_argument("--update", action="store_true", help="rewrite the stored reference bits")
+
+    args = parser.parse_args()
+
+    if args.command == "synth":
+        capture = synthesize(args.scenario, args.seed)
+        capture["reference"] = run_model(capture)
+        write_capture(args.output, capture)
+        report(args.output, capture, capture["reference"])
+    elif args.command == "pack":
+        with open(args.raw, "rb") as f:
+            raw = f.read()
+        if len(raw) & 1:
+            sys.exit("error: %s: odd size" % args.raw)
+        capture = dict(mode=MODE_OOK if args.mode == "ook" else MODE_FSK, sample_rate=args.rate,
+                       bit_rate=args.bit_rate, envelope_shift=args.envelope_shift, decay_shift=args.decay_shift,
+                       clock_gain_shift=args.clock_gain_shift, squelch=args.squelch,
+                       taps=lowpass_taps(args.bit_rate / args.rate),
+                       sent=byte_bits(bytes.fromhex(args.sent)),
+                       samples=list(struct.unpack("<%dh" % (len(raw) // 2), raw)))
+        capture["reference"] = run_model(capture)
+        write_capture(args.output, capture)
+        report(args.output, capture, capture["reference"])
+    else:
+        mismatched = False
+        for path in args.files:
+            capture = read_capture(path)
+            bits = run_model(capture)
+            report(path, capture, bits)
+            if args.update:
+                capture["reference"] = bits
+                write_capture(path, capture)
+            elif bits != capture["reference"]:
+                print("%s: stored reference bits differ from the model" % path)
+                mismatched = True
+        if mismatched:
+            sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
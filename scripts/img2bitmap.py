@@ -0,0 +1,263 @@
+#!/usr/bin/env python3
+"""
+TweaknGeek bitmap converter
+
+Converts PBM (P1/P4) and PGM (P2/P5) images into hal_bitmap_t definitions
+for hal_graphics_blit(). Output is page-major, the display's native layout,
+optionally run-length encoded (see hal_bitmap_t in include/hal_display.h).
+Grayscale input is dithered to black and white with the same integer
+kernels as hal_graphics_draw_gray(), or kept as an 8-bit hal_gray_image_t
+with --gray for dithering at runtime.
+
+Usage:
+    img2bitmap.py [--rle] [--dither none|ordered|fs] [--mask MASK.pbm]
+                  -n NAME -o OUTPUT.h IMAGE.pnm
+    img2bitmap.py --gray -n NAME -o OUTPUT.h IMAGE.pgm
+"""
+
+import argparse
+import sys
+
+
+# 8x8 Bayer matrix scaled to (2b + 1) * 255 / 128, as in hal_display.c
+BAYER8 = [
+    [0, 32, 8, 40, 2, 34, 10, 42],
+    [48, 16, 56, 24, 50, 18, 58, 26],
+    [12, 44, 4, 36, 14, 46, 6, 38],
+    [60, 28, 52, 20, 62, 30, 54, 22],
+    [3, 35, 11, 43, 1, 33, 9, 41],
+    [51, 19, 59, 27, 49, 17, 57, 25],
+    [15, 47, 7, 39, 13, 45, 5, 37],
+    [63, 31, 55, 23, 61, 29, 53, 21],
+]
+DITHER_BIAS = [[(2 * b + 1) * 255 // 128 for b in row] for row in BAYER8]
+
+
+def cdiv(a, b):
+    """C integer division (truncates toward zero)."""
+    q = abs(a) // abs(b)
+    return q if (a >= 0) == (b > 0) else -q
+
+
+def read_pnm(path):
+    """Returns width, height and rows of 8-bit luminance (0 = black)."""
+    with open(path, "rb") as f:
+        raw = f.read()
+
+    pos = 0
+
+    def next_token():
+        nonlocal pos
+        while pos < len(raw):
+            ch = raw[pos:pos + 1]
+            if ch == b"#":
+                while pos < len(raw) and raw[pos:pos + 1] != b"\n":
+                    pos += 1
+            elif ch.isspace():
+                pos += 1
+            else:
+                break
+        start = pos
+        while pos < len(raw) and not raw[pos:pos + 1].isspace():
+            pos += 1
+        return raw[start:pos].decode("ascii")
+
+    magic = next_token()
+    width = int(next_token())
+    height = int(next_token())
+
+    if magic == "P4":
+        pos += 1
+        stride = (width + 7) // 8
+        pixels = []
+        for y in range(height):
+            row = raw[pos + y * stride:pos + (y + 1) * stride]
+            pixels.append([0 if (row[x // 8] >> (7 - x % 8)) & 1 else 255 for x in range(width)])
+    elif magic == "P1":
+        bits = [c for c in raw[pos:].decode("ascii") if c in "01"]
+        pixels = [[0 if bits[y * width + x] == "1" else 255 for x in range(width)] for y in range(height)]
+    elif magic in ("P2", "P5"):
+        maxval = int(next_token())
+        if magic == "P5":
+            pos += 1
+            size = 2 if maxval > 255 else 1
+            values = [int.from_bytes(raw[pos + i * size:pos + (i + 1) * size], "big")
+                      for i in range(width * height)]
+        else:
+            values = [int(next_token()) for _ in range(width * height)]
+        pixels = [[(values[y * width + x] * 255 + maxval // 2) // maxval for x in range(width)]
+                  for y in range(height)]
+    else:
+        sys.exit("error: %s is not a PBM/PGM (P1/P2/P4/P5) image" % path)
+
+    return width, height, pixels
+
+
+def dither(width, height, pixels, method):
+    """Black and white pixels (1 = set) from luminance, matching hal_graphics_draw_gray()."""
+    out = [[0] * width for _ in range(height)]
+    err = [0] * (width + 2)
+    for y in range(height):
+        nxt = [0] * (width + 2)
+        for x in range(width):
+            ink = 255 - pixels[y][x]
+            if method == "ordered":
+                level = (ink + DITHER_BIAS[y & 7][x & 7]) // 255
+            elif method == "fs":
+                value = ink + err[x + 1]
+                level = 0 if value <= 0 else 1 if value >= 255 else (value + 127) // 255
+                error = value - level * 255
+                e7 = cdiv(error * 7, 16)
+                e3 = cdiv(error * 3, 16)
+                e5 = cdiv(error * 5, 16)
+                err[x + 2] += e7
+                nxt[x] += e3
+                nxt[x + 1] += e5
+                nxt[x + 2] += error - e7 - e3 - e5
+            else:
+                level = (ink + 127) // 255
+            out[y][x] = level
+        err = nxt
+    return out
+
+
+def to_pages(width, height, pixels):
+    data = []
+    for page in range((height + 7) // 8):
+        for x in range(width):
+            value = 0
+            for bit in range(8):
+                y = page * 8 + bit
+                if y < height and pixels[y][x]:
+                    value |= 1 << bit
+            data.append(value)
+    return data
+
+
+def rle_encode(data):
+    """0x00-0x7F: ctrl + 1 literals follow; 0x80-0xFF: next byte repeated ctrl - 0x80 + 2 times."""
+    out = []
+    literal = []
+    i = 0
+
+    def flush():
+        while literal:
+            chunk = literal[:128]
+            del literal[:128]
+            out.append(len(chunk) - 1)
+            out.extend(chunk)
+
+    while i < len(data):
+        run = 1
+        while i + run < len(data) and data[i + run] == data[i] and run < 129:
+            run += 1
+        if run >= 3 or (run == 2 and not literal):
+            flush()
+            out.append(0x80 | (run - 2))
+            out.append(data[i])
+            i += run
+        else:
+            literal.append(data[i])
+            i += 1
+    flush()
+    return out
+
+
+def emit_array(name, data, per_line=12):
+    lines = ["static const uint8_t %s[] = {" % name]
+    for i in range(0, len(data), per_line):
+        lines.append("    " + ", ".join("0x%02X" % b for b in data[i:i + per_line]) + ",")
+    lines.append("};")
+    return lines
+
+
+def header_lines(image, output):
+    guard = output.split("/")[-1].upper().replace(".", "_")
+    return guard, [
+        "/* Generated by scripts/img2bitmap.py from %s - do not edit */" % image.split("/")[-1],
+        "",
+        "#ifndef %s" % guard,
+        "#define %s" % guard,
+        "",
+        "#include \"hal_display.h\"",
+        "",
+    ]
+
+
+def write_gray(args, width, height, pixels):
+    guard, lines = header_lines(args.image, args.output)
+    lines += emit_array("%s_pixels" % args.name, [v for row in pixels for v in row], 16)
+    lines += [
+        "",
+        "static const hal_gray_image_t %s = {" % args.name,
+        "    .pixels = %s_pixels," % args.name,
+        "    .width = %d," % width,
+        "    .height = %d," % height,
+        "    .stride = 0,",
+        "};",
+        "",
+        "#endif /* %s */" % guard,
+    ]
+    with open(args.output, "w") as f:
+        f.write("\n".join(lines) + "\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Convert PBM images to TweaknGeek bitmaps")
+    parser.add_argument("-n", "--name", required=True, help="C identifier for the bitmap")
+    parser.add_argument("-o", "--output", required=True, help="output header file")
+    parser.add_argument("--rle", action="store_true", help="run-length encode the data")
+    parser.add_argument("--dither", choices=("none", "ordered", "fs"), default="none",
+                        help="dithering for grayscale input (default: none)")
+    parser.add_argument("--gray", action="store_true",
+                        help="emit an 8-bit hal_gray_image_t instead of a bitmap")
+    parser.add_argument("--mask", help="PBM mask image of the same size")
+    parser.add_argument("image", help="input PBM/PGM image")
+    args = parser.parse_args()
+
+    width, height, pixels = read_pnm(args.image)
+    if args.gray:
+        write_gray(args, width, height, pixels)
+        return
+
+    data = to_pages(width, height, dither(width, height, pixels, args.dither))
+    mask = None
+
+    if args.mask:
+        mw, mh, mpixels = read_pnm(args.mask)
+        if (mw, mh) != (width, height):
+            sys.exit("error: mask is %dx%d, image is %dx%d" % (mw, mh, width, height))
+        mask = to_pages(width, height, dither(width, height, mpixels, "none"))
+
+    if args.rle:
+        data = rle_encode(data)
+        mask = rle_encode(mask) if mask is not None else None
+
+    guard, lines = header_lines(args.image, args.output)
+    lines += emit_array("%s_data" % args.name, data)
+    lines.append("")
+    if mask is not None:
+        lines += emit_array("%s_mask" % args.name, mask)
+        lines.append("")
+
+    lines += [
+        "static const hal_bitmap_t %s = {" % args.name,
+        "    .data = %s_data," % args.name,
+        "    .mask = %s," % ("%s_mask" % args.name if mask is not None else "NULL"),
+        "    .data_size = sizeof(%s_data)," % args.name,
+        "    .mask_size = %s," % ("sizeof(%s_mask)" % args.name if mask is not None else "0"),
+        "    .width = %d," % width,
+        "    .height = %d," % height,
+        "    .stride = 0,",
+        "    .format = %s," % ("HAL_BITMAP_FORMAT_RLE" if args.rle else "HAL_BITMAP_FORMAT_PAGE_MAJOR"),
+        "};",
+        "",
+        "#endif /* %s */" % guard,
+    ]
+
+    with open(args.output, "w") as f:
+        f.write("\n".join(lines) + "\n")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,332 @@
+/**
+ * @file anim_player.c
+ * @brief Compressed animation playback for the boot splash and UI
+ */
+
+#include "anim_player.h"
+#include "layout_scene.h"
+#include <string.h>
+
+/* Frame stream codes */
+#define ANIM_CODE_MASK              0xC0
+#define ANIM_CODE_SKIP              0x00
+#define ANIM_CODE_LITERAL           0x40
+#define ANIM_CODE_RUN               0x80
+#define ANIM_CODE_LONG_SKIP         0xC0
+#define ANIM_CODE_COUNT(code)       ((uint32_t)((code) & 0x3F))
+
+/**
+ * @brief Destination cursor over the animation area
+ */
+typedef struct {
+    uint8_t *buffer;                /* Frame buffer */
+    uint32_t stride;                /* Frame buffer bytes per page */
+    uint32_t x;                     /* Area origin column */
+    uint32_t page;                  /* Area origin page */
+    uint32_t width;                 /* Area width */
+    uint32_t pages;                 /* Area height in pages */
+    uint32_t column;                /* Cursor column within the area */
+    uint32_t row;                   /* Cursor page within the area */
+    int32_t min_column;             /* Changed bounds, in area coordinates */
+    int32_t max_column;
+    int32_t min_row;
+    int32_t max_row;
+} anim_cursor_t;
+
+/* Static function prototypes */
+static hal_result_t anim_area(const anim_player_t *player, anim_cursor_t *cursor);
+static hal_result_t anim_decode_frame(anim_player_t *player, anim_cursor_t *cursor);
+static bool anim_skip(anim_cursor_t *cursor, uint32_t count);
+static bool anim_xor(anim_cursor_t *cursor, const uint8_t *src, uint8_t value, uint32_t count);
+static void anim_flush(anim_player_t *player);
+
+hal_result_t anim_player_start(anim_player_t *player, const anim_t *anim,
+                               const hal_point_t *position, uint32_t now_ms)
+{
+    /* A zero frame time would never let the tick loop catch up */
+    if (!player || !anim || !anim->data || !position || anim->frame_count == 0 ||
+        anim->frame_ms == 0 || anim->width == 0 || anim->pages == 0) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    memset(player, 0, sizeof(*player));
+    player->anim = anim;
+    player->position = *position;
+    player->cursor = anim->data;
+
+    anim_cursor_t cursor;
+    hal_result_t result = anim_area(player, &cursor);
+    if (result != HAL_OK) {
+        player->anim = NULL;
+        return result;
+    }
+
+    /* The first frame is a delta against a blank area */
+    for (uint32_t page = 0; page < cursor.pages; page++) {
+        memset(&cursor.buffer[(cursor.page + page) * cursor.stride + cursor.x], 0, cursor.width);
+    }
+
+    result = anim_decode_frame(player, &cursor);
+    if (result != HAL_OK) {
+        player->anim = NULL;
+        return result;
+    }
+
+    player->pending.x = position->x;
+    player->pending.y = position->y;
+    player->pending.width = anim->width;
+    player->pending.height = (uint16_t)(anim->pages * 8U);
+    player->next_ms = now_ms + anim->frame_ms;
+    player->running = true;
+
+    anim_flush(player);
+    return HAL_OK;
+}
+
+hal_result_t anim_player_tick(anim_player_t *player, uint32_t now_ms)
+{
+    if (!player || !player->anim) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    const anim_t *anim = player->anim;
+
+    /* Frames that fell due since the last call; wrap-safe time comparison */
+    while (player->running && (int32_t)(now_ms - player->next_ms) >= 0) {
+        bool wrap = (player->frame + 1U >= anim->frame_count);
+
+        if (wrap && !(anim->flags & ANIM_FLAG_LOOP)) {
+            player->running = false;
+            break;
+        }
+
+        anim_cursor_t cursor;
+        hal_result_t result = anim_area(player, &cursor);
+        if (result == HAL_OK) {
+            result = anim_decode_frame(player, &cursor);
+        }
+        if (result != HAL_OK) {
+            player->running = false;
+            return result;
+        }
+
+        if (cursor.max_row >= 0) {
+            hal_rect_t changed = {
+                (int16_t)(player->position.x + cursor.min_column),
+                (int16_t)(player->position.y + cursor.min_row * 8),
+                (uint16_t)(cursor.max_column - cursor.min_column + 1),
+                (uint16_t)((cursor.max_row - cursor.min_row + 1) * 8)
+            };
+            layout_rect_union(&player->pending, &changed);
+        }
+
+        if (wrap) {
+            /* The loop delta restored frame 0; carry on with the 0 -> 1 delta */
+            uint32_t first_length = (uint32_t)anim->data[0] | ((uint32_t)anim->data[1] << 8);
+            player->cursor = anim->data + 2U + first_length;
+            player->frame = 0;
+        } else {
+            player->frame++;
+        }
+
+        player->next_ms += anim->frame_ms;
+    }
+
+    anim_flush(player);
+    return HAL_OK;
+}
+
+void anim_player_stop(anim_player_t *player)
+{
+    if (player) {
+        player->running = false;
+    }
+}
+
+bool anim_player_is_running(const anim_player_t *player)
+{
+    return player && player->running;
+}
+
+/* Static helper functions */
+
+/**
+ * @brief Locate the animation area in the frame buffer
+ */
+static hal_result_t anim_area(const anim_player_t *player, anim_cursor_t *cursor)
+{
+    hal_display_config_t screen;
+    uint8_t *buffer;
+    uint32_t size;
+    const anim_t *anim = player->anim;
+
+    hal_result_t result = hal_display_get_config(&screen);
+    if (result == HAL_OK) {
+        result = hal_display_get_buffer(&buffer, &size);
+    }
+    if (result != HAL_OK) {
+        return result;
+    }
+
+    /* Byte-wise deltas need the area on page boundaries and fully on screen */
+    if (player->position.x < 0 || player->position.y < 0 || (player->position.y & 7) != 0 ||
+        player->position.x + anim->width > screen.width ||
+        player->position.y + anim->pages * 8 > screen.height) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    memset(cursor, 0, sizeof(*cursor));
+    cursor->buffer = buffer;
+    cursor->stride = screen.width;
+    cursor->x = (uint32_t)player->position.x;
+    cursor->page = (uint32_t)player->position.y >> 3;
+    cursor->width = anim->width;
+    cursor->pages = anim->pages;
+    cursor->min_column = (int32_t)anim->width;
+    cursor->max_column = -1;
+    cursor->min_row = (int32_t)anim->pages;
+    cursor->max_row = -1;
+    return HAL_OK;
+}
+
+/**
+ * @brief Apply the frame stream at the player's cursor and advance past it
+ */
+static hal_result_t anim_decode_frame(anim_player_t *player, anim_cursor_t *cursor)
+{
+    const anim_t *anim = player->anim;
+    const uint8_t *end = anim->data + anim->data_size;
+    const uint8_t *pos = player->cursor;
+
+    if (end - pos < 2) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    uint32_t length = (uint32_t)pos[0] | ((uint32_t)pos[1] << 8);
+    pos += 2;
+    if ((uint32_t)(end - pos) < length) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    const uint8_t *stream_end = pos + length;
+    bool ok = true;
+
+    while (ok && pos < stream_end) {
+        uint8_t code = *pos++;
+        uint32_t count = ANIM_CODE_COUNT(code);
+
+        switch (code & ANIM_CODE_MASK) {
+            case ANIM_CODE_SKIP:
+                ok = anim_skip(cursor, count + 1U);
+                break;
+
+            case ANIM_CODE_LITERAL:
+                ok = (uint32_t)(stream_end - pos) >= count + 1U &&
+                     anim_xor(cursor, pos, 0, count + 1U);
+                pos += count + 1U;
+                break;
+
+            case ANIM_CODE_RUN:
+                ok = pos < stream_end && anim_xor(cursor, NULL, *pos, count + 2U);
+                pos++;
+                break;
+
+            case ANIM_CODE_LONG_SKIP:
+            default:
+                ok = pos < stream_end && anim_skip(cursor, ((count << 8) | *pos) + 1U);
+                pos++;
+                break;
+        }
+    }
+
+    if (!ok) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    player->cursor = stream_end;
+    return HAL_OK;
+}
+
+/**
+ * @brief Move the cursor over unchanged bytes
+ * @return false if the skip runs past the area
+ */
+static bool anim_skip(anim_cursor_t *cursor, uint32_t count)
+{
+    cursor->column += count;
+    if (cursor->column >= cursor->width) {
+        cursor->row += cursor->column / cursor->width;
+        cursor->column %= cursor->width;
+    }
+
+    /* Landing exactly on the end is fine, anything written there is not */
+    return cursor->row < cursor->pages || (cursor->row == cursor->pages && cursor->column == 0);
+}
+
+/**
+ * @brief XOR literal bytes (src) or a repeated value into the area
+ * @return false if the bytes run past the area
+ */
+static bool anim_xor(anim_cursor_t *cursor, const uint8_t *src, uint8_t value, uint32_t count)
+{
+    while (count > 0) {
+        if (cursor->row >= cursor->pages) {
+            return false;
+        }
+
+        uint32_t span = cursor->width - cursor->column;
+        if (span > count) {
+            span = count;
+        }
+
+        uint8_t *dst = &cursor->buffer[(cursor->page + cursor->row) * cursor->stride +
+                                       cursor->x + cursor->column];
+        if (src) {
+            for (uint32_t i = 0; i < span; i++) {
+                dst[i] ^= src[i];
+            }
+            src += span;
+        } else {
+            for (uint32_t i = 0; i < span; i++) {
+                dst[i] ^= value;
+            }
+        }
+
+        /* Changed bounds grow per span, not per byte */
+        int32_t first = (int32_t)cursor->column;
+        int32_t last = first + (int32_t)span - 1;
+        if (first < cursor->min_column) {
+            cursor->min_column = first;
+        }
+        if (last > cursor->max_column) {
+            cursor->max_column = last;
+        }
+        if ((int32_t)cursor->row < cursor->min_row) {
+            cursor->min_row = (int32_t)cursor->row;
+        }
+        cursor->max_row = (int32_t)cursor->row;
+
+        count -= span;
+        cursor->column += span;
+        if (cursor->column == cursor->width) {
+            cursor->column = 0;
+            cursor->row++;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Send the pending area to the panel unless a transfer is running
+ */
+static void anim_flush(anim_player_t *player)
+{
+    if (player->pending.width == 0) {
+        return;
+    }
+
+    if (hal_display_update_rect_async(&player->pending) != HAL_ERROR_RESOURCE_BUSY) {
+        memset(&player->pending, 0, sizeof(player->pending));
+    }
+}
@@ -0,0 +1,99 @@
+/**
+ * @file anim_player.h
+ * @brief Compressed animation playback for the boot splash and UI
+ *
+ * Animations are stored as XOR deltas between consecutive frames in the
+ * display's page-major layout, generated by scripts/anim2delta.py. Each
+ * frame is a length-prefixed stream of byte codes:
+ *
+ *   00nnnnnn            skip n + 1 unchanged bytes
+ *   01nnnnnn <n+1 B>    XOR the following n + 1 bytes into the frame
+ *   10nnnnnn <B>        XOR one byte into the next n + 2 bytes
+ *   11nnnnnn <lo>       skip ((n << 8) | lo) + 1 unchanged bytes
+ *
+ * The first frame is a delta against a blank area; looping animations
+ * carry one more delta that turns the last frame back into the first.
+ * Decoding touches only changed bytes and goes straight into the frame
+ * buffer, and each step flushes just the area that changed.
+ */
+
+#ifndef ANIM_PLAYER_H
+#define ANIM_PLAYER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "hal_display.h"
+
+/* Animation flags */
+#define ANIM_FLAG_LOOP              (1 << 0)    /**< Restart after the last frame */
+
+/**
+ * @brief Animation descriptor
+ */
+typedef struct {
+    uint16_t width;                 /**< Frame width in columns */
+    uint8_t pages;                  /**< Frame height in pages (8 rows each) */
+    uint8_t flags;                  /**< ANIM_FLAG_* */
+    uint16_t frame_count;           /**< Number of frames */
+    uint16_t frame_ms;              /**< Time each frame is shown, non-zero */
+    const uint8_t *data;            /**< Frame streams, each prefixed by a 16-bit LE length */
+    uint32_t data_size;             /**< Size of data in bytes */
+} anim_t;
+
+/**
+ * @brief Player state
+ */
+typedef struct {
+    const anim_t *anim;
+    const uint8_t *cursor;          /**< Length prefix of the next frame */
+    hal_point_t position;           /**< Top-left corner (y on a page boundary) */
+    hal_rect_t pending;             /**< Changed area not yet sent to the panel */
+    uint32_t next_ms;               /**< When the next frame is due */
+    uint16_t frame;                 /**< Frame currently shown */
+    bool running;
+} anim_player_t;
+
+/**
+ * @brief Start playing an animation
+ *
+ * Clears the animation area, decodes the first frame and starts flushing
+ * it. The player owns the area until it stops.
+ *
+ * @param player Player state
+ * @param anim Animation to play
+ * @param position Top-left corner; y must be a multiple of 8 and the
+ *        animation must fit on screen
+ * @param now_ms Current time in milliseconds
+ * @return HAL_OK on success, error code otherwise
+ */
+hal_result_t anim_player_start(anim_player_t *player, const anim_t *anim,
+                               const hal_point_t *position, uint32_t now_ms);
+
+/**
+ * @brief Advance the animation
+ *
+ * Call from a periodic timer or the UI loop. Frames that are due are
+ * decoded (several if the caller fell behind) and the union of the changed
+ * areas is flushed once. If the display is busy, the area is flushed by a
+ * later call.
+ *
+ * @param player Player state
+ * @param now_ms Current time in milliseconds
+ * @return HAL_OK on success, HAL_ERROR_INVALID_PARAM on a corrupt stream
+ */
+hal_result_t anim_player_tick(anim_player_t *player, uint32_t now_ms);
+
+/**
+ * @brief Stop playback, leaving the current frame on screen
+ * @param player Player state
+ */
+void anim_player_stop(anim_player_t *player);
+
+/**
+ * @brief Check whether an animation is still playing
+ * @param player Player state
+ * @return true until a non-looping animation has shown its last frame
+ */
+bool anim_player_is_running(const anim_player_t *player);
+
+#endif /* ANIM_PLAYER_H */
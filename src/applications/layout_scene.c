@@ -0,0 +1,583 @@
+/**
+ * @file layout_scene.c
+ * @brief Retained-mode scene graph for the custom layout engine
+ *
+ * Each render pass walks the nodes once in paint order, resolving absolute
+ * positions and visibility from the parents. Nodes that changed contribute
+ * both their old and new screen bounds to a small damage list; only those
+ * rectangles are cleared, redrawn under a clip and flushed to the panel.
+ */
+
+#include "layout_scene.h"
+#include <string.h>
+
+/* Static function prototypes */
+static layout_node_t *scene_node(layout_scene_t *scene, uint8_t id);
+static layout_cmd_t *node_append(layout_scene_t *scene, uint8_t id, hal_result_t *result);
+static bool command_bounds(const layout_cmd_t *cmd, int16_t ox, int16_t oy,
+                           const hal_display_config_t *screen, hal_rect_t *bounds);
+static void command_draw(const layout_cmd_t *cmd, int16_t ox, int16_t oy);
+static bool rect_overlaps(const hal_rect_t *a, const hal_rect_t *b);
+static uint32_t rect_area(const hal_rect_t *rect);
+static void scene_damage(layout_scene_t *scene, const hal_rect_t *rect);
+
+hal_result_t layout_scene_init(layout_scene_t *scene)
+{
+    if (!scene) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    memset(scene, 0, sizeof(*scene));
+    return HAL_OK;
+}
+
+hal_result_t layout_node_create(layout_scene_t *scene, uint8_t parent, const hal_point_t *origin,
+                                uint8_t capacity, uint8_t *id)
+{
+    if (!scene || !origin || !id) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    /* Parents must exist first so one in-order pass resolves positions */
+    if (parent != LAYOUT_NODE_ROOT && parent >= scene->node_count) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    if (scene->node_count >= LAYOUT_MAX_NODES ||
+        scene->commands_used + capacity > LAYOUT_MAX_COMMANDS) {
+        return HAL_ERROR_NO_MEMORY;
+    }
+
+    layout_node_t *node = &scene->nodes[scene->node_count];
+    memset(node, 0, sizeof(*node));
+    node->origin = *origin;
+    node->first_command = scene->commands_used;
+    node->command_capacity = capacity;
+    node->parent = parent;
+    node->flags = LAYOUT_NODE_FLAG_VISIBLE | LAYOUT_NODE_FLAG_DIRTY;
+
+    scene->commands_used += capacity;
+    *id = scene->node_count++;
+    return HAL_OK;
+}
+
+hal_result_t layout_node_add_rect(layout_scene_t *scene, uint8_t id, const hal_rect_t *rect,
+                                  bool fill, hal_graphics_mode_t mode)
+{
+    hal_result_t result;
+
+    if (!rect || mode >= HAL_GRAPHICS_MODE_MAX) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    layout_cmd_t *cmd = node_append(scene, id, &result);
+    if (!cmd) {
+        return result;
+    }
+
+    cmd->type = fill ? LAYOUT_CMD_FILL_RECT : LAYOUT_CMD_RECT;
+    cmd->mode = (uint8_t)mode;
+    cmd->x = rect->x;
+    cmd->y = rect->y;
+    cmd->w = (int16_t)rect->width;
+    cmd->h = (int16_t)rect->height;
+    return HAL_OK;
+}
+
+hal_result_t layout_node_add_line(layout_scene_t *scene, uint8_t id, int16_t x0, int16_t y0,
+                                  int16_t x1, int16_t y1, hal_graphics_mode_t mode)
+{
+    hal_result_t result;
+
+    if (mode >= HAL_GRAPHICS_MODE_MAX) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    layout_cmd_t *cmd = node_append(scene, id, &result);
+    if (!cmd) {
+        return result;
+    }
+
+    cmd->type = LAYOUT_CMD_LINE;
+    cmd->mode = (uint8_t)mode;
+    cmd->x = x0;
+    cmd->y = y0;
+    cmd->w = x1;
+    cmd->h = y1;
+    return HAL_OK;
+}
+
+hal_result_t layout_node_add_text(layout_scene_t *scene, uint8_t id, const char *text,
+                                  const hal_point_t *position, hal_font_size_t font_size,
+                                  hal_graphics_mode_t mode)
+{
+    hal_result_t result;
+
+    if (!text || !position || font_size >= HAL_FONT_SIZE_MAX || mode >= HAL_GRAPHICS_MODE_MAX) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    layout_cmd_t *cmd = node_append(scene, id, &result);
+    if (!cmd) {
+        return result;
+    }
+
+    cmd->type = LAYOUT_CMD_TEXT;
+    cmd->mode = (uint8_t)mode;
+    cmd->font = (uint8_t)font_size;
+    cmd->x = position->x;
+    cmd->y = position->y;
+    cmd->data = text;
+    return HAL_OK;
+}
+
+hal_result_t layout_node_add_bitmap(layout_scene_t *scene, uint8_t id, const hal_bitmap_t *bitmap,
+                                    const hal_point_t *position, hal_blit_mode_t mode)
+{
+    hal_result_t result;
+
+    if (!bitmap || !position || mode >= HAL_BLIT_MODE_MAX) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    layout_cmd_t *cmd = node_append(scene, id, &result);
+    if (!cmd) {
+        return result;
+    }
+
+    cmd->type = LAYOUT_CMD_BITMAP;
+    cmd->mode = (uint8_t)mode;
+    cmd->x = position->x;
+    cmd->y = position->y;
+    cmd->w = (int16_t)bitmap->width;
+    cmd->h = (int16_t)bitmap->height;
+    cmd->data = bitmap;
+    return HAL_OK;
+}
+
+hal_result_t layout_node_add_canvas(layout_scene_t *scene, uint8_t id, const hal_canvas_t *canvas,
+                                    const hal_point_t *position, hal_blit_mode_t mode)
+{
+    hal_result_t result;
+
+    if (!canvas || !position || mode >= HAL_BLIT_MODE_MAX || mode == HAL_BLIT_MODE_MASK) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    layout_cmd_t *cmd = node_append(scene, id, &result);
+    if (!cmd) {
+        return result;
+    }
+
+    cmd->type = LAYOUT_CMD_CANVAS;
+    cmd->mode = (uint8_t)mode;
+    cmd->x = position->x;
+    cmd->y = position->y;
+    cmd->w = (int16_t)canvas->width;
+    cmd->h = (int16_t)canvas->height;
+    cmd->data = canvas;
+    return HAL_OK;
+}
+
+hal_result_t layout_node_clear(layout_scene_t *scene, uint8_t id)
+{
+    layout_node_t *node = scene_node(scene, id);
+    if (!node) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    node->command_count = 0;
+    node->flags |= LAYOUT_NODE_FLAG_DIRTY;
+    return HAL_OK;
+}
+
+hal_result_t layout_node_set_text(layout_scene_t *scene, uint8_t id, uint8_t index, const char *text)
+{
+    layout_node_t *node = scene_node(scene, id);
+    if (!node || !text || index >= node->command_count) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    layout_cmd_t *cmd = &scene->commands[node->first_command + index];
+    if (cmd->type != LAYOUT_CMD_TEXT) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    cmd->data = text;
+    node->flags |= LAYOUT_NODE_FLAG_DIRTY;
+    return HAL_OK;
+}
+
+hal_result_t layout_node_move(layout_scene_t *scene, uint8_t id, const hal_point_t *origin)
+{
+    layout_node_t *node = scene_node(scene, id);
+    if (!node || !origin) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    /* Position changes (including inherited ones) are detected at render */
+    node->origin = *origin;
+    return HAL_OK;
+}
+
+hal_result_t layout_node_set_visible(layout_scene_t *scene, uint8_t id, bool visible)
+{
+    layout_node_t *node = scene_node(scene, id);
+    if (!node) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    if (visible) {
+        node->flags |= LAYOUT_NODE_FLAG_VISIBLE;
+    } else {
+        node->flags &= (uint8_t)~LAYOUT_NODE_FLAG_VISIBLE;
+    }
+    return HAL_OK;
+}
+
+hal_result_t layout_node_invalidate(layout_scene_t *scene, uint8_t id)
+{
+    layout_node_t *node = scene_node(scene, id);
+    if (!node) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    node->flags |= LAYOUT_NODE_FLAG_DIRTY;
+    return HAL_OK;
+}
+
+hal_result_t layout_scene_invalidate_all(layout_scene_t *scene)
+{
+    hal_display_config_t screen;
+
+    if (!scene) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    hal_result_t result = hal_display_get_config(&screen);
+    if (result != HAL_OK) {
+        return result;
+    }
+
+    hal_rect_t all = { 0, 0, screen.width, screen.height };
+    scene_damage(scene, &all);
+    return HAL_OK;
+}
+
+hal_result_t layout_scene_render(layout_scene_t *scene)
+{
+    hal_display_config_t screen;
+    hal_point_t positions[LAYOUT_MAX_NODES];
+    bool visible[LAYOUT_MAX_NODES];
+
+    if (!scene) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    hal_result_t result = hal_display_get_config(&screen);
+    if (result != HAL_OK) {
+        return result;
+    }
+
+    /* Resolve positions and collect damage from changed nodes */
+    for (uint8_t i = 0; i < scene->node_count; i++) {
+        layout_node_t *node = &scene->nodes[i];
+        hal_point_t position = node->origin;
+        bool shown = (node->flags & LAYOUT_NODE_FLAG_VISIBLE) != 0;
+
+        if (node->parent != LAYOUT_NODE_ROOT) {
+            position.x = (int16_t)(position.x + positions[node->parent].x);
+            position.y = (int16_t)(position.y + positions[node->parent].y);
+            shown = shown && visible[node->parent];
+        }
+        positions[i] = position;
+        visible[i] = shown;
+
+        bool was_shown = (node->flags & LAYOUT_NODE_FLAG_SHOWN) != 0;
+        bool moved = position.x != node->position.x || position.y != node->position.y;
+
+        if (!(node->flags & LAYOUT_NODE_FLAG_DIRTY) && shown == was_shown && (!moved || !shown)) {
+            continue;
+        }
+
+        if (was_shown) {
+            scene_damage(scene, &node->drawn);
+        }
+
+        memset(&node->drawn, 0, sizeof(node->drawn));
+        if (shown) {
+            const layout_cmd_t *cmd = &scene->commands[node->first_command];
+            for (uint8_t c = 0; c < node->command_count; c++) {
+                hal_rect_t bounds;
+                if (command_bounds(&cmd[c], position.x, position.y, &screen, &bounds)) {
+                    layout_rect_union(&node->drawn, &bounds);
+                }
+            }
+            scene_damage(scene, &node->drawn);
+        }
+
+        node->position = position;
+        node->flags &= (uint8_t)~(LAYOUT_NODE_FLAG_DIRTY | LAYOUT_NODE_FLAG_SHOWN);
+        if (shown) {
+            node->flags |= LAYOUT_NODE_FLAG_SHOWN;
+        }
+    }
+
+    /* Re-rasterize each damaged area under a clip */
+    for (uint8_t d = 0; d < scene->damage_count; d++) {
+        const hal_rect_t *area = &scene->damage[d];
+
+        hal_graphics_set_clip(area);
+        hal_graphics_fill_rect(area, HAL_GRAPHICS_MODE_CLEAR);
+
+        for (uint8_t i = 0; i < scene->node_count; i++) {
+            const layout_node_t *node = &scene->nodes[i];
+
+            if (!visible[i] || !rect_overlaps(&node->drawn, area)) {
+                continue;
+            }
+
+            const layout_cmd_t *cmd = &scene->commands[node->first_command];
+            for (uint8_t c = 0; c < node->command_count; c++) {
+                command_draw(&cmd[c], positions[i].x, positions[i].y);
+            }
+        }
+
+        layout_rect_union(&scene->pending, area);
+    }
+
+    hal_graphics_set_clip(NULL);
+    scene->damage_count = 0;
+
+    if (scene->pending.width == 0) {
+        return HAL_OK;
+    }
+
+    /* A transfer still in flight: keep the area for the next pass */
+    result = hal_display_update_rect_async(&scene->pending);
+    if (result == HAL_ERROR_RESOURCE_BUSY) {
+        return HAL_OK;
+    }
+
+    memset(&scene->pending, 0, sizeof(scene->pending));
+    return result;
+}
+
+void layout_rect_union(hal_rect_t *dst, const hal_rect_t *src)
+{
+    if (src->width == 0 || src->height == 0) {
+        return;
+    }
+
+    if (dst->width == 0 || dst->height == 0) {
+        *dst = *src;
+        return;
+    }
+
+    int32_t left = (src->x < dst->x) ? src->x : dst->x;
+    int32_t top = (src->y < dst->y) ? src->y : dst->y;
+    int32_t right = dst->x + dst->width;
+    int32_t bottom = dst->y + dst->height;
+
+    if (src->x + src->width > right) {
+        right = src->x + src->width;
+    }
+    if (src->y + src->height > bottom) {
+        bottom = src->y + src->height;
+    }
+
+    dst->x = (int16_t)left;
+    dst->y = (int16_t)top;
+    dst->width = (uint16_t)(right - left);
+    dst->height = (uint16_t)(bottom - top);
+}
+
+/* Static helper functions */
+
+static layout_node_t *scene_node(layout_scene_t *scene, uint8_t id)
+{
+    if (!scene || id >= scene->node_count) {
+        return NULL;
+    }
+
+    return &scene->nodes[id];
+}
+
+static layout_cmd_t *node_append(layout_scene_t *scene, uint8_t id, hal_result_t *result)
+{
+    layout_node_t *node = scene_node(scene, id);
+    if (!node) {
+        *result = HAL_ERROR_INVALID_PARAM;
+        return NULL;
+    }
+
+    if (node->command_count >= node->command_capacity) {
+        *result = HAL_ERROR_NO_MEMORY;
+        return NULL;
+    }
+
+    layout_cmd_t *cmd = &scene->commands[node->first_command + node->command_count++];
+    memset(cmd, 0, sizeof(*cmd));
+    node->flags |= LAYOUT_NODE_FLAG_DIRTY;
+    *result = HAL_OK;
+    return cmd;
+}
+
+/**
+ * @brief Screen area a command can touch
+ * @return false if the command draws nothing
+ */
+static bool command_bounds(const layout_cmd_t *cmd, int16_t ox, int16_t oy,
+                           const hal_display_config_t *screen, hal_rect_t *bounds)
+{
+    int32_t x = ox + cmd->x;
+    int32_t y = oy + cmd->y;
+    int32_t w = cmd->w;
+    int32_t h = cmd->h;
+
+    switch (cmd->type) {
+        case LAYOUT_CMD_LINE: {
+            int32_t x1 = ox + cmd->w;
+            int32_t y1 = oy + cmd->h;
+            w = (x1 > x ? x1 - x : x - x1) + 1;
+            h = (y1 > y ? y1 - y : y - y1) + 1;
+            x = (x1 < x) ? x1 : x;
+            y = (y1 < y) ? y1 : y;
+            break;
+        }
+
+        case LAYOUT_CMD_TEXT: {
+            const char *text = (const char *)cmd->data;
+            const hal_font_t *font = hal_graphics_get_font((hal_font_size_t)cmd->font);
+            int32_t lines = 1;
+
+            if (!font) {
+                return false;
+            }
+            for (const char *p = text; *p; p++) {
+                lines += (*p == '\n');
+            }
+
+            w = hal_graphics_get_text_width(text, (hal_font_size_t)cmd->font);
+            h = lines * font->height;
+
+            /* Text that wraps at the right edge may reach the bottom right corner */
+            if (x + w > screen->width) {
+                w = screen->width - x;
+                h = screen->height - y;
+            }
+            break;
+        }
+
+        default:
+            break;
+    }
+
+    if (w <= 0 || h <= 0) {
+        return false;
+    }
+
+    bounds->x = (int16_t)x;
+    bounds->y = (int16_t)y;
+    bounds->width = (uint16_t)w;
+    bounds->height = (uint16_t)h;
+    return true;
+}
+
+static void command_draw(const layout_cmd_t *cmd, int16_t ox, int16_t oy)
+{
+    hal_point_t position = { (int16_t)(ox + cmd->x), (int16_t)(oy + cmd->y) };
+    hal_rect_t rect = { position.x, position.y, (uint16_t)cmd->w, (uint16_t)cmd->h };
+
+    switch (cmd->type) {
+        case LAYOUT_CMD_RECT:
+            hal_graphics_draw_rect(&rect, (hal_graphics_mode_t)cmd->mode);
+            break;
+
+        case LAYOUT_CMD_FILL_RECT:
+            hal_graphics_fill_rect(&rect, (hal_graphics_mode_t)cmd->mode);
+            break;
+
+        case LAYOUT_CMD_LINE:
+            hal_graphics_draw_line(position.x, position.y, (int16_t)(ox + cmd->w), (int16_t)(oy + cmd->h),
+                                   (hal_graphics_mode_t)cmd->mode);
+            break;
+
+        case LAYOUT_CMD_TEXT:
+            hal_graphics_draw_text((const char *)cmd->data, &position, (hal_font_size_t)cmd->font,
+                                   (hal_graphics_mode_t)cmd->mode);
+            break;
+
+        case LAYOUT_CMD_BITMAP:
+            hal_graphics_blit((const hal_bitmap_t *)cmd->data, &position, (hal_blit_mode_t)cmd->mode);
+            break;
+
+        case LAYOUT_CMD_CANVAS:
+            hal_canvas_composite(HAL_CANVAS_SCREEN, (const hal_canvas_t *)cmd->data, NULL, NULL, &position,
+                                 (hal_blit_mode_t)cmd->mode);
+            break;
+
+        default:
+            break;
+    }
+}
+
+static bool rect_overlaps(const hal_rect_t *a, const hal_rect_t *b)
+{
+    return a->width != 0 && a->height != 0 && b->width != 0 && b->height != 0 &&
+           a->x < b->x + b->width && b->x < a->x + a->width &&
+           a->y < b->y + b->height && b->y < a->y + a->height;
+}
+
+static uint32_t rect_area(const hal_rect_t *rect)
+{
+    return (uint32_t)rect->width * rect->height;
+}
+
+/**
+ * @brief Add a rectangle to the damage list
+ *
+ * Overlapping rectangles are merged. When the list is full the rectangle
+ * joins the entry whose area grows least.
+ */
+static void scene_damage(layout_scene_t *scene, const hal_rect_t *rect)
+{
+    if (rect->width == 0 || rect->height == 0) {
+        return;
+    }
+
+    hal_rect_t merged = *rect;
+    uint8_t d = 0;
+
+    /* Absorb every entry the (growing) rectangle overlaps */
+    while (d < scene->damage_count) {
+        if (rect_overlaps(&scene->damage[d], &merged)) {
+            layout_rect_union(&merged, &scene->damage[d]);
+            scene->damage[d] = scene->damage[--scene->damage_count];
+            d = 0;
+        } else {
+            d++;
+        }
+    }
+
+    if (scene->damage_count < LAYOUT_MAX_DAMAGE) {
+        scene->damage[scene->damage_count++] = merged;
+        return;
+    }
+
+    uint8_t best = 0;
+    uint32_t best_growth = UINT32_MAX;
+
+    for (d = 0; d < scene->damage_count; d++) {
+        hal_rect_t candidate = scene->damage[d];
+        layout_rect_union(&candidate, &merged);
+
+        uint32_t growth = rect_area(&candidate) - rect_area(&scene->damage[d]);
+        if (growth < best_growth) {
+            best_growth = growth;
+            best = d;
+        }
+    }
+
+    layout_rect_union(&scene->damage[best], &merged);
+}
@@ -0,0 +1,255 @@
+/**
+ * @file layout_scene.h
+ * @brief Retained-mode scene graph for the custom layout engine
+ *
+ * Widgets are scene nodes that own a short list of drawing commands
+ * (rectangles, lines, text, bitmaps) positioned relative to the node
+ * origin. Nodes may be nested; a child's origin is relative to its parent.
+ * The scene tracks the screen bounds of every node, so a render pass only
+ * re-rasterizes the damaged areas and flushes them with a partial display
+ * update instead of redrawing and transmitting the whole frame.
+ *
+ * All storage is fixed size. Text, bitmap and canvas commands reference
+ * caller memory, which must stay valid while the node exists; after
+ * changing it in place, call layout_node_invalidate(). Static parts that
+ * are expensive to draw can be rendered once into a canvas and added with
+ * layout_node_add_canvas(), so redraws only composite them.
+ */
+
+#ifndef LAYOUT_SCENE_H
+#define LAYOUT_SCENE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "hal_display.h"
+
+/* Scene limits */
+#define LAYOUT_MAX_NODES            32
+#define LAYOUT_MAX_COMMANDS         128
+#define LAYOUT_MAX_DAMAGE           8
+
+/* Parent id for top-level nodes */
+#define LAYOUT_NODE_ROOT            0xFF
+
+/**
+ * @brief Drawing command types
+ */
+typedef enum {
+    LAYOUT_CMD_RECT = 0,            /**< Rectangle outline */
+    LAYOUT_CMD_FILL_RECT,           /**< Filled rectangle */
+    LAYOUT_CMD_LINE,                /**< Line between two points */
+    LAYOUT_CMD_TEXT,                /**< Text string */
+    LAYOUT_CMD_BITMAP,              /**< Bitmap blit */
+    LAYOUT_CMD_CANVAS,              /**< Pre-rendered canvas */
+    LAYOUT_CMD_MAX
+} layout_cmd_type_t;
+
+/**
+ * @brief Compact drawing command (16 bytes)
+ */
+typedef struct {
+    uint8_t type;                   /**< layout_cmd_type_t */
+    uint8_t mode;                   /**< hal_graphics_mode_t, or hal_blit_mode_t for bitmaps */
+    uint8_t font;                   /**< hal_font_size_t for text */
+    uint8_t reserved;
+    int16_t x;                      /**< X relative to the node origin */
+    int16_t y;                      /**< Y relative to the node origin */
+    int16_t w;                      /**< Width, or line end X */
+    int16_t h;                      /**< Height, or line end Y */
+    const void *data;               /**< Text string, hal_bitmap_t or hal_canvas_t */
+} layout_cmd_t;
+
+/**
+ * @brief Scene node (one widget)
+ */
+typedef struct {
+    hal_point_t origin;             /**< Origin relative to the parent */
+    hal_point_t position;           /**< Absolute origin at the last render */
+    hal_rect_t drawn;               /**< Screen area covered at the last render */
+    uint16_t first_command;         /**< Index of the node's first command */
+    uint8_t command_count;          /**< Commands in use */
+    uint8_t command_capacity;       /**< Commands reserved at creation */
+    uint8_t parent;                 /**< Parent node id or LAYOUT_NODE_ROOT */
+    uint8_t flags;                  /**< LAYOUT_NODE_FLAG_* */
+} layout_node_t;
+
+/* Node flags */
+#define LAYOUT_NODE_FLAG_VISIBLE    (1 << 0)    /**< Node is shown (children inherit hiding) */
+#define LAYOUT_NODE_FLAG_DIRTY      (1 << 1)    /**< Commands changed since the last render */
+#define LAYOUT_NODE_FLAG_SHOWN      (1 << 2)    /**< Node was visible at the last render */
+
+/**
+ * @brief Scene
+ */
+typedef struct {
+    layout_node_t nodes[LAYOUT_MAX_NODES];
+    layout_cmd_t commands[LAYOUT_MAX_COMMANDS];
+    hal_rect_t damage[LAYOUT_MAX_DAMAGE];
+    hal_rect_t pending;             /**< Rendered area not yet sent to the panel */
+    uint16_t commands_used;
+    uint8_t node_count;
+    uint8_t damage_count;
+} layout_scene_t;
+
+/**
+ * @brief Initialize an empty scene
+ * @param scene Scene to initialize
+ * @return HAL_OK on success, error code otherwise
+ */
+hal_result_t layout_scene_init(layout_scene_t *scene);
+
+/**
+ * @brief Create a node
+ *
+ * Nodes paint in creation order, so children always draw over their
+ * parents.
+ *
+ * @param scene Scene
+ * @param parent Parent node id or LAYOUT_NODE_ROOT
+ * @param origin Origin relative to the parent
+ * @param capacity Number of commands to reserve for the node
+ * @param id Pointer to store the new node id
+ * @return HAL_OK on success, HAL_ERROR_NO_MEMORY if the scene is full
+ */
+hal_result_t layout_node_create(layout_scene_t *scene, uint8_t parent, const hal_point_t *origin,
+                                uint8_t capacity, uint8_t *id);
+
+/**
+ * @brief Append a rectangle command
+ * @param scene Scene
+ * @param id Node id
+ * @param rect Rectangle relative to the node origin
+ * @param fill Fill the rectangle instead of outlining it
+ * @param mode Graphics mode
+ * @return HAL_OK on success, HAL_ERROR_NO_MEMORY if the node is full
+ */
+hal_result_t layout_node_add_rect(layout_scene_t *scene, uint8_t id, const hal_rect_t *rect,
+                                  bool fill, hal_graphics_mode_t mode);
+
+/**
+ * @brief Append a line command
+ * @param scene Scene
+ * @param id Node id
+ * @param x0 Start X relative to the node origin
+ * @param y0 Start Y relative to the node origin
+ * @param x1 End X relative to the node origin
+ * @param y1 End Y relative to the node origin
+ * @param mode Graphics mode
+ * @return HAL_OK on success, HAL_ERROR_NO_MEMORY if the node is full
+ */
+hal_result_t layout_node_add_line(layout_scene_t *scene, uint8_t id, int16_t x0, int16_t y0,
+                                  int16_t x1, int16_t y1, hal_graphics_mode_t mode);
+
+/**
+ * @brief Append a text command
+ * @param scene Scene
+ * @param id Node id
+ * @param text Text string (referenced, not copied)
+ * @param position Position relative to the node origin
+ * @param font_size Font size
+ * @param mode Graphics mode
+ * @return HAL_OK on success, HAL_ERROR_NO_MEMORY if the node is full
+ */
+hal_result_t layout_node_add_text(layout_scene_t *scene, uint8_t id, const char *text,
+                                  const hal_point_t *position, hal_font_size_t font_size,
+                                  hal_graphics_mode_t mode);
+
+/**
+ * @brief Append a bitmap command
+ * @param scene Scene
+ * @param id Node id
+ * @param bitmap Bitmap descriptor (referenced, not copied)
+ * @param position Position relative to the node origin
+ * @param mode Blit mode
+ * @return HAL_OK on success, HAL_ERROR_NO_MEMORY if the node is full
+ */
+hal_result_t layout_node_add_bitmap(layout_scene_t *scene, uint8_t id, const hal_bitmap_t *bitmap,
+                                    const hal_point_t *position, hal_blit_mode_t mode);
+
+/**
+ * @brief Append a canvas command
+ * @param scene Scene
+ * @param id Node id
+ * @param canvas Pre-rendered canvas (referenced, not copied)
+ * @param position Position relative to the node origin
+ * @param mode Blit mode (not MASK)
+ * @return HAL_OK on success, HAL_ERROR_NO_MEMORY if the node is full
+ */
+hal_result_t layout_node_add_canvas(layout_scene_t *scene, uint8_t id, const hal_canvas_t *canvas,
+                                    const hal_point_t *position, hal_blit_mode_t mode);
+
+/**
+ * @brief Remove all commands from a node
+ * @param scene Scene
+ * @param id Node id
+ * @return HAL_OK on success, error code otherwise
+ */
+hal_result_t layout_node_clear(layout_scene_t *scene, uint8_t id);
+
+/**
+ * @brief Replace the string of a text command
+ * @param scene Scene
+ * @param id Node id
+ * @param index Command index within the node
+ * @param text New text string (referenced, not copied)
+ * @return HAL_OK on success, error code otherwise
+ */
+hal_result_t layout_node_set_text(layout_scene_t *scene, uint8_t id, uint8_t index, const char *text);
+
+/**
+ * @brief Move a node (and its children)
+ * @param scene Scene
+ * @param id Node id
+ * @param origin New origin relative to the parent
+ * @return HAL_OK on success, error code otherwise
+ */
+hal_result_t layout_node_move(layout_scene_t *scene, uint8_t id, const hal_point_t *origin);
+
+/**
+ * @brief Show or hide a node (and its children)
+ * @param scene Scene
+ * @param id Node id
+ * @param visible Visibility
+ * @return HAL_OK on success, error code otherwise
+ */
+hal_result_t layout_node_set_visible(layout_scene_t *scene, uint8_t id, bool visible);
+
+/**
+ * @brief Mark a node for redraw after its referenced data changed
+ * @param scene Scene
+ * @param id Node id
+ * @return HAL_OK on success, error code otherwise
+ */
+hal_result_t layout_node_invalidate(layout_scene_t *scene, uint8_t id);
+
+/**
+ * @brief Mark the whole screen for redraw
+ * @param scene Scene
+ * @return HAL_OK on success, error code otherwise
+ */
+hal_result_t layout_scene_invalidate_all(layout_scene_t *scene);
+
+/**
+ * @brief Re-rasterize damaged areas and start a partial display update
+ *
+ * Damaged areas are cleared and every visible node overlapping them is
+ * redrawn clipped to the area. If the display is still busy with the
+ * previous transfer, the area is kept and sent by the next call.
+ *
+ * @param scene Scene
+ * @return HAL_OK on success, error code otherwise
+ */
+hal_result_t layout_scene_render(layout_scene_t *scene);
+
+/**
+ * @brief Grow a rectangle to cover another
+ *
+ * An empty source leaves the destination alone; an empty destination
+ * takes the source.
+ *
+ * @param dst Rectangle to grow
+ * @param src Rectangle to cover
+ */
+void layout_rect_union(hal_rect_t *dst, const hal_rect_t *src);
+
+#endif /* LAYOUT_SCENE_H */
@@ -0,0 +1,147 @@
+/**
+ * @file net_internal.h
+ * @brief Network stack internals shared by the IP and TCP layers
+ */
+
+#ifndef NET_INTERNAL_H
+#define NET_INTERNAL_H
+
+#include "net_stack.h"
+
+/* Header sizes */
+#define NET_IP_HEADER               20
+#define NET_UDP_HEADER              8
+#define NET_TCP_HEADER              20
+
+/* IP protocol numbers */
+#define NET_PROTOCOL_ICMP           1
+#define NET_PROTOCOL_TCP            6
+#define NET_PROTOCOL_UDP            17
+
+/* Sequence number comparison, modulo 2^32 */
+#define NET_SEQ_LT(a, b)            ((int32_t)((a) - (b)) < 0)
+#define NET_SEQ_LEQ(a, b)           ((int32_t)((a) - (b)) <= 0)
+#define NET_SEQ_GT(a, b)            ((int32_t)((a) - (b)) > 0)
+#define NET_SEQ_GEQ(a, b)           ((int32_t)((a) - (b)) >= 0)
+
+/**
+ * @brief Buffer queue
+ */
+typedef struct {
+    net_buf_t *head;
+    net_buf_t *tail;
+    uint8_t count;
+} net_queue_t;
+
+/**
+ * @brief Socket
+ */
+typedef struct {
+    net_socket_t handle;            /* NET_SOCKET_NONE if the slot is free */
+    net_protocol_t protocol;
+    bool open;                      /* Handle still held by the application */
+    uint16_t local_port;
+    uint16_t remote_port;
+    uint32_t remote_address;
+    net_queue_t rx;                 /* Received, in order */
+    net_queue_t ooo;                /* Received ahead of a gap, by sequence number (TCP) */
+    hal_result_t error;             /* Reported once the stream is gone */
+
+    /* TCP */
+    net_tcp_state_t state;
+    net_socket_t parent;            /* Listening socket, until accepted */
+    net_queue_t tx;                 /* Unacknowledged and unsent segments */
+    net_buf_t *tx_next;             /* First segment not yet sent */
+    uint32_t tx_seq;                /* Sequence number of tx.head */
+    uint32_t iss;                   /* Initial send sequence */
+    uint32_t snd_una;               /* Oldest unacknowledged */
+    uint32_t snd_nxt;               /* Next to send */
+    uint32_t snd_max;               /* Highest sent */
+    uint32_t snd_wnd;               /* Peer's receive window */
+    uint32_t rcv_nxt;               /* Next expected */
+    uint16_t mss;                   /* Peer's MSS */
+    uint32_t cwnd;                  /* Congestion window */
+    uint32_t ssthresh;              /* Slow start threshold */
+    uint8_t dupacks;                /* Duplicate ACKs in a row, 3 and up while recovering */
+    uint32_t recover;               /* snd_max when fast recovery began */
+    uint32_t srtt;                  /* Smoothed RTT, ms << 3 */
+    uint32_t rttvar;                /* RTT variance, ms << 2 */
+    uint32_t rto;                   /* Retransmission timeout, ms */
+    bool rtt_timing;                /* A segment is being timed */
+    uint32_t rtt_seq;               /* ACK that ends the timed segment */
+    uint32_t rtt_start;
+    bool timer_armed;               /* Retransmit, persist or TIME_WAIT timer */
+    uint32_t timer_ms;              /* Expiry */
+    uint8_t retries;
+    bool persist;                   /* Probing a window too small for the next segment */
+    uint8_t persist_backoff;        /* Probes go every rto << persist_backoff */
+    bool ack_pending;               /* Delayed ACK owed */
+    uint8_t ack_segments;           /* Segments received since the last ACK */
+    bool window_closed;             /* Last advertised window was zero */
+    bool fin_pending;               /* Close requested, FIN follows the data */
+    bool fin_sent;
+    bool fin_received;
+} net_socket_entry_t;
+
+/* Shared state */
+extern net_stats_t net_stats;
+extern uint32_t net_now;
+
+/* Sockets */
+net_socket_entry_t *net_socket_find(net_socket_t handle);
+net_socket_entry_t *net_socket_create(net_protocol_t protocol);
+net_socket_entry_t *net_socket_at(uint32_t index);
+void net_socket_release(net_socket_entry_t *entry);
+uint16_t net_ephemeral_port(net_protocol_t protocol);
+
+/* Buffers and queues */
+net_buf_t *net_buf_wrap(wifi_emu_buffer_t *frame, uint8_t *data, uint16_t length);
+net_buf_t *net_buf_reserve(uint32_t headroom);
+void net_queue_push(net_queue_t *queue, net_buf_t *buffer);
+net_buf_t *net_queue_pop(net_queue_t *queue);
+void net_queue_free(net_queue_t *queue);
+
+/* IP layer */
+uint32_t net_checksum(uint32_t sum, const uint8_t *data, uint32_t length);
+uint16_t net_checksum_fold(uint32_t sum);
+uint32_t net_pseudo_checksum(uint32_t source, uint32_t destination, uint8_t protocol, uint32_t length);
+uint32_t net_local_address(void);
+const uint32_t *net_iss_key(void);
+hal_result_t net_ip_output(wifi_emu_buffer_t *frame, uint32_t destination, uint8_t protocol, uint32_t length);
+
+/* TCP layer */
+void net_tcp_input(wifi_emu_buffer_t *frame, uint32_t source, uint8_t *segment, uint32_t length);
+void net_tcp_poll(net_socket_entry_t *entry);
+hal_result_t net_tcp_connect(net_socket_entry_t *entry);
+hal_result_t net_tcp_send_buf(net_socket_entry_t *entry, net_buf_t *chain);
+hal_result_t net_tcp_send(net_socket_entry_t *entry, const uint8_t *data, uint32_t length, uint32_t *sent);
+hal_result_t net_tcp_recv_buf(net_socket_entry_t *entry, net_buf_t **chain);
+hal_result_t net_tcp_recv(net_socket_entry_t *entry, uint8_t *data, uint32_t length, uint32_t *received);
+void net_tcp_close(net_socket_entry_t *entry);
+
+/* Big-endian field access */
+static inline uint16_t net_get16(const uint8_t *p)
+{
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+static inline uint32_t net_get32(const uint8_t *p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static inline void net_put16(uint8_t *p, uint16_t value)
+{
+    p[0] = (uint8_t)(value >> 8);
+    p[1] = (uint8_t)value;
+}
+
+static inline void net_put32(uint8_t *p, uint32_t value)
+{
+    p[0] = (uint8_t)(value >> 24);
+    p[1] = (uint8_t)(value >> 16);
+    p[2] = (uint8_t)(value >> 8);
+    p[3] = (uint8_t)value;
+}
+
+#endif /* NET_INTERNAL_H */
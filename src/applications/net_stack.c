@@ -0,0 +1,806 @@
+/**
+ * @file net_stack.c
+ * @brief IPv4, ICMP echo, UDP and the socket API
+ */
+
+#include "net_internal.h"
+#include <string.h>
+
+/* IPv4 header fields */
+#define NET_IP_VERSION_IHL          0x45        /* Version 4, no options */
+#define NET_IP_DONT_FRAGMENT        0x4000
+#define NET_IP_FRAGMENT_MASK        0x3FFF      /* More fragments and offset */
+#define NET_IP_TTL                  64
+#define NET_IP_BROADCAST            0xFFFFFFFF
+
+/* ICMP */
+#define NET_ICMP_ECHO_REPLY         0
+#define NET_ICMP_ECHO_REQUEST       8
+#define NET_ICMP_HEADER             8
+
+/* Ephemeral ports (RFC 6335) */
+#define NET_PORT_EPHEMERAL_FIRST    49152
+
+/* Shared state */
+net_stats_t net_stats;
+uint32_t net_now = 0;
+
+/* Global state */
+static bool net_initialized = false;
+static net_config_t net_config;
+static net_socket_entry_t net_sockets[NET_SOCKETS];
+static net_socket_t net_next_handle = 1;
+static net_buf_t net_bufs[NET_BUFFERS];
+static net_buf_t *net_buf_free_list = NULL;
+static uint16_t net_ip_id = 0;
+static uint16_t net_next_port = NET_PORT_EPHEMERAL_FIRST;
+
+/* Static function prototypes */
+static void net_ip_input(wifi_emu_buffer_t *frame);
+static void net_icmp_input(wifi_emu_buffer_t *frame, uint32_t source, uint8_t *message, uint32_t length);
+static void net_udp_input(wifi_emu_buffer_t *frame, uint32_t source, uint32_t destination, uint8_t *datagram,
+                          uint32_t length);
+static hal_result_t net_udp_output(net_socket_entry_t *entry, net_buf_t *buffer);
+static uint32_t net_headroom(net_protocol_t protocol);
+static net_buf_t *net_buf_get(void);
+static void net_buf_put(net_buf_t *buffer);
+
+hal_result_t net_init(const net_config_t *config)
+{
+    if (!config || config->connection >= WIFI_EMU_MAX_CONNECTIONS || config->address == 0) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+    if (net_initialized) {
+        return HAL_ERROR_RESOURCE_BUSY;
+    }
+
+    net_config = *config;
+    memset(net_sockets, 0, sizeof(net_sockets));
+    memset(&net_stats, 0, sizeof(net_stats));
+    net_buf_free_list = NULL;
+    for (uint32_t i = 0; i < NET_BUFFERS; i++) {
+        net_bufs[i].next = net_buf_free_list;
+        net_buf_free_list = &net_bufs[i];
+    }
+
+    net_initialized = true;
+    return HAL_OK;
+}
+
+hal_result_t net_deinit(void)
+{
+    if (!net_initialized) {
+        return HAL_ERROR_NOT_INITIALIZED;
+    }
+
+    for (uint32_t i = 0; i < NET_SOCKETS; i++) {
+        if (net_sockets[i].handle != NET_SOCKET_NONE) {
+            net_socket_release(&net_sockets[i]);
+        }
+    }
+
+    net_initialized = false;
+    return HAL_OK;
+}
+
+void net_input(uint8_t connection, wifi_emu_buffer_t *frame, void *user_data)
+{
+    (void)user_data;
+
+    if (frame == NULL) {
+        return;
+    }
+    if (!net_initialized || connection != net_config.connection) {
+        wifi_emu_free(frame);
+        return;
+    }
+
+    net_ip_input(frame);
+}
+
+void net_poll(uint32_t now_ms)
+{
+    if (!net_initialized) {
+        return;
+    }
+
+    net_now = now_ms;
+    for (uint32_t i = 0; i < NET_SOCKETS; i++) {
+        net_socket_entry_t *entry = &net_sockets[i];
+        if (entry->handle != NET_SOCKET_NONE && entry->protocol == NET_TCP) {
+            net_tcp_poll(entry);
+        }
+    }
+}
+
+hal_result_t net_get_stats(net_stats_t *stats)
+{
+    if (!net_initialized) {
+        return HAL_ERROR_NOT_INITIALIZED;
+    }
+    if (!stats) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    *stats = net_stats;
+    return HAL_OK;
+}
+
+hal_result_t net_socket_open(net_protocol_t protocol, net_socket_t *socket)
+{
+    if (!net_initialized) {
+        return HAL_ERROR_NOT_INITIALIZED;
+    }
+    if (!socket || (protocol != NET_UDP && protocol != NET_TCP)) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    net_socket_entry_t *entry = net_socket_create(protocol);
+    if (entry == NULL) {
+        return HAL_ERROR_NO_MEMORY;
+    }
+
+    entry->open = true;
+    *socket = entry->handle;
+    return HAL_OK;
+}
+
+hal_result_t net_socket_bind(net_socket_t socket, uint16_t port)
+{
+    net_socket_entry_t *entry = net_socket_find(socket);
+    if (entry == NULL) {
+        return HAL_ERROR_RESOURCE_NOT_FOUND;
+    }
+    if (entry->local_port != 0) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    if (port == 0) {
+        port = net_ephemeral_port(entry->protocol);
+        if (port == 0) {
+            return HAL_ERROR_NO_MEMORY;
+        }
+    }
+
+    /* Connected TCP sockets share their listener's port */
+    for (uint32_t i = 0; i < NET_SOCKETS; i++) {
+        net_socket_entry_t *other = &net_sockets[i];
+        if (other->handle == NET_SOCKET_NONE || other == entry || other->protocol != entry->protocol ||
+            other->local_port != port) {
+            continue;
+        }
+        if (other->protocol == NET_UDP || other->state == NET_TCP_LISTEN || other->state == NET_TCP_CLOSED) {
+            return HAL_ERROR_RESOURCE_BUSY;
+        }
+    }
+
+    entry->local_port = port;
+    return HAL_OK;
+}
+
+hal_result_t net_socket_listen(net_socket_t socket)
+{
+    net_socket_entry_t *entry = net_socket_find(socket);
+    if (entry == NULL) {
+        return HAL_ERROR_RESOURCE_NOT_FOUND;
+    }
+    if (entry->protocol != NET_TCP) {
+        return HAL_ERROR_NOT_SUPPORTED;
+    }
+    if (entry->local_port == 0 || entry->state != NET_TCP_CLOSED) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    entry->state = NET_TCP_LISTEN;
+    return HAL_OK;
+}
+
+hal_result_t net_socket_accept(net_socket_t socket, net_socket_t *client)
+{
+    if (!client) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    net_socket_entry_t *entry = net_socket_find(socket);
+    if (entry == NULL) {
+        return HAL_ERROR_RESOURCE_NOT_FOUND;
+    }
+    if (entry->protocol != NET_TCP) {
+        return HAL_ERROR_NOT_SUPPORTED;
+    }
+    if (entry->state != NET_TCP_LISTEN) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    for (uint32_t i = 0; i < NET_SOCKETS; i++) {
+        net_socket_entry_t *child = &net_sockets[i];
+        if (child->handle == NET_SOCKET_NONE || child->parent != entry->handle ||
+            (child->state != NET_TCP_ESTABLISHED && child->state != NET_TCP_CLOSE_WAIT)) {
+            continue;
+        }
+
+        child->parent = NET_SOCKET_NONE;
+        child->open = true;
+        *client = child->handle;
+        return HAL_OK;
+    }
+
+    return HAL_ERROR_RESOURCE_BUSY;
+}
+
+hal_result_t net_socket_connect(net_socket_t socket, uint32_t address, uint16_t port)
+{
+    if (address == 0 || port == 0) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    net_socket_entry_t *entry = net_socket_find(socket);
+    if (entry == NULL) {
+        return HAL_ERROR_RESOURCE_NOT_FOUND;
+    }
+    if (entry->protocol == NET_TCP && entry->state != NET_TCP_CLOSED) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    if (entry->local_port == 0) {
+        entry->local_port = net_ephemeral_port(entry->protocol);
+        if (entry->local_port == 0) {
+            return HAL_ERROR_NO_MEMORY;
+        }
+    }
+    entry->remote_address = address;
+    entry->remote_port = port;
+
+    if (entry->protocol == NET_TCP) {
+        return net_tcp_connect(entry);
+    }
+    return HAL_OK;
+}
+
+net_buf_t *net_buf_alloc(net_socket_t socket)
+{
+    net_socket_entry_t *entry = net_socket_find(socket);
+    if (entry == NULL) {
+        return NULL;
+    }
+
+    return net_buf_reserve(net_headroom(entry->protocol));
+}
+
+void net_buf_free(net_buf_t *chain)
+{
+    while (chain) {
+        net_buf_t *next = chain->next;
+        wifi_emu_free(chain->frame);
+        net_buf_put(chain);
+        chain = next;
+    }
+}
+
+hal_result_t net_socket_send_buf(net_socket_t socket, net_buf_t *chain)
+{
+    if (!chain) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    net_socket_entry_t *entry = net_socket_find(socket);
+    if (entry == NULL) {
+        return HAL_ERROR_RESOURCE_NOT_FOUND;
+    }
+
+    if (entry->protocol == NET_TCP) {
+        return net_tcp_send_buf(entry, chain);
+    }
+    if (chain->next != NULL) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    hal_result_t result = net_udp_output(entry, chain);
+    if (result == HAL_OK) {
+        /* The link owns the frame now */
+        net_buf_put(chain);
+    }
+    return result;
+}
+
+hal_result_t net_socket_send(net_socket_t socket, const void *data, uint32_t length, uint32_t *sent)
+{
+    if (!data && length > 0) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    net_socket_entry_t *entry = net_socket_find(socket);
+    if (entry == NULL) {
+        return HAL_ERROR_RESOURCE_NOT_FOUND;
+    }
+
+    if (entry->protocol == NET_TCP) {
+        uint32_t taken = 0;
+        hal_result_t result = net_tcp_send(entry, (const uint8_t *)data, length, &taken);
+        if (sent) {
+            *sent = taken;
+        }
+        return result;
+    }
+
+    if (length > NET_UDP_PAYLOAD_MAX) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    net_buf_t *buffer = net_buf_reserve(net_headroom(NET_UDP));
+    if (buffer == NULL) {
+        return HAL_ERROR_RESOURCE_BUSY;
+    }
+    if (length > 0) {
+        memcpy(buffer->data, data, length);
+    }
+    buffer->length = (uint16_t)length;
+
+    hal_result_t result = net_udp_output(entry, buffer);
+    if (result != HAL_OK) {
+        net_buf_free(buffer);
+        return result;
+    }
+
+    net_buf_put(buffer);
+    if (sent) {
+        *sent = length;
+    }
+    return HAL_OK;
+}
+
+hal_result_t net_socket_recv_buf(net_socket_t socket, net_buf_t **chain)
+{
+    if (!chain) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    net_socket_entry_t *entry = net_socket_find(socket);
+    if (entry == NULL) {
+        return HAL_ERROR_RESOURCE_NOT_FOUND;
+    }
+
+    if (entry->protocol == NET_TCP) {
+        return net_tcp_recv_buf(entry, chain);
+    }
+
+    *chain = net_queue_pop(&entry->rx);
+    return *chain ? HAL_OK : HAL_ERROR_RESOURCE_BUSY;
+}
+
+hal_result_t net_socket_recv(net_socket_t socket, void *data, uint32_t length, uint32_t *received)
+{
+    if ((!data && length > 0) || !received) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    net_socket_entry_t *entry = net_socket_find(socket);
+    if (entry == NULL) {
+        return HAL_ERROR_RESOURCE_NOT_FOUND;
+    }
+
+    if (entry->protocol == NET_TCP) {
+        return net_tcp_recv(entry, (uint8_t *)data, length, received);
+    }
+
+    net_buf_t *datagram = net_queue_pop(&entry->rx);
+    if (datagram == NULL) {
+        *received = 0;
+        return HAL_ERROR_RESOURCE_BUSY;
+    }
+
+    *received = datagram->length < length ? datagram->length : length;
+    memcpy(data, datagram->data, *received);
+    net_buf_free(datagram);
+    return HAL_OK;
+}
+
+hal_result_t net_socket_close(net_socket_t socket)
+{
+    net_socket_entry_t *entry = net_socket_find(socket);
+    if (entry == NULL) {
+        return HAL_ERROR_RESOURCE_NOT_FOUND;
+    }
+
+    entry->open = false;
+    if (entry->protocol == NET_TCP) {
+        net_tcp_close(entry);
+    } else {
+        net_socket_release(entry);
+    }
+    return HAL_OK;
+}
+
+net_tcp_state_t net_socket_get_state(net_socket_t socket)
+{
+    net_socket_entry_t *entry = net_socket_find(socket);
+    if (entry == NULL || entry->protocol != NET_TCP) {
+        return NET_TCP_CLOSED;
+    }
+    return entry->state;
+}
+
+uint16_t net_socket_mss(net_socket_t socket)
+{
+    net_socket_entry_t *entry = net_socket_find(socket);
+    if (entry == NULL) {
+        return 0;
+    }
+    return entry->protocol == NET_TCP ? entry->mss : NET_UDP_PAYLOAD_MAX;
+}
+
+/* Functions shared with the TCP layer */
+
+net_socket_entry_t *net_socket_find(net_socket_t handle)
+{
+    for (uint32_t i = 0; i < NET_SOCKETS && handle != NET_SOCKET_NONE; i++) {
+        if (net_sockets[i].handle == handle) {
+            return net_sockets[i].open ? &net_sockets[i] : NULL;
+        }
+    }
+    return NULL;
+}
+
+net_socket_entry_t *net_socket_create(net_protocol_t protocol)
+{
+    for (uint32_t i = 0; i < NET_SOCKETS; i++) {
+        net_socket_entry_t *entry = &net_sockets[i];
+        if (entry->handle != NET_SOCKET_NONE) {
+            continue;
+        }
+
+        memset(entry, 0, sizeof(*entry));
+        entry->handle = net_next_handle++;
+        if (net_next_handle == NET_SOCKET_NONE) {
+            net_next_handle = 1;
+        }
+        entry->protocol = protocol;
+        entry->error = HAL_OK;
+        return entry;
+    }
+
+    return NULL;
+}
+
+net_socket_entry_t *net_socket_at(uint32_t index)
+{
+    if (index >= NET_SOCKETS || net_sockets[index].handle == NET_SOCKET_NONE) {
+        return NULL;
+    }
+    return &net_sockets[index];
+}
+
+void net_socket_release(net_socket_entry_t *entry)
+{
+    net_queue_free(&entry->rx);
+    net_queue_free(&entry->ooo);
+    net_queue_free(&entry->tx);
+    memset(entry, 0, sizeof(*entry));
+}
+
+uint16_t net_ephemeral_port(net_protocol_t protocol)
+{
+    for (uint32_t attempt = 0; attempt < 0x10000 - NET_PORT_EPHEMERAL_FIRST; attempt++) {
+        uint16_t port = net_next_port++;
+        if (net_next_port == 0) {
+            net_next_port = NET_PORT_EPHEMERAL_FIRST;
+        }
+
+        bool used = false;
+        for (uint32_t i = 0; i < NET_SOCKETS && !used; i++) {
+            used = net_sockets[i].handle != NET_SOCKET_NONE && net_sockets[i].protocol == protocol &&
+                   net_sockets[i].local_port == port;
+        }
+        if (!used) {
+            return port;
+        }
+    }
+
+    return 0;
+}
+
+net_buf_t *net_buf_wrap(wifi_emu_buffer_t *frame, uint8_t *data, uint16_t length)
+{
+    net_buf_t *buffer = net_buf_get();
+    if (buffer == NULL) {
+        return NULL;
+    }
+
+    buffer->frame = frame;
+    buffer->data = data;
+    buffer->length = length;
+    return buffer;
+}
+
+net_buf_t *net_buf_reserve(uint32_t headroom)
+{
+    net_buf_t *buffer = net_buf_get();
+    if (buffer == NULL) {
+        return NULL;
+    }
+
+    buffer->frame = wifi_emu_alloc();
+    if (buffer->frame == NULL) {
+        net_stats.buffers_exhausted++;
+        net_buf_put(buffer);
+        return NULL;
+    }
+
+    buffer->data = &buffer->frame->data[headroom];
+    return buffer;
+}
+
+void net_queue_push(net_queue_t *queue, net_buf_t *buffer)
+{
+    buffer->next = NULL;
+    if (queue->tail) {
+        queue->tail->next = buffer;
+    } else {
+        queue->head = buffer;
+    }
+    queue->tail = buffer;
+    queue->count++;
+}
+
+net_buf_t *net_queue_pop(net_queue_t *queue)
+{
+    net_buf_t *buffer = queue->head;
+    if (buffer == NULL) {
+        return NULL;
+    }
+
+    queue->head = buffer->next;
+    if (queue->head == NULL) {
+        queue->tail = NULL;
+    }
+    queue->count--;
+    buffer->next = NULL;
+    return buffer;
+}
+
+void net_queue_free(net_queue_t *queue)
+{
+    net_buf_free(queue->head);
+    queue->head = NULL;
+    queue->tail = NULL;
+    queue->count = 0;
+}
+
+uint32_t net_checksum(uint32_t sum, const uint8_t *data, uint32_t length)
+{
+    while (length > 1) {
+        sum += ((uint32_t)data[0] << 8) | data[1];
+        data += 2;
+        length -= 2;
+    }
+    if (length) {
+        sum += (uint32_t)data[0] << 8;
+    }
+    return sum;
+}
+
+uint16_t net_checksum_fold(uint32_t sum)
+{
+    while (sum >> 16) {
+        sum = (sum & 0xFFFF) + (sum >> 16);
+    }
+    return (uint16_t)~sum;
+}
+
+uint32_t net_pseudo_checksum(uint32_t source, uint32_t destination, uint8_t protocol, uint32_t length)
+{
+    return (source >> 16) + (source & 0xFFFF) + (destination >> 16) + (destination & 0xFFFF) +
+           protocol + length;
+}
+
+uint32_t net_local_address(void)
+{
+    return net_config.address;
+}
+
+const uint32_t *net_iss_key(void)
+{
+    return net_config.iss_key;
+}
+
+hal_result_t net_ip_output(wifi_emu_buffer_t *frame, uint32_t destination, uint8_t protocol, uint32_t length)
+{
+    uint8_t *ip = frame->data;
+    uint32_t total = NET_IP_HEADER + length;
+
+    ip[0] = NET_IP_VERSION_IHL;
+    ip[1] = 0;
+    net_put16(&ip[2], (uint16_t)total);
+    net_put16(&ip[4], net_ip_id++);
+    net_put16(&ip[6], NET_IP_DONT_FRAGMENT);
+    ip[8] = NET_IP_TTL;
+    ip[9] = protocol;
+    net_put16(&ip[10], 0);
+    net_put32(&ip[12], net_config.address);
+    net_put32(&ip[16], destination);
+    net_put16(&ip[10], net_checksum_fold(net_checksum(0, ip, NET_IP_HEADER)));
+    frame->length = (uint16_t)total;
+
+    hal_result_t result = wifi_emu_send(net_config.connection, frame);
+    if (result == HAL_OK) {
+        net_stats.ip_sent++;
+    }
+    return result;
+}
+
+/* Static helper functions */
+
+static void net_ip_input(wifi_emu_buffer_t *frame)
+{
+    uint8_t *ip = frame->data;
+    uint32_t header = (uint32_t)(ip[0] & 0x0F) * 4;
+    uint32_t total = frame->length >= NET_IP_HEADER ? net_get16(&ip[2]) : 0;
+
+    if (frame->length < NET_IP_HEADER || (ip[0] >> 4) != 4 || header < NET_IP_HEADER || total < header ||
+        total > frame->length || net_checksum_fold(net_checksum(0, ip, header)) != 0 ||
+        (net_get16(&ip[6]) & NET_IP_FRAGMENT_MASK) != 0) {
+        net_stats.ip_dropped++;
+        wifi_emu_free(frame);
+        return;
+    }
+
+    uint32_t source = net_get32(&ip[12]);
+    uint32_t destination = net_get32(&ip[16]);
+    if (destination != net_config.address && destination != NET_IP_BROADCAST) {
+        net_stats.ip_dropped++;
+        wifi_emu_free(frame);
+        return;
+    }
+
+    net_stats.ip_received++;
+    uint8_t *payload = &ip[header];
+    uint32_t length = total - header;
+
+    switch (ip[9]) {
+        case NET_PROTOCOL_ICMP:
+            if (header == NET_IP_HEADER) {
+                net_icmp_input(frame, source, payload, length);
+                return;
+            }
+            break;
+        case NET_PROTOCOL_UDP:
+            net_udp_input(frame, source, destination, payload, length);
+            return;
+        case NET_PROTOCOL_TCP:
+            if (destination != NET_IP_BROADCAST) {
+                net_tcp_input(frame, source, payload, length);
+                return;
+            }
+            break;
+        default:
+            break;
+    }
+
+    net_stats.ip_dropped++;
+    wifi_emu_free(frame);
+}
+
+static void net_icmp_input(wifi_emu_buffer_t *frame, uint32_t source, uint8_t *message, uint32_t length)
+{
+    if (length < NET_ICMP_HEADER || message[0] != NET_ICMP_ECHO_REQUEST ||
+        net_checksum_fold(net_checksum(0, message, length)) != 0) {
+        wifi_emu_free(frame);
+        return;
+    }
+
+    /* Answer in the request's own frame */
+    message[0] = NET_ICMP_ECHO_REPLY;
+    net_put16(&message[2], 0);
+    net_put16(&message[2], net_checksum_fold(net_checksum(0, message, length)));
+
+    if (net_ip_output(frame, source, NET_PROTOCOL_ICMP, length) != HAL_OK) {
+        wifi_emu_free(frame);
+        return;
+    }
+    net_stats.icmp_echoes++;
+}
+
+static void net_udp_input(wifi_emu_buffer_t *frame, uint32_t source, uint32_t destination, uint8_t *datagram,
+                          uint32_t length)
+{
+    uint32_t udp_length = length >= NET_UDP_HEADER ? net_get16(&datagram[4]) : 0;
+    if (udp_length < NET_UDP_HEADER || udp_length > length) {
+        net_stats.udp_dropped++;
+        wifi_emu_free(frame);
+        return;
+    }
+
+    if (net_get16(&datagram[6]) != 0) {
+        uint32_t sum = net_pseudo_checksum(source, destination, NET_PROTOCOL_UDP, udp_length);
+        if (net_checksum_fold(net_checksum(sum, datagram, udp_length)) != 0) {
+            net_stats.udp_dropped++;
+            wifi_emu_free(frame);
+            return;
+        }
+    }
+
+    uint16_t port = net_get16(&datagram[2]);
+    net_socket_entry_t *entry = NULL;
+    for (uint32_t i = 0; i < NET_SOCKETS && entry == NULL; i++) {
+        if (net_sockets[i].handle != NET_SOCKET_NONE && net_sockets[i].protocol == NET_UDP &&
+            net_sockets[i].local_port == port) {
+            entry = &net_sockets[i];
+        }
+    }
+
+    net_buf_t *buffer = NULL;
+    if (entry && entry->rx.count < NET_SOCKET_QUEUE) {
+        buffer = net_buf_wrap(frame, &datagram[NET_UDP_HEADER], (uint16_t)(udp_length - NET_UDP_HEADER));
+    }
+    if (buffer == NULL) {
+        net_stats.udp_dropped++;
+        wifi_emu_free(frame);
+        return;
+    }
+
+    buffer->address = source;
+    buffer->port = net_get16(&datagram[0]);
+    net_queue_push(&entry->rx, buffer);
+    net_stats.udp_received++;
+}
+
+static hal_result_t net_udp_output(net_socket_entry_t *entry, net_buf_t *buffer)
+{
+    uint32_t destination = buffer->address ? buffer->address : entry->remote_address;
+    uint16_t port = buffer->address ? buffer->port : entry->remote_port;
+
+    if (destination == 0 || port == 0 || buffer->length > NET_UDP_PAYLOAD_MAX ||
+        buffer->data != &buffer->frame->data[net_headroom(NET_UDP)]) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+    if (buffer->frame->references > 1) {
+        return HAL_ERROR_RESOURCE_BUSY;
+    }
+    if (entry->local_port == 0) {
+        entry->local_port = net_ephemeral_port(NET_UDP);
+        if (entry->local_port == 0) {
+            return HAL_ERROR_NO_MEMORY;
+        }
+    }
+
+    uint8_t *udp = buffer->data - NET_UDP_HEADER;
+    uint32_t length = NET_UDP_HEADER + buffer->length;
+    net_put16(&udp[0], entry->local_port);
+    net_put16(&udp[2], port);
+    net_put16(&udp[4], (uint16_t)length);
+    net_put16(&udp[6], 0);
+
+    uint32_t sum = net_pseudo_checksum(net_config.address, destination, NET_PROTOCOL_UDP, length);
+    uint16_t checksum = net_checksum_fold(net_checksum(sum, udp, length));
+    net_put16(&udp[6], checksum ? checksum : 0xFFFF);
+
+    hal_result_t result = net_ip_output(buffer->frame, destination, NET_PROTOCOL_UDP, length);
+    if (result == HAL_OK) {
+        net_stats.udp_sent++;
+    }
+    return result;
+}
+
+static uint32_t net_headroom(net_protocol_t protocol)
+{
+    return NET_IP_HEADER + (protocol == NET_TCP ? NET_TCP_HEADER : NET_UDP_HEADER);
+}
+
+static net_buf_t *net_buf_get(void)
+{
+    net_buf_t *buffer = net_buf_free_list;
+    if (buffer == NULL) {
+        net_stats.buffers_exhausted++;
+        return NULL;
+    }
+
+    net_buf_free_list = buffer->next;
+    memset(buffer, 0, sizeof(*buffer));
+    return buffer;
+}
+
+static void net_buf_put(net_buf_t *buffer)
+{
+    buffer->next = net_buf_free_list;
+    net_buf_free_list = buffer;
+}
@@ -0,0 +1,303 @@
+/**
+ * @file net_stack.h
+ * @brief IPv4, UDP and TCP over the WiFi emulation link
+ *
+ * The stack treats one WiFi emulation connection as a point-to-point
+ * link: every packet goes to the phone bridge, which routes it on.
+ * Within the stack packets stay in WiFi emulation frame buffers. A
+ * received frame stays where the WiFi emulation service reassembled it
+ * and sockets queue net_buf_t views of its payload; an outgoing buffer
+ * is allocated with room for the IP and transport headers in front of
+ * the payload, so the stack writes headers in place and hands the same
+ * frame to the link. TCP keeps a reference to each sent frame until it
+ * is acknowledged and retransmits from it.
+ *
+ * Below the stack, received bytes are copied twice: L2CAP reassembles
+ * each fragment into the service's SDU buffer, and the service copies
+ * the fragment into a pool frame. Sending, the link gathers fragments
+ * straight from the frame.
+ *
+ * Sockets never block. Calls that would wait return
+ * HAL_ERROR_RESOURCE_BUSY; call net_poll() regularly to run timers and
+ * push out queued data.
+ *
+ * Deliberately small: no IP fragmentation or options, no TCP window
+ * scaling or SACK. Segments that arrive ahead of a gap wait in the
+ * socket's receive slots until it is filled.
+ */
+
+#ifndef NET_STACK_H
+#define NET_STACK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "wifi_emu.h"
+
+/* Packet sizes */
+#define NET_MTU                     WIFI_EMU_BUFFER_SIZE            /**< Largest IP packet */
+#define NET_UDP_PAYLOAD_MAX         (NET_MTU - 20 - 8)              /**< Largest UDP payload */
+#define NET_TCP_MSS                 (NET_MTU - 20 - 20)             /**< Largest TCP segment payload we accept */
+
+/** Build an IPv4 address in host order */
+#define NET_ADDRESS(a, b, c, d)     (((uint32_t)(a) << 24) | ((uint32_t)(b) << 16) | \
+                                     ((uint32_t)(c) << 8) | (uint32_t)(d))
+
+/** Socket handle; NET_SOCKET_NONE is never issued */
+typedef uint32_t net_socket_t;
+#define NET_SOCKET_NONE 0
+
+/**
+ * @brief Transport protocol
+ */
+typedef enum {
+    NET_UDP = 0,                    /**< Datagrams */
+    NET_TCP                         /**< Byte stream */
+} net_protocol_t;
+
+/**
+ * @brief TCP connection state (RFC 793 names)
+ */
+typedef enum {
+    NET_TCP_CLOSED = 0,
+    NET_TCP_LISTEN,
+    NET_TCP_SYN_SENT,
+    NET_TCP_SYN_RECEIVED,
+    NET_TCP_ESTABLISHED,
+    NET_TCP_FIN_WAIT_1,
+    NET_TCP_FIN_WAIT_2,
+    NET_TCP_CLOSE_WAIT,
+    NET_TCP_CLOSING,
+    NET_TCP_LAST_ACK,
+    NET_TCP_TIME_WAIT
+} net_tcp_state_t;
+
+/**
+ * @brief Payload view into a frame buffer; chains through next
+ */
+typedef struct net_buf {
+    struct net_buf *next;           /**< Next buffer in the chain */
+    wifi_emu_buffer_t *frame;       /**< Frame holding the bytes */
+    uint8_t *data;                  /**< First payload byte */
+    uint16_t length;                /**< Payload bytes */
+    uint16_t port;                  /**< Datagram peer port (UDP) */
+    uint32_t address;               /**< Datagram peer address (UDP), 0 for the connected peer */
+    uint32_t seq;                   /**< Sequence number of the first byte (TCP, received ahead of a gap) */
+} net_buf_t;
+
+/**
+ * @brief Stack configuration
+ */
+typedef struct {
+    uint8_t connection;             /**< WiFi emulation connection carrying the link */
+    uint32_t address;               /**< Local IPv4 address, host order */
+    uint32_t iss_key[4];            /**< Secret for TCP initial sequence numbers (RFC 6528), random at every boot */
+} net_config_t;
+
+/**
+ * @brief Stack counters
+ */
+typedef struct {
+    uint32_t ip_received;           /**< Packets accepted */
+    uint32_t ip_sent;               /**< Packets handed to the link */
+    uint32_t ip_dropped;            /**< Malformed, fragmented or not addressed to us */
+    uint32_t icmp_echoes;           /**< Echo requests answered */
+    uint32_t udp_received;          /**< Datagrams queued to sockets */
+    uint32_t udp_sent;              /**< Datagrams sent */
+    uint32_t udp_dropped;           /**< No socket, bad checksum or full queue */
+    uint32_t tcp_received;          /**< Segments received */
+    uint32_t tcp_sent;              /**< Segments sent, retransmissions included */
+    uint32_t tcp_retransmits;       /**< Segments sent again after a timeout */
+    uint32_t tcp_fast_retransmits;  /**< Segments sent again after three duplicate ACKs */
+    uint32_t tcp_out_of_order;      /**< Segments received ahead of a gap */
+    uint32_t tcp_window_probes;     /**< Probes of a window too small for the next segment */
+    uint32_t tcp_dropped;           /**< Bad checksum, no connection or full queue */
+    uint32_t tcp_resets;            /**< Connections reset or timed out */
+    uint32_t buffers_exhausted;     /**< Allocations that found no frame or descriptor */
+} net_stats_t;
+
+/**
+ * @brief Start the stack on a WiFi emulation connection
+ *
+ * Incoming frames reach the stack through net_input(); pass it as the
+ * WiFi emulation receive callback, or forward frames to it.
+ *
+ * @param config Stack configuration, copied
+ * @return HAL_OK on success, error code otherwise
+ */
+hal_result_t net_init(const net_config_t *config);
+
+/**
+ * @brief Stop the stack; all sockets are dropped without notice
+ * @return HAL_OK on success, error code otherwise
+ */
+hal_result_t net_deinit(void);
+
+/**
+ * @brief Take an incoming frame; matches wifi_emu_receive_callback_t
+ *
+ * The stack owns the frame from here on. Frames for other connections
+ * are freed.
+ *
+ * @param connection Connection the frame arrived on
+ * @param frame Frame holding one IP packet
+ * @param user_data Unused
+ */
+void net_input(uint8_t connection, wifi_emu_buffer_t *frame, void *user_data);
+
+/**
+ * @brief Run timers and send queued data
+ * @param now_ms Current time in milliseconds
+ */
+void net_poll(uint32_t now_ms);
+
+/**
+ * @brief Get stack counters
+ * @param stats Pointer to store the counters
+ * @return HAL_OK on success, error code otherwise
+ */
+hal_result_t net_get_stats(net_stats_t *stats);
+
+/**
+ * @brief Create a socket
+ * @param protocol NET_UDP or NET_TCP
+ * @param socket Pointer to store the socket handle
+ * @return HAL_OK on success, HAL_ERROR_NO_MEMORY if all sockets are in use
+ */
+hal_result_t net_socket_open(net_protocol_t protocol, net_socket_t *socket);
+
+/**
+ * @brief Bind a socket to a local port
+ * @param socket Socket handle
+ * @param port Local port, 0 for an ephemeral one
+ * @return HAL_OK on success, HAL_ERROR_RESOURCE_BUSY if the port is taken
+ */
+hal_result_t net_socket_bind(net_socket_t socket, uint16_t port);
+
+/**
+ * @brief Accept TCP connections on a bound socket
+ * @param socket TCP socket handle
+ * @return HAL_OK on success, error code otherwise
+ */
+hal_result_t net_socket_listen(net_socket_t socket);
+
+/**
+ * @brief Take an established connection from a listening socket
+ * @param socket Listening socket handle
+ * @param client Pointer to store the new socket handle
+ * @return HAL_OK on success, HAL_ERROR_RESOURCE_BUSY if none is ready
+ */
+hal_result_t net_socket_accept(net_socket_t socket, net_socket_t *client);
+
+/**
+ * @brief Set the peer
+ *
+ * TCP starts the handshake; net_socket_get_state() reports
+ * NET_TCP_ESTABLISHED once it completes. UDP only records the default
+ * destination.
+ *
+ * @param socket Socket handle
+ * @param address Peer address, host order
+ * @param port Peer port
+ * @return HAL_OK on success, error code otherwise
+ */
+hal_result_t net_socket_connect(net_socket_t socket, uint32_t address, uint16_t port);
+
+/**
+ * @brief Take a buffer to fill and pass to net_socket_send_buf()
+ *
+ * The payload starts at data with header room reserved in front. Fill
+ * at most NET_UDP_PAYLOAD_MAX bytes for UDP, net_socket_mss() for TCP.
+ *
+ * @param socket Socket the buffer will be sent on
+ * @return Empty buffer, NULL if the pool is exhausted
+ */
+net_buf_t *net_buf_alloc(net_socket_t socket);
+
+/**
+ * @brief Free a buffer chain from net_buf_alloc() or net_socket_recv_buf()
+ * @param chain First buffer, may be NULL
+ */
+void net_buf_free(net_buf_t *chain);
+
+/**
+ * @brief Send buffers without copying them
+ *
+ * UDP sends one buffer as a datagram, to its address and port or to the
+ * connected peer. TCP queues the chain on the stream, one segment per
+ * buffer. On success the stack owns the chain; on error the caller keeps
+ * it.
+ *
+ * @param socket Socket handle
+ * @param chain Filled buffers from net_buf_alloc()
+ * @return HAL_OK on success, HAL_ERROR_RESOURCE_BUSY if the send queue is full
+ */
+hal_result_t net_socket_send_buf(net_socket_t socket, net_buf_t *chain);
+
+/**
+ * @brief Copy bytes out
+ *
+ * UDP sends one datagram to the connected peer. TCP appends to the
+ * stream as far as the send queue allows.
+ *
+ * @param socket Socket handle
+ * @param data Bytes to send
+ * @param length Number of bytes
+ * @param sent Pointer to store the bytes taken (may be NULL)
+ * @return HAL_OK on success, HAL_ERROR_RESOURCE_BUSY if nothing could be taken
+ */
+hal_result_t net_socket_send(net_socket_t socket, const void *data, uint32_t length, uint32_t *sent);
+
+/**
+ * @brief Take received buffers without copying them out of their frames
+ *
+ * UDP returns one datagram with its source in address and port. TCP
+ * returns everything received so far, in stream order.
+ *
+ * @param socket Socket handle
+ * @param chain Pointer to store the chain, owned by the caller until net_buf_free(); NULL once a TCP peer has closed
+ * @return HAL_OK on success, HAL_ERROR_RESOURCE_BUSY if nothing is waiting,
+ *         HAL_ERROR or HAL_ERROR_TIMEOUT once a TCP connection was reset or timed out
+ */
+hal_result_t net_socket_recv_buf(net_socket_t socket, net_buf_t **chain);
+
+/**
+ * @brief Copy received bytes in
+ *
+ * UDP reads one datagram, truncated to length. TCP reads up to length
+ * stream bytes; zero bytes with HAL_OK means the peer has closed.
+ *
+ * @param socket Socket handle
+ * @param data Destination
+ * @param length Destination size
+ * @param received Pointer to store the bytes copied
+ * @return HAL_OK on success, HAL_ERROR_RESOURCE_BUSY if nothing is waiting,
+ *         HAL_ERROR or HAL_ERROR_TIMEOUT once a TCP connection was reset or timed out
+ */
+hal_result_t net_socket_recv(net_socket_t socket, void *data, uint32_t length, uint32_t *received);
+
+/**
+ * @brief Close a socket
+ *
+ * TCP sends what is queued, then closes the stream; the handle is
+ * invalid on return and the connection finishes in the background.
+ *
+ * @param socket Socket handle
+ * @return HAL_OK on success, error code otherwise
+ */
+hal_result_t net_socket_close(net_socket_t socket);
+
+/**
+ * @brief Get TCP connection state
+ * @param socket Socket handle
+ * @return Connection state, NET_TCP_CLOSED for UDP or a bad handle
+ */
+net_tcp_state_t net_socket_get_state(net_socket_t socket);
+
+/**
+ * @brief Largest payload per buffer for net_socket_send_buf()
+ * @param socket Socket handle
+ * @return Payload bytes, 0 for a bad handle
+ */
+uint16_t net_socket_mss(net_socket_t socket);
+
+#endif /* NET_STACK_H */
@@ -0,0 +1,1180 @@
+/**
+ * @file net_tcp.c
+ * @brief TCP over the WiFi emulation link
+ *
+ * Segments are the application's buffers: each queued net_buf_t goes out
+ * as one segment with its headers written into the frame's head room,
+ * and stays queued, holding a frame reference, until it is acknowledged.
+ * A frame still held by the link is not rewritten; its retransmission
+ * waits for the next timer instead.
+ *
+ * Loss recovery is NewReno: slow start, congestion avoidance, fast
+ * retransmit on the third duplicate ACK with partial ACKs filling the
+ * remaining holes, and go-back-N from the oldest unacknowledged segment
+ * on a timeout with RFC 6298 timers. A window too small for the next
+ * segment is probed on a timer of its own; probes are not losses.
+ *
+ * Received segments ahead of a gap keep their frames in the socket's
+ * receive slots until the gap fills, so one loss costs one retransmission
+ * rather than the whole window behind it.
+ */
+
+#include "net_internal.h"
+#include <string.h>
+
+/* Header flags */
+#define NET_TCP_FIN                 0x01
+#define NET_TCP_SYN                 0x02
+#define NET_TCP_RST                 0x04
+#define NET_TCP_PSH                 0x08
+#define NET_TCP_ACK                 0x10
+
+/* Options */
+#define NET_TCP_OPTION_END          0
+#define NET_TCP_OPTION_NOP          1
+#define NET_TCP_OPTION_MSS          2
+#define NET_TCP_MSS_OPTION_SIZE     4
+
+/* Tuning */
+#define NET_TCP_DEFAULT_MSS         536         /* Until the peer says otherwise (RFC 9293) */
+#define NET_TCP_MIN_MSS             64
+#define NET_TCP_RTO_INITIAL         1000
+#define NET_TCP_RTO_MIN             200
+#define NET_TCP_RTO_MAX             8000
+#define NET_TCP_RETRIES             8           /* Timeouts in a row before giving up */
+#define NET_TCP_PERSIST_BACKOFF     6           /* Window probe interval doubles up to rto << 6 */
+#define NET_TCP_TIME_WAIT_MS        2000
+#define NET_TCP_FIN_WAIT_MS         30000       /* Peer's FIN, once ours is acknowledged */
+#define NET_TCP_COALESCE            256         /* Copy segments up to this size into the previous buffer */
+#define NET_TCP_WINDOW_MAX          0xFFFF
+
+/* Static function prototypes */
+static void tcp_listen_input(net_socket_entry_t *listener, uint32_t source, uint16_t port, uint32_t seq,
+                             uint32_t ack, uint8_t flags, uint16_t window, uint16_t mss);
+static void tcp_syn_sent_input(net_socket_entry_t *entry, uint32_t seq, uint32_t ack, uint8_t flags,
+                               uint16_t window, uint16_t mss);
+static bool tcp_process(net_socket_entry_t *entry, wifi_emu_buffer_t *frame, uint32_t seq, uint32_t ack,
+                        uint8_t flags, uint16_t window, uint8_t *payload, uint32_t length);
+static bool tcp_ack(net_socket_entry_t *entry, uint32_t ack, uint16_t window, uint32_t length, uint8_t flags);
+static bool tcp_queue(net_socket_entry_t *entry, wifi_emu_buffer_t *frame, uint8_t *payload, uint32_t length,
+                      bool *kept);
+static bool tcp_queue_ahead(net_socket_entry_t *entry, wifi_emu_buffer_t *frame, uint32_t seq, uint8_t *payload,
+                            uint32_t length);
+static void tcp_merge_ahead(net_socket_entry_t *entry);
+static void tcp_output(net_socket_entry_t *entry, bool force);
+static void tcp_timeout(net_socket_entry_t *entry);
+static void tcp_probe(net_socket_entry_t *entry);
+static hal_result_t tcp_emit(net_socket_entry_t *entry, wifi_emu_buffer_t *frame, uint32_t seq, uint8_t flags,
+                             uint32_t length);
+static bool tcp_control(net_socket_entry_t *entry, uint32_t seq, uint8_t flags);
+static bool tcp_segment(net_socket_entry_t *entry, net_buf_t *buffer, uint32_t seq);
+static void tcp_reset_reply(uint32_t source, uint16_t source_port, uint16_t port, uint32_t seq, uint32_t ack,
+                            uint8_t flags, uint32_t length);
+static void tcp_established(net_socket_entry_t *entry);
+static void tcp_closed(net_socket_entry_t *entry);
+static void tcp_drop(net_socket_entry_t *entry, hal_result_t error);
+static void tcp_rtt(net_socket_entry_t *entry, uint32_t sample);
+static void tcp_set_timer(net_socket_entry_t *entry, uint32_t ms);
+static void tcp_window_update(net_socket_entry_t *entry);
+static uint32_t tcp_window(const net_socket_entry_t *entry);
+static uint32_t tcp_flight(const net_socket_entry_t *entry);
+static uint32_t tcp_iss(const net_socket_entry_t *entry);
+static uint64_t tcp_siphash(const uint32_t key[4], const uint8_t *data, uint32_t length);
+static void tcp_sipround(uint64_t v[4]);
+static uint16_t tcp_parse_mss(const uint8_t *options, uint32_t length);
+static bool tcp_can_send(const net_socket_entry_t *entry);
+
+void net_tcp_input(wifi_emu_buffer_t *frame, uint32_t source, uint8_t *segment, uint32_t length)
+{
+    net_stats.tcp_received++;
+
+    uint32_t header = length >= NET_TCP_HEADER ? (uint32_t)(segment[12] >> 4) * 4 : 0;
+    uint32_t sum = net_pseudo_checksum(source, net_local_address(), NET_PROTOCOL_TCP, length);
+    if (header < NET_TCP_HEADER || header > length || net_checksum_fold(net_checksum(sum, segment, length)) != 0) {
+        net_stats.tcp_dropped++;
+        wifi_emu_free(frame);
+        return;
+    }
+
+    uint16_t source_port = net_get16(&segment[0]);
+    uint16_t port = net_get16(&segment[2]);
+    uint32_t seq = net_get32(&segment[4]);
+    uint32_t ack = net_get32(&segment[8]);
+    uint8_t flags = segment[13];
+    uint16_t window = net_get16(&segment[14]);
+    uint8_t *payload = &segment[header];
+    uint32_t payload_length = length - header;
+    uint16_t mss = (flags & NET_TCP_SYN) ? tcp_parse_mss(&segment[NET_TCP_HEADER], header - NET_TCP_HEADER)
+                                         : NET_TCP_DEFAULT_MSS;
+
+    net_socket_entry_t *entry = NULL;
+    net_socket_entry_t *listener = NULL;
+    for (uint32_t i = 0; i < NET_SOCKETS; i++) {
+        net_socket_entry_t *candidate = net_socket_at(i);
+        if (candidate == NULL || candidate->protocol != NET_TCP || candidate->local_port != port) {
+            continue;
+        }
+        if (candidate->state == NET_TCP_LISTEN) {
+            listener = candidate;
+        } else if (candidate->state != NET_TCP_CLOSED && candidate->remote_port == source_port &&
+                   candidate->remote_address == source) {
+            entry = candidate;
+            break;
+        }
+    }
+
+    bool kept = false;
+    if (entry) {
+        if (entry->state == NET_TCP_SYN_SENT) {
+            tcp_syn_sent_input(entry, seq, ack, flags, window, mss);
+        } else {
+            kept = tcp_process(entry, frame, seq, ack, flags, window, payload, payload_length);
+        }
+    } else if (listener) {
+        tcp_listen_input(listener, source, source_port, seq, ack, flags, window, mss);
+    } else {
+        net_stats.tcp_dropped++;
+        if (!(flags & NET_TCP_RST)) {
+            uint32_t segment_length = payload_length + ((flags & NET_TCP_SYN) ? 1 : 0) +
+                                      ((flags & NET_TCP_FIN) ? 1 : 0);
+            tcp_reset_reply(source, source_port, port, seq, ack, flags, segment_length);
+        }
+    }
+
+    if (!kept) {
+        wifi_emu_free(frame);
+    }
+}
+
+void net_tcp_poll(net_socket_entry_t *entry)
+{
+    if (entry->timer_armed && NET_SEQ_GEQ(net_now, entry->timer_ms)) {
+        entry->timer_armed = false;
+        tcp_timeout(entry);
+        if (entry->handle == NET_SOCKET_NONE) {
+            return;
+        }
+    }
+
+    tcp_output(entry, false);
+
+    /* Delayed ACKs go out once per poll */
+    if (entry->ack_pending) {
+        tcp_control(entry, entry->snd_nxt, NET_TCP_ACK);
+    }
+}
+
+hal_result_t net_tcp_connect(net_socket_entry_t *entry)
+{
+    entry->iss = tcp_iss(entry);
+    entry->snd_una = entry->iss;
+    entry->snd_nxt = entry->iss + 1;
+    entry->snd_max = entry->snd_nxt;
+    entry->tx_seq = entry->snd_nxt;
+    entry->mss = NET_TCP_DEFAULT_MSS;
+    entry->rto = NET_TCP_RTO_INITIAL;
+    entry->state = NET_TCP_SYN_SENT;
+
+    /* A SYN that finds no buffer goes out on the first timeout */
+    tcp_control(entry, entry->iss, NET_TCP_SYN);
+    tcp_set_timer(entry, entry->rto);
+    return HAL_OK;
+}
+
+hal_result_t net_tcp_send_buf(net_socket_entry_t *entry, net_buf_t *chain)
+{
+    if (entry->state == NET_TCP_SYN_SENT || entry->state == NET_TCP_SYN_RECEIVED) {
+        return HAL_ERROR_RESOURCE_BUSY;
+    }
+    if (!tcp_can_send(entry)) {
+        return entry->error != HAL_OK ? entry->error : HAL_ERROR;
+    }
+
+    uint32_t count = 0;
+    for (net_buf_t *buffer = chain; buffer; buffer = buffer->next) {
+        if (buffer->length == 0 || buffer->length > entry->mss ||
+            buffer->data != &buffer->frame->data[NET_IP_HEADER + NET_TCP_HEADER] ||
+            buffer->frame->references > 1) {
+            return HAL_ERROR_INVALID_PARAM;
+        }
+        count++;
+    }
+    if (entry->tx.count + count > NET_SOCKET_QUEUE) {
+        return HAL_ERROR_RESOURCE_BUSY;
+    }
+
+    while (chain) {
+        net_buf_t *next = chain->next;
+        net_queue_push(&entry->tx, chain);
+        if (entry->tx_next == NULL) {
+            entry->tx_next = chain;
+        }
+        chain = next;
+    }
+
+    tcp_output(entry, false);
+    return HAL_OK;
+}
+
+hal_result_t net_tcp_send(net_socket_entry_t *entry, const uint8_t *data, uint32_t length, uint32_t *sent)
+{
+    *sent = 0;
+    if (entry->state == NET_TCP_SYN_SENT || entry->state == NET_TCP_SYN_RECEIVED) {
+        return HAL_ERROR_RESOURCE_BUSY;
+    }
+    if (!tcp_can_send(entry)) {
+        return entry->error != HAL_OK ? entry->error : HAL_ERROR;
+    }
+
+    uint32_t taken = 0;
+
+    /* Top up the last segment if it has not left yet */
+    net_buf_t *tail = entry->tx.tail;
+    if (tail && entry->tx_next && tail->length < entry->mss) {
+        uint32_t chunk = entry->mss - tail->length;
+        chunk = chunk < length ? chunk : length;
+        memcpy(&tail->data[tail->length], data, chunk);
+        tail->length = (uint16_t)(tail->length + chunk);
+        taken = chunk;
+    }
+
+    while (taken < length && entry->tx.count < NET_SOCKET_QUEUE) {
+        net_buf_t *buffer = net_buf_reserve(NET_IP_HEADER + NET_TCP_HEADER);
+        if (buffer == NULL) {
+            break;
+        }
+
+        uint32_t chunk = length - taken;
+        chunk = chunk < entry->mss ? chunk : entry->mss;
+        memcpy(buffer->data, &data[taken], chunk);
+        buffer->length = (uint16_t)chunk;
+        net_queue_push(&entry->tx, buffer);
+        if (entry->tx_next == NULL) {
+            entry->tx_next = buffer;
+        }
+        taken += chunk;
+    }
+
+    *sent = taken;
+    if (taken == 0 && length > 0) {
+        return HAL_ERROR_RESOURCE_BUSY;
+    }
+
+    tcp_output(entry, false);
+    return HAL_OK;
+}
+
+hal_result_t net_tcp_recv_buf(net_socket_entry_t *entry, net_buf_t **chain)
+{
+    *chain = entry->rx.head;
+    if (*chain) {
+        entry->rx.head = NULL;
+        entry->rx.tail = NULL;
+        entry->rx.count = 0;
+        tcp_window_update(entry);
+        return HAL_OK;
+    }
+
+    if (entry->error != HAL_OK) {
+        return entry->error;
+    }
+    return entry->fin_received ? HAL_OK : HAL_ERROR_RESOURCE_BUSY;
+}
+
+hal_result_t net_tcp_recv(net_socket_entry_t *entry, uint8_t *data, uint32_t length, uint32_t *received)
+{
+    *received = 0;
+    if (entry->rx.head == NULL) {
+        if (entry->error != HAL_OK) {
+            return entry->error;
+        }
+        return entry->fin_received ? HAL_OK : HAL_ERROR_RESOURCE_BUSY;
+    }
+
+    while (entry->rx.head && *received < length) {
+        net_buf_t *buffer = entry->rx.head;
+        uint32_t chunk = length - *received;
+        chunk = chunk < buffer->length ? chunk : buffer->length;
+
+        memcpy(&data[*received], buffer->data, chunk);
+        *received += chunk;
+        buffer->data += chunk;
+        buffer->length = (uint16_t)(buffer->length - chunk);
+        if (buffer->length == 0) {
+            net_buf_free(net_queue_pop(&entry->rx));
+        }
+    }
+
+    tcp_window_update(entry);
+    return HAL_OK;
+}
+
+void net_tcp_close(net_socket_entry_t *entry)
+{
+    net_queue_free(&entry->rx);
+    net_queue_free(&entry->ooo);
+
+    switch (entry->state) {
+        case NET_TCP_LISTEN:
+            /* Connections nobody accepted are reset */
+            for (uint32_t i = 0; i < NET_SOCKETS; i++) {
+                net_socket_entry_t *child = net_socket_at(i);
+                if (child && child->parent == entry->handle) {
+                    tcp_control(child, child->snd_nxt, NET_TCP_RST | NET_TCP_ACK);
+                    net_socket_release(child);
+                }
+            }
+            net_socket_release(entry);
+            break;
+        case NET_TCP_CLOSED:
+        case NET_TCP_SYN_SENT:
+            net_socket_release(entry);
+            break;
+        case NET_TCP_SYN_RECEIVED:
+        case NET_TCP_ESTABLISHED:
+            entry->fin_pending = true;
+            entry->state = NET_TCP_FIN_WAIT_1;
+            tcp_output(entry, false);
+            break;
+        case NET_TCP_CLOSE_WAIT:
+            entry->fin_pending = true;
+            entry->state = NET_TCP_LAST_ACK;
+            tcp_output(entry, false);
+            break;
+        default:
+            /* Already closing; finishes in the background */
+            break;
+    }
+}
+
+/* Static helper functions */
+
+static void tcp_listen_input(net_socket_entry_t *listener, uint32_t source, uint16_t port, uint32_t seq,
+                             uint32_t ack, uint8_t flags, uint16_t window, uint16_t mss)
+{
+    if (flags & NET_TCP_RST) {
+        return;
+    }
+    if (flags & NET_TCP_ACK) {
+        tcp_reset_reply(source, port, listener->local_port, seq, ack, NET_TCP_ACK, 0);
+        return;
+    }
+    if (!(flags & NET_TCP_SYN)) {
+        return;
+    }
+
+    uint32_t backlog = 0;
+    for (uint32_t i = 0; i < NET_SOCKETS; i++) {
+        net_socket_entry_t *child = net_socket_at(i);
+        if (child && child->parent == listener->handle) {
+            backlog++;
+        }
+    }
+
+    net_socket_entry_t *child = backlog < NET_SOCKET_QUEUE ? net_socket_create(NET_TCP) : NULL;
+    if (child == NULL) {
+        net_stats.tcp_dropped++;
+        return;
+    }
+
+    child->parent = listener->handle;
+    child->local_port = listener->local_port;
+    child->remote_address = source;
+    child->remote_port = port;
+    child->rcv_nxt = seq + 1;
+    child->mss = mss;
+    child->snd_wnd = window;
+    child->iss = tcp_iss(child);
+    child->snd_una = child->iss;
+    child->snd_nxt = child->iss + 1;
+    child->snd_max = child->snd_nxt;
+    child->tx_seq = child->snd_nxt;
+    child->rto = NET_TCP_RTO_INITIAL;
+    child->state = NET_TCP_SYN_RECEIVED;
+
+    tcp_control(child, child->iss, NET_TCP_SYN | NET_TCP_ACK);
+    tcp_set_timer(child, child->rto);
+}
+
+static void tcp_syn_sent_input(net_socket_entry_t *entry, uint32_t seq, uint32_t ack, uint8_t flags,
+                               uint16_t window, uint16_t mss)
+{
+    bool acceptable = (flags & NET_TCP_ACK) && ack == entry->snd_nxt;
+
+    if ((flags & NET_TCP_ACK) && !acceptable) {
+        if (!(flags & NET_TCP_RST)) {
+            tcp_reset_reply(entry->remote_address, entry->remote_port, entry->local_port, seq, ack, flags, 0);
+        }
+        return;
+    }
+    if (flags & NET_TCP_RST) {
+        if (acceptable) {
+            tcp_drop(entry, HAL_ERROR);
+        }
+        return;
+    }
+
+    /* Simultaneous open is not supported */
+    if (!(flags & NET_TCP_SYN) || !acceptable) {
+        return;
+    }
+
+    entry->rcv_nxt = seq + 1;
+    entry->mss = mss;
+    entry->snd_una = ack;
+    entry->snd_wnd = window;
+    entry->retries = 0;
+    entry->timer_armed = false;
+    tcp_established(entry);
+
+    tcp_control(entry, entry->snd_nxt, NET_TCP_ACK);
+    tcp_output(entry, false);
+}
+
+static bool tcp_process(net_socket_entry_t *entry, wifi_emu_buffer_t *frame, uint32_t seq, uint32_t ack,
+                        uint8_t flags, uint16_t window, uint8_t *payload, uint32_t length)
+{
+    if (flags & NET_TCP_RST) {
+        /* Exact match only (RFC 5961) */
+        if (seq == entry->rcv_nxt) {
+            tcp_drop(entry, HAL_ERROR);
+        }
+        return false;
+    }
+
+    if (flags & NET_TCP_SYN) {
+        if (entry->state == NET_TCP_SYN_RECEIVED && seq + 1 == entry->rcv_nxt) {
+            /* Our SYN-ACK was lost */
+            tcp_control(entry, entry->iss, NET_TCP_SYN | NET_TCP_ACK);
+        } else {
+            tcp_control(entry, entry->snd_nxt, NET_TCP_ACK);
+        }
+        return false;
+    }
+
+    if (!(flags & NET_TCP_ACK) || !tcp_ack(entry, ack, window, length, flags)) {
+        return false;
+    }
+
+    uint32_t segment_length = length + ((flags & NET_TCP_FIN) ? 1 : 0);
+    if (segment_length == 0) {
+        /* A window probe sits just below rcv_nxt and wants the window back */
+        if (NET_SEQ_LT(seq, entry->rcv_nxt)) {
+            tcp_control(entry, entry->snd_nxt, NET_TCP_ACK);
+        }
+        return false;
+    }
+
+    /* Only these states take new data; the rest just get an ACK */
+    if (entry->state != NET_TCP_ESTABLISHED && entry->state != NET_TCP_FIN_WAIT_1 &&
+        entry->state != NET_TCP_FIN_WAIT_2) {
+        tcp_control(entry, entry->snd_nxt, NET_TCP_ACK);
+        return false;
+    }
+
+    if (NET_SEQ_LEQ(seq + segment_length, entry->rcv_nxt)) {
+        tcp_control(entry, entry->snd_nxt, NET_TCP_ACK);
+        return false;
+    }
+
+    /* Nobody will read new data once the application has closed (RFC 9293 3.10.7.4) */
+    if (length > 0 && !entry->open && entry->parent == NET_SOCKET_NONE) {
+        tcp_control(entry, entry->snd_nxt, NET_TCP_RST | NET_TCP_ACK);
+        tcp_drop(entry, HAL_ERROR);
+        return false;
+    }
+
+    /* Ahead of a gap: keep the data, the duplicate ACK asks for the hole */
+    if (NET_SEQ_GT(seq, entry->rcv_nxt)) {
+        net_stats.tcp_out_of_order++;
+        bool kept = length > 0 && tcp_queue_ahead(entry, frame, seq, payload, length);
+        tcp_control(entry, entry->snd_nxt, NET_TCP_ACK);
+        return kept;
+    }
+
+    /* Trim what a retransmission repeats */
+    uint32_t trim = entry->rcv_nxt - seq;
+    if (trim > length) {
+        trim = length;
+    }
+    payload += trim;
+    length -= trim;
+
+    bool kept = false;
+    if (length > 0) {
+        if (!tcp_queue(entry, frame, payload, length, &kept)) {
+            net_stats.tcp_dropped++;
+            tcp_control(entry, entry->snd_nxt, NET_TCP_ACK);
+            return false;
+        }
+        entry->rcv_nxt += length;
+    }
+
+    /* Filling a gap is acknowledged at once (RFC 5681) */
+    bool ack_now = false;
+    if (entry->ooo.head) {
+        tcp_merge_ahead(entry);
+        ack_now = true;
+    }
+
+    if (flags & NET_TCP_FIN) {
+        entry->rcv_nxt++;
+        entry->fin_received = true;
+        ack_now = true;
+        net_queue_free(&entry->ooo);
+
+        if (entry->state == NET_TCP_ESTABLISHED) {
+            entry->state = NET_TCP_CLOSE_WAIT;
+        } else if (entry->state == NET_TCP_FIN_WAIT_1) {
+            entry->state = NET_TCP_CLOSING;
+        } else {
+            entry->state = NET_TCP_TIME_WAIT;
+            tcp_set_timer(entry, NET_TCP_TIME_WAIT_MS);
+        }
+    }
+
+    /* ACK every second segment, the rest wait for the next poll */
+    entry->ack_segments++;
+    if (ack_now || entry->ack_segments >= 2) {
+        tcp_control(entry, entry->snd_nxt, NET_TCP_ACK);
+    } else {
+        entry->ack_pending = true;
+    }
+    return kept;
+}
+
+static bool tcp_ack(net_socket_entry_t *entry, uint32_t ack, uint16_t window, uint32_t length, uint8_t flags)
+{
+    if (entry->state == NET_TCP_SYN_RECEIVED) {
+        if (ack != entry->snd_nxt) {
+            tcp_reset_reply(entry->remote_address, entry->remote_port, entry->local_port, 0, ack,
+                            NET_TCP_ACK, 0);
+            return false;
+        }
+        entry->snd_una = ack;
+        entry->snd_wnd = window;
+        entry->retries = 0;
+        entry->timer_armed = false;
+        tcp_established(entry);
+        return true;
+    }
+
+    if (NET_SEQ_GT(ack, entry->snd_max)) {
+        tcp_control(entry, entry->snd_nxt, NET_TCP_ACK);
+        return false;
+    }
+
+    if (NET_SEQ_GT(ack, entry->snd_una)) {
+        uint32_t acked = ack - entry->snd_una;
+
+        if (entry->rtt_timing && NET_SEQ_GEQ(ack, entry->rtt_seq)) {
+            tcp_rtt(entry, net_now - entry->rtt_start);
+            entry->rtt_timing = false;
+        }
+
+        while (entry->tx.head) {
+            uint32_t end = entry->tx_seq + entry->tx.head->length;
+            if (NET_SEQ_GT(end, ack)) {
+                break;
+            }
+            net_buf_t *buffer = net_queue_pop(&entry->tx);
+            if (entry->tx_next == buffer) {
+                entry->tx_next = entry->tx.head;
+            }
+            net_buf_free(buffer);
+            entry->tx_seq = end;
+        }
+        entry->snd_una = ack;
+        entry->persist = false;
+
+        /* After a go-back, the first transmission may be acknowledged beyond snd_nxt */
+        if (NET_SEQ_LT(entry->snd_nxt, ack)) {
+            entry->snd_nxt = entry->tx_seq;
+            entry->tx_next = entry->tx.head;
+            if (entry->fin_sent && entry->tx.head == NULL) {
+                entry->snd_nxt = ack;
+            }
+        }
+
+        if (entry->dupacks >= 3 && NET_SEQ_LT(ack, entry->recover)) {
+            /* Partial ACK (RFC 6582): the next hole goes now, cwnd gives back what left the network */
+            entry->cwnd = entry->cwnd > acked ? entry->cwnd - acked : 0;
+            if (acked >= entry->mss) {
+                entry->cwnd += entry->mss;
+            }
+            if (entry->cwnd < entry->mss) {
+                entry->cwnd = entry->mss;
+            }
+            if (entry->tx.head && tcp_segment(entry, entry->tx.head, entry->tx_seq)) {
+                net_stats.tcp_fast_retransmits++;
+            }
+        } else if (entry->dupacks >= 3) {
+            entry->cwnd = entry->ssthresh;
+            entry->dupacks = 0;
+        } else if (entry->cwnd < entry->ssthresh) {
+            entry->cwnd += entry->mss;
+        } else {
+            uint32_t increase = (uint32_t)entry->mss * entry->mss / entry->cwnd;
+            entry->cwnd += increase ? increase : 1;
+        }
+        if (entry->dupacks < 3) {
+            entry->dupacks = 0;
+        }
+        entry->retries = 0;
+
+        if (tcp_flight(entry) > 0 || entry->tx_next) {
+            tcp_set_timer(entry, entry->rto);
+        } else if (entry->state != NET_TCP_TIME_WAIT && entry->state != NET_TCP_FIN_WAIT_2) {
+            entry->timer_armed = false;
+        }
+
+        bool fin_acked = entry->fin_pending && entry->tx.head == NULL && ack == entry->tx_seq + 1;
+        if (fin_acked) {
+            if (entry->state == NET_TCP_FIN_WAIT_1) {
+                entry->state = NET_TCP_FIN_WAIT_2;
+                tcp_set_timer(entry, NET_TCP_FIN_WAIT_MS);
+            } else if (entry->state == NET_TCP_CLOSING) {
+                entry->state = NET_TCP_TIME_WAIT;
+                tcp_set_timer(entry, NET_TCP_TIME_WAIT_MS);
+            } else if (entry->state == NET_TCP_LAST_ACK) {
+                tcp_closed(entry);
+                return false;
+            }
+        }
+    } else if (ack == entry->snd_una && length == 0 && !(flags & NET_TCP_FIN) && tcp_flight(entry) > 0 &&
+               !entry->persist) {
+        /* Windows move in whole buffers as the peer drains, so a changed window still counts */
+        entry->dupacks++;
+        if (entry->dupacks == 3 && entry->tx.head) {
+            uint32_t flight = tcp_flight(entry);
+            entry->ssthresh = flight / 2 > 2u * entry->mss ? flight / 2 : 2u * entry->mss;
+            entry->cwnd = entry->ssthresh + 3u * entry->mss;
+            entry->recover = entry->snd_max;
+            entry->rtt_timing = false;
+            if (tcp_segment(entry, entry->tx.head, entry->tx_seq)) {
+                net_stats.tcp_fast_retransmits++;
+            }
+        } else if (entry->dupacks > 3) {
+            entry->cwnd += entry->mss;
+        }
+    }
+
+    entry->snd_wnd = window;
+    tcp_output(entry, false);
+    return true;
+}
+
+static bool tcp_queue(net_socket_entry_t *entry, wifi_emu_buffer_t *frame, uint8_t *payload, uint32_t length,
+                      bool *kept)
+{
+    /* Small segments share the previous frame rather than pinning one each */
+    net_buf_t *tail = entry->rx.tail;
+    if (tail && length <= NET_TCP_COALESCE) {
+        uint8_t *end = tail->data + tail->length;
+        uint32_t room = (uint32_t)(&tail->frame->data[WIFI_EMU_BUFFER_SIZE] - end);
+        if (room >= length) {
+            memcpy(end, payload, length);
+            tail->length = (uint16_t)(tail->length + length);
+            return true;
+        }
+    }
+
+    /* Data at rcv_nxt takes the slot of the data furthest ahead */
+    if (entry->rx.count + entry->ooo.count >= NET_SOCKET_QUEUE && entry->ooo.head) {
+        net_buf_t **last = &entry->ooo.head;
+        while ((*last)->next) {
+            last = &(*last)->next;
+        }
+        net_buf_free(*last);
+        *last = NULL;
+        entry->ooo.count--;
+        entry->ooo.tail = NULL;
+        for (net_buf_t *buffer = entry->ooo.head; buffer; buffer = buffer->next) {
+            entry->ooo.tail = buffer;
+        }
+    }
+
+    if (entry->rx.count + entry->ooo.count >= NET_SOCKET_QUEUE) {
+        return false;
+    }
+
+    net_buf_t *buffer = net_buf_wrap(frame, payload, (uint16_t)length);
+    if (buffer == NULL) {
+        return false;
+    }
+
+    net_queue_push(&entry->rx, buffer);
+    *kept = true;
+    return true;
+}
+
+/**
+ * @brief Keep a segment that arrived ahead of a gap, in sequence order
+ * @return true if the frame is kept
+ */
+static bool tcp_queue_ahead(net_socket_entry_t *entry, wifi_emu_buffer_t *frame, uint32_t seq, uint8_t *payload,
+                            uint32_t length)
+{
+    /* One slot stays free for the segment that fills the gap */
+    if (entry->rx.count + entry->ooo.count + 1 >= NET_SOCKET_QUEUE ||
+        NET_SEQ_GT(seq + length, entry->rcv_nxt + tcp_window(entry))) {
+        return false;
+    }
+
+    net_buf_t **link = &entry->ooo.head;
+    while (*link && NET_SEQ_LT((*link)->seq, seq)) {
+        link = &(*link)->next;
+    }
+    if (*link && (*link)->seq == seq) {
+        return false;
+    }
+
+    net_buf_t *buffer = net_buf_wrap(frame, payload, (uint16_t)length);
+    if (buffer == NULL) {
+        return false;
+    }
+
+    buffer->seq = seq;
+    buffer->next = *link;
+    *link = buffer;
+    if (buffer->next == NULL) {
+        entry->ooo.tail = buffer;
+    }
+    entry->ooo.count++;
+    return true;
+}
+
+/**
+ * @brief Move segments the gap was holding back onto the receive queue
+ */
+static void tcp_merge_ahead(net_socket_entry_t *entry)
+{
+    while (entry->ooo.head && NET_SEQ_LEQ(entry->ooo.head->seq, entry->rcv_nxt)) {
+        net_buf_t *buffer = net_queue_pop(&entry->ooo);
+        uint32_t end = buffer->seq + buffer->length;
+        if (NET_SEQ_LEQ(end, entry->rcv_nxt)) {
+            net_buf_free(buffer);
+            continue;
+        }
+
+        uint32_t trim = entry->rcv_nxt - buffer->seq;
+        buffer->data += trim;
+        buffer->length = (uint16_t)(buffer->length - trim);
+        net_queue_push(&entry->rx, buffer);
+        entry->rcv_nxt = end;
+    }
+}
+
+static void tcp_output(net_socket_entry_t *entry, bool force)
+{
+    if (!tcp_can_send(entry) && entry->state != NET_TCP_FIN_WAIT_1 && entry->state != NET_TCP_CLOSING &&
+        entry->state != NET_TCP_LAST_ACK) {
+        return;
+    }
+
+    while (entry->tx_next) {
+        net_buf_t *buffer = entry->tx_next;
+        uint32_t flight = tcp_flight(entry);
+        uint32_t limit = entry->cwnd < entry->snd_wnd ? entry->cwnd : entry->snd_wnd;
+
+        if (!force) {
+            if (flight + buffer->length > limit) {
+                /* Nothing in flight, so the peer's window is what holds the segment back: probe it */
+                if (flight == 0 && !entry->persist) {
+                    entry->persist = true;
+                    entry->persist_backoff = 0;
+                    tcp_set_timer(entry, entry->rto);
+                } else if (!entry->timer_armed) {
+                    tcp_set_timer(entry, entry->rto);
+                }
+                break;
+            }
+            /* Nagle: hold a short tail while data is in flight */
+            if (buffer->next == NULL && buffer->length < entry->mss && flight > 0 && !entry->fin_pending) {
+                break;
+            }
+        }
+
+        if (!tcp_segment(entry, buffer, entry->snd_nxt)) {
+            if (!entry->timer_armed) {
+                tcp_set_timer(entry, entry->rto);
+            }
+            break;
+        }
+
+        /* The window opened: back to the retransmission timer */
+        if (entry->persist && !force) {
+            entry->persist = false;
+            tcp_set_timer(entry, entry->rto);
+        }
+        if (!entry->rtt_timing && !entry->persist && NET_SEQ_GEQ(entry->snd_nxt, entry->snd_max)) {
+            entry->rtt_timing = true;
+            entry->rtt_seq = entry->snd_nxt + buffer->length;
+            entry->rtt_start = net_now;
+        }
+        entry->snd_nxt += buffer->length;
+        if (NET_SEQ_GT(entry->snd_nxt, entry->snd_max)) {
+            entry->snd_max = entry->snd_nxt;
+        }
+        entry->tx_next = buffer->next;
+        if (!entry->timer_armed) {
+            tcp_set_timer(entry, entry->rto);
+        }
+        force = false;
+    }
+
+    if (entry->tx_next == NULL && entry->fin_pending && !entry->fin_sent &&
+        tcp_control(entry, entry->snd_nxt, NET_TCP_FIN | NET_TCP_ACK)) {
+        entry->fin_sent = true;
+        entry->snd_nxt++;
+        if (NET_SEQ_GT(entry->snd_nxt, entry->snd_max)) {
+            entry->snd_max = entry->snd_nxt;
+        }
+        if (!entry->timer_armed) {
+            tcp_set_timer(entry, entry->rto);
+        }
+    }
+}
+
+static void tcp_timeout(net_socket_entry_t *entry)
+{
+    if (entry->state == NET_TCP_TIME_WAIT || entry->state == NET_TCP_FIN_WAIT_2) {
+        tcp_closed(entry);
+        return;
+    }
+
+    if (entry->state == NET_TCP_SYN_SENT || entry->state == NET_TCP_SYN_RECEIVED) {
+        if (++entry->retries > NET_TCP_RETRIES) {
+            tcp_drop(entry, HAL_ERROR_TIMEOUT);
+            return;
+        }
+        uint8_t flags = entry->state == NET_TCP_SYN_SENT ? NET_TCP_SYN : (NET_TCP_SYN | NET_TCP_ACK);
+        tcp_control(entry, entry->iss, flags);
+        entry->rto = entry->rto * 2 < NET_TCP_RTO_MAX ? entry->rto * 2 : NET_TCP_RTO_MAX;
+        tcp_set_timer(entry, entry->rto);
+        return;
+    }
+
+    if (entry->persist) {
+        tcp_probe(entry);
+        return;
+    }
+
+    uint32_t flight = tcp_flight(entry);
+    bool fin_outstanding = entry->fin_sent && NET_SEQ_LT(entry->snd_una, entry->snd_max);
+    if (flight == 0 && !fin_outstanding) {
+        /* Nothing was lost: the link still held the segment's frame */
+        tcp_output(entry, false);
+        return;
+    }
+
+    if (++entry->retries > NET_TCP_RETRIES) {
+        tcp_control(entry, entry->snd_nxt, NET_TCP_RST | NET_TCP_ACK);
+        tcp_drop(entry, HAL_ERROR_TIMEOUT);
+        return;
+    }
+
+    net_stats.tcp_retransmits++;
+    entry->ssthresh = flight / 2 > 2u * entry->mss ? flight / 2 : 2u * entry->mss;
+    entry->cwnd = entry->mss;
+    entry->dupacks = 0;
+    entry->rtt_timing = false;
+    entry->rto = entry->rto * 2 < NET_TCP_RTO_MAX ? entry->rto * 2 : NET_TCP_RTO_MAX;
+
+    /* Go back to the oldest unacknowledged segment */
+    entry->snd_nxt = entry->tx_seq;
+    entry->tx_next = entry->tx.head;
+    entry->fin_sent = false;
+
+    tcp_output(entry, true);
+    if (!entry->timer_armed) {
+        tcp_set_timer(entry, entry->rto);
+    }
+}
+
+/**
+ * @brief Probe a window too small for the next segment (RFC 9293 3.8.6.1)
+ *
+ * A zero window gets a bare ACK below snd_una, which the peer answers
+ * with its window; a small one gets the next segment anyway. Probes back
+ * off on their own and never count as retries or collapse the RTO and
+ * cwnd: a reader that stalls is not a lossy path.
+ */
+static void tcp_probe(net_socket_entry_t *entry)
+{
+    /* A segment pushed past the window last time counts as never sent */
+    entry->snd_nxt = entry->tx_seq;
+    entry->tx_next = entry->tx.head;
+
+    net_stats.tcp_window_probes++;
+    if (entry->snd_wnd == 0 || entry->tx_next == NULL) {
+        tcp_control(entry, entry->snd_una - 1, NET_TCP_ACK);
+    } else {
+        tcp_output(entry, true);
+    }
+
+    uint32_t interval = entry->rto << entry->persist_backoff;
+    tcp_set_timer(entry, interval < NET_TCP_RTO_MAX ? interval : NET_TCP_RTO_MAX);
+    if (entry->persist_backoff < NET_TCP_PERSIST_BACKOFF) {
+        entry->persist_backoff++;
+    }
+}
+
+static hal_result_t tcp_emit(net_socket_entry_t *entry, wifi_emu_buffer_t *frame, uint32_t seq, uint8_t flags,
+                             uint32_t length)
+{
+    uint8_t *tcp = &frame->data[NET_IP_HEADER];
+    uint32_t header = NET_TCP_HEADER + ((flags & NET_TCP_SYN) ? NET_TCP_MSS_OPTION_SIZE : 0);
+    uint32_t window = tcp_window(entry);
+
+    net_put16(&tcp[0], entry->local_port);
+    net_put16(&tcp[2], entry->remote_port);
+    net_put32(&tcp[4], seq);
+    net_put32(&tcp[8], (flags & NET_TCP_ACK) ? entry->rcv_nxt : 0);
+    tcp[12] = (uint8_t)((header / 4) << 4);
+    tcp[13] = flags;
+    net_put16(&tcp[14], (uint16_t)window);
+    net_put16(&tcp[16], 0);
+    net_put16(&tcp[18], 0);
+    if (flags & NET_TCP_SYN) {
+        tcp[20] = NET_TCP_OPTION_MSS;
+        tcp[21] = NET_TCP_MSS_OPTION_SIZE;
+        net_put16(&tcp[22], NET_TCP_MSS);
+    }
+
+    uint32_t total = header + length;
+    uint32_t sum = net_pseudo_checksum(net_local_address(), entry->remote_address, NET_PROTOCOL_TCP, total);
+    net_put16(&tcp[16], net_checksum_fold(net_checksum(sum, tcp, total)));
+
+    hal_result_t result = net_ip_output(frame, entry->remote_address, NET_PROTOCOL_TCP, total);
+    if (result != HAL_OK) {
+        return result;
+    }
+
+    net_stats.tcp_sent++;
+    if (flags & NET_TCP_ACK) {
+        entry->ack_pending = false;
+        entry->ack_segments = 0;
+        entry->window_closed = (window == 0);
+    }
+    return HAL_OK;
+}
+
+static bool tcp_control(net_socket_entry_t *entry, uint32_t seq, uint8_t flags)
+{
+    wifi_emu_buffer_t *frame = wifi_emu_alloc();
+    if (frame == NULL) {
+        net_stats.buffers_exhausted++;
+        return false;
+    }
+
+    if (tcp_emit(entry, frame, seq, flags, 0) != HAL_OK) {
+        wifi_emu_free(frame);
+        return false;
+    }
+    return true;
+}
+
+static bool tcp_segment(net_socket_entry_t *entry, net_buf_t *buffer, uint32_t seq)
+{
+    /* Still queued on the link from the last transmission */
+    if (buffer->frame->references > 1) {
+        return false;
+    }
+
+    uint8_t flags = NET_TCP_ACK | (buffer->next == NULL ? NET_TCP_PSH : 0);
+    wifi_emu_ref(buffer->frame);
+    if (tcp_emit(entry, buffer->frame, seq, flags, buffer->length) != HAL_OK) {
+        wifi_emu_free(buffer->frame);
+        return false;
+    }
+    return true;
+}
+
+static void tcp_reset_reply(uint32_t source, uint16_t source_port, uint16_t port, uint32_t seq, uint32_t ack,
+                            uint8_t flags, uint32_t length)
+{
+    net_socket_entry_t reply;
+    memset(&reply, 0, sizeof(reply));
+    reply.local_port = port;
+    reply.remote_port = source_port;
+    reply.remote_address = source;
+
+    if (flags & NET_TCP_ACK) {
+        tcp_control(&reply, ack, NET_TCP_RST);
+    } else {
+        reply.rcv_nxt = seq + length;
+        tcp_control(&reply, 0, NET_TCP_RST | NET_TCP_ACK);
+    }
+}
+
+static void tcp_established(net_socket_entry_t *entry)
+{
+    /* Initial window per RFC 3390 */
+    uint32_t window = 4380 > 2u * entry->mss ? 4380 : 2u * entry->mss;
+    entry->cwnd = window < 4u * entry->mss ? window : 4u * entry->mss;
+    entry->ssthresh = NET_TCP_WINDOW_MAX;
+    entry->state = NET_TCP_ESTABLISHED;
+}
+
+static void tcp_closed(net_socket_entry_t *entry)
+{
+    net_queue_free(&entry->tx);
+    net_queue_free(&entry->ooo);
+    entry->tx_next = NULL;
+    entry->timer_armed = false;
+    entry->persist = false;
+    entry->state = NET_TCP_CLOSED;
+    if (!entry->open) {
+        net_socket_release(entry);
+    }
+}
+
+static void tcp_drop(net_socket_entry_t *entry, hal_result_t error)
+{
+    net_stats.tcp_resets++;
+    entry->error = error;
+    tcp_closed(entry);
+}
+
+static void tcp_rtt(net_socket_entry_t *entry, uint32_t sample)
+{
+    /* RFC 6298, srtt scaled by 8 and rttvar by 4 */
+    if (entry->srtt == 0) {
+        entry->srtt = sample << 3;
+        entry->rttvar = sample << 1;
+    } else {
+        int32_t delta = (int32_t)sample - (int32_t)(entry->srtt >> 3);
+        entry->srtt = (uint32_t)((int32_t)entry->srtt + delta);
+        if (delta < 0) {
+            delta = -delta;
+        }
+        entry->rttvar = (uint32_t)((int32_t)entry->rttvar + delta - (int32_t)(entry->rttvar >> 2));
+    }
+
+    uint32_t rto = (entry->srtt >> 3) + entry->rttvar;
+    entry->rto = rto < NET_TCP_RTO_MIN ? NET_TCP_RTO_MIN : (rto > NET_TCP_RTO_MAX ? NET_TCP_RTO_MAX : rto);
+}
+
+static void tcp_set_timer(net_socket_entry_t *entry, uint32_t ms)
+{
+    entry->timer_armed = true;
+    entry->timer_ms = net_now + ms;
+}
+
+static void tcp_window_update(net_socket_entry_t *entry)
+{
+    if (entry->window_closed && tcp_window(entry) > 0) {
+        tcp_control(entry, entry->snd_nxt, NET_TCP_ACK);
+    }
+}
+
+static uint32_t tcp_window(const net_socket_entry_t *entry)
+{
+    uint32_t window = (uint32_t)(NET_SOCKET_QUEUE - entry->rx.count) * NET_TCP_MSS;
+    return window < NET_TCP_WINDOW_MAX ? window : NET_TCP_WINDOW_MAX;
+}
+
+static uint32_t tcp_flight(const net_socket_entry_t *entry)
+{
+    return NET_SEQ_GT(entry->snd_nxt, entry->snd_una) ? entry->snd_nxt - entry->snd_una : 0;
+}
+
+static uint32_t tcp_iss(const net_socket_entry_t *entry)
+{
+    /* RFC 6528: a 4 us clock plus a keyed hash of the connection's addresses and ports */
+    uint8_t tuple[12];
+    net_put32(&tuple[0], net_local_address());
+    net_put32(&tuple[4], entry->remote_address);
+    net_put16(&tuple[8], entry->local_port);
+    net_put16(&tuple[10], entry->remote_port);
+
+    return net_now * 250 + (uint32_t)tcp_siphash(net_iss_key(), tuple, sizeof(tuple));
+}
+
+/**
+ * @brief SipHash-2-4 of a short message
+ */
+static uint64_t tcp_siphash(const uint32_t key[4], const uint8_t *data, uint32_t length)
+{
+    uint64_t k0 = key[0] | ((uint64_t)key[1] << 32);
+    uint64_t k1 = key[2] | ((uint64_t)key[3] << 32);
+    uint64_t v[4] = {
+        k0 ^ 0x736F6D6570736575ULL, k1 ^ 0x646F72616E646F6DULL,
+        k0 ^ 0x6C7967656E657261ULL, k1 ^ 0x7465646279746573ULL
+    };
+    uint64_t last = (uint64_t)length << 56;
+    uint32_t i = 0;
+
+    for (; i + 8 <= length; i += 8) {
+        uint64_t word = 0;
+        for (uint32_t j = 0; j < 8; j++) {
+            word |= (uint64_t)data[i + j] << (8 * j);
+        }
+        v[3] ^= word;
+        tcp_sipround(v);
+        tcp_sipround(v);
+        v[0] ^= word;
+    }
+    for (uint32_t j = 0; i + j < length; j++) {
+        last |= (uint64_t)data[i + j] << (8 * j);
+    }
+
+    v[3] ^= last;
+    tcp_sipround(v);
+    tcp_sipround(v);
+    v[0] ^= last;
+    v[2] ^= 0xFF;
+    for (uint32_t round = 0; round < 4; round++) {
+        tcp_sipround(v);
+    }
+    return v[0] ^ v[1] ^ v[2] ^ v[3];
+}
+
+static void tcp_sipround(uint64_t v[4])
+{
+    v[0] += v[1];
+    v[1] = (v[1] << 13) | (v[1] >> 51);
+    v[1] ^= v[0];
+    v[0] = (v[0] << 32) | (v[0] >> 32);
+    v[2] += v[3];
+    v[3] = (v[3] << 16) | (v[3] >> 48);
+    v[3] ^= v[2];
+    v[0] += v[3];
+    v[3] = (v[3] << 21) | (v[3] >> 43);
+    v[3] ^= v[0];
+    v[2] += v[1];
+    v[1] = (v[1] << 17) | (v[1] >> 47);
+    v[1] ^= v[2];
+    v[2] = (v[2] << 32) | (v[2] >> 32);
+}
+
+static uint16_t tcp_parse_mss(const uint8_t *options, uint32_t length)
+{
+    uint32_t i = 0;
+    while (i < length) {
+        uint8_t kind = options[i];
+        if (kind == NET_TCP_OPTION_END) {
+            break;
+        }
+        if (kind == NET_TCP_OPTION_NOP) {
+            i++;
+            continue;
+        }
+        if (i + 1 >= length || options[i + 1] < 2 || i + options[i + 1] > length) {
+            break;
+        }
+        if (kind == NET_TCP_OPTION_MSS && options[i + 1] == NET_TCP_MSS_OPTION_SIZE) {
+            uint16_t mss = net_get16(&options[i + 2]);
+            mss = mss < NET_TCP_MSS ? mss : NET_TCP_MSS;
+            return mss > NET_TCP_MIN_MSS ? mss : NET_TCP_MIN_MSS;
+        }
+        i += options[i + 1];
+    }
+    return NET_TCP_DEFAULT_MSS;
+}
+
+static bool tcp_can_send(const net_socket_entry_t *entry)
+{
+    return (entry->state == NET_TCP_ESTABLISHED || entry->state == NET_TCP_CLOSE_WAIT) && !entry->fin_pending;
+}
@@ -0,0 +1,642 @@
+/**
+ * @file wifi_emu.c
+ * @brief WiFi emulation service over the BLE link
+ */
+
+#include "wifi_emu.h"
+#include <string.h>
+
+/* Fragment header */
+#define WIFI_EMU_FLAG_FIRST         0x80
+#define WIFI_EMU_FLAG_LAST          0x40
+#define WIFI_EMU_CONNECTION_MASK    0x0F
+
+/* Link sizing */
+#define WIFI_EMU_SDU_MAX            245         /* One K-frame at our MPS of 247, SDU length included */
+#define WIFI_EMU_RX_CREDITS         8           /* Fragments the bridge may send ahead */
+#define WIFI_EMU_RATE_WINDOW_US     1000000     /* Rate counter window */
+
+/**
+ * @brief Emulated station
+ */
+typedef struct {
+    wifi_emu_state_t state;
+    char ssid[WIFI_EMU_SSID_MAX + 1];
+    uint8_t channel;
+    wifi_emu_buffer_t *tx_head;         /* Transmit queue; the head may be partly fragmented */
+    wifi_emu_buffer_t *tx_tail;
+    uint8_t tx_depth;
+    uint8_t tx_sequence;                /* Sequence of the frame at tx_head */
+    uint32_t deficit;                   /* Round robin byte allowance */
+    wifi_emu_buffer_t *rx;              /* Frame being reassembled */
+    uint8_t rx_sequence;
+    uint32_t tx_window;                 /* Bytes in the current rate window */
+    uint32_t rx_window;
+    wifi_emu_stats_t stats;
+} wifi_emu_context_t;
+
+/**
+ * @brief Fragment handed to L2CAP, waiting for HAL_RADIO_L2CAP_SENT
+ */
+typedef struct {
+    uint8_t header[WIFI_EMU_HEADER_SIZE];
+    hal_radio_segment_t segments[2];    /* Header, then the payload inside the frame buffer */
+    wifi_emu_buffer_t *frame;
+    uint8_t connection;
+    bool complete;                      /* Last fragment: count the frame */
+    bool release;                       /* Frame buffer returns to the pool when sent */
+} wifi_emu_fragment_t;
+
+/* Global state */
+static bool wifi_emu_initialized = false;
+static wifi_emu_config_t wifi_emu_config;
+static wifi_emu_buffer_t wifi_emu_pool[WIFI_EMU_POOL_BUFFERS];
+static wifi_emu_buffer_t *wifi_emu_free_list = NULL;
+static uint32_t wifi_emu_free_count = 0;
+static wifi_emu_context_t wifi_emu_contexts[WIFI_EMU_MAX_CONNECTIONS];
+static wifi_emu_fragment_t wifi_emu_fragments[HAL_RADIO_L2CAP_QUEUE];
+static uint32_t wifi_emu_fragment_head = 0;
+static uint32_t wifi_emu_fragment_tail = 0;
+static uint8_t wifi_emu_rx_sdu[WIFI_EMU_SDU_MAX];
+static hal_radio_channel_t wifi_emu_channel = HAL_RADIO_CHANNEL_NONE;
+static bool wifi_emu_link_open = false;
+static uint32_t wifi_emu_fragment_size = 0;
+static uint8_t wifi_emu_turn = 0;
+static bool wifi_emu_turn_started = false;
+static bool wifi_emu_scheduling = false;
+static uint32_t wifi_emu_window_start = 0;
+
+/* Static function prototypes */
+static void wifi_emu_l2cap_event(hal_radio_channel_t channel, hal_radio_l2cap_event_t event,
+                                 const void *data, uint32_t length, void *user_data);
+static void wifi_emu_link_up(void);
+static void wifi_emu_link_down(void);
+static void wifi_emu_schedule(void);
+static wifi_emu_context_t *wifi_emu_next(void);
+static bool wifi_emu_send_fragment(wifi_emu_context_t *context);
+static void wifi_emu_fragment_sent(const void *segments);
+static void wifi_emu_fragment_received(const uint8_t *data, uint32_t length);
+static void wifi_emu_flush(wifi_emu_context_t *context);
+static void wifi_emu_push_front(wifi_emu_context_t *context, wifi_emu_buffer_t *frame);
+static wifi_emu_buffer_t *wifi_emu_pop(wifi_emu_context_t *context);
+static uint32_t wifi_emu_chunk(const wifi_emu_buffer_t *frame);
+static uint32_t wifi_emu_now_us(void);
+static void wifi_emu_latency(wifi_emu_stats_t *stats, uint32_t sample);
+
+hal_result_t wifi_emu_init(const wifi_emu_config_t *config)
+{
+    if (!config) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+    if (wifi_emu_initialized) {
+        return HAL_ERROR_RESOURCE_BUSY;
+    }
+
+    memset(wifi_emu_contexts, 0, sizeof(wifi_emu_contexts));
+    wifi_emu_config = *config;
+    wifi_emu_free_list = NULL;
+    for (uint32_t i = 0; i < WIFI_EMU_POOL_BUFFERS; i++) {
+        wifi_emu_pool[i].next = wifi_emu_free_list;
+        wifi_emu_pool[i].references = 0;
+        wifi_emu_free_list = &wifi_emu_pool[i];
+    }
+    wifi_emu_free_count = WIFI_EMU_POOL_BUFFERS;
+    wifi_emu_fragment_head = 0;
+    wifi_emu_fragment_tail = 0;
+    wifi_emu_link_open = false;
+    wifi_emu_turn = 0;
+    wifi_emu_turn_started = false;
+    wifi_emu_window_start = wifi_emu_now_us();
+
+    hal_radio_l2cap_config_t l2cap = {
+        .psm = config->psm,
+        .mtu = WIFI_EMU_SDU_MAX,
+        .rx_buffer = wifi_emu_rx_sdu,
+        .rx_credits = WIFI_EMU_RX_CREDITS,
+        .callback = wifi_emu_l2cap_event,
+        .user_data = NULL
+    };
+    hal_result_t result = hal_radio_l2cap_open(config->radio_id, &l2cap, true, &wifi_emu_channel);
+    if (result != HAL_OK) {
+        return result;
+    }
+
+    wifi_emu_initialized = true;
+    return HAL_OK;
+}
+
+hal_result_t wifi_emu_deinit(void)
+{
+    if (!wifi_emu_initialized) {
+        return HAL_ERROR_NOT_INITIALIZED;
+    }
+
+    /* Closing does not report HAL_RADIO_L2CAP_CLOSED; reclaim in-flight buffers first */
+    wifi_emu_link_down();
+    hal_radio_l2cap_close(wifi_emu_channel);
+    wifi_emu_channel = HAL_RADIO_CHANNEL_NONE;
+
+    for (uint32_t i = 0; i < WIFI_EMU_MAX_CONNECTIONS; i++) {
+        wifi_emu_flush(&wifi_emu_contexts[i]);
+        wifi_emu_contexts[i].state = WIFI_EMU_DISCONNECTED;
+    }
+
+    wifi_emu_initialized = false;
+    return HAL_OK;
+}
+
+hal_result_t wifi_emu_connect(const char *ssid, uint8_t channel, uint8_t *connection)
+{
+    if (!wifi_emu_initialized) {
+        return HAL_ERROR_NOT_INITIALIZED;
+    }
+    if (!ssid || !connection || strlen(ssid) > WIFI_EMU_SSID_MAX) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    for (uint8_t i = 0; i < WIFI_EMU_MAX_CONNECTIONS; i++) {
+        wifi_emu_context_t *context = &wifi_emu_contexts[i];
+        if (context->state != WIFI_EMU_DISCONNECTED) {
+            continue;
+        }
+
+        memset(context, 0, sizeof(*context));
+        strcpy(context->ssid, ssid);
+        context->channel = channel ? channel : WIFI_EMU_CHANNEL_DEFAULT;
+        context->state = WIFI_EMU_CONNECTED;
+        *connection = i;
+        return HAL_OK;
+    }
+
+    return HAL_ERROR_NO_MEMORY;
+}
+
+hal_result_t wifi_emu_disconnect(uint8_t connection)
+{
+    if (!wifi_emu_initialized) {
+        return HAL_ERROR_NOT_INITIALIZED;
+    }
+    if (connection >= WIFI_EMU_MAX_CONNECTIONS ||
+        wifi_emu_contexts[connection].state == WIFI_EMU_DISCONNECTED) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    wifi_emu_flush(&wifi_emu_contexts[connection]);
+    wifi_emu_contexts[connection].state = WIFI_EMU_DISCONNECTED;
+    return HAL_OK;
+}
+
+wifi_emu_state_t wifi_emu_get_state(uint8_t connection)
+{
+    if (connection >= WIFI_EMU_MAX_CONNECTIONS) {
+        return WIFI_EMU_DISCONNECTED;
+    }
+    return wifi_emu_contexts[connection].state;
+}
+
+wifi_emu_buffer_t *wifi_emu_alloc(void)
+{
+    wifi_emu_buffer_t *buffer = wifi_emu_free_list;
+    if (buffer == NULL) {
+        return NULL;
+    }
+
+    wifi_emu_free_list = buffer->next;
+    wifi_emu_free_count--;
+    buffer->next = NULL;
+    buffer->length = 0;
+    buffer->offset = 0;
+    buffer->references = 1;
+    return buffer;
+}
+
+void wifi_emu_ref(wifi_emu_buffer_t *buffer)
+{
+    if (buffer && buffer->references > 0) {
+        buffer->references++;
+    }
+}
+
+void wifi_emu_free(wifi_emu_buffer_t *buffer)
+{
+    /* A buffer already in the pool is ignored: a second link would corrupt the free list */
+    if (buffer == NULL || buffer->references == 0 || --buffer->references > 0) {
+        return;
+    }
+
+    buffer->next = wifi_emu_free_list;
+    wifi_emu_free_list = buffer;
+    wifi_emu_free_count++;
+}
+
+uint32_t wifi_emu_available(void)
+{
+    return wifi_emu_free_count;
+}
+
+hal_result_t wifi_emu_send(uint8_t connection, wifi_emu_buffer_t *frame)
+{
+    if (!wifi_emu_initialized) {
+        return HAL_ERROR_NOT_INITIALIZED;
+    }
+    if (connection >= WIFI_EMU_MAX_CONNECTIONS || !frame || frame->length > WIFI_EMU_BUFFER_SIZE) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    wifi_emu_context_t *context = &wifi_emu_contexts[connection];
+    if (context->state != WIFI_EMU_CONNECTED) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+    if (context->tx_depth >= WIFI_EMU_TX_QUEUE) {
+        context->stats.tx_rejected++;
+        return HAL_ERROR_RESOURCE_BUSY;
+    }
+
+    frame->next = NULL;
+    frame->offset = 0;
+    frame->queued_us = wifi_emu_now_us();
+    if (context->tx_tail) {
+        context->tx_tail->next = frame;
+    } else {
+        context->tx_head = frame;
+    }
+    context->tx_tail = frame;
+    context->tx_depth++;
+
+    wifi_emu_schedule();
+    return HAL_OK;
+}
+
+void wifi_emu_poll(void)
+{
+    if (!wifi_emu_initialized) {
+        return;
+    }
+
+    wifi_emu_schedule();
+
+    uint32_t now = wifi_emu_now_us();
+    uint32_t elapsed = now - wifi_emu_window_start;
+    if (elapsed < WIFI_EMU_RATE_WINDOW_US) {
+        return;
+    }
+
+    for (uint32_t i = 0; i < WIFI_EMU_MAX_CONNECTIONS; i++) {
+        wifi_emu_context_t *context = &wifi_emu_contexts[i];
+        context->stats.tx_rate = (uint32_t)(((uint64_t)context->tx_window * 1000000) / elapsed);
+        context->stats.rx_rate = (uint32_t)(((uint64_t)context->rx_window * 1000000) / elapsed);
+        context->tx_window = 0;
+        context->rx_window = 0;
+    }
+    wifi_emu_window_start = now;
+}
+
+hal_result_t wifi_emu_get_stats(uint8_t connection, wifi_emu_stats_t *stats)
+{
+    if (!wifi_emu_initialized) {
+        return HAL_ERROR_NOT_INITIALIZED;
+    }
+    if (connection >= WIFI_EMU_MAX_CONNECTIONS || !stats) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    *stats = wifi_emu_contexts[connection].stats;
+    return HAL_OK;
+}
+
+/* Static helper functions */
+
+static void wifi_emu_l2cap_event(hal_radio_channel_t channel, hal_radio_l2cap_event_t event,
+                                 const void *data, uint32_t length, void *user_data)
+{
+    (void)channel;
+    (void)user_data;
+
+    switch (event) {
+        case HAL_RADIO_L2CAP_OPENED:
+            wifi_emu_link_up();
+            break;
+        case HAL_RADIO_L2CAP_CLOSED:
+            wifi_emu_link_down();
+            break;
+        case HAL_RADIO_L2CAP_RECEIVED:
+            wifi_emu_fragment_received((const uint8_t *)data, length);
+            break;
+        case HAL_RADIO_L2CAP_SENT:
+            wifi_emu_fragment_sent(data);
+            wifi_emu_schedule();
+            break;
+        default:
+            break;
+    }
+}
+
+static void wifi_emu_link_up(void)
+{
+    hal_radio_l2cap_stats_t stats;
+    if (hal_radio_l2cap_get_stats(wifi_emu_channel, &stats) != HAL_OK) {
+        return;
+    }
+
+    /* Size fragments so each SDU, length field included, fits one K-frame */
+    uint32_t sdu = stats.peer_mtu;
+    if (sdu > (uint32_t)stats.peer_mps - 2) {
+        sdu = (uint32_t)stats.peer_mps - 2;
+    }
+    if (sdu <= WIFI_EMU_HEADER_SIZE) {
+        return;
+    }
+
+    wifi_emu_fragment_size = sdu - WIFI_EMU_HEADER_SIZE;
+    wifi_emu_link_open = true;
+    wifi_emu_schedule();
+}
+
+static void wifi_emu_link_down(void)
+{
+    wifi_emu_link_open = false;
+
+    /* L2CAP dropped everything queued; frames already popped are lost */
+    while (wifi_emu_fragment_tail != wifi_emu_fragment_head) {
+        wifi_emu_fragment_t *fragment = &wifi_emu_fragments[wifi_emu_fragment_tail % HAL_RADIO_L2CAP_QUEUE];
+        if (fragment->release) {
+            wifi_emu_free(fragment->frame);
+        }
+        wifi_emu_fragment_tail++;
+    }
+
+    /* Frames still queued go again in full on the next link */
+    for (uint32_t i = 0; i < WIFI_EMU_MAX_CONNECTIONS; i++) {
+        wifi_emu_context_t *context = &wifi_emu_contexts[i];
+        if (context->tx_head) {
+            context->tx_head->offset = 0;
+        }
+        context->deficit = 0;
+        wifi_emu_free(context->rx);
+        context->rx = NULL;
+    }
+    wifi_emu_turn_started = false;
+}
+
+static void wifi_emu_schedule(void)
+{
+    /* SENT can arrive from inside hal_radio_l2cap_send(); the running loop picks it up */
+    if (!wifi_emu_link_open || wifi_emu_scheduling) {
+        return;
+    }
+
+    wifi_emu_scheduling = true;
+    while (wifi_emu_fragment_head - wifi_emu_fragment_tail < HAL_RADIO_L2CAP_QUEUE) {
+        wifi_emu_context_t *context = wifi_emu_next();
+        if (context == NULL || !wifi_emu_send_fragment(context)) {
+            break;
+        }
+    }
+    wifi_emu_scheduling = false;
+}
+
+static wifi_emu_context_t *wifi_emu_next(void)
+{
+    /* Deficit round robin: each turn adds one fragment's worth of bytes */
+    for (uint32_t i = 0; i <= WIFI_EMU_MAX_CONNECTIONS; i++) {
+        wifi_emu_context_t *context = &wifi_emu_contexts[wifi_emu_turn];
+
+        if (context->tx_head != NULL) {
+            if (!wifi_emu_turn_started) {
+                context->deficit += wifi_emu_fragment_size;
+                wifi_emu_turn_started = true;
+            }
+            if (wifi_emu_chunk(context->tx_head) <= context->deficit) {
+                return context;
+            }
+        } else {
+            context->deficit = 0;
+        }
+
+        wifi_emu_turn = (uint8_t)((wifi_emu_turn + 1) % WIFI_EMU_MAX_CONNECTIONS);
+        wifi_emu_turn_started = false;
+    }
+
+    return NULL;
+}
+
+static bool wifi_emu_send_fragment(wifi_emu_context_t *context)
+{
+    wifi_emu_buffer_t *frame = context->tx_head;
+    uint32_t offset = frame->offset;
+    uint32_t chunk = wifi_emu_chunk(frame);
+    uint8_t connection = (uint8_t)(context - wifi_emu_contexts);
+    bool first = (offset == 0);
+    bool last = (offset + chunk == frame->length);
+
+    wifi_emu_fragment_t *fragment = &wifi_emu_fragments[wifi_emu_fragment_head % HAL_RADIO_L2CAP_QUEUE];
+    fragment->header[0] = (uint8_t)(connection | (first ? WIFI_EMU_FLAG_FIRST : 0) |
+                                    (last ? WIFI_EMU_FLAG_LAST : 0));
+    fragment->header[1] = context->tx_sequence;
+    fragment->header[2] = (uint8_t)offset;
+    fragment->header[3] = (uint8_t)(offset >> 8);
+    fragment->segments[0].data = fragment->header;
+    fragment->segments[0].length = WIFI_EMU_HEADER_SIZE;
+    fragment->segments[1].data = &frame->data[offset];
+    fragment->segments[1].length = chunk;
+    fragment->frame = frame;
+    fragment->connection = connection;
+    fragment->complete = last;
+    fragment->release = last;
+
+    /* Commit first: the SENT callback may run before hal_radio_l2cap_send() returns */
+    wifi_emu_fragment_head++;
+    frame->offset = (uint16_t)(offset + chunk);
+    if (last) {
+        wifi_emu_pop(context);
+        context->tx_sequence++;
+    }
+
+    uint32_t count = chunk ? 2 : 1;
+    if (hal_radio_l2cap_send(wifi_emu_channel, fragment->segments, count) != HAL_OK) {
+        wifi_emu_fragment_head--;
+        frame->offset = (uint16_t)offset;
+        if (last) {
+            context->tx_sequence--;
+            wifi_emu_push_front(context, frame);
+        }
+        return false;
+    }
+
+    context->deficit -= chunk;
+    context->stats.tx_fragments++;
+    return true;
+}
+
+static void wifi_emu_fragment_sent(const void *segments)
+{
+    if (wifi_emu_fragment_tail == wifi_emu_fragment_head) {
+        return;
+    }
+
+    wifi_emu_fragment_t *fragment = &wifi_emu_fragments[wifi_emu_fragment_tail % HAL_RADIO_L2CAP_QUEUE];
+    if (segments != fragment->segments) {
+        return;
+    }
+    wifi_emu_fragment_tail++;
+
+    if (fragment->complete) {
+        wifi_emu_context_t *context = &wifi_emu_contexts[fragment->connection];
+        wifi_emu_buffer_t *frame = fragment->frame;
+        context->stats.tx_frames++;
+        context->stats.tx_bytes += frame->length;
+        context->tx_window += frame->length;
+        wifi_emu_latency(&context->stats, wifi_emu_now_us() - frame->queued_us);
+    }
+    if (fragment->release) {
+        wifi_emu_free(fragment->frame);
+    }
+}
+
+static void wifi_emu_fragment_received(const uint8_t *data, uint32_t length)
+{
+    if (data == NULL || length < WIFI_EMU_HEADER_SIZE) {
+        return;
+    }
+
+    uint8_t connection = data[0] & WIFI_EMU_CONNECTION_MASK;
+    if (connection >= WIFI_EMU_MAX_CONNECTIONS) {
+        return;
+    }
+    wifi_emu_context_t *context = &wifi_emu_contexts[connection];
+    if (context->state != WIFI_EMU_CONNECTED) {
+        return;
+    }
+    context->stats.rx_fragments++;
+
+    uint8_t flags = data[0];
+    uint8_t sequence = data[1];
+    uint32_t offset = (uint32_t)data[2] | ((uint32_t)data[3] << 8);
+    const uint8_t *payload = &data[WIFI_EMU_HEADER_SIZE];
+    uint32_t size = length - WIFI_EMU_HEADER_SIZE;
+
+    if (flags & WIFI_EMU_FLAG_FIRST) {
+        if (context->rx) {
+            /* Previous frame never finished */
+            context->stats.rx_dropped++;
+            wifi_emu_free(context->rx);
+        }
+        context->rx = wifi_emu_alloc();
+        if (context->rx == NULL) {
+            context->stats.rx_dropped++;
+            return;
+        }
+        context->rx_sequence = sequence;
+    } else if (context->rx == NULL) {
+        /* Rest of a frame already dropped */
+        return;
+    }
+
+    wifi_emu_buffer_t *frame = context->rx;
+    if (sequence != context->rx_sequence || offset != frame->length ||
+        frame->length + size > WIFI_EMU_BUFFER_SIZE) {
+        context->stats.rx_dropped++;
+        wifi_emu_free(frame);
+        context->rx = NULL;
+        return;
+    }
+
+    memcpy(&frame->data[frame->length], payload, size);
+    frame->length = (uint16_t)(frame->length + size);
+    if (!(flags & WIFI_EMU_FLAG_LAST)) {
+        return;
+    }
+
+    context->rx = NULL;
+    context->stats.rx_frames++;
+    context->stats.rx_bytes += frame->length;
+    context->rx_window += frame->length;
+    if (wifi_emu_config.receive) {
+        wifi_emu_config.receive(connection, frame, wifi_emu_config.user_data);
+    } else {
+        wifi_emu_free(frame);
+    }
+}
+
+static void wifi_emu_flush(wifi_emu_context_t *context)
+{
+    wifi_emu_buffer_t *frame = context->tx_head;
+
+    /* A partly fragmented head is still being read by the link */
+    if (frame && frame->offset > 0) {
+        wifi_emu_pop(context);
+        wifi_emu_fragment_t *owner = NULL;
+        for (uint32_t i = wifi_emu_fragment_tail; i != wifi_emu_fragment_head; i++) {
+            wifi_emu_fragment_t *fragment = &wifi_emu_fragments[i % HAL_RADIO_L2CAP_QUEUE];
+            if (fragment->frame == frame) {
+                owner = fragment;
+            }
+        }
+        if (owner) {
+            owner->release = true;
+        } else {
+            wifi_emu_free(frame);
+        }
+    }
+
+    while ((frame = wifi_emu_pop(context)) != NULL) {
+        wifi_emu_free(frame);
+    }
+
+    wifi_emu_free(context->rx);
+    context->rx = NULL;
+    context->deficit = 0;
+}
+
+static void wifi_emu_push_front(wifi_emu_context_t *context, wifi_emu_buffer_t *frame)
+{
+    frame->next = context->tx_head;
+    context->tx_head = frame;
+    if (context->tx_tail == NULL) {
+        context->tx_tail = frame;
+    }
+    context->tx_depth++;
+}
+
+static wifi_emu_buffer_t *wifi_emu_pop(wifi_emu_context_t *context)
+{
+    wifi_emu_buffer_t *frame = context->tx_head;
+    if (frame == NULL) {
+        return NULL;
+    }
+
+    context->tx_head = frame->next;
+    if (context->tx_head == NULL) {
+        context->tx_tail = NULL;
+    }
+    context->tx_depth--;
+    frame->next = NULL;
+    return frame;
+}
+
+static uint32_t wifi_emu_chunk(const wifi_emu_buffer_t *frame)
+{
+    uint32_t remaining = (uint32_t)frame->length - frame->offset;
+    return remaining < wifi_emu_fragment_size ? remaining : wifi_emu_fragment_size;
+}
+
+static uint32_t wifi_emu_now_us(void)
+{
+    uint32_t now = 0;
+    hal_radio_get_time(&now);
+    return now;
+}
+
+static void wifi_emu_latency(wifi_emu_stats_t *stats, uint32_t sample)
+{
+    stats->latency_last_us = sample;
+    if (sample > stats->latency_max_us) {
+        stats->latency_max_us = sample;
+    }
+    if (stats->latency_avg_us == 0) {
+        stats->latency_avg_us = sample;
+    } else {
+        stats->latency_avg_us = (uint32_t)((int32_t)stats->latency_avg_us +
+                                           ((int32_t)sample - (int32_t)stats->latency_avg_us) / 8);
+    }
+}
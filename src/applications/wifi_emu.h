@@ -0,0 +1,191 @@
+/**
+ * @file wifi_emu.h
+ * @brief WiFi emulation service over the BLE link
+ *
+ * Emulated stations exchange whole frames with a bridge on the paired
+ * phone through one L2CAP credit based channel. Frames live in a fixed
+ * pool of WIFI_EMU_BUFFER_SIZE buffers and are never copied on the way
+ * out: each frame is cut into fragments that fit one K-frame, and every
+ * fragment is gathered by the link straight from the pool buffer behind
+ * a four byte header:
+ *
+ *   byte 0   bits 0-3 connection, bit 6 last fragment, bit 7 first fragment
+ *   byte 1   frame sequence number, per connection
+ *   byte 2-3 fragment offset within the frame, little endian
+ *
+ * Each connection has its own transmit queue. Queues take turns by
+ * deficit round robin at fragment granularity, so a station pushing
+ * full size frames cannot hold the link while another waits with a
+ * short one. Incoming fragments are copied out of the L2CAP SDU buffer
+ * and reassembled per connection into pool buffers that the receive
+ * callback takes ownership of.
+ */
+
+#ifndef WIFI_EMU_H
+#define WIFI_EMU_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "hal_radio.h"
+#include "tweakngeek_config.h"
+
+/* Fragment layout */
+#define WIFI_EMU_HEADER_SIZE        4           /**< Fragment header bytes */
+#define WIFI_EMU_SSID_MAX           32          /**< SSID bytes, no terminator */
+
+/**
+ * @brief Frame buffer from the pool
+ */
+typedef struct wifi_emu_buffer {
+    struct wifi_emu_buffer *next;   /**< Queue link, owned by the service while queued */
+    uint16_t length;                /**< Frame bytes in data */
+    uint16_t offset;                /**< Bytes already fragmented (transmit side) */
+    uint32_t queued_us;             /**< wifi_emu_send() time, for latency */
+    uint8_t references;             /**< Holders; the buffer returns to the pool at zero */
+    uint8_t data[WIFI_EMU_BUFFER_SIZE]; /**< Frame bytes */
+} wifi_emu_buffer_t;
+
+/**
+ * @brief Connection state
+ */
+typedef enum {
+    WIFI_EMU_DISCONNECTED = 0,      /**< Slot free */
+    WIFI_EMU_CONNECTED              /**< Frames flow both ways */
+} wifi_emu_state_t;
+
+/**
+ * @brief Received frame, owned by the callee until wifi_emu_free()
+ * @param connection Connection index
+ * @param frame Reassembled frame
+ * @param user_data User data from the configuration
+ */
+typedef void (*wifi_emu_receive_callback_t)(uint8_t connection, wifi_emu_buffer_t *frame, void *user_data);
+
+/**
+ * @brief Service configuration
+ */
+typedef struct {
+    uint32_t radio_id;              /**< Open Bluetooth radio */
+    uint16_t psm;                   /**< L2CAP PSM the phone bridge connects to */
+    wifi_emu_receive_callback_t receive; /**< Frame consumer */
+    void *user_data;                /**< User data for the callback */
+} wifi_emu_config_t;
+
+/**
+ * @brief Per-connection counters
+ *
+ * Rates cover the last full second of wifi_emu_poll() calls. Latency runs
+ * from wifi_emu_send() to the last fragment being handed to the radio.
+ */
+typedef struct {
+    uint32_t tx_frames;             /**< Frames fully sent */
+    uint32_t rx_frames;             /**< Frames delivered to the callback */
+    uint64_t tx_bytes;              /**< Frame bytes sent */
+    uint64_t rx_bytes;              /**< Frame bytes received */
+    uint32_t tx_fragments;          /**< Fragments sent */
+    uint32_t rx_fragments;          /**< Fragments received */
+    uint32_t tx_rejected;           /**< wifi_emu_send() calls refused with a full queue */
+    uint32_t rx_dropped;            /**< Frames lost to an empty pool or broken reassembly */
+    uint32_t tx_rate;               /**< Frame bytes per second sent */
+    uint32_t rx_rate;               /**< Frame bytes per second received */
+    uint32_t latency_last_us;       /**< Latency of the last frame sent */
+    uint32_t latency_avg_us;        /**< Moving average over about eight frames */
+    uint32_t latency_max_us;        /**< Worst latency seen */
+} wifi_emu_stats_t;
+
+/**
+ * @brief Start the service and listen for the phone bridge
+ * @param config Service configuration, copied
+ * @return HAL_OK on success, error code otherwise
+ */
+hal_result_t wifi_emu_init(const wifi_emu_config_t *config);
+
+/**
+ * @brief Stop the service; queued and in-flight frames return to the pool
+ * @return HAL_OK on success, error code otherwise
+ */
+hal_result_t wifi_emu_deinit(void);
+
+/**
+ * @brief Bring up an emulated station
+ * @param ssid Network name, up to WIFI_EMU_SSID_MAX bytes
+ * @param channel WiFi channel, 0 for WIFI_EMU_CHANNEL_DEFAULT
+ * @param connection Pointer to store the connection index
+ * @return HAL_OK on success, HAL_ERROR_NO_MEMORY if all connections are in use
+ */
+hal_result_t wifi_emu_connect(const char *ssid, uint8_t channel, uint8_t *connection);
+
+/**
+ * @brief Take a station down; its queued frames return to the pool
+ * @param connection Connection index
+ * @return HAL_OK on success, error code otherwise
+ */
+hal_result_t wifi_emu_disconnect(uint8_t connection);
+
+/**
+ * @brief Get connection state
+ * @param connection Connection index
+ * @return Connection state, WIFI_EMU_DISCONNECTED for a bad index
+ */
+wifi_emu_state_t wifi_emu_get_state(uint8_t connection);
+
+/**
+ * @brief Take a frame buffer from the pool
+ * @return Empty buffer, NULL if the pool is exhausted
+ */
+wifi_emu_buffer_t *wifi_emu_alloc(void);
+
+/**
+ * @brief Take another reference to a frame buffer
+ *
+ * Lets a protocol keep a frame it passed to wifi_emu_send(), e.g. for
+ * retransmission. A buffer held by anyone else must not be modified.
+ *
+ * @param buffer Buffer with at least one reference; one in the pool is ignored
+ */
+void wifi_emu_ref(wifi_emu_buffer_t *buffer);
+
+/**
+ * @brief Drop a reference; the last one returns the buffer to the pool
+ *
+ * Freeing a buffer that is already back in the pool does nothing.
+ *
+ * @param buffer Buffer from wifi_emu_alloc() or the receive callback
+ */
+void wifi_emu_free(wifi_emu_buffer_t *buffer);
+
+/**
+ * @brief Number of free buffers in the pool
+ * @return Free buffers
+ */
+uint32_t wifi_emu_available(void);
+
+/**
+ * @brief Queue a frame on a connection
+ *
+ * On success the service owns the buffer and frees it once the last
+ * fragment is with the radio; on error the caller keeps it.
+ *
+ * @param connection Connection index
+ * @param frame Buffer with length set
+ * @return HAL_OK on success, HAL_ERROR_RESOURCE_BUSY if WIFI_EMU_TX_QUEUE frames are waiting
+ */
+hal_result_t wifi_emu_send(uint8_t connection, wifi_emu_buffer_t *frame);
+
+/**
+ * @brief Move fragments to the link and roll the rate counters
+ *
+ * Call regularly from a task; the radio task runs
+ * hal_radio_bluetooth_poll() on its own.
+ */
+void wifi_emu_poll(void);
+
+/**
+ * @brief Get connection counters
+ * @param connection Connection index
+ * @param stats Pointer to store the counters
+ * @return HAL_OK on success, error code otherwise
+ */
+hal_result_t wifi_emu_get_stats(uint8_t connection, wifi_emu_stats_t *stats);
+
+#endif /* WIFI_EMU_H */
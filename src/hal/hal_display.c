@@ -9,9 +9,9 @@
 
 #include "hal_display.h"
 #include "hal_internal.h"
+#include "kernel/interrupt.h"
 #include <string.h>
 #include <stdlib.h>
-#include <math.h>
 
 /* Private constants */
 #define DISPLAY_BUFFER_SIZE_BYTES   ((DISPLAY_WIDTH * DISPLAY_HEIGHT) / 8)
@@ -19,33 +19,242 @@
 #define INPUT_HOLD_TIME_MS          500
 #define INPUT_REPEAT_TIME_MS        100
 
-/* Font data structures */
+#define TEXT_WIDTH_CACHE_SIZE       8
+#define DISPLAY_PAGES               (DISPLAY_HEIGHT / 8)
+#define DISPLAY_FLUSH_TIMEOUT_MS    100
+
+#if HAL_DISPLAY_DOUBLE_BUFFER
+#define DISPLAY_FRAME_BUFFERS       2
+#else
+#define DISPLAY_FRAME_BUFFERS       1
+#endif
+
+/* Buffers a primitive may have to write: one, or every gray plane */
+#if HAL_DISPLAY_GRAY_PLANES > 1
+#define DISPLAY_MAX_TARGETS         HAL_DISPLAY_GRAY_PLANES
+#else
+#define DISPLAY_MAX_TARGETS         1
+#endif
+
+/* Display controller (ST7565 family) commands */
+#define ST7565_CMD_PAGE_ADDRESS     0xB0    /**< | page */
+#define ST7565_CMD_COLUMN_HIGH      0x10    /**< | column[7:4] */
+#define ST7565_CMD_COLUMN_LOW       0x00    /**< | column[3:0] */
+#define ST7565_CMD_SEG_NORMAL       0xA0
+#define ST7565_CMD_SEG_REVERSE      0xA1
+#define ST7565_CMD_DISPLAY_NORMAL   0xA6
+#define ST7565_CMD_DISPLAY_INVERSE  0xA7
+#define ST7565_CMD_COM_NORMAL       0xC0
+#define ST7565_CMD_COM_REVERSE      0xC8
+#define ST7565_CMD_VOLUME           0x81    /**< Followed by contrast 0-63 */
+#define ST7565_COLUMNS              132     /**< Controller RAM columns */
+
+/* Display SPI2 TX is served by DMA1 channel 1 through DMAMUX1 channel 0 */
+#define DISPLAY_SPI_BASE            0x40003800UL    /* SPI2 */
+#define DISPLAY_DMA_BASE            0x40020000UL    /* DMA1 */
+#define DISPLAY_DMAMUX_BASE         0x40020800UL    /* DMAMUX1 */
+
+#define SPI_CR2_OFFSET              0x04
+#define SPI_SR_OFFSET               0x08
+#define SPI_DR_OFFSET               0x0C
+#define SPI_CR2_TXDMAEN             (1UL << 1)
+#define SPI_SR_BSY                  (1UL << 7)
+#define SPI_SR_FTLVL                (3UL << 11)
+
+#define DMA_ISR_OFFSET              0x00
+#define DMA_IFCR_OFFSET             0x04
+#define DMA_CCR1_OFFSET             0x08
+#define DMA_CNDTR1_OFFSET           0x0C
+#define DMA_CPAR1_OFFSET            0x10
+#define DMA_CMAR1_OFFSET            0x14
+#define DMA_CCR_EN                  (1UL << 0)
+#define DMA_CCR_TCIE                (1UL << 1)
+#define DMA_CCR_TEIE                (1UL << 3)
+#define DMA_CCR_DIR                 (1UL << 4)      /* Memory to peripheral */
+#define DMA_CCR_MINC                (1UL << 7)
+#define DMA_ISR_TCIF1               (1UL << 1)
+#define DMA_ISR_TEIF1               (1UL << 3)
+#define DMA_IFCR_CGIF1              (1UL << 0)
+#define DMAMUX_C0CR_OFFSET          0x00
+#define DMAMUX_REQ_SPI2_TX          9
+
+#define DISPLAY_REG(base, offset)   (*(volatile uint32_t *)((base) + (offset)))
+
+/* Built-in fonts by size */
+static const hal_font_t *const fonts[HAL_FONT_SIZE_MAX] = {
+    [HAL_FONT_SIZE_SMALL]  = &hal_font_small,
+    [HAL_FONT_SIZE_MEDIUM] = &hal_font_medium,
+    [HAL_FONT_SIZE_LARGE]  = &hal_font_large,
+};
+
+/**
+ * @brief Cached text width measurement
+ *
+ * Layout code tends to measure the same labels every frame; proportional
+ * widths need a glyph and kerning lookup per character, so recent results
+ * are kept keyed by font, string hash and length.
+ */
+typedef struct {
+    const hal_font_t *font;
+    uint32_t hash;
+    uint16_t length;
+    uint16_t width;
+} text_width_entry_t;
+
+/**
+ * @brief Raster operation applied to a byte or word of the buffer
+ *
+ * Every drawing mode is expressed as dst = (dst & and_mask) ^ xor_mask:
+ * SET is OR (and ~m, xor m), CLEAR is AND-NOT (and ~m, xor 0) and
+ * INVERT is XOR (and all ones, xor m), so span loops need no per-pixel switch.
+ */
+typedef struct {
+    uint32_t and_mask;
+    uint32_t xor_mask;
+} raster_op_t;
+
+/**
+ * @brief Run-length decoder state
+ */
+typedef struct {
+    const uint8_t *pos;
+    const uint8_t *end;
+    uint8_t value;
+    uint8_t count;
+    bool literal;
+} rle_state_t;
+
+/**
+ * @brief Bitmap source read one page row (eight pixel rows) at a time
+ */
 typedef struct {
-    uint8_t width;
-    uint8_t height;
+    hal_bitmap_format_t format;
     const uint8_t *data;
-} font_info_t;
-
-/* Simple 6x8 font data (basic ASCII characters) */
-static const uint8_t font_6x8_data[] = {
-    /* Space (32) */
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    /* ! (33) */
-    0x00, 0x00, 0x5F, 0x00, 0x00, 0x00,
-    /* " (34) */
-    0x00, 0x07, 0x00, 0x07, 0x00, 0x00,
-    /* Add more characters as needed... */
+    uint32_t stride;            /* Bytes per page row, or bits per pixel row for row-major */
+    uint32_t width;
+    uint32_t height;
+    rle_state_t rle;
+} blit_source_t;
+
+/**
+ * @brief Drawing target saved while a canvas is bound
+ */
+typedef struct {
+    uint8_t *buffer;
+    int32_t width;
+    int32_t height;
+    int32_t stride;
+    int32_t clip_left;
+    int32_t clip_top;
+    int32_t clip_right;
+    int32_t clip_bottom;
+} raster_binding_t;
+
+/* sin(0..90 degrees) in Q14, used to turn arc angles into direction vectors */
+static const int16_t sin_table_q14[91] = {
+        0,   286,   572,   857,  1143,  1428,  1713,  1997,  2280,  2563,
+     2845,  3126,  3406,  3686,  3964,  4240,  4516,  4790,  5063,  5334,
+     5604,  5872,  6138,  6402,  6664,  6924,  7182,  7438,  7692,  7943,
+     8192,  8438,  8682,  8923,  9162,  9397,  9630,  9860, 10087, 10311,
+    10531, 10749, 10963, 11174, 11381, 11585, 11786, 11982, 12176, 12365,
+    12551, 12733, 12911, 13085, 13255, 13421, 13583, 13741, 13894, 14044,
+    14189, 14330, 14466, 14598, 14726, 14849, 14968, 15082, 15191, 15296,
+    15396, 15491, 15582, 15668, 15749, 15826, 15897, 15964, 16026, 16083,
+    16135, 16182, 16225, 16262, 16294, 16322, 16344, 16362, 16374, 16382,
+    16384
 };
 
-/* Font definitions */
-static const font_info_t fonts[] = {
-    [HAL_FONT_SIZE_SMALL]  = { .width = 6,  .height = 8,  .data = font_6x8_data },
-    [HAL_FONT_SIZE_MEDIUM] = { .width = 8,  .height = 12, .data = font_6x8_data }, /* Placeholder */
-    [HAL_FONT_SIZE_LARGE]  = { .width = 12, .height = 16, .data = font_6x8_data }, /* Placeholder */
+/*
+ * Ordered dither thresholds: the 8x8 Bayer matrix b scaled to
+ * (2b + 1) * 255 / 128, added before dividing by 255 so that each level
+ * boundary is crossed at evenly spread intensities.
+ */
+static const uint8_t dither_bias[8][8] = {
+    {   1, 129,  33, 161,   9, 137,  41, 169 },
+    { 193,  65, 225,  97, 201,  73, 233, 105 },
+    {  49, 177,  17, 145,  57, 185,  25, 153 },
+    { 241, 113, 209,  81, 249, 121, 217,  89 },
+    {  13, 141,  45, 173,   5, 133,  37, 165 },
+    { 205,  77, 237, 109, 197,  69, 229, 101 },
+    {  61, 189,  29, 157,  53, 181,  21, 149 },
+    { 253, 125, 221,  93, 245, 117, 213,  85 },
 };
 
+/* 32-bit view of the framebuffer used by span fills */
+typedef uint32_t __attribute__((may_alias)) raster_word_t;
+
 /* Private variables */
-static uint8_t display_buffer[DISPLAY_BUFFER_SIZE_BYTES];
+/**
+ * @brief Panel transfer in progress
+ *
+ * Frames are streamed one page at a time: the page/column address is set
+ * with a few polled command bytes, then the page data goes out by DMA and
+ * the completion interrupt moves on to the next page.
+ */
+typedef struct {
+    const uint8_t *buffer;      /* Frame being transmitted */
+    uint8_t page;               /* Page currently on the wire */
+    uint8_t last_page;
+    uint8_t first_column;
+    uint8_t last_column;
+    bool transposed;            /* Buffer holds a portrait (90/270) frame */
+    volatile bool active;
+} display_flush_t;
+
+static uint8_t frame_buffers[DISPLAY_FRAME_BUFFERS][DISPLAY_BUFFER_SIZE_BYTES] __attribute__((aligned(4)));
+static uint8_t *display_buffer = frame_buffers[0];     /* Buffer primitives draw into */
+static uint8_t *front_buffer = frame_buffers[0];       /* Buffer sent to the panel */
+static hal_display_buffering_t buffering = HAL_DISPLAY_BUFFERING_SINGLE;
+static display_flush_t flush;
+static uint8_t flush_staging[2][DISPLAY_WIDTH] __attribute__((aligned(8)));
+
+/*
+ * Grayscale bitplanes. Plane n carries bit n of each pixel's gray level
+ * and is shown for 2^n subframes out of 2^bits - 1, so the time a pixel is
+ * dark is proportional to its level.
+ */
+#if HAL_DISPLAY_GRAY_PLANES > 0
+static uint8_t gray_planes[HAL_DISPLAY_GRAY_PLANES][DISPLAY_BUFFER_SIZE_BYTES] __attribute__((aligned(4)));
+#endif
+static uint8_t gray_bits = 0;           /* Planes in use, 0 in MONO format */
+static uint8_t gray_level = 0;          /* Level painted by SET mode */
+static uint8_t gray_step = 0;           /* Subframe within the refresh cycle */
+static int16_t dither_errors[2][DISPLAY_WIDTH + 2];
+
+/*
+ * Logical raster geometry. Portrait rotations draw into a 64x128 raster
+ * with the same page-major layout (16 pages of 64 bytes) that is
+ * transposed to panel pages during the flush; 180 degrees is done by the
+ * controller's segment/common scan direction, so drawing never transforms
+ * coordinates.
+ */
+static int32_t raster_width = DISPLAY_WIDTH;
+static int32_t raster_height = DISPLAY_HEIGHT;
+static int32_t raster_pages = DISPLAY_PAGES;
+static bool display_transposed = false;
+
+/* Clip rectangle within the raster, right/bottom exclusive */
+static int32_t clip_left = 0;
+static int32_t clip_top = 0;
+static int32_t clip_right = DISPLAY_WIDTH;
+static int32_t clip_bottom = DISPLAY_HEIGHT;
+
+/*
+ * Drawing target. Primitives draw into the screen raster unless a
+ * hal_canvas_* call has bound an offscreen canvas; the clip above is then
+ * the canvas clip until the screen's is restored.
+ */
+static uint8_t *canvas_buffer = NULL;   /* Bound canvas, NULL for the screen */
+static int32_t draw_width = DISPLAY_WIDTH;
+static int32_t draw_height = DISPLAY_HEIGHT;
+static int32_t draw_stride = DISPLAY_WIDTH;
+
+static uint8_t display_column_offset = 0;
+static volatile uint32_t frames_completed = 0;
+static hal_display_vsync_callback_t vsync_callback = NULL;
+static void *vsync_callback_user_data = NULL;
+static text_width_entry_t text_width_cache[TEXT_WIDTH_CACHE_SIZE];
+static uint8_t text_width_cache_next = 0;
 static hal_display_config_t current_config;
 static bool display_initialized = false;
 static bool input_initialized = false;
@@ -61,10 +270,55 @@ static void *input_callback_user_data = NULL;
 static hal_result_t display_hardware_init(void);
 static hal_result_t display_hardware_deinit(void);
 static hal_result_t display_send_command(uint8_t cmd);
-static hal_result_t display_send_data(const uint8_t *data, uint32_t size);
+static void display_flush_start(const uint8_t *buffer, uint8_t first_page, uint8_t last_page,
+                                uint8_t first_column, uint8_t last_column);
+static void display_flush_page(void);
+static void display_flush_stage(uint8_t page);
+static void display_apply_orientation(bool flipped);
+static hal_result_t display_present(int32_t x0, int32_t y0, int32_t x1, int32_t y1, bool whole_frame);
+static bool raster_clip_rect(const hal_rect_t *rect, int32_t width, int32_t height,
+                             int32_t *x0, int32_t *y0, int32_t *x1, int32_t *y1);
+static void raster_set_clip(const hal_rect_t *rect);
+static void raster_bind_screen(void);
+static bool canvas_valid(const hal_canvas_t *canvas);
+static hal_result_t canvas_bind(const hal_canvas_t *canvas, raster_binding_t *saved);
+static void canvas_unbind(const raster_binding_t *saved);
+static hal_result_t display_set_format(hal_display_format_t format);
+static uint32_t raster_targets(uint8_t **targets);
+static bool raster_plane_ink(uint32_t plane);
+static uint8_t raster_clip_rows(int32_t page);
+static void display_dma_start(const uint8_t *data, uint32_t size);
+static void display_dma_irq_handler(void);
 static void input_read_hardware_states(void);
 static uint32_t get_system_time_ms(void);
 static void bresenham_line(int16_t x0, int16_t y0, int16_t x1, int16_t y1, hal_graphics_mode_t mode);
+static raster_op_t raster_make_op(uint8_t mask, hal_graphics_mode_t mode);
+static void raster_apply_span(uint8_t *dst, uint32_t count, raster_op_t op);
+static void raster_fill_rect(int32_t x, int32_t y, int32_t width, int32_t height, hal_graphics_mode_t mode);
+static void raster_pixel(int32_t x, int32_t y, hal_graphics_mode_t mode);
+static void raster_blit_pages(const uint8_t *src, uint32_t stride, int32_t x, int32_t y,
+                              int32_t width, int32_t height, hal_graphics_mode_t mode);
+static uint64_t raster_transpose8x8(uint64_t x);
+static void rle_decode(rle_state_t *rle, uint8_t *out, uint32_t count);
+static void blit_source_init(blit_source_t *src, hal_bitmap_format_t format, const uint8_t *data,
+                             uint32_t size, uint32_t stride, uint32_t width, uint32_t height);
+static void blit_rows_to_columns(const blit_source_t *src, uint32_t page, uint32_t col0,
+                                 uint32_t count, uint8_t *out);
+static const uint8_t *blit_source_strip(blit_source_t *src, uint32_t page, uint32_t col0,
+                                        uint32_t count, uint8_t *scratch);
+static hal_blit_mode_t raster_blit_mode(hal_graphics_mode_t mode);
+static void raster_blit(blit_source_t *data, blit_source_t *mask, int32_t x, int32_t y, hal_blit_mode_t mode);
+static const hal_font_glyph_t *font_find_glyph(const hal_font_t *font, char c, uint8_t *code);
+static int32_t font_kerning(const hal_font_t *font, uint8_t left, uint8_t right);
+static uint16_t font_measure(const char *text, const hal_font_t *font);
+static int32_t raster_clamp_radius(const hal_rect_t *rect, uint16_t radius);
+static void raster_round_outline(int32_t left, int32_t top, int32_t right, int32_t bottom,
+                                 int32_t r, hal_graphics_mode_t mode);
+static void raster_round_fill(int32_t left, int32_t top, int32_t right, int32_t bottom,
+                              int32_t r, hal_graphics_mode_t mode);
+static void raster_ellipse(int32_t cx, int32_t cy, int32_t rx, int32_t ry, bool fill, hal_graphics_mode_t mode);
+static void raster_arc(int32_t cx, int32_t cy, int32_t r, int32_t start_angle, int32_t sweep_angle,
+                       hal_graphics_mode_t mode);
 
 /* Display HAL Implementation */
 
@@ -74,8 +328,20 @@ hal_result_t hal_display_init(void)
         return HAL_OK;
     }
 
-    /* Initialize display buffer */
-    memset(display_buffer, 0, sizeof(display_buffer));
+    /* Initialize frame buffers, starting single buffered */
+    memset(frame_buffers, 0, sizeof(frame_buffers));
+    display_buffer = frame_buffers[0];
+    front_buffer = frame_buffers[0];
+    buffering = HAL_DISPLAY_BUFFERING_SINGLE;
+    flush.active = false;
+    frames_completed = 0;
+    raster_width = DISPLAY_WIDTH;
+    raster_height = DISPLAY_HEIGHT;
+    raster_pages = DISPLAY_PAGES;
+    display_transposed = false;
+    raster_bind_screen();
+    raster_set_clip(NULL);
+    gray_bits = 0;
 
     /* Set default configuration */
     current_config.width = DISPLAY_WIDTH;
@@ -92,6 +358,22 @@ hal_result_t hal_display_init(void)
         return result;
     }
 
+    display_apply_orientation(false);
+    display_send_command(ST7565_CMD_VOLUME);
+    display_send_command((uint8_t)(current_config.contrast >> 2));
+    display_send_command(ST7565_CMD_DISPLAY_NORMAL);
+
+    /* Page flushes advance from the DMA completion interrupt */
+    if (interrupt_register(IRQ_DMA1_CH1, display_dma_irq_handler, IRQ_PRIORITY_NORMAL, "DMA1_CH1") != KERNEL_OK) {
+        display_hardware_deinit();
+        return HAL_ERROR;
+    }
+    if (interrupt_enable(IRQ_DMA1_CH1) != KERNEL_OK) {
+        interrupt_unregister(IRQ_DMA1_CH1);
+        display_hardware_deinit();
+        return HAL_ERROR;
+    }
+
     display_initialized = true;
     return HAL_OK;
 }
@@ -102,6 +384,10 @@ hal_result_t hal_display_deinit(void)
         return HAL_ERROR_NOT_INITIALIZED;
     }
 
+    hal_display_wait_idle(DISPLAY_FLUSH_TIMEOUT_MS);
+    interrupt_disable(IRQ_DMA1_CH1);
+    interrupt_unregister(IRQ_DMA1_CH1);
+
     hal_result_t result = display_hardware_deinit();
     display_initialized = false;
     return result;
@@ -124,8 +410,31 @@ hal_result_t hal_display_configure(const hal_display_config_t *config)
         return HAL_ERROR_INVALID_PARAM;
     }
 
-    /* Apply configuration */
+    if (config->format == HAL_DISPLAY_FORMAT_RGB565 ||
+        (config->format == HAL_DISPLAY_FORMAT_GRAY2 && HAL_DISPLAY_GRAY_PLANES < 2) ||
+        (config->format == HAL_DISPLAY_FORMAT_GRAY4 && HAL_DISPLAY_GRAY_PLANES < 4)) {
+        return HAL_ERROR_NOT_SUPPORTED;
+    }
+
+    /* Both steps refuse only while a flush is running: refuse up front so neither applies alone */
+    if (flush.active) {
+        return HAL_ERROR_RESOURCE_BUSY;
+    }
+
+    hal_result_t result = display_set_format(config->format);
+    if (result != HAL_OK) {
+        return result;
+    }
+
+    result = hal_display_set_rotation(config->rotation);
+    if (result != HAL_OK) {
+        return result;
+    }
+
+    /* Apply configuration; the geometry follows from the rotation */
     memcpy(&current_config, config, sizeof(hal_display_config_t));
+    current_config.width = (uint16_t)raster_width;
+    current_config.height = (uint16_t)raster_height;
 
     /* Update hardware settings */
     hal_display_set_backlight(config->backlight);
@@ -155,7 +464,10 @@ hal_result_t hal_display_clear(void)
         return HAL_ERROR_NOT_INITIALIZED;
     }
 
-    memset(display_buffer, 0, sizeof(display_buffer));
+    memset(display_buffer, 0, DISPLAY_BUFFER_SIZE_BYTES);
+#if HAL_DISPLAY_GRAY_PLANES > 0
+    memset(gray_planes, 0, (uint32_t)gray_bits * DISPLAY_BUFFER_SIZE_BYTES);
+#endif
     return HAL_OK;
 }
 
@@ -165,7 +477,161 @@ hal_result_t hal_display_update(void)
         return HAL_ERROR_NOT_INITIALIZED;
     }
 
-    return display_send_data(display_buffer, sizeof(display_buffer));
+    hal_result_t result = hal_display_wait_idle(DISPLAY_FLUSH_TIMEOUT_MS);
+    if (result != HAL_OK) {
+        return result;
+    }
+
+    result = hal_display_update_async();
+    if (result != HAL_OK) {
+        return result;
+    }
+
+    return hal_display_wait_idle(DISPLAY_FLUSH_TIMEOUT_MS);
+}
+
+hal_result_t hal_display_update_async(void)
+{
+    if (!display_initialized) {
+        return HAL_ERROR_NOT_INITIALIZED;
+    }
+
+    /* Gray planes are live; hal_display_gray_tick() keeps them on screen */
+    if (gray_bits != 0) {
+        return HAL_OK;
+    }
+
+    return display_present(0, 0, raster_width - 1, raster_height - 1, true);
+}
+
+hal_result_t hal_display_update_rect(const hal_rect_t *rect)
+{
+    if (!display_initialized) {
+        return HAL_ERROR_NOT_INITIALIZED;
+    }
+
+    if (!rect) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    hal_result_t result = hal_display_wait_idle(DISPLAY_FLUSH_TIMEOUT_MS);
+    if (result != HAL_OK) {
+        return result;
+    }
+
+    result = hal_display_update_rect_async(rect);
+    if (result != HAL_OK) {
+        return result;
+    }
+
+    return hal_display_wait_idle(DISPLAY_FLUSH_TIMEOUT_MS);
+}
+
+hal_result_t hal_display_update_rect_async(const hal_rect_t *rect)
+{
+    if (!display_initialized) {
+        return HAL_ERROR_NOT_INITIALIZED;
+    }
+
+    if (!rect) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    int32_t x0, y0, x1, y1;
+    if (gray_bits != 0 || !raster_clip_rect(rect, raster_width, raster_height, &x0, &y0, &x1, &y1)) {
+        return HAL_OK;
+    }
+
+    return display_present(x0, y0, x1, y1, false);
+}
+
+hal_result_t hal_display_wait_idle(uint32_t timeout_ms)
+{
+    if (!display_initialized) {
+        return HAL_ERROR_NOT_INITIALIZED;
+    }
+
+    uint32_t start = get_system_time_ms();
+    while (flush.active) {
+        if (get_system_time_ms() - start >= timeout_ms) {
+            return HAL_ERROR_TIMEOUT;
+        }
+    }
+
+    return HAL_OK;
+}
+
+bool hal_display_is_busy(void)
+{
+    return flush.active;
+}
+
+hal_result_t hal_display_set_buffering(hal_display_buffering_t mode)
+{
+    if (!display_initialized) {
+        return HAL_ERROR_NOT_INITIALIZED;
+    }
+
+    if (mode >= HAL_DISPLAY_BUFFERING_MAX) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    if (mode != HAL_DISPLAY_BUFFERING_SINGLE && DISPLAY_FRAME_BUFFERS < 2) {
+        return HAL_ERROR_NOT_SUPPORTED;
+    }
+
+    if (flush.active) {
+        return HAL_ERROR_RESOURCE_BUSY;
+    }
+
+    /* Keep the picture being drawn; the front buffer is buffer 0 in every mode */
+    uint8_t *target = frame_buffers[DISPLAY_FRAME_BUFFERS - 1];
+    if (mode == HAL_DISPLAY_BUFFERING_SINGLE) {
+        target = frame_buffers[0];
+    }
+    if (target != display_buffer) {
+        memcpy(target, display_buffer, DISPLAY_BUFFER_SIZE_BYTES);
+    }
+    if (mode != HAL_DISPLAY_BUFFERING_SINGLE && front_buffer != frame_buffers[0]) {
+        memcpy(frame_buffers[0], front_buffer, DISPLAY_BUFFER_SIZE_BYTES);
+    }
+
+    display_buffer = target;
+    front_buffer = frame_buffers[0];
+    buffering = mode;
+    return HAL_OK;
+}
+
+hal_result_t hal_display_register_vsync_callback(hal_display_vsync_callback_t callback, void *user_data)
+{
+    if (!display_initialized) {
+        return HAL_ERROR_NOT_INITIALIZED;
+    }
+
+    /* The interrupt may fire in between; never pair a callback with stale data */
+    vsync_callback = NULL;
+    vsync_callback_user_data = user_data;
+    vsync_callback = callback;
+    return HAL_OK;
+}
+
+void hal_display_gray_tick(void)
+{
+#if HAL_DISPLAY_GRAY_PLANES > 0
+    if (!display_initialized || gray_bits == 0 || flush.active) {
+        return;
+    }
+
+    /*
+     * Steps 1..2^bits-1: the top plane gets every odd step, the next plane
+     * every step that is 2 mod 4 and so on, which spreads each plane's
+     * subframes evenly over the cycle.
+     */
+    gray_step = (uint8_t)((gray_step % ((1U << gray_bits) - 1U)) + 1U);
+    uint32_t plane = (uint32_t)gray_bits - 1U - (uint32_t)__builtin_ctz(gray_step);
+
+    display_flush_start(gray_planes[plane], 0, DISPLAY_PAGES - 1, 0, DISPLAY_WIDTH - 1);
+#endif
 }
 
 hal_result_t hal_display_set_backlight(hal_display_backlight_t level)
@@ -193,10 +659,14 @@ hal_result_t hal_display_set_contrast(uint8_t contrast)
     }
 
     current_config.contrast = contrast;
-    
-    /* Hardware-specific contrast control would go here */
-    /* For now, this is a stub implementation */
-    
+
+    /* Commands must not interleave with a frame being streamed */
+    hal_display_wait_idle(DISPLAY_FLUSH_TIMEOUT_MS);
+
+    /* Electronic volume is 6 bits */
+    display_send_command(ST7565_CMD_VOLUME);
+    display_send_command((uint8_t)(contrast >> 2));
+
     return HAL_OK;
 }
 
@@ -207,10 +677,51 @@ hal_result_t hal_display_set_invert(bool invert)
     }
 
     current_config.invert = invert;
-    
-    /* Hardware-specific invert control would go here */
-    /* For now, this is a stub implementation */
-    
+
+    /* Inversion is a controller mode; the frame buffer is left untouched */
+    hal_display_wait_idle(DISPLAY_FLUSH_TIMEOUT_MS);
+    display_send_command(invert ? ST7565_CMD_DISPLAY_INVERSE : ST7565_CMD_DISPLAY_NORMAL);
+
+    return HAL_OK;
+}
+
+hal_result_t hal_display_set_rotation(hal_display_rotation_t rotation)
+{
+    if (!display_initialized) {
+        return HAL_ERROR_NOT_INITIALIZED;
+    }
+
+    if (rotation >= HAL_DISPLAY_ROTATION_MAX) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    if (flush.active) {
+        return HAL_ERROR_RESOURCE_BUSY;
+    }
+
+    /* 270 is the transposed 90 frame shown through the controller's 180 flip */
+    bool portrait = (rotation == HAL_DISPLAY_ROTATION_90 || rotation == HAL_DISPLAY_ROTATION_270);
+    bool flipped = (rotation == HAL_DISPLAY_ROTATION_180 || rotation == HAL_DISPLAY_ROTATION_270);
+
+    if (portrait != display_transposed) {
+        /* Switching between landscape and portrait invalidates the contents */
+        memset(frame_buffers, 0, sizeof(frame_buffers));
+#if HAL_DISPLAY_GRAY_PLANES > 0
+        memset(gray_planes, 0, sizeof(gray_planes));
+#endif
+        display_transposed = portrait;
+        raster_width = portrait ? DISPLAY_HEIGHT : DISPLAY_WIDTH;
+        raster_height = portrait ? DISPLAY_WIDTH : DISPLAY_HEIGHT;
+        raster_pages = raster_height / 8;
+        raster_bind_screen();
+        raster_set_clip(NULL);
+    }
+
+    display_apply_orientation(flipped);
+
+    current_config.rotation = rotation;
+    current_config.width = (uint16_t)raster_width;
+    current_config.height = (uint16_t)raster_height;
     return HAL_OK;
 }
 
@@ -225,19 +736,29 @@ hal_result_t hal_display_get_buffer(uint8_t **buffer, uint32_t *size)
     }
 
     *buffer = display_buffer;
-    *size = sizeof(display_buffer);
+    *size = DISPLAY_BUFFER_SIZE_BYTES;
     return HAL_OK;
 }
 
 /* Graphics Primitives Implementation */
 
+hal_result_t hal_graphics_set_clip(const hal_rect_t *rect)
+{
+    if (!display_initialized) {
+        return HAL_ERROR_NOT_INITIALIZED;
+    }
+
+    raster_set_clip(rect);
+    return HAL_OK;
+}
+
 hal_result_t hal_graphics_set_pixel(int16_t x, int16_t y, hal_graphics_mode_t mode)
 {
     if (!display_initialized) {
         return HAL_ERROR_NOT_INITIALIZED;
     }
 
-    if (x < 0 || x >= DISPLAY_WIDTH || y < 0 || y >= DISPLAY_HEIGHT) {
+    if (x < 0 || x >= draw_width || y < 0 || y >= draw_height) {
         return HAL_ERROR_INVALID_PARAM;
     }
 
@@ -245,24 +766,7 @@ hal_result_t hal_graphics_set_pixel(int16_t x, int16_t y, hal_graphics_mode_t mo
         return HAL_ERROR_INVALID_PARAM;
     }
 
-    /* Calculate buffer position for monochrome display */
-    uint32_t byte_index = (y / 8) * DISPLAY_WIDTH + x;
-    uint8_t bit_mask = 1 << (y % 8);
-
-    switch (mode) {
-        case HAL_GRAPHICS_MODE_SET:
-            display_buffer[byte_index] |= bit_mask;
-            break;
-        case HAL_GRAPHICS_MODE_CLEAR:
-            display_buffer[byte_index] &= ~bit_mask;
-            break;
-        case HAL_GRAPHICS_MODE_INVERT:
-            display_buffer[byte_index] ^= bit_mask;
-            break;
-        default:
-            return HAL_ERROR_INVALID_PARAM;
-    }
-
+    raster_pixel(x, y, mode);
     return HAL_OK;
 }
 
@@ -290,11 +794,21 @@ hal_result_t hal_graphics_draw_rect(const hal_rect_t *rect, hal_graphics_mode_t
         return HAL_ERROR_INVALID_PARAM;
     }
 
-    /* Draw rectangle outline */
-    hal_graphics_draw_line(rect->x, rect->y, rect->x + rect->width - 1, rect->y, mode);
-    hal_graphics_draw_line(rect->x + rect->width - 1, rect->y, rect->x + rect->width - 1, rect->y + rect->height - 1, mode);
-    hal_graphics_draw_line(rect->x + rect->width - 1, rect->y + rect->height - 1, rect->x, rect->y + rect->height - 1, mode);
-    hal_graphics_draw_line(rect->x, rect->y + rect->height - 1, rect->x, rect->y, mode);
+    if (rect->width == 0 || rect->height == 0) {
+        return HAL_OK;
+    }
+
+    /* Draw rectangle outline as spans; corners are touched once so INVERT is exact */
+    raster_fill_rect(rect->x, rect->y, rect->width, 1, mode);
+    if (rect->height > 1) {
+        raster_fill_rect(rect->x, rect->y + rect->height - 1, rect->width, 1, mode);
+    }
+    if (rect->height > 2) {
+        raster_fill_rect(rect->x, rect->y + 1, 1, rect->height - 2, mode);
+        if (rect->width > 1) {
+            raster_fill_rect(rect->x + rect->width - 1, rect->y + 1, 1, rect->height - 2, mode);
+        }
+    }
 
     return HAL_OK;
 }
@@ -309,13 +823,7 @@ hal_result_t hal_graphics_fill_rect(const hal_rect_t *rect, hal_graphics_mode_t
         return HAL_ERROR_INVALID_PARAM;
     }
 
-    /* Fill rectangle */
-    for (int16_t y = rect->y; y < rect->y + rect->height; y++) {
-        for (int16_t x = rect->x; x < rect->x + rect->width; x++) {
-            hal_graphics_set_pixel(x, y, mode);
-        }
-    }
-
+    raster_fill_rect(rect->x, rect->y, rect->width, rect->height, mode);
     return HAL_OK;
 }
 
@@ -329,31 +837,7 @@ hal_result_t hal_graphics_draw_circle(const hal_point_t *center, uint16_t radius
         return HAL_ERROR_INVALID_PARAM;
     }
 
-    /* Bresenham circle algorithm */
-    int16_t x = 0;
-    int16_t y = radius;
-    int16_t d = 3 - 2 * radius;
-
-    while (x <= y) {
-        /* Draw 8 octants */
-        hal_graphics_set_pixel(center->x + x, center->y + y, mode);
-        hal_graphics_set_pixel(center->x - x, center->y + y, mode);
-        hal_graphics_set_pixel(center->x + x, center->y - y, mode);
-        hal_graphics_set_pixel(center->x - x, center->y - y, mode);
-        hal_graphics_set_pixel(center->x + y, center->y + x, mode);
-        hal_graphics_set_pixel(center->x - y, center->y + x, mode);
-        hal_graphics_set_pixel(center->x + y, center->y - x, mode);
-        hal_graphics_set_pixel(center->x - y, center->y - x, mode);
-
-        if (d < 0) {
-            d = d + 4 * x + 6;
-        } else {
-            d = d + 4 * (x - y) + 10;
-            y--;
-        }
-        x++;
-    }
-
+    raster_round_outline(center->x, center->y, center->x, center->y, radius, mode);
     return HAL_OK;
 }
 
@@ -367,405 +851,2371 @@ hal_result_t hal_graphics_fill_circle(const hal_point_t *center, uint16_t radius
         return HAL_ERROR_INVALID_PARAM;
     }
 
-    /* Fill circle by drawing horizontal lines */
-    for (int16_t y = -radius; y <= radius; y++) {
-        int16_t x_max = (int16_t)sqrt(radius * radius - y * y);
-        for (int16_t x = -x_max; x <= x_max; x++) {
-            hal_graphics_set_pixel(center->x + x, center->y + y, mode);
-        }
-    }
-
+    raster_round_fill(center->x, center->y, center->x, center->y, radius, mode);
     return HAL_OK;
 }
 
-hal_result_t hal_graphics_draw_text(const char *text, const hal_point_t *position, 
-                                    hal_font_size_t font_size, hal_graphics_mode_t mode)
+hal_result_t hal_graphics_draw_round_rect(const hal_rect_t *rect, uint16_t radius, hal_graphics_mode_t mode)
 {
     if (!display_initialized) {
         return HAL_ERROR_NOT_INITIALIZED;
     }
 
-    if (!text || !position || font_size >= HAL_FONT_SIZE_MAX || mode >= HAL_GRAPHICS_MODE_MAX) {
+    if (!rect || mode >= HAL_GRAPHICS_MODE_MAX) {
         return HAL_ERROR_INVALID_PARAM;
     }
 
-    const font_info_t *font = &fonts[font_size];
-    int16_t x = position->x;
-    int16_t y = position->y;
+    if (rect->width == 0 || rect->height == 0) {
+        return HAL_OK;
+    }
 
-    /* Simple text rendering - just draw rectangles for now */
-    /* In a real implementation, this would use actual font data */
-    while (*text) {
-        if (*text >= 32 && *text <= 126) {
-            hal_rect_t char_rect = {
-                .x = x,
-                .y = y,
-                .width = font->width,
-                .height = font->height
-            };
-            hal_graphics_draw_rect(&char_rect, mode);
-        }
-        
-        x += font->width + 1;
-        if (x >= DISPLAY_WIDTH) {
-            x = position->x;
-            y += font->height + 1;
-        }
-        
-        text++;
+    int32_t r = raster_clamp_radius(rect, radius);
+    if (r == 0) {
+        return hal_graphics_draw_rect(rect, mode);
     }
 
+    raster_round_outline(rect->x + r, rect->y + r,
+                         rect->x + rect->width - 1 - r, rect->y + rect->height - 1 - r, r, mode);
     return HAL_OK;
 }
 
-hal_result_t hal_graphics_draw_bitmap(const uint8_t *bitmap, const hal_point_t *position,
-                                      uint16_t width, uint16_t height, hal_graphics_mode_t mode)
+hal_result_t hal_graphics_fill_round_rect(const hal_rect_t *rect, uint16_t radius, hal_graphics_mode_t mode)
 {
     if (!display_initialized) {
         return HAL_ERROR_NOT_INITIALIZED;
     }
 
-    if (!bitmap || !position || mode >= HAL_GRAPHICS_MODE_MAX) {
+    if (!rect || mode >= HAL_GRAPHICS_MODE_MAX) {
         return HAL_ERROR_INVALID_PARAM;
     }
 
-    /* Draw bitmap pixel by pixel */
-    for (uint16_t y = 0; y < height; y++) {
-        for (uint16_t x = 0; x < width; x++) {
-            uint32_t byte_index = (y * width + x) / 8;
-            uint8_t bit_index = (y * width + x) % 8;
-            
-            if (bitmap[byte_index] & (1 << bit_index)) {
-                hal_graphics_set_pixel(position->x + x, position->y + y, mode);
-            }
-        }
+    if (rect->width == 0 || rect->height == 0) {
+        return HAL_OK;
     }
 
+    int32_t r = raster_clamp_radius(rect, radius);
+    raster_round_fill(rect->x + r, rect->y + r,
+                      rect->x + rect->width - 1 - r, rect->y + rect->height - 1 - r, r, mode);
     return HAL_OK;
 }
 
-/* Input Functions Implementation */
-
-hal_result_t hal_input_init(void)
+hal_result_t hal_graphics_draw_ellipse(const hal_point_t *center, uint16_t radius_x, uint16_t radius_y,
+                                       hal_graphics_mode_t mode)
 {
-    if (input_initialized) {
-        return HAL_OK;
+    if (!display_initialized) {
+        return HAL_ERROR_NOT_INITIALIZED;
     }
 
-    /* Initialize button states */
-    for (int i = 0; i < HAL_INPUT_BUTTON_MAX; i++) {
-        button_states[i] = HAL_INPUT_STATE_RELEASED;
-        prev_button_states[i] = HAL_INPUT_STATE_RELEASED;
-        button_press_times[i] = 0;
+    if (!center || mode >= HAL_GRAPHICS_MODE_MAX) {
+        return HAL_ERROR_INVALID_PARAM;
     }
 
-    input_callback = NULL;
-    input_callback_user_data = NULL;
-
-    input_initialized = true;
+    raster_ellipse(center->x, center->y, radius_x, radius_y, false, mode);
     return HAL_OK;
 }
 
-hal_result_t hal_input_deinit(void)
+hal_result_t hal_graphics_fill_ellipse(const hal_point_t *center, uint16_t radius_x, uint16_t radius_y,
+                                       hal_graphics_mode_t mode)
 {
-    if (!input_initialized) {
+    if (!display_initialized) {
         return HAL_ERROR_NOT_INITIALIZED;
     }
 
-    input_callback = NULL;
-    input_callback_user_data = NULL;
-    input_initialized = false;
+    if (!center || mode >= HAL_GRAPHICS_MODE_MAX) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    raster_ellipse(center->x, center->y, radius_x, radius_y, true, mode);
     return HAL_OK;
 }
 
-hal_result_t hal_input_get_button_state(hal_input_button_t button, hal_input_state_t *state)
+hal_result_t hal_graphics_draw_arc(const hal_point_t *center, uint16_t radius, int16_t start_angle,
+                                   uint16_t sweep_angle, hal_graphics_mode_t mode)
 {
-    if (!input_initialized) {
+    if (!display_initialized) {
         return HAL_ERROR_NOT_INITIALIZED;
     }
 
-    if (button >= HAL_INPUT_BUTTON_MAX || !state) {
+    if (!center || mode >= HAL_GRAPHICS_MODE_MAX) {
         return HAL_ERROR_INVALID_PARAM;
     }
 
-    *state = button_states[button];
+    if (sweep_angle >= 360) {
+        raster_round_outline(center->x, center->y, center->x, center->y, radius, mode);
+        return HAL_OK;
+    }
+
+    if (sweep_angle == 0) {
+        return HAL_OK;
+    }
+
+    raster_arc(center->x, center->y, radius, start_angle, sweep_angle, mode);
     return HAL_OK;
 }
 
-hal_result_t hal_input_get_all_states(hal_input_state_t *states)
+hal_result_t hal_graphics_draw_text(const char *text, const hal_point_t *position, 
+                                    hal_font_size_t font_size, hal_graphics_mode_t mode)
 {
-    if (!input_initialized) {
+    if (!display_initialized) {
         return HAL_ERROR_NOT_INITIALIZED;
     }
 
-    if (!states) {
+    if (font_size >= HAL_FONT_SIZE_MAX) {
         return HAL_ERROR_INVALID_PARAM;
     }
 
-    memcpy(states, button_states, sizeof(button_states));
+    return hal_graphics_draw_text_font(text, position, fonts[font_size], mode);
+}
+
+hal_result_t hal_graphics_draw_text_font(const char *text, const hal_point_t *position,
+                                         const hal_font_t *font, hal_graphics_mode_t mode)
+{
+    if (!display_initialized) {
+        return HAL_ERROR_NOT_INITIALIZED;
+    }
+
+    if (!text || !position || !font || mode >= HAL_GRAPHICS_MODE_MAX) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    int32_t x = position->x;
+    int32_t y = position->y;
+    uint8_t prev = 0;
+
+    while (*text && y < draw_height) {
+        if (*text == '\n') {
+            x = position->x;
+            y += font->height;
+            prev = 0;
+            text++;
+            continue;
+        }
+
+        uint8_t code;
+        const hal_font_glyph_t *glyph = font_find_glyph(font, *text, &code);
+
+        if (prev != 0) {
+            x += font_kerning(font, prev, code);
+        }
+
+        /* Wrap before a glyph that would cross the right edge */
+        if (x + glyph->width > draw_width && x > position->x) {
+            x = position->x;
+            y += font->height;
+            if (y >= draw_height) {
+                break;
+            }
+        }
+
+        if (glyph->width > 0) {
+            raster_blit_pages(&font->bitmap[glyph->offset], glyph->width, x, y,
+                              glyph->width, font->height, mode);
+        }
+
+        x += glyph->advance;
+        prev = code;
+        text++;
+    }
+
     return HAL_OK;
 }
 
-hal_result_t hal_input_register_callback(hal_input_event_callback_t callback, void *user_data)
+hal_result_t hal_graphics_draw_bitmap(const uint8_t *bitmap, const hal_point_t *position,
+                                      uint16_t width, uint16_t height, hal_graphics_mode_t mode)
 {
-    if (!input_initialized) {
+    if (!display_initialized) {
         return HAL_ERROR_NOT_INITIALIZED;
     }
 
-    if (!callback) {
+    if (!bitmap || !position || mode >= HAL_GRAPHICS_MODE_MAX) {
         return HAL_ERROR_INVALID_PARAM;
     }
 
-    input_callback = callback;
-    input_callback_user_data = user_data;
+    /* Packed row-major stream: the row stride is exactly width bits */
+    blit_source_t source;
+    blit_source_init(&source, HAL_BITMAP_FORMAT_ROW_MAJOR, bitmap, 0, 0, width, height);
+    source.stride = width;
+
+    raster_blit(&source, NULL, position->x, position->y, raster_blit_mode(mode));
+
     return HAL_OK;
 }
 
-hal_result_t hal_input_unregister_callback(void)
+hal_result_t hal_graphics_blit(const hal_bitmap_t *bitmap, const hal_point_t *position, hal_blit_mode_t mode)
 {
-    if (!input_initialized) {
+    if (!display_initialized) {
         return HAL_ERROR_NOT_INITIALIZED;
     }
 
-    input_callback = NULL;
-    input_callback_user_data = NULL;
+    if (!bitmap || !position || !bitmap->data || bitmap->format >= HAL_BITMAP_FORMAT_MAX ||
+        mode >= HAL_BLIT_MODE_MAX) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    if (mode == HAL_BLIT_MODE_MASK && !bitmap->mask) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    blit_source_t data;
+    blit_source_t mask;
+
+    blit_source_init(&data, bitmap->format, bitmap->data, bitmap->data_size, bitmap->stride,
+                     bitmap->width, bitmap->height);
+
+    if (mode == HAL_BLIT_MODE_MASK) {
+        blit_source_init(&mask, bitmap->format, bitmap->mask, bitmap->mask_size, bitmap->stride,
+                         bitmap->width, bitmap->height);
+        raster_blit(&data, &mask, position->x, position->y, mode);
+    } else {
+        raster_blit(&data, NULL, position->x, position->y, mode);
+    }
+
     return HAL_OK;
 }
 
-hal_result_t hal_input_process_events(void)
+hal_result_t hal_graphics_set_gray_level(uint8_t level)
 {
-    if (!input_initialized) {
+    if (!display_initialized) {
         return HAL_ERROR_NOT_INITIALIZED;
     }
 
-    /* Read current hardware states */
-    input_read_hardware_states();
+    if (gray_bits == 0) {
+        return HAL_ERROR_NOT_SUPPORTED;
+    }
 
-    uint32_t current_time = get_system_time_ms();
+    if (level >= (1U << gray_bits)) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
 
-    /* Process each button */
-    for (int i = 0; i < HAL_INPUT_BUTTON_MAX; i++) {
-        hal_input_state_t current_state = button_states[i];
-        hal_input_state_t prev_state = prev_button_states[i];
+    gray_level = level;
+    return HAL_OK;
+}
 
-        /* Detect state changes */
-        if (current_state != prev_state) {
-            if (current_state == HAL_INPUT_STATE_PRESSED && prev_state == HAL_INPUT_STATE_RELEASED) {
-                /* Button press event */
-                button_press_times[i] = current_time;
-                
-                if (input_callback) {
-                    hal_input_event_data_t event = {
-                        .button = (hal_input_button_t)i,
-                        .event = HAL_INPUT_EVENT_PRESS,
-                        .state = current_state,
-                        .timestamp = current_time,
-                        .duration = 0
-                    };
-                    input_callback(&event, input_callback_user_data);
-                }
-            } else if (current_state == HAL_INPUT_STATE_RELEASED && prev_state == HAL_INPUT_STATE_PRESSED) {
-                /* Button release event */
-                uint32_t duration = current_time - button_press_times[i];
-                
-                if (input_callback) {
-                    hal_input_event_data_t event = {
-                        .button = (hal_input_button_t)i,
-                        .event = HAL_INPUT_EVENT_RELEASE,
-                        .state = current_state,
-                        .timestamp = current_time,
-                        .duration = duration
-                    };
-                    input_callback(&event, input_callback_user_data);
+hal_result_t hal_graphics_draw_gray(const hal_gray_image_t *image, const hal_point_t *position,
+                                    hal_dither_t dither)
+{
+    if (!display_initialized) {
+        return HAL_ERROR_NOT_INITIALIZED;
+    }
+
+    if (!image || !image->pixels || !position || dither >= HAL_DITHER_MAX) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    int32_t x = position->x;
+    int32_t y = position->y;
+    int32_t col0 = (x < clip_left) ? clip_left - x : 0;
+    int32_t col1 = (x + image->width > clip_right) ? clip_right - x : image->width;
+    int32_t row0 = (y < clip_top) ? clip_top - y : 0;
+    int32_t row1 = (y + image->height > clip_bottom) ? clip_bottom - y : image->height;
+
+    if (col0 >= col1 || row0 >= row1) {
+        return HAL_OK;
+    }
+
+    uint8_t *targets[DISPLAY_MAX_TARGETS];
+    uint32_t target_count = raster_targets(targets);
+    uint32_t stride = image->stride ? image->stride : image->width;
+    int32_t top_level = (int32_t)((1U << target_count) - 1U);
+    uint32_t count = (uint32_t)(col1 - col0);
+
+    /* Error diffusion covers the visible part only, as if it were cropped */
+    memset(dither_errors, 0, sizeof(dither_errors));
+
+    for (int32_t row = row0; row < row1; row++) {
+        const uint8_t *src = &image->pixels[(uint32_t)row * stride];
+        int16_t *err = &dither_errors[row & 1][1];
+        int16_t *next = &dither_errors[(row + 1) & 1][1];
+        int32_t dy = y + row;
+        uint32_t offset = ((uint32_t)dy >> 3) * (uint32_t)draw_stride + (uint32_t)(x + col0);
+        uint8_t bit = (uint8_t)(1U << (dy & 7));
+
+        if (dither == HAL_DITHER_FLOYD_STEINBERG) {
+            memset(next - 1, 0, (count + 2) * sizeof(int16_t));
+        }
+
+        for (uint32_t i = 0; i < count; i++) {
+            int32_t col = col0 + (int32_t)i;
+            int32_t ink = 255 - src[col];
+            int32_t level;
+
+            switch (dither) {
+                case HAL_DITHER_ORDERED:
+                    level = (ink * top_level + dither_bias[row & 7][col & 7]) / 255;
+                    break;
+
+                case HAL_DITHER_FLOYD_STEINBERG: {
+                    int32_t value = ink + err[i];
+                    if (value <= 0) {
+                        level = 0;
+                    } else if (value >= 255) {
+                        level = top_level;
+                    } else {
+                        level = (value * top_level + 127) / 255;
+                    }
+
+                    /* 7/16 right, 3/16, 5/16, 1/16 below; the last share takes the remainder */
+                    int32_t error = value - level * 255 / top_level;
+                    int32_t e7 = error * 7 / 16;
+                    int32_t e3 = error * 3 / 16;
+                    int32_t e5 = error * 5 / 16;
+                    err[i + 1] = (int16_t)(err[i + 1] + e7);
+                    next[(int32_t)i - 1] = (int16_t)(next[(int32_t)i - 1] + e3);
+                    next[i] = (int16_t)(next[i] + e5);
+                    next[i + 1] = (int16_t)(next[i + 1] + (error - e7 - e3 - e5));
+                    break;
                 }
+
+                case HAL_DITHER_NONE:
+                default:
+                    level = (ink * top_level + 127) / 255;
+                    break;
             }
-        } else if (current_state == HAL_INPUT_STATE_PRESSED) {
-            /* Check for hold events */
-            uint32_t duration = current_time - button_press_times[i];
-            
-            if (duration >= INPUT_HOLD_TIME_MS && prev_state == HAL_INPUT_STATE_PRESSED) {
-                button_states[i] = HAL_INPUT_STATE_HELD;
-                
-                if (input_callback) {
-                    hal_input_event_data_t event = {
-                        .button = (hal_input_button_t)i,
-                        .event = HAL_INPUT_EVENT_HOLD,
-                        .state = HAL_INPUT_STATE_HELD,
-                        .timestamp = current_time,
-                        .duration = duration
-                    };
-                    input_callback(&event, input_callback_user_data);
+
+            for (uint32_t t = 0; t < target_count; t++) {
+                uint8_t *byte = &targets[t][offset + i];
+                if ((level >> t) & 1) {
+                    *byte |= bit;
+                } else {
+                    *byte &= (uint8_t)~bit;
                 }
             }
         }
-
-        prev_button_states[i] = button_states[i];
     }
 
     return HAL_OK;
 }
 
-/* Utility Functions Implementation */
+/* Canvas Functions Implementation */
 
-uint8_t hal_graphics_get_char_width(hal_font_size_t font_size)
+hal_result_t hal_canvas_init(hal_canvas_t *canvas, uint8_t *buffer, uint16_t width, uint16_t height,
+                             uint16_t stride)
 {
-    if (font_size >= HAL_FONT_SIZE_MAX) {
-        return 0;
+    if (!canvas || !buffer) {
+        return HAL_ERROR_INVALID_PARAM;
     }
-    return fonts[font_size].width;
-}
 
-uint8_t hal_graphics_get_char_height(hal_font_size_t font_size)
-{
-    if (font_size >= HAL_FONT_SIZE_MAX) {
-        return 0;
-    }
-    return fonts[font_size].height;
+    canvas->buffer = buffer;
+    canvas->width = width;
+    canvas->height = height;
+    canvas->stride = stride ? stride : width;
+    canvas->clip.x = 0;
+    canvas->clip.y = 0;
+    canvas->clip.width = width;
+    canvas->clip.height = height;
+
+    return canvas_valid(canvas) ? HAL_OK : HAL_ERROR_INVALID_PARAM;
 }
 
-uint16_t hal_graphics_get_text_width(const char *text, hal_font_size_t font_size)
+hal_result_t hal_canvas_clear(hal_canvas_t *canvas)
 {
-    if (!text || font_size >= HAL_FONT_SIZE_MAX) {
-        return 0;
+    if (!canvas) {
+        return hal_display_clear();
     }
 
-    uint16_t width = 0;
-    uint8_t char_width = fonts[font_size].width;
-    
-    while (*text) {
-        if (width > 0) {
-            width += 1; /* Character spacing */
-        }
-        width += char_width;
-        text++;
+    if (!canvas_valid(canvas)) {
+        return HAL_ERROR_INVALID_PARAM;
     }
 
-    return width;
+    memset(canvas->buffer, 0, (uint32_t)canvas->stride * (((uint32_t)canvas->height + 7U) >> 3));
+    return HAL_OK;
 }
 
-const char *hal_input_button_to_string(hal_input_button_t button)
+hal_result_t hal_canvas_set_clip(hal_canvas_t *canvas, const hal_rect_t *rect)
 {
-    static const char *button_names[] = {
-        [HAL_INPUT_BUTTON_UP] = "UP",
-        [HAL_INPUT_BUTTON_DOWN] = "DOWN",
-        [HAL_INPUT_BUTTON_LEFT] = "LEFT",
-        [HAL_INPUT_BUTTON_RIGHT] = "RIGHT",
-        [HAL_INPUT_BUTTON_OK] = "OK",
-        [HAL_INPUT_BUTTON_BACK] = "BACK"
-    };
+    if (!canvas) {
+        return hal_graphics_set_clip(rect);
+    }
 
-    if (button >= HAL_INPUT_BUTTON_MAX) {
-        return "UNKNOWN";
+    if (!canvas_valid(canvas)) {
+        return HAL_ERROR_INVALID_PARAM;
     }
 
-    return button_names[button];
+    if (rect) {
+        canvas->clip = *rect;
+    } else {
+        canvas->clip.x = 0;
+        canvas->clip.y = 0;
+        canvas->clip.width = canvas->width;
+        canvas->clip.height = canvas->height;
+    }
+
+    return HAL_OK;
 }
 
-const char *hal_input_event_to_string(hal_input_event_t event)
+hal_result_t hal_canvas_set_pixel(hal_canvas_t *canvas, int16_t x, int16_t y, hal_graphics_mode_t mode)
 {
-    static const char *event_names[] = {
-        [HAL_INPUT_EVENT_PRESS] = "PRESS",
-        [HAL_INPUT_EVENT_RELEASE] = "RELEASE",
-        [HAL_INPUT_EVENT_HOLD] = "HOLD",
-        [HAL_INPUT_EVENT_REPEAT] = "REPEAT"
-    };
-
-    if (event >= HAL_INPUT_EVENT_MAX) {
-        return "UNKNOWN";
+    raster_binding_t saved;
+    hal_result_t result = canvas_bind(canvas, &saved);
+    if (result != HAL_OK) {
+        return result;
     }
 
-    return event_names[event];
+    result = hal_graphics_set_pixel(x, y, mode);
+    canvas_unbind(&saved);
+    return result;
 }
 
-/* Private Functions Implementation */
-
-static hal_result_t display_hardware_init(void)
+hal_result_t hal_canvas_draw_line(hal_canvas_t *canvas, int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                                  hal_graphics_mode_t mode)
 {
-    /* Hardware-specific initialization would go here */
-    /* This is a stub implementation for the FlipperZero display */
-    
-    /* Initialize SPI interface for display */
-    /* Configure GPIO pins for CS, DC, RST */
-    /* Send initialization sequence to display controller */
-    
-    return HAL_OK;
+    raster_binding_t saved;
+    hal_result_t result = canvas_bind(canvas, &saved);
+    if (result != HAL_OK) {
+        return result;
+    }
+
+    result = hal_graphics_draw_line(x0, y0, x1, y1, mode);
+    canvas_unbind(&saved);
+    return result;
 }
 
-static hal_result_t display_hardware_deinit(void)
+hal_result_t hal_canvas_draw_rect(hal_canvas_t *canvas, const hal_rect_t *rect, hal_graphics_mode_t mode)
 {
-    /* Hardware-specific deinitialization would go here */
-    /* Turn off display, release GPIO pins, etc. */
-    
-    return HAL_OK;
+    raster_binding_t saved;
+    hal_result_t result = canvas_bind(canvas, &saved);
+    if (result != HAL_OK) {
+        return result;
+    }
+
+    result = hal_graphics_draw_rect(rect, mode);
+    canvas_unbind(&saved);
+    return result;
 }
 
-static hal_result_t display_send_command(uint8_t cmd)
+hal_result_t hal_canvas_fill_rect(hal_canvas_t *canvas, const hal_rect_t *rect, hal_graphics_mode_t mode)
 {
-    /* Hardware-specific command sending would go here */
-    /* Set DC pin low, send command via SPI */
-    
-    (void)cmd; /* Suppress unused parameter warning */
-    return HAL_OK;
+    raster_binding_t saved;
+    hal_result_t result = canvas_bind(canvas, &saved);
+    if (result != HAL_OK) {
+        return result;
+    }
+
+    result = hal_graphics_fill_rect(rect, mode);
+    canvas_unbind(&saved);
+    return result;
 }
 
-static hal_result_t display_send_data(const uint8_t *data, uint32_t size)
+hal_result_t hal_canvas_draw_circle(hal_canvas_t *canvas, const hal_point_t *center, uint16_t radius,
+                                    hal_graphics_mode_t mode)
 {
-    /* Hardware-specific data sending would go here */
-    /* Set DC pin high, send data via SPI */
-    
-    (void)data;
-    (void)size;
-    return HAL_OK;
+    raster_binding_t saved;
+    hal_result_t result = canvas_bind(canvas, &saved);
+    if (result != HAL_OK) {
+        return result;
+    }
+
+    result = hal_graphics_draw_circle(center, radius, mode);
+    canvas_unbind(&saved);
+    return result;
 }
 
-static void input_read_hardware_states(void)
+hal_result_t hal_canvas_fill_circle(hal_canvas_t *canvas, const hal_point_t *center, uint16_t radius,
+                                    hal_graphics_mode_t mode)
 {
-    /* Hardware-specific button reading would go here */
-    /* Read GPIO pins for each button and update button_states array */
-    
-    /* For now, this is a stub implementation */
-    /* In a real implementation, this would read the actual hardware pins */
-    
-    /* Example stub code - buttons are always released */
-    for (int i = 0; i < HAL_INPUT_BUTTON_MAX; i++) {
-        button_states[i] = HAL_INPUT_STATE_RELEASED;
+    raster_binding_t saved;
+    hal_result_t result = canvas_bind(canvas, &saved);
+    if (result != HAL_OK) {
+        return result;
+    }
+
+    result = hal_graphics_fill_circle(center, radius, mode);
+    canvas_unbind(&saved);
+    return result;
+}
+
+hal_result_t hal_canvas_draw_round_rect(hal_canvas_t *canvas, const hal_rect_t *rect, uint16_t radius,
+                                        hal_graphics_mode_t mode)
+{
+    raster_binding_t saved;
+    hal_result_t result = canvas_bind(canvas, &saved);
+    if (result != HAL_OK) {
+        return result;
+    }
+
+    result = hal_graphics_draw_round_rect(rect, radius, mode);
+    canvas_unbind(&saved);
+    return result;
+}
+
+hal_result_t hal_canvas_fill_round_rect(hal_canvas_t *canvas, const hal_rect_t *rect, uint16_t radius,
+                                        hal_graphics_mode_t mode)
+{
+    raster_binding_t saved;
+    hal_result_t result = canvas_bind(canvas, &saved);
+    if (result != HAL_OK) {
+        return result;
+    }
+
+    result = hal_graphics_fill_round_rect(rect, radius, mode);
+    canvas_unbind(&saved);
+    return result;
+}
+
+hal_result_t hal_canvas_draw_ellipse(hal_canvas_t *canvas, const hal_point_t *center, uint16_t radius_x,
+                                     uint16_t radius_y, hal_graphics_mode_t mode)
+{
+    raster_binding_t saved;
+    hal_result_t result = canvas_bind(canvas, &saved);
+    if (result != HAL_OK) {
+        return result;
+    }
+
+    result = hal_graphics_draw_ellipse(center, radius_x, radius_y, mode);
+    canvas_unbind(&saved);
+    return result;
+}
+
+hal_result_t hal_canvas_fill_ellipse(hal_canvas_t *canvas, const hal_point_t *center, uint16_t radius_x,
+                                     uint16_t radius_y, hal_graphics_mode_t mode)
+{
+    raster_binding_t saved;
+    hal_result_t result = canvas_bind(canvas, &saved);
+    if (result != HAL_OK) {
+        return result;
+    }
+
+    result = hal_graphics_fill_ellipse(center, radius_x, radius_y, mode);
+    canvas_unbind(&saved);
+    return result;
+}
+
+hal_result_t hal_canvas_draw_arc(hal_canvas_t *canvas, const hal_point_t *center, uint16_t radius,
+                                 int16_t start_angle, uint16_t sweep_angle, hal_graphics_mode_t mode)
+{
+    raster_binding_t saved;
+    hal_result_t result = canvas_bind(canvas, &saved);
+    if (result != HAL_OK) {
+        return result;
+    }
+
+    result = hal_graphics_draw_arc(center, radius, start_angle, sweep_angle, mode);
+    canvas_unbind(&saved);
+    return result;
+}
+
+hal_result_t hal_canvas_draw_text(hal_canvas_t *canvas, const char *text, const hal_point_t *position,
+                                  hal_font_size_t font_size, hal_graphics_mode_t mode)
+{
+    raster_binding_t saved;
+    hal_result_t result = canvas_bind(canvas, &saved);
+    if (result != HAL_OK) {
+        return result;
+    }
+
+    result = hal_graphics_draw_text(text, position, font_size, mode);
+    canvas_unbind(&saved);
+    return result;
+}
+
+hal_result_t hal_canvas_draw_text_font(hal_canvas_t *canvas, const char *text, const hal_point_t *position,
+                                       const hal_font_t *font, hal_graphics_mode_t mode)
+{
+    raster_binding_t saved;
+    hal_result_t result = canvas_bind(canvas, &saved);
+    if (result != HAL_OK) {
+        return result;
+    }
+
+    result = hal_graphics_draw_text_font(text, position, font, mode);
+    canvas_unbind(&saved);
+    return result;
+}
+
+hal_result_t hal_canvas_draw_bitmap(hal_canvas_t *canvas, const uint8_t *bitmap, const hal_point_t *position,
+                                    uint16_t width, uint16_t height, hal_graphics_mode_t mode)
+{
+    raster_binding_t saved;
+    hal_result_t result = canvas_bind(canvas, &saved);
+    if (result != HAL_OK) {
+        return result;
+    }
+
+    result = hal_graphics_draw_bitmap(bitmap, position, width, height, mode);
+    canvas_unbind(&saved);
+    return result;
+}
+
+hal_result_t hal_canvas_blit(hal_canvas_t *canvas, const hal_bitmap_t *bitmap, const hal_point_t *position,
+                             hal_blit_mode_t mode)
+{
+    raster_binding_t saved;
+    hal_result_t result = canvas_bind(canvas, &saved);
+    if (result != HAL_OK) {
+        return result;
+    }
+
+    result = hal_graphics_blit(bitmap, position, mode);
+    canvas_unbind(&saved);
+    return result;
+}
+
+hal_result_t hal_canvas_draw_gray(hal_canvas_t *canvas, const hal_gray_image_t *image,
+                                  const hal_point_t *position, hal_dither_t dither)
+{
+    raster_binding_t saved;
+    hal_result_t result = canvas_bind(canvas, &saved);
+    if (result != HAL_OK) {
+        return result;
+    }
+
+    result = hal_graphics_draw_gray(image, position, dither);
+    canvas_unbind(&saved);
+    return result;
+}
+
+hal_result_t hal_canvas_composite(hal_canvas_t *dst, const hal_canvas_t *src, const hal_rect_t *src_rect,
+                                  const hal_canvas_t *mask, const hal_point_t *position, hal_blit_mode_t mode)
+{
+    if (!display_initialized) {
+        return HAL_ERROR_NOT_INITIALIZED;
+    }
+
+    if (!canvas_valid(src) || !position || mode >= HAL_BLIT_MODE_MAX) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    if (mode == HAL_BLIT_MODE_MASK &&
+        (!canvas_valid(mask) || mask->width != src->width || mask->height != src->height)) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    hal_rect_t whole = { 0, 0, src->width, src->height };
+    int32_t x0, y0, x1, y1;
+
+    if (!src_rect) {
+        src_rect = &whole;
+    }
+    if (!raster_clip_rect(src_rect, src->width, src->height, &x0, &y0, &x1, &y1)) {
+        return HAL_OK;
+    }
+
+    raster_binding_t saved;
+    hal_result_t result = canvas_bind(dst, &saved);
+    if (result != HAL_OK) {
+        return result;
+    }
+
+    /* Where the visible part of the source area lands */
+    int32_t dx = position->x + (x0 - src_rect->x);
+    int32_t dy = position->y + (y0 - src_rect->y);
+    int32_t width = x1 - x0 + 1;
+    int32_t height = y1 - y0 + 1;
+
+    /*
+     * The blitter reads whole source pages, so start at the page holding
+     * the first row and narrow the clip to drop the rows above it.
+     */
+    int32_t page = y0 >> 3;
+    int32_t skew = y0 & 7;
+
+    if (clip_left < dx) {
+        clip_left = dx;
+    }
+    if (clip_top < dy) {
+        clip_top = dy;
+    }
+    if (clip_right > dx + width) {
+        clip_right = dx + width;
+    }
+    if (clip_bottom > dy + height) {
+        clip_bottom = dy + height;
+    }
+
+    if (clip_left < clip_right && clip_top < clip_bottom) {
+        blit_source_t data;
+        blit_source_t mask_source;
+
+        blit_source_init(&data, HAL_BITMAP_FORMAT_PAGE_MAJOR, &src->buffer[(uint32_t)page * src->stride + x0],
+                         0, src->stride, (uint32_t)width, (uint32_t)(height + skew));
+
+        if (mode == HAL_BLIT_MODE_MASK) {
+            blit_source_init(&mask_source, HAL_BITMAP_FORMAT_PAGE_MAJOR,
+                             &mask->buffer[(uint32_t)page * mask->stride + x0], 0, mask->stride,
+                             (uint32_t)width, (uint32_t)(height + skew));
+            raster_blit(&data, &mask_source, dx, dy - skew, mode);
+        } else {
+            raster_blit(&data, NULL, dx, dy - skew, mode);
+        }
+    }
+
+    canvas_unbind(&saved);
+    return HAL_OK;
+}
+
+/* Input Functions Implementation */
+
+hal_result_t hal_input_init(void)
+{
+    if (input_initialized) {
+        return HAL_OK;
+    }
+
+    /* Initialize button states */
+    for (int i = 0; i < HAL_INPUT_BUTTON_MAX; i++) {
+        button_states[i] = HAL_INPUT_STATE_RELEASED;
+        prev_button_states[i] = HAL_INPUT_STATE_RELEASED;
+        button_press_times[i] = 0;
+    }
+
+    input_callback = NULL;
+    input_callback_user_data = NULL;
+
+    input_initialized = true;
+    return HAL_OK;
+}
+
+hal_result_t hal_input_deinit(void)
+{
+    if (!input_initialized) {
+        return HAL_ERROR_NOT_INITIALIZED;
+    }
+
+    input_callback = NULL;
+    input_callback_user_data = NULL;
+    input_initialized = false;
+    return HAL_OK;
+}
+
+hal_result_t hal_input_get_button_state(hal_input_button_t button, hal_input_state_t *state)
+{
+    if (!input_initialized) {
+        return HAL_ERROR_NOT_INITIALIZED;
+    }
+
+    if (button >= HAL_INPUT_BUTTON_MAX || !state) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    *state = button_states[button];
+    return HAL_OK;
+}
+
+hal_result_t hal_input_get_all_states(hal_input_state_t *states)
+{
+    if (!input_initialized) {
+        return HAL_ERROR_NOT_INITIALIZED;
+    }
+
+    if (!states) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    memcpy(states, button_states, sizeof(button_states));
+    return HAL_OK;
+}
+
+hal_result_t hal_input_register_callback(hal_input_event_callback_t callback, void *user_data)
+{
+    if (!input_initialized) {
+        return HAL_ERROR_NOT_INITIALIZED;
+    }
+
+    if (!callback) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    input_callback = callback;
+    input_callback_user_data = user_data;
+    return HAL_OK;
+}
+
+hal_result_t hal_input_unregister_callback(void)
+{
+    if (!input_initialized) {
+        return HAL_ERROR_NOT_INITIALIZED;
+    }
+
+    input_callback = NULL;
+    input_callback_user_data = NULL;
+    return HAL_OK;
+}
+
+hal_result_t hal_input_process_events(void)
+{
+    if (!input_initialized) {
+        return HAL_ERROR_NOT_INITIALIZED;
+    }
+
+    /* Read current hardware states */
+    input_read_hardware_states();
+
+    uint32_t current_time = get_system_time_ms();
+
+    /* Process each button */
+    for (int i = 0; i < HAL_INPUT_BUTTON_MAX; i++) {
+        hal_input_state_t current_state = button_states[i];
+        hal_input_state_t prev_state = prev_button_states[i];
+
+        /* Detect state changes */
+        if (current_state != prev_state) {
+            if (current_state == HAL_INPUT_STATE_PRESSED && prev_state == HAL_INPUT_STATE_RELEASED) {
+                /* Button press event */
+                button_press_times[i] = current_time;
+                
+                if (input_callback) {
+                    hal_input_event_data_t event = {
+                        .button = (hal_input_button_t)i,
+                        .event = HAL_INPUT_EVENT_PRESS,
+                        .state = current_state,
+                        .timestamp = current_time,
+                        .duration = 0
+                    };
+                    input_callback(&event, input_callback_user_data);
+                }
+            } else if (current_state == HAL_INPUT_STATE_RELEASED && prev_state == HAL_INPUT_STATE_PRESSED) {
+                /* Button release event */
+                uint32_t duration = current_time - button_press_times[i];
+                
+                if (input_callback) {
+                    hal_input_event_data_t event = {
+                        .button = (hal_input_button_t)i,
+                        .event = HAL_INPUT_EVENT_RELEASE,
+                        .state = current_state,
+                        .timestamp = current_time,
+                        .duration = duration
+                    };
+                    input_callback(&event, input_callback_user_data);
+                }
+            }
+        } else if (current_state == HAL_INPUT_STATE_PRESSED) {
+            /* Check for hold events */
+            uint32_t duration = current_time - button_press_times[i];
+            
+            if (duration >= INPUT_HOLD_TIME_MS && prev_state == HAL_INPUT_STATE_PRESSED) {
+                button_states[i] = HAL_INPUT_STATE_HELD;
+                
+                if (input_callback) {
+                    hal_input_event_data_t event = {
+                        .button = (hal_input_button_t)i,
+                        .event = HAL_INPUT_EVENT_HOLD,
+                        .state = HAL_INPUT_STATE_HELD,
+                        .timestamp = current_time,
+                        .duration = duration
+                    };
+                    input_callback(&event, input_callback_user_data);
+                }
+            }
+        }
+
+        prev_button_states[i] = button_states[i];
+    }
+
+    return HAL_OK;
+}
+
+/* Utility Functions Implementation */
+
+uint8_t hal_graphics_get_char_width(hal_font_size_t font_size)
+{
+    if (font_size >= HAL_FONT_SIZE_MAX) {
+        return 0;
+    }
+    return fonts[font_size]->cell_width;
+}
+
+uint8_t hal_graphics_get_char_height(hal_font_size_t font_size)
+{
+    if (font_size >= HAL_FONT_SIZE_MAX) {
+        return 0;
+    }
+    return fonts[font_size]->height;
+}
+
+uint16_t hal_graphics_get_text_width(const char *text, hal_font_size_t font_size)
+{
+    if (font_size >= HAL_FONT_SIZE_MAX) {
+        return 0;
+    }
+    return hal_graphics_get_text_width_font(text, fonts[font_size]);
+}
+
+uint16_t hal_graphics_get_text_width_font(const char *text, const hal_font_t *font)
+{
+    if (!text || !font) {
+        return 0;
+    }
+
+    if (!(font->flags & HAL_FONT_FLAG_PROPORTIONAL)) {
+        return font_measure(text, font);
+    }
+
+    /* FNV-1a over the string; the length is part of the key as well */
+    uint32_t hash = 2166136261UL;
+    uint16_t length = 0;
+    for (const char *p = text; *p; p++) {
+        hash = (hash ^ (uint8_t)*p) * 16777619UL;
+        length++;
+    }
+
+    for (uint32_t i = 0; i < TEXT_WIDTH_CACHE_SIZE; i++) {
+        text_width_entry_t *entry = &text_width_cache[i];
+        if (entry->font == font && entry->hash == hash && entry->length == length) {
+            return entry->width;
+        }
+    }
+
+    text_width_entry_t *entry = &text_width_cache[text_width_cache_next];
+    text_width_cache_next = (uint8_t)((text_width_cache_next + 1) % TEXT_WIDTH_CACHE_SIZE);
+
+    entry->font = font;
+    entry->hash = hash;
+    entry->length = length;
+    entry->width = font_measure(text, font);
+
+    return entry->width;
+}
+
+const hal_font_t *hal_graphics_get_font(hal_font_size_t font_size)
+{
+    if (font_size >= HAL_FONT_SIZE_MAX) {
+        return NULL;
+    }
+    return fonts[font_size];
+}
+
+const char *hal_input_button_to_string(hal_input_button_t button)
+{
+    static const char *button_names[] = {
+        [HAL_INPUT_BUTTON_UP] = "UP",
+        [HAL_INPUT_BUTTON_DOWN] = "DOWN",
+        [HAL_INPUT_BUTTON_LEFT] = "LEFT",
+        [HAL_INPUT_BUTTON_RIGHT] = "RIGHT",
+        [HAL_INPUT_BUTTON_OK] = "OK",
+        [HAL_INPUT_BUTTON_BACK] = "BACK"
+    };
+
+    if (button >= HAL_INPUT_BUTTON_MAX) {
+        return "UNKNOWN";
+    }
+
+    return button_names[button];
+}
+
+const char *hal_input_event_to_string(hal_input_event_t event)
+{
+    static const char *event_names[] = {
+        [HAL_INPUT_EVENT_PRESS] = "PRESS",
+        [HAL_INPUT_EVENT_RELEASE] = "RELEASE",
+        [HAL_INPUT_EVENT_HOLD] = "HOLD",
+        [HAL_INPUT_EVENT_REPEAT] = "REPEAT"
+    };
+
+    if (event >= HAL_INPUT_EVENT_MAX) {
+        return "UNKNOWN";
+    }
+
+    return event_names[event];
+}
+
+/* Private Functions Implementation */
+
+static hal_result_t display_hardware_init(void)
+{
+    /* Hardware-specific initialization would go here */
+    /* This is a stub implementation for the FlipperZero display */
+    
+    /* Initialize SPI interface for display */
+    /* Configure GPIO pins for CS, DC, RST */
+    /* Send initialization sequence to display controller */
+    
+    return HAL_OK;
+}
+
+static hal_result_t display_hardware_deinit(void)
+{
+    /* Hardware-specific deinitialization would go here */
+    /* Turn off display, release GPIO pins, etc. */
+    
+    return HAL_OK;
+}
+
+static hal_result_t display_send_command(uint8_t cmd)
+{
+    /* Hardware-specific command sending would go here */
+    /* Set DC pin low, send command via SPI */
+    
+    (void)cmd; /* Suppress unused parameter warning */
+    return HAL_OK;
+}
+
+/**
+ * @brief Switch between MONO and the temporal grayscale formats
+ *
+ * Entering a grayscale format starts from blank planes; the refresh runs
+ * from hal_display_gray_tick(). Support has been checked by the caller.
+ */
+static hal_result_t display_set_format(hal_display_format_t format)
+{
+    uint8_t bits = 0;
+
+    if (format == HAL_DISPLAY_FORMAT_GRAY2) {
+        bits = 2;
+    } else if (format == HAL_DISPLAY_FORMAT_GRAY4) {
+        bits = 4;
+    }
+
+    if (bits == gray_bits) {
+        return HAL_OK;
+    }
+
+    if (flush.active) {
+        return HAL_ERROR_RESOURCE_BUSY;
+    }
+
+#if HAL_DISPLAY_GRAY_PLANES > 0
+    memset(gray_planes, 0, sizeof(gray_planes));
+#endif
+    gray_bits = bits;
+    gray_level = (uint8_t)((1U << bits) - 1U);
+    gray_step = 0;
+    return HAL_OK;
+}
+
+/**
+ * @brief Hand a logical window of the drawn frame to the panel
+ *
+ * A whole frame swaps buffers in SWAP mode. A window is copied into the
+ * front buffer in both double-buffered modes instead, since the rest of
+ * the front buffer must keep matching the panel and partial redraws keep
+ * drawing into the same back buffer. The transfer itself is page granular.
+ */
+static hal_result_t display_present(int32_t x0, int32_t y0, int32_t x1, int32_t y1, bool whole_frame)
+{
+    if (flush.active) {
+        return HAL_ERROR_RESOURCE_BUSY;
+    }
+
+    bool full = (x0 == 0 && y0 == 0 && x1 == raster_width - 1 && y1 == raster_height - 1);
+
+    if (buffering == HAL_DISPLAY_BUFFERING_SWAP && whole_frame) {
+        uint8_t *drawn = display_buffer;
+        display_buffer = front_buffer;
+        front_buffer = drawn;
+    } else if (buffering != HAL_DISPLAY_BUFFERING_SINGLE) {
+        if (full) {
+            memcpy(front_buffer, display_buffer, DISPLAY_BUFFER_SIZE_BYTES);
+        } else {
+            /* Only the rectangle's rows: the rest of the back buffer may be stale */
+            for (int32_t page = y0 >> 3; page <= (y1 >> 3); page++) {
+                uint32_t offset = (uint32_t)(page * raster_width + x0);
+                uint32_t count = (uint32_t)(x1 - x0 + 1);
+                uint8_t rows = 0xFF;
+
+                if (page == (y0 >> 3)) {
+                    rows &= (uint8_t)(0xFF << (y0 & 7));
+                }
+                if (page == (y1 >> 3)) {
+                    rows &= (uint8_t)(0xFF >> (7 - (y1 & 7)));
+                }
+
+                if (rows == 0xFF) {
+                    memcpy(&front_buffer[offset], &display_buffer[offset], count);
+                } else {
+                    for (uint32_t i = 0; i < count; i++) {
+                        front_buffer[offset + i] = (uint8_t)((front_buffer[offset + i] & ~rows) |
+                                                             (display_buffer[offset + i] & rows));
+                    }
+                }
+            }
+        }
+    }
+
+    /* Portrait rows run along the panel columns, right to left */
+    if (display_transposed) {
+        display_flush_start(front_buffer, (uint8_t)(x0 >> 3), (uint8_t)(x1 >> 3),
+                            (uint8_t)(DISPLAY_WIDTH - 1 - y1), (uint8_t)(DISPLAY_WIDTH - 1 - y0));
+    } else {
+        display_flush_start(front_buffer, (uint8_t)(y0 >> 3), (uint8_t)(y1 >> 3), (uint8_t)x0, (uint8_t)x1);
+    }
+
+    return HAL_OK;
+}
+
+/**
+ * @brief Begin streaming a page/column window of a frame to the panel
+ */
+static void display_flush_start(const uint8_t *buffer, uint8_t first_page, uint8_t last_page,
+                                uint8_t first_column, uint8_t last_column)
+{
+    flush.buffer = buffer;
+    flush.page = first_page;
+    flush.last_page = last_page;
+    flush.first_column = first_column;
+    flush.last_column = last_column;
+    flush.transposed = display_transposed;
+    flush.active = true;
+
+    if (flush.transposed) {
+        display_flush_stage(first_page);
+    }
+    display_flush_page();
+}
+
+/**
+ * @brief Address the current page and start its data transfer
+ *
+ * Portrait frames stream from a staging buffer; the next page is
+ * transposed while the current one is on the wire.
+ */
+static void display_flush_page(void)
+{
+    uint8_t column = (uint8_t)(flush.first_column + display_column_offset);
+    const uint8_t *data;
+
+    display_send_command((uint8_t)(ST7565_CMD_PAGE_ADDRESS | flush.page));
+    display_send_command((uint8_t)(ST7565_CMD_COLUMN_HIGH | (column >> 4)));
+    display_send_command((uint8_t)(ST7565_CMD_COLUMN_LOW | (column & 0x0F)));
+
+    if (flush.transposed) {
+        data = &flush_staging[flush.page & 1][flush.first_column];
+    } else {
+        data = &flush.buffer[(uint32_t)flush.page * DISPLAY_WIDTH + flush.first_column];
+    }
+
+    display_dma_start(data, (uint32_t)(flush.last_column - flush.first_column) + 1);
+
+    if (flush.transposed && flush.page < flush.last_page) {
+        display_flush_stage((uint8_t)(flush.page + 1));
+    }
+}
+
+/**
+ * @brief Transpose one panel page of a portrait frame into staging
+ *
+ * Panel page p shows portrait columns 8p..8p+7. Rotated 90 degrees
+ * clockwise, portrait row y lands on panel column 127 - y, so each 8x8
+ * block is eight consecutive portrait bytes, transposed and reversed.
+ * Only the blocks covering the flushed column window are converted.
+ */
+static void display_flush_stage(uint8_t page)
+{
+    uint8_t *out = flush_staging[page & 1];
+    uint32_t last_block = flush.last_column >> 3;
+
+    for (uint32_t block = flush.first_column >> 3; block <= last_block; block++) {
+        uint32_t portrait_page = (DISPLAY_WIDTH / 8) - 1 - block;
+        uint64_t rows;
+
+        memcpy(&rows, &flush.buffer[portrait_page * DISPLAY_HEIGHT + (uint32_t)page * 8], sizeof(rows));
+        uint64_t columns = __builtin_bswap64(raster_transpose8x8(rows));
+        memcpy(&out[block * 8], &columns, sizeof(columns));
+    }
+}
+
+/**
+ * @brief Set the controller scan directions for normal or 180 degree output
+ */
+static void display_apply_orientation(bool flipped)
+{
+    display_send_command(flipped ? ST7565_CMD_SEG_REVERSE : ST7565_CMD_SEG_NORMAL);
+    display_send_command(flipped ? ST7565_CMD_COM_REVERSE : ST7565_CMD_COM_NORMAL);
+
+    /* With the segment order reversed the visible columns end the RAM */
+    display_column_offset = flipped ? (ST7565_COLUMNS - DISPLAY_WIDTH) : 0;
+}
+
+/**
+ * @brief DMA1 channel 1 interrupt: stream the next page, or finish the frame
+ */
+static void display_dma_irq_handler(void)
+{
+    uint32_t status = DISPLAY_REG(DISPLAY_DMA_BASE, DMA_ISR_OFFSET);
+
+    if (!(status & (DMA_ISR_TCIF1 | DMA_ISR_TEIF1))) {
+        return;
+    }
+
+    DISPLAY_REG(DISPLAY_DMA_BASE, DMA_IFCR_OFFSET) = DMA_IFCR_CGIF1;
+    DISPLAY_REG(DISPLAY_DMA_BASE, DMA_CCR1_OFFSET) &= ~DMA_CCR_EN;
+
+    if (!flush.active) {
+        return;
+    }
+
+    /* DMA completion only means the last byte reached the SPI FIFO */
+    while (DISPLAY_REG(DISPLAY_SPI_BASE, SPI_SR_OFFSET) & (SPI_SR_FTLVL | SPI_SR_BSY)) {
+    }
+
+    if (!(status & DMA_ISR_TEIF1) && flush.page < flush.last_page) {
+        flush.page++;
+        display_flush_page();
+        return;
+    }
+
+    /* Frame done (a transfer error abandons the rest of the frame) */
+    flush.active = false;
+    frames_completed++;
+
+    hal_display_vsync_callback_t callback = vsync_callback;
+    if (callback) {
+        callback(frames_completed, vsync_callback_user_data);
+    }
+}
+
+/**
+ * @brief Start a memory-to-SPI DMA transfer of display data
+ */
+static void display_dma_start(const uint8_t *data, uint32_t size)
+{
+    /* Hardware-specific: DC pin high (data) before the first byte goes out */
+
+    DISPLAY_REG(DISPLAY_DMA_BASE, DMA_CCR1_OFFSET) &= ~DMA_CCR_EN;
+    DISPLAY_REG(DISPLAY_DMA_BASE, DMA_IFCR_OFFSET) = DMA_IFCR_CGIF1;
+    DISPLAY_REG(DISPLAY_DMAMUX_BASE, DMAMUX_C0CR_OFFSET) = DMAMUX_REQ_SPI2_TX;
+    DISPLAY_REG(DISPLAY_DMA_BASE, DMA_CPAR1_OFFSET) = (uint32_t)(DISPLAY_SPI_BASE + SPI_DR_OFFSET);
+    DISPLAY_REG(DISPLAY_DMA_BASE, DMA_CMAR1_OFFSET) = (uint32_t)(uintptr_t)data;
+    DISPLAY_REG(DISPLAY_DMA_BASE, DMA_CNDTR1_OFFSET) = size;
+    DISPLAY_REG(DISPLAY_DMA_BASE, DMA_CCR1_OFFSET) = DMA_CCR_DIR | DMA_CCR_MINC | DMA_CCR_TCIE |
+                                                     DMA_CCR_TEIE | DMA_CCR_EN;
+    DISPLAY_REG(DISPLAY_SPI_BASE, SPI_CR2_OFFSET) |= SPI_CR2_TXDMAEN;
+}
+
+static void input_read_hardware_states(void)
+{
+    /* Hardware-specific button reading would go here */
+    /* Read GPIO pins for each button and update button_states array */
+    
+    /* For now, this is a stub implementation */
+    /* In a real implementation, this would read the actual hardware pins */
+    
+    /* Example stub code - buttons are always released */
+    for (int i = 0; i < HAL_INPUT_BUTTON_MAX; i++) {
+        button_states[i] = HAL_INPUT_STATE_RELEASED;
     }
 }
 
 static uint32_t get_system_time_ms(void)
 {
-    /* Hardware-specific system time reading would go here */
-    /* This should return the current system time in milliseconds */
-    
-    /* For now, return a stub value */
-    static uint32_t stub_time = 0;
-    return stub_time++;
+    /* Hardware-specific system time reading would go here */
+    /* This should return the current system time in milliseconds */
+    
+    /* For now, return a stub value */
+    static uint32_t stub_time = 0;
+    return stub_time++;
+}
+
+static void bresenham_line(int16_t x0, int16_t y0, int16_t x1, int16_t y1, hal_graphics_mode_t mode)
+{
+    /* Axis-aligned lines go through the span fill */
+    if (y0 == y1) {
+        int16_t left = (x0 < x1) ? x0 : x1;
+        raster_fill_rect(left, y0, abs(x1 - x0) + 1, 1, mode);
+        return;
+    }
+    if (x0 == x1) {
+        int16_t top = (y0 < y1) ? y0 : y1;
+        raster_fill_rect(x0, top, 1, abs(y1 - y0) + 1, mode);
+        return;
+    }
+
+    /* Bresenham's line algorithm implementation */
+    int16_t dx = abs(x1 - x0);
+    int16_t dy = abs(y1 - y0);
+    int16_t sx = (x0 < x1) ? 1 : -1;
+    int16_t sy = (y0 < y1) ? 1 : -1;
+    int16_t err = dx - dy;
+
+    while (true) {
+        raster_pixel(x0, y0, mode);
+
+        if (x0 == x1 && y0 == y1) {
+            break;
+        }
+
+        int16_t e2 = 2 * err;
+        if (e2 > -dy) {
+            err -= dy;
+            x0 += sx;
+        }
+        if (e2 < dx) {
+            err += dx;
+            y0 += sy;
+        }
+    }
+}
+
+/**
+ * @brief Build the and/xor pair that applies a mode to the bits in mask
+ */
+static raster_op_t raster_make_op(uint8_t mask, hal_graphics_mode_t mode)
+{
+    uint32_t mask32 = (uint32_t)mask * 0x01010101UL;
+    raster_op_t op;
+
+    switch (mode) {
+        case HAL_GRAPHICS_MODE_SET:
+            op.and_mask = ~mask32;
+            op.xor_mask = mask32;
+            break;
+        case HAL_GRAPHICS_MODE_CLEAR:
+            op.and_mask = ~mask32;
+            op.xor_mask = 0;
+            break;
+        case HAL_GRAPHICS_MODE_INVERT:
+        default:
+            op.and_mask = 0xFFFFFFFFUL;
+            op.xor_mask = mask32;
+            break;
+    }
+
+    return op;
+}
+
+/**
+ * @brief Apply a raster operation to count consecutive columns of one page
+ *
+ * Unaligned head and tail bytes are handled individually, the aligned middle
+ * is processed one 32-bit word (four columns) at a time.
+ */
+static void raster_apply_span(uint8_t *dst, uint32_t count, raster_op_t op)
+{
+    uint8_t and8 = (uint8_t)op.and_mask;
+    uint8_t xor8 = (uint8_t)op.xor_mask;
+
+    while (count > 0 && ((uintptr_t)dst & 3U) != 0) {
+        *dst = (*dst & and8) ^ xor8;
+        dst++;
+        count--;
+    }
+
+    raster_word_t *word = (raster_word_t *)dst;
+    while (count >= 4) {
+        *word = (*word & op.and_mask) ^ op.xor_mask;
+        word++;
+        count -= 4;
+    }
+
+    dst = (uint8_t *)word;
+    while (count > 0) {
+        *dst = (*dst & and8) ^ xor8;
+        dst++;
+        count--;
+    }
+}
+
+/**
+ * @brief Fill a rectangle, clipped once to the screen
+ *
+ * Each page touched by the rectangle gets a single bit mask covering the
+ * rows it spans, which is then applied across the clipped column range.
+ * Vertical lines reduce to one masked byte per page, horizontal lines to
+ * one word-wide span.
+ */
+static void raster_fill_rect(int32_t x, int32_t y, int32_t width, int32_t height, hal_graphics_mode_t mode)
+{
+    if (width <= 0 || height <= 0) {
+        return;
+    }
+
+    int32_t x0 = x;
+    int32_t y0 = y;
+    int32_t x1 = x + width - 1;
+    int32_t y1 = y + height - 1;
+
+    if (x0 < clip_left) {
+        x0 = clip_left;
+    }
+    if (y0 < clip_top) {
+        y0 = clip_top;
+    }
+    if (x1 >= clip_right) {
+        x1 = clip_right - 1;
+    }
+    if (y1 >= clip_bottom) {
+        y1 = clip_bottom - 1;
+    }
+    if (x0 > x1 || y0 > y1) {
+        return;
+    }
+
+    uint32_t first_page = (uint32_t)y0 >> 3;
+    uint32_t last_page = (uint32_t)y1 >> 3;
+    uint32_t count = (uint32_t)(x1 - x0 + 1);
+    uint8_t *targets[DISPLAY_MAX_TARGETS];
+    uint32_t target_count = raster_targets(targets);
+
+    for (uint32_t page = first_page; page <= last_page; page++) {
+        uint8_t mask = 0xFF;
+        if (page == first_page) {
+            mask &= (uint8_t)(0xFF << (y0 & 7));
+        }
+        if (page == last_page) {
+            mask &= (uint8_t)(0xFF >> (7 - (y1 & 7)));
+        }
+
+        uint32_t offset = page * (uint32_t)draw_stride + (uint32_t)x0;
+        for (uint32_t t = 0; t < target_count; t++) {
+            hal_graphics_mode_t plane_mode = (mode == HAL_GRAPHICS_MODE_SET && !raster_plane_ink(t))
+                                             ? HAL_GRAPHICS_MODE_CLEAR : mode;
+            raster_apply_span(&targets[t][offset], count, raster_make_op(mask, plane_mode));
+        }
+    }
+}
+
+/**
+ * @brief Plot a single pixel without re-validating display state
+ */
+static void raster_pixel(int32_t x, int32_t y, hal_graphics_mode_t mode)
+{
+    if (x < clip_left || x >= clip_right || y < clip_top || y >= clip_bottom) {
+        return;
+    }
+
+    uint8_t *targets[DISPLAY_MAX_TARGETS];
+    uint32_t target_count = raster_targets(targets);
+    uint32_t offset = ((uint32_t)y >> 3) * (uint32_t)draw_stride + (uint32_t)x;
+    uint8_t bit_mask = (uint8_t)(1U << (y & 7));
+
+    for (uint32_t t = 0; t < target_count; t++) {
+        uint8_t *dst = &targets[t][offset];
+
+        switch (mode) {
+            case HAL_GRAPHICS_MODE_SET:
+                if (raster_plane_ink(t)) {
+                    *dst |= bit_mask;
+                } else {
+                    *dst &= (uint8_t)~bit_mask;
+                }
+                break;
+            case HAL_GRAPHICS_MODE_CLEAR:
+                *dst &= (uint8_t)~bit_mask;
+                break;
+            case HAL_GRAPHICS_MODE_INVERT:
+                *dst ^= bit_mask;
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+/**
+ * @brief Buffers the primitives draw into
+ *
+ * A bound canvas, else the frame buffer in MONO format and every gray
+ * plane otherwise.
+ *
+ * @return Number of targets
+ */
+static uint32_t raster_targets(uint8_t **targets)
+{
+    if (canvas_buffer) {
+        targets[0] = canvas_buffer;
+        return 1;
+    }
+
+#if HAL_DISPLAY_GRAY_PLANES > 0
+    if (gray_bits != 0) {
+        for (uint32_t plane = 0; plane < gray_bits; plane++) {
+            targets[plane] = gray_planes[plane];
+        }
+        return gray_bits;
+    }
+#endif
+
+    targets[0] = display_buffer;
+    return 1;
+}
+
+/**
+ * @brief Whether SET mode turns pixels on in a target (the gray level's bit)
+ */
+static bool raster_plane_ink(uint32_t plane)
+{
+    return canvas_buffer != NULL || gray_bits == 0 || ((gray_level >> plane) & 1U) != 0;
+}
+
+/**
+ * @brief Intersect a rectangle with a width x height surface (inclusive corners)
+ * @return false if nothing of the rectangle is on the surface
+ */
+static bool raster_clip_rect(const hal_rect_t *rect, int32_t width, int32_t height,
+                             int32_t *x0, int32_t *y0, int32_t *x1, int32_t *y1)
+{
+    int32_t left = (rect->x < 0) ? 0 : rect->x;
+    int32_t top = (rect->y < 0) ? 0 : rect->y;
+    int32_t right = (int32_t)rect->x + (int32_t)rect->width - 1;
+    int32_t bottom = (int32_t)rect->y + (int32_t)rect->height - 1;
+
+    if (right >= width) {
+        right = width - 1;
+    }
+    if (bottom >= height) {
+        bottom = height - 1;
+    }
+    if (left > right || top > bottom) {
+        return false;
+    }
+
+    *x0 = left;
+    *y0 = top;
+    *x1 = right;
+    *y1 = bottom;
+    return true;
+}
+
+/**
+ * @brief Set the clip to a rectangle within the drawing target
+ * @param rect Clip rectangle, NULL for the whole target
+ */
+static void raster_set_clip(const hal_rect_t *rect)
+{
+    int32_t x0, y0, x1, y1;
+
+    if (!rect) {
+        clip_left = 0;
+        clip_top = 0;
+        clip_right = draw_width;
+        clip_bottom = draw_height;
+    } else if (raster_clip_rect(rect, draw_width, draw_height, &x0, &y0, &x1, &y1)) {
+        clip_left = x0;
+        clip_top = y0;
+        clip_right = x1 + 1;
+        clip_bottom = y1 + 1;
+    } else {
+        /* Empty clip: nothing is drawn until it is reset */
+        clip_left = 0;
+        clip_top = 0;
+        clip_right = 0;
+        clip_bottom = 0;
+    }
+}
+
+/**
+ * @brief Make the screen raster the drawing target (clip unchanged)
+ */
+static void raster_bind_screen(void)
+{
+    canvas_buffer = NULL;
+    draw_width = raster_width;
+    draw_height = raster_height;
+    draw_stride = raster_width;
+}
+
+/**
+ * @brief Check a canvas descriptor
+ *
+ * Rows of a canvas are bounded by the panel width so the per-row scratch
+ * buffers of the blitter and the ditherer fit.
+ */
+static bool canvas_valid(const hal_canvas_t *canvas)
+{
+    return canvas && canvas->buffer && canvas->width > 0 && canvas->width <= DISPLAY_WIDTH &&
+           canvas->height > 0 && canvas->stride >= canvas->width;
+}
+
+/**
+ * @brief Direct the primitives at a canvas until canvas_unbind()
+ * @param canvas Canvas, or NULL to keep drawing into the screen
+ * @param saved Receives the current target
+ */
+static hal_result_t canvas_bind(const hal_canvas_t *canvas, raster_binding_t *saved)
+{
+    saved->buffer = canvas_buffer;
+    saved->width = draw_width;
+    saved->height = draw_height;
+    saved->stride = draw_stride;
+    saved->clip_left = clip_left;
+    saved->clip_top = clip_top;
+    saved->clip_right = clip_right;
+    saved->clip_bottom = clip_bottom;
+
+    if (!canvas) {
+        return HAL_OK;
+    }
+
+    if (!canvas_valid(canvas)) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    canvas_buffer = canvas->buffer;
+    draw_width = canvas->width;
+    draw_height = canvas->height;
+    draw_stride = canvas->stride;
+    raster_set_clip(&canvas->clip);
+    return HAL_OK;
+}
+
+/**
+ * @brief Restore the target saved by canvas_bind()
+ */
+static void canvas_unbind(const raster_binding_t *saved)
+{
+    canvas_buffer = saved->buffer;
+    draw_width = saved->width;
+    draw_height = saved->height;
+    draw_stride = saved->stride;
+    clip_left = saved->clip_left;
+    clip_top = saved->clip_top;
+    clip_right = saved->clip_right;
+    clip_bottom = saved->clip_bottom;
+}
+
+/**
+ * @brief Bits of a page that lie inside the clip rectangle's rows
+ */
+static uint8_t raster_clip_rows(int32_t page)
+{
+    int32_t top = clip_top - page * 8;
+    int32_t bottom = clip_bottom - page * 8;
+    uint8_t mask = 0xFF;
+
+    if (top > 0) {
+        mask = (top >= 8) ? 0 : (uint8_t)(mask << top);
+    }
+    if (bottom < 8) {
+        mask &= (bottom <= 0) ? 0 : (uint8_t)(0xFF >> (8 - bottom));
+    }
+
+    return mask;
+}
+
+/**
+ * @brief Transpose an 8x8 bit matrix held one row per byte
+ *
+ * Bit k of byte r moves to bit r of byte k, which turns eight row-major
+ * bytes into eight page-major column bytes and back.
+ */
+static uint64_t raster_transpose8x8(uint64_t x)
+{
+    uint64_t t;
+
+    t = (x ^ (x >> 7)) & 0x00AA00AA00AA00AAULL;
+    x ^= t ^ (t << 7);
+    t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCULL;
+    x ^= t ^ (t << 14);
+    t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ULL;
+    x ^= t ^ (t << 28);
+
+    return x;
+}
+
+/**
+ * @brief Decode count bytes of an RLE stream into out (NULL skips them)
+ */
+static void rle_decode(rle_state_t *rle, uint8_t *out, uint32_t count)
+{
+    while (count > 0) {
+        if (rle->count == 0) {
+            if (rle->pos >= rle->end) {
+                /* Truncated stream: the rest decodes as blank */
+                if (out) {
+                    memset(out, 0, count);
+                }
+                return;
+            }
+
+            uint8_t ctrl = *rle->pos++;
+            if (ctrl & 0x80) {
+                rle->count = (uint8_t)((ctrl & 0x7F) + 2);
+                rle->literal = false;
+                rle->value = (rle->pos < rle->end) ? *rle->pos++ : 0;
+            } else {
+                rle->count = (uint8_t)(ctrl + 1);
+                rle->literal = true;
+            }
+        }
+
+        uint32_t n = (rle->count < count) ? rle->count : count;
+
+        if (rle->literal) {
+            uint32_t avail = (uint32_t)(rle->end - rle->pos);
+            if (n > avail) {
+                n = avail;
+                rle->count = (uint8_t)n;
+                if (n == 0) {
+                    continue;
+                }
+            }
+            if (out) {
+                memcpy(out, rle->pos, n);
+            }
+            rle->pos += n;
+        } else if (out) {
+            memset(out, rle->value, n);
+        }
+
+        if (out) {
+            out += n;
+        }
+        rle->count = (uint8_t)(rle->count - n);
+        count -= n;
+    }
+}
+
+/**
+ * @brief Prepare a blit source for strip-by-strip reading
+ */
+static void blit_source_init(blit_source_t *src, hal_bitmap_format_t format, const uint8_t *data,
+                             uint32_t size, uint32_t stride, uint32_t width, uint32_t height)
+{
+    src->format = format;
+    src->data = data;
+    src->width = width;
+    src->height = height;
+    src->rle.pos = data;
+    src->rle.end = data + size;
+    src->rle.count = 0;
+    src->rle.value = 0;
+    src->rle.literal = false;
+
+    switch (format) {
+        case HAL_BITMAP_FORMAT_ROW_MAJOR:
+            /* Row-major strides are kept in bits so packed rows work too */
+            src->stride = stride ? stride * 8 : ((width + 7) & ~7U);
+            break;
+        case HAL_BITMAP_FORMAT_RLE:
+            src->stride = width;
+            break;
+        case HAL_BITMAP_FORMAT_PAGE_MAJOR:
+        default:
+            src->stride = stride ? stride : width;
+            break;
+    }
+}
+
+/**
+ * @brief Gather eight rows of a row-major source into column bytes
+ *
+ * Works on 8-column groups: each group's eight row bytes are fetched at
+ * whatever bit offset they start and transposed in one go.
+ */
+static void blit_rows_to_columns(const blit_source_t *src, uint32_t page, uint32_t col0,
+                                 uint32_t count, uint8_t *out)
+{
+    uint32_t row0 = page * 8;
+    uint32_t rows = (src->height - row0 < 8) ? src->height - row0 : 8;
+    uint32_t col_end = col0 + count;
+
+    for (uint32_t group = col0 & ~7U; group < col_end; group += 8) {
+        uint32_t need = (src->width - group < 8) ? src->width - group : 8;
+        uint32_t need_mask = (1U << need) - 1;
+        uint64_t block = 0;
+
+        for (uint32_t r = 0; r < rows; r++) {
+            uint32_t bit = (row0 + r) * src->stride + group;
+            const uint8_t *p = &src->data[bit >> 3];
+            uint32_t sh = bit & 7;
+            uint32_t bits = (uint32_t)p[0] >> sh;
+            if (sh + need > 8) {
+                bits |= (uint32_t)p[1] << (8 - sh);
+            }
+            block |= (uint64_t)(bits & need_mask) << (r * 8);
+        }
+
+        block = raster_transpose8x8(block);
+
+        for (uint32_t k = 0; k < 8; k++) {
+            uint32_t col = group + k;
+            if (col >= col0 && col < col_end) {
+                out[col - col0] = (uint8_t)(block >> (k * 8));
+            }
+        }
+    }
 }
 
-static void bresenham_line(int16_t x0, int16_t y0, int16_t x1, int16_t y1, hal_graphics_mode_t mode)
+/**
+ * @brief Get the visible column bytes of one source page row
+ *
+ * Page-major sources are returned in place. Row-major and RLE sources are
+ * converted into scratch; RLE strips must be requested in order, with
+ * count 0 to skip a strip that is not visible.
+ */
+static const uint8_t *blit_source_strip(blit_source_t *src, uint32_t page, uint32_t col0,
+                                        uint32_t count, uint8_t *scratch)
 {
-    /* Bresenham's line algorithm implementation */
-    int16_t dx = abs(x1 - x0);
-    int16_t dy = abs(y1 - y0);
-    int16_t sx = (x0 < x1) ? 1 : -1;
-    int16_t sy = (y0 < y1) ? 1 : -1;
-    int16_t err = dx - dy;
+    switch (src->format) {
+        case HAL_BITMAP_FORMAT_ROW_MAJOR:
+            if (count > 0) {
+                blit_rows_to_columns(src, page, col0, count, scratch);
+            }
+            return scratch;
 
-    while (true) {
-        hal_graphics_set_pixel(x0, y0, mode);
+        case HAL_BITMAP_FORMAT_RLE:
+            if (count == 0) {
+                rle_decode(&src->rle, NULL, src->width);
+                return scratch;
+            }
+            rle_decode(&src->rle, NULL, col0);
+            rle_decode(&src->rle, scratch, count);
+            rle_decode(&src->rle, NULL, src->width - col0 - count);
+            return scratch;
 
-        if (x0 == x1 && y0 == y1) {
+        case HAL_BITMAP_FORMAT_PAGE_MAJOR:
+        default:
+            return &src->data[page * src->stride + col0];
+    }
+}
+
+/**
+ * @brief Map a drawing mode onto the equivalent transparent blit mode
+ */
+static hal_blit_mode_t raster_blit_mode(hal_graphics_mode_t mode)
+{
+    switch (mode) {
+        case HAL_GRAPHICS_MODE_CLEAR:
+            return HAL_BLIT_MODE_ERASE;
+        case HAL_GRAPHICS_MODE_INVERT:
+            return HAL_BLIT_MODE_INVERT;
+        case HAL_GRAPHICS_MODE_SET:
+        default:
+            return HAL_BLIT_MODE_TRANSPARENT;
+    }
+}
+
+/**
+ * @brief Blit a bitmap source into the buffer
+ *
+ * Columns and pages are clipped once up front. Each source page row is
+ * fetched as column bytes (eight vertical pixels, LSB at the top); when y
+ * is page aligned every byte lands on exactly one destination byte,
+ * otherwise it is split into a shifted low part for the destination page
+ * and the carried high part for the page below.
+ *
+ * With v the source bits and m the affected bits (the bitmap area, or the
+ * mask in MASK mode) every mode reduces to
+ * dst = (dst & ~((v & and_v) | (m & and_m))) ^ (v & xor_v & (m | xor_all)).
+ */
+static void raster_blit(blit_source_t *data, blit_source_t *mask, int32_t x, int32_t y, hal_blit_mode_t mode)
+{
+    static uint8_t data_scratch[DISPLAY_WIDTH];
+    static uint8_t mask_scratch[DISPLAY_WIDTH];
+
+    int32_t width = (int32_t)data->width;
+    int32_t height = (int32_t)data->height;
+
+    if (width <= 0 || height <= 0 || y >= clip_bottom || y + height <= clip_top) {
+        return;
+    }
+
+    int32_t col0 = (x < clip_left) ? clip_left - x : 0;
+    int32_t col1 = (x + width > clip_right) ? clip_right - x : width;
+    if (col0 >= col1) {
+        return;
+    }
+
+    uint8_t and_v = 0;
+    uint8_t and_m = 0;
+    uint8_t xor_v = 0xFF;
+    uint8_t xor_all = 0xFF;
+
+    switch (mode) {
+        case HAL_BLIT_MODE_OPAQUE:
+        case HAL_BLIT_MODE_MASK:
+            and_m = 0xFF;
+            xor_all = 0;
+            break;
+        case HAL_BLIT_MODE_ERASE:
+            and_v = 0xFF;
+            xor_v = 0;
+            break;
+        case HAL_BLIT_MODE_INVERT:
+            break;
+        case HAL_BLIT_MODE_TRANSPARENT:
+        default:
+            and_v = 0xFF;
+            break;
+    }
+
+    if (mode != HAL_BLIT_MODE_MASK) {
+        mask = NULL;
+    }
+
+    /* Floor division so bitmaps partly above the screen still shift correctly */
+    int32_t page0 = (y >= 0) ? (y >> 3) : -((7 - y) >> 3);
+    uint32_t shift = (uint32_t)(y - page0 * 8);
+    int32_t src_pages = (height + 7) >> 3;
+    uint8_t last_mask = (uint8_t)(0xFF >> ((src_pages << 3) - height));
+
+    uint32_t count = (uint32_t)(col1 - col0);
+    uint32_t dst_x = (uint32_t)(x + col0);
+    int32_t clip_first_page = clip_top >> 3;
+    int32_t clip_last_page = (clip_bottom - 1) >> 3;
+    uint8_t lo_clip = 0xFF;
+    uint8_t hi_clip = 0xFF;
+
+    /* Gray planes whose level bit is clear only get the clearing half of the op */
+    uint8_t *targets[DISPLAY_MAX_TARGETS];
+    uint8_t target_xor[DISPLAY_MAX_TARGETS];
+    uint32_t target_count = raster_targets(targets);
+    for (uint32_t t = 0; t < target_count; t++) {
+        target_xor[t] = (raster_plane_ink(t) || mode == HAL_BLIT_MODE_INVERT) ? xor_v : 0;
+    }
+
+    for (int32_t sp = 0; sp < src_pages; sp++) {
+        int32_t lo_page = page0 + sp;
+        int32_t hi_page = lo_page + 1;
+        int32_t lo_offset = -1;
+        int32_t hi_offset = -1;
+
+        if (lo_page > clip_last_page) {
             break;
         }
+        if (lo_page >= clip_first_page) {
+            lo_offset = lo_page * draw_stride + (int32_t)dst_x;
+            lo_clip = raster_clip_rows(lo_page);
+        }
+        if (shift != 0 && hi_page >= clip_first_page && hi_page <= clip_last_page) {
+            hi_offset = hi_page * draw_stride + (int32_t)dst_x;
+            hi_clip = raster_clip_rows(hi_page);
+        }
 
-        int16_t e2 = 2 * err;
-        if (e2 > -dy) {
-            err -= dy;
-            x0 += sx;
+        if (lo_offset < 0 && hi_offset < 0) {
+            blit_source_strip(data, (uint32_t)sp, 0, 0, data_scratch);
+            if (mask) {
+                blit_source_strip(mask, (uint32_t)sp, 0, 0, mask_scratch);
+            }
+            continue;
         }
-        if (e2 < dx) {
-            err += dx;
-            y0 += sy;
+
+        const uint8_t *v_row = blit_source_strip(data, (uint32_t)sp, (uint32_t)col0, count, data_scratch);
+        const uint8_t *m_row = mask ? blit_source_strip(mask, (uint32_t)sp, (uint32_t)col0, count, mask_scratch)
+                                    : NULL;
+        uint8_t valid = (sp == src_pages - 1) ? last_mask : 0xFF;
+
+        for (uint32_t t = 0; t < target_count; t++) {
+            uint8_t *lo = (lo_offset >= 0) ? &targets[t][lo_offset] : NULL;
+            uint8_t *hi = (hi_offset >= 0) ? &targets[t][hi_offset] : NULL;
+            uint8_t xor_t = target_xor[t];
+
+            for (uint32_t c = 0; c < count; c++) {
+                uint8_t v = v_row[c] & valid;
+                uint8_t m = m_row ? (m_row[c] & valid) : valid;
+
+                if (lo) {
+                    uint8_t lv = (uint8_t)(v << shift) & lo_clip;
+                    uint8_t lm = (uint8_t)(m << shift) & lo_clip;
+                    lo[c] = (uint8_t)((lo[c] & ~((lv & and_v) | (lm & and_m))) ^ (lv & xor_t & (lm | xor_all)));
+                }
+                if (hi) {
+                    uint8_t hv = (uint8_t)(v >> (8 - shift)) & hi_clip;
+                    uint8_t hm = (uint8_t)(m >> (8 - shift)) & hi_clip;
+                    hi[c] = (uint8_t)((hi[c] & ~((hv & and_v) | (hm & and_m))) ^ (hv & xor_t & (hm | xor_all)));
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Blit a page-major bitmap (glyphs, native sprites) with a drawing mode
+ */
+static void raster_blit_pages(const uint8_t *src, uint32_t stride, int32_t x, int32_t y,
+                              int32_t width, int32_t height, hal_graphics_mode_t mode)
+{
+    blit_source_t source;
+
+    blit_source_init(&source, HAL_BITMAP_FORMAT_PAGE_MAJOR, src, 0, stride, (uint32_t)width, (uint32_t)height);
+    raster_blit(&source, NULL, x, y, raster_blit_mode(mode));
+}
+
+/**
+ * @brief Look up the glyph for a character, substituting the default glyph
+ */
+static const hal_font_glyph_t *font_find_glyph(const hal_font_t *font, char c, uint8_t *code)
+{
+    uint8_t ch = (uint8_t)c;
+
+    if (ch < font->first_char || ch > font->last_char) {
+        ch = font->default_char;
+    }
+
+    *code = ch;
+    return &font->glyphs[ch - font->first_char];
+}
+
+/**
+ * @brief Kerning adjustment for a character pair (binary search, table is sorted)
+ */
+static int32_t font_kerning(const hal_font_t *font, uint8_t left, uint8_t right)
+{
+    if (font->kerning_count == 0) {
+        return 0;
+    }
+
+    uint16_t pair = (uint16_t)((left << 8) | right);
+    uint32_t lo = 0;
+    uint32_t hi = font->kerning_count;
+
+    while (lo < hi) {
+        uint32_t mid = (lo + hi) / 2;
+        uint16_t key = font->kerning[mid].pair;
+        if (key == pair) {
+            return font->kerning[mid].adjust;
+        }
+        if (key < pair) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Measure the inked width of the widest line of text
+ */
+static uint16_t font_measure(const char *text, const hal_font_t *font)
+{
+    int32_t widest = 0;
+    int32_t x = 0;
+    int32_t extent = 0;
+    uint8_t prev = 0;
+
+    for (; *text; text++) {
+        if (*text == '\n') {
+            if (extent > widest) {
+                widest = extent;
+            }
+            x = 0;
+            extent = 0;
+            prev = 0;
+            continue;
+        }
+
+        uint8_t code;
+        const hal_font_glyph_t *glyph = font_find_glyph(font, *text, &code);
+
+        if (prev != 0) {
+            x += font_kerning(font, prev, code);
+        }
+        if (x + glyph->width > extent) {
+            extent = x + glyph->width;
+        }
+
+        x += glyph->advance;
+        prev = code;
+    }
+
+    if (extent > widest) {
+        widest = extent;
+    }
+
+    return (uint16_t)((widest > 0xFFFF) ? 0xFFFF : widest);
+}
+
+/**
+ * @brief Clamp a corner radius so opposite corners never overlap
+ */
+static int32_t raster_clamp_radius(const hal_rect_t *rect, uint16_t radius)
+{
+    int32_t r = radius;
+    int32_t max_x = (rect->width - 1) / 2;
+    int32_t max_y = (rect->height - 1) / 2;
+
+    if (r > max_x) {
+        r = max_x;
+    }
+    if (r > max_y) {
+        r = max_y;
+    }
+    return r;
+}
+
+/**
+ * @brief Plot the four corner points for one octant step of a rounded outline
+ *
+ * (a, b) is an offset from the corner centers with a, b > 0; points on the
+ * axes belong to the straight edges and are drawn there instead.
+ */
+static void raster_round_corners(int32_t left, int32_t top, int32_t right, int32_t bottom,
+                                 int32_t a, int32_t b, hal_graphics_mode_t mode)
+{
+    raster_pixel(left - a, top - b, mode);
+    raster_pixel(right + a, top - b, mode);
+    raster_pixel(left - a, bottom + b, mode);
+    raster_pixel(right + a, bottom + b, mode);
+}
+
+/**
+ * @brief Midpoint outline of a rounded box
+ *
+ * left/top/right/bottom are the centers of the corner arcs; a circle is the
+ * degenerate case where all four coincide. Every pixel is touched once so
+ * INVERT mode produces a clean outline.
+ */
+static void raster_round_outline(int32_t left, int32_t top, int32_t right, int32_t bottom,
+                                 int32_t r, hal_graphics_mode_t mode)
+{
+    if (r == 0) {
+        /* Zero-radius circle; rounded rectangles fall back to draw_rect */
+        raster_fill_rect(left, top, right - left + 1, bottom - top + 1, mode);
+        return;
+    }
+
+    /* Straight edges between the corner arcs, endpoints included */
+    raster_fill_rect(left, top - r, right - left + 1, 1, mode);
+    raster_fill_rect(left - r, top, 1, bottom - top + 1, mode);
+    raster_fill_rect(left, bottom + r, right - left + 1, 1, mode);
+    raster_fill_rect(right + r, top, 1, bottom - top + 1, mode);
+
+    int32_t x = 0;
+    int32_t y = r;
+    int32_t d = 1 - r;
+
+    while (x <= y) {
+        if (x > 0) {
+            raster_round_corners(left, top, right, bottom, x, y, mode);
+            if (x != y) {
+                raster_round_corners(left, top, right, bottom, y, x, mode);
+            }
+        }
+
+        if (d < 0) {
+            d += 2 * x + 3;
+        } else {
+            d += 2 * (x - y) + 5;
+            y--;
+        }
+        x++;
+    }
+}
+
+/**
+ * @brief Emit the two horizontal spans at vertical offset dy of a rounded fill
+ */
+static void raster_round_rows(int32_t left, int32_t top, int32_t right, int32_t bottom,
+                              int32_t dy, int32_t half_width, hal_graphics_mode_t mode)
+{
+    int32_t width = right - left + 2 * half_width + 1;
+
+    raster_fill_rect(left - half_width, top - dy, width, 1, mode);
+    raster_fill_rect(left - half_width, bottom + dy, width, 1, mode);
+}
+
+/**
+ * @brief Midpoint scanline fill of a rounded box
+ *
+ * The band between the corner centers is one rectangle fill; each row of the
+ * caps is emitted exactly once as a horizontal span with the widest extent
+ * the midpoint walk reaches on that row.
+ */
+static void raster_round_fill(int32_t left, int32_t top, int32_t right, int32_t bottom,
+                              int32_t r, hal_graphics_mode_t mode)
+{
+    raster_fill_rect(left - r, top, right - left + 2 * r + 1, bottom - top + 1, mode);
+
+    int32_t x = 0;
+    int32_t y = r;
+    int32_t d = 1 - r;
+
+    while (x <= y) {
+        /* Row offset x spans out to y */
+        if (x > 0) {
+            raster_round_rows(left, top, right, bottom, x, y, mode);
+        }
+
+        if (d < 0) {
+            d += 2 * x + 3;
+        } else {
+            /* Last step on row offset y: x is its widest extent */
+            if (x != y) {
+                raster_round_rows(left, top, right, bottom, y, x, mode);
+            }
+            d += 2 * (x - y) + 5;
+            y--;
+        }
+        x++;
+    }
+}
+
+/**
+ * @brief Plot or fill the row pair at vertical offset y of an ellipse
+ */
+static void raster_ellipse_row(int32_t cx, int32_t cy, int32_t x, int32_t y, bool fill,
+                               hal_graphics_mode_t mode)
+{
+    if (fill) {
+        raster_fill_rect(cx - x, cy - y, 2 * x + 1, 1, mode);
+        if (y != 0) {
+            raster_fill_rect(cx - x, cy + y, 2 * x + 1, 1, mode);
+        }
+        return;
+    }
+
+    raster_pixel(cx + x, cy - y, mode);
+    if (x != 0) {
+        raster_pixel(cx - x, cy - y, mode);
+    }
+    if (y != 0) {
+        raster_pixel(cx + x, cy + y, mode);
+        if (x != 0) {
+            raster_pixel(cx - x, cy + y, mode);
         }
     }
+}
+
+/**
+ * @brief Two-region midpoint ellipse, outline or scanline fill
+ *
+ * Decision variables are scaled by 4 to stay integral and kept in 64 bits
+ * since they grow with rx^2 * ry^2. In fill mode each row is emitted once,
+ * at the last step the walk spends on it.
+ */
+static void raster_ellipse(int32_t cx, int32_t cy, int32_t rx, int32_t ry, bool fill, hal_graphics_mode_t mode)
+{
+    if (rx == 0 || ry == 0) {
+        raster_fill_rect(cx - rx, cy - ry, 2 * rx + 1, 2 * ry + 1, mode);
+        return;
+    }
+
+    int64_t a2 = (int64_t)rx * rx;
+    int64_t b2 = (int64_t)ry * ry;
+    int32_t x = 0;
+    int32_t y = ry;
+    int64_t dx = 0;
+    int64_t dy = 2 * a2 * y;
+
+    /* Region 1: slope shallower than -1, x advances every step */
+    int64_t d1 = 4 * b2 - 4 * a2 * ry + a2;
+    while (dx < dy) {
+        if (!fill) {
+            raster_ellipse_row(cx, cy, x, y, false, mode);
+        }
+
+        if (d1 < 0) {
+            x++;
+            dx += 2 * b2;
+            d1 += 4 * (dx + b2);
+        } else {
+            if (fill) {
+                raster_ellipse_row(cx, cy, x, y, true, mode);
+            }
+            x++;
+            y--;
+            dx += 2 * b2;
+            dy -= 2 * a2;
+            d1 += 4 * (dx - dy + b2);
+        }
+    }
+
+    /* Region 2: slope steeper than -1, y advances every step */
+    int64_t d2 = b2 * (2 * x + 1) * (2 * x + 1) + 4 * a2 * (int64_t)(y - 1) * (y - 1) - 4 * a2 * b2;
+    while (y > 0) {
+        raster_ellipse_row(cx, cy, x, y, fill, mode);
+
+        if (d2 > 0) {
+            y--;
+            dy -= 2 * a2;
+            d2 += 4 * (a2 - dy);
+        } else {
+            y--;
+            x++;
+            dx += 2 * b2;
+            dy -= 2 * a2;
+            d2 += 4 * (dx - dy + a2);
+        }
+    }
+
+    /* Row 0 reaches out to rx; flat ellipses arrive here with x still short of it */
+    if (fill) {
+        raster_ellipse_row(cx, cy, rx, 0, true, mode);
+    } else {
+        raster_fill_rect(cx + x, cy, rx - x + 1, 1, mode);
+        raster_fill_rect(cx - rx, cy, rx - x + 1, 1, mode);
+    }
+}
+
+/**
+ * @brief Direction vector for an angle in degrees, Q14 fixed point
+ */
+static void raster_angle_vector(int32_t angle, int32_t *vx, int32_t *vy)
+{
+    angle %= 360;
+    if (angle < 0) {
+        angle += 360;
+    }
+
+    int32_t quadrant = angle / 90;
+    int32_t rem = angle % 90;
+    int32_t s = sin_table_q14[rem];
+    int32_t c = sin_table_q14[90 - rem];
+
+    switch (quadrant) {
+        case 0:  *vx = c;  *vy = s;  break;
+        case 1:  *vx = -s; *vy = c;  break;
+        case 2:  *vx = -c; *vy = -s; break;
+        default: *vx = s;  *vy = -c; break;
+    }
+}
+
+/**
+ * @brief 2D cross product, positive when b is clockwise of a on screen
+ */
+static int64_t raster_cross(int32_t ax, int32_t ay, int32_t bx, int32_t by)
+{
+    return (int64_t)ax * by - (int64_t)ay * bx;
+}
+
+/**
+ * @brief Plot an outline point if it lies inside the arc's sweep
+ */
+static void raster_arc_point(int32_t cx, int32_t cy, int32_t px, int32_t py,
+                             const int32_t *start, const int32_t *end, bool major,
+                             hal_graphics_mode_t mode)
+{
+    bool inside;
+
+    if (major) {
+        /* Sweeps over 180 degrees: inside unless strictly within the gap */
+        inside = !(raster_cross(end[0], end[1], px, py) > 0 &&
+                   raster_cross(px, py, start[0], start[1]) > 0);
+    } else {
+        inside = raster_cross(start[0], start[1], px, py) >= 0 &&
+                 raster_cross(px, py, end[0], end[1]) >= 0;
+    }
+
+    if (inside) {
+        raster_pixel(cx + px, cy + py, mode);
+    }
+}
+
+/**
+ * @brief Midpoint circle restricted to an angular range
+ *
+ * Start and end angles become Q14 direction vectors once; each outline point
+ * is then accepted or rejected with two integer cross products.
+ */
+static void raster_arc(int32_t cx, int32_t cy, int32_t r, int32_t start_angle, int32_t sweep_angle,
+                       hal_graphics_mode_t mode)
+{
+    int32_t start[2];
+    int32_t end[2];
+    bool major = sweep_angle > 180;
+
+    raster_angle_vector(start_angle, &start[0], &start[1]);
+    raster_angle_vector(start_angle + sweep_angle, &end[0], &end[1]);
+
+    if (r == 0) {
+        raster_pixel(cx, cy, mode);
+        return;
+    }
+
+    int32_t x = 0;
+    int32_t y = r;
+    int32_t d = 1 - r;
+
+    while (x <= y) {
+        /* Octant points, skipping duplicates on the axes and diagonals */
+        raster_arc_point(cx, cy, x, y, start, end, major, mode);
+        raster_arc_point(cx, cy, -y, x, start, end, major, mode);
+        raster_arc_point(cx, cy, -x, -y, start, end, major, mode);
+        raster_arc_point(cx, cy, y, -x, start, end, major, mode);
+        if (x != 0 && x != y) {
+            raster_arc_point(cx, cy, -x, y, start, end, major, mode);
+            raster_arc_point(cx, cy, -y, -x, start, end, major, mode);
+            raster_arc_point(cx, cy, x, -y, start, end, major, mode);
+            raster_arc_point(cx, cy, y, x, start, end, major, mode);
+        }
+
+        if (d < 0) {
+            d += 2 * x + 3;
+        } else {
+            d += 2 * (x - y) + 5;
+            y--;
+        }
+        x++;
+    }
 }
\ No newline at end of file
@@ -0,0 +1,1398 @@
+/**
+ * @file hal_font_data.c
+ * @brief Built-in font atlases
+ *
+ * Generated by scripts/bdf2font.py from the BDF sources in src/hal/fonts.
+ * Do not edit by hand; regenerate with the 'fonts' build target.
+ */
+
+#include "hal_font.h"
+#include <stddef.h>
+
+/* small: tng_5x7.bdf, 8 px, fixed */
+static const uint8_t small_bitmap[] = {
+    /* '!' */
+    0x00, 0x00, 0x5F, 0x00, 0x00,
+    /* '"' */
+    0x00, 0x07, 0x00, 0x07, 0x00,
+    /* '#' */
+    0x14, 0x7F, 0x14, 0x7F, 0x14,
+    /* '$' */
+    0x24, 0x2A, 0x7F, 0x2A, 0x12,
+    /* '%' */
+    0x23, 0x13, 0x08, 0x64, 0x62,
+    /* '&' */
+    0x36, 0x49, 0x56, 0x20, 0x50,
+    /* apostrophe */
+    0x00, 0x05, 0x03, 0x00, 0x00,
+    /* '(' */
+    0x00, 0x1C, 0x22, 0x41, 0x00,
+    /* ')' */
+    0x00, 0x41, 0x22, 0x1C, 0x00,
+    /* '*' */
+    0x08, 0x2A, 0x1C, 0x2A, 0x08,
+    /* '+' */
+    0x08, 0x08, 0x3E, 0x08, 0x08,
+    /* ',' */
+    0x00, 0x50, 0x30, 0x00, 0x00,
+    /* '-' */
+    0x08, 0x08, 0x08, 0x08, 0x08,
+    /* '.' */
+    0x00, 0x60, 0x60, 0x00, 0x00,
+    /* '/' */
+    0x20, 0x10, 0x08, 0x04, 0x02,
+    /* '0' */
+    0x3E, 0x51, 0x49, 0x45, 0x3E,
+    /* '1' */
+    0x00, 0x42, 0x7F, 0x40, 0x00,
+    /* '2' */
+    0x42, 0x61, 0x51, 0x49, 0x46,
+    /* '3' */
+    0x21, 0x41, 0x45, 0x4B, 0x31,
+    /* '4' */
+    0x18, 0x14, 0x12, 0x7F, 0x10,
+    /* '5' */
+    0x27, 0x45, 0x45, 0x45, 0x39,
+    /* '6' */
+    0x3C, 0x4A, 0x49, 0x49, 0x30,
+    /* '7' */
+    0x01, 0x71, 0x09, 0x05, 0x03,
+    /* '8' */
+    0x36, 0x49, 0x49, 0x49, 0x36,
+    /* '9' */
+    0x06, 0x49, 0x49, 0x29, 0x1E,
+    /* ':' */
+    0x00, 0x36, 0x36, 0x00, 0x00,
+    /* ';' */
+    0x00, 0x56, 0x36, 0x00, 0x00,
+    /* '<' */
+    0x00, 0x08, 0x14, 0x22, 0x41,
+    /* '=' */
+    0x14, 0x14, 0x14, 0x14, 0x14,
+    /* '>' */
+    0x41, 0x22, 0x14, 0x08, 0x00,
+    /* '?' */
+    0x02, 0x01, 0x51, 0x09, 0x06,
+    /* '@' */
+    0x32, 0x49, 0x79, 0x41, 0x3E,
+    /* 'A' */
+    0x7E, 0x11, 0x11, 0x11, 0x7E,
+    /* 'B' */
+    0x7F, 0x49, 0x49, 0x49, 0x36,
+    /* 'C' */
+    0x3E, 0x41, 0x41, 0x41, 0x22,
+    /* 'D' */
+    0x7F, 0x41, 0x41, 0x22, 0x1C,
+    /* 'E' */
+    0x7F, 0x49, 0x49, 0x49, 0x41,
+    /* 'F' */
+    0x7F, 0x09, 0x09, 0x09, 0x01,
+    /* 'G' */
+    0x3E, 0x41, 0x49, 0x49, 0x7A,
+    /* 'H' */
+    0x7F, 0x08, 0x08, 0x08, 0x7F,
+    /* 'I' */
+    0x00, 0x41, 0x7F, 0x41, 0x00,
+    /* 'J' */
+    0x20, 0x40, 0x41, 0x3F, 0x01,
+    /* 'K' */
+    0x7F, 0x08, 0x14, 0x22, 0x41,
+    /* 'L' */
+    0x7F, 0x40, 0x40, 0x40, 0x40,
+    /* 'M' */
+    0x7F, 0x02, 0x0C, 0x02, 0x7F,
+    /* 'N' */
+    0x7F, 0x04, 0x08, 0x10, 0x7F,
+    /* 'O' */
+    0x3E, 0x41, 0x41, 0x41, 0x3E,
+    /* 'P' */
+    0x7F, 0x09, 0x09, 0x09, 0x06,
+    /* 'Q' */
+    0x3E, 0x41, 0x51, 0x21, 0x5E,
+    /* 'R' */
+    0x7F, 0x09, 0x19, 0x29, 0x46,
+    /* 'S' */
+    0x46, 0x49, 0x49, 0x49, 0x31,
+    /* 'T' */
+    0x01, 0x01, 0x7F, 0x01, 0x01,
+    /* 'U' */
+    0x3F, 0x40, 0x40, 0x40, 0x3F,
+    /* 'V' */
+    0x1F, 0x20, 0x40, 0x20, 0x1F,
+    /* 'W' */
+    0x3F, 0x40, 0x38, 0x40, 0x3F,
+    /* 'X' */
+    0x63, 0x14, 0x08, 0x14, 0x63,
+    /* 'Y' */
+    0x07, 0x08, 0x70, 0x08, 0x07,
+    /* 'Z' */
+    0x61, 0x51, 0x49, 0x45, 0x43,
+    /* '[' */
+    0x00, 0x7F, 0x41, 0x41, 0x00,
+    /* backslash */
+    0x02, 0x04, 0x08, 0x10, 0x20,
+    /* ']' */
+    0x00, 0x41, 0x41, 0x7F, 0x00,
+    /* '^' */
+    0x04, 0x02, 0x01, 0x02, 0x04,
+    /* '_' */
+    0x40, 0x40, 0x40, 0x40, 0x40,
+    /* '`' */
+    0x00, 0x01, 0x02, 0x04, 0x00,
+    /* 'a' */
+    0x20, 0x54, 0x54, 0x54, 0x78,
+    /* 'b' */
+    0x7F, 0x48, 0x44, 0x44, 0x38,
+    /* 'c' */
+    0x38, 0x44, 0x44, 0x44, 0x20,
+    /* 'd' */
+    0x38, 0x44, 0x44, 0x48, 0x7F,
+    /* 'e' */
+    0x38, 0x54, 0x54, 0x54, 0x18,
+    /* 'f' */
+    0x08, 0x7E, 0x09, 0x01, 0x02,
+    /* 'g' */
+    0x0C, 0x52, 0x52, 0x52, 0x3E,
+    /* 'h' */
+    0x7F, 0x08, 0x04, 0x04, 0x78,
+    /* 'i' */
+    0x00, 0x44, 0x7D, 0x40, 0x00,
+    /* 'j' */
+    0x20, 0x40, 0x44, 0x3D, 0x00,
+    /* 'k' */
+    0x7F, 0x10, 0x28, 0x44, 0x00,
+    /* 'l' */
+    0x00, 0x41, 0x7F, 0x40, 0x00,
+    /* 'm' */
+    0x7C, 0x04, 0x18, 0x04, 0x78,
+    /* 'n' */
+    0x7C, 0x08, 0x04, 0x04, 0x78,
+    /* 'o' */
+    0x38, 0x44, 0x44, 0x44, 0x38,
+    /* 'p' */
+    0x7C, 0x14, 0x14, 0x14, 0x08,
+    /* 'q' */
+    0x08, 0x14, 0x14, 0x18, 0x7C,
+    /* 'r' */
+    0x7C, 0x08, 0x04, 0x04, 0x08,
+    /* 's' */
+    0x48, 0x54, 0x54, 0x54, 0x20,
+    /* 't' */
+    0x04, 0x3F, 0x44, 0x40, 0x20,
+    /* 'u' */
+    0x3C, 0x40, 0x40, 0x20, 0x7C,
+    /* 'v' */
+    0x1C, 0x20, 0x40, 0x20, 0x1C,
+    /* 'w' */
+    0x3C, 0x40, 0x30, 0x40, 0x3C,
+    /* 'x' */
+    0x44, 0x28, 0x10, 0x28, 0x44,
+    /* 'y' */
+    0x0C, 0x50, 0x50, 0x50, 0x3C,
+    /* 'z' */
+    0x44, 0x64, 0x54, 0x4C, 0x44,
+    /* '{' */
+    0x00, 0x08, 0x36, 0x41, 0x00,
+    /* '|' */
+    0x00, 0x00, 0x7F, 0x00, 0x00,
+    /* '}' */
+    0x00, 0x41, 0x36, 0x08, 0x00,
+    /* '~' */
+    0x08, 0x04, 0x08, 0x10, 0x08,
+};
+
+static const hal_font_glyph_t small_glyphs[] = {
+    {     0,  0,  6 },  /* space */
+    {     0,  5,  6 },  /* '!' */
+    {     5,  5,  6 },  /* '"' */
+    {    10,  5,  6 },  /* '#' */
+    {    15,  5,  6 },  /* '$' */
+    {    20,  5,  6 },  /* '%' */
+    {    25,  5,  6 },  /* '&' */
+    {    30,  5,  6 },  /* apostrophe */
+    {    35,  5,  6 },  /* '(' */
+    {    40,  5,  6 },  /* ')' */
+    {    45,  5,  6 },  /* '*' */
+    {    50,  5,  6 },  /* '+' */
+    {    55,  5,  6 },  /* ',' */
+    {    60,  5,  6 },  /* '-' */
+    {    65,  5,  6 },  /* '.' */
+    {    70,  5,  6 },  /* '/' */
+    {    75,  5,  6 },  /* '0' */
+    {    80,  5,  6 },  /* '1' */
+    {    85,  5,  6 },  /* '2' */
+    {    90,  5,  6 },  /* '3' */
+    {    95,  5,  6 },  /* '4' */
+    {   100,  5,  6 },  /* '5' */
+    {   105,  5,  6 },  /* '6' */
+    {   110,  5,  6 },  /* '7' */
+    {   115,  5,  6 },  /* '8' */
+    {   120,  5,  6 },  /* '9' */
+    {   125,  5,  6 },  /* ':' */
+    {   130,  5,  6 },  /* ';' */
+    {   135,  5,  6 },  /* '<' */
+    {   140,  5,  6 },  /* '=' */
+    {   145,  5,  6 },  /* '>' */
+    {   150,  5,  6 },  /* '?' */
+    {   155,  5,  6 },  /* '@' */
+    {   160,  5,  6 },  /* 'A' */
+    {   165,  5,  6 },  /* 'B' */
+    {   170,  5,  6 },  /* 'C' */
+    {   175,  5,  6 },  /* 'D' */
+    {   180,  5,  6 },  /* 'E' */
+    {   185,  5,  6 },  /* 'F' */
+    {   190,  5,  6 },  /* 'G' */
+    {   195,  5,  6 },  /* 'H' */
+    {   200,  5,  6 },  /* 'I' */
+    {   205,  5,  6 },  /* 'J' */
+    {   210,  5,  6 },  /* 'K' */
+    {   215,  5,  6 },  /* 'L' */
+    {   220,  5,  6 },  /* 'M' */
+    {   225,  5,  6 },  /* 'N' */
+    {   230,  5,  6 },  /* 'O' */
+    {   235,  5,  6 },  /* 'P' */
+    {   240,  5,  6 },  /* 'Q' */
+    {   245,  5,  6 },  /* 'R' */
+    {   250,  5,  6 },  /* 'S' */
+    {   255,  5,  6 },  /* 'T' */
+    {   260,  5,  6 },  /* 'U' */
+    {   265,  5,  6 },  /* 'V' */
+    {   270,  5,  6 },  /* 'W' */
+    {   275,  5,  6 },  /* 'X' */
+    {   280,  5,  6 },  /* 'Y' */
+    {   285,  5,  6 },  /* 'Z' */
+    {   290,  5,  6 },  /* '[' */
+    {   295,  5,  6 },  /* backslash */
+    {   300,  5,  6 },  /* ']' */
+    {   305,  5,  6 },  /* '^' */
+    {   310,  5,  6 },  /* '_' */
+    {   315,  5,  6 },  /* '`' */
+    {   320,  5,  6 },  /* 'a' */
+    {   325,  5,  6 },  /* 'b' */
+    {   330,  5,  6 },  /* 'c' */
+    {   335,  5,  6 },  /* 'd' */
+    {   340,  5,  6 },  /* 'e' */
+    {   345,  5,  6 },  /* 'f' */
+    {   350,  5,  6 },  /* 'g' */
+    {   355,  5,  6 },  /* 'h' */
+    {   360,  5,  6 },  /* 'i' */
+    {   365,  5,  6 },  /* 'j' */
+    {   370,  5,  6 },  /* 'k' */
+    {   375,  5,  6 },  /* 'l' */
+    {   380,  5,  6 },  /* 'm' */
+    {   385,  5,  6 },  /* 'n' */
+    {   390,  5,  6 },  /* 'o' */
+    {   395,  5,  6 },  /* 'p' */
+    {   400,  5,  6 },  /* 'q' */
+    {   405,  5,  6 },  /* 'r' */
+    {   410,  5,  6 },  /* 's' */
+    {   415,  5,  6 },  /* 't' */
+    {   420,  5,  6 },  /* 'u' */
+    {   425,  5,  6 },  /* 'v' */
+    {   430,  5,  6 },  /* 'w' */
+    {   435,  5,  6 },  /* 'x' */
+    {   440,  5,  6 },  /* 'y' */
+    {   445,  5,  6 },  /* 'z' */
+    {   450,  5,  6 },  /* '{' */
+    {   455,  5,  6 },  /* '|' */
+    {   460,  5,  6 },  /* '}' */
+    {   465,  5,  6 },  /* '~' */
+};
+
+const hal_font_t hal_font_small = {
+    .height = 8,
+    .cell_width = 6,
+    .first_char = 32,
+    .last_char = 126,
+    .default_char = 32,
+    .flags = 0,
+    .kerning_count = 0,
+    .glyphs = small_glyphs,
+    .bitmap = small_bitmap,
+    .kerning = NULL,
+};
+
+/* medium: tng_5x7.bdf, 8 px, proportional */
+static const uint8_t medium_bitmap[] = {
+    /* '!' */
+    0x5F,
+    /* '"' */
+    0x07, 0x00, 0x07,
+    /* '#' */
+    0x14, 0x7F, 0x14, 0x7F, 0x14,
+    /* '$' */
+    0x24, 0x2A, 0x7F, 0x2A, 0x12,
+    /* '%' */
+    0x23, 0x13, 0x08, 0x64, 0x62,
+    /* '&' */
+    0x36, 0x49, 0x56, 0x20, 0x50,
+    /* apostrophe */
+    0x05, 0x03,
+    /* '(' */
+    0x1C, 0x22, 0x41,
+    /* ')' */
+    0x41, 0x22, 0x1C,
+    /* '*' */
+    0x08, 0x2A, 0x1C, 0x2A, 0x08,
+    /* '+' */
+    0x08, 0x08, 0x3E, 0x08, 0x08,
+    /* ',' */
+    0x50, 0x30,
+    /* '-' */
+    0x08, 0x08, 0x08, 0x08, 0x08,
+    /* '.' */
+    0x60, 0x60,
+    /* '/' */
+    0x20, 0x10, 0x08, 0x04, 0x02,
+    /* '0' */
+    0x3E, 0x51, 0x49, 0x45, 0x3E,
+    /* '1' */
+    0x42, 0x7F, 0x40,
+    /* '2' */
+    0x42, 0x61, 0x51, 0x49, 0x46,
+    /* '3' */
+    0x21, 0x41, 0x45, 0x4B, 0x31,
+    /* '4' */
+    0x18, 0x14, 0x12, 0x7F, 0x10,
+    /* '5' */
+    0x27, 0x45, 0x45, 0x45, 0x39,
+    /* '6' */
+    0x3C, 0x4A, 0x49, 0x49, 0x30,
+    /* '7' */
+    0x01, 0x71, 0x09, 0x05, 0x03,
+    /* '8' */
+    0x36, 0x49, 0x49, 0x49, 0x36,
+    /* '9' */
+    0x06, 0x49, 0x49, 0x29, 0x1E,
+    /* ':' */
+    0x36, 0x36,
+    /* ';' */
+    0x56, 0x36,
+    /* '<' */
+    0x08, 0x14, 0x22, 0x41,
+    /* '=' */
+    0x14, 0x14, 0x14, 0x14, 0x14,
+    /* '>' */
+    0x41, 0x22, 0x14, 0x08,
+    /* '?' */
+    0x02, 0x01, 0x51, 0x09, 0x06,
+    /* '@' */
+    0x32, 0x49, 0x79, 0x41, 0x3E,
+    /* 'A' */
+    0x7E, 0x11, 0x11, 0x11, 0x7E,
+    /* 'B' */
+    0x7F, 0x49, 0x49, 0x49, 0x36,
+    /* 'C' */
+    0x3E, 0x41, 0x41, 0x41, 0x22,
+    /* 'D' */
+    0x7F, 0x41, 0x41, 0x22, 0x1C,
+    /* 'E' */
+    0x7F, 0x49, 0x49, 0x49, 0x41,
+    /* 'F' */
+    0x7F, 0x09, 0x09, 0x09, 0x01,
+    /* 'G' */
+    0x3E, 0x41, 0x49, 0x49, 0x7A,
+    /* 'H' */
+    0x7F, 0x08, 0x08, 0x08, 0x7F,
+    /* 'I' */
+    0x41, 0x7F, 0x41,
+    /* 'J' */
+    0x20, 0x40, 0x41, 0x3F, 0x01,
+    /* 'K' */
+    0x7F, 0x08, 0x14, 0x22, 0x41,
+    /* 'L' */
+    0x7F, 0x40, 0x40, 0x40, 0x40,
+    /* 'M' */
+    0x7F, 0x02, 0x0C, 0x02, 0x7F,
+    /* 'N' */
+    0x7F, 0x04, 0x08, 0x10, 0x7F,
+    /* 'O' */
+    0x3E, 0x41, 0x41, 0x41, 0x3E,
+    /* 'P' */
+    0x7F, 0x09, 0x09, 0x09, 0x06,
+    /* 'Q' */
+    0x3E, 0x41, 0x51, 0x21, 0x5E,
+    /* 'R' */
+    0x7F, 0x09, 0x19, 0x29, 0x46,
+    /* 'S' */
+    0x46, 0x49, 0x49, 0x49, 0x31,
+    /* 'T' */
+    0x01, 0x01, 0x7F, 0x01, 0x01,
+    /* 'U' */
+    0x3F, 0x40, 0x40, 0x40, 0x3F,
+    /* 'V' */
+    0x1F, 0x20, 0x40, 0x20, 0x1F,
+    /* 'W' */
+    0x3F, 0x40, 0x38, 0x40, 0x3F,
+    /* 'X' */
+    0x63, 0x14, 0x08, 0x14, 0x63,
+    /* 'Y' */
+    0x07, 0x08, 0x70, 0x08, 0x07,
+    /* 'Z' */
+    0x61, 0x51, 0x49, 0x45, 0x43,
+    /* '[' */
+    0x7F, 0x41, 0x41,
+    /* backslash */
+    0x02, 0x04, 0x08, 0x10, 0x20,
+    /* ']' */
+    0x41, 0x41, 0x7F,
+    /* '^' */
+    0x04, 0x02, 0x01, 0x02, 0x04,
+    /* '_' */
+    0x40, 0x40, 0x40, 0x40, 0x40,
+    /* '`' */
+    0x01, 0x02, 0x04,
+    /* 'a' */
+    0x20, 0x54, 0x54, 0x54, 0x78,
+    /* 'b' */
+    0x7F, 0x48, 0x44, 0x44, 0x38,
+    /* 'c' */
+    0x38, 0x44, 0x44, 0x44, 0x20,
+    /* 'd' */
+    0x38, 0x44, 0x44, 0x48, 0x7F,
+    /* 'e' */
+    0x38, 0x54, 0x54, 0x54, 0x18,
+    /* 'f' */
+    0x08, 0x7E, 0x09, 0x01, 0x02,
+    /* 'g' */
+    0x0C, 0x52, 0x52, 0x52, 0x3E,
+    /* 'h' */
+    0x7F, 0x08, 0x04, 0x04, 0x78,
+    /* 'i' */
+    0x44, 0x7D, 0x40,
+    /* 'j' */
+    0x20, 0x40, 0x44, 0x3D,
+    /* 'k' */
+    0x7F, 0x10, 0x28, 0x44,
+    /* 'l' */
+    0x41, 0x7F, 0x40,
+    /* 'm' */
+    0x7C, 0x04, 0x18, 0x04, 0x78,
+    /* 'n' */
+    0x7C, 0x08, 0x04, 0x04, 0x78,
+    /* 'o' */
+    0x38, 0x44, 0x44, 0x44, 0x38,
+    /* 'p' */
+    0x7C, 0x14, 0x14, 0x14, 0x08,
+    /* 'q' */
+    0x08, 0x14, 0x14, 0x18, 0x7C,
+    /* 'r' */
+    0x7C, 0x08, 0x04, 0x04, 0x08,
+    /* 's' */
+    0x48, 0x54, 0x54, 0x54, 0x20,
+    /* 't' */
+    0x04, 0x3F, 0x44, 0x40, 0x20,
+    /* 'u' */
+    0x3C, 0x40, 0x40, 0x20, 0x7C,
+    /* 'v' */
+    0x1C, 0x20, 0x40, 0x20, 0x1C,
+    /* 'w' */
+    0x3C, 0x40, 0x30, 0x40, 0x3C,
+    /* 'x' */
+    0x44, 0x28, 0x10, 0x28, 0x44,
+    /* 'y' */
+    0x0C, 0x50, 0x50, 0x50, 0x3C,
+    /* 'z' */
+    0x44, 0x64, 0x54, 0x4C, 0x44,
+    /* '{' */
+    0x08, 0x36, 0x41,
+    /* '|' */
+    0x7F,
+    /* '}' */
+    0x41, 0x36, 0x08,
+    /* '~' */
+    0x08, 0x04, 0x08, 0x10, 0x08,
+};
+
+static const hal_font_glyph_t medium_glyphs[] = {
+    {     0,  0,  3 },  /* space */
+    {     0,  1,  2 },  /* '!' */
+    {     1,  3,  4 },  /* '"' */
+    {     4,  5,  6 },  /* '#' */
+    {     9,  5,  6 },  /* '$' */
+    {    14,  5,  6 },  /* '%' */
+    {    19,  5,  6 },  /* '&' */
+    {    24,  2,  3 },  /* apostrophe */
+    {    26,  3,  4 },  /* '(' */
+    {    29,  3,  4 },  /* ')' */
+    {    32,  5,  6 },  /* '*' */
+    {    37,  5,  6 },  /* '+' */
+    {    42,  2,  3 },  /* ',' */
+    {    44,  5,  6 },  /* '-' */
+    {    49,  2,  3 },  /* '.' */
+    {    51,  5,  6 },  /* '/' */
+    {    56,  5,  6 },  /* '0' */
+    {    61,  3,  4 },  /* '1' */
+    {    64,  5,  6 },  /* '2' */
+    {    69,  5,  6 },  /* '3' */
+    {    74,  5,  6 },  /* '4' */
+    {    79,  5,  6 },  /* '5' */
+    {    84,  5,  6 },  /* '6' */
+    {    89,  5,  6 },  /* '7' */
+    {    94,  5,  6 },  /* '8' */
+    {    99,  5,  6 },  /* '9' */
+    {   104,  2,  3 },  /* ':' */
+    {   106,  2,  3 },  /* ';' */
+    {   108,  4,  5 },  /* '<' */
+    {   112,  5,  6 },  /* '=' */
+    {   117,  4,  5 },  /* '>' */
+    {   121,  5,  6 },  /* '?' */
+    {   126,  5,  6 },  /* '@' */
+    {   131,  5,  6 },  /* 'A' */
+    {   136,  5,  6 },  /* 'B' */
+    {   141,  5,  6 },  /* 'C' */
+    {   146,  5,  6 },  /* 'D' */
+    {   151,  5,  6 },  /* 'E' */
+    {   156,  5,  6 },  /* 'F' */
+    {   161,  5,  6 },  /* 'G' */
+    {   166,  5,  6 },  /* 'H' */
+    {   171,  3,  4 },  /* 'I' */
+    {   174,  5,  6 },  /* 'J' */
+    {   179,  5,  6 },  /* 'K' */
+    {   184,  5,  6 },  /* 'L' */
+    {   189,  5,  6 },  /* 'M' */
+    {   194,  5,  6 },  /* 'N' */
+    {   199,  5,  6 },  /* 'O' */
+    {   204,  5,  6 },  /* 'P' */
+    {   209,  5,  6 },  /* 'Q' */
+    {   214,  5,  6 },  /* 'R' */
+    {   219,  5,  6 },  /* 'S' */
+    {   224,  5,  6 },  /* 'T' */
+    {   229,  5,  6 },  /* 'U' */
+    {   234,  5,  6 },  /* 'V' */
+    {   239,  5,  6 },  /* 'W' */
+    {   244,  5,  6 },  /* 'X' */
+    {   249,  5,  6 },  /* 'Y' */
+    {   254,  5,  6 },  /* 'Z' */
+    {   259,  3,  4 },  /* '[' */
+    {   262,  5,  6 },  /* backslash */
+    {   267,  3,  4 },  /* ']' */
+    {   270,  5,  6 },  /* '^' */
+    {   275,  5,  6 },  /* '_' */
+    {   280,  3,  4 },  /* '`' */
+    {   283,  5,  6 },  /* 'a' */
+    {   288,  5,  6 },  /* 'b' */
+    {   293,  5,  6 },  /* 'c' */
+    {   298,  5,  6 },  /* 'd' */
+    {   303,  5,  6 },  /* 'e' */
+    {   308,  5,  6 },  /* 'f' */
+    {   313,  5,  6 },  /* 'g' */
+    {   318,  5,  6 },  /* 'h' */
+    {   323,  3,  4 },  /* 'i' */
+    {   326,  4,  5 },  /* 'j' */
+    {   330,  4,  5 },  /* 'k' */
+    {   334,  3,  4 },  /* 'l' */
+    {   337,  5,  6 },  /* 'm' */
+    {   342,  5,  6 },  /* 'n' */
+    {   347,  5,  6 },  /* 'o' */
+    {   352,  5,  6 },  /* 'p' */
+    {   357,  5,  6 },  /* 'q' */
+    {   362,  5,  6 },  /* 'r' */
+    {   367,  5,  6 },  /* 's' */
+    {   372,  5,  6 },  /* 't' */
+    {   377,  5,  6 },  /* 'u' */
+    {   382,  5,  6 },  /* 'v' */
+    {   387,  5,  6 },  /* 'w' */
+    {   392,  5,  6 },  /* 'x' */
+    {   397,  5,  6 },  /* 'y' */
+    {   402,  5,  6 },  /* 'z' */
+    {   407,  3,  4 },  /* '{' */
+    {   410,  1,  2 },  /* '|' */
+    {   411,  3,  4 },  /* '}' */
+    {   414,  5,  6 },  /* '~' */
+};
+
+static const hal_font_kern_t medium_kerning[] = {
+    { 0x224A, -1 },  /* '"' 'J' */
+    { 0x2261, -1 },  /* '"' 'a' */
+    { 0x226A, -1 },  /* '"' 'j' */
+    { 0x2734, -1 },  /* apostrophe '4' */
+    { 0x274A, -1 },  /* apostrophe 'J' */
+    { 0x2761, -1 },  /* apostrophe 'a' */
+    { 0x2763, -1 },  /* apostrophe 'c' */
+    { 0x2764, -1 },  /* apostrophe 'd' */
+    { 0x2765, -1 },  /* apostrophe 'e' */
+    { 0x2766, -1 },  /* apostrophe 'f' */
+    { 0x276A, -1 },  /* apostrophe 'j' */
+    { 0x276F, -1 },  /* apostrophe 'o' */
+    { 0x2771, -1 },  /* apostrophe 'q' */
+    { 0x2773, -1 },  /* apostrophe 's' */
+    { 0x2C37, -1 },  /* ',' '7' */
+    { 0x2C39, -1 },  /* ',' '9' */
+    { 0x2C54, -1 },  /* ',' 'T' */
+    { 0x2C59, -1 },  /* ',' 'Y' */
+    { 0x2C74, -1 },  /* ',' 't' */
+    { 0x2D31, -1 },  /* '-' '1' */
+    { 0x2D32, -1 },  /* '-' '2' */
+    { 0x2D33, -1 },  /* '-' '3' */
+    { 0x2D37, -1 },  /* '-' '7' */
+    { 0x2D49, -1 },  /* '-' 'I' */
+    { 0x2D4A, -1 },  /* '-' 'J' */
+    { 0x2D54, -1 },  /* '-' 'T' */
+    { 0x2D58, -1 },  /* '-' 'X' */
+    { 0x2D5A, -1 },  /* '-' 'Z' */
+    { 0x2D61, -1 },  /* '-' 'a' */
+    { 0x2D6A, -1 },  /* '-' 'j' */
+    { 0x2D6C, -1 },  /* '-' 'l' */
+    { 0x2E37, -1 },  /* '.' '7' */
+    { 0x2E39, -1 },  /* '.' '9' */
+    { 0x2E54, -1 },  /* '.' 'T' */
+    { 0x2E59, -1 },  /* '.' 'Y' */
+    { 0x2E66, -1 },  /* '.' 'f' */
+    { 0x2E67, -1 },  /* '.' 'g' */
+    { 0x2E71, -1 },  /* '.' 'q' */
+    { 0x2E74, -1 },  /* '.' 't' */
+    { 0x2E79, -1 },  /* '.' 'y' */
+    { 0x3122, -1 },  /* '1' '"' */
+    { 0x3127, -1 },  /* '1' apostrophe */
+    { 0x312D, -1 },  /* '1' '-' */
+    { 0x3134, -1 },  /* '1' '4' */
+    { 0x3137, -1 },  /* '1' '7' */
+    { 0x3139, -1 },  /* '1' '9' */
+    { 0x3154, -1 },  /* '1' 'T' */
+    { 0x3156, -1 },  /* '1' 'V' */
+    { 0x3159, -1 },  /* '1' 'Y' */
+    { 0x3166, -1 },  /* '1' 'f' */
+    { 0x3167, -1 },  /* '1' 'g' */
+    { 0x3171, -1 },  /* '1' 'q' */
+    { 0x3174, -1 },  /* '1' 't' */
+    { 0x3176, -1 },  /* '1' 'v' */
+    { 0x3179, -1 },  /* '1' 'y' */
+    { 0x3374, -1 },  /* '3' 't' */
+    { 0x3422, -1 },  /* '4' '"' */
+    { 0x3427, -1 },  /* '4' apostrophe */
+    { 0x3431, -1 },  /* '4' '1' */
+    { 0x3432, -1 },  /* '4' '2' */
+    { 0x3437, -1 },  /* '4' '7' */
+    { 0x3439, -1 },  /* '4' '9' */
+    { 0x3449, -1 },  /* '4' 'I' */
+    { 0x3453, -1 },  /* '4' 'S' */
+    { 0x3454, -1 },  /* '4' 'T' */
+    { 0x3459, -1 },  /* '4' 'Y' */
+    { 0x3469, -1 },  /* '4' 'i' */
+    { 0x346C, -1 },  /* '4' 'l' */
+    { 0x3474, -1 },  /* '4' 't' */
+    { 0x3478, -1 },  /* '4' 'x' */
+    { 0x347A, -1 },  /* '4' 'z' */
+    { 0x3622, -1 },  /* '6' '"' */
+    { 0x3627, -1 },  /* '6' apostrophe */
+    { 0x3637, -1 },  /* '6' '7' */
+    { 0x3639, -1 },  /* '6' '9' */
+    { 0x3654, -1 },  /* '6' 'T' */
+    { 0x3659, -1 },  /* '6' 'Y' */
+    { 0x3674, -1 },  /* '6' 't' */
+    { 0x372C, -1 },  /* '7' ',' */
+    { 0x372D, -1 },  /* '7' '-' */
+    { 0x372E, -1 },  /* '7' '.' */
+    { 0x3734, -1 },  /* '7' '4' */
+    { 0x374A, -1 },  /* '7' 'J' */
+    { 0x3761, -1 },  /* '7' 'a' */
+    { 0x3763, -1 },  /* '7' 'c' */
+    { 0x3764, -1 },  /* '7' 'd' */
+    { 0x3765, -1 },  /* '7' 'e' */
+    { 0x3766, -1 },  /* '7' 'f' */
+    { 0x376A, -1 },  /* '7' 'j' */
+    { 0x376F, -1 },  /* '7' 'o' */
+    { 0x3771, -1 },  /* '7' 'q' */
+    { 0x3773, -1 },  /* '7' 's' */
+    { 0x432D, -1 },  /* 'C' '-' */
+    { 0x4366, -1 },  /* 'C' 'f' */
+    { 0x4371, -1 },  /* 'C' 'q' */
+    { 0x4437, -1 },  /* 'D' '7' */
+    { 0x4449, -1 },  /* 'D' 'I' */
+    { 0x4454, -1 },  /* 'D' 'T' */
+    { 0x446C, -1 },  /* 'D' 'l' */
+    { 0x452D, -1 },  /* 'E' '-' */
+    { 0x4534, -1 },  /* 'E' '4' */
+    { 0x4566, -1 },  /* 'E' 'f' */
+    { 0x4567, -1 },  /* 'E' 'g' */
+    { 0x4571, -1 },  /* 'E' 'q' */
+    { 0x4574, -1 },  /* 'E' 't' */
+    { 0x4576, -1 },  /* 'E' 'v' */
+    { 0x4579, -1 },  /* 'E' 'y' */
+    { 0x462C, -1 },  /* 'F' ',' */
+    { 0x462D, -1 },  /* 'F' '-' */
+    { 0x462E, -1 },  /* 'F' '.' */
+    { 0x4634, -1 },  /* 'F' '4' */
+    { 0x4636, -1 },  /* 'F' '6' */
+    { 0x464A, -1 },  /* 'F' 'J' */
+    { 0x4661, -1 },  /* 'F' 'a' */
+    { 0x4663, -1 },  /* 'F' 'c' */
+    { 0x4664, -1 },  /* 'F' 'd' */
+    { 0x4665, -1 },  /* 'F' 'e' */
+    { 0x4666, -1 },  /* 'F' 'f' */
+    { 0x4667, -1 },  /* 'F' 'g' */
+    { 0x4669, -1 },  /* 'F' 'i' */
+    { 0x466A, -1 },  /* 'F' 'j' */
+    { 0x466D, -1 },  /* 'F' 'm' */
+    { 0x466E, -1 },  /* 'F' 'n' */
+    { 0x466F, -1 },  /* 'F' 'o' */
+    { 0x4670, -1 },  /* 'F' 'p' */
+    { 0x4671, -1 },  /* 'F' 'q' */
+    { 0x4672, -1 },  /* 'F' 'r' */
+    { 0x4673, -1 },  /* 'F' 's' */
+    { 0x4674, -1 },  /* 'F' 't' */
+    { 0x4675, -1 },  /* 'F' 'u' */
+    { 0x4676, -1 },  /* 'F' 'v' */
+    { 0x4677, -1 },  /* 'F' 'w' */
+    { 0x4678, -1 },  /* 'F' 'x' */
+    { 0x4679, -1 },  /* 'F' 'y' */
+    { 0x467A, -1 },  /* 'F' 'z' */
+    { 0x492D, -1 },  /* 'I' '-' */
+    { 0x4934, -1 },  /* 'I' '4' */
+    { 0x4966, -1 },  /* 'I' 'f' */
+    { 0x4967, -1 },  /* 'I' 'g' */
+    { 0x4971, -1 },  /* 'I' 'q' */
+    { 0x4974, -1 },  /* 'I' 't' */
+    { 0x4976, -1 },  /* 'I' 'v' */
+    { 0x4979, -1 },  /* 'I' 'y' */
+    { 0x4A2C, -1 },  /* 'J' ',' */
+    { 0x4A2D, -1 },  /* 'J' '-' */
+    { 0x4A2E, -1 },  /* 'J' '.' */
+    { 0x4A34, -1 },  /* 'J' '4' */
+    { 0x4A36, -1 },  /* 'J' '6' */
+    { 0x4A4A, -1 },  /* 'J' 'J' */
+    { 0x4A61, -1 },  /* 'J' 'a' */
+    { 0x4A63, -1 },  /* 'J' 'c' */
+    { 0x4A64, -1 },  /* 'J' 'd' */
+    { 0x4A65, -1 },  /* 'J' 'e' */
+    { 0x4A66, -1 },  /* 'J' 'f' */
+    { 0x4A67, -1 },  /* 'J' 'g' */
+    { 0x4A69, -1 },  /* 'J' 'i' */
+    { 0x4A6A, -1 },  /* 'J' 'j' */
+    { 0x4A6D, -1 },  /* 'J' 'm' */
+    { 0x4A6E, -1 },  /* 'J' 'n' */
+    { 0x4A6F, -1 },  /* 'J' 'o' */
+    { 0x4A70, -1 },  /* 'J' 'p' */
+    { 0x4A71, -1 },  /* 'J' 'q' */
+    { 0x4A72, -1 },  /* 'J' 'r' */
+    { 0x4A73, -1 },  /* 'J' 's' */
+    { 0x4A74, -1 },  /* 'J' 't' */
+    { 0x4A75, -1 },  /* 'J' 'u' */
+    { 0x4A76, -1 },  /* 'J' 'v' */
+    { 0x4A77, -1 },  /* 'J' 'w' */
+    { 0x4A78, -1 },  /* 'J' 'x' */
+    { 0x4A79, -1 },  /* 'J' 'y' */
+    { 0x4A7A, -1 },  /* 'J' 'z' */
+    { 0x4B2D, -1 },  /* 'K' '-' */
+    { 0x4B34, -1 },  /* 'K' '4' */
+    { 0x4B66, -1 },  /* 'K' 'f' */
+    { 0x4B67, -1 },  /* 'K' 'g' */
+    { 0x4B71, -1 },  /* 'K' 'q' */
+    { 0x4B74, -1 },  /* 'K' 't' */
+    { 0x4B76, -1 },  /* 'K' 'v' */
+    { 0x4B79, -1 },  /* 'K' 'y' */
+    { 0x4C22, -1 },  /* 'L' '"' */
+    { 0x4C27, -1 },  /* 'L' apostrophe */
+    { 0x4C2D, -1 },  /* 'L' '-' */
+    { 0x4C34, -1 },  /* 'L' '4' */
+    { 0x4C37, -1 },  /* 'L' '7' */
+    { 0x4C39, -1 },  /* 'L' '9' */
+    { 0x4C54, -1 },  /* 'L' 'T' */
+    { 0x4C56, -1 },  /* 'L' 'V' */
+    { 0x4C59, -1 },  /* 'L' 'Y' */
+    { 0x4C66, -1 },  /* 'L' 'f' */
+    { 0x4C67, -1 },  /* 'L' 'g' */
+    { 0x4C71, -1 },  /* 'L' 'q' */
+    { 0x4C74, -1 },  /* 'L' 't' */
+    { 0x4C76, -1 },  /* 'L' 'v' */
+    { 0x4C79, -1 },  /* 'L' 'y' */
+    { 0x502C, -1 },  /* 'P' ',' */
+    { 0x502E, -1 },  /* 'P' '.' */
+    { 0x504A, -1 },  /* 'P' 'J' */
+    { 0x5061, -1 },  /* 'P' 'a' */
+    { 0x506A, -1 },  /* 'P' 'j' */
+    { 0x5374, -1 },  /* 'S' 't' */
+    { 0x542C, -1 },  /* 'T' ',' */
+    { 0x542D, -1 },  /* 'T' '-' */
+    { 0x542E, -1 },  /* 'T' '.' */
+    { 0x5434, -1 },  /* 'T' '4' */
+    { 0x5436, -1 },  /* 'T' '6' */
+    { 0x544A, -1 },  /* 'T' 'J' */
+    { 0x5461, -1 },  /* 'T' 'a' */
+    { 0x5463, -1 },  /* 'T' 'c' */
+    { 0x5464, -1 },  /* 'T' 'd' */
+    { 0x5465, -1 },  /* 'T' 'e' */
+    { 0x5466, -1 },  /* 'T' 'f' */
+    { 0x5467, -1 },  /* 'T' 'g' */
+    { 0x5469, -1 },  /* 'T' 'i' */
+    { 0x546A, -1 },  /* 'T' 'j' */
+    { 0x546D, -1 },  /* 'T' 'm' */
+    { 0x546E, -1 },  /* 'T' 'n' */
+    { 0x546F, -1 },  /* 'T' 'o' */
+    { 0x5470, -1 },  /* 'T' 'p' */
+    { 0x5471, -1 },  /* 'T' 'q' */
+    { 0x5472, -1 },  /* 'T' 'r' */
+    { 0x5473, -1 },  /* 'T' 's' */
+    { 0x5474, -1 },  /* 'T' 't' */
+    { 0x5475, -1 },  /* 'T' 'u' */
+    { 0x5476, -1 },  /* 'T' 'v' */
+    { 0x5477, -1 },  /* 'T' 'w' */
+    { 0x5478, -1 },  /* 'T' 'x' */
+    { 0x5479, -1 },  /* 'T' 'y' */
+    { 0x547A, -1 },  /* 'T' 'z' */
+    { 0x582D, -1 },  /* 'X' '-' */
+    { 0x5866, -1 },  /* 'X' 'f' */
+    { 0x5871, -1 },  /* 'X' 'q' */
+    { 0x592C, -1 },  /* 'Y' ',' */
+    { 0x592E, -1 },  /* 'Y' '.' */
+    { 0x594A, -1 },  /* 'Y' 'J' */
+    { 0x5961, -1 },  /* 'Y' 'a' */
+    { 0x596A, -1 },  /* 'Y' 'j' */
+    { 0x5A2D, -1 },  /* 'Z' '-' */
+    { 0x5A34, -1 },  /* 'Z' '4' */
+    { 0x5A66, -1 },  /* 'Z' 'f' */
+    { 0x5A71, -1 },  /* 'Z' 'q' */
+    { 0x6137, -1 },  /* 'a' '7' */
+    { 0x6154, -1 },  /* 'a' 'T' */
+    { 0x6237, -1 },  /* 'b' '7' */
+    { 0x6254, -1 },  /* 'b' 'T' */
+    { 0x6322, -1 },  /* 'c' '"' */
+    { 0x6327, -1 },  /* 'c' apostrophe */
+    { 0x632D, -1 },  /* 'c' '-' */
+    { 0x6337, -1 },  /* 'c' '7' */
+    { 0x6339, -1 },  /* 'c' '9' */
+    { 0x6354, -1 },  /* 'c' 'T' */
+    { 0x6359, -1 },  /* 'c' 'Y' */
+    { 0x6366, -1 },  /* 'c' 'f' */
+    { 0x6367, -1 },  /* 'c' 'g' */
+    { 0x6371, -1 },  /* 'c' 'q' */
+    { 0x6374, -1 },  /* 'c' 't' */
+    { 0x6379, -1 },  /* 'c' 'y' */
+    { 0x6531, -1 },  /* 'e' '1' */
+    { 0x6532, -1 },  /* 'e' '2' */
+    { 0x6537, -1 },  /* 'e' '7' */
+    { 0x6549, -1 },  /* 'e' 'I' */
+    { 0x6554, -1 },  /* 'e' 'T' */
+    { 0x656C, -1 },  /* 'e' 'l' */
+    { 0x662C, -1 },  /* 'f' ',' */
+    { 0x662D, -1 },  /* 'f' '-' */
+    { 0x662E, -1 },  /* 'f' '.' */
+    { 0x6634, -1 },  /* 'f' '4' */
+    { 0x664A, -1 },  /* 'f' 'J' */
+    { 0x6661, -1 },  /* 'f' 'a' */
+    { 0x6663, -1 },  /* 'f' 'c' */
+    { 0x6664, -1 },  /* 'f' 'd' */
+    { 0x6665, -1 },  /* 'f' 'e' */
+    { 0x6666, -1 },  /* 'f' 'f' */
+    { 0x666A, -1 },  /* 'f' 'j' */
+    { 0x666F, -1 },  /* 'f' 'o' */
+    { 0x6671, -1 },  /* 'f' 'q' */
+    { 0x6673, -1 },  /* 'f' 's' */
+    { 0x6837, -1 },  /* 'h' '7' */
+    { 0x6854, -1 },  /* 'h' 'T' */
+    { 0x6922, -1 },  /* 'i' '"' */
+    { 0x6927, -1 },  /* 'i' apostrophe */
+    { 0x692D, -1 },  /* 'i' '-' */
+    { 0x6934, -1 },  /* 'i' '4' */
+    { 0x6937, -1 },  /* 'i' '7' */
+    { 0x6939, -1 },  /* 'i' '9' */
+    { 0x6954, -1 },  /* 'i' 'T' */
+    { 0x6956, -1 },  /* 'i' 'V' */
+    { 0x6959, -1 },  /* 'i' 'Y' */
+    { 0x6966, -1 },  /* 'i' 'f' */
+    { 0x6967, -1 },  /* 'i' 'g' */
+    { 0x6971, -1 },  /* 'i' 'q' */
+    { 0x6974, -1 },  /* 'i' 't' */
+    { 0x6976, -1 },  /* 'i' 'v' */
+    { 0x6979, -1 },  /* 'i' 'y' */
+    { 0x6B37, -1 },  /* 'k' '7' */
+    { 0x6B54, -1 },  /* 'k' 'T' */
+    { 0x6C22, -1 },  /* 'l' '"' */
+    { 0x6C27, -1 },  /* 'l' apostrophe */
+    { 0x6C2D, -1 },  /* 'l' '-' */
+    { 0x6C34, -1 },  /* 'l' '4' */
+    { 0x6C37, -1 },  /* 'l' '7' */
+    { 0x6C39, -1 },  /* 'l' '9' */
+    { 0x6C54, -1 },  /* 'l' 'T' */
+    { 0x6C56, -1 },  /* 'l' 'V' */
+    { 0x6C59, -1 },  /* 'l' 'Y' */
+    { 0x6C66, -1 },  /* 'l' 'f' */
+    { 0x6C67, -1 },  /* 'l' 'g' */
+    { 0x6C71, -1 },  /* 'l' 'q' */
+    { 0x6C74, -1 },  /* 'l' 't' */
+    { 0x6C76, -1 },  /* 'l' 'v' */
+    { 0x6C79, -1 },  /* 'l' 'y' */
+    { 0x6D37, -1 },  /* 'm' '7' */
+    { 0x6D54, -1 },  /* 'm' 'T' */
+    { 0x6E37, -1 },  /* 'n' '7' */
+    { 0x6E54, -1 },  /* 'n' 'T' */
+    { 0x6F37, -1 },  /* 'o' '7' */
+    { 0x6F54, -1 },  /* 'o' 'T' */
+    { 0x702E, -1 },  /* 'p' '.' */
+    { 0x7031, -1 },  /* 'p' '1' */
+    { 0x7032, -1 },  /* 'p' '2' */
+    { 0x7033, -1 },  /* 'p' '3' */
+    { 0x7037, -1 },  /* 'p' '7' */
+    { 0x7049, -1 },  /* 'p' 'I' */
+    { 0x704A, -1 },  /* 'p' 'J' */
+    { 0x7054, -1 },  /* 'p' 'T' */
+    { 0x7058, -1 },  /* 'p' 'X' */
+    { 0x705A, -1 },  /* 'p' 'Z' */
+    { 0x7061, -1 },  /* 'p' 'a' */
+    { 0x706A, -1 },  /* 'p' 'j' */
+    { 0x706C, -1 },  /* 'p' 'l' */
+    { 0x7137, -1 },  /* 'q' '7' */
+    { 0x7154, -1 },  /* 'q' 'T' */
+    { 0x722E, -1 },  /* 'r' '.' */
+    { 0x7231, -1 },  /* 'r' '1' */
+    { 0x7232, -1 },  /* 'r' '2' */
+    { 0x7233, -1 },  /* 'r' '3' */
+    { 0x7237, -1 },  /* 'r' '7' */
+    { 0x7249, -1 },  /* 'r' 'I' */
+    { 0x724A, -1 },  /* 'r' 'J' */
+    { 0x7254, -1 },  /* 'r' 'T' */
+    { 0x7258, -1 },  /* 'r' 'X' */
+    { 0x725A, -1 },  /* 'r' 'Z' */
+    { 0x7261, -1 },  /* 'r' 'a' */
+    { 0x726A, -1 },  /* 'r' 'j' */
+    { 0x726C, -1 },  /* 'r' 'l' */
+    { 0x7322, -1 },  /* 's' '"' */
+    { 0x7327, -1 },  /* 's' apostrophe */
+    { 0x732D, -1 },  /* 's' '-' */
+    { 0x7337, -1 },  /* 's' '7' */
+    { 0x7339, -1 },  /* 's' '9' */
+    { 0x7354, -1 },  /* 's' 'T' */
+    { 0x7359, -1 },  /* 's' 'Y' */
+    { 0x7366, -1 },  /* 's' 'f' */
+    { 0x7367, -1 },  /* 's' 'g' */
+    { 0x7371, -1 },  /* 's' 'q' */
+    { 0x7374, -1 },  /* 's' 't' */
+    { 0x7379, -1 },  /* 's' 'y' */
+    { 0x7422, -1 },  /* 't' '"' */
+    { 0x7427, -1 },  /* 't' apostrophe */
+    { 0x742D, -1 },  /* 't' '-' */
+    { 0x7437, -1 },  /* 't' '7' */
+    { 0x7439, -1 },  /* 't' '9' */
+    { 0x7454, -1 },  /* 't' 'T' */
+    { 0x7459, -1 },  /* 't' 'Y' */
+    { 0x7466, -1 },  /* 't' 'f' */
+    { 0x7467, -1 },  /* 't' 'g' */
+    { 0x7471, -1 },  /* 't' 'q' */
+    { 0x7474, -1 },  /* 't' 't' */
+    { 0x7479, -1 },  /* 't' 'y' */
+    { 0x7537, -1 },  /* 'u' '7' */
+    { 0x7554, -1 },  /* 'u' 'T' */
+    { 0x7637, -1 },  /* 'v' '7' */
+    { 0x7649, -1 },  /* 'v' 'I' */
+    { 0x7654, -1 },  /* 'v' 'T' */
+    { 0x766C, -1 },  /* 'v' 'l' */
+    { 0x7737, -1 },  /* 'w' '7' */
+    { 0x7754, -1 },  /* 'w' 'T' */
+    { 0x7837, -1 },  /* 'x' '7' */
+    { 0x7854, -1 },  /* 'x' 'T' */
+    { 0x7937, -1 },  /* 'y' '7' */
+    { 0x7954, -1 },  /* 'y' 'T' */
+    { 0x7A37, -1 },  /* 'z' '7' */
+    { 0x7A54, -1 },  /* 'z' 'T' */
+};
+
+const hal_font_t hal_font_medium = {
+    .height = 8,
+    .cell_width = 6,
+    .first_char = 32,
+    .last_char = 126,
+    .default_char = 32,
+    .flags = HAL_FONT_FLAG_PROPORTIONAL,
+    .kerning_count = 382,
+    .glyphs = medium_glyphs,
+    .bitmap = medium_bitmap,
+    .kerning = medium_kerning,
+};
+
+/* large: tng_5x7.bdf, 16 px, fixed */
+static const uint8_t large_bitmap[] = {
+    /* '!' */
+    0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x33, 0x33, 0x00, 0x00, 0x00, 0x00,
+    /* '"' */
+    0x00, 0x00, 0x3F, 0x3F, 0x00, 0x00, 0x3F, 0x3F, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    /* '#' */
+    0x30, 0x30, 0xFF, 0xFF, 0x30, 0x30, 0xFF, 0xFF, 0x30, 0x30, 0x03, 0x03,
+    0x3F, 0x3F, 0x03, 0x03, 0x3F, 0x3F, 0x03, 0x03,
+    /* '$' */
+    0x30, 0x30, 0xCC, 0xCC, 0xFF, 0xFF, 0xCC, 0xCC, 0x0C, 0x0C, 0x0C, 0x0C,
+    0x0C, 0x0C, 0x3F, 0x3F, 0x0C, 0x0C, 0x03, 0x03,
+    /* '%' */
+    0x0F, 0x0F, 0x0F, 0x0F, 0xC0, 0xC0, 0x30, 0x30, 0x0C, 0x0C, 0x0C, 0x0C,
+    0x03, 0x03, 0x00, 0x00, 0x3C, 0x3C, 0x3C, 0x3C,
+    /* '&' */
+    0x3C, 0x3C, 0xC3, 0xC3, 0x3C, 0x3C, 0x00, 0x00, 0x00, 0x00, 0x0F, 0x0F,
+    0x30, 0x30, 0x33, 0x33, 0x0C, 0x0C, 0x33, 0x33,
+    /* apostrophe */
+    0x00, 0x00, 0x33, 0x33, 0x0F, 0x0F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    /* '(' */
+    0x00, 0x00, 0xF0, 0xF0, 0x0C, 0x0C, 0x03, 0x03, 0x00, 0x00, 0x00, 0x00,
+    0x03, 0x03, 0x0C, 0x0C, 0x30, 0x30, 0x00, 0x00,
+    /* ')' */
+    0x00, 0x00, 0x03, 0x03, 0x0C, 0x0C, 0xF0, 0xF0, 0x00, 0x00, 0x00, 0x00,
+    0x30, 0x30, 0x0C, 0x0C, 0x03, 0x03, 0x00, 0x00,
+    /* '*' */
+    0xC0, 0xC0, 0xCC, 0xCC, 0xF0, 0xF0, 0xCC, 0xCC, 0xC0, 0xC0, 0x00, 0x00,
+    0x0C, 0x0C, 0x03, 0x03, 0x0C, 0x0C, 0x00, 0x00,
+    /* '+' */
+    0xC0, 0xC0, 0xC0, 0xC0, 0xFC, 0xFC, 0xC0, 0xC0, 0xC0, 0xC0, 0x00, 0x00,
+    0x00, 0x00, 0x0F, 0x0F, 0x00, 0x00, 0x00, 0x00,
+    /* ',' */
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x33, 0x33, 0x0F, 0x0F, 0x00, 0x00, 0x00, 0x00,
+    /* '-' */
+    0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    /* '.' */
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x3C, 0x3C, 0x3C, 0x3C, 0x00, 0x00, 0x00, 0x00,
+    /* '/' */
+    0x00, 0x00, 0x00, 0x00, 0xC0, 0xC0, 0x30, 0x30, 0x0C, 0x0C, 0x0C, 0x0C,
+    0x03, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    /* '0' */
+    0xFC, 0xFC, 0x03, 0x03, 0xC3, 0xC3, 0x33, 0x33, 0xFC, 0xFC, 0x0F, 0x0F,
+    0x33, 0x33, 0x30, 0x30, 0x30, 0x30, 0x0F, 0x0F,
+    /* '1' */
+    0x00, 0x00, 0x0C, 0x0C, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x30, 0x30, 0x3F, 0x3F, 0x30, 0x30, 0x00, 0x00,
+    /* '2' */
+    0x0C, 0x0C, 0x03, 0x03, 0x03, 0x03, 0xC3, 0xC3, 0x3C, 0x3C, 0x30, 0x30,
+    0x3C, 0x3C, 0x33, 0x33, 0x30, 0x30, 0x30, 0x30,
+    /* '3' */
+    0x03, 0x03, 0x03, 0x03, 0x33, 0x33, 0xCF, 0xCF, 0x03, 0x03, 0x0C, 0x0C,
+    0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x0F, 0x0F,
+    /* '4' */
+    0xC0, 0xC0, 0x30, 0x30, 0x0C, 0x0C, 0xFF, 0xFF, 0x00, 0x00, 0x03, 0x03,
+    0x03, 0x03, 0x03, 0x03, 0x3F, 0x3F, 0x03, 0x03,
+    /* '5' */
+    0x3F, 0x3F, 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0xC3, 0xC3, 0x0C, 0x0C,
+    0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x0F, 0x0F,
+    /* '6' */
+    0xF0, 0xF0, 0xCC, 0xCC, 0xC3, 0xC3, 0xC3, 0xC3, 0x00, 0x00, 0x0F, 0x0F,
+    0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x0F, 0x0F,
+    /* '7' */
+    0x03, 0x03, 0x03, 0x03, 0xC3, 0xC3, 0x33, 0x33, 0x0F, 0x0F, 0x00, 0x00,
+    0x3F, 0x3F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    /* '8' */
+    0x3C, 0x3C, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0x3C, 0x3C, 0x0F, 0x0F,
+    0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x0F, 0x0F,
+    /* '9' */
+    0x3C, 0x3C, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xFC, 0xFC, 0x00, 0x00,
+    0x30, 0x30, 0x30, 0x30, 0x0C, 0x0C, 0x03, 0x03,
+    /* ':' */
+    0x00, 0x00, 0x3C, 0x3C, 0x3C, 0x3C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x0F, 0x0F, 0x0F, 0x0F, 0x00, 0x00, 0x00, 0x00,
+    /* ';' */
+    0x00, 0x00, 0x3C, 0x3C, 0x3C, 0x3C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x33, 0x33, 0x0F, 0x0F, 0x00, 0x00, 0x00, 0x00,
+    /* '<' */
+    0x00, 0x00, 0xC0, 0xC0, 0x30, 0x30, 0x0C, 0x0C, 0x03, 0x03, 0x00, 0x00,
+    0x00, 0x00, 0x03, 0x03, 0x0C, 0x0C, 0x30, 0x30,
+    /* '=' */
+    0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x03, 0x03,
+    0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03,
+    /* '>' */
+    0x03, 0x03, 0x0C, 0x0C, 0x30, 0x30, 0xC0, 0xC0, 0x00, 0x00, 0x30, 0x30,
+    0x0C, 0x0C, 0x03, 0x03, 0x00, 0x00, 0x00, 0x00,
+    /* '?' */
+    0x0C, 0x0C, 0x03, 0x03, 0x03, 0x03, 0xC3, 0xC3, 0x3C, 0x3C, 0x00, 0x00,
+    0x00, 0x00, 0x33, 0x33, 0x00, 0x00, 0x00, 0x00,
+    /* '@' */
+    0x0C, 0x0C, 0xC3, 0xC3, 0xC3, 0xC3, 0x03, 0x03, 0xFC, 0xFC, 0x0F, 0x0F,
+    0x30, 0x30, 0x3F, 0x3F, 0x30, 0x30, 0x0F, 0x0F,
+    /* 'A' */
+    0xFC, 0xFC, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0xFC, 0xFC, 0x3F, 0x3F,
+    0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x3F, 0x3F,
+    /* 'B' */
+    0xFF, 0xFF, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0x3C, 0x3C, 0x3F, 0x3F,
+    0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x0F, 0x0F,
+    /* 'C' */
+    0xFC, 0xFC, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x0C, 0x0C, 0x0F, 0x0F,
+    0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x0C, 0x0C,
+    /* 'D' */
+    0xFF, 0xFF, 0x03, 0x03, 0x03, 0x03, 0x0C, 0x0C, 0xF0, 0xF0, 0x3F, 0x3F,
+    0x30, 0x30, 0x30, 0x30, 0x0C, 0x0C, 0x03, 0x03,
+    /* 'E' */
+    0xFF, 0xFF, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0x03, 0x03, 0x3F, 0x3F,
+    0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30,
+    /* 'F' */
+    0xFF, 0xFF, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0x03, 0x03, 0x3F, 0x3F,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    /* 'G' */
+    0xFC, 0xFC, 0x03, 0x03, 0xC3, 0xC3, 0xC3, 0xC3, 0xCC, 0xCC, 0x0F, 0x0F,
+    0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x3F, 0x3F,
+    /* 'H' */
+    0xFF, 0xFF, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xFF, 0xFF, 0x3F, 0x3F,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3F, 0x3F,
+    /* 'I' */
+    0x00, 0x00, 0x03, 0x03, 0xFF, 0xFF, 0x03, 0x03, 0x00, 0x00, 0x00, 0x00,
+    0x30, 0x30, 0x3F, 0x3F, 0x30, 0x30, 0x00, 0x00,
+    /* 'J' */
+    0x00, 0x00, 0x00, 0x00, 0x03, 0x03, 0xFF, 0xFF, 0x03, 0x03, 0x0C, 0x0C,
+    0x30, 0x30, 0x30, 0x30, 0x0F, 0x0F, 0x00, 0x00,
+    /* 'K' */
+    0xFF, 0xFF, 0xC0, 0xC0, 0x30, 0x30, 0x0C, 0x0C, 0x03, 0x03, 0x3F, 0x3F,
+    0x00, 0x00, 0x03, 0x03, 0x0C, 0x0C, 0x30, 0x30,
+    /* 'L' */
+    0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3F, 0x3F,
+    0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30,
+    /* 'M' */
+    0xFF, 0xFF, 0x0C, 0x0C, 0xF0, 0xF0, 0x0C, 0x0C, 0xFF, 0xFF, 0x3F, 0x3F,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3F, 0x3F,
+    /* 'N' */
+    0xFF, 0xFF, 0x30, 0x30, 0xC0, 0xC0, 0x00, 0x00, 0xFF, 0xFF, 0x3F, 0x3F,
+    0x00, 0x00, 0x00, 0x00, 0x03, 0x03, 0x3F, 0x3F,
+    /* 'O' */
+    0xFC, 0xFC, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0xFC, 0xFC, 0x0F, 0x0F,
+    0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x0F, 0x0F,
+    /* 'P' */
+    0xFF, 0xFF, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0x3C, 0x3C, 0x3F, 0x3F,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    /* 'Q' */
+    0xFC, 0xFC, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0xFC, 0xFC, 0x0F, 0x0F,
+    0x30, 0x30, 0x33, 0x33, 0x0C, 0x0C, 0x33, 0x33,
+    /* 'R' */
+    0xFF, 0xFF, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0x3C, 0x3C, 0x3F, 0x3F,
+    0x00, 0x00, 0x03, 0x03, 0x0C, 0x0C, 0x30, 0x30,
+    /* 'S' */
+    0x3C, 0x3C, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0x03, 0x03, 0x30, 0x30,
+    0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x0F, 0x0F,
+    /* 'T' */
+    0x03, 0x03, 0x03, 0x03, 0xFF, 0xFF, 0x03, 0x03, 0x03, 0x03, 0x00, 0x00,
+    0x00, 0x00, 0x3F, 0x3F, 0x00, 0x00, 0x00, 0x00,
+    /* 'U' */
+    0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0x0F, 0x0F,
+    0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x0F, 0x0F,
+    /* 'V' */
+    0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0x03, 0x03,
+    0x0C, 0x0C, 0x30, 0x30, 0x0C, 0x0C, 0x03, 0x03,
+    /* 'W' */
+    0xFF, 0xFF, 0x00, 0x00, 0xC0, 0xC0, 0x00, 0x00, 0xFF, 0xFF, 0x0F, 0x0F,
+    0x30, 0x30, 0x0F, 0x0F, 0x30, 0x30, 0x0F, 0x0F,
+    /* 'X' */
+    0x0F, 0x0F, 0x30, 0x30, 0xC0, 0xC0, 0x30, 0x30, 0x0F, 0x0F, 0x3C, 0x3C,
+    0x03, 0x03, 0x00, 0x00, 0x03, 0x03, 0x3C, 0x3C,
+    /* 'Y' */
+    0x3F, 0x3F, 0xC0, 0xC0, 0x00, 0x00, 0xC0, 0xC0, 0x3F, 0x3F, 0x00, 0x00,
+    0x00, 0x00, 0x3F, 0x3F, 0x00, 0x00, 0x00, 0x00,
+    /* 'Z' */
+    0x03, 0x03, 0x03, 0x03, 0xC3, 0xC3, 0x33, 0x33, 0x0F, 0x0F, 0x3C, 0x3C,
+    0x33, 0x33, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30,
+    /* '[' */
+    0x00, 0x00, 0xFF, 0xFF, 0x03, 0x03, 0x03, 0x03, 0x00, 0x00, 0x00, 0x00,
+    0x3F, 0x3F, 0x30, 0x30, 0x30, 0x30, 0x00, 0x00,
+    /* backslash */
+    0x0C, 0x0C, 0x30, 0x30, 0xC0, 0xC0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x03, 0x03, 0x0C, 0x0C,
+    /* ']' */
+    0x00, 0x00, 0x03, 0x03, 0x03, 0x03, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00,
+    0x30, 0x30, 0x30, 0x30, 0x3F, 0x3F, 0x00, 0x00,
+    /* '^' */
+    0x30, 0x30, 0x0C, 0x0C, 0x03, 0x03, 0x0C, 0x0C, 0x30, 0x30, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    /* '_' */
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x30, 0x30,
+    0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30,
+    /* '`' */
+    0x00, 0x00, 0x03, 0x03, 0x0C, 0x0C, 0x30, 0x30, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    /* 'a' */
+    0x00, 0x00, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0xC0, 0xC0, 0x0C, 0x0C,
+    0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x3F, 0x3F,
+    /* 'b' */
+    0xFF, 0xFF, 0xC0, 0xC0, 0x30, 0x30, 0x30, 0x30, 0xC0, 0xC0, 0x3F, 0x3F,
+    0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x0F, 0x0F,
+    /* 'c' */
+    0xC0, 0xC0, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x00, 0x00, 0x0F, 0x0F,
+    0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x0C, 0x0C,
+    /* 'd' */
+    0xC0, 0xC0, 0x30, 0x30, 0x30, 0x30, 0xC0, 0xC0, 0xFF, 0xFF, 0x0F, 0x0F,
+    0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x3F, 0x3F,
+    /* 'e' */
+    0xC0, 0xC0, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0xC0, 0xC0, 0x0F, 0x0F,
+    0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x03, 0x03,
+    /* 'f' */
+    0xC0, 0xC0, 0xFC, 0xFC, 0xC3, 0xC3, 0x03, 0x03, 0x0C, 0x0C, 0x00, 0x00,
+    0x3F, 0x3F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    /* 'g' */
+    0xF0, 0xF0, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0xFC, 0xFC, 0x00, 0x00,
+    0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x0F, 0x0F,
+    /* 'h' */
+    0xFF, 0xFF, 0xC0, 0xC0, 0x30, 0x30, 0x30, 0x30, 0xC0, 0xC0, 0x3F, 0x3F,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3F, 0x3F,
+    /* 'i' */
+    0x00, 0x00, 0x30, 0x30, 0xF3, 0xF3, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x30, 0x30, 0x3F, 0x3F, 0x30, 0x30, 0x00, 0x00,
+    /* 'j' */
+    0x00, 0x00, 0x00, 0x00, 0x30, 0x30, 0xF3, 0xF3, 0x00, 0x00, 0x0C, 0x0C,
+    0x30, 0x30, 0x30, 0x30, 0x0F, 0x0F, 0x00, 0x00,
+    /* 'k' */
+    0xFF, 0xFF, 0x00, 0x00, 0xC0, 0xC0, 0x30, 0x30, 0x00, 0x00, 0x3F, 0x3F,
+    0x03, 0x03, 0x0C, 0x0C, 0x30, 0x30, 0x00, 0x00,
+    /* 'l' */
+    0x00, 0x00, 0x03, 0x03, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x30, 0x30, 0x3F, 0x3F, 0x30, 0x30, 0x00, 0x00,
+    /* 'm' */
+    0xF0, 0xF0, 0x30, 0x30, 0xC0, 0xC0, 0x30, 0x30, 0xC0, 0xC0, 0x3F, 0x3F,
+    0x00, 0x00, 0x03, 0x03, 0x00, 0x00, 0x3F, 0x3F,
+    /* 'n' */
+    0xF0, 0xF0, 0xC0, 0xC0, 0x30, 0x30, 0x30, 0x30, 0xC0, 0xC0, 0x3F, 0x3F,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3F, 0x3F,
+    /* 'o' */
+    0xC0, 0xC0, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0xC0, 0xC0, 0x0F, 0x0F,
+    0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x0F, 0x0F,
+    /* 'p' */
+    0xF0, 0xF0, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0xC0, 0xC0, 0x3F, 0x3F,
+    0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x00, 0x00,
+    /* 'q' */
+    0xC0, 0xC0, 0x30, 0x30, 0x30, 0x30, 0xC0, 0xC0, 0xF0, 0xF0, 0x00, 0x00,
+    0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x3F, 0x3F,
+    /* 'r' */
+    0xF0, 0xF0, 0xC0, 0xC0, 0x30, 0x30, 0x30, 0x30, 0xC0, 0xC0, 0x3F, 0x3F,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    /* 's' */
+    0xC0, 0xC0, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x00, 0x00, 0x30, 0x30,
+    0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x0C, 0x0C,
+    /* 't' */
+    0x30, 0x30, 0xFF, 0xFF, 0x30, 0x30, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x0F, 0x0F, 0x30, 0x30, 0x30, 0x30, 0x0C, 0x0C,
+    /* 'u' */
+    0xF0, 0xF0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF0, 0xF0, 0x0F, 0x0F,
+    0x30, 0x30, 0x30, 0x30, 0x0C, 0x0C, 0x3F, 0x3F,
+    /* 'v' */
+    0xF0, 0xF0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF0, 0xF0, 0x03, 0x03,
+    0x0C, 0x0C, 0x30, 0x30, 0x0C, 0x0C, 0x03, 0x03,
+    /* 'w' */
+    0xF0, 0xF0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF0, 0xF0, 0x0F, 0x0F,
+    0x30, 0x30, 0x0F, 0x0F, 0x30, 0x30, 0x0F, 0x0F,
+    /* 'x' */
+    0x30, 0x30, 0xC0, 0xC0, 0x00, 0x00, 0xC0, 0xC0, 0x30, 0x30, 0x30, 0x30,
+    0x0C, 0x0C, 0x03, 0x03, 0x0C, 0x0C, 0x30, 0x30,
+    /* 'y' */
+    0xF0, 0xF0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF0, 0xF0, 0x00, 0x00,
+    0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x0F, 0x0F,
+    /* 'z' */
+    0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0xF0, 0xF0, 0x30, 0x30, 0x30, 0x30,
+    0x3C, 0x3C, 0x33, 0x33, 0x30, 0x30, 0x30, 0x30,
+    /* '{' */
+    0x00, 0x00, 0xC0, 0xC0, 0x3C, 0x3C, 0x03, 0x03, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x0F, 0x0F, 0x30, 0x30, 0x00, 0x00,
+    /* '|' */
+    0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x3F, 0x3F, 0x00, 0x00, 0x00, 0x00,
+    /* '}' */
+    0x00, 0x00, 0x03, 0x03, 0x3C, 0x3C, 0xC0, 0xC0, 0x00, 0x00, 0x00, 0x00,
+    0x30, 0x30, 0x0F, 0x0F, 0x00, 0x00, 0x00, 0x00,
+    /* '~' */
+    0xC0, 0xC0, 0x30, 0x30, 0xC0, 0xC0, 0x00, 0x00, 0xC0, 0xC0, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x03, 0x03, 0x00, 0x00,
+};
+
+static const hal_font_glyph_t large_glyphs[] = {
+    {     0,  0, 12 },  /* space */
+    {     0, 10, 12 },  /* '!' */
+    {    20, 10, 12 },  /* '"' */
+    {    40, 10, 12 },  /* '#' */
+    {    60, 10, 12 },  /* '$' */
+    {    80, 10, 12 },  /* '%' */
+    {   100, 10, 12 },  /* '&' */
+    {   120, 10, 12 },  /* apostrophe */
+    {   140, 10, 12 },  /* '(' */
+    {   160, 10, 12 },  /* ')' */
+    {   180, 10, 12 },  /* '*' */
+    {   200, 10, 12 },  /* '+' */
+    {   220, 10, 12 },  /* ',' */
+    {   240, 10, 12 },  /* '-' */
+    {   260, 10, 12 },  /* '.' */
+    {   280, 10, 12 },  /* '/' */
+    {   300, 10, 12 },  /* '0' */
+    {   320, 10, 12 },  /* '1' */
+    {   340, 10, 12 },  /* '2' */
+    {   360, 10, 12 },  /* '3' */
+    {   380, 10, 12 },  /* '4' */
+    {   400, 10, 12 },  /* '5' */
+    {   420, 10, 12 },  /* '6' */
+    {   440, 10, 12 },  /* '7' */
+    {   460, 10, 12 },  /* '8' */
+    {   480, 10, 12 },  /* '9' */
+    {   500, 10, 12 },  /* ':' */
+    {   520, 10, 12 },  /* ';' */
+    {   540, 10, 12 },  /* '<' */
+    {   560, 10, 12 },  /* '=' */
+    {   580, 10, 12 },  /* '>' */
+    {   600, 10, 12 },  /* '?' */
+    {   620, 10, 12 },  /* '@' */
+    {   640, 10, 12 },  /* 'A' */
+    {   660, 10, 12 },  /* 'B' */
+    {   680, 10, 12 },  /* 'C' */
+    {   700, 10, 12 },  /* 'D' */
+    {   720, 10, 12 },  /* 'E' */
+    {   740, 10, 12 },  /* 'F' */
+    {   760, 10, 12 },  /* 'G' */
+    {   780, 10, 12 },  /* 'H' */
+    {   800, 10, 12 },  /* 'I' */
+    {   820, 10, 12 },  /* 'J' */
+    {   840, 10, 12 },  /* 'K' */
+    {   860, 10, 12 },  /* 'L' */
+    {   880, 10, 12 },  /* 'M' */
+    {   900, 10, 12 },  /* 'N' */
+    {   920, 10, 12 },  /* 'O' */
+    {   940, 10, 12 },  /* 'P' */
+    {   960, 10, 12 },  /* 'Q' */
+    {   980, 10, 12 },  /* 'R' */
+    {  1000, 10, 12 },  /* 'S' */
+    {  1020, 10, 12 },  /* 'T' */
+    {  1040, 10, 12 },  /* 'U' */
+    {  1060, 10, 12 },  /* 'V' */
+    {  1080, 10, 12 },  /* 'W' */
+    {  1100, 10, 12 },  /* 'X' */
+    {  1120, 10, 12 },  /* 'Y' */
+    {  1140, 10, 12 },  /* 'Z' */
+    {  1160, 10, 12 },  /* '[' */
+    {  1180, 10, 12 },  /* backslash */
+    {  1200, 10, 12 },  /* ']' */
+    {  1220, 10, 12 },  /* '^' */
+    {  1240, 10, 12 },  /* '_' */
+    {  1260, 10, 12 },  /* '`' */
+    {  1280, 10, 12 },  /* 'a' */
+    {  1300, 10, 12 },  /* 'b' */
+    {  1320, 10, 12 },  /* 'c' */
+    {  1340, 10, 12 },  /* 'd' */
+    {  1360, 10, 12 },  /* 'e' */
+    {  1380, 10, 12 },  /* 'f' */
+    {  1400, 10, 12 },  /* 'g' */
+    {  1420, 10, 12 },  /* 'h' */
+    {  1440, 10, 12 },  /* 'i' */
+    {  1460, 10, 12 },  /* 'j' */
+    {  1480, 10, 12 },  /* 'k' */
+    {  1500, 10, 12 },  /* 'l' */
+    {  1520, 10, 12 },  /* 'm' */
+    {  1540, 10, 12 },  /* 'n' */
+    {  1560, 10, 12 },  /* 'o' */
+    {  1580, 10, 12 },  /* 'p' */
+    {  1600, 10, 12 },  /* 'q' */
+    {  1620, 10, 12 },  /* 'r' */
+    {  1640, 10, 12 },  /* 's' */
+    {  1660, 10, 12 },  /* 't' */
+    {  1680, 10, 12 },  /* 'u' */
+    {  1700, 10, 12 },  /* 'v' */
+    {  1720, 10, 12 },  /* 'w' */
+    {  1740, 10, 12 },  /* 'x' */
+    {  1760, 10, 12 },  /* 'y' */
+    {  1780, 10, 12 },  /* 'z' */
+    {  1800, 10, 12 },  /* '{' */
+    {  1820, 10, 12 },  /* '|' */
+    {  1840, 10, 12 },  /* '}' */
+    {  1860, 10, 12 },  /* '~' */
+};
+
+const hal_font_t hal_font_large = {
+    .height = 16,
+    .cell_width = 12,
+    .first_char = 32,
+    .last_char = 126,
+    .default_char = 32,
+    .flags = 0,
+    .kerning_count = 0,
+    .glyphs = large_glyphs,
+    .bitmap = large_bitmap,
+    .kerning = NULL,
+};
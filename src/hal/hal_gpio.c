@@ -9,6 +9,7 @@
 
 #include "hal_gpio.h"
 #include "hal_internal.h"
+#include "kernel/interrupt.h"
 #include <string.h>
 #include <stdlib.h>
 
@@ -32,6 +33,19 @@
 #define GPIO_AFRL_OFFSET    0x20    /**< Alternate function low register */
 #define GPIO_AFRH_OFFSET    0x24    /**< Alternate function high register */
 
+/* STM32WB55 EXTI and SYSCFG register definitions */
+#define EXTI_BASE           0x58000800UL
+#define EXTI_RTSR1          (*(volatile uint32_t *)(EXTI_BASE + 0x00))  /**< Rising trigger selection */
+#define EXTI_FTSR1          (*(volatile uint32_t *)(EXTI_BASE + 0x04))  /**< Falling trigger selection */
+#define EXTI_PR1            (*(volatile uint32_t *)(EXTI_BASE + 0x0C))  /**< Pending, write 1 to clear */
+#define EXTI_C1IMR1         (*(volatile uint32_t *)(EXTI_BASE + 0x80))  /**< CPU1 interrupt mask */
+#define SYSCFG_BASE         0x40010000UL
+#define SYSCFG_EXTICR(n)    (*(volatile uint32_t *)(SYSCFG_BASE + 0x08 + (n) * 4))  /**< Line to port routing */
+
+/* GPIO lines, one per pin number, shared by all ports */
+#define EXTI_LINES          16
+#define EXTI_LINE_FREE      0xFF
+
 /* Maximum number of GPIO pins */
 #define MAX_GPIO_PINS       64
 #define PINS_PER_PORT       16
@@ -57,13 +71,24 @@ static bool gpio_hal_initialized = false;
 static hal_gpio_pin_state_t pin_states[MAX_GPIO_PINS];
 static hal_device_t gpio_device;
 static hal_driver_t gpio_driver;
+static uint8_t exti_pins[EXTI_LINES];      /* Pin routed to each line, EXTI_LINE_FREE if none */
 
 /* Forward declarations */
 static hal_result_t gpio_driver_init(hal_device_t *device);
 static hal_result_t gpio_driver_deinit(hal_device_t *device);
 static uint32_t gpio_get_port_base(uint32_t pin);
 static uint32_t gpio_get_pin_mask(uint32_t pin);
-static void gpio_interrupt_handler(uint32_t pin);
+static irq_number_t gpio_exti_irq(uint32_t line);
+static bool gpio_exti_irq_in_use(irq_number_t irq);
+static hal_result_t gpio_exti_irq_start(irq_number_t irq);
+static void gpio_exti_dispatch(uint32_t first, uint32_t last);
+static void gpio_exti0_irq_handler(void);
+static void gpio_exti1_irq_handler(void);
+static void gpio_exti2_irq_handler(void);
+static void gpio_exti3_irq_handler(void);
+static void gpio_exti4_irq_handler(void);
+static void gpio_exti9_5_irq_handler(void);
+static void gpio_exti15_10_irq_handler(void);
 
 /* GPIO driver operations */
 static const hal_driver_ops_t gpio_driver_ops = {
@@ -96,6 +121,7 @@ hal_result_t hal_gpio_init(void)
         pin_states[i].reserved = false;
         pin_states[i].interrupt.enabled = false;
     }
+    memset(exti_pins, EXTI_LINE_FREE, sizeof(exti_pins));
 
     /* Initialize GPIO driver */
     gpio_driver.name = "gpio";
@@ -301,24 +327,64 @@ hal_result_t hal_gpio_enable_interrupt(uint32_t pin, hal_gpio_trigger_t trigger,
         return HAL_ERROR_NOT_INITIALIZED;
     }
 
-    if (pin >= MAX_GPIO_PINS || callback == NULL || trigger >= HAL_GPIO_TRIGGER_MAX) {
+    if (pin >= MAX_GPIO_PINS || callback == NULL || trigger == HAL_GPIO_TRIGGER_NONE ||
+        trigger >= HAL_GPIO_TRIGGER_MAX || gpio_get_port_base(pin) == 0) {
         return HAL_ERROR_INVALID_PARAM;
     }
 
+    /* EXTI only detects edges */
+    if (trigger == HAL_GPIO_TRIGGER_LOW || trigger == HAL_GPIO_TRIGGER_HIGH) {
+        return HAL_ERROR_NOT_SUPPORTED;
+    }
+
+    /* A line serves one port at a time */
+    uint32_t line = pin % PINS_PER_PORT;
+    if (exti_pins[line] != EXTI_LINE_FREE && exti_pins[line] != pin) {
+        return HAL_ERROR_RESOURCE_BUSY;
+    }
+
+    uint32_t mask = 1UL << line;
+    irq_number_t irq = gpio_exti_irq(line);
+    bool irq_running = gpio_exti_irq_in_use(irq);
+
+    /* Mask the line while it is rerouted */
+    EXTI_C1IMR1 &= ~mask;
+
     /* Store interrupt configuration */
     pin_states[pin].interrupt.pin = pin;
     pin_states[pin].interrupt.callback = callback;
     pin_states[pin].interrupt.user_data = user_data;
     pin_states[pin].interrupt.enabled = true;
+    exti_pins[line] = (uint8_t)pin;
 
-    /* TODO: Configure EXTI (External Interrupt) hardware registers
-     * This would involve:
-     * 1. Configure EXTI line for the pin
-     * 2. Set trigger type (rising/falling/both)
-     * 3. Enable EXTI interrupt in NVIC
-     * 4. Configure SYSCFG to route GPIO to EXTI
-     */
+    /* Route the port to the line */
+    uint32_t shift = (line % 4) * 4;
+    SYSCFG_EXTICR(line / 4) = (SYSCFG_EXTICR(line / 4) & ~(0xFUL << shift)) |
+                              ((pin / PINS_PER_PORT) << shift);
+
+    if (trigger == HAL_GPIO_TRIGGER_RISING || trigger == HAL_GPIO_TRIGGER_BOTH) {
+        EXTI_RTSR1 |= mask;
+    } else {
+        EXTI_RTSR1 &= ~mask;
+    }
+    if (trigger == HAL_GPIO_TRIGGER_FALLING || trigger == HAL_GPIO_TRIGGER_BOTH) {
+        EXTI_FTSR1 |= mask;
+    } else {
+        EXTI_FTSR1 &= ~mask;
+    }
+
+    /* Drop an edge latched under the previous routing */
+    EXTI_PR1 = mask;
+
+    if (!irq_running && gpio_exti_irq_start(irq) != HAL_OK) {
+        pin_states[pin].interrupt.enabled = false;
+        pin_states[pin].interrupt.callback = NULL;
+        pin_states[pin].interrupt.user_data = NULL;
+        exti_pins[line] = EXTI_LINE_FREE;
+        return HAL_ERROR;
+    }
 
+    EXTI_C1IMR1 |= mask;
     return HAL_OK;
 }
 
@@ -335,13 +401,28 @@ hal_result_t hal_gpio_disable_interrupt(uint32_t pin)
         return HAL_ERROR_INVALID_PARAM;
     }
 
+    uint32_t line = pin % PINS_PER_PORT;
+    if (exti_pins[line] == pin) {
+        uint32_t mask = 1UL << line;
+
+        EXTI_C1IMR1 &= ~mask;
+        EXTI_RTSR1 &= ~mask;
+        EXTI_FTSR1 &= ~mask;
+        EXTI_PR1 = mask;
+        exti_pins[line] = EXTI_LINE_FREE;
+
+        /* The shared vectors stay on while another line uses them */
+        irq_number_t irq = gpio_exti_irq(line);
+        if (!gpio_exti_irq_in_use(irq)) {
+            interrupt_disable(irq);
+        }
+    }
+
     /* Clear interrupt configuration */
     pin_states[pin].interrupt.enabled = false;
     pin_states[pin].interrupt.callback = NULL;
     pin_states[pin].interrupt.user_data = NULL;
 
-    /* TODO: Disable EXTI hardware configuration */
-
     return HAL_OK;
 }
 
@@ -435,17 +516,114 @@ static uint32_t gpio_get_pin_mask(uint32_t pin)
 }
 
 /**
- * @brief GPIO interrupt handler (called by system interrupt handler)
+ * @brief Get the NVIC vector serving an EXTI line
+ */
+static irq_number_t gpio_exti_irq(uint32_t line)
+{
+    if (line <= 4) {
+        return (irq_number_t)(IRQ_EXTI0 + line);
+    }
+    return (line <= 9) ? IRQ_EXTI9_5 : IRQ_EXTI15_10;
+}
+
+/**
+ * @brief Check whether any line still uses a vector
  */
-static void gpio_interrupt_handler(uint32_t pin)
+static bool gpio_exti_irq_in_use(irq_number_t irq)
 {
-    if (pin < MAX_GPIO_PINS && pin_states[pin].interrupt.enabled) {
-        if (pin_states[pin].interrupt.callback) {
+    for (uint32_t line = 0; line < EXTI_LINES; line++) {
+        if (exti_pins[line] != EXTI_LINE_FREE && gpio_exti_irq(line) == irq) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Install and enable the handler for a vector
+ */
+static hal_result_t gpio_exti_irq_start(irq_number_t irq)
+{
+    irq_handler_t handler;
+    const char *name;
+
+    switch (irq) {
+    case IRQ_EXTI0:     handler = gpio_exti0_irq_handler;     name = "EXTI0";     break;
+    case IRQ_EXTI1:     handler = gpio_exti1_irq_handler;     name = "EXTI1";     break;
+    case IRQ_EXTI2:     handler = gpio_exti2_irq_handler;     name = "EXTI2";     break;
+    case IRQ_EXTI3:     handler = gpio_exti3_irq_handler;     name = "EXTI3";     break;
+    case IRQ_EXTI4:     handler = gpio_exti4_irq_handler;     name = "EXTI4";     break;
+    case IRQ_EXTI9_5:   handler = gpio_exti9_5_irq_handler;   name = "EXTI9_5";   break;
+    default:            handler = gpio_exti15_10_irq_handler; name = "EXTI15_10"; break;
+    }
+
+    if (interrupt_register(irq, handler, IRQ_PRIORITY_HIGH, name) != KERNEL_OK ||
+        interrupt_enable(irq) != KERNEL_OK) {
+        return HAL_ERROR;
+    }
+    return HAL_OK;
+}
+
+/**
+ * @brief Run the callbacks for the pending lines of one vector
+ *
+ * Each pending bit is cleared before its callback runs, so an edge
+ * arriving during the callback raises the interrupt again.
+ */
+static void gpio_exti_dispatch(uint32_t first, uint32_t last)
+{
+    uint32_t pending = EXTI_PR1 & EXTI_C1IMR1;
+
+    for (uint32_t line = first; line <= last; line++) {
+        uint32_t mask = 1UL << line;
+        if (!(pending & mask)) {
+            continue;
+        }
+        EXTI_PR1 = mask;
+
+        uint32_t pin = exti_pins[line];
+        if (pin < MAX_GPIO_PINS && pin_states[pin].interrupt.enabled && pin_states[pin].interrupt.callback) {
             pin_states[pin].interrupt.callback(pin, pin_states[pin].interrupt.user_data);
         }
     }
 }
 
+/* EXTI vectors, installed through interrupt_register() */
+static void gpio_exti0_irq_handler(void)
+{
+    gpio_exti_dispatch(0, 0);
+}
+
+static void gpio_exti1_irq_handler(void)
+{
+    gpio_exti_dispatch(1, 1);
+}
+
+static void gpio_exti2_irq_handler(void)
+{
+    gpio_exti_dispatch(2, 2);
+}
+
+static void gpio_exti3_irq_handler(void)
+{
+    gpio_exti_dispatch(3, 3);
+}
+
+static void gpio_exti4_irq_handler(void)
+{
+    gpio_exti_dispatch(4, 4);
+}
+
+static void gpio_exti9_5_irq_handler(void)
+{
+    gpio_exti_dispatch(5, 9);
+}
+
+static void gpio_exti15_10_irq_handler(void)
+{
+    gpio_exti_dispatch(10, 15);
+}
+
 /* Driver implementation */
 
 /**
@@ -0,0 +1,648 @@
+/**
+ * @file hal_ipcc.c
+ * @brief Mailbox transport to the wireless coprocessor (CPU2)
+ *
+ * Implements CPU1's side of ST's transport layer (see hal_ipcc_mailbox.h
+ * for the layout). The reference table goes alone in section .ipcc_shared
+ * so the linker puts it at the start of SRAM_SHARED, where CPU2 looks for
+ * it; the other tables, the queues and the buffers follow in
+ * .ipcc_shared.tables.
+ *
+ * Bring-up: CPU2 boots, puts a ready event on the system queue, and is
+ * then sent SHCI_C2_BLE_Init for a link-layer-only stack. Until it
+ * accepts that, hal_ipcc_alloc() hands out no command buffer.
+ *
+ * Received events are drained from the queue in batches while CPU1 owns
+ * it, then the channel is cleared to give it back. Released buffers
+ * collect on a local list and move to the shared free queue whenever the
+ * memory manager channel is clear, one doorbell per batch.
+ */
+
+#include "hal_ipcc.h"
+#include "hal_ipcc_mailbox.h"
+#include "kernel/interrupt.h"
+#include <stddef.h>
+#include <string.h>
+
+/* IPCC register definitions (STM32WB55 specific) */
+#define IPCC_BASE                   0x58000C00UL
+#define IPCC_C1CR_OFFSET            0x00
+#define IPCC_C1MR_OFFSET            0x04
+#define IPCC_C1SCR_OFFSET           0x08
+#define IPCC_C1TOC2SR_OFFSET        0x0C
+#define IPCC_C2TOC1SR_OFFSET        0x1C
+#define IPCC_C1CR_RXOIE             (1UL << 0)
+#define IPCC_CH_BIT(channel)        (1UL << ((channel) - 1))   /* CHnF, CHnC, CHnOM */
+#define IPCC_CH_SET(channel)        (1UL << ((channel) + 15))  /* CHnS, CHnFM */
+#define IPCC_RX_CHANNELS            (IPCC_CH_BIT(IPCC_CH_BLE) | IPCC_CH_BIT(IPCC_CH_SYSTEM))
+#define IPCC_ALL_CHANNELS           0x3FUL
+
+#define IPCC_RCC_BASE               0x58000000UL
+#define RCC_AHB3ENR_OFFSET          0x50
+#define RCC_AHB3ENR_IPCCEN          (1UL << 12)
+#define IPCC_PWR_BASE               0x58000400UL
+#define PWR_CR4_OFFSET              0x0C
+#define PWR_CR4_C2BOOT              (1UL << 15)
+
+#ifdef HAL_IPCC_SIMULATOR
+/* Host build (scripts/bench): registers, interrupts and CPU2 are simulated */
+#include "ipcc_sim.h"
+#else
+#define IPCC_READ(offset)           (*(volatile uint32_t *)(IPCC_BASE + (offset)))
+#define IPCC_WRITE(offset, value)   (*(volatile uint32_t *)(IPCC_BASE + (offset)) = (value))
+#define IPCC_CLOCK_ENABLE()         (*(volatile uint32_t *)(IPCC_RCC_BASE + RCC_AHB3ENR_OFFSET) |= RCC_AHB3ENR_IPCCEN)
+#define IPCC_BOOT_CPU2(table)       ((void)(table), \
+                                     *(volatile uint32_t *)(IPCC_PWR_BASE + PWR_CR4_OFFSET) |= PWR_CR4_C2BOOT)
+
+/* The other core sees memory in program order only across a barrier */
+#define IPCC_BARRIER()              __asm volatile ("dmb" ::: "memory")
+#endif
+
+/* Event pool CPU2 carves into buffers, word-sized steps */
+#define IPCC_POOL_STRIDE            ((sizeof(hal_ipcc_buffer_t) + 3U) & ~3U)
+#define IPCC_POOL_SIZE              (HAL_IPCC_EVENT_BUFFERS * IPCC_POOL_STRIDE)
+
+/* Everything but the reference table; the linker places it after that */
+#define IPCC_SHARED                 __attribute__((section(".ipcc_shared.tables"), aligned(8)))
+
+/* Mailbox, in SRAM_SHARED; the linker keeps it out of .bss so startup does not clear it under CPU2 */
+static ipcc_ref_table_t ipcc_ref_table __attribute__((section(".ipcc_shared"), aligned(8)));
+static ipcc_device_info_t ipcc_device_info IPCC_SHARED;
+static ipcc_ble_table_t ipcc_ble_table IPCC_SHARED;
+static ipcc_sys_table_t ipcc_sys_table IPCC_SHARED;
+static ipcc_mm_table_t ipcc_mm_table IPCC_SHARED;
+static ipcc_traces_table_t ipcc_traces_table IPCC_SHARED;
+static hal_ipcc_node_t ipcc_event_queue IPCC_SHARED;
+static hal_ipcc_node_t ipcc_system_queue IPCC_SHARED;
+static hal_ipcc_node_t ipcc_free_queue IPCC_SHARED;
+static hal_ipcc_node_t ipcc_traces_queue IPCC_SHARED;
+static hal_ipcc_buffer_t ipcc_command_buffer IPCC_SHARED;
+static hal_ipcc_buffer_t ipcc_acl_buffer IPCC_SHARED;
+static hal_ipcc_buffer_t ipcc_system_buffer IPCC_SHARED;
+static hal_ipcc_buffer_t ipcc_spare_ble_buffer IPCC_SHARED;
+static hal_ipcc_buffer_t ipcc_spare_sys_buffer IPCC_SHARED;
+static uint8_t ipcc_status_buffer[IPCC_STATUS_BUFFER_SIZE] IPCC_SHARED;
+static uint8_t ipcc_event_pool[IPCC_POOL_SIZE] IPCC_SHARED;
+
+/* ST's defaults; with the host on CPU1 only the link layer values matter */
+static const ipcc_ble_init_t ipcc_ble_init = {
+    .attribute_records = 68,
+    .attribute_services = 8,
+    .attribute_value_size = 1344,
+    .links = 8,
+    .extended_packet_length = 1,
+    .prepare_write_list = 0x3A,
+    .memory_blocks = 0x79,
+    .att_mtu = 156,
+    .slave_sca = 500,
+    .master_sca = 0,
+    .ls_source = 0,
+    .max_connection_event = 0xFFFFFFFFUL,
+    .hse_startup = 0x148,
+    .viterbi = 1,
+    .options = SHCI_BLE_OPTIONS_LL_ONLY,
+    .hw_version = 0
+};
+
+/* Transport state */
+static bool ipcc_initialized = false;
+static bool ipcc_booted = false;            /* CPU2 runs on this layout until reset */
+static bool ipcc_ready = false;             /* CPU2 accepted the BLE configuration */
+static bool ipcc_system_pending = false;    /* System command with CPU2 */
+static uint32_t ipcc_held;                  /* Send buffers allocated by CPU1, channel bits */
+static uint32_t ipcc_outstanding;           /* Delivered buffers not released yet */
+static hal_ipcc_node_t ipcc_local_free;     /* Released buffers waiting for the memory manager channel */
+static hal_ipcc_receive_callback_t ipcc_callback;
+static hal_ipcc_wakeup_t ipcc_wakeup;
+static void *ipcc_user_data;
+static hal_ipcc_stats_t ipcc_stats;
+
+/* Static function prototypes */
+static uint32_t ipcc_lock(void);
+static void ipcc_unlock(uint32_t primask);
+static void ipcc_layout(void);
+static void ipcc_ring(uint32_t channel);
+static void ipcc_hand_back(uint32_t channel);
+static uint32_t ipcc_channel(const hal_ipcc_buffer_t *buffer);
+static bool ipcc_received(const hal_ipcc_buffer_t *buffer);
+static void ipcc_return_buffers(void);
+static void ipcc_system(void);
+static void ipcc_system_command(uint16_t opcode, const void *params, uint8_t length);
+static uint32_t ipcc_deliver(void);
+static void ipcc_list_init(hal_ipcc_node_t *head);
+static bool ipcc_list_empty(const hal_ipcc_node_t *head);
+static void ipcc_list_insert_tail(hal_ipcc_node_t *head, hal_ipcc_node_t *node);
+static hal_ipcc_node_t *ipcc_list_remove_head(hal_ipcc_node_t *head);
+static bool ipcc_list_contains(const hal_ipcc_node_t *head, const hal_ipcc_node_t *node);
+
+hal_result_t hal_ipcc_init(void)
+{
+    if (ipcc_initialized) {
+        return HAL_OK;
+    }
+
+    IPCC_CLOCK_ENABLE();
+
+    if (!ipcc_booted) {
+        /* Channels masked and clear while the mailbox is laid out */
+        IPCC_WRITE(IPCC_C1MR_OFFSET, IPCC_ALL_CHANNELS | (IPCC_ALL_CHANNELS << 16));
+        IPCC_WRITE(IPCC_C1SCR_OFFSET, IPCC_ALL_CHANNELS);
+        ipcc_layout();
+    }
+
+    if (interrupt_register(IRQ_IPCC_C1_RX, hal_ipcc_rx_irq_handler, IRQ_PRIORITY_NORMAL, "IPCC_C1_RX") != KERNEL_OK) {
+        return HAL_ERROR;
+    }
+
+    IPCC_WRITE(IPCC_C1MR_OFFSET, IPCC_READ(IPCC_C1MR_OFFSET) & ~IPCC_RX_CHANNELS);
+    IPCC_WRITE(IPCC_C1CR_OFFSET, IPCC_C1CR_RXOIE);
+
+    if (interrupt_enable(IRQ_IPCC_C1_RX) != KERNEL_OK) {
+        IPCC_WRITE(IPCC_C1CR_OFFSET, 0);
+        IPCC_WRITE(IPCC_C1MR_OFFSET, IPCC_ALL_CHANNELS | (IPCC_ALL_CHANNELS << 16));
+        interrupt_unregister(IRQ_IPCC_C1_RX);
+        return HAL_ERROR;
+    }
+
+    if (!ipcc_booted) {
+        IPCC_BOOT_CPU2(&ipcc_ref_table);
+        ipcc_booted = true;
+    }
+
+    ipcc_initialized = true;
+    return HAL_OK;
+}
+
+hal_result_t hal_ipcc_deinit(void)
+{
+    if (!ipcc_initialized) {
+        return HAL_ERROR_NOT_INITIALIZED;
+    }
+
+    IPCC_WRITE(IPCC_C1CR_OFFSET, 0);
+    IPCC_WRITE(IPCC_C1MR_OFFSET, IPCC_ALL_CHANNELS | (IPCC_ALL_CHANNELS << 16));
+    interrupt_disable(IRQ_IPCC_C1_RX);
+    interrupt_unregister(IRQ_IPCC_C1_RX);
+
+    ipcc_callback = NULL;
+    ipcc_wakeup = NULL;
+    ipcc_initialized = false;
+    return HAL_OK;
+}
+
+hal_ipcc_buffer_t *hal_ipcc_alloc(hal_ipcc_packet_type_t type)
+{
+    hal_ipcc_buffer_t *buffer;
+    uint32_t channel;
+
+    if (!ipcc_initialized) {
+        return NULL;
+    }
+
+    if (type == HAL_IPCC_PACKET_COMMAND) {
+        buffer = &ipcc_command_buffer;
+        channel = IPCC_CH_BLE;
+    } else if (type == HAL_IPCC_PACKET_ACL) {
+        buffer = &ipcc_acl_buffer;
+        channel = IPCC_CH_ACL;
+    } else {
+        return NULL;
+    }
+
+    uint32_t primask = ipcc_lock();
+    if (!ipcc_ready || (ipcc_held & IPCC_CH_BIT(channel)) != 0) {
+        ipcc_unlock(primask);
+        return NULL;
+    }
+    if ((IPCC_READ(IPCC_C1TOC2SR_OFFSET) & IPCC_CH_BIT(channel)) != 0) {
+        /* CPU2 has not taken the last packet out yet */
+        ipcc_stats.send_busy++;
+        ipcc_unlock(primask);
+        return NULL;
+    }
+    ipcc_held |= IPCC_CH_BIT(channel);
+    ipcc_unlock(primask);
+
+    buffer->type = (uint8_t)type;
+    return buffer;
+}
+
+hal_result_t hal_ipcc_send(hal_ipcc_buffer_t *buffer)
+{
+    if (!ipcc_initialized) {
+        return HAL_ERROR_NOT_INITIALIZED;
+    }
+
+    uint32_t channel = ipcc_channel(buffer);
+    uint32_t length = (channel != 0) ? hal_ipcc_length(buffer) : 0;
+    if (length == 0 || length > HAL_IPCC_BUFFER_PAYLOAD) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    uint32_t primask = ipcc_lock();
+    if ((ipcc_held & IPCC_CH_BIT(channel)) == 0) {
+        ipcc_unlock(primask);
+        return HAL_ERROR_INVALID_PARAM;
+    }
+    ipcc_held &= ~IPCC_CH_BIT(channel);
+    ipcc_stats.packets_sent++;
+    ipcc_ring(channel);
+    ipcc_unlock(primask);
+    return HAL_OK;
+}
+
+void hal_ipcc_free(hal_ipcc_buffer_t *buffer)
+{
+    uint32_t channel = ipcc_channel(buffer);
+
+    uint32_t primask = ipcc_lock();
+    if (channel == 0 || (ipcc_held & IPCC_CH_BIT(channel)) == 0) {
+        ipcc_stats.rejected++;
+    } else {
+        ipcc_held &= ~IPCC_CH_BIT(channel);
+    }
+    ipcc_unlock(primask);
+}
+
+void hal_ipcc_release(hal_ipcc_buffer_t *buffer)
+{
+    hal_ipcc_node_t *node = (hal_ipcc_node_t *)(void *)buffer;
+
+    if (!ipcc_booted) {
+        return;
+    }
+
+    uint32_t primask = ipcc_lock();
+    /* Only a delivered buffer may go back, and only once */
+    if (!ipcc_received(buffer) || ipcc_outstanding == 0 || ipcc_list_contains(&ipcc_local_free, node)) {
+        ipcc_stats.rejected++;
+        ipcc_unlock(primask);
+        return;
+    }
+
+    ipcc_outstanding--;
+    ipcc_list_insert_tail(&ipcc_local_free, node);
+    ipcc_return_buffers();
+    ipcc_unlock(primask);
+}
+
+uint32_t hal_ipcc_length(const hal_ipcc_buffer_t *buffer)
+{
+    if (buffer == NULL) {
+        return 0;
+    }
+
+    switch (buffer->type) {
+    case HAL_IPCC_PACKET_COMMAND:
+    case IPCC_PACKET_SYSTEM_COMMAND:
+        return 3U + buffer->data[2];
+    case HAL_IPCC_PACKET_ACL:
+        return 4U + ((uint32_t)buffer->data[2] | ((uint32_t)buffer->data[3] << 8));
+    case HAL_IPCC_PACKET_EVENT:
+    case IPCC_PACKET_SYSTEM_RESPONSE:
+    case IPCC_PACKET_SYSTEM_EVENT:
+        return 2U + buffer->data[1];
+    default:
+        return 0;
+    }
+}
+
+hal_result_t hal_ipcc_register_callback(hal_ipcc_receive_callback_t callback, hal_ipcc_wakeup_t wakeup,
+                                        void *user_data)
+{
+    uint32_t primask = ipcc_lock();
+    ipcc_callback = callback;
+    ipcc_wakeup = wakeup;
+    ipcc_user_data = user_data;
+    ipcc_unlock(primask);
+    return HAL_OK;
+}
+
+uint32_t hal_ipcc_process(void)
+{
+    if (!ipcc_initialized) {
+        return 0;
+    }
+
+    ipcc_system();
+    uint32_t delivered = ipcc_deliver();
+
+    /* Buffers released while the channel was pending go now */
+    uint32_t primask = ipcc_lock();
+    ipcc_return_buffers();
+    ipcc_unlock(primask);
+
+    return delivered;
+}
+
+hal_result_t hal_ipcc_get_stats(hal_ipcc_stats_t *stats)
+{
+    if (stats == NULL) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    uint32_t primask = ipcc_lock();
+    *stats = ipcc_stats;
+    stats->wireless_version = ipcc_ready ? ipcc_device_info.wireless_version : 0;
+    ipcc_unlock(primask);
+    return HAL_OK;
+}
+
+void hal_ipcc_rx_irq_handler(void)
+{
+    uint32_t pending = IPCC_READ(IPCC_C2TOC1SR_OFFSET) & ~IPCC_READ(IPCC_C1MR_OFFSET) & IPCC_RX_CHANNELS;
+
+    if (pending == 0) {
+        return;
+    }
+
+    /* Silent until hal_ipcc_process() has drained the queues */
+    IPCC_WRITE(IPCC_C1MR_OFFSET, IPCC_READ(IPCC_C1MR_OFFSET) | pending);
+    ipcc_stats.interrupts++;
+
+    if (ipcc_wakeup != NULL) {
+        ipcc_wakeup(ipcc_user_data);
+    }
+}
+
+/* Static helper functions */
+
+static uint32_t ipcc_lock(void)
+{
+#ifdef HAL_IPCC_SIMULATOR
+    return ipcc_sim_lock();
+#else
+    uint32_t primask;
+    __asm volatile ("MRS %0, primask\n\tcpsid i" : "=r" (primask) : : "memory");
+    return primask;
+#endif
+}
+
+static void ipcc_unlock(uint32_t primask)
+{
+#ifdef HAL_IPCC_SIMULATOR
+    ipcc_sim_unlock(primask);
+#else
+    __asm volatile ("MSR primask, %0" : : "r" (primask) : "memory");
+#endif
+}
+
+/**
+ * @brief Fill in the tables and empty the queues before CPU2 starts
+ */
+static void ipcc_layout(void)
+{
+    memset(&ipcc_device_info, 0, sizeof(ipcc_device_info));
+    ipcc_list_init(&ipcc_event_queue);
+    ipcc_list_init(&ipcc_system_queue);
+    ipcc_list_init(&ipcc_free_queue);
+    ipcc_list_init(&ipcc_traces_queue);
+    ipcc_list_init(&ipcc_local_free);
+    ipcc_held = 0;
+    ipcc_outstanding = 0;
+    ipcc_ready = false;
+    ipcc_system_pending = false;
+
+    ipcc_ble_table.command_buffer = &ipcc_command_buffer;
+    ipcc_ble_table.status_buffer = ipcc_status_buffer;
+    ipcc_ble_table.event_queue = &ipcc_event_queue;
+    ipcc_ble_table.acl_buffer = &ipcc_acl_buffer;
+
+    ipcc_sys_table.command_buffer = &ipcc_system_buffer;
+    ipcc_sys_table.system_queue = &ipcc_system_queue;
+
+    ipcc_mm_table.spare_ble_buffer = &ipcc_spare_ble_buffer;
+    ipcc_mm_table.spare_sys_buffer = &ipcc_spare_sys_buffer;
+    ipcc_mm_table.ble_pool = ipcc_event_pool;
+    ipcc_mm_table.ble_pool_size = sizeof(ipcc_event_pool);
+    ipcc_mm_table.free_queue = &ipcc_free_queue;
+    ipcc_mm_table.traces_pool = NULL;
+    ipcc_mm_table.traces_pool_size = 0;
+
+    ipcc_traces_table.traces_queue = &ipcc_traces_queue;
+
+    memset(&ipcc_ref_table, 0, sizeof(ipcc_ref_table));
+    ipcc_ref_table.device_info = &ipcc_device_info;
+    ipcc_ref_table.ble = &ipcc_ble_table;
+    ipcc_ref_table.sys = &ipcc_sys_table;
+    ipcc_ref_table.mm = &ipcc_mm_table;
+    ipcc_ref_table.traces = &ipcc_traces_table;
+    IPCC_BARRIER();
+}
+
+/**
+ * @brief Hand a buffer or queue to CPU2; everything written before is visible to it
+ */
+static void ipcc_ring(uint32_t channel)
+{
+    IPCC_BARRIER();
+    IPCC_WRITE(IPCC_C1SCR_OFFSET, IPCC_CH_SET(channel));
+    ipcc_stats.doorbells_rung++;
+}
+
+/**
+ * @brief Give a drained receive queue back to CPU2 and listen on its channel again
+ */
+static void ipcc_hand_back(uint32_t channel)
+{
+    IPCC_BARRIER();
+    uint32_t primask = ipcc_lock();
+    IPCC_WRITE(IPCC_C1SCR_OFFSET, IPCC_CH_BIT(channel));
+    IPCC_WRITE(IPCC_C1MR_OFFSET, IPCC_READ(IPCC_C1MR_OFFSET) & ~IPCC_CH_BIT(channel));
+    ipcc_unlock(primask);
+}
+
+/**
+ * @brief Channel a send buffer goes out on, 0 if it is not one
+ */
+static uint32_t ipcc_channel(const hal_ipcc_buffer_t *buffer)
+{
+    if (buffer == &ipcc_command_buffer) {
+        return IPCC_CH_BLE;
+    }
+    if (buffer == &ipcc_acl_buffer) {
+        return IPCC_CH_ACL;
+    }
+    return 0;
+}
+
+/**
+ * @brief Whether a buffer is one CPU2 could have delivered: pool or spare
+ */
+static bool ipcc_received(const hal_ipcc_buffer_t *buffer)
+{
+    uintptr_t address = (uintptr_t)buffer;
+    uintptr_t pool = (uintptr_t)ipcc_event_pool;
+
+    if (buffer == &ipcc_spare_ble_buffer || buffer == &ipcc_spare_sys_buffer) {
+        return true;
+    }
+    return address >= pool && address - pool <= sizeof(ipcc_event_pool) - sizeof(hal_ipcc_buffer_t);
+}
+
+/**
+ * @brief Move released buffers to CPU2 if the free queue is ours; caller holds the lock
+ */
+static void ipcc_return_buffers(void)
+{
+    if (ipcc_list_empty(&ipcc_local_free)) {
+        return;
+    }
+    if ((IPCC_READ(IPCC_C1TOC2SR_OFFSET) & IPCC_CH_BIT(IPCC_CH_MM)) != 0) {
+        /* CPU2 is still taking the last batch; this one follows it */
+        ipcc_stats.doorbells_coalesced++;
+        return;
+    }
+
+    IPCC_BARRIER();
+    while (!ipcc_list_empty(&ipcc_local_free)) {
+        ipcc_list_insert_tail(&ipcc_free_queue, ipcc_list_remove_head(&ipcc_local_free));
+    }
+    ipcc_ring(IPCC_CH_MM);
+}
+
+/**
+ * @brief Handle the system channel: ready event, BLE configuration response
+ */
+static void ipcc_system(void)
+{
+    if (ipcc_system_pending && (IPCC_READ(IPCC_C1TOC2SR_OFFSET) & IPCC_CH_BIT(IPCC_CH_SYSTEM)) == 0) {
+        /* The response overwrote the command: Command Complete, 1 credit, opcode, status */
+        const hal_ipcc_buffer_t *response = &ipcc_system_buffer;
+
+        IPCC_BARRIER();
+        ipcc_system_pending = false;
+        if (response->type == IPCC_PACKET_SYSTEM_RESPONSE && response->data[0] == SHCI_EVENT_COMMAND_COMPLETE &&
+            response->data[1] >= 4 &&
+            ((uint16_t)response->data[3] | ((uint16_t)response->data[4] << 8)) == SHCI_OPCODE_BLE_INIT) {
+            ipcc_ready = (response->data[5] == 0);
+        }
+    }
+
+    if ((IPCC_READ(IPCC_C2TOC1SR_OFFSET) & IPCC_CH_BIT(IPCC_CH_SYSTEM)) == 0) {
+        return;
+    }
+
+    IPCC_BARRIER();
+    while (!ipcc_list_empty(&ipcc_system_queue)) {
+        hal_ipcc_buffer_t *event = (hal_ipcc_buffer_t *)(void *)ipcc_list_remove_head(&ipcc_system_queue);
+
+        /* Ready with the wireless stack running (not the firmware upgrade service) */
+        if (event->type == IPCC_PACKET_SYSTEM_EVENT && event->data[0] == SHCI_EVENT_VENDOR && event->data[1] >= 3 &&
+            ((uint16_t)event->data[2] | ((uint16_t)event->data[3] << 8)) == SHCI_SUBEVENT_READY &&
+            event->data[4] == 0 && !ipcc_system_pending) {
+            ipcc_system_command(SHCI_OPCODE_BLE_INIT, &ipcc_ble_init, sizeof(ipcc_ble_init));
+        }
+
+        uint32_t primask = ipcc_lock();
+        ipcc_list_insert_tail(&ipcc_local_free, (hal_ipcc_node_t *)(void *)event);
+        ipcc_unlock(primask);
+    }
+    ipcc_hand_back(IPCC_CH_SYSTEM);
+}
+
+/**
+ * @brief Send a system command; ipcc_system() picks up the response
+ */
+static void ipcc_system_command(uint16_t opcode, const void *params, uint8_t length)
+{
+    hal_ipcc_buffer_t *buffer = &ipcc_system_buffer;
+
+    buffer->type = IPCC_PACKET_SYSTEM_COMMAND;
+    buffer->data[0] = (uint8_t)opcode;
+    buffer->data[1] = (uint8_t)(opcode >> 8);
+    buffer->data[2] = length;
+    memcpy(&buffer->data[3], params, length);
+    ipcc_system_pending = true;
+
+    uint32_t primask = ipcc_lock();
+    ipcc_ring(IPCC_CH_SYSTEM);
+    ipcc_unlock(primask);
+}
+
+/**
+ * @brief Hand the event queue to the callback, HAL_IPCC_BATCH at a time
+ */
+static uint32_t ipcc_deliver(void)
+{
+    hal_ipcc_buffer_t *batch[HAL_IPCC_BATCH];
+    uint32_t delivered = 0;
+
+    /* The queue is CPU1's only while CPU2's flag is up */
+    if ((IPCC_READ(IPCC_C2TOC1SR_OFFSET) & IPCC_CH_BIT(IPCC_CH_BLE)) == 0) {
+        return 0;
+    }
+
+    IPCC_BARRIER();
+    for (;;) {
+        uint32_t count = 0;
+
+        while (count < HAL_IPCC_BATCH && !ipcc_list_empty(&ipcc_event_queue)) {
+            batch[count++] = (hal_ipcc_buffer_t *)(void *)ipcc_list_remove_head(&ipcc_event_queue);
+        }
+        if (count == 0) {
+            break;
+        }
+
+        uint32_t primask = ipcc_lock();
+        ipcc_outstanding += count;
+        ipcc_stats.packets_received += count;
+        ipcc_stats.batches++;
+        if (count > ipcc_stats.batch_max) {
+            ipcc_stats.batch_max = count;
+        }
+        ipcc_unlock(primask);
+        delivered += count;
+
+        if (ipcc_callback != NULL) {
+            ipcc_callback(batch, count, ipcc_user_data);
+        } else {
+            for (uint32_t i = 0; i < count; i++) {
+                hal_ipcc_release(batch[i]);
+            }
+        }
+    }
+
+    ipcc_hand_back(IPCC_CH_BLE);
+    return delivered;
+}
+
+/* Queues follow ST's tl_list: circular, doubly linked, sentinel head */
+
+static void ipcc_list_init(hal_ipcc_node_t *head)
+{
+    head->next = head;
+    head->prev = head;
+}
+
+static bool ipcc_list_empty(const hal_ipcc_node_t *head)
+{
+    return head->next == head;
+}
+
+static void ipcc_list_insert_tail(hal_ipcc_node_t *head, hal_ipcc_node_t *node)
+{
+    node->next = head;
+    node->prev = head->prev;
+    head->prev->next = node;
+    head->prev = node;
+}
+
+static hal_ipcc_node_t *ipcc_list_remove_head(hal_ipcc_node_t *head)
+{
+    hal_ipcc_node_t *node = head->next;
+
+    head->next = node->next;
+    node->next->prev = head;
+    return node;
+}
+
+static bool ipcc_list_contains(const hal_ipcc_node_t *head, const hal_ipcc_node_t *node)
+{
+    for (const hal_ipcc_node_t *at = head->next; at != head; at = at->next) {
+        if (at == node) {
+            return true;
+        }
+    }
+    return false;
+}
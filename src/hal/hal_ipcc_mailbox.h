@@ -0,0 +1,145 @@
+/**
+ * @file hal_ipcc_mailbox.h
+ * @brief Layout of ST's transport layer mailbox shared with CPU2
+ *
+ * Follows the STM32WB wireless stack's mbox_def.h. CPU2 finds the
+ * reference table at the start of SRAM2A and reaches everything else
+ * through it; CPU1 lays the tables out before setting C2BOOT and CPU2
+ * fills in the device info table. Queues are circular doubly linked
+ * lists of packets with a sentinel head, owned by one core at a time:
+ *
+ *   channel  CPU1 -> CPU2                    CPU2 -> CPU1
+ *   1        BLE command in command_buffer   BLE events on event_queue
+ *   2        system command in command_buffer system events on system_queue
+ *   4        released buffers on free_queue  traces (not used)
+ *   6        ACL packet in acl_buffer        -
+ *
+ * A core sets a channel to hand the buffer or queue over and the other
+ * core clears it to hand it back. Shared by hal_ipcc.c and the host
+ * CPU2 simulator in scripts/bench.
+ */
+
+#ifndef HAL_IPCC_MAILBOX_H
+#define HAL_IPCC_MAILBOX_H
+
+#include "hal_ipcc.h"
+
+/* IPCC channels */
+#define IPCC_CH_BLE                 1
+#define IPCC_CH_SYSTEM              2
+#define IPCC_CH_MM                  4
+#define IPCC_CH_ACL                 6
+
+/* Packet indicators beyond HCI */
+#define IPCC_PACKET_SYSTEM_COMMAND  0x10
+#define IPCC_PACKET_SYSTEM_RESPONSE 0x11
+#define IPCC_PACKET_SYSTEM_EVENT    0x12
+
+/* System interface (SHCI) */
+#define SHCI_OPCODE_BLE_INIT        0xFC66
+#define SHCI_EVENT_COMMAND_COMPLETE 0x0E
+#define SHCI_EVENT_VENDOR           0xFF
+#define SHCI_SUBEVENT_READY         0x9200
+#define SHCI_BLE_OPTIONS_LL_ONLY    0x01    /* Host runs on CPU1: CPU2 is an HCI controller */
+
+/* Command Status buffer: link, indicator, event header and 4 parameter bytes */
+#define IPCC_STATUS_BUFFER_SIZE     (sizeof(hal_ipcc_node_t) + 3U + 4U)
+
+/**
+ * @brief Device info table, filled in by CPU2 (MB_DeviceInfoTable_t)
+ */
+typedef struct {
+    uint32_t safe_boot_version;
+    uint32_t fus_version;
+    uint32_t fus_memory_size;
+    uint32_t fus_info;
+    uint32_t wireless_version;
+    uint32_t wireless_memory_size;
+    uint32_t wireless_thread_info;
+    uint32_t wireless_ble_info;
+} ipcc_device_info_t;
+
+/**
+ * @brief BLE table (MB_BleTable_t)
+ */
+typedef struct {
+    hal_ipcc_buffer_t *command_buffer;
+    uint8_t *status_buffer;
+    hal_ipcc_node_t *event_queue;
+    hal_ipcc_buffer_t *acl_buffer;
+} ipcc_ble_table_t;
+
+/**
+ * @brief System table (MB_SysTable_t); the response overwrites the command
+ */
+typedef struct {
+    hal_ipcc_buffer_t *command_buffer;
+    hal_ipcc_node_t *system_queue;
+} ipcc_sys_table_t;
+
+/**
+ * @brief Memory manager table (MB_MemManagerTable_t)
+ *
+ * CPU2 carves the event pool into its own buffers and takes them back
+ * from free_queue.
+ */
+typedef struct {
+    hal_ipcc_buffer_t *spare_ble_buffer;
+    hal_ipcc_buffer_t *spare_sys_buffer;
+    uint8_t *ble_pool;
+    uint32_t ble_pool_size;
+    hal_ipcc_node_t *free_queue;
+    uint8_t *traces_pool;
+    uint32_t traces_pool_size;
+} ipcc_mm_table_t;
+
+/**
+ * @brief Traces table (MB_TracesTable_t)
+ */
+typedef struct {
+    hal_ipcc_node_t *traces_queue;
+} ipcc_traces_table_t;
+
+/**
+ * @brief Reference table at the start of SRAM2A (MB_RefTable_t)
+ *
+ * Tables for stacks this firmware does not load stay NULL.
+ */
+typedef struct {
+    ipcc_device_info_t *device_info;
+    ipcc_ble_table_t *ble;
+    void *thread;
+    ipcc_sys_table_t *sys;
+    ipcc_mm_table_t *mm;
+    ipcc_traces_table_t *traces;
+    void *mac_802_15_4;
+    void *zigbee;
+    void *lld_tests;
+    void *ble_lld;
+} ipcc_ref_table_t;
+
+/**
+ * @brief SHCI_C2_BLE_Init parameters, as sent in the system command
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t ble_buffer_address;        /* Unused, 0 */
+    uint32_t ble_buffer_size;           /* Unused, 0 */
+    uint16_t attribute_records;
+    uint16_t attribute_services;
+    uint16_t attribute_value_size;
+    uint8_t links;
+    uint8_t extended_packet_length;
+    uint8_t prepare_write_list;
+    uint8_t memory_blocks;
+    uint16_t att_mtu;
+    uint16_t slave_sca;
+    uint8_t master_sca;
+    uint8_t ls_source;
+    uint32_t max_connection_event;
+    uint16_t hse_startup;
+    uint8_t viterbi;
+    uint8_t options;
+    uint8_t hw_version;
+} ipcc_ble_init_t;
+
+#endif /* HAL_IPCC_MAILBOX_H */
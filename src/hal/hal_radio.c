@@ -7,122 +7,31 @@
  * transmission and reception capabilities.
  */
 
-#include "hal_radio.h"
+#include "hal_radio_internal.h"
 #include "hal_internal.h"
+#include "kernel/scheduler.h"
 #include <string.h>
 #include <stdlib.h>
 
-/* CC1101 register definitions */
-#define CC1101_IOCFG2       0x00    /**< GDO2 output pin configuration */
-#define CC1101_IOCFG1       0x01    /**< GDO1 output pin configuration */
-#define CC1101_IOCFG0       0x02    /**< GDO0 output pin configuration */
-#define CC1101_FIFOTHR      0x03    /**< RX FIFO and TX FIFO thresholds */
-#define CC1101_SYNC1        0x04    /**< Sync word, high byte */
-#define CC1101_SYNC0        0x05    /**< Sync word, low byte */
-#define CC1101_PKTLEN       0x06    /**< Packet length */
-#define CC1101_PKTCTRL1     0x07    /**< Packet automation control */
-#define CC1101_PKTCTRL0     0x08    /**< Packet automation control */
-#define CC1101_ADDR         0x09    /**< Device address */
-#define CC1101_CHANNR       0x0A    /**< Channel number */
-#define CC1101_FSCTRL1      0x0B    /**< Frequency synthesizer control */
-#define CC1101_FSCTRL0      0x0C    /**< Frequency synthesizer control */
-#define CC1101_FREQ2        0x0D    /**< Frequency control word, high byte */
-#define CC1101_FREQ1        0x0E    /**< Frequency control word, middle byte */
-#define CC1101_FREQ0        0x0F    /**< Frequency control word, low byte */
-#define CC1101_MDMCFG4      0x10    /**< Modem configuration */
-#define CC1101_MDMCFG3      0x11    /**< Modem configuration */
-#define CC1101_MDMCFG2      0x12    /**< Modem configuration */
-#define CC1101_MDMCFG1      0x13    /**< Modem configuration */
-#define CC1101_MDMCFG0      0x14    /**< Modem configuration */
-#define CC1101_DEVIATN      0x15    /**< Modem deviation setting */
-
-/* CC1101 command strobes */
-#define CC1101_SRES         0x30    /**< Reset chip */
-#define CC1101_SFSTXON      0x31    /**< Enable and calibrate frequency synthesizer */
-#define CC1101_SXOFF        0x32    /**< Turn off crystal oscillator */
-#define CC1101_SCAL         0x33    /**< Calibrate frequency synthesizer */
-#define CC1101_SRX          0x34    /**< Enable RX */
-#define CC1101_STX          0x35    /**< Enable TX */
-#define CC1101_SIDLE        0x36    /**< Exit RX / TX, turn off frequency synthesizer */
-#define CC1101_SWOR         0x38    /**< Start automatic RX polling sequence */
-#define CC1101_SPWD         0x39    /**< Enter power down mode */
-#define CC1101_SFRX         0x3A    /**< Flush the RX FIFO buffer */
-#define CC1101_SFTX         0x3B    /**< Flush the TX FIFO buffer */
-#define CC1101_SWORRST      0x3C    /**< Reset real time clock */
-#define CC1101_SNOP         0x3D    /**< No operation */
-
-/* Bluetooth register definitions (STM32WB55 specific) */
-#define BLE_BASE_ADDR       0x58000000UL
-#define BLE_CTRL_OFFSET     0x00
-#define BLE_STATUS_OFFSET   0x04
-#define BLE_CONFIG_OFFSET   0x08
-
 /* Maximum number of radio instances */
 #define MAX_RADIO_INSTANCES 2
 
-/**
- * @brief Radio instance structure
- */
-typedef struct {
-    uint32_t radio_id;                      /**< Radio instance ID */
-    hal_radio_type_t type;                  /**< Radio hardware type */
-    hal_radio_config_t config;              /**< Radio configuration */
-    hal_radio_state_t state;                /**< Current radio state */
-    hal_radio_stats_t stats;                /**< Radio statistics */
-    hal_radio_event_callback_t callback;    /**< Event callback function */
-    void *callback_user_data;               /**< User data for callback */
-    bool in_use;                            /**< Instance in use flag */
-    void *hw_context;                       /**< Hardware-specific context */
-} hal_radio_instance_t;
-
-/**
- * @brief CC1101 hardware context
- */
-typedef struct {
-    uint32_t spi_device_id;                 /**< SPI device ID for communication */
-    uint32_t cs_pin;                        /**< Chip select GPIO pin */
-    uint32_t gdo0_pin;                      /**< GDO0 GPIO pin */
-    uint32_t gdo2_pin;                      /**< GDO2 GPIO pin */
-    uint8_t tx_fifo[64];                    /**< TX FIFO buffer */
-    uint8_t rx_fifo[64];                    /**< RX FIFO buffer */
-    uint8_t fifo_threshold;                 /**< FIFO threshold */
-} hal_radio_cc1101_context_t;
-
-/**
- * @brief Bluetooth hardware context
- */
-typedef struct {
-    uint32_t base_address;                  /**< BLE controller base address */
-    uint8_t tx_buffer[256];                 /**< TX buffer */
-    uint8_t rx_buffer[256];                 /**< RX buffer */
-    uint16_t connection_handle;             /**< BLE connection handle */
-} hal_radio_bluetooth_context_t;
-
 /* Radio HAL state */
 static bool radio_hal_initialized = false;
 static hal_radio_instance_t radio_instances[MAX_RADIO_INSTANCES];
 static uint32_t next_radio_id = 1;
 static hal_device_t radio_device;
 static hal_driver_t radio_driver;
+static uint32_t radio_task_id;              /* 0 while not running */
 
 /* Forward declarations */
 static hal_result_t radio_driver_init(hal_device_t *device);
 static hal_result_t radio_driver_deinit(hal_device_t *device);
-static hal_result_t cc1101_init(hal_radio_instance_t *instance);
-static hal_result_t cc1101_deinit(hal_radio_instance_t *instance);
-static hal_result_t cc1101_configure(hal_radio_instance_t *instance, const hal_radio_config_t *config);
-static hal_result_t cc1101_transmit(hal_radio_instance_t *instance, const hal_radio_packet_t *packet);
-static hal_result_t cc1101_receive(hal_radio_instance_t *instance, hal_radio_packet_t *packet, uint32_t timeout_ms);
-static hal_result_t cc1101_set_state(hal_radio_instance_t *instance, hal_radio_state_t state);
-static hal_result_t bluetooth_init(hal_radio_instance_t *instance);
-static hal_result_t bluetooth_deinit(hal_radio_instance_t *instance);
-static hal_result_t bluetooth_configure(hal_radio_instance_t *instance, const hal_radio_config_t *config);
-static hal_result_t bluetooth_transmit(hal_radio_instance_t *instance, const hal_radio_packet_t *packet);
-static hal_result_t bluetooth_receive(hal_radio_instance_t *instance, hal_radio_packet_t *packet, uint32_t timeout_ms);
-static hal_result_t bluetooth_set_state(hal_radio_instance_t *instance, hal_radio_state_t state);
+static hal_result_t hal_radio_set_state(hal_radio_instance_t *instance, hal_radio_state_t state);
 static hal_radio_instance_t *find_radio_instance(uint32_t radio_id);
 static hal_radio_instance_t *allocate_radio_instance(hal_radio_type_t type);
 static void free_radio_instance(hal_radio_instance_t *instance);
+static void radio_task(void);
 
 /* Radio driver operations */
 static const hal_driver_ops_t radio_driver_ops = {
@@ -188,6 +97,23 @@ hal_result_t hal_radio_init(void)
         return result;
     }
 
+    /* Clock for async request timing */
+    result = hal_radio_timer_init();
+    if (result != HAL_OK) {
+        hal_device_unregister(&radio_device);
+        hal_driver_unregister(&radio_driver);
+        return result;
+    }
+
+    /* Controller events, advertising turns, L2CAP data and arbiter slots are run from here */
+    radio_task_id = process_create("radio", radio_task, HAL_RADIO_TASK_STACK, PRIORITY_HIGH, PROCESS_FLAG_SYSTEM);
+    if (radio_task_id == 0) {
+        hal_radio_timer_deinit();
+        hal_device_unregister(&radio_device);
+        hal_driver_unregister(&radio_driver);
+        return HAL_ERROR_NO_MEMORY;
+    }
+
     radio_hal_initialized = true;
     return HAL_OK;
 }
@@ -201,6 +127,9 @@ hal_result_t hal_radio_deinit(void)
         return HAL_ERROR_NOT_INITIALIZED;
     }
 
+    process_terminate(radio_task_id);
+    radio_task_id = 0;
+
     /* Close all radio instances */
     for (uint32_t i = 0; i < MAX_RADIO_INSTANCES; i++) {
         if (radio_instances[i].in_use) {
@@ -208,6 +137,8 @@ hal_result_t hal_radio_deinit(void)
         }
     }
 
+    hal_radio_timer_deinit();
+
     /* Unregister device and driver */
     hal_device_unregister(&radio_device);
     hal_driver_unregister(&radio_driver);
@@ -272,6 +203,8 @@ hal_result_t hal_radio_close(uint32_t radio_id)
         return HAL_ERROR_RESOURCE_NOT_FOUND;
     }
 
+    hal_radio_arbiter_detach(instance);
+
     /* Deinitialize hardware-specific context */
     hal_result_t result = HAL_OK;
     switch (instance->type) {
@@ -333,8 +266,9 @@ hal_result_t hal_radio_configure(uint32_t radio_id, const hal_radio_config_t *co
     }
 
     return result;
-}/**
+}
 
+/**
  * @brief Get radio configuration
  */
 hal_result_t hal_radio_get_config(uint32_t radio_id, hal_radio_config_t *config)
@@ -486,6 +420,137 @@ hal_result_t hal_radio_receive(uint32_t radio_id, hal_radio_packet_t *packet, ui
     return result;
 }
 
+/**
+ * @brief Queue a packet for transmission
+ */
+hal_result_t hal_radio_transmit_async(uint32_t radio_id, const hal_radio_packet_t *packet,
+                                      const hal_radio_request_options_t *options, hal_radio_request_t *request)
+{
+    if (!radio_hal_initialized) {
+        return HAL_ERROR_NOT_INITIALIZED;
+    }
+
+    if (packet == NULL || packet->data == NULL || packet->length == 0) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    hal_radio_instance_t *instance = find_radio_instance(radio_id);
+    if (instance == NULL) {
+        return HAL_ERROR_RESOURCE_NOT_FOUND;
+    }
+
+    if (instance->type != HAL_RADIO_TYPE_CC1101) {
+        return HAL_ERROR_NOT_SUPPORTED;
+    }
+
+    /* The packet is only read; the completion hands back the caller's pointer */
+    return cc1101_submit(instance, true, (hal_radio_packet_t *)packet, options, request);
+}
+
+/**
+ * @brief Transmit a packet at an absolute time
+ */
+hal_result_t hal_radio_transmit_at(uint32_t radio_id, const hal_radio_packet_t *packet, uint32_t start_us,
+                                   hal_radio_request_t *request)
+{
+    hal_radio_request_options_t options;
+
+    memset(&options, 0, sizeof(options));
+    options.at_time = true;
+    options.start_us = start_us;
+    return hal_radio_transmit_async(radio_id, packet, &options, request);
+}
+
+/**
+ * @brief Get the radio clock
+ */
+hal_result_t hal_radio_get_time(uint32_t *time_us)
+{
+    if (!radio_hal_initialized) {
+        return HAL_ERROR_NOT_INITIALIZED;
+    }
+
+    if (time_us == NULL) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    *time_us = hal_radio_timer_now();
+    return HAL_OK;
+}
+
+/**
+ * @brief Queue a receive window
+ */
+hal_result_t hal_radio_receive_async(uint32_t radio_id, hal_radio_packet_t *packet,
+                                     const hal_radio_request_options_t *options, hal_radio_request_t *request)
+{
+    if (!radio_hal_initialized) {
+        return HAL_ERROR_NOT_INITIALIZED;
+    }
+
+    if (packet == NULL || packet->data == NULL || packet->length == 0) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    hal_radio_instance_t *instance = find_radio_instance(radio_id);
+    if (instance == NULL) {
+        return HAL_ERROR_RESOURCE_NOT_FOUND;
+    }
+
+    if (instance->type != HAL_RADIO_TYPE_CC1101) {
+        return HAL_ERROR_NOT_SUPPORTED;
+    }
+
+    return cc1101_submit(instance, false, packet, options, request);
+}
+
+/**
+ * @brief Withdraw a queued async request
+ */
+hal_result_t hal_radio_cancel(uint32_t radio_id, hal_radio_request_t request)
+{
+    if (!radio_hal_initialized) {
+        return HAL_ERROR_NOT_INITIALIZED;
+    }
+
+    if (request == HAL_RADIO_REQUEST_NONE) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    hal_radio_instance_t *instance = find_radio_instance(radio_id);
+    if (instance == NULL) {
+        return HAL_ERROR_RESOURCE_NOT_FOUND;
+    }
+
+    if (instance->type != HAL_RADIO_TYPE_CC1101) {
+        return HAL_ERROR_NOT_SUPPORTED;
+    }
+
+    return cc1101_cancel(instance, request);
+}
+
+/**
+ * @brief Register a client sharing a radio through the arbiter
+ */
+hal_result_t hal_radio_arbiter_register(uint32_t radio_id, const hal_radio_client_config_t *config,
+                                        hal_radio_client_t *client)
+{
+    if (!radio_hal_initialized) {
+        return HAL_ERROR_NOT_INITIALIZED;
+    }
+
+    if (config == NULL || client == NULL) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    hal_radio_instance_t *instance = find_radio_instance(radio_id);
+    if (instance == NULL) {
+        return HAL_ERROR_RESOURCE_NOT_FOUND;
+    }
+
+    return hal_radio_arbiter_attach(instance, config, client);
+}
+
 /**
  * @brief Get radio state
  */
@@ -637,6 +702,18 @@ const char *hal_radio_state_to_string(hal_radio_state_t state)
 
 /* Helper functions */
 
+/**
+ * @brief Deliver an event to the instance's callback
+ */
+void hal_radio_notify(hal_radio_instance_t *instance, hal_radio_event_t event, void *data)
+{
+    hal_radio_event_callback_t callback = instance->callback;
+
+    if (callback != NULL) {
+        callback(instance->radio_id, event, data, instance->callback_user_data);
+    }
+}
+
 /**
  * @brief Find radio instance by ID
  */
@@ -682,336 +759,504 @@ static void free_radio_instance(hal_radio_instance_t *instance)
     }
 }
 
-/* CC1101 Hardware-specific implementations */
-
 /**
- * @brief Initialize CC1101 radio
+ * @brief Set radio state (hardware-agnostic)
  */
-static hal_result_t cc1101_init(hal_radio_instance_t *instance)
+static hal_result_t hal_radio_set_state(hal_radio_instance_t *instance, hal_radio_state_t state)
 {
     if (instance == NULL) {
         return HAL_ERROR_INVALID_PARAM;
     }
 
-    /* Allocate CC1101 context */
-    hal_radio_cc1101_context_t *ctx = malloc(sizeof(hal_radio_cc1101_context_t));
-    if (ctx == NULL) {
-        return HAL_ERROR_NO_MEMORY;
+    /* Apply state change using hardware-specific implementation */
+    switch (instance->type) {
+        case HAL_RADIO_TYPE_CC1101:
+            return cc1101_set_state(instance, state);
+        case HAL_RADIO_TYPE_BLUETOOTH:
+            return bluetooth_set_state(instance, state);
+        default:
+            return HAL_ERROR_NOT_SUPPORTED;
     }
+}
 
-    memset(ctx, 0, sizeof(hal_radio_cc1101_context_t));
-    
-    /* TODO: Initialize SPI interface and GPIO pins for CC1101
-     * This would involve:
-     * 1. Configure SPI interface for CC1101 communication
-     * 2. Configure GPIO pins for CS, GDO0, GDO2
-     * 3. Reset CC1101 chip
-     * 4. Verify chip ID and version
-     */
-    
-    ctx->spi_device_id = 0;  /* Placeholder */
-    ctx->cs_pin = 0;         /* Placeholder */
-    ctx->gdo0_pin = 0;       /* Placeholder */
-    ctx->gdo2_pin = 0;       /* Placeholder */
-    ctx->fifo_threshold = 32;
-
-    instance->hw_context = ctx;
-    return HAL_OK;
+/**
+ * @brief Radio task: runs the Bluetooth controller interface and arbiter switches
+ *
+ * Every pass hands the rest of its time slice back, so the task costs
+ * little more than the work it finds.
+ */
+static void radio_task(void)
+{
+    while (1) {
+        hal_radio_bluetooth_poll();
+        hal_radio_arbiter_service();
+        scheduler_yield();
+    }
 }
 
+/* Driver implementation */
+
 /**
- * @brief Deinitialize CC1101 radio
+ * @brief Radio driver initialization
  */
-static hal_result_t cc1101_deinit(hal_radio_instance_t *instance)
+static hal_result_t radio_driver_init(hal_device_t *device)
 {
-    if (instance == NULL || instance->hw_context == NULL) {
+    if (device == NULL) {
         return HAL_ERROR_INVALID_PARAM;
     }
 
-    /* TODO: Put CC1101 in sleep mode and release resources */
+    /* TODO: Initialize radio hardware clocks and power */
 
-    free(instance->hw_context);
-    instance->hw_context = NULL;
     return HAL_OK;
 }
 
 /**
- * @brief Configure CC1101 radio
+ * @brief Radio driver deinitialization
  */
-static hal_result_t cc1101_configure(hal_radio_instance_t *instance, const hal_radio_config_t *config)
+static hal_result_t radio_driver_deinit(hal_device_t *device)
 {
-    if (instance == NULL || config == NULL || instance->hw_context == NULL) {
+    if (device == NULL) {
         return HAL_ERROR_INVALID_PARAM;
     }
 
-    /* TODO: Configure CC1101 registers based on configuration
-     * This would involve:
-     * 1. Set frequency registers (FREQ2, FREQ1, FREQ0)
-     * 2. Set modulation and data rate (MDMCFG registers)
-     * 3. Set power level (PATABLE)
-     * 4. Set packet format (PKTCTRL registers)
-     * 5. Set sync word (SYNC1, SYNC0)
-     */
+    /* TODO: Disable radio hardware clocks and power */
 
     return HAL_OK;
 }
 
+/* Additional Radio HAL functions */
+
 /**
- * @brief Transmit packet using CC1101
+ * @brief Set radio modulation
  */
-static hal_result_t cc1101_transmit(hal_radio_instance_t *instance, const hal_radio_packet_t *packet)
+hal_result_t hal_radio_set_modulation(uint32_t radio_id, hal_radio_modulation_t modulation)
 {
-    if (instance == NULL || packet == NULL || instance->hw_context == NULL) {
+    if (!radio_hal_initialized) {
+        return HAL_ERROR_NOT_INITIALIZED;
+    }
+
+    if (modulation >= HAL_RADIO_MODULATION_MAX) {
         return HAL_ERROR_INVALID_PARAM;
     }
 
-    /* TODO: Implement CC1101 transmission
-     * This would involve:
-     * 1. Write packet data to TX FIFO
-     * 2. Send STX command strobe
-     * 3. Wait for transmission complete (GDO0 or interrupt)
-     * 4. Return to idle state
-     */
+    hal_radio_instance_t *instance = find_radio_instance(radio_id);
+    if (instance == NULL) {
+        return HAL_ERROR_RESOURCE_NOT_FOUND;
+    }
 
-    instance->state = HAL_RADIO_STATE_TX;
-    /* Simulate transmission delay */
-    instance->state = HAL_RADIO_STATE_IDLE;
+    instance->config.modulation = modulation;
 
-    return HAL_OK;
+    /* Apply modulation change to hardware */
+    hal_radio_config_t config = instance->config;
+    return hal_radio_configure(radio_id, &config);
 }
 
 /**
- * @brief Receive packet using CC1101
+ * @brief Switch to a precomputed configuration profile
  */
-static hal_result_t cc1101_receive(hal_radio_instance_t *instance, hal_radio_packet_t *packet, uint32_t timeout_ms)
+hal_result_t hal_radio_apply_preset(uint32_t radio_id, hal_radio_preset_t preset, uint32_t frequency_hz)
 {
-    if (instance == NULL || packet == NULL || instance->hw_context == NULL) {
+    if (!radio_hal_initialized) {
+        return HAL_ERROR_NOT_INITIALIZED;
+    }
+
+    if (preset >= HAL_RADIO_PRESET_MAX) {
         return HAL_ERROR_INVALID_PARAM;
     }
 
-    /* TODO: Implement CC1101 reception
-     * This would involve:
-     * 1. Send SRX command strobe
-     * 2. Wait for packet reception (GDO0 or interrupt)
-     * 3. Read packet data from RX FIFO
-     * 4. Read RSSI and LQI values
-     * 5. Return to idle state
-     */
+    hal_radio_instance_t *instance = find_radio_instance(radio_id);
+    if (instance == NULL) {
+        return HAL_ERROR_RESOURCE_NOT_FOUND;
+    }
+
+    if (instance->type != HAL_RADIO_TYPE_CC1101) {
+        return HAL_ERROR_NOT_SUPPORTED;
+    }
 
-    instance->state = HAL_RADIO_STATE_RX;
-    /* Simulate reception timeout */
-    instance->state = HAL_RADIO_STATE_IDLE;
+    hal_radio_config_t config = instance->config;
+    hal_result_t result = cc1101_apply_preset(instance, preset, frequency_hz, &config);
+    if (result == HAL_OK) {
+        instance->config = config;
+    }
 
-    return HAL_ERROR_TIMEOUT;
+    return result;
 }
 
-/* Bluetooth Hardware-specific implementations */
+/**
+ * @brief Start continuous transmission
+ */
+hal_result_t hal_radio_start_tx_continuous(uint32_t radio_id, const uint8_t *data, uint16_t length)
+{
+    if (!radio_hal_initialized) {
+        return HAL_ERROR_NOT_INITIALIZED;
+    }
+
+    if (data == NULL || length == 0) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    hal_radio_instance_t *instance = find_radio_instance(radio_id);
+    if (instance == NULL) {
+        return HAL_ERROR_RESOURCE_NOT_FOUND;
+    }
+
+    /* TODO: Implement continuous transmission mode */
+    instance->state = HAL_RADIO_STATE_TX;
+
+    return HAL_OK;
+}
 
 /**
- * @brief Initialize Bluetooth radio
+ * @brief Start continuous reception
  */
-static hal_result_t bluetooth_init(hal_radio_instance_t *instance)
+hal_result_t hal_radio_start_rx_continuous(uint32_t radio_id)
 {
+    if (!radio_hal_initialized) {
+        return HAL_ERROR_NOT_INITIALIZED;
+    }
+
+    hal_radio_instance_t *instance = find_radio_instance(radio_id);
     if (instance == NULL) {
+        return HAL_ERROR_RESOURCE_NOT_FOUND;
+    }
+
+    switch (instance->type) {
+        case HAL_RADIO_TYPE_CC1101:
+            return cc1101_start_capture(instance);
+        case HAL_RADIO_TYPE_BLUETOOTH:
+            /* TODO: Implement continuous reception mode */
+            instance->state = HAL_RADIO_STATE_RX;
+            return HAL_OK;
+        default:
+            return HAL_ERROR_NOT_SUPPORTED;
+    }
+}
+
+/**
+ * @brief Start duty-cycled reception (wake-on-radio)
+ */
+hal_result_t hal_radio_start_wor(uint32_t radio_id, const hal_radio_wor_config_t *config,
+                                 hal_radio_packet_t *packet, hal_radio_wor_timing_t *timing)
+{
+    if (!radio_hal_initialized) {
+        return HAL_ERROR_NOT_INITIALIZED;
+    }
+
+    if (config == NULL || packet == NULL || packet->data == NULL || packet->length == 0) {
         return HAL_ERROR_INVALID_PARAM;
     }
 
-    /* Allocate Bluetooth context */
-    hal_radio_bluetooth_context_t *ctx = malloc(sizeof(hal_radio_bluetooth_context_t));
-    if (ctx == NULL) {
-        return HAL_ERROR_NO_MEMORY;
+    hal_radio_instance_t *instance = find_radio_instance(radio_id);
+    if (instance == NULL) {
+        return HAL_ERROR_RESOURCE_NOT_FOUND;
     }
 
-    memset(ctx, 0, sizeof(hal_radio_bluetooth_context_t));
-    
-    /* TODO: Initialize Bluetooth controller
-     * This would involve:
-     * 1. Initialize BLE controller registers
-     * 2. Configure BLE stack parameters
-     * 3. Set up advertising and scanning parameters
-     */
-    
-    ctx->base_address = BLE_BASE_ADDR;
-    ctx->connection_handle = 0xFFFF;  /* Invalid handle */
+    if (instance->type != HAL_RADIO_TYPE_CC1101) {
+        return HAL_ERROR_NOT_SUPPORTED;
+    }
 
-    instance->hw_context = ctx;
-    return HAL_OK;
+    return cc1101_start_wor(instance, config, packet, timing);
+}
+
+/**
+ * @brief Stop continuous operation
+ */
+hal_result_t hal_radio_stop_continuous(uint32_t radio_id)
+{
+    if (!radio_hal_initialized) {
+        return HAL_ERROR_NOT_INITIALIZED;
+    }
+
+    hal_radio_instance_t *instance = find_radio_instance(radio_id);
+    if (instance == NULL) {
+        return HAL_ERROR_RESOURCE_NOT_FOUND;
+    }
+
+    /* Stop continuous operation and return to idle */
+    return hal_radio_set_idle(radio_id);
 }
 
 /**
- * @brief Deinitialize Bluetooth radio
+ * @brief Take the oldest filled capture buffer
  */
-static hal_result_t bluetooth_deinit(hal_radio_instance_t *instance)
+hal_result_t hal_radio_capture_acquire(uint32_t radio_id, const hal_radio_capture_buffer_t **buffer)
 {
-    if (instance == NULL || instance->hw_context == NULL) {
+    if (!radio_hal_initialized) {
+        return HAL_ERROR_NOT_INITIALIZED;
+    }
+
+    if (buffer == NULL) {
         return HAL_ERROR_INVALID_PARAM;
     }
 
-    /* TODO: Shutdown Bluetooth controller */
+    hal_radio_instance_t *instance = find_radio_instance(radio_id);
+    if (instance == NULL) {
+        return HAL_ERROR_RESOURCE_NOT_FOUND;
+    }
 
-    free(instance->hw_context);
-    instance->hw_context = NULL;
-    return HAL_OK;
+    return hal_radio_capture_take(instance, buffer);
 }
 
 /**
- * @brief Configure Bluetooth radio
+ * @brief Return a capture buffer to the pool
  */
-static hal_result_t bluetooth_configure(hal_radio_instance_t *instance, const hal_radio_config_t *config)
+hal_result_t hal_radio_capture_release(uint32_t radio_id, const hal_radio_capture_buffer_t *buffer)
 {
-    if (instance == NULL || config == NULL || instance->hw_context == NULL) {
+    if (!radio_hal_initialized) {
+        return HAL_ERROR_NOT_INITIALIZED;
+    }
+
+    if (buffer == NULL) {
         return HAL_ERROR_INVALID_PARAM;
     }
 
-    /* TODO: Configure Bluetooth parameters
-     * This would involve:
-     * 1. Set advertising parameters
-     * 2. Set connection parameters
-     * 3. Configure custom packet formats for WiFi emulation
-     */
+    hal_radio_instance_t *instance = find_radio_instance(radio_id);
+    if (instance == NULL) {
+        return HAL_ERROR_RESOURCE_NOT_FOUND;
+    }
 
-    return HAL_OK;
+    return hal_radio_capture_give(instance, buffer);
 }
 
 /**
- * @brief Transmit packet using Bluetooth
+ * @brief Spill filled capture buffers to a sink
  */
-static hal_result_t bluetooth_transmit(hal_radio_instance_t *instance, const hal_radio_packet_t *packet)
+hal_result_t hal_radio_capture_spill(uint32_t radio_id, hal_radio_capture_sink_t sink, void *user_data,
+                                     uint32_t *spilled)
 {
-    if (instance == NULL || packet == NULL || instance->hw_context == NULL) {
+    if (!radio_hal_initialized) {
+        return HAL_ERROR_NOT_INITIALIZED;
+    }
+
+    if (sink == NULL) {
         return HAL_ERROR_INVALID_PARAM;
     }
 
-    /* TODO: Implement Bluetooth transmission
-     * This would involve:
-     * 1. Format packet for BLE transmission
-     * 2. Send via BLE controller
-     * 3. Handle acknowledgments
-     */
+    hal_radio_instance_t *instance = find_radio_instance(radio_id);
+    if (instance == NULL) {
+        return HAL_ERROR_RESOURCE_NOT_FOUND;
+    }
+
+    return hal_radio_capture_drain(instance, sink, user_data, spilled);
+}
 
-    instance->state = HAL_RADIO_STATE_TX;
-    /* Simulate transmission */
-    instance->state = HAL_RADIO_STATE_IDLE;
+/**
+ * @brief Get raw capture counters
+ */
+hal_result_t hal_radio_capture_get_stats(uint32_t radio_id, hal_radio_capture_stats_t *stats)
+{
+    if (!radio_hal_initialized) {
+        return HAL_ERROR_NOT_INITIALIZED;
+    }
 
-    return HAL_OK;
+    if (stats == NULL) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    hal_radio_instance_t *instance = find_radio_instance(radio_id);
+    if (instance == NULL) {
+        return HAL_ERROR_RESOURCE_NOT_FOUND;
+    }
+
+    return hal_radio_capture_stats(instance, stats);
 }
 
 /**
- * @brief Receive packet using Bluetooth
+ * @brief Start sampling the demodulator output
  */
-static hal_result_t bluetooth_receive(hal_radio_instance_t *instance, hal_radio_packet_t *packet, uint32_t timeout_ms)
+hal_result_t hal_radio_start_sampling(uint32_t radio_id, uint32_t sample_rate_hz)
 {
-    if (instance == NULL || packet == NULL || instance->hw_context == NULL) {
+    if (!radio_hal_initialized) {
+        return HAL_ERROR_NOT_INITIALIZED;
+    }
+
+    if (sample_rate_hz == 0) {
         return HAL_ERROR_INVALID_PARAM;
     }
 
-    /* TODO: Implement Bluetooth reception
-     * This would involve:
-     * 1. Listen for BLE packets
-     * 2. Filter and decode packets
-     * 3. Extract payload data
-     */
+    hal_radio_instance_t *instance = find_radio_instance(radio_id);
+    if (instance == NULL) {
+        return HAL_ERROR_RESOURCE_NOT_FOUND;
+    }
 
-    instance->state = HAL_RADIO_STATE_RX;
-    /* Simulate reception timeout */
-    instance->state = HAL_RADIO_STATE_IDLE;
+    if (instance->type != HAL_RADIO_TYPE_CC1101) {
+        return HAL_ERROR_NOT_SUPPORTED;
+    }
 
-    return HAL_ERROR_TIMEOUT;
+    return cc1101_start_sampling(instance, sample_rate_hz);
 }
 
 /**
- * @brief Set radio state (hardware-agnostic)
+ * @brief Take the most recently filled half of the sample ring
  */
-static hal_result_t hal_radio_set_state(hal_radio_instance_t *instance, hal_radio_state_t state)
+hal_result_t hal_radio_sample_acquire(uint32_t radio_id, const int16_t **samples, uint32_t *count,
+                                      uint32_t *missed)
 {
-    if (instance == NULL) {
+    if (!radio_hal_initialized) {
+        return HAL_ERROR_NOT_INITIALIZED;
+    }
+
+    if (samples == NULL || count == NULL) {
         return HAL_ERROR_INVALID_PARAM;
     }
 
-    /* Apply state change using hardware-specific implementation */
-    switch (instance->type) {
-        case HAL_RADIO_TYPE_CC1101:
-            return cc1101_set_state(instance, state);
-        case HAL_RADIO_TYPE_BLUETOOTH:
-            return bluetooth_set_state(instance, state);
-        default:
-            return HAL_ERROR_NOT_SUPPORTED;
+    hal_radio_instance_t *instance = find_radio_instance(radio_id);
+    if (instance == NULL) {
+        return HAL_ERROR_RESOURCE_NOT_FOUND;
     }
+
+    return hal_radio_sampler_take(instance, samples, count, missed);
 }
 
 /**
- * @brief Set CC1101 radio state
+ * @brief Set, replace or remove a BLE advertising set
  */
-static hal_result_t cc1101_set_state(hal_radio_instance_t *instance, hal_radio_state_t state)
+hal_result_t hal_radio_set_adv_set(uint32_t radio_id, uint8_t index, const hal_radio_adv_set_t *set)
 {
-    if (instance == NULL) {
+    if (!radio_hal_initialized) {
+        return HAL_ERROR_NOT_INITIALIZED;
+    }
+
+    if (index >= HAL_RADIO_ADV_SETS) {
         return HAL_ERROR_INVALID_PARAM;
     }
 
-    /* TODO: Send appropriate command strobe to CC1101
-     * SIDLE for idle, SRX for receive, STX for transmit, SPWD for sleep
-     */
+    hal_radio_instance_t *instance = find_radio_instance(radio_id);
+    if (instance == NULL) {
+        return HAL_ERROR_RESOURCE_NOT_FOUND;
+    }
 
-    instance->state = state;
-    return HAL_OK;
+    if (instance->type != HAL_RADIO_TYPE_BLUETOOTH) {
+        return HAL_ERROR_NOT_SUPPORTED;
+    }
+
+    return bluetooth_set_adv_set(instance, index, set);
 }
 
 /**
- * @brief Set Bluetooth radio state
+ * @brief Start advertising the configured sets
  */
-static hal_result_t bluetooth_set_state(hal_radio_instance_t *instance, hal_radio_state_t state)
+hal_result_t hal_radio_start_advertising(uint32_t radio_id)
 {
+    if (!radio_hal_initialized) {
+        return HAL_ERROR_NOT_INITIALIZED;
+    }
+
+    hal_radio_instance_t *instance = find_radio_instance(radio_id);
     if (instance == NULL) {
-        return HAL_ERROR_INVALID_PARAM;
+        return HAL_ERROR_RESOURCE_NOT_FOUND;
     }
 
-    /* TODO: Configure Bluetooth controller state */
+    if (instance->type != HAL_RADIO_TYPE_BLUETOOTH) {
+        return HAL_ERROR_NOT_SUPPORTED;
+    }
 
-    instance->state = state;
-    return HAL_OK;
+    return bluetooth_start_advertising(instance);
 }
 
-/* Driver implementation */
+/**
+ * @brief Stop advertising
+ */
+hal_result_t hal_radio_stop_advertising(uint32_t radio_id)
+{
+    if (!radio_hal_initialized) {
+        return HAL_ERROR_NOT_INITIALIZED;
+    }
+
+    hal_radio_instance_t *instance = find_radio_instance(radio_id);
+    if (instance == NULL) {
+        return HAL_ERROR_RESOURCE_NOT_FOUND;
+    }
+
+    if (instance->type != HAL_RADIO_TYPE_BLUETOOTH) {
+        return HAL_ERROR_NOT_SUPPORTED;
+    }
+
+    return bluetooth_stop_advertising(instance);
+}
 
 /**
- * @brief Radio driver initialization
+ * @brief Start scanning for advertisers
  */
-static hal_result_t radio_driver_init(hal_device_t *device)
+hal_result_t hal_radio_start_scan(uint32_t radio_id, const hal_radio_scan_config_t *config)
 {
-    if (device == NULL) {
+    if (!radio_hal_initialized) {
+        return HAL_ERROR_NOT_INITIALIZED;
+    }
+
+    if (config == NULL || config->callback == NULL) {
         return HAL_ERROR_INVALID_PARAM;
     }
 
-    /* TODO: Initialize radio hardware clocks and power */
+    hal_radio_instance_t *instance = find_radio_instance(radio_id);
+    if (instance == NULL) {
+        return HAL_ERROR_RESOURCE_NOT_FOUND;
+    }
 
-    return HAL_OK;
+    if (instance->type != HAL_RADIO_TYPE_BLUETOOTH) {
+        return HAL_ERROR_NOT_SUPPORTED;
+    }
+
+    return bluetooth_start_scan(instance, config);
 }
 
 /**
- * @brief Radio driver deinitialization
+ * @brief Stop scanning
  */
-static hal_result_t radio_driver_deinit(hal_device_t *device)
+hal_result_t hal_radio_stop_scan(uint32_t radio_id)
 {
-    if (device == NULL) {
+    if (!radio_hal_initialized) {
+        return HAL_ERROR_NOT_INITIALIZED;
+    }
+
+    hal_radio_instance_t *instance = find_radio_instance(radio_id);
+    if (instance == NULL) {
+        return HAL_ERROR_RESOURCE_NOT_FOUND;
+    }
+
+    if (instance->type != HAL_RADIO_TYPE_BLUETOOTH) {
+        return HAL_ERROR_NOT_SUPPORTED;
+    }
+
+    return bluetooth_stop_scan(instance);
+}
+
+/**
+ * @brief Get BLE controller counters
+ */
+hal_result_t hal_radio_bluetooth_get_stats(uint32_t radio_id, hal_radio_bluetooth_stats_t *stats)
+{
+    if (!radio_hal_initialized) {
+        return HAL_ERROR_NOT_INITIALIZED;
+    }
+
+    if (stats == NULL) {
         return HAL_ERROR_INVALID_PARAM;
     }
 
-    /* TODO: Disable radio hardware clocks and power */
+    hal_radio_instance_t *instance = find_radio_instance(radio_id);
+    if (instance == NULL) {
+        return HAL_ERROR_RESOURCE_NOT_FOUND;
+    }
 
-    return HAL_OK;
-}/* Additi
-onal Radio HAL functions */
+    if (instance->type != HAL_RADIO_TYPE_BLUETOOTH) {
+        return HAL_ERROR_NOT_SUPPORTED;
+    }
+
+    return bluetooth_get_stats(instance, stats);
+}
 
 /**
- * @brief Set radio modulation
+ * @brief Open an L2CAP LE credit based channel
  */
-hal_result_t hal_radio_set_modulation(uint32_t radio_id, hal_radio_modulation_t modulation)
+hal_result_t hal_radio_l2cap_open(uint32_t radio_id, const hal_radio_l2cap_config_t *config, bool listen,
+                                  hal_radio_channel_t *channel)
 {
     if (!radio_hal_initialized) {
         return HAL_ERROR_NOT_INITIALIZED;
     }
 
-    if (modulation >= HAL_RADIO_MODULATION_MAX) {
+    if (config == NULL || channel == NULL || config->rx_buffer == NULL || config->callback == NULL) {
         return HAL_ERROR_INVALID_PARAM;
     }
 
@@ -1020,23 +1265,40 @@ hal_result_t hal_radio_set_modulation(uint32_t radio_id, hal_radio_modulation_t
         return HAL_ERROR_RESOURCE_NOT_FOUND;
     }
 
-    instance->config.modulation = modulation;
+    if (instance->type != HAL_RADIO_TYPE_BLUETOOTH) {
+        return HAL_ERROR_NOT_SUPPORTED;
+    }
 
-    /* Apply modulation change to hardware */
-    hal_radio_config_t config = instance->config;
-    return hal_radio_configure(radio_id, &config);
+    return hal_radio_l2cap_attach(instance, config, listen, channel);
 }
 
 /**
- * @brief Start continuous transmission
+ * @brief Calibrate radio
  */
-hal_result_t hal_radio_start_tx_continuous(uint32_t radio_id, const uint8_t *data, uint16_t length)
+hal_result_t hal_radio_calibrate(uint32_t radio_id)
 {
     if (!radio_hal_initialized) {
         return HAL_ERROR_NOT_INITIALIZED;
     }
 
-    if (data == NULL || length == 0) {
+    hal_radio_instance_t *instance = find_radio_instance(radio_id);
+    if (instance == NULL) {
+        return HAL_ERROR_RESOURCE_NOT_FOUND;
+    }
+
+    return hal_radio_set_state(instance, HAL_RADIO_STATE_CALIBRATE);
+}
+
+/**
+ * @brief Set the channel plan and calibrate its channels
+ */
+hal_result_t hal_radio_set_scan_plan(uint32_t radio_id, const hal_radio_scan_plan_t *plan)
+{
+    if (!radio_hal_initialized) {
+        return HAL_ERROR_NOT_INITIALIZED;
+    }
+
+    if (plan == NULL || plan->channel_count == 0 || plan->channel_count > HAL_RADIO_CHANNELS) {
         return HAL_ERROR_INVALID_PARAM;
     }
 
@@ -1045,16 +1307,17 @@ hal_result_t hal_radio_start_tx_continuous(uint32_t radio_id, const uint8_t *dat
         return HAL_ERROR_RESOURCE_NOT_FOUND;
     }
 
-    /* TODO: Implement continuous transmission mode */
-    instance->state = HAL_RADIO_STATE_TX;
+    if (instance->type != HAL_RADIO_TYPE_CC1101) {
+        return HAL_ERROR_NOT_SUPPORTED;
+    }
 
-    return HAL_OK;
+    return cc1101_set_scan_plan(instance, plan);
 }
 
 /**
- * @brief Start continuous reception
+ * @brief Retune to a plan channel
  */
-hal_result_t hal_radio_start_rx_continuous(uint32_t radio_id)
+hal_result_t hal_radio_hop(uint32_t radio_id, uint16_t channel)
 {
     if (!radio_hal_initialized) {
         return HAL_ERROR_NOT_INITIALIZED;
@@ -1065,50 +1328,67 @@ hal_result_t hal_radio_start_rx_continuous(uint32_t radio_id)
         return HAL_ERROR_RESOURCE_NOT_FOUND;
     }
 
-    /* TODO: Implement continuous reception mode */
-    instance->state = HAL_RADIO_STATE_RX;
+    if (instance->type != HAL_RADIO_TYPE_CC1101) {
+        return HAL_ERROR_NOT_SUPPORTED;
+    }
 
-    return HAL_OK;
+    return cc1101_hop(instance, channel);
 }
 
 /**
- * @brief Stop continuous operation
+ * @brief Read the current RSSI
  */
-hal_result_t hal_radio_stop_continuous(uint32_t radio_id)
+hal_result_t hal_radio_get_rssi(uint32_t radio_id, int8_t *rssi_dbm)
 {
     if (!radio_hal_initialized) {
         return HAL_ERROR_NOT_INITIALIZED;
     }
 
+    if (rssi_dbm == NULL) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
     hal_radio_instance_t *instance = find_radio_instance(radio_id);
     if (instance == NULL) {
         return HAL_ERROR_RESOURCE_NOT_FOUND;
     }
 
-    /* Stop continuous operation and return to idle */
-    return hal_radio_set_idle(radio_id);
+    if (instance->type != HAL_RADIO_TYPE_CC1101) {
+        return HAL_ERROR_NOT_SUPPORTED;
+    }
+
+    hal_result_t result = cc1101_get_rssi(instance, rssi_dbm);
+    if (result == HAL_OK) {
+        instance->stats.last_rssi = *rssi_dbm;
+    }
+
+    return result;
 }
 
 /**
- * @brief Calibrate radio
+ * @brief Sweep the channel plan
  */
-hal_result_t hal_radio_calibrate(uint32_t radio_id)
+hal_result_t hal_radio_sweep(uint32_t radio_id, hal_radio_sweep_point_t *points, uint16_t max_points,
+                             uint16_t *count)
 {
     if (!radio_hal_initialized) {
         return HAL_ERROR_NOT_INITIALIZED;
     }
 
+    if (points == NULL || count == NULL || max_points == 0) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
     hal_radio_instance_t *instance = find_radio_instance(radio_id);
     if (instance == NULL) {
         return HAL_ERROR_RESOURCE_NOT_FOUND;
     }
 
-    /* TODO: Perform radio calibration */
-    instance->state = HAL_RADIO_STATE_CALIBRATE;
-    /* Simulate calibration time */
-    instance->state = HAL_RADIO_STATE_IDLE;
+    if (instance->type != HAL_RADIO_TYPE_CC1101) {
+        return HAL_ERROR_NOT_SUPPORTED;
+    }
 
-    return HAL_OK;
+    return cc1101_sweep(instance, points, max_points, count);
 }
 
 /**
@@ -1149,12 +1429,9 @@ hal_result_t hal_radio_read_register(uint32_t radio_id, uint8_t reg_addr, uint8_
         return HAL_ERROR_RESOURCE_NOT_FOUND;
     }
 
-    /* TODO: Implement hardware-specific register read */
     switch (instance->type) {
         case HAL_RADIO_TYPE_CC1101:
-            /* TODO: Read CC1101 register via SPI */
-            *value = 0x00;  /* Placeholder */
-            break;
+            return cc1101_read_register(instance, reg_addr, value);
         case HAL_RADIO_TYPE_BLUETOOTH:
             /* TODO: Read Bluetooth controller register */
             *value = 0x00;  /* Placeholder */
@@ -1180,11 +1457,9 @@ hal_result_t hal_radio_write_register(uint32_t radio_id, uint8_t reg_addr, uint8
         return HAL_ERROR_RESOURCE_NOT_FOUND;
     }
 
-    /* TODO: Implement hardware-specific register write */
     switch (instance->type) {
         case HAL_RADIO_TYPE_CC1101:
-            /* TODO: Write CC1101 register via SPI */
-            break;
+            return cc1101_write_register(instance, reg_addr, value);
         case HAL_RADIO_TYPE_BLUETOOTH:
             /* TODO: Write Bluetooth controller register */
             break;
@@ -1193,4 +1468,4 @@ hal_result_t hal_radio_write_register(uint32_t radio_id, uint8_t reg_addr, uint8
     }
 
     return HAL_OK;
-}
\ No newline at end of file
+}
@@ -0,0 +1,471 @@
+/**
+ * @file hal_radio_arbiter.c
+ * @brief Time-multiplexing of one radio between several clients
+ *
+ * Each client keeps its own radio context: configuration, event callback
+ * and the driver's register shadow. A switch idles the radio, saves the
+ * outgoing client's context and restores the incoming one; since the
+ * driver only writes registers that differ from its shadow, clients with
+ * similar settings switch in a few SPI bytes.
+ *
+ * Who owns the radio:
+ * - a client whose reserved slot has come due (slot_ms every period_ms),
+ *   whatever its priority, for the length of the slot;
+ * - otherwise the highest priority client that wants the radio, the
+ *   current owner winning ties.
+ * A transmission in progress is never cut; the switch waits for the next
+ * scheduling pass.
+ *
+ * Slot starts and ends are kept by a deadline timer channel armed at the
+ * next boundary. Its interrupt only flags the boundary; the switch itself
+ * talks to the radio and calls clients back, so the radio task runs it.
+ *
+ * Bluetooth clients keep configuration and callback only; the controller
+ * holds no per-client registers. Taking the radio from one stops its
+ * advertising and scanning, which it starts again on its next grant.
+ */
+
+#include "hal_radio_internal.h"
+#include <string.h>
+
+#define ARBITER_TIMER_CHANNEL       1       /* Deadline timer channel (the CC1101 driver has 0) */
+#define ARBITER_RETRY_US            1000    /* Boundary already passed: look again this much later */
+
+/**
+ * @brief Arbiter client
+ */
+typedef struct {
+    hal_radio_client_t handle;              /**< HAL_RADIO_CLIENT_NONE if the slot is free */
+    hal_radio_instance_t *instance;         /**< Shared radio */
+    hal_radio_client_config_t config;
+    hal_radio_context_t context;            /**< Radio context while not the owner */
+    hal_radio_client_stats_t stats;
+    volatile bool wanting;                  /**< Between request and release */
+    bool owner;                             /**< Holds the radio */
+    bool in_slot;                           /**< Owner for a reserved slot */
+    uint32_t slot_end_us;                   /**< End of the reserved slot */
+    uint32_t next_due_us;                   /**< Start of the next reserved slot */
+    uint32_t granted_us;                    /**< Time of the last grant */
+} arbiter_client_t;
+
+/* Arbiter state */
+static arbiter_client_t arbiter_clients[HAL_RADIO_ARBITER_CLIENTS];
+static hal_radio_client_t arbiter_next_handle = 1;
+static bool arbiter_running;                /* A scheduling pass is in progress */
+static volatile bool arbiter_due;           /* A slot boundary passed; the radio task runs a pass */
+
+/* Static function prototypes */
+static arbiter_client_t *arbiter_find(hal_radio_client_t handle);
+static arbiter_client_t *arbiter_owner(const hal_radio_instance_t *instance);
+static void arbiter_schedule(hal_radio_instance_t *instance);
+static arbiter_client_t *arbiter_choose(hal_radio_instance_t *instance, arbiter_client_t *owner, uint32_t now_us,
+                                        bool *slot);
+static void arbiter_switch(hal_radio_instance_t *instance, arbiter_client_t *from, arbiter_client_t *to,
+                           uint32_t now_us);
+static void arbiter_save(hal_radio_instance_t *instance, hal_radio_context_t *context);
+static void arbiter_restore(hal_radio_instance_t *instance, const hal_radio_context_t *context);
+static bool arbiter_reached(uint32_t now_us, uint32_t at_us);
+static void arbiter_arm(void);
+static void arbiter_timer_isr(void *user_data);
+
+/**
+ * @brief Add a client to a radio
+ *
+ * The client starts from the radio's current context.
+ */
+hal_result_t hal_radio_arbiter_attach(hal_radio_instance_t *instance, const hal_radio_client_config_t *config,
+                                      hal_radio_client_t *client)
+{
+    if (config->period_ms != 0 && (config->slot_ms == 0 || config->slot_ms > config->period_ms)) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    /* Reservations may only take part of the radio's time */
+    uint32_t reserved = (config->period_ms != 0) ? config->slot_ms * 100U / config->period_ms : 0;
+    arbiter_client_t *free_slot = NULL;
+    for (uint32_t i = 0; i < HAL_RADIO_ARBITER_CLIENTS; i++) {
+        arbiter_client_t *other = &arbiter_clients[i];
+        if (other->handle == HAL_RADIO_CLIENT_NONE) {
+            free_slot = free_slot ? free_slot : other;
+        } else if (other->instance == instance && other->config.period_ms != 0) {
+            reserved += other->config.slot_ms * 100U / other->config.period_ms;
+        }
+    }
+    if (reserved > HAL_RADIO_ARBITER_RESERVE_PERCENT) {
+        return HAL_ERROR_RESOURCE_BUSY;
+    }
+    if (free_slot == NULL) {
+        return HAL_ERROR_NO_MEMORY;
+    }
+
+    memset(free_slot, 0, sizeof(*free_slot));
+    free_slot->instance = instance;
+    free_slot->config = *config;
+    arbiter_save(instance, &free_slot->context);
+    free_slot->context.callback = config->callback;
+    free_slot->context.callback_user_data = config->user_data;
+    free_slot->next_due_us = hal_radio_timer_now();
+
+    free_slot->handle = arbiter_next_handle++;
+    if (arbiter_next_handle == HAL_RADIO_CLIENT_NONE) {
+        arbiter_next_handle = 1;
+    }
+
+    *client = free_slot->handle;
+    return HAL_OK;
+}
+
+/**
+ * @brief Drop every client of a radio that is being closed
+ */
+void hal_radio_arbiter_detach(hal_radio_instance_t *instance)
+{
+    for (uint32_t i = 0; i < HAL_RADIO_ARBITER_CLIENTS; i++) {
+        if (arbiter_clients[i].instance == instance) {
+            memset(&arbiter_clients[i], 0, sizeof(arbiter_clients[i]));
+        }
+    }
+    arbiter_arm();
+}
+
+/**
+ * @brief Run a scheduling pass if a slot boundary has passed; radio task only
+ */
+void hal_radio_arbiter_service(void)
+{
+    if (arbiter_due) {
+        arbiter_due = false;
+        hal_radio_arbiter_poll();
+    }
+}
+
+hal_result_t hal_radio_arbiter_unregister(hal_radio_client_t client)
+{
+    arbiter_client_t *entry = arbiter_find(client);
+    if (entry == NULL) {
+        return HAL_ERROR_RESOURCE_NOT_FOUND;
+    }
+
+    entry->wanting = false;
+    arbiter_schedule(entry->instance);
+
+    /* Still the owner if a pass was already running; hand the radio back without a context */
+    if (entry->owner) {
+        hal_radio_set_idle(entry->instance->radio_id);
+        entry->instance->callback = NULL;
+        entry->instance->callback_user_data = NULL;
+    }
+
+    memset(entry, 0, sizeof(*entry));
+    arbiter_arm();
+    return HAL_OK;
+}
+
+hal_result_t hal_radio_arbiter_request(hal_radio_client_t client)
+{
+    arbiter_client_t *entry = arbiter_find(client);
+    if (entry == NULL) {
+        return HAL_ERROR_RESOURCE_NOT_FOUND;
+    }
+
+    entry->wanting = true;
+    arbiter_schedule(entry->instance);
+    return HAL_OK;
+}
+
+hal_result_t hal_radio_arbiter_release(hal_radio_client_t client)
+{
+    arbiter_client_t *entry = arbiter_find(client);
+    if (entry == NULL) {
+        return HAL_ERROR_RESOURCE_NOT_FOUND;
+    }
+
+    entry->wanting = false;
+    arbiter_schedule(entry->instance);
+    return HAL_OK;
+}
+
+bool hal_radio_arbiter_is_owner(hal_radio_client_t client)
+{
+    arbiter_client_t *entry = arbiter_find(client);
+    return entry != NULL && entry->owner;
+}
+
+void hal_radio_arbiter_poll(void)
+{
+    for (uint32_t i = 0; i < HAL_RADIO_ARBITER_CLIENTS; i++) {
+        hal_radio_instance_t *instance = arbiter_clients[i].instance;
+        bool first = true;
+
+        /* One pass per radio, from its first client */
+        for (uint32_t j = 0; j < i && first; j++) {
+            first = (arbiter_clients[j].instance != instance);
+        }
+        if (instance != NULL && first) {
+            arbiter_schedule(instance);
+        }
+    }
+}
+
+hal_result_t hal_radio_arbiter_get_stats(hal_radio_client_t client, hal_radio_client_stats_t *stats)
+{
+    if (stats == NULL) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    arbiter_client_t *entry = arbiter_find(client);
+    if (entry == NULL) {
+        return HAL_ERROR_RESOURCE_NOT_FOUND;
+    }
+
+    *stats = entry->stats;
+    if (entry->owner) {
+        stats->held_us += hal_radio_timer_now() - entry->granted_us;
+    }
+    return HAL_OK;
+}
+
+/* Static helper functions */
+
+static arbiter_client_t *arbiter_find(hal_radio_client_t handle)
+{
+    if (handle == HAL_RADIO_CLIENT_NONE) {
+        return NULL;
+    }
+
+    for (uint32_t i = 0; i < HAL_RADIO_ARBITER_CLIENTS; i++) {
+        if (arbiter_clients[i].handle == handle) {
+            return &arbiter_clients[i];
+        }
+    }
+    return NULL;
+}
+
+static arbiter_client_t *arbiter_owner(const hal_radio_instance_t *instance)
+{
+    for (uint32_t i = 0; i < HAL_RADIO_ARBITER_CLIENTS; i++) {
+        if (arbiter_clients[i].owner && arbiter_clients[i].instance == instance) {
+            return &arbiter_clients[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Hand the radio to whoever should have it now
+ *
+ * Thread context only. Passes do not nest: a pass started while another
+ * runs is skipped, and the next request, release or poll catches up.
+ */
+static void arbiter_schedule(hal_radio_instance_t *instance)
+{
+    uint32_t primask = hal_radio_lock();
+    bool busy = arbiter_running;
+    arbiter_running = true;
+    hal_radio_unlock(primask);
+
+    if (busy) {
+        /* Whatever this pass was for, the radio task catches up */
+        arbiter_due = true;
+        return;
+    }
+
+    uint32_t now_us = hal_radio_timer_now();
+    arbiter_client_t *owner = arbiter_owner(instance);
+
+    if (owner != NULL && owner->in_slot && arbiter_reached(now_us, owner->slot_end_us)) {
+        owner->in_slot = false;
+    }
+
+    bool slot = false;
+    arbiter_client_t *next = arbiter_choose(instance, owner, now_us, &slot);
+
+    /* Let a transmission finish rather than cut it */
+    if (next == owner || instance->state != HAL_RADIO_STATE_TX) {
+        if (next != owner) {
+            arbiter_switch(instance, owner, next, now_us);
+        }
+
+        if (slot) {
+            next->in_slot = true;
+            next->slot_end_us = now_us + next->config.slot_ms * 1000U;
+            next->next_due_us += next->config.period_ms * 1000U;
+            if (arbiter_reached(now_us, next->next_due_us)) {
+                /* Slot came a whole period late: start the grid over from now */
+                next->next_due_us = now_us + next->config.period_ms * 1000U;
+                next->stats.slots_late++;
+            }
+            next->stats.slots++;
+        }
+    }
+
+    arbiter_arm();
+    arbiter_running = false;
+}
+
+/**
+ * @brief Pick the client that should own the radio
+ * @param slot Set if the chosen client starts a reserved slot
+ * @return The client, NULL if nobody wants the radio
+ */
+static arbiter_client_t *arbiter_choose(hal_radio_instance_t *instance, arbiter_client_t *owner, uint32_t now_us,
+                                        bool *slot)
+{
+    /* A reserved slot runs to its end */
+    if (owner != NULL && owner->in_slot && owner->wanting) {
+        return owner;
+    }
+
+    arbiter_client_t *due = NULL;
+    arbiter_client_t *best = (owner != NULL && owner->wanting) ? owner : NULL;
+
+    for (uint32_t i = 0; i < HAL_RADIO_ARBITER_CLIENTS; i++) {
+        arbiter_client_t *client = &arbiter_clients[i];
+        if (client->instance != instance || !client->wanting) {
+            continue;
+        }
+
+        if (client->config.period_ms != 0 && arbiter_reached(now_us, client->next_due_us) &&
+            (due == NULL || (int32_t)(client->next_due_us - due->next_due_us) < 0)) {
+            due = client;
+        }
+
+        /* The owner keeps the radio against equal priorities; otherwise the longest waiting goes first */
+        if (best == NULL || client->config.priority > best->config.priority ||
+            (client->config.priority == best->config.priority && best != owner &&
+             (int32_t)(client->granted_us - best->granted_us) < 0)) {
+            best = client;
+        }
+    }
+
+    if (due != NULL) {
+        *slot = true;
+        return due;
+    }
+    return best;
+}
+
+/**
+ * @brief Move the radio from one client to another
+ *
+ * Either side may be NULL: nobody held the radio, or nobody wants it.
+ */
+static void arbiter_switch(hal_radio_instance_t *instance, arbiter_client_t *from, arbiter_client_t *to,
+                           uint32_t now_us)
+{
+    uint32_t start_us = hal_radio_timer_now();
+
+    if (from != NULL) {
+        /* Idled first, so REVOKED is the last event the client sees for this turn */
+        hal_radio_set_idle(instance->radio_id);
+        hal_radio_notify(instance, HAL_RADIO_EVENT_REVOKED, &from->handle);
+        arbiter_save(instance, &from->context);
+
+        from->owner = false;
+        from->in_slot = false;
+        from->stats.held_us += now_us - from->granted_us;
+        if (from->wanting) {
+            from->stats.preemptions++;
+        }
+    }
+
+    if (to != NULL) {
+        if (from == NULL) {
+            hal_radio_set_idle(instance->radio_id);
+        }
+        arbiter_restore(instance, &to->context);
+
+        to->owner = true;
+        to->granted_us = now_us;
+        to->stats.grants++;
+        to->stats.switch_us_last = hal_radio_timer_now() - start_us;
+        if (to->stats.switch_us_last > to->stats.switch_us_max) {
+            to->stats.switch_us_max = to->stats.switch_us_last;
+        }
+        hal_radio_notify(instance, HAL_RADIO_EVENT_GRANTED, &to->handle);
+    } else {
+        /* Nobody holds the radio: events must not reach the client that left */
+        instance->callback = NULL;
+        instance->callback_user_data = NULL;
+    }
+}
+
+static void arbiter_save(hal_radio_instance_t *instance, hal_radio_context_t *context)
+{
+    context->config = instance->config;
+    context->callback = instance->callback;
+    context->callback_user_data = instance->callback_user_data;
+
+    if (instance->type == HAL_RADIO_TYPE_CC1101) {
+        cc1101_save_context(instance, context);
+    }
+}
+
+static void arbiter_restore(hal_radio_instance_t *instance, const hal_radio_context_t *context)
+{
+    instance->config = context->config;
+    instance->callback = context->callback;
+    instance->callback_user_data = context->callback_user_data;
+
+    if (instance->type == HAL_RADIO_TYPE_CC1101) {
+        cc1101_restore_context(instance, context);
+    }
+}
+
+/**
+ * @brief Whether a time has been reached, wrap-safe
+ */
+static bool arbiter_reached(uint32_t now_us, uint32_t at_us)
+{
+    return (int32_t)(now_us - at_us) >= 0;
+}
+
+/**
+ * @brief Arm the deadline timer for the next slot start or end on any radio
+ */
+static void arbiter_arm(void)
+{
+    uint32_t now_us = hal_radio_timer_now();
+    bool armed = false;
+    uint32_t at_us = 0;
+
+    for (uint32_t i = 0; i < HAL_RADIO_ARBITER_CLIENTS; i++) {
+        const arbiter_client_t *client = &arbiter_clients[i];
+        uint32_t boundary_us;
+
+        if (client->handle == HAL_RADIO_CLIENT_NONE) {
+            continue;
+        }
+        if (client->owner && client->in_slot) {
+            boundary_us = client->slot_end_us;
+        } else if (client->wanting && client->config.period_ms != 0) {
+            boundary_us = client->next_due_us;
+        } else {
+            continue;
+        }
+
+        /* Passed but not acted on (a transmission was running): look again shortly */
+        if (arbiter_reached(now_us, boundary_us)) {
+            boundary_us = now_us + ARBITER_RETRY_US;
+        }
+        if (!armed || (int32_t)(boundary_us - at_us) < 0) {
+            at_us = boundary_us;
+            armed = true;
+        }
+    }
+
+    if (armed) {
+        hal_radio_timer_arm(ARBITER_TIMER_CHANNEL, at_us, arbiter_timer_isr, NULL);
+    } else {
+        hal_radio_timer_cancel(ARBITER_TIMER_CHANNEL);
+    }
+}
+
+/**
+ * @brief Slot boundary reached: leave the switch to the radio task
+ */
+static void arbiter_timer_isr(void *user_data)
+{
+    (void)user_data;
+    arbiter_due = true;
+}
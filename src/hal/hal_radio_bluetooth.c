@@ -0,0 +1,1312 @@
+/**
+ * @file hal_radio_bluetooth.c
+ * @brief Bluetooth LE driver for the controller on CPU2
+ *
+ * The controller is driven over HCI through the mailbox (hal_ipcc.h).
+ * Commands wait in a short queue and go out as the controller hands out
+ * command credits (Num_HCI_Command_Packets in Command Complete and Command
+ * Status); events are handled in hal_radio_bluetooth_poll(), in the
+ * batches the mailbox delivers.
+ *
+ * Advertising uses the legacy HCI commands, which drive a single
+ * advertiser. Several sets share it by taking turns: a turn disables
+ * advertising, loads the next set's parameters and data and enables it
+ * again, five queued commands in all.
+ *
+ * Connections get the LE Data Length Extension (251-byte link packets)
+ * and the LE 2M PHY requested as soon as they are up; ACL data is sent
+ * within the controller's buffer count, returned by Number Of Completed
+ * Packets, and handed to the L2CAP layer on receipt
+ * (hal_radio_l2cap.c).
+ *
+ * Scanning leaves the controller's duplicate filter off (its table size is
+ * unknown and it hides data changes) and filters here instead. Devices are
+ * kept in a fixed table, hashed on address into buckets and ordered by
+ * when they were last heard; each remembers a hash of its advertising and
+ * scan response data. Reports that pass the RSSI threshold and are new or
+ * changed are copied into a batch, handed to the scan callback when full
+ * or when the batch timeout runs out. Nothing is allocated while scanning.
+ */
+
+#include "hal_radio_internal.h"
+#include "hal_ipcc.h"
+#include "kernel/scheduler.h"
+#include <string.h>
+#include <stdlib.h>
+
+/* HCI command opcodes (OGF << 10 | OCF) */
+#define HCI_OP_SET_EVENT_MASK               0x0C01
+#define HCI_OP_RESET                        0x0C03
+#define HCI_OP_LE_SET_EVENT_MASK            0x2001
+#define HCI_OP_LE_READ_BUFFER_SIZE          0x2002
+#define HCI_OP_LE_SET_ADV_PARAMETERS        0x2006
+#define HCI_OP_LE_SET_ADV_DATA              0x2008
+#define HCI_OP_LE_SET_SCAN_RESPONSE_DATA    0x2009
+#define HCI_OP_LE_SET_ADV_ENABLE            0x200A
+#define HCI_OP_LE_SET_SCAN_PARAMETERS       0x200B
+#define HCI_OP_LE_SET_SCAN_ENABLE           0x200C
+#define HCI_OP_LE_SET_DATA_LENGTH           0x2022
+#define HCI_OP_LE_WRITE_DEFAULT_DATA_LENGTH 0x2024
+#define HCI_OP_LE_SET_PHY                   0x2032
+
+/* HCI event codes */
+#define HCI_EV_DISCONNECTION_COMPLETE       0x05
+#define HCI_EV_COMMAND_COMPLETE             0x0E
+#define HCI_EV_COMMAND_STATUS               0x0F
+#define HCI_EV_NUMBER_OF_COMPLETED_PACKETS  0x13
+#define HCI_EV_LE_META                      0x3E
+
+/* LE meta subevents */
+#define HCI_LE_CONNECTION_COMPLETE          0x01
+#define HCI_LE_ADVERTISING_REPORT           0x02
+#define HCI_LE_DATA_LENGTH_CHANGE           0x07
+#define HCI_LE_ENHANCED_CONNECTION_COMPLETE 0x0A
+#define HCI_LE_PHY_UPDATE_COMPLETE          0x0C
+
+/* Events enabled: the specification's default set plus LE Meta (bit 61),
+ * without which no LE event is delivered whatever the LE event mask says */
+#define HCI_EVENT_MASK                      0x20001FFFFFFFFFFFULL
+
+/* LE events enabled: connection complete, advertising report, connection
+ * update, remote features, LTK request, data length change, PHY update */
+#define HCI_LE_EVENT_MASK                   0x085FU
+
+/* HCI packet layout */
+#define HCI_COMMAND_HEADER_SIZE     3       /* Opcode, parameter length */
+#define HCI_EVENT_HEADER_SIZE       2       /* Event code, parameter length */
+#define HCI_COMMAND_PARAMS_MAX      32      /* Longest parameter block sent (advertising data) */
+#define HCI_ADV_REPORT_MIN_SIZE     10      /* Report with no data: type, address type, address, length, RSSI */
+#define HCI_ADV_SCAN_RSP            0x04    /* Advertising report event type of a scan response */
+#define HCI_RSSI_UNAVAILABLE        127
+#define HCI_ROLE_PERIPHERAL         0x01
+#define HCI_STATUS_DISALLOWED       0x0C    /* Command Disallowed */
+
+/* HCI ACL header: handle with packet boundary flags, then data length */
+#define BLE_ACL_HEADER_SIZE         4
+#define BLE_ACL_PB_FIRST            0x0000  /* First non-automatically-flushable fragment */
+#define BLE_ACL_PB_CONTINUE         0x1000  /* Continuing fragment */
+#define BLE_HANDLE_MASK             0x0FFF
+#define BLE_HANDLE_INVALID          0xFFFF
+
+/* Link layer packet limits and PHYs */
+#define BLE_LINK_OCTETS_MIN         27
+#define BLE_LINK_OCTETS_MAX         251
+#define BLE_LINK_TIME_MAX           2120    /* us for 251 octets on LE 1M */
+#define BLE_PHY_1M                  1
+#define BLE_PHY_PREFER_2M           0x02
+
+/* Pending HCI commands (power of two) */
+#define BLE_COMMAND_QUEUE           16
+#define BLE_ADV_TURN_COMMANDS       5       /* Disable, parameters, data, scan response, enable */
+#define BLE_SCAN_START_COMMANDS     3       /* Disable, parameters, enable */
+
+/* Advertising and scan timing limits, converted to 0.625 ms units */
+#define BLE_ADV_INTERVAL_MIN_MS     20
+#define BLE_ADV_INTERVAL_MAX_MS     10240
+#define BLE_SCAN_INTERVAL_MIN_MS    3
+#define BLE_SCAN_INTERVAL_MAX_MS    10240
+#define BLE_UNITS_625US(ms)         ((uint16_t)((ms) * 8U / 5U))
+#define BLE_ADV_RETRY_MS            100     /* Wait after the controller refuses to advertise */
+
+/* Duplicate filter */
+#define BLE_SCAN_NONE               0xFF    /* No device index */
+#define BLE_HASH_OFFSET             2166136261UL    /* FNV-1a */
+#define BLE_HASH_PRIME              16777619UL
+
+#if (HAL_RADIO_SCAN_DEVICES & (HAL_RADIO_SCAN_DEVICES - 1)) != 0 || HAL_RADIO_SCAN_DEVICES > 128
+#error "HAL_RADIO_SCAN_DEVICES must be a power of two, at most 128"
+#endif
+
+/**
+ * @brief Bluetooth hardware context
+ *
+ * Packets go straight into mailbox buffers, so there are no staging
+ * buffers here.
+ */
+typedef struct {
+    uint16_t connection_handle;             /**< BLE connection handle */
+} hal_radio_bluetooth_context_t;
+
+/**
+ * @brief Queued HCI command
+ */
+typedef struct {
+    uint16_t opcode;
+    uint8_t length;
+    uint8_t params[HCI_COMMAND_PARAMS_MAX];
+} ble_command_t;
+
+/**
+ * @brief Duplicate filter entry
+ *
+ * Data hashes and report times are kept separately for advertising data
+ * (kind 0) and scan responses (kind 1), which alternate from one device.
+ */
+typedef struct {
+    uint8_t address[6];
+    uint8_t address_type;
+    uint8_t bucket;                         /**< Hash bucket the device is chained in */
+    uint8_t bucket_next;                    /**< Next device in the bucket, or in the free list */
+    uint8_t lru_prev;                       /**< More recently heard device */
+    uint8_t lru_next;                       /**< Less recently heard device */
+    uint8_t known;                          /**< Bit per kind with a hash */
+    uint32_t hash[2];                       /**< Data hash per kind */
+    uint32_t reported_ms[2];                /**< Last report per kind */
+} ble_device_t;
+
+/* Driver state; the controller on CPU2 is the only Bluetooth radio */
+static hal_radio_instance_t *ble_instance;
+static hal_radio_bluetooth_stats_t ble_stats;
+static uint32_t ble_clock_us;               /* Timer reading the millisecond clock is at */
+static uint32_t ble_clock_ms;
+static bool ble_polling;                    /* hal_radio_bluetooth_poll() is running */
+
+/* HCI command queue */
+static ble_command_t ble_commands[BLE_COMMAND_QUEUE];
+static uint32_t ble_command_head;
+static uint32_t ble_command_tail;
+static uint8_t ble_credits;                 /* Commands the controller will take now */
+
+/* ACL data flow */
+static uint16_t ble_acl_length;             /* Controller ACL buffer size, 0 until read */
+static uint16_t ble_acl_total;              /* Controller ACL buffers */
+static uint16_t ble_acl_free;               /* Controller ACL buffers not holding our data */
+
+/* Advertising */
+static hal_radio_adv_set_t ble_adv_sets[HAL_RADIO_ADV_SETS];
+static bool ble_adv_used[HAL_RADIO_ADV_SETS];
+static bool ble_adv_running;                /* Between start and stop */
+static bool ble_adv_on_air;                 /* The controller is advertising ble_adv_current */
+static bool ble_adv_dirty;                  /* ble_adv_current changed while on air */
+static uint8_t ble_adv_current;
+static uint32_t ble_adv_turn_ms;            /* Start of the current turn */
+static bool ble_adv_refused;                /* Last enable refused; retry after BLE_ADV_RETRY_MS */
+static uint32_t ble_adv_refused_ms;
+
+/* Blocking receive: the next ACL packet on the connection is copied here too */
+static hal_radio_packet_t *ble_rx_packet;
+static uint16_t ble_rx_capacity;
+static bool ble_rx_done;
+static hal_result_t ble_rx_result;
+
+/* Scanning */
+static hal_radio_scan_config_t ble_scan_config;
+static bool ble_scan_running;
+static ble_device_t ble_scan_devices[HAL_RADIO_SCAN_DEVICES];
+static uint8_t ble_scan_buckets[HAL_RADIO_SCAN_DEVICES];
+static uint8_t ble_scan_free;
+static uint8_t ble_scan_lru_head;
+static uint8_t ble_scan_lru_tail;
+static hal_radio_scan_report_t ble_scan_batch[HAL_RADIO_SCAN_BATCH];
+static uint32_t ble_scan_batch_count;
+static uint32_t ble_scan_batch_ms;          /* Arrival of the batch's first report */
+
+/* Static function prototypes */
+static void ble_reset(void);
+static uint32_t ble_now_ms(void);
+static uint32_t ble_command_space(void);
+static hal_result_t ble_command(uint16_t opcode, const uint8_t *params, uint8_t length);
+static void ble_command_flush(void);
+static void ble_receive(hal_ipcc_buffer_t *const *buffers, uint32_t count, void *user_data);
+static void ble_event(const uint8_t *data, uint32_t length);
+static void ble_command_complete(const uint8_t *params, uint32_t length);
+static void ble_le_event(const uint8_t *params, uint32_t length);
+static void ble_link_up(uint16_t handle);
+static bool ble_connected(void);
+static void ble_raw_receive(const uint8_t *data, uint32_t length);
+static void ble_advertise(uint32_t now_ms);
+static hal_result_t ble_adv_enable(bool enable);
+static hal_result_t ble_adv_data(uint16_t opcode, const uint8_t *data, uint8_t length);
+static hal_result_t ble_scan_enable(bool enable);
+static void ble_scan_reports(const uint8_t *data, uint32_t length);
+static void ble_scan_report(uint8_t event_type, uint8_t address_type, const uint8_t *address,
+                            const uint8_t *data, uint8_t length, int8_t rssi_dbm);
+static ble_device_t *ble_scan_lookup(uint8_t address_type, const uint8_t *address);
+static void ble_scan_unlink(uint8_t index);
+static void ble_scan_push_front(uint8_t index);
+static void ble_scan_clear(void);
+static void ble_scan_deliver(void);
+static uint32_t ble_hash(uint32_t hash, const uint8_t *data, uint32_t length);
+
+/**
+ * @brief Initialize Bluetooth radio
+ */
+hal_result_t bluetooth_init(hal_radio_instance_t *instance)
+{
+    if (instance == NULL) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    if (ble_instance != NULL) {
+        return HAL_ERROR_RESOURCE_BUSY;
+    }
+
+    /* Allocate Bluetooth context */
+    hal_radio_bluetooth_context_t *ctx = malloc(sizeof(hal_radio_bluetooth_context_t));
+    if (ctx == NULL) {
+        return HAL_ERROR_NO_MEMORY;
+    }
+
+    memset(ctx, 0, sizeof(hal_radio_bluetooth_context_t));
+
+    /* The controller is reached through the mailbox to CPU2 */
+    hal_result_t result = hal_ipcc_init();
+    if (result != HAL_OK) {
+        free(ctx);
+        return result;
+    }
+
+    ctx->connection_handle = BLE_HANDLE_INVALID;
+
+    instance->hw_context = ctx;
+    ble_instance = instance;
+    ble_reset();
+    hal_ipcc_register_callback(ble_receive, NULL, NULL);
+
+    /* One command may be outstanding until the controller says otherwise */
+    static const uint8_t event_mask[8] = {
+        (uint8_t)HCI_EVENT_MASK, (uint8_t)(HCI_EVENT_MASK >> 8),
+        (uint8_t)(HCI_EVENT_MASK >> 16), (uint8_t)(HCI_EVENT_MASK >> 24),
+        (uint8_t)(HCI_EVENT_MASK >> 32), (uint8_t)(HCI_EVENT_MASK >> 40),
+        (uint8_t)(HCI_EVENT_MASK >> 48), (uint8_t)(HCI_EVENT_MASK >> 56)
+    };
+    static const uint8_t le_event_mask[8] = { (uint8_t)HCI_LE_EVENT_MASK, (uint8_t)(HCI_LE_EVENT_MASK >> 8) };
+    static const uint8_t data_length[4] = {
+        (uint8_t)BLE_LINK_OCTETS_MAX, (uint8_t)(BLE_LINK_OCTETS_MAX >> 8),
+        (uint8_t)BLE_LINK_TIME_MAX, (uint8_t)(BLE_LINK_TIME_MAX >> 8)
+    };
+    ble_credits = 1;
+    ble_command(HCI_OP_RESET, NULL, 0);
+    ble_command(HCI_OP_SET_EVENT_MASK, event_mask, sizeof(event_mask));
+    ble_command(HCI_OP_LE_SET_EVENT_MASK, le_event_mask, sizeof(le_event_mask));
+    ble_command(HCI_OP_LE_READ_BUFFER_SIZE, NULL, 0);
+    ble_command(HCI_OP_LE_WRITE_DEFAULT_DATA_LENGTH, data_length, sizeof(data_length));
+    ble_command_flush();
+    return HAL_OK;
+}
+
+/**
+ * @brief Deinitialize Bluetooth radio
+ */
+hal_result_t bluetooth_deinit(hal_radio_instance_t *instance)
+{
+    if (instance == NULL || instance->hw_context == NULL) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    /* Stopping the controller drops its advertising, scanning and links too */
+    hal_radio_l2cap_detach(instance);
+    hal_ipcc_register_callback(NULL, NULL, NULL);
+    hal_ipcc_deinit();
+    ble_reset();
+    ble_instance = NULL;
+
+    free(instance->hw_context);
+    instance->hw_context = NULL;
+    return HAL_OK;
+}
+
+/**
+ * @brief Configure Bluetooth radio
+ */
+hal_result_t bluetooth_configure(hal_radio_instance_t *instance, const hal_radio_config_t *config)
+{
+    if (instance == NULL || config == NULL || instance->hw_context == NULL) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    /*
+     * Nothing to send: the controller owns frequency, modulation and
+     * framing. Link data length and PHY are requested when a link comes
+     * up (ble_link_up), advertising and scanning take their parameters
+     * from their own calls, and the WiFi emulation framing rides on L2CAP.
+     */
+    return HAL_OK;
+}
+
+/**
+ * @brief Transmit packet using Bluetooth
+ */
+hal_result_t bluetooth_transmit(hal_radio_instance_t *instance, const hal_radio_packet_t *packet)
+{
+    if (instance == NULL || packet == NULL || instance->hw_context == NULL) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    hal_radio_bluetooth_context_t *ctx = instance->hw_context;
+
+    if (ctx->connection_handle == BLE_HANDLE_INVALID) {
+        return HAL_ERROR_NOT_INITIALIZED;
+    }
+
+    /* Built in place in the mailbox buffer, in one controller buffer */
+    uint8_t *payload;
+    uint16_t capacity;
+    hal_ipcc_buffer_t *buffer = bluetooth_acl_alloc(&payload, &capacity);
+    if (buffer == NULL) {
+        return HAL_ERROR_RESOURCE_BUSY;
+    }
+    if (packet->length > capacity) {
+        hal_ipcc_free(buffer);
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    memcpy(payload, packet->data, packet->length);
+    hal_result_t result = bluetooth_acl_send(buffer, true, packet->length);
+    if (result != HAL_OK) {
+        return result;
+    }
+
+    instance->stats.packets_transmitted++;
+    return HAL_OK;
+}
+
+/**
+ * @brief Receive one ACL packet on the current connection
+ *
+ * The counterpart of bluetooth_transmit(): the packet's payload, as the
+ * peer sent it, is copied into the caller's buffer. The L2CAP layer sees
+ * the same packet. The radio task delivers it; the wait also polls, in
+ * case the scheduler is not running. Not for use from radio callbacks,
+ * which run inside the poll.
+ */
+hal_result_t bluetooth_receive(hal_radio_instance_t *instance, hal_radio_packet_t *packet, uint32_t timeout_ms)
+{
+    if (instance == NULL || packet == NULL || instance->hw_context == NULL ||
+        packet->data == NULL || packet->length == 0) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    if (!ble_connected()) {
+        return HAL_ERROR_NOT_INITIALIZED;
+    }
+
+    if (ble_rx_packet != NULL) {
+        return HAL_ERROR_RESOURCE_BUSY;
+    }
+
+    ble_rx_capacity = packet->length;
+    ble_rx_done = false;
+    ble_rx_packet = packet;
+
+    /* Accumulated so waits longer than one timer period work; 0 waits for good */
+    uint64_t elapsed_us = 0;
+    uint32_t last_us = hal_radio_timer_now();
+    while (!ble_rx_done && ble_connected() && (timeout_ms == 0 || elapsed_us < (uint64_t)timeout_ms * 1000U)) {
+        hal_radio_bluetooth_poll();
+        scheduler_yield();
+        uint32_t now_us = hal_radio_timer_now();
+        elapsed_us += now_us - last_us;
+        last_us = now_us;
+    }
+    ble_rx_packet = NULL;
+
+    if (!ble_rx_done && !ble_connected()) {
+        return HAL_ERROR_NOT_INITIALIZED;
+    }
+    if (!ble_rx_done) {
+        hal_radio_notify(instance, HAL_RADIO_EVENT_RX_TIMEOUT, NULL);
+        return HAL_ERROR_TIMEOUT;
+    }
+    return ble_rx_result;
+}
+
+/**
+ * @brief Set Bluetooth radio state
+ *
+ * Idle and sleep take the radio off air: advertising and scanning stop
+ * (a partial scan batch is delivered) and must be started again. A
+ * connection stays up; the controller manages its own low-power states.
+ */
+hal_result_t bluetooth_set_state(hal_radio_instance_t *instance, hal_radio_state_t state)
+{
+    if (instance == NULL || instance->hw_context == NULL) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    if (state != HAL_RADIO_STATE_IDLE && state != HAL_RADIO_STATE_SLEEP) {
+        return HAL_ERROR_NOT_SUPPORTED;
+    }
+
+    hal_result_t result = bluetooth_stop_advertising(instance);
+    if (result == HAL_OK) {
+        result = bluetooth_stop_scan(instance);
+    }
+    if (result != HAL_OK) {
+        return result;
+    }
+
+    instance->state = state;
+    return HAL_OK;
+}
+
+/**
+ * @brief Set, replace or remove an advertising set
+ */
+hal_result_t bluetooth_set_adv_set(hal_radio_instance_t *instance, uint8_t index, const hal_radio_adv_set_t *set)
+{
+    (void)instance;
+
+    if (set != NULL) {
+        if ((set->type != HAL_RADIO_ADV_CONNECTABLE && set->type != HAL_RADIO_ADV_SCANNABLE &&
+             set->type != HAL_RADIO_ADV_NONCONNECTABLE) ||
+            set->interval_ms < BLE_ADV_INTERVAL_MIN_MS || set->interval_ms > BLE_ADV_INTERVAL_MAX_MS ||
+            set->duration_ms == 0 || set->data_length > HAL_RADIO_ADV_DATA_MAX ||
+            set->scan_response_length > HAL_RADIO_ADV_DATA_MAX) {
+            return HAL_ERROR_INVALID_PARAM;
+        }
+        ble_adv_sets[index] = *set;
+    }
+    ble_adv_used[index] = (set != NULL);
+
+    if (ble_adv_on_air && index == ble_adv_current) {
+        ble_adv_dirty = true;
+    }
+
+    ble_advertise(ble_now_ms());
+    ble_command_flush();
+    return HAL_OK;
+}
+
+/**
+ * @brief Start advertising the configured sets, first set first
+ */
+hal_result_t bluetooth_start_advertising(hal_radio_instance_t *instance)
+{
+    (void)instance;
+
+    bool any = false;
+    for (uint32_t i = 0; i < HAL_RADIO_ADV_SETS; i++) {
+        any = any || ble_adv_used[i];
+    }
+    if (!any) {
+        return HAL_ERROR_RESOURCE_NOT_FOUND;
+    }
+
+    if (!ble_adv_running) {
+        ble_adv_running = true;
+        ble_adv_current = HAL_RADIO_ADV_SETS - 1;
+    }
+
+    ble_advertise(ble_now_ms());
+    ble_command_flush();
+    return HAL_OK;
+}
+
+/**
+ * @brief Stop advertising
+ */
+hal_result_t bluetooth_stop_advertising(hal_radio_instance_t *instance)
+{
+    (void)instance;
+
+    if (ble_adv_on_air) {
+        hal_result_t result = ble_adv_enable(false);
+        if (result != HAL_OK) {
+            return result;
+        }
+    }
+
+    ble_adv_running = false;
+    ble_adv_on_air = false;
+    ble_adv_dirty = false;
+    ble_adv_refused = false;
+    ble_command_flush();
+    return HAL_OK;
+}
+
+/**
+ * @brief Start scanning with a fresh duplicate filter
+ */
+hal_result_t bluetooth_start_scan(hal_radio_instance_t *instance, const hal_radio_scan_config_t *config)
+{
+    (void)instance;
+
+    if (config->interval_ms < BLE_SCAN_INTERVAL_MIN_MS || config->interval_ms > BLE_SCAN_INTERVAL_MAX_MS ||
+        config->window_ms < BLE_SCAN_INTERVAL_MIN_MS || config->window_ms > config->interval_ms ||
+        config->batch_size > HAL_RADIO_SCAN_BATCH) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    if (ble_command_space() < BLE_SCAN_START_COMMANDS) {
+        return HAL_ERROR_RESOURCE_BUSY;
+    }
+
+    /* Reports from the previous scan belong to its callback */
+    ble_scan_deliver();
+
+    if (ble_scan_running) {
+        ble_scan_enable(false);
+    }
+
+    uint16_t interval = BLE_UNITS_625US(config->interval_ms);
+    uint16_t window = BLE_UNITS_625US(config->window_ms);
+    uint8_t params[7] = {
+        config->active ? 0x01 : 0x00,
+        (uint8_t)interval, (uint8_t)(interval >> 8),
+        (uint8_t)window, (uint8_t)(window >> 8),
+        0x00,                               /* Own address: public */
+        0x00                                /* Accept all advertisers */
+    };
+    ble_command(HCI_OP_LE_SET_SCAN_PARAMETERS, params, sizeof(params));
+    ble_scan_enable(true);
+
+    ble_scan_config = *config;
+    if (ble_scan_config.batch_size == 0) {
+        ble_scan_config.batch_size = HAL_RADIO_SCAN_BATCH;
+    }
+    ble_scan_clear();
+    ble_scan_running = true;
+
+    ble_command_flush();
+    return HAL_OK;
+}
+
+/**
+ * @brief Stop scanning, delivering any partial batch
+ */
+hal_result_t bluetooth_stop_scan(hal_radio_instance_t *instance)
+{
+    (void)instance;
+
+    if (!ble_scan_running) {
+        return HAL_OK;
+    }
+
+    hal_result_t result = ble_scan_enable(false);
+    if (result != HAL_OK) {
+        return result;
+    }
+
+    ble_scan_running = false;
+    ble_scan_deliver();
+    ble_command_flush();
+    return HAL_OK;
+}
+
+/**
+ * @brief Get BLE controller counters
+ */
+hal_result_t bluetooth_get_stats(hal_radio_instance_t *instance, hal_radio_bluetooth_stats_t *stats)
+{
+    (void)instance;
+
+    *stats = ble_stats;
+    return HAL_OK;
+}
+
+/**
+ * @brief Take a mailbox buffer for one ACL packet on the current connection
+ *
+ * Succeeds only while connected with a controller buffer free.
+ *
+ * @param payload Pointer to store where the ACL payload goes
+ * @param capacity Pointer to store the payload bytes the packet may carry
+ * @return Buffer, NULL if the packet cannot be sent now
+ */
+hal_ipcc_buffer_t *bluetooth_acl_alloc(uint8_t **payload, uint16_t *capacity)
+{
+    if (ble_instance == NULL || ble_acl_free == 0 || !ble_connected()) {
+        return NULL;
+    }
+
+    hal_ipcc_buffer_t *buffer = hal_ipcc_alloc(HAL_IPCC_PACKET_ACL);
+    if (buffer == NULL) {
+        return NULL;
+    }
+
+    *payload = &buffer->data[BLE_ACL_HEADER_SIZE];
+    *capacity = (ble_acl_length < HAL_IPCC_BUFFER_PAYLOAD - BLE_ACL_HEADER_SIZE) ?
+                ble_acl_length : (uint16_t)(HAL_IPCC_BUFFER_PAYLOAD - BLE_ACL_HEADER_SIZE);
+    return buffer;
+}
+
+/**
+ * @brief Send an ACL packet from bluetooth_acl_alloc()
+ * @param buffer Buffer with the payload filled in
+ * @param start First fragment of an L2CAP PDU
+ * @param length Payload bytes
+ * @return HAL_OK on success; the buffer is freed on failure
+ */
+hal_result_t bluetooth_acl_send(hal_ipcc_buffer_t *buffer, bool start, uint16_t length)
+{
+    hal_radio_bluetooth_context_t *ctx = ble_instance->hw_context;
+    uint16_t handle = (uint16_t)(ctx->connection_handle | (start ? BLE_ACL_PB_FIRST : BLE_ACL_PB_CONTINUE));
+
+    buffer->data[0] = (uint8_t)handle;
+    buffer->data[1] = (uint8_t)(handle >> 8);
+    buffer->data[2] = (uint8_t)length;
+    buffer->data[3] = (uint8_t)(length >> 8);
+
+    hal_result_t result = hal_ipcc_send(buffer);
+    if (result != HAL_OK) {
+        hal_ipcc_free(buffer);
+        return result;
+    }
+
+    ble_acl_free--;
+    ble_stats.acl_sent++;
+    return HAL_OK;
+}
+
+void hal_radio_bluetooth_poll(void)
+{
+    if (ble_instance == NULL) {
+        return;
+    }
+
+    /* The radio task and a blocking receive may both poll; one pass at a time */
+    uint32_t primask = hal_radio_lock();
+    bool busy = ble_polling;
+    ble_polling = true;
+    hal_radio_unlock(primask);
+
+    if (busy) {
+        return;
+    }
+
+    hal_ipcc_process();
+
+    uint32_t now_ms = ble_now_ms();
+    if (ble_scan_batch_count > 0 && now_ms - ble_scan_batch_ms >= ble_scan_config.batch_timeout_ms) {
+        ble_scan_deliver();
+    }
+
+    ble_advertise(now_ms);
+    ble_command_flush();
+    hal_radio_l2cap_pump();
+    ble_polling = false;
+}
+
+/* Static helper functions */
+
+/**
+ * @brief Forget commands, advertising and scan state
+ */
+static void ble_reset(void)
+{
+    memset(&ble_stats, 0, sizeof(ble_stats));
+    ble_command_head = ble_command_tail = 0;
+    ble_credits = 0;
+    ble_acl_length = 0;
+    ble_acl_total = 0;
+    ble_acl_free = 0;
+
+    memset(ble_adv_used, 0, sizeof(ble_adv_used));
+    ble_adv_running = false;
+    ble_adv_on_air = false;
+    ble_adv_dirty = false;
+    ble_adv_refused = false;
+
+    ble_scan_running = false;
+    ble_scan_batch_count = 0;
+    ble_scan_clear();
+
+    ble_clock_us = hal_radio_timer_now();
+    ble_clock_ms = 0;
+}
+
+/**
+ * @brief Millisecond clock from the microsecond timer
+ *
+ * Carries the sub-millisecond remainder, so it does not wrap with the
+ * timer as long as it is read at least once per timer wrap.
+ */
+static uint32_t ble_now_ms(void)
+{
+    uint32_t elapsed_ms = (hal_radio_timer_now() - ble_clock_us) / 1000U;
+
+    ble_clock_us += elapsed_ms * 1000U;
+    ble_clock_ms += elapsed_ms;
+    return ble_clock_ms;
+}
+
+/**
+ * @brief Free entries in the command queue
+ */
+static uint32_t ble_command_space(void)
+{
+    return BLE_COMMAND_QUEUE - (ble_command_head - ble_command_tail);
+}
+
+/**
+ * @brief Queue an HCI command; ble_command_flush() sends it
+ */
+static hal_result_t ble_command(uint16_t opcode, const uint8_t *params, uint8_t length)
+{
+    if (ble_command_space() == 0) {
+        return HAL_ERROR_RESOURCE_BUSY;
+    }
+
+    ble_command_t *command = &ble_commands[ble_command_head & (BLE_COMMAND_QUEUE - 1)];
+    command->opcode = opcode;
+    command->length = length;
+    if (length > 0) {
+        memcpy(command->params, params, length);
+    }
+    ble_command_head++;
+    return HAL_OK;
+}
+
+/**
+ * @brief Send queued commands while the controller has credits for them
+ */
+static void ble_command_flush(void)
+{
+    while (ble_command_tail != ble_command_head && ble_credits > 0) {
+        hal_ipcc_buffer_t *buffer = hal_ipcc_alloc(HAL_IPCC_PACKET_COMMAND);
+        if (buffer == NULL) {
+            return;
+        }
+
+        const ble_command_t *command = &ble_commands[ble_command_tail & (BLE_COMMAND_QUEUE - 1)];
+        buffer->data[0] = (uint8_t)command->opcode;
+        buffer->data[1] = (uint8_t)(command->opcode >> 8);
+        buffer->data[2] = command->length;
+        memcpy(&buffer->data[HCI_COMMAND_HEADER_SIZE], command->params, command->length);
+
+        if (hal_ipcc_send(buffer) != HAL_OK) {
+            hal_ipcc_free(buffer);
+            return;
+        }
+
+        ble_command_tail++;
+        ble_credits--;
+        ble_stats.hci_commands++;
+    }
+}
+
+/**
+ * @brief Mailbox batch: handle events, hand every buffer back
+ */
+static void ble_receive(hal_ipcc_buffer_t *const *buffers, uint32_t count, void *user_data)
+{
+    (void)user_data;
+
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t length = hal_ipcc_length(buffers[i]);
+
+        if (buffers[i]->type == HAL_IPCC_PACKET_EVENT) {
+            ble_event(buffers[i]->data, length);
+        } else if (buffers[i]->type == HAL_IPCC_PACKET_ACL) {
+            ble_stats.acl_received++;
+            ble_raw_receive(buffers[i]->data, length);
+            hal_radio_l2cap_receive(buffers[i]->data, length);
+        }
+        hal_ipcc_release(buffers[i]);
+    }
+
+    /* Command credits and ACL buffers may have come back with the events */
+    ble_command_flush();
+    hal_radio_l2cap_pump();
+}
+
+/**
+ * @brief Handle one HCI event
+ */
+static void ble_event(const uint8_t *data, uint32_t length)
+{
+    if (length < HCI_EVENT_HEADER_SIZE || data[1] > length - HCI_EVENT_HEADER_SIZE) {
+        return;
+    }
+
+    const uint8_t *params = &data[HCI_EVENT_HEADER_SIZE];
+    uint32_t params_length = data[1];
+    hal_radio_bluetooth_context_t *ctx = ble_instance->hw_context;
+
+    ble_stats.hci_events++;
+
+    switch (data[0]) {
+        case HCI_EV_COMMAND_COMPLETE:
+            ble_command_complete(params, params_length);
+            break;
+
+        case HCI_EV_COMMAND_STATUS:
+            if (params_length >= 4) {
+                ble_stats.hci_command_errors += (params[0] != 0) ? 1U : 0U;
+                ble_credits = params[1];
+            }
+            break;
+
+        case HCI_EV_NUMBER_OF_COMPLETED_PACKETS:
+            /* Handle and completed count per connection */
+            for (uint32_t i = 0; params_length >= 1 && i < params[0] && 1 + 4 * i + 4 <= params_length; i++) {
+                ble_acl_free += (uint16_t)(params[1 + 4 * i + 2] | (params[1 + 4 * i + 3] << 8));
+            }
+            if (ble_acl_free > ble_acl_total) {
+                ble_acl_free = ble_acl_total;
+            }
+            break;
+
+        case HCI_EV_DISCONNECTION_COMPLETE:
+            if (params_length >= 4 && params[0] == 0 &&
+                (uint16_t)(params[1] | (params[2] << 8)) == ctx->connection_handle) {
+                /* Packets still in the controller are dropped with the link */
+                ctx->connection_handle = BLE_HANDLE_INVALID;
+                ble_acl_free = ble_acl_total;
+                hal_radio_l2cap_link_down();
+            }
+            break;
+
+        case HCI_EV_LE_META:
+            ble_le_event(params, params_length);
+            break;
+
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief Handle Command Complete: credits, status and return parameters
+ */
+static void ble_command_complete(const uint8_t *params, uint32_t length)
+{
+    /* Credits, opcode, then the command's return parameters, status first */
+    if (length < 4) {
+        return;
+    }
+
+    uint16_t opcode = (uint16_t)(params[1] | (params[2] << 8));
+    ble_credits = params[0];
+    if (params[3] != 0) {
+        ble_stats.hci_command_errors++;
+
+        /* Refused enable (Command Disallowed while the link layer is busy
+         * or connected, or any other reason): nothing is on air, so the
+         * turn starts over once the back-off has passed */
+        if (opcode == HCI_OP_LE_SET_ADV_ENABLE && ble_adv_on_air) {
+            ble_adv_on_air = false;
+            ble_adv_refused = true;
+            ble_adv_refused_ms = ble_now_ms();
+            ble_stats.adv_refused += (params[3] == HCI_STATUS_DISALLOWED) ? 1U : 0U;
+        }
+        return;
+    }
+
+    if (opcode == HCI_OP_LE_READ_BUFFER_SIZE && length >= 7) {
+        /* A zero length would mean shared BR/EDR buffers, which CPU2 does not have */
+        ble_acl_length = (uint16_t)(params[4] | (params[5] << 8));
+        ble_acl_total = (ble_acl_length != 0) ? params[6] : 0;
+        ble_acl_free = ble_acl_total;
+    }
+}
+
+/**
+ * @brief Handle an LE meta event
+ */
+static void ble_le_event(const uint8_t *params, uint32_t length)
+{
+    if (length < 1) {
+        return;
+    }
+
+    switch (params[0]) {
+        case HCI_LE_CONNECTION_COMPLETE:
+        case HCI_LE_ENHANCED_CONNECTION_COMPLETE:
+            if (length >= 5 && params[1] == 0) {
+                /* The controller stops advertising when it accepts a connection */
+                if (params[4] == HCI_ROLE_PERIPHERAL) {
+                    ble_adv_on_air = false;
+                }
+                ble_link_up((uint16_t)((params[2] | (params[3] << 8)) & BLE_HANDLE_MASK));
+            }
+            break;
+
+        case HCI_LE_ADVERTISING_REPORT:
+            ble_scan_reports(&params[1], length - 1);
+            break;
+
+        case HCI_LE_DATA_LENGTH_CHANGE:
+            if (length >= 11) {
+                ble_stats.link_tx_octets = (uint16_t)(params[3] | (params[4] << 8));
+                ble_stats.link_rx_octets = (uint16_t)(params[7] | (params[8] << 8));
+            }
+            break;
+
+        case HCI_LE_PHY_UPDATE_COMPLETE:
+            if (length >= 6 && params[1] == 0) {
+                ble_stats.link_tx_phy = params[4];
+                ble_stats.link_rx_phy = params[5];
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief New connection: ask for long link packets and the 2M PHY, open channels
+ *
+ * Either request may be refused by the peer; the link then keeps running
+ * at what it has.
+ */
+static void ble_link_up(uint16_t handle)
+{
+    hal_radio_bluetooth_context_t *ctx = ble_instance->hw_context;
+    uint8_t data_length[6] = {
+        (uint8_t)handle, (uint8_t)(handle >> 8),
+        (uint8_t)BLE_LINK_OCTETS_MAX, (uint8_t)(BLE_LINK_OCTETS_MAX >> 8),
+        (uint8_t)BLE_LINK_TIME_MAX, (uint8_t)(BLE_LINK_TIME_MAX >> 8)
+    };
+    uint8_t phy[7] = {
+        (uint8_t)handle, (uint8_t)(handle >> 8),
+        0x00,                               /* Preferences given for both directions */
+        BLE_PHY_PREFER_2M, BLE_PHY_PREFER_2M,
+        0x00, 0x00                          /* No coding preference */
+    };
+
+    ctx->connection_handle = handle;
+    ble_stats.link_tx_octets = ble_stats.link_rx_octets = BLE_LINK_OCTETS_MIN;
+    ble_stats.link_tx_phy = ble_stats.link_rx_phy = BLE_PHY_1M;
+
+    ble_command(HCI_OP_LE_SET_DATA_LENGTH, data_length, sizeof(data_length));
+    ble_command(HCI_OP_LE_SET_PHY, phy, sizeof(phy));
+    hal_radio_l2cap_link_up();
+}
+
+static bool ble_connected(void)
+{
+    return ((hal_radio_bluetooth_context_t *)ble_instance->hw_context)->connection_handle != BLE_HANDLE_INVALID;
+}
+
+/**
+ * @brief Hand an ACL packet to a waiting bluetooth_receive()
+ */
+static void ble_raw_receive(const uint8_t *data, uint32_t length)
+{
+    if (ble_rx_packet == NULL || ble_rx_done || length < BLE_ACL_HEADER_SIZE) {
+        return;
+    }
+
+    uint32_t payload_length = (uint32_t)(data[2] | (data[3] << 8));
+    if (payload_length > length - BLE_ACL_HEADER_SIZE) {
+        return;
+    }
+
+    /* Too long for the caller's buffer: report it rather than truncate */
+    ble_rx_result = (payload_length <= ble_rx_capacity) ? HAL_OK : HAL_ERROR_NO_MEMORY;
+    if (ble_rx_result == HAL_OK) {
+        memcpy(ble_rx_packet->data, &data[BLE_ACL_HEADER_SIZE], payload_length);
+        ble_rx_packet->length = (uint16_t)payload_length;
+    }
+    ble_rx_packet->rssi = 0;                /* Not reported with ACL data */
+    ble_rx_packet->lqi = 0;
+    ble_rx_packet->crc_ok = true;           /* The link layer only passes packets with a good CRC */
+    ble_rx_packet->timestamp = hal_radio_timer_now();
+    ble_rx_done = true;
+}
+
+/**
+ * @brief Start the next advertising turn when one is due
+ *
+ * Advances to the next set in index order when the current set's turn is
+ * over, when it was removed or when the controller stopped advertising;
+ * reprograms the current set when it changed. A turn that does not fit
+ * the command queue is retried on the next poll.
+ */
+static void ble_advertise(uint32_t now_ms)
+{
+    /* The controller takes no new advertising while a link is up; rotation resumes after it */
+    if (!ble_adv_running || ble_connected()) {
+        return;
+    }
+    if (ble_adv_refused && now_ms - ble_adv_refused_ms < BLE_ADV_RETRY_MS) {
+        return;
+    }
+
+    uint32_t used = 0;
+    for (uint32_t i = 0; i < HAL_RADIO_ADV_SETS; i++) {
+        used += ble_adv_used[i] ? 1U : 0U;
+    }
+
+    if (used == 0) {
+        /* Last set removed: off air until a set is added */
+        if (ble_adv_on_air && ble_adv_enable(false) == HAL_OK) {
+            ble_adv_on_air = false;
+            ble_adv_dirty = false;
+        }
+        return;
+    }
+
+    bool turn_over = used > 1 && now_ms - ble_adv_turn_ms >= ble_adv_sets[ble_adv_current].duration_ms;
+    bool advance = !ble_adv_on_air || !ble_adv_used[ble_adv_current] || turn_over;
+
+    if (!advance && !ble_adv_dirty) {
+        return;
+    }
+    if (ble_command_space() < BLE_ADV_TURN_COMMANDS) {
+        return;
+    }
+
+    uint8_t next = ble_adv_current;
+    if (advance) {
+        do {
+            next = (uint8_t)((next + 1) % HAL_RADIO_ADV_SETS);
+        } while (!ble_adv_used[next]);
+    }
+
+    if (ble_adv_on_air) {
+        ble_adv_enable(false);
+        ble_stats.adv_rotations += (next != ble_adv_current) ? 1U : 0U;
+    }
+
+    const hal_radio_adv_set_t *set = &ble_adv_sets[next];
+    uint16_t interval = BLE_UNITS_625US(set->interval_ms);
+    uint8_t params[15] = {
+        (uint8_t)interval, (uint8_t)(interval >> 8),
+        (uint8_t)interval, (uint8_t)(interval >> 8),
+        (uint8_t)set->type,
+        0x00,                               /* Own address: public */
+        0x00, 0, 0, 0, 0, 0, 0,             /* No peer (undirected) */
+        0x07,                               /* All three advertising channels */
+        0x00                                /* Accept all scanners and initiators */
+    };
+    ble_command(HCI_OP_LE_SET_ADV_PARAMETERS, params, sizeof(params));
+    ble_adv_data(HCI_OP_LE_SET_ADV_DATA, set->data, set->data_length);
+    ble_adv_data(HCI_OP_LE_SET_SCAN_RESPONSE_DATA, set->scan_response, set->scan_response_length);
+    ble_adv_enable(true);
+
+    ble_adv_current = next;
+    ble_adv_on_air = true;
+    ble_adv_dirty = false;
+    ble_adv_refused = false;
+    ble_adv_turn_ms = now_ms;
+}
+
+/**
+ * @brief Queue LE Set Advertising Enable
+ */
+static hal_result_t ble_adv_enable(bool enable)
+{
+    uint8_t param = enable ? 0x01 : 0x00;
+    return ble_command(HCI_OP_LE_SET_ADV_ENABLE, &param, 1);
+}
+
+/**
+ * @brief Queue LE Set Advertising Data or Scan Response Data, zero padded
+ */
+static hal_result_t ble_adv_data(uint16_t opcode, const uint8_t *data, uint8_t length)
+{
+    uint8_t params[1 + HAL_RADIO_ADV_DATA_MAX] = { length };
+
+    memcpy(&params[1], data, length);
+    return ble_command(opcode, params, sizeof(params));
+}
+
+/**
+ * @brief Queue LE Set Scan Enable, with the controller's duplicate filter off
+ */
+static hal_result_t ble_scan_enable(bool enable)
+{
+    uint8_t params[2] = { enable ? 0x01 : 0x00, 0x00 };
+    return ble_command(HCI_OP_LE_SET_SCAN_ENABLE, params, sizeof(params));
+}
+
+/**
+ * @brief Split an LE Advertising Report event into reports
+ *
+ * Reports are read one after the other, each complete, the way
+ * controllers send them (nearly always one per event).
+ */
+static void ble_scan_reports(const uint8_t *data, uint32_t length)
+{
+    if (!ble_scan_running || length < 1) {
+        return;
+    }
+
+    uint32_t count = data[0];
+    uint32_t offset = 1;
+
+    for (uint32_t i = 0; i < count && length - offset >= HCI_ADV_REPORT_MIN_SIZE; i++) {
+        const uint8_t *report = &data[offset];
+        uint8_t data_length = report[8];
+
+        if (data_length > HAL_RADIO_ADV_DATA_MAX || length - offset < HCI_ADV_REPORT_MIN_SIZE + (uint32_t)data_length) {
+            return;
+        }
+
+        ble_scan_report(report[0], report[1], &report[2], &report[9], data_length,
+                        (int8_t)report[9 + data_length]);
+        offset += HCI_ADV_REPORT_MIN_SIZE + data_length;
+    }
+}
+
+/**
+ * @brief Filter one advertising report and batch it if it is news
+ */
+static void ble_scan_report(uint8_t event_type, uint8_t address_type, const uint8_t *address,
+                            const uint8_t *data, uint8_t length, int8_t rssi_dbm)
+{
+    ble_stats.scan_reports++;
+
+    if (rssi_dbm == HCI_RSSI_UNAVAILABLE || rssi_dbm < ble_scan_config.rssi_threshold_dbm) {
+        ble_stats.scan_weak++;
+        return;
+    }
+
+    uint32_t now_ms = ble_now_ms();
+    uint32_t kind = (event_type == HCI_ADV_SCAN_RSP) ? 1U : 0U;
+    uint32_t hash = ble_hash(ble_hash(BLE_HASH_OFFSET, &event_type, 1), data, length);
+    ble_device_t *device = ble_scan_lookup(address_type, address);
+
+    if ((device->known & (1U << kind)) != 0 && device->hash[kind] == hash &&
+        (ble_scan_config.refresh_ms == 0 || now_ms - device->reported_ms[kind] < ble_scan_config.refresh_ms)) {
+        ble_stats.scan_duplicates++;
+        return;
+    }
+
+    device->known |= (uint8_t)(1U << kind);
+    device->hash[kind] = hash;
+    device->reported_ms[kind] = now_ms;
+
+    if (ble_scan_batch_count == 0) {
+        ble_scan_batch_ms = now_ms;
+    }
+
+    hal_radio_scan_report_t *report = &ble_scan_batch[ble_scan_batch_count++];
+    memcpy(report->address, address, sizeof(report->address));
+    report->address_type = address_type;
+    report->event_type = event_type;
+    report->rssi_dbm = rssi_dbm;
+    report->data_length = length;
+    memcpy(report->data, data, length);
+
+    if (ble_scan_batch_count >= ble_scan_config.batch_size) {
+        ble_scan_deliver();
+    }
+}
+
+/**
+ * @brief Find a device, or add it in place of the least recently heard
+ *
+ * The device returned is the most recently heard from then on.
+ */
+static ble_device_t *ble_scan_lookup(uint8_t address_type, const uint8_t *address)
+{
+    uint32_t hash = ble_hash(ble_hash(BLE_HASH_OFFSET, &address_type, 1), address, 6);
+    uint8_t bucket = (uint8_t)((hash ^ (hash >> 16)) & (HAL_RADIO_SCAN_DEVICES - 1));
+    uint8_t index;
+
+    for (index = ble_scan_buckets[bucket]; index != BLE_SCAN_NONE; index = ble_scan_devices[index].bucket_next) {
+        ble_device_t *device = &ble_scan_devices[index];
+        if (device->address_type == address_type && memcmp(device->address, address, 6) == 0) {
+            if (ble_scan_lru_head != index) {
+                ble_scan_unlink(index);
+                ble_scan_push_front(index);
+            }
+            return device;
+        }
+    }
+
+    if (ble_scan_free != BLE_SCAN_NONE) {
+        index = ble_scan_free;
+        ble_scan_free = ble_scan_devices[index].bucket_next;
+        ble_stats.scan_devices++;
+    } else {
+        index = ble_scan_lru_tail;
+        ble_scan_unlink(index);
+
+        /* Out of its bucket chain too */
+        uint8_t *link = &ble_scan_buckets[ble_scan_devices[index].bucket];
+        while (*link != index) {
+            link = &ble_scan_devices[*link].bucket_next;
+        }
+        *link = ble_scan_devices[index].bucket_next;
+        ble_stats.scan_evictions++;
+    }
+
+    ble_device_t *device = &ble_scan_devices[index];
+    memset(device, 0, sizeof(*device));
+    memcpy(device->address, address, 6);
+    device->address_type = address_type;
+    device->bucket = bucket;
+    device->bucket_next = ble_scan_buckets[bucket];
+    ble_scan_buckets[bucket] = index;
+    ble_scan_push_front(index);
+    return device;
+}
+
+/**
+ * @brief Take a device out of the recency list
+ */
+static void ble_scan_unlink(uint8_t index)
+{
+    ble_device_t *device = &ble_scan_devices[index];
+
+    if (device->lru_prev != BLE_SCAN_NONE) {
+        ble_scan_devices[device->lru_prev].lru_next = device->lru_next;
+    } else {
+        ble_scan_lru_head = device->lru_next;
+    }
+    if (device->lru_next != BLE_SCAN_NONE) {
+        ble_scan_devices[device->lru_next].lru_prev = device->lru_prev;
+    } else {
+        ble_scan_lru_tail = device->lru_prev;
+    }
+}
+
+/**
+ * @brief Make a device the most recently heard
+ */
+static void ble_scan_push_front(uint8_t index)
+{
+    ble_device_t *device = &ble_scan_devices[index];
+
+    device->lru_prev = BLE_SCAN_NONE;
+    device->lru_next = ble_scan_lru_head;
+    if (ble_scan_lru_head != BLE_SCAN_NONE) {
+        ble_scan_devices[ble_scan_lru_head].lru_prev = index;
+    } else {
+        ble_scan_lru_tail = index;
+    }
+    ble_scan_lru_head = index;
+}
+
+/**
+ * @brief Empty the device table
+ */
+static void ble_scan_clear(void)
+{
+    memset(ble_scan_buckets, BLE_SCAN_NONE, sizeof(ble_scan_buckets));
+    for (uint32_t i = 0; i < HAL_RADIO_SCAN_DEVICES; i++) {
+        ble_scan_devices[i].bucket_next = (uint8_t)((i + 1 < HAL_RADIO_SCAN_DEVICES) ? i + 1 : BLE_SCAN_NONE);
+    }
+    ble_scan_free = 0;
+    ble_scan_lru_head = ble_scan_lru_tail = BLE_SCAN_NONE;
+    ble_stats.scan_devices = 0;
+}
+
+/**
+ * @brief Hand the pending batch to the scan callback
+ *
+ * The batch is emptied first, so the callback may stop or restart the scan.
+ */
+static void ble_scan_deliver(void)
+{
+    uint32_t count = ble_scan_batch_count;
+
+    if (count == 0) {
+        return;
+    }
+
+    ble_scan_batch_count = 0;
+    ble_stats.scan_delivered += count;
+    ble_stats.scan_batches++;
+    if (ble_scan_config.callback != NULL) {
+        ble_scan_config.callback(ble_scan_batch, count, ble_scan_config.user_data);
+    }
+}
+
+/**
+ * @brief FNV-1a hash, continued from a previous value
+ */
+static uint32_t ble_hash(uint32_t hash, const uint8_t *data, uint32_t length)
+{
+    for (uint32_t i = 0; i < length; i++) {
+        hash ^= data[i];
+        hash *= BLE_HASH_PRIME;
+    }
+    return hash;
+}
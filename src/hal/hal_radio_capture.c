@@ -0,0 +1,293 @@
+/**
+ * @file hal_radio_capture.c
+ * @brief Raw Sub-GHz capture buffer pool
+ *
+ * The radio driver timestamps demodulator edges in its interrupt handler
+ * and pushes pulse durations here. They are collected into fixed pool
+ * buffers; a full buffer moves to the ready ring and the consumer gets it
+ * by reference, then hands it back through the free ring. Each ring has
+ * one producer and one consumer (the interrupt handler on one side, the
+ * consuming task on the other), so neither needs a lock. Memory is
+ * bounded by the pool: when the consumer falls behind, edges are counted
+ * as dropped rather than buffered further.
+ */
+
+#include "hal_radio_internal.h"
+#include <string.h>
+
+#if (HAL_RADIO_CAPTURE_BUFFERS & (HAL_RADIO_CAPTURE_BUFFERS - 1)) != 0
+#error "HAL_RADIO_CAPTURE_BUFFERS must be a power of two"
+#endif
+
+#if HAL_RADIO_CAPTURE_BUFFERS > 32
+#error "HAL_RADIO_CAPTURE_BUFFERS must fit the taken-buffer mask"
+#endif
+
+#define CAPTURE_RING_MASK           (HAL_RADIO_CAPTURE_BUFFERS - 1U)
+#define CAPTURE_FLUSH_US            20000   /**< Publish a partial buffer after this much signal time */
+
+/* Stores to a buffer must land before the index that publishes it */
+#define CAPTURE_BARRIER()           __asm volatile ("" ::: "memory")
+
+/**
+ * @brief Pool buffer; the public part comes first so references convert back
+ */
+typedef struct {
+    hal_radio_capture_buffer_t buffer;
+    uint32_t span_us;                       /**< Signal time covered so far */
+    int32_t edges[HAL_RADIO_CAPTURE_EDGES];
+} capture_slot_t;
+
+/**
+ * @brief Single-producer single-consumer ring of slot indices
+ */
+typedef struct {
+    uint8_t slots[HAL_RADIO_CAPTURE_BUFFERS];
+    volatile uint32_t head;                 /**< Written by the producer */
+    volatile uint32_t tail;                 /**< Written by the consumer */
+} capture_ring_t;
+
+/* Capture state */
+static capture_slot_t capture_pool[HAL_RADIO_CAPTURE_BUFFERS];
+static capture_ring_t capture_free;         /* Consumer -> interrupt handler */
+static capture_ring_t capture_ready;        /* Interrupt handler -> consumer */
+static capture_slot_t *capture_current;     /* Being filled by the interrupt handler */
+static uint32_t capture_taken;              /* Slots held by the consumer; consumer side only */
+static hal_radio_instance_t *capture_owner;
+static volatile bool capture_running;
+static uint32_t capture_sequence;
+static hal_radio_capture_stats_t capture_stats;
+
+/* Static function prototypes */
+static bool capture_ring_put(capture_ring_t *ring, uint8_t slot);
+static bool capture_ring_get(capture_ring_t *ring, uint8_t *slot);
+static void capture_publish(void);
+
+/**
+ * @brief Reset the pool and start accepting edges for an instance
+ *
+ * Refused while the consumer still holds buffers from the last capture:
+ * they would be handed out again while in use.
+ */
+hal_result_t hal_radio_capture_begin(hal_radio_instance_t *instance)
+{
+    if (capture_running || capture_taken != 0) {
+        return HAL_ERROR_RESOURCE_BUSY;
+    }
+
+    memset(&capture_free, 0, sizeof(capture_free));
+    memset(&capture_ready, 0, sizeof(capture_ready));
+    memset(&capture_stats, 0, sizeof(capture_stats));
+
+    for (uint32_t i = 0; i < HAL_RADIO_CAPTURE_BUFFERS; i++) {
+        capture_pool[i].buffer.edges = capture_pool[i].edges;
+        capture_ring_put(&capture_free, (uint8_t)i);
+    }
+
+    capture_current = NULL;
+    capture_sequence = 0;
+    capture_owner = instance;
+    capture_running = true;
+    return HAL_OK;
+}
+
+/**
+ * @brief Stop accepting edges and publish the partly filled buffer
+ *
+ * Called once the driver has stopped delivering edges; buffers still in
+ * the ready ring stay available to hal_radio_capture_acquire().
+ */
+void hal_radio_capture_end(hal_radio_instance_t *instance)
+{
+    if (instance != capture_owner || !capture_running) {
+        return;
+    }
+
+    capture_running = false;
+    capture_publish();
+}
+
+/**
+ * @brief Record one pulse (interrupt context)
+ * @param high Level of the pulse that just ended
+ * @param duration_us Pulse length in microseconds
+ */
+void hal_radio_capture_edge(bool high, uint32_t duration_us)
+{
+    if (!capture_running) {
+        return;
+    }
+
+    if (capture_current == NULL) {
+        uint8_t index;
+        if (!capture_ring_get(&capture_free, &index)) {
+            capture_stats.edges_dropped++;
+            return;
+        }
+
+        uint32_t in_use = HAL_RADIO_CAPTURE_BUFFERS - (capture_free.head - capture_free.tail);
+        if (in_use > capture_stats.max_buffers_in_use) {
+            capture_stats.max_buffers_in_use = in_use;
+        }
+
+        capture_current = &capture_pool[index];
+        capture_current->buffer.count = 0;
+        capture_current->span_us = 0;
+    }
+
+    if (duration_us > INT32_MAX) {
+        duration_us = INT32_MAX;
+    }
+
+    capture_slot_t *slot = capture_current;
+    slot->edges[slot->buffer.count++] = high ? (int32_t)duration_us : -(int32_t)duration_us;
+    slot->span_us += duration_us;
+    capture_stats.edges_captured++;
+
+    /* Sparse signals still reach the consumer promptly */
+    if (slot->buffer.count == HAL_RADIO_CAPTURE_EDGES || slot->span_us >= CAPTURE_FLUSH_US) {
+        capture_publish();
+    }
+}
+
+/**
+ * @brief Take the oldest filled buffer
+ */
+hal_result_t hal_radio_capture_take(hal_radio_instance_t *instance, const hal_radio_capture_buffer_t **buffer)
+{
+    uint8_t index;
+
+    if (instance != capture_owner) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    *buffer = NULL;
+    if (capture_ring_get(&capture_ready, &index)) {
+        capture_taken |= 1UL << index;
+        *buffer = &capture_pool[index].buffer;
+    }
+
+    return HAL_OK;
+}
+
+/**
+ * @brief Give a buffer back to the pool
+ *
+ * Only a buffer the consumer took and has not given back yet is accepted;
+ * anything else would put a slot on the free ring twice.
+ */
+hal_result_t hal_radio_capture_give(hal_radio_instance_t *instance, const hal_radio_capture_buffer_t *buffer)
+{
+    if (instance != capture_owner || buffer == NULL) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    for (uint32_t index = 0; index < HAL_RADIO_CAPTURE_BUFFERS; index++) {
+        if (buffer == &capture_pool[index].buffer) {
+            if (!(capture_taken & (1UL << index))) {
+                return HAL_ERROR_INVALID_PARAM;
+            }
+            capture_taken &= ~(1UL << index);
+            capture_ring_put(&capture_free, (uint8_t)index);
+            return HAL_OK;
+        }
+    }
+
+    return HAL_ERROR_INVALID_PARAM;
+}
+
+/**
+ * @brief Hand every filled buffer to a sink, returning each to the pool
+ *
+ * The sink sees the pool buffer itself; nothing is copied on the way to
+ * storage. Stops at the first sink error, after returning that buffer.
+ */
+hal_result_t hal_radio_capture_drain(hal_radio_instance_t *instance, hal_radio_capture_sink_t sink,
+                                     void *user_data, uint32_t *spilled)
+{
+    const hal_radio_capture_buffer_t *buffer;
+    hal_result_t result = HAL_OK;
+    uint32_t count = 0;
+
+    while (result == HAL_OK) {
+        result = hal_radio_capture_take(instance, &buffer);
+        if (result != HAL_OK || buffer == NULL) {
+            break;
+        }
+
+        result = sink(buffer, user_data);
+        hal_radio_capture_give(instance, buffer);
+        if (result == HAL_OK) {
+            count++;
+        }
+    }
+
+    capture_stats.buffers_spilled += count;
+    if (spilled != NULL) {
+        *spilled = count;
+    }
+
+    return result;
+}
+
+/**
+ * @brief Copy the capture counters
+ */
+hal_result_t hal_radio_capture_stats(hal_radio_instance_t *instance, hal_radio_capture_stats_t *stats)
+{
+    if (instance != capture_owner) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    *stats = capture_stats;
+    return HAL_OK;
+}
+
+/* Static helper functions */
+
+static bool capture_ring_put(capture_ring_t *ring, uint8_t slot)
+{
+    uint32_t head = ring->head;
+
+    if (head - ring->tail >= HAL_RADIO_CAPTURE_BUFFERS) {
+        return false;
+    }
+
+    ring->slots[head & CAPTURE_RING_MASK] = slot;
+    CAPTURE_BARRIER();
+    ring->head = head + 1;
+    return true;
+}
+
+static bool capture_ring_get(capture_ring_t *ring, uint8_t *slot)
+{
+    uint32_t tail = ring->tail;
+
+    if (ring->head == tail) {
+        return false;
+    }
+
+    *slot = ring->slots[tail & CAPTURE_RING_MASK];
+    CAPTURE_BARRIER();
+    ring->tail = tail + 1;
+    return true;
+}
+
+/**
+ * @brief Move the buffer being filled to the ready ring
+ */
+static void capture_publish(void)
+{
+    capture_slot_t *slot = capture_current;
+
+    if (slot == NULL || slot->buffer.count == 0) {
+        return;
+    }
+
+    capture_current = NULL;
+    slot->buffer.sequence = capture_sequence++;
+    capture_stats.buffers_filled++;
+
+    /* The ready ring holds every pool buffer, so this cannot fail */
+    capture_ring_put(&capture_ready, (uint8_t)(slot - capture_pool));
+}
@@ -0,0 +1,2501 @@
+/**
+ * @file hal_radio_cc1101.c
+ * @brief CC1101 Sub-GHz transceiver driver
+ *
+ * Register and FIFO access use the CC1101 SPI burst mode: one header byte
+ * followed by any number of data bytes. Packets are streamed straight
+ * between the caller's buffer and the 64-byte chip FIFOs from the GDO
+ * interrupts: GDO0 signals the FIFO threshold (refill TX, drain RX) and
+ * GDO2 the sync word and the end of the packet. Packets longer than 255
+ * bytes run in infinite length mode and switch to fixed length for the
+ * last partial wrap of the chip's byte counter.
+ */
+
+#include "hal_radio_internal.h"
+#include "hal_gpio.h"
+#include <string.h>
+#include <stdlib.h>
+
+/* CC1101 configuration registers */
+#define CC1101_IOCFG2       0x00    /**< GDO2 output pin configuration */
+#define CC1101_IOCFG1       0x01    /**< GDO1 output pin configuration */
+#define CC1101_IOCFG0       0x02    /**< GDO0 output pin configuration */
+#define CC1101_FIFOTHR      0x03    /**< RX FIFO and TX FIFO thresholds */
+#define CC1101_SYNC1        0x04    /**< Sync word, high byte */
+#define CC1101_SYNC0        0x05    /**< Sync word, low byte */
+#define CC1101_PKTLEN       0x06    /**< Packet length */
+#define CC1101_PKTCTRL1     0x07    /**< Packet automation control */
+#define CC1101_PKTCTRL0     0x08    /**< Packet automation control */
+#define CC1101_ADDR         0x09    /**< Device address */
+#define CC1101_CHANNR       0x0A    /**< Channel number */
+#define CC1101_FSCTRL1      0x0B    /**< Frequency synthesizer control */
+#define CC1101_FSCTRL0      0x0C    /**< Frequency synthesizer control */
+#define CC1101_FREQ2        0x0D    /**< Frequency control word, high byte */
+#define CC1101_FREQ1        0x0E    /**< Frequency control word, middle byte */
+#define CC1101_FREQ0        0x0F    /**< Frequency control word, low byte */
+#define CC1101_MDMCFG4      0x10    /**< Modem configuration */
+#define CC1101_MDMCFG3      0x11    /**< Modem configuration */
+#define CC1101_MDMCFG2      0x12    /**< Modem configuration */
+#define CC1101_MDMCFG1      0x13    /**< Modem configuration */
+#define CC1101_MDMCFG0      0x14    /**< Modem configuration */
+#define CC1101_DEVIATN      0x15    /**< Modem deviation setting */
+#define CC1101_MCSM2        0x16    /**< Main radio control state machine configuration */
+#define CC1101_MCSM1        0x17    /**< Main radio control state machine configuration */
+#define CC1101_MCSM0        0x18    /**< Main radio control state machine configuration */
+#define CC1101_FOCCFG       0x19    /**< Frequency offset compensation configuration */
+#define CC1101_BSCFG        0x1A    /**< Bit synchronization configuration */
+#define CC1101_AGCCTRL2     0x1B    /**< AGC control */
+#define CC1101_AGCCTRL1     0x1C    /**< AGC control */
+#define CC1101_AGCCTRL0     0x1D    /**< AGC control */
+#define CC1101_WOREVT1      0x1E    /**< Event 0 timeout, high byte */
+#define CC1101_WOREVT0      0x1F    /**< Event 0 timeout, low byte */
+#define CC1101_WORCTRL      0x20    /**< Wake on radio control */
+#define CC1101_FREND1       0x21    /**< Front end RX configuration */
+#define CC1101_FREND0       0x22    /**< Front end TX configuration */
+#define CC1101_FSCAL3       0x23    /**< Frequency synthesizer calibration */
+#define CC1101_FSCAL2       0x24    /**< Frequency synthesizer calibration */
+#define CC1101_FSCAL1       0x25    /**< Frequency synthesizer calibration */
+#define CC1101_FSCAL0       0x26    /**< Frequency synthesizer calibration */
+#define CC1101_TEST0        0x2E    /**< Last configuration register */
+#define CC1101_CONFIG_REGISTERS 0x2F
+
+#if CC1101_CONFIG_REGISTERS != HAL_RADIO_CONTEXT_REGISTERS
+#error "HAL_RADIO_CONTEXT_REGISTERS must match the CC1101 register file"
+#endif
+
+/* CC1101 command strobes */
+#define CC1101_SRES         0x30    /**< Reset chip */
+#define CC1101_SFSTXON      0x31    /**< Enable and calibrate frequency synthesizer */
+#define CC1101_SXOFF        0x32    /**< Turn off crystal oscillator */
+#define CC1101_SCAL         0x33    /**< Calibrate frequency synthesizer */
+#define CC1101_SRX          0x34    /**< Enable RX */
+#define CC1101_STX          0x35    /**< Enable TX */
+#define CC1101_SIDLE        0x36    /**< Exit RX / TX, turn off frequency synthesizer */
+#define CC1101_SWOR         0x38    /**< Start automatic RX polling sequence */
+#define CC1101_SPWD         0x39    /**< Enter power down mode */
+#define CC1101_SFRX         0x3A    /**< Flush the RX FIFO buffer */
+#define CC1101_SFTX         0x3B    /**< Flush the TX FIFO buffer */
+#define CC1101_SWORRST      0x3C    /**< Reset real time clock */
+#define CC1101_SNOP         0x3D    /**< No operation */
+
+/* CC1101 status registers (read with the burst bit set) */
+#define CC1101_PARTNUM      0x30    /**< Part number */
+#define CC1101_VERSION      0x31    /**< Chip version */
+#define CC1101_LQI          0x33    /**< Link quality estimate */
+#define CC1101_RSSI         0x34    /**< Received signal strength */
+#define CC1101_MARCSTATE    0x35    /**< Main radio control state */
+#define CC1101_TXBYTES      0x3A    /**< Underflow flag and bytes in the TX FIFO */
+#define CC1101_RXBYTES      0x3B    /**< Overflow flag and bytes in the RX FIFO */
+#define CC1101_STATUS_LAST  0x3D
+
+/* Multi-byte spaces */
+#define CC1101_PATABLE      0x3E    /**< PA power table */
+#define CC1101_FIFO         0x3F    /**< TX FIFO (write) / RX FIFO (read) */
+
+/* SPI header bits */
+#define CC1101_READ         0x80
+#define CC1101_BURST        0x40
+
+/* Register fields */
+#define CC1101_GDO_RX_THRESHOLD     0x00    /**< RX FIFO at or above threshold */
+#define CC1101_GDO_TX_THRESHOLD     0x02    /**< TX FIFO at or above threshold */
+#define CC1101_GDO_SYNC_WORD        0x06    /**< Sync word seen until the end of the packet */
+#define CC1101_GDO_SERIAL_DATA      0x0D    /**< Demodulated data, asynchronous */
+#define CC1101_FIFOTHR_33_32        0x47    /**< ADC retention, TX 33 / RX 32 bytes */
+#define CC1101_PKTCTRL1_APPEND      0x04    /**< Append RSSI and LQI/CRC_OK to RX packets */
+#define CC1101_PKTCTRL1_PQT_SHIFT   5       /**< Preamble quality threshold, 4 per step */
+#define CC1101_PKTCTRL1_PQT_MASK    0xE0
+#define CC1101_PKTCTRL0_WHITE       0x40
+#define CC1101_PKTCTRL0_CRC         0x04
+#define CC1101_LENGTH_FIXED         0x00
+#define CC1101_LENGTH_VARIABLE      0x01
+#define CC1101_LENGTH_INFINITE      0x02
+#define CC1101_PKTCTRL0_ASYNC       0x30    /**< Asynchronous serial mode, no packet handling */
+#define CC1101_FIFO_OVERFLOW        0x80    /**< TXBYTES/RXBYTES flag */
+#define CC1101_FIFO_COUNT           0x7F
+#define CC1101_LQI_CRC_OK           0x80
+#define CC1101_MCSM0_AUTOCAL_MASK   0x30
+#define CC1101_MCSM0_AUTOCAL_IDLE   0x10    /**< Calibrate when leaving IDLE for RX/TX */
+#define CC1101_MCSM0_AUTOCAL_NEVER  0x00    /**< Only calibrate on SCAL */
+#define CC1101_MCSM2_RX_TIME_RSSI   0x10    /**< End RX early without carrier sense */
+#define CC1101_MCSM2_RX_TIME_QUAL   0x08    /**< At RX timeout, stay for a preamble rather than a sync word */
+#define CC1101_MCSM2_RX_TIME_NONE   0x07    /**< No RX timeout */
+#define CC1101_AGCCTRL1_CS_MASK     0x3F    /**< CARRIER_SENSE_REL_THR and CARRIER_SENSE_ABS_THR */
+#define CC1101_AGCCTRL1_CS_REL_SHIFT 4
+#define CC1101_WORCTRL_RC_PD        0x80    /**< RC oscillator powered down */
+#define CC1101_WORCTRL_EVENT1_SHIFT 4
+#define CC1101_WORCTRL_RC_CAL       0x08    /**< Calibrate the RC oscillator on every wake */
+#define CC1101_WORCTRL_OFF          0xFB    /**< Reset value: RC oscillator off */
+#define CC1101_MARC_IDLE            0x01
+#define CC1101_MARC_RX              0x0D
+#define CC1101_MARC_TXFIFO_UNDERFLOW 0x16
+
+#define CC1101_FIFO_SIZE            64
+#define CC1101_XOSC_HZ              26000000UL
+#define CC1101_RSSI_OFFSET          74
+
+/* Driver defaults for configuration fields left at 0 */
+#define CC1101_DEFAULT_DATA_RATE    4800
+#define CC1101_DEFAULT_DEVIATION    20000
+#define CC1101_DEFAULT_BANDWIDTH    100000
+
+/* Timing */
+#define CC1101_READY_TIMEOUT_US     1000    /**< CHIP_RDYn after chip select */
+#define CC1101_STATE_TIMEOUT_US     2000    /**< State changes and calibration */
+#define CC1101_TX_MARGIN_MS         50
+#define CC1101_RSSI_SETTLE_US       100     /**< RSSI valid after entering RX */
+#define CC1101_CCA_BACKOFF_US       500     /**< Base backoff after a busy channel check */
+#define CC1101_CCA_JITTER_MASK      0x3FF   /**< Random part of the backoff, in us */
+#define CC1101_SCHEDULE_LEAD_US     20      /**< Timed strobes: wake this early, spin the rest */
+#define CC1101_WOR_EVENT1           3       /**< Wake to RX: code 3 = 12 RC periods (~350 us) for the crystal */
+#define CC1101_WOR_DUTY_PPM         36058   /**< Longest RX window, per million of EVENT0 (RX_TIME 0, WOR_RES 0) */
+#define CC1101_WOR_MIN_MS           10
+#define CC1101_WOR_MAX_MS           60000
+
+/* Deadline timer channel for async requests */
+#define CC1101_TIMER_CHANNEL        0
+
+/* Board wiring: SPI1 with software chip select */
+#define CC1101_PIN_SCK              5       /* PA5 */
+#define CC1101_PIN_MISO             20      /* PB4 */
+#define CC1101_PIN_MOSI             21      /* PB5 */
+#define CC1101_PIN_CS               48      /* PD0 */
+#define CC1101_PIN_GDO0             1       /* PA1 */
+#define CC1101_PIN_GDO2             2       /* PA2 */
+
+#define CC1101_SPI_BASE             0x40013000UL    /* SPI1 */
+#define CC1101_RCC_BASE             0x58000000UL
+#define RCC_APB2ENR_OFFSET          0x60
+#define RCC_APB2ENR_SPI1EN          (1UL << 12)
+#define SPI_CR1_OFFSET              0x00
+#define SPI_CR2_OFFSET              0x04
+#define SPI_SR_OFFSET               0x08
+#define SPI_DR_OFFSET               0x0C
+#define SPI_CR1_MSTR                (1UL << 2)
+#define SPI_CR1_BR_DIV16            (3UL << 3)      /* 4 MHz, inside the 6.5 MHz burst limit */
+#define SPI_CR1_SPE                 (1UL << 6)
+#define SPI_CR1_SSI                 (1UL << 8)
+#define SPI_CR1_SSM                 (1UL << 9)
+#define SPI_CR2_DS_8BIT             (7UL << 8)
+#define SPI_CR2_FRXTH               (1UL << 12)
+#define SPI_SR_RXNE                 (1UL << 0)
+#define SPI_SR_TXE                  (1UL << 1)
+
+#define CYCLES_PER_US               (CPU_FREQUENCY_HZ / 1000000UL)
+
+#ifdef HAL_CC1101_SIMULATOR
+/* Host build (scripts/bench): SPI1, the chip, the GDO lines and the cycle counter are simulated */
+#include "cc1101_sim.h"
+#else
+/* Cycle counter used for timeouts */
+#define DWT_CTRL                    (*(volatile uint32_t *)0xE0001000UL)
+#define DWT_CYCCNT                  (*(volatile uint32_t *)0xE0001004UL)
+#define DWT_CTRL_CYCCNTENA          (1UL << 0)
+#define DEMCR                       (*(volatile uint32_t *)0xE000EDFCUL)
+#define DEMCR_TRCENA                (1UL << 24)
+
+#define CC1101_REG(offset)          (*(volatile uint32_t *)(CC1101_SPI_BASE + (offset)))
+#define CC1101_DR8                  (*(volatile uint8_t *)(CC1101_SPI_BASE + SPI_DR_OFFSET))
+#endif
+
+/**
+ * @brief FIFO transfer in progress
+ */
+typedef enum {
+    CC1101_XFER_NONE = 0,
+    CC1101_XFER_TX,
+    CC1101_XFER_RX,
+    CC1101_XFER_CAPTURE,
+    CC1101_XFER_SAMPLE,                     /**< GDO0 sampled by DMA, no edge interrupt */
+    CC1101_XFER_QUEUED                      /**< Async requests queued, none on air */
+} cc1101_xfer_t;
+
+/**
+ * @brief What the deadline timer is armed for
+ */
+typedef enum {
+    CC1101_PHASE_DELAY = 0,                 /**< Turnaround before the head request */
+    CC1101_PHASE_CCA,                       /**< Receiving until the RSSI is valid for a channel check */
+    CC1101_PHASE_WINDOW                     /**< End of the receive window */
+} cc1101_phase_t;
+
+/**
+ * @brief Queued async request
+ */
+typedef struct {
+    hal_radio_request_t handle;
+    hal_radio_packet_t *packet;
+    hal_radio_request_options_t options;
+    bool transmit;
+} cc1101_request_t;
+
+/**
+ * @brief Scan plan channel with its cached calibration
+ */
+typedef struct {
+    uint8_t freq[3];                        /**< FREQ2..0 */
+    uint8_t fscal[3];                       /**< FSCAL3..1 after calibrating on this frequency */
+    bool valid;                             /**< Frequency inside a synthesizer band */
+} cc1101_channel_t;
+
+/**
+ * @brief CC1101 hardware context
+ *
+ * Packet data moves directly between the caller's buffer and the chip
+ * FIFOs; only the position within the packet is kept here.
+ */
+typedef struct {
+    uint32_t cs_pin;                        /**< Chip select GPIO pin */
+    uint32_t gdo0_pin;                      /**< GDO0 GPIO pin (FIFO threshold) */
+    uint32_t gdo2_pin;                      /**< GDO2 GPIO pin (sync word / end of packet) */
+    uint8_t shadow[CC1101_CONFIG_REGISTERS]; /**< Last values written to the configuration registers */
+    uint8_t patable[2];                     /**< Last values written to PATABLE[0..1] */
+    uint8_t pktctrl0;                       /**< Whitening and CRC bits; length mode is per packet */
+    volatile uint8_t xfer;                  /**< cc1101_xfer_t */
+    volatile hal_result_t xfer_result;      /**< Outcome of the last transfer */
+    bool variable;                          /**< Length byte precedes the payload */
+    bool infinite;                          /**< Infinite length mode until the last wrap */
+    bool have_length;                       /**< RX length byte read */
+    const uint8_t *tx_data;                 /**< Caller's TX payload */
+    hal_radio_packet_t *rx_packet;          /**< Caller's RX packet */
+    uint32_t length;                        /**< Payload length */
+    uint32_t position;                      /**< Payload bytes moved so far */
+    uint32_t edge_cycles;                   /**< Raw capture: cycle count of the last edge */
+    hal_radio_scan_plan_t plan;             /**< Current scan plan, channel_count 0 if none */
+    cc1101_channel_t channels[HAL_RADIO_CHANNELS]; /**< Calibration cache for the scan plan */
+    cc1101_request_t queue[HAL_RADIO_REQUEST_QUEUE]; /**< Async requests; the head one is running */
+    uint8_t queue_head;                     /**< Index of the head request */
+    volatile uint8_t queue_count;           /**< Requests in the queue */
+    volatile uint8_t phase;                 /**< cc1101_phase_t */
+    uint8_t cca_attempts;                   /**< Busy channel checks for the head request */
+    volatile bool sync_seen;                /**< Sync word received in the current RX */
+    bool start_late;                        /**< Head request's start time had passed when it was prepared */
+    volatile bool wor;                      /**< Wake-on-radio: re-enter the polling sequence after each packet */
+    uint16_t wor_capacity;                  /**< Wake-on-radio: size of the packet buffer */
+    uint8_t wor_agcctrl1;                   /**< AGCCTRL1 before wake-on-radio changed the carrier sense */
+    hal_radio_request_t next_handle;
+    hal_radio_completion_t completion;      /**< Event data for the request being reported */
+} hal_radio_cc1101_context_t;
+
+/* Base register file written after reset (SmartRF defaults, 433.92 MHz 2-FSK) */
+static const uint8_t cc1101_base_registers[CC1101_CONFIG_REGISTERS] = {
+    CC1101_GDO_SYNC_WORD,   /* IOCFG2 */
+    0x2E,                   /* IOCFG1: high impedance */
+    CC1101_GDO_TX_THRESHOLD,/* IOCFG0 */
+    CC1101_FIFOTHR_33_32,   /* FIFOTHR */
+    0xD3, 0x91,             /* SYNC1, SYNC0 */
+    0xFF,                   /* PKTLEN */
+    CC1101_PKTCTRL1_APPEND, /* PKTCTRL1 */
+    0x45,                   /* PKTCTRL0: whitening, CRC, variable length */
+    0x00, 0x00,             /* ADDR, CHANNR */
+    0x06, 0x00,             /* FSCTRL1, FSCTRL0 */
+    0x10, 0xB0, 0x71,       /* FREQ2..0: 433.92 MHz */
+    0xC7, 0x83, 0x03,       /* MDMCFG4..2: 100 kHz, 4.8 kBaud, 2-FSK, 30/32 sync */
+    0x22, 0xF8,             /* MDMCFG1, MDMCFG0: 4 preamble bytes */
+    0x34,                   /* DEVIATN: 19 kHz */
+    0x07,                   /* MCSM2 */
+    0x30,                   /* MCSM1: CCA unless receiving, IDLE after RX and TX */
+    0x18,                   /* MCSM0: calibrate from IDLE to RX/TX */
+    0x16, 0x6C,             /* FOCCFG, BSCFG */
+    0x43, 0x40, 0x91,       /* AGCCTRL2..0 */
+    0x87, 0x6B, 0xFB,       /* WOREVT1, WOREVT0, WORCTRL */
+    0x56, 0x10,             /* FREND1, FREND0 */
+    0xE9, 0x2A, 0x00, 0x1F, /* FSCAL3..0 */
+    0x41, 0x00,             /* RCCTRL1, RCCTRL0 */
+    0x59, 0x7F, 0x3F,       /* FSTEST, PTEST, AGCTEST */
+    0x81, 0x35, 0x09        /* TEST2..0 */
+};
+
+/**
+ * @brief Configuration profile
+ *
+ * Register values are precomputed with the same formulas cc1101_configure()
+ * uses, from the fields kept alongside, plus the AGC and front end
+ * settings that suit the modulation. Frequency and power come from the
+ * caller.
+ */
+#define CC1101_PRESET_REGISTERS     13
+
+typedef struct {
+    uint8_t addr;
+    uint8_t value;
+} cc1101_reg_t;
+
+typedef struct {
+    hal_radio_modulation_t modulation;
+    uint32_t data_rate_bps;
+    uint32_t deviation_hz;
+    uint32_t bandwidth_hz;
+    cc1101_reg_t regs[CC1101_PRESET_REGISTERS];
+} cc1101_preset_t;
+
+/* Sync word 0xD391 (16/16), variable length with CRC, no whitening */
+#define CC1101_PRESET_PACKET(mdmcfg2) \
+    { CC1101_SYNC1, 0xD3 }, { CC1101_SYNC0, 0x91 }, \
+    { CC1101_PKTCTRL0, CC1101_PKTCTRL0_CRC | CC1101_LENGTH_VARIABLE }, { CC1101_MDMCFG2, (mdmcfg2) }
+
+static const cc1101_preset_t cc1101_presets[HAL_RADIO_PRESET_MAX] = {
+    [HAL_RADIO_PRESET_OOK_270KHZ] = {
+        HAL_RADIO_MODULATION_OOK, 3794, 0, 270833, {
+            CC1101_PRESET_PACKET(0x32),
+            { CC1101_MDMCFG4, 0x67 }, { CC1101_MDMCFG3, 0x32 },     /* 270 kHz, 3.79 kBaud */
+            { CC1101_DEVIATN, 0x35 },
+            { CC1101_FOCCFG, 0x18 }, { CC1101_AGCCTRL2, 0x03 },
+            { CC1101_AGCCTRL1, 0x00 }, { CC1101_AGCCTRL0, 0x91 },
+            { CC1101_FREND1, 0xB6 }, { CC1101_FREND0, 0x11 }
+        }
+    },
+    [HAL_RADIO_PRESET_OOK_650KHZ] = {
+        HAL_RADIO_MODULATION_OOK, 3794, 0, 650000, {
+            CC1101_PRESET_PACKET(0x32),
+            { CC1101_MDMCFG4, 0x17 }, { CC1101_MDMCFG3, 0x32 },     /* 650 kHz, 3.79 kBaud */
+            { CC1101_DEVIATN, 0x35 },
+            { CC1101_FOCCFG, 0x18 }, { CC1101_AGCCTRL2, 0x07 },
+            { CC1101_AGCCTRL1, 0x00 }, { CC1101_AGCCTRL0, 0x91 },
+            { CC1101_FREND1, 0xB6 }, { CC1101_FREND0, 0x11 }
+        }
+    },
+    [HAL_RADIO_PRESET_2FSK_DEV2_38KHZ] = {
+        HAL_RADIO_MODULATION_FSK, 4798, 2380, 270833, {
+            CC1101_PRESET_PACKET(0x02),
+            { CC1101_MDMCFG4, 0x67 }, { CC1101_MDMCFG3, 0x83 },     /* 270 kHz, 4.8 kBaud */
+            { CC1101_DEVIATN, 0x04 },                               /* 2.38 kHz */
+            { CC1101_FOCCFG, 0x16 }, { CC1101_AGCCTRL2, 0x43 },
+            { CC1101_AGCCTRL1, 0x40 }, { CC1101_AGCCTRL0, 0x91 },
+            { CC1101_FREND1, 0xB6 }, { CC1101_FREND0, 0x10 }
+        }
+    },
+    [HAL_RADIO_PRESET_2FSK_DEV47_6KHZ] = {
+        HAL_RADIO_MODULATION_FSK, 4798, 47607, 270833, {
+            CC1101_PRESET_PACKET(0x02),
+            { CC1101_MDMCFG4, 0x67 }, { CC1101_MDMCFG3, 0x83 },     /* 270 kHz, 4.8 kBaud */
+            { CC1101_DEVIATN, 0x47 },                               /* 47.6 kHz */
+            { CC1101_FOCCFG, 0x16 }, { CC1101_AGCCTRL2, 0x43 },
+            { CC1101_AGCCTRL1, 0x40 }, { CC1101_AGCCTRL0, 0x91 },
+            { CC1101_FREND1, 0xB6 }, { CC1101_FREND0, 0x10 }
+        }
+    },
+    [HAL_RADIO_PRESET_GFSK_38K4] = {
+        HAL_RADIO_MODULATION_GFSK, 38383, 20630, 101562, {
+            CC1101_PRESET_PACKET(0x12),
+            { CC1101_MDMCFG4, 0xCA }, { CC1101_MDMCFG3, 0x83 },     /* 101 kHz, 38.4 kBaud */
+            { CC1101_DEVIATN, 0x35 },                               /* 20.6 kHz */
+            { CC1101_FOCCFG, 0x16 }, { CC1101_AGCCTRL2, 0x43 },
+            { CC1101_AGCCTRL1, 0x40 }, { CC1101_AGCCTRL0, 0x91 },
+            { CC1101_FREND1, 0x56 }, { CC1101_FREND0, 0x10 }
+        }
+    }
+};
+
+/* PA settings per hal_radio_power_t: -30, -20, -10, 0, +10 dBm */
+static const uint8_t cc1101_pa_433[HAL_RADIO_POWER_LEVELS] = { 0x12, 0x0E, 0x34, 0x60, 0xC0 };
+static const uint8_t cc1101_pa_868[HAL_RADIO_POWER_LEVELS] = { 0x03, 0x0F, 0x27, 0x50, 0xC2 };
+
+/* Static function prototypes */
+static hal_result_t cc1101_hardware_init(hal_radio_cc1101_context_t *ctx);
+static uint8_t cc1101_spi_transfer(uint8_t value);
+static hal_result_t cc1101_access(const hal_radio_cc1101_context_t *ctx, uint8_t header,
+                                  const uint8_t *tx, uint8_t *rx, uint32_t count);
+static hal_result_t cc1101_strobe(const hal_radio_cc1101_context_t *ctx, uint8_t command);
+static hal_result_t cc1101_write(hal_radio_cc1101_context_t *ctx, uint8_t addr, uint8_t value);
+static hal_result_t cc1101_write_span(hal_radio_cc1101_context_t *ctx, uint8_t addr, const uint8_t *data,
+                                      uint32_t count);
+static hal_result_t cc1101_write_image(hal_radio_instance_t *instance, uint8_t *image, uint32_t frequency_hz,
+                                       hal_radio_power_t power_level);
+static bool cc1101_frequency_valid(uint32_t frequency_hz);
+static hal_result_t cc1101_read_status(const hal_radio_cc1101_context_t *ctx, uint8_t addr, uint8_t *value);
+static hal_result_t cc1101_idle(const hal_radio_cc1101_context_t *ctx);
+static hal_result_t cc1101_wait_state(const hal_radio_cc1101_context_t *ctx, uint8_t marcstate);
+static void cc1101_delay_us(uint32_t us);
+static int8_t cc1101_rssi_dbm(uint8_t raw);
+static void cc1101_patable(uint32_t frequency_hz, hal_radio_power_t power_level, bool ook, uint8_t *patable);
+static hal_result_t cc1101_write_patable(hal_radio_cc1101_context_t *ctx, const uint8_t *patable);
+static hal_result_t cc1101_wait_done(hal_radio_cc1101_context_t *ctx, uint32_t timeout_ms);
+static hal_result_t cc1101_prepare_tx(hal_radio_instance_t *instance, const hal_radio_packet_t *packet);
+static hal_result_t cc1101_prepare_rx(hal_radio_instance_t *instance, hal_radio_packet_t *packet);
+static void cc1101_queue_next(hal_radio_instance_t *instance, uint32_t reference_us);
+static void cc1101_queue_fire(hal_radio_instance_t *instance);
+static void cc1101_queue_retire(hal_radio_instance_t *instance, hal_result_t result);
+static void cc1101_record_jitter(hal_radio_instance_t *instance, uint32_t start_us, bool late);
+static void cc1101_timer_isr(void *user_data);
+static hal_result_t cc1101_set_length_mode(hal_radio_cc1101_context_t *ctx, uint32_t length);
+static void cc1101_start(hal_radio_instance_t *instance, cc1101_xfer_t xfer, uint8_t strobe);
+static void cc1101_abort(hal_radio_instance_t *instance, uint8_t flush);
+static void cc1101_wor_sleep(hal_radio_instance_t *instance);
+static void cc1101_wor_end(hal_radio_cc1101_context_t *ctx);
+static void cc1101_finish(hal_radio_instance_t *instance, hal_result_t result, hal_radio_event_t event,
+                          void *data);
+static void cc1101_tx_refill(hal_radio_instance_t *instance);
+static void cc1101_rx_drain(hal_radio_instance_t *instance, bool end);
+static void cc1101_gdo0_isr(uint32_t pin, void *user_data);
+static void cc1101_gdo2_isr(uint32_t pin, void *user_data);
+static void cc1101_capture_isr(uint32_t pin, void *user_data);
+static uint8_t cc1101_drate(uint32_t rate, uint8_t *mantissa);
+static uint8_t cc1101_chanbw(uint32_t bandwidth);
+static uint8_t cc1101_deviatn(uint32_t deviation);
+
+/**
+ * @brief Initialize CC1101 radio
+ */
+hal_result_t cc1101_init(hal_radio_instance_t *instance)
+{
+    if (instance == NULL) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    /* Allocate CC1101 context */
+    hal_radio_cc1101_context_t *ctx = malloc(sizeof(hal_radio_cc1101_context_t));
+    if (ctx == NULL) {
+        return HAL_ERROR_NO_MEMORY;
+    }
+
+    memset(ctx, 0, sizeof(hal_radio_cc1101_context_t));
+    ctx->cs_pin = CC1101_PIN_CS;
+    ctx->gdo0_pin = CC1101_PIN_GDO0;
+    ctx->gdo2_pin = CC1101_PIN_GDO2;
+    ctx->pktctrl0 = CC1101_PKTCTRL0_WHITE | CC1101_PKTCTRL0_CRC;
+    ctx->patable[0] = cc1101_pa_433[HAL_RADIO_POWER_HIGH];
+    ctx->patable[1] = ctx->patable[0];
+
+    hal_result_t result = cc1101_hardware_init(ctx);
+
+    /* Reset, then check that a CC1101 answers (accesses wait for CHIP_RDYn) */
+    uint8_t partnum = 0xFF;
+    uint8_t version = 0;
+    if (result == HAL_OK) {
+        result = cc1101_strobe(ctx, CC1101_SRES);
+    }
+    if (result == HAL_OK) {
+        result = cc1101_read_status(ctx, CC1101_PARTNUM, &partnum);
+    }
+    if (result == HAL_OK) {
+        result = cc1101_read_status(ctx, CC1101_VERSION, &version);
+    }
+    if (result == HAL_OK && (partnum != 0x00 || version == 0x00 || version == 0xFF)) {
+        result = HAL_ERROR_RESOURCE_NOT_FOUND;
+    }
+
+    /* Whole register file in one burst; from here on the shadow tracks it */
+    if (result == HAL_OK) {
+        result = cc1101_access(ctx, CC1101_IOCFG2 | CC1101_BURST, cc1101_base_registers, NULL,
+                               sizeof(cc1101_base_registers));
+    }
+    if (result == HAL_OK) {
+        result = cc1101_access(ctx, CC1101_PATABLE | CC1101_BURST, ctx->patable, NULL, sizeof(ctx->patable));
+    }
+    memcpy(ctx->shadow, cc1101_base_registers, sizeof(ctx->shadow));
+
+    if (result != HAL_OK) {
+        free(ctx);
+        return result;
+    }
+
+    instance->hw_context = ctx;
+    return HAL_OK;
+}
+
+/**
+ * @brief Deinitialize CC1101 radio
+ */
+hal_result_t cc1101_deinit(hal_radio_instance_t *instance)
+{
+    if (instance == NULL || instance->hw_context == NULL) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    hal_radio_cc1101_context_t *ctx = instance->hw_context;
+
+    if (ctx->xfer != CC1101_XFER_NONE) {
+        cc1101_abort(instance, ctx->xfer == CC1101_XFER_TX ? CC1101_SFTX : CC1101_SFRX);
+    }
+
+    cc1101_idle(ctx);
+    cc1101_strobe(ctx, CC1101_SPWD);
+    hal_gpio_release_pin(ctx->gdo0_pin);
+    hal_gpio_release_pin(ctx->gdo2_pin);
+    hal_gpio_release_pin(ctx->cs_pin);
+
+    free(instance->hw_context);
+    instance->hw_context = NULL;
+    return HAL_OK;
+}
+
+/**
+ * @brief Configure CC1101 radio
+ *
+ * The register values are worked out on a copy of the shadow register file
+ * and only the registers that end up different are written, so changing
+ * just the frequency or the power level costs one short burst.
+ */
+hal_result_t cc1101_configure(hal_radio_instance_t *instance, const hal_radio_config_t *config)
+{
+    if (instance == NULL || config == NULL || instance->hw_context == NULL) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    hal_radio_cc1101_context_t *ctx = instance->hw_context;
+
+    if (!cc1101_frequency_valid(config->frequency_hz) ||
+        config->modulation >= HAL_RADIO_MODULATION_MAX || config->power_level >= HAL_RADIO_POWER_LEVELS ||
+        config->packet_format >= HAL_RADIO_PACKET_MAX || config->sync_word_length > 4 ||
+        (config->data_rate_bps != 0 && (config->data_rate_bps < 600 || config->data_rate_bps > 500000))) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    if (ctx->xfer != CC1101_XFER_NONE) {
+        return HAL_ERROR_RESOURCE_BUSY;
+    }
+
+    uint32_t rate = config->data_rate_bps ? config->data_rate_bps : CC1101_DEFAULT_DATA_RATE;
+    uint8_t drate_m;
+    uint8_t drate_e = cc1101_drate(rate, &drate_m);
+    uint8_t mod_format;
+    uint8_t sync_mode;
+    bool ook = (config->modulation == HAL_RADIO_MODULATION_ASK ||
+                config->modulation == HAL_RADIO_MODULATION_OOK);
+
+    switch (config->modulation) {
+        case HAL_RADIO_MODULATION_GFSK: mod_format = 0x10; break;
+        case HAL_RADIO_MODULATION_MSK:  mod_format = 0x70; break;
+        case HAL_RADIO_MODULATION_ASK:
+        case HAL_RADIO_MODULATION_OOK:  mod_format = 0x30; break;
+        case HAL_RADIO_MODULATION_FSK:
+        default:                        mod_format = 0x00; break;
+    }
+
+    /* The chip matches 16 bits, or the same 16 bits twice (30 of 32) */
+    if (config->sync_word_length == 0) {
+        sync_mode = 0x00;
+    } else if (config->sync_word_length <= 2) {
+        sync_mode = 0x02;
+    } else {
+        sync_mode = 0x03;
+    }
+
+    ctx->pktctrl0 = (config->whitening_enabled ? CC1101_PKTCTRL0_WHITE : 0) |
+                    (config->crc_enabled ? CC1101_PKTCTRL0_CRC : 0);
+
+    uint8_t image[CC1101_CONFIG_REGISTERS];
+    memcpy(image, ctx->shadow, sizeof(image));
+    image[CC1101_SYNC1] = config->sync_word[0];
+    image[CC1101_SYNC0] = (config->sync_word_length >= 2) ? config->sync_word[1] : config->sync_word[0];
+    image[CC1101_PKTCTRL0] = ctx->pktctrl0 | CC1101_LENGTH_VARIABLE;
+    image[CC1101_MDMCFG4] = cc1101_chanbw(config->bandwidth_hz ? config->bandwidth_hz
+                                                               : CC1101_DEFAULT_BANDWIDTH) | drate_e;
+    image[CC1101_MDMCFG3] = drate_m;
+    image[CC1101_MDMCFG2] = mod_format | sync_mode;
+    image[CC1101_DEVIATN] = cc1101_deviatn(config->deviation_hz ? config->deviation_hz
+                                                                : CC1101_DEFAULT_DEVIATION);
+    image[CC1101_FREND0] = ook ? 0x11 : 0x10;
+
+    return cc1101_write_image(instance, image, config->frequency_hz, config->power_level);
+}
+
+/**
+ * @brief Switch to a precomputed configuration profile
+ *
+ * The preset's registers are laid over the shadow register file and the
+ * result goes through the same delta write as cc1101_configure(), so
+ * switching between presets only touches the registers that differ.
+ */
+hal_result_t cc1101_apply_preset(hal_radio_instance_t *instance, hal_radio_preset_t preset,
+                                 uint32_t frequency_hz, hal_radio_config_t *config)
+{
+    if (instance == NULL || instance->hw_context == NULL || config == NULL ||
+        preset >= HAL_RADIO_PRESET_MAX || !cc1101_frequency_valid(frequency_hz) ||
+        config->power_level >= HAL_RADIO_POWER_LEVELS) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    hal_radio_cc1101_context_t *ctx = instance->hw_context;
+
+    if (ctx->xfer != CC1101_XFER_NONE) {
+        return HAL_ERROR_RESOURCE_BUSY;
+    }
+
+    const cc1101_preset_t *p = &cc1101_presets[preset];
+    uint8_t image[CC1101_CONFIG_REGISTERS];
+
+    memcpy(image, ctx->shadow, sizeof(image));
+    for (uint32_t i = 0; i < CC1101_PRESET_REGISTERS; i++) {
+        image[p->regs[i].addr] = p->regs[i].value;
+    }
+
+    hal_result_t result = cc1101_write_image(instance, image, frequency_hz, config->power_level);
+    if (result != HAL_OK) {
+        return result;
+    }
+
+    /* Describe the preset so a later hal_radio_configure() reproduces it */
+    ctx->pktctrl0 = CC1101_PKTCTRL0_CRC;
+    config->type = HAL_RADIO_TYPE_CC1101;
+    config->frequency_hz = frequency_hz;
+    config->data_rate_bps = p->data_rate_bps;
+    config->modulation = p->modulation;
+    config->deviation_hz = p->deviation_hz;
+    config->bandwidth_hz = p->bandwidth_hz;
+    config->packet_format = HAL_RADIO_PACKET_VARIABLE_LENGTH;
+    config->sync_word[0] = 0xD3;
+    config->sync_word[1] = 0x91;
+    config->sync_word_length = 2;
+    config->crc_enabled = true;
+    config->whitening_enabled = false;
+
+    return HAL_OK;
+}
+
+/**
+ * @brief Set the scan plan and fill the calibration cache
+ *
+ * Each channel is calibrated once with SCAL and FSCAL3..1 are read back,
+ * following the CC1101 fast frequency hopping scheme: a hop then only
+ * writes FREQ2..0 and FSCAL3..1 and enters RX without the ~720 us
+ * calibration.
+ */
+hal_result_t cc1101_set_scan_plan(hal_radio_instance_t *instance, const hal_radio_scan_plan_t *plan)
+{
+    if (instance == NULL || instance->hw_context == NULL || plan == NULL ||
+        plan->channel_count == 0 || plan->channel_count > HAL_RADIO_CHANNELS) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    hal_radio_cc1101_context_t *ctx = instance->hw_context;
+
+    if (ctx->xfer != CC1101_XFER_NONE) {
+        return HAL_ERROR_RESOURCE_BUSY;
+    }
+
+    uint8_t freq_saved[3];
+    uint8_t mcsm0 = (ctx->shadow[CC1101_MCSM0] & (uint8_t)~CC1101_MCSM0_AUTOCAL_MASK) | CC1101_MCSM0_AUTOCAL_IDLE;
+
+    memcpy(freq_saved, &ctx->shadow[CC1101_FREQ2], sizeof(freq_saved));
+    ctx->plan.channel_count = 0;
+
+    hal_result_t result = cc1101_idle(ctx);
+    instance->state = HAL_RADIO_STATE_IDLE;
+
+    for (uint32_t i = 0; i < plan->channel_count && result == HAL_OK; i++) {
+        cc1101_channel_t *channel = &ctx->channels[i];
+        uint64_t frequency = plan->start_hz + (uint64_t)plan->step_hz * i;
+
+        channel->valid = (frequency <= UINT32_MAX) && cc1101_frequency_valid((uint32_t)frequency);
+        if (!channel->valid) {
+            continue;
+        }
+
+        uint32_t freq = (uint32_t)(((frequency << 16) + CC1101_XOSC_HZ / 2) / CC1101_XOSC_HZ);
+        channel->freq[0] = (uint8_t)(freq >> 16);
+        channel->freq[1] = (uint8_t)(freq >> 8);
+        channel->freq[2] = (uint8_t)freq;
+
+        result = cc1101_write_span(ctx, CC1101_FREQ2, channel->freq, sizeof(channel->freq));
+        if (result == HAL_OK) {
+            result = cc1101_strobe(ctx, CC1101_SCAL);
+        }
+        if (result == HAL_OK) {
+            result = cc1101_wait_state(ctx, CC1101_MARC_IDLE);
+        }
+        if (result == HAL_OK) {
+            result = cc1101_access(ctx, CC1101_FSCAL3 | CC1101_READ | CC1101_BURST, NULL, channel->fscal,
+                                   sizeof(channel->fscal));
+        }
+    }
+
+    /* Back on the configured frequency, calibrating on the way to RX/TX */
+    if (result == HAL_OK) {
+        result = cc1101_write_span(ctx, CC1101_FREQ2, freq_saved, sizeof(freq_saved));
+    }
+    if (result == HAL_OK) {
+        result = cc1101_write(ctx, CC1101_MCSM0, mcsm0);
+    }
+    if (result == HAL_OK) {
+        ctx->plan = *plan;
+    }
+
+    return result;
+}
+
+/**
+ * @brief Retune to a plan channel from its cached calibration and enter RX
+ */
+hal_result_t cc1101_hop(hal_radio_instance_t *instance, uint16_t channel)
+{
+    if (instance == NULL || instance->hw_context == NULL) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    hal_radio_cc1101_context_t *ctx = instance->hw_context;
+
+    if (channel >= ctx->plan.channel_count || !ctx->channels[channel].valid) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    if (ctx->xfer != CC1101_XFER_NONE) {
+        return HAL_ERROR_RESOURCE_BUSY;
+    }
+
+    const cc1101_channel_t *entry = &ctx->channels[channel];
+    uint32_t frequency_hz = ctx->plan.start_hz + ctx->plan.step_hz * channel;
+    uint8_t mcsm0 = (ctx->shadow[CC1101_MCSM0] & (uint8_t)~CC1101_MCSM0_AUTOCAL_MASK) | CC1101_MCSM0_AUTOCAL_NEVER;
+    uint8_t patable[2];
+
+    cc1101_patable(frequency_hz, instance->config.power_level,
+                   (ctx->shadow[CC1101_MDMCFG2] & 0x70) == 0x30, patable);
+
+    hal_result_t result = cc1101_idle(ctx);
+    if (result == HAL_OK) {
+        result = cc1101_write(ctx, CC1101_MCSM0, mcsm0);
+    }
+    if (result == HAL_OK) {
+        result = cc1101_write_span(ctx, CC1101_FREQ2, entry->freq, sizeof(entry->freq));
+    }
+    if (result == HAL_OK) {
+        /* Always written: the shadow cannot know what the last calibration left */
+        result = cc1101_access(ctx, CC1101_FSCAL3 | CC1101_BURST, entry->fscal, NULL, sizeof(entry->fscal));
+    }
+    if (result == HAL_OK) {
+        memcpy(&ctx->shadow[CC1101_FSCAL3], entry->fscal, sizeof(entry->fscal));
+        result = cc1101_write_patable(ctx, patable);
+    }
+    if (result == HAL_OK) {
+        result = cc1101_strobe(ctx, CC1101_SRX);
+    }
+
+    if (result != HAL_OK) {
+        instance->state = HAL_RADIO_STATE_ERROR;
+        return result;
+    }
+
+    instance->config.frequency_hz = frequency_hz;
+    instance->state = HAL_RADIO_STATE_RX;
+    return HAL_OK;
+}
+
+/**
+ * @brief Read the RSSI register
+ */
+hal_result_t cc1101_get_rssi(hal_radio_instance_t *instance, int8_t *rssi_dbm)
+{
+    if (instance == NULL || instance->hw_context == NULL || rssi_dbm == NULL) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    hal_radio_cc1101_context_t *ctx = instance->hw_context;
+    uint8_t raw;
+
+    if (ctx->xfer != CC1101_XFER_NONE) {
+        return HAL_ERROR_RESOURCE_BUSY;
+    }
+
+    hal_result_t result = cc1101_read_status(ctx, CC1101_RSSI, &raw);
+    if (result == HAL_OK) {
+        *rssi_dbm = cc1101_rssi_dbm(raw);
+    }
+
+    return result;
+}
+
+/**
+ * @brief Hop across the plan, sampling RSSI for each channel's dwell
+ *
+ * Samples start once the receiver is running and the RSSI has settled;
+ * the average is taken in dB.
+ */
+hal_result_t cc1101_sweep(hal_radio_instance_t *instance, hal_radio_sweep_point_t *points, uint16_t max_points,
+                          uint16_t *count)
+{
+    if (instance == NULL || instance->hw_context == NULL || points == NULL || count == NULL) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    hal_radio_cc1101_context_t *ctx = instance->hw_context;
+    uint16_t total = (ctx->plan.channel_count < max_points) ? ctx->plan.channel_count : max_points;
+    hal_result_t result = HAL_OK;
+
+    *count = 0;
+    if (ctx->plan.channel_count == 0) {
+        return HAL_ERROR_NOT_INITIALIZED;
+    }
+
+    for (uint16_t i = 0; i < total && result == HAL_OK; i++) {
+        hal_radio_sweep_point_t *point = &points[i];
+
+        point->frequency_hz = ctx->plan.start_hz + ctx->plan.step_hz * i;
+        point->rssi_dbm = HAL_RADIO_RSSI_INVALID;
+        point->peak_dbm = HAL_RADIO_RSSI_INVALID;
+
+        if (!ctx->channels[i].valid) {
+            continue;
+        }
+
+        result = cc1101_hop(instance, i);
+        if (result == HAL_OK) {
+            result = cc1101_wait_state(ctx, CC1101_MARC_RX);
+        }
+        if (result != HAL_OK) {
+            break;
+        }
+
+        cc1101_delay_us(CC1101_RSSI_SETTLE_US);
+
+        uint32_t start = DWT_CYCCNT;
+        int32_t sum = 0;
+        int32_t samples = 0;
+        int8_t peak = HAL_RADIO_RSSI_INVALID;
+
+        do {
+            int8_t rssi;
+            result = cc1101_get_rssi(instance, &rssi);
+            if (result != HAL_OK) {
+                break;
+            }
+            sum += rssi;
+            samples++;
+            if (rssi > peak) {
+                peak = rssi;
+            }
+        } while ((DWT_CYCCNT - start) / CYCLES_PER_US < ctx->plan.dwell_us);
+
+        if (samples > 0) {
+            point->rssi_dbm = (int8_t)(sum / samples);
+            point->peak_dbm = peak;
+        }
+    }
+
+    if (result == HAL_OK) {
+        result = cc1101_idle(ctx);
+        instance->state = HAL_RADIO_STATE_IDLE;
+    }
+
+    *count = total;
+    return result;
+}
+
+/**
+ * @brief Transmit packet using CC1101
+ *
+ * The FIFO is filled before STX and refilled from the GDO0 interrupt each
+ * time it drains below the threshold, so any length streams without
+ * underflow as long as interrupts are serviced within ~30 byte times.
+ */
+hal_result_t cc1101_transmit(hal_radio_instance_t *instance, const hal_radio_packet_t *packet)
+{
+    if (instance == NULL || packet == NULL || instance->hw_context == NULL) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    hal_radio_cc1101_context_t *ctx = instance->hw_context;
+
+    if (ctx->xfer != CC1101_XFER_NONE) {
+        return HAL_ERROR_RESOURCE_BUSY;
+    }
+
+    hal_result_t result = cc1101_prepare_tx(instance, packet);
+    if (result != HAL_OK) {
+        return result;
+    }
+
+    cc1101_start(instance, CC1101_XFER_TX, CC1101_STX);
+
+    /* Air time of preamble, sync, length, payload and CRC, plus margin */
+    uint32_t rate = instance->config.data_rate_bps ? instance->config.data_rate_bps : CC1101_DEFAULT_DATA_RATE;
+    uint32_t timeout_ms = (uint32_t)(((uint64_t)(ctx->length + 16) * 8 * 1000) / rate) + CC1101_TX_MARGIN_MS;
+
+    result = cc1101_wait_done(ctx, timeout_ms);
+    if (result != HAL_OK) {
+        cc1101_abort(instance, CC1101_SFTX);
+        return result;
+    }
+
+    return ctx->xfer_result;
+}
+
+/**
+ * @brief Receive packet using CC1101
+ *
+ * packet->data and packet->length give the buffer and its size. In
+ * variable length format the packet's length byte decides how much is
+ * received; in the other formats exactly packet->length bytes are.
+ */
+hal_result_t cc1101_receive(hal_radio_instance_t *instance, hal_radio_packet_t *packet, uint32_t timeout_ms)
+{
+    if (instance == NULL || packet == NULL || instance->hw_context == NULL ||
+        packet->data == NULL || packet->length == 0) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    hal_radio_cc1101_context_t *ctx = instance->hw_context;
+
+    if (ctx->xfer != CC1101_XFER_NONE) {
+        return HAL_ERROR_RESOURCE_BUSY;
+    }
+
+    hal_result_t result = cc1101_prepare_rx(instance, packet);
+    if (result != HAL_OK) {
+        return result;
+    }
+
+    cc1101_start(instance, CC1101_XFER_RX, CC1101_SRX);
+
+    result = cc1101_wait_done(ctx, timeout_ms);
+    if (result != HAL_OK) {
+        cc1101_abort(instance, CC1101_SFRX);
+        hal_radio_notify(instance, HAL_RADIO_EVENT_RX_TIMEOUT, NULL);
+        return result;
+    }
+
+    return ctx->xfer_result;
+}
+
+/**
+ * @brief Queue an async TX or RX request
+ *
+ * The first request of an empty queue is prepared and started from the
+ * caller's context; the rest are started by the interrupt handlers as
+ * each one completes.
+ */
+hal_result_t cc1101_submit(hal_radio_instance_t *instance, bool transmit, hal_radio_packet_t *packet,
+                           const hal_radio_request_options_t *options, hal_radio_request_t *request)
+{
+    if (instance == NULL || packet == NULL || instance->hw_context == NULL) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    hal_radio_cc1101_context_t *ctx = instance->hw_context;
+
+    if (transmit && instance->config.packet_format == HAL_RADIO_PACKET_VARIABLE_LENGTH && packet->length > 255) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    uint32_t primask = hal_radio_lock();
+
+    /* Only blocking transfers and captures keep the queue out */
+    bool idle = (ctx->xfer == CC1101_XFER_NONE);
+    if (!idle && ctx->xfer != CC1101_XFER_QUEUED && ctx->queue_count == 0) {
+        hal_radio_unlock(primask);
+        return HAL_ERROR_RESOURCE_BUSY;
+    }
+    if (ctx->queue_count >= HAL_RADIO_REQUEST_QUEUE) {
+        hal_radio_unlock(primask);
+        return HAL_ERROR_NO_MEMORY;
+    }
+
+    if (++ctx->next_handle == HAL_RADIO_REQUEST_NONE) {
+        ctx->next_handle++;
+    }
+
+    cc1101_request_t *entry = &ctx->queue[(ctx->queue_head + ctx->queue_count) % HAL_RADIO_REQUEST_QUEUE];
+    entry->handle = ctx->next_handle;
+    entry->packet = packet;
+    entry->transmit = transmit;
+    if (options != NULL) {
+        entry->options = *options;
+    } else {
+        memset(&entry->options, 0, sizeof(entry->options));
+    }
+    ctx->queue_count++;
+
+    if (request != NULL) {
+        *request = entry->handle;
+    }
+
+    /* Claimed under the lock; nothing else touches the chip until the request is started */
+    if (idle) {
+        ctx->xfer = CC1101_XFER_QUEUED;
+    }
+    hal_radio_unlock(primask);
+
+    if (idle) {
+        cc1101_queue_next(instance, hal_radio_timer_now());
+    }
+
+    return HAL_OK;
+}
+
+/**
+ * @brief Withdraw a queued async request that is not on air
+ */
+hal_result_t cc1101_cancel(hal_radio_instance_t *instance, hal_radio_request_t request)
+{
+    if (instance == NULL || instance->hw_context == NULL) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    hal_radio_cc1101_context_t *ctx = instance->hw_context;
+    uint32_t primask = hal_radio_lock();
+    uint32_t offset;
+
+    for (offset = 0; offset < ctx->queue_count; offset++) {
+        if (ctx->queue[(ctx->queue_head + offset) % HAL_RADIO_REQUEST_QUEUE].handle == request) {
+            break;
+        }
+    }
+
+    if (offset == ctx->queue_count) {
+        hal_radio_unlock(primask);
+        return HAL_ERROR_RESOURCE_NOT_FOUND;
+    }
+
+    if (offset > 0) {
+        /* Not started yet: close the gap */
+        for (; offset + 1U < ctx->queue_count; offset++) {
+            ctx->queue[(ctx->queue_head + offset) % HAL_RADIO_REQUEST_QUEUE] =
+                ctx->queue[(ctx->queue_head + offset + 1U) % HAL_RADIO_REQUEST_QUEUE];
+        }
+        ctx->queue_count--;
+        hal_radio_unlock(primask);
+        return HAL_OK;
+    }
+
+    /* The head request can only go while it waits out its delay */
+    if (ctx->xfer != CC1101_XFER_QUEUED || ctx->phase != CC1101_PHASE_DELAY) {
+        hal_radio_unlock(primask);
+        return HAL_ERROR_RESOURCE_BUSY;
+    }
+
+    hal_radio_timer_cancel(CC1101_TIMER_CHANNEL);
+    ctx->queue_head = (uint8_t)((ctx->queue_head + 1U) % HAL_RADIO_REQUEST_QUEUE);
+    ctx->queue_count--;
+    hal_radio_unlock(primask);
+
+    cc1101_idle(ctx);
+    cc1101_queue_next(instance, hal_radio_timer_now());
+    return HAL_OK;
+}
+
+/**
+ * @brief Start a raw capture of the demodulator output
+ *
+ * The chip runs in asynchronous serial mode with GDO0 carrying the
+ * demodulated signal; every edge is timed with the cycle counter and the
+ * pulse that ended goes to the capture pool.
+ */
+hal_result_t cc1101_start_capture(hal_radio_instance_t *instance)
+{
+    if (instance == NULL || instance->hw_context == NULL) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    hal_radio_cc1101_context_t *ctx = instance->hw_context;
+
+    if (ctx->xfer != CC1101_XFER_NONE) {
+        return HAL_ERROR_RESOURCE_BUSY;
+    }
+
+    hal_result_t result = hal_radio_capture_begin(instance);
+    if (result == HAL_OK) {
+        result = cc1101_idle(ctx);
+    }
+    if (result == HAL_OK) {
+        result = cc1101_write(ctx, CC1101_PKTCTRL0, CC1101_PKTCTRL0_ASYNC | CC1101_LENGTH_INFINITE);
+    }
+    if (result == HAL_OK) {
+        result = cc1101_write(ctx, CC1101_IOCFG0, CC1101_GDO_SERIAL_DATA);
+    }
+    if (result == HAL_OK) {
+        ctx->edge_cycles = DWT_CYCCNT;
+        result = hal_gpio_enable_interrupt(ctx->gdo0_pin, HAL_GPIO_TRIGGER_BOTH, cc1101_capture_isr, instance);
+    }
+    if (result == HAL_OK) {
+        result = cc1101_strobe(ctx, CC1101_SRX);
+    }
+
+    if (result != HAL_OK) {
+        hal_gpio_disable_interrupt(ctx->gdo0_pin);
+        hal_radio_capture_end(instance);
+        return result;
+    }
+
+    instance->state = HAL_RADIO_STATE_RX;
+    ctx->xfer = CC1101_XFER_CAPTURE;
+    return HAL_OK;
+}
+
+/**
+ * @brief Start sampling the demodulator output at a fixed rate
+ *
+ * Same asynchronous serial mode as a raw capture, but GDO0 is read by DMA
+ * into the sample ring for software demodulation instead of being timed
+ * edge by edge.
+ */
+hal_result_t cc1101_start_sampling(hal_radio_instance_t *instance, uint32_t sample_rate_hz)
+{
+    if (instance == NULL || instance->hw_context == NULL) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    hal_radio_cc1101_context_t *ctx = instance->hw_context;
+
+    if (ctx->xfer != CC1101_XFER_NONE) {
+        return HAL_ERROR_RESOURCE_BUSY;
+    }
+
+    hal_result_t result = cc1101_idle(ctx);
+    if (result == HAL_OK) {
+        result = cc1101_write(ctx, CC1101_PKTCTRL0, CC1101_PKTCTRL0_ASYNC | CC1101_LENGTH_INFINITE);
+    }
+    if (result == HAL_OK) {
+        result = cc1101_write(ctx, CC1101_IOCFG0, CC1101_GDO_SERIAL_DATA);
+    }
+    if (result == HAL_OK) {
+        result = hal_radio_sampler_begin(instance, ctx->gdo0_pin, sample_rate_hz);
+    }
+    if (result == HAL_OK) {
+        result = cc1101_strobe(ctx, CC1101_SRX);
+        if (result != HAL_OK) {
+            hal_radio_sampler_end(instance);
+        }
+    }
+
+    if (result != HAL_OK) {
+        return result;
+    }
+
+    instance->state = HAL_RADIO_STATE_RX;
+    ctx->xfer = CC1101_XFER_SAMPLE;
+    return HAL_OK;
+}
+
+/**
+ * @brief Stop a raw capture; filled buffers stay available to the consumer
+ */
+hal_result_t cc1101_stop_capture(hal_radio_instance_t *instance)
+{
+    if (instance == NULL || instance->hw_context == NULL) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    hal_radio_cc1101_context_t *ctx = instance->hw_context;
+
+    if (ctx->xfer != CC1101_XFER_CAPTURE) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    cc1101_abort(instance, CC1101_SFRX);
+    return HAL_OK;
+}
+
+/**
+ * @brief Copy the register shadow into an arbiter client's context
+ */
+void cc1101_save_context(hal_radio_instance_t *instance, hal_radio_context_t *context)
+{
+    hal_radio_cc1101_context_t *ctx = instance->hw_context;
+
+    memcpy(context->registers, ctx->shadow, sizeof(context->registers));
+    memcpy(context->patable, ctx->patable, sizeof(context->patable));
+    context->pktctrl0 = ctx->pktctrl0;
+}
+
+/**
+ * @brief Bring the chip back to a saved context
+ *
+ * Only registers that differ from the current shadow are written.
+ * FSCAL3..1 are left to calibration, which the restored MCSM0 runs on the
+ * next start: the saved values may belong to another client's frequency.
+ */
+hal_result_t cc1101_restore_context(hal_radio_instance_t *instance, const hal_radio_context_t *context)
+{
+    hal_radio_cc1101_context_t *ctx = instance->hw_context;
+    uint8_t image[CC1101_CONFIG_REGISTERS];
+
+    if (ctx->xfer != CC1101_XFER_NONE) {
+        return HAL_ERROR_RESOURCE_BUSY;
+    }
+
+    memcpy(image, context->registers, sizeof(image));
+    image[CC1101_MCSM0] = (image[CC1101_MCSM0] & (uint8_t)~CC1101_MCSM0_AUTOCAL_MASK) | CC1101_MCSM0_AUTOCAL_IDLE;
+
+    hal_result_t result = cc1101_idle(ctx);
+    instance->state = HAL_RADIO_STATE_IDLE;
+
+    if (result == HAL_OK) {
+        result = cc1101_write_span(ctx, 0, image, CC1101_FSCAL3);
+    }
+    if (result == HAL_OK) {
+        result = cc1101_write_span(ctx, CC1101_FSCAL0, &image[CC1101_FSCAL0],
+                                   CC1101_CONFIG_REGISTERS - CC1101_FSCAL0);
+    }
+    if (result == HAL_OK) {
+        result = cc1101_write_patable(ctx, context->patable);
+    }
+    if (result == HAL_OK) {
+        ctx->pktctrl0 = context->pktctrl0;
+    }
+
+    return result;
+}
+
+/**
+ * @brief Start duty-cycled reception on the chip's wake-on-radio timer
+ *
+ * The chip sleeps on its RC oscillator, wakes every EVENT0 period and
+ * listens for a window of RX_TIME; without a carrier (optionally) or a
+ * preamble/sync word it goes straight back to sleep, all without the MCU.
+ * GDO2 rises only on a sync word, so the MCU can stay in Stop mode until
+ * a packet is actually arriving.
+ */
+hal_result_t cc1101_start_wor(hal_radio_instance_t *instance, const hal_radio_wor_config_t *config,
+                              hal_radio_packet_t *packet, hal_radio_wor_timing_t *timing)
+{
+    if (instance == NULL || instance->hw_context == NULL || config == NULL || packet == NULL) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    hal_radio_cc1101_context_t *ctx = instance->hw_context;
+    static const uint8_t relative_db[4] = { 0, 6, 10, 14 };
+    uint8_t cs_relative = 0;
+
+    while (cs_relative < 4 && relative_db[cs_relative] != config->carrier_sense_relative_db) {
+        cs_relative++;
+    }
+    if (config->interval_ms < CC1101_WOR_MIN_MS || config->interval_ms > CC1101_WOR_MAX_MS ||
+        config->rx_window_us == 0 || cs_relative == 4 || config->preamble_quality > 7 ||
+        config->carrier_sense_absolute_db < -8 || config->carrier_sense_absolute_db > 7) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    if (ctx->xfer != CC1101_XFER_NONE) {
+        return HAL_ERROR_RESOURCE_BUSY;
+    }
+
+    /* EVENT0 = t * f_xosc / (750 * 2^(5 * WOR_RES)); WOR_RES 1 for periods past 16 bits */
+    uint64_t event0 = ((uint64_t)config->interval_ms * (CC1101_XOSC_HZ / 1000U) + 375U) / 750U;
+    uint32_t resolution = (event0 > 0xFFFFU) ? 1U : 0U;
+    event0 = (event0 + (resolution ? 16U : 0U)) >> (5U * resolution);
+    uint32_t interval_us = (uint32_t)((event0 * 750U * 1000000U << (5U * resolution)) / CC1101_XOSC_HZ);
+
+    /* RX window halves with each RX_TIME step (and once more at WOR_RES 1): shortest that is long enough */
+    uint32_t rx_time = 7;
+    uint32_t window_us = 0;
+    while (rx_time > 0 && window_us < config->rx_window_us) {
+        rx_time--;
+        window_us = (uint32_t)(((uint64_t)interval_us * CC1101_WOR_DUTY_PPM / 1000000U) >> (rx_time + resolution));
+    }
+
+    hal_result_t result = cc1101_prepare_rx(instance, packet);
+    if (result != HAL_OK) {
+        return result;
+    }
+
+    /* A preamble quality threshold also gates the sync word search */
+    uint8_t mcsm2 = (uint8_t)rx_time;
+    if (config->carrier_sense) {
+        mcsm2 |= CC1101_MCSM2_RX_TIME_RSSI;
+    }
+    if (config->preamble_quality > 0) {
+        mcsm2 |= CC1101_MCSM2_RX_TIME_QUAL;
+    }
+    uint8_t pktctrl1 = (uint8_t)((config->preamble_quality << CC1101_PKTCTRL1_PQT_SHIFT) | CC1101_PKTCTRL1_APPEND);
+    uint8_t agcctrl1 = (uint8_t)((ctx->shadow[CC1101_AGCCTRL1] & (uint8_t)~CC1101_AGCCTRL1_CS_MASK) |
+                                 (cs_relative << CC1101_AGCCTRL1_CS_REL_SHIFT) |
+                                 ((uint8_t)config->carrier_sense_absolute_db & 0x0FU));
+    uint8_t wor[3] = {
+        (uint8_t)(event0 >> 8), (uint8_t)event0,
+        (uint8_t)((CC1101_WOR_EVENT1 << CC1101_WORCTRL_EVENT1_SHIFT) | CC1101_WORCTRL_RC_CAL | resolution)
+    };
+
+    ctx->wor_agcctrl1 = ctx->shadow[CC1101_AGCCTRL1];
+    ctx->wor_capacity = packet->length;
+
+    result = cc1101_write(ctx, CC1101_MCSM2, mcsm2);
+    if (result == HAL_OK) {
+        result = cc1101_write(ctx, CC1101_PKTCTRL1, pktctrl1);
+    }
+    if (result == HAL_OK) {
+        result = cc1101_write(ctx, CC1101_AGCCTRL1, agcctrl1);
+    }
+    if (result == HAL_OK) {
+        result = cc1101_write_span(ctx, CC1101_WOREVT1, wor, sizeof(wor));
+    }
+    if (result == HAL_OK) {
+        result = cc1101_strobe(ctx, CC1101_SWORRST);
+    }
+    if (result != HAL_OK) {
+        cc1101_wor_end(ctx);
+        return result;
+    }
+
+    if (timing != NULL) {
+        timing->interval_us = interval_us;
+        timing->rx_window_us = window_us;
+        timing->duty_ppm = (uint32_t)((uint64_t)window_us * 1000000U / interval_us);
+    }
+
+    ctx->wor = true;
+    cc1101_start(instance, CC1101_XFER_RX, CC1101_SWOR);
+    return HAL_OK;
+}
+
+/**
+ * @brief Set CC1101 radio state with the matching command strobe
+ */
+hal_result_t cc1101_set_state(hal_radio_instance_t *instance, hal_radio_state_t state)
+{
+    if (instance == NULL || instance->hw_context == NULL) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    hal_radio_cc1101_context_t *ctx = instance->hw_context;
+    hal_result_t result;
+
+    if (ctx->xfer != CC1101_XFER_NONE) {
+        cc1101_abort(instance, ctx->xfer == CC1101_XFER_TX ? CC1101_SFTX : CC1101_SFRX);
+    }
+
+    switch (state) {
+        case HAL_RADIO_STATE_IDLE:
+            result = cc1101_idle(ctx);
+            break;
+
+        case HAL_RADIO_STATE_RX:
+            result = cc1101_strobe(ctx, CC1101_SRX);
+            break;
+
+        case HAL_RADIO_STATE_TX:
+            result = cc1101_strobe(ctx, CC1101_STX);
+            break;
+
+        case HAL_RADIO_STATE_SLEEP:
+            result = cc1101_idle(ctx);
+            if (result == HAL_OK) {
+                result = cc1101_strobe(ctx, CC1101_SPWD);
+            }
+            break;
+
+        case HAL_RADIO_STATE_CALIBRATE:
+            /* SCAL returns to IDLE when the synthesizer is calibrated */
+            result = cc1101_idle(ctx);
+            if (result == HAL_OK) {
+                result = cc1101_strobe(ctx, CC1101_SCAL);
+            }
+            if (result == HAL_OK) {
+                result = cc1101_wait_state(ctx, CC1101_MARC_IDLE);
+            }
+            state = HAL_RADIO_STATE_IDLE;
+            break;
+
+        default:
+            return HAL_ERROR_INVALID_PARAM;
+    }
+
+    instance->state = (result == HAL_OK) ? state : HAL_RADIO_STATE_ERROR;
+    return result;
+}
+
+/**
+ * @brief Read a configuration, status or first PATABLE register
+ */
+hal_result_t cc1101_read_register(hal_radio_instance_t *instance, uint8_t reg_addr, uint8_t *value)
+{
+    if (instance == NULL || instance->hw_context == NULL || value == NULL ||
+        (reg_addr > CC1101_STATUS_LAST && reg_addr != CC1101_PATABLE) ||
+        (reg_addr >= CC1101_CONFIG_REGISTERS && reg_addr < CC1101_PARTNUM)) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    hal_radio_cc1101_context_t *ctx = instance->hw_context;
+
+    if (ctx->xfer != CC1101_XFER_NONE) {
+        return HAL_ERROR_RESOURCE_BUSY;
+    }
+
+    if (reg_addr >= CC1101_PARTNUM && reg_addr <= CC1101_STATUS_LAST) {
+        return cc1101_read_status(ctx, reg_addr, value);
+    }
+
+    return cc1101_access(ctx, reg_addr | CC1101_READ, NULL, value, 1);
+}
+
+/**
+ * @brief Write a configuration or first PATABLE register
+ */
+hal_result_t cc1101_write_register(hal_radio_instance_t *instance, uint8_t reg_addr, uint8_t value)
+{
+    if (instance == NULL || instance->hw_context == NULL ||
+        (reg_addr >= CC1101_CONFIG_REGISTERS && reg_addr != CC1101_PATABLE)) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    hal_radio_cc1101_context_t *ctx = instance->hw_context;
+
+    if (ctx->xfer != CC1101_XFER_NONE) {
+        return HAL_ERROR_RESOURCE_BUSY;
+    }
+
+    /* Unconditional, so it also repairs a register the shadow disagrees with */
+    hal_result_t result = cc1101_access(ctx, reg_addr, &value, NULL, 1);
+    if (result == HAL_OK) {
+        if (reg_addr == CC1101_PATABLE) {
+            ctx->patable[0] = value;
+        } else {
+            ctx->shadow[reg_addr] = value;
+        }
+    }
+
+    return result;
+}
+
+/* Static helper functions */
+
+/**
+ * @brief Set up SPI1, chip select and the GDO inputs
+ */
+static hal_result_t cc1101_hardware_init(hal_radio_cc1101_context_t *ctx)
+{
+    static const uint32_t spi_pins[] = { CC1101_PIN_SCK, CC1101_PIN_MISO, CC1101_PIN_MOSI };
+    hal_gpio_config_t pin = {
+        .pin = ctx->cs_pin,
+        .mode = HAL_GPIO_MODE_OUTPUT,
+        .pull = HAL_GPIO_PULL_NONE,
+        .output_type = HAL_GPIO_OUTPUT_PUSH_PULL,
+        .speed = HAL_GPIO_SPEED_VERY_HIGH,
+        .alt_func = HAL_GPIO_AF_SYSTEM,
+        .trigger = HAL_GPIO_TRIGGER_NONE
+    };
+
+    hal_result_t result = hal_gpio_reserve_pin(ctx->cs_pin, "cc1101");
+    if (result == HAL_OK) {
+        result = hal_gpio_configure_pin(&pin);
+    }
+    if (result == HAL_OK) {
+        result = hal_gpio_set_pin(ctx->cs_pin, HAL_GPIO_STATE_HIGH);
+    }
+
+    pin.mode = HAL_GPIO_MODE_ALTERNATE;
+    pin.alt_func = HAL_GPIO_AF_SPI1;
+    for (uint32_t i = 0; i < sizeof(spi_pins) / sizeof(spi_pins[0]) && result == HAL_OK; i++) {
+        pin.pin = spi_pins[i];
+        result = hal_gpio_configure_pin(&pin);
+    }
+
+    pin.mode = HAL_GPIO_MODE_INPUT;
+    pin.alt_func = HAL_GPIO_AF_SYSTEM;
+    pin.pin = ctx->gdo0_pin;
+    if (result == HAL_OK) {
+        result = hal_gpio_reserve_pin(ctx->gdo0_pin, "cc1101");
+    }
+    if (result == HAL_OK) {
+        result = hal_gpio_configure_pin(&pin);
+    }
+    pin.pin = ctx->gdo2_pin;
+    if (result == HAL_OK) {
+        result = hal_gpio_reserve_pin(ctx->gdo2_pin, "cc1101");
+    }
+    if (result == HAL_OK) {
+        result = hal_gpio_configure_pin(&pin);
+    }
+    if (result != HAL_OK) {
+        return result;
+    }
+
+#ifndef HAL_CC1101_SIMULATOR
+    /* SPI mode 0, 8-bit frames, RXNE per byte */
+    *(volatile uint32_t *)(CC1101_RCC_BASE + RCC_APB2ENR_OFFSET) |= RCC_APB2ENR_SPI1EN;
+    CC1101_REG(SPI_CR1_OFFSET) = 0;
+    CC1101_REG(SPI_CR2_OFFSET) = SPI_CR2_DS_8BIT | SPI_CR2_FRXTH;
+    CC1101_REG(SPI_CR1_OFFSET) = SPI_CR1_MSTR | SPI_CR1_BR_DIV16 | SPI_CR1_SSM | SPI_CR1_SSI | SPI_CR1_SPE;
+
+    /* Timeouts count core cycles */
+    DEMCR |= DEMCR_TRCENA;
+    DWT_CTRL |= DWT_CTRL_CYCCNTENA;
+#endif
+
+    return HAL_OK;
+}
+
+/**
+ * @brief Exchange one byte on SPI1
+ */
+static uint8_t cc1101_spi_transfer(uint8_t value)
+{
+#ifdef HAL_CC1101_SIMULATOR
+    return cc1101_sim_exchange(value);
+#else
+    while (!(CC1101_REG(SPI_SR_OFFSET) & SPI_SR_TXE)) {
+    }
+    CC1101_DR8 = value;
+    while (!(CC1101_REG(SPI_SR_OFFSET) & SPI_SR_RXNE)) {
+    }
+    return CC1101_DR8;
+#endif
+}
+
+/**
+ * @brief One chip-select framed access: header byte, then count data bytes
+ *
+ * With the burst bit set in the header, consecutive bytes go to
+ * consecutive registers, or all to the FIFO. tx supplies the bytes to
+ * write (zeros when NULL), rx receives the bytes read (may be NULL).
+ */
+static hal_result_t cc1101_access(const hal_radio_cc1101_context_t *ctx, uint8_t header,
+                                  const uint8_t *tx, uint8_t *rx, uint32_t count)
+{
+    uint32_t start = DWT_CYCCNT;
+    hal_gpio_state_t miso = HAL_GPIO_STATE_HIGH;
+
+    hal_gpio_set_pin(ctx->cs_pin, HAL_GPIO_STATE_LOW);
+    while (hal_gpio_get_pin(CC1101_PIN_MISO, &miso) == HAL_OK && miso != HAL_GPIO_STATE_LOW) {
+        if ((DWT_CYCCNT - start) / CYCLES_PER_US >= CC1101_READY_TIMEOUT_US) {
+            hal_gpio_set_pin(ctx->cs_pin, HAL_GPIO_STATE_HIGH);
+            return HAL_ERROR_TIMEOUT;
+        }
+    }
+
+    cc1101_spi_transfer(header);
+    for (uint32_t i = 0; i < count; i++) {
+        uint8_t in = cc1101_spi_transfer(tx ? tx[i] : 0);
+        if (rx) {
+            rx[i] = in;
+        }
+    }
+
+    hal_gpio_set_pin(ctx->cs_pin, HAL_GPIO_STATE_HIGH);
+    return HAL_OK;
+}
+
+static hal_result_t cc1101_strobe(const hal_radio_cc1101_context_t *ctx, uint8_t command)
+{
+    return cc1101_access(ctx, command, NULL, NULL, 0);
+}
+
+/**
+ * @brief Write one configuration register unless the shadow already holds the value
+ */
+static hal_result_t cc1101_write(hal_radio_cc1101_context_t *ctx, uint8_t addr, uint8_t value)
+{
+    return cc1101_write_span(ctx, addr, &value, 1);
+}
+
+/**
+ * @brief Write consecutive configuration registers
+ *
+ * Leading and trailing registers that already match the shadow are
+ * trimmed and the rest goes out as one burst.
+ */
+static hal_result_t cc1101_write_span(hal_radio_cc1101_context_t *ctx, uint8_t addr, const uint8_t *data,
+                                      uint32_t count)
+{
+    uint32_t first = 0;
+    uint32_t last = count;
+
+    while (first < last && data[first] == ctx->shadow[addr + first]) {
+        first++;
+    }
+    while (last > first && data[last - 1] == ctx->shadow[addr + last - 1]) {
+        last--;
+    }
+    if (first == last) {
+        return HAL_OK;
+    }
+
+    hal_result_t result = cc1101_access(ctx, (uint8_t)(addr + first) | CC1101_BURST, &data[first], NULL,
+                                        last - first);
+    if (result == HAL_OK) {
+        memcpy(&ctx->shadow[addr + first], &data[first], last - first);
+    }
+
+    return result;
+}
+
+/**
+ * @brief Bring the chip in line with a register file image
+ *
+ * Fills in the frequency word and PA table, then writes only what differs
+ * from the shadow. FSCAL3..1 are left out: the chip rewrites them on every
+ * calibration, so the shadow cannot know them. Everything a configuration
+ * touches lies below them, which keeps the write to one burst.
+ */
+static hal_result_t cc1101_write_image(hal_radio_instance_t *instance, uint8_t *image, uint32_t frequency_hz,
+                                       hal_radio_power_t power_level)
+{
+    hal_radio_cc1101_context_t *ctx = instance->hw_context;
+    uint32_t freq = (uint32_t)((((uint64_t)frequency_hz << 16) + CC1101_XOSC_HZ / 2) / CC1101_XOSC_HZ);
+    uint8_t patable[2];
+
+    image[CC1101_FREQ2] = (uint8_t)(freq >> 16);
+    image[CC1101_FREQ1] = (uint8_t)(freq >> 8);
+    image[CC1101_FREQ0] = (uint8_t)freq;
+
+    /* Leaves hopping: the new frequency has no cached calibration */
+    image[CC1101_MCSM0] = (image[CC1101_MCSM0] & (uint8_t)~CC1101_MCSM0_AUTOCAL_MASK) | CC1101_MCSM0_AUTOCAL_IDLE;
+
+    cc1101_patable(frequency_hz, power_level, (image[CC1101_MDMCFG2] & 0x70) == 0x30, patable);
+
+    bool registers = memcmp(image, ctx->shadow, CC1101_FSCAL3) != 0 ||
+                     memcmp(&image[CC1101_FSCAL0], &ctx->shadow[CC1101_FSCAL0],
+                            CC1101_CONFIG_REGISTERS - CC1101_FSCAL0) != 0;
+    bool pa_table = memcmp(patable, ctx->patable, sizeof(ctx->patable)) != 0;
+    if (!registers && !pa_table) {
+        return HAL_OK;
+    }
+
+    /* Frequency and modem settings only change in IDLE */
+    hal_result_t result = cc1101_idle(ctx);
+    instance->state = HAL_RADIO_STATE_IDLE;
+
+    if (result == HAL_OK) {
+        result = cc1101_write_span(ctx, 0, image, CC1101_FSCAL3);
+    }
+    if (result == HAL_OK) {
+        result = cc1101_write_span(ctx, CC1101_FSCAL0, &image[CC1101_FSCAL0],
+                                   CC1101_CONFIG_REGISTERS - CC1101_FSCAL0);
+    }
+    if (result == HAL_OK) {
+        result = cc1101_write_patable(ctx, patable);
+    }
+
+    return result;
+}
+
+/**
+ * @brief PA table for a band and power level
+ *
+ * OOK keys between PATABLE[0] (off) and PATABLE[1].
+ */
+static void cc1101_patable(uint32_t frequency_hz, hal_radio_power_t power_level, bool ook, uint8_t *patable)
+{
+    const uint8_t *pa = (frequency_hz < 600000000UL) ? cc1101_pa_433 : cc1101_pa_868;
+
+    patable[0] = ook ? 0x00 : pa[power_level];
+    patable[1] = pa[power_level];
+}
+
+static hal_result_t cc1101_write_patable(hal_radio_cc1101_context_t *ctx, const uint8_t *patable)
+{
+    if (memcmp(patable, ctx->patable, sizeof(ctx->patable)) == 0) {
+        return HAL_OK;
+    }
+
+    hal_result_t result = cc1101_access(ctx, CC1101_PATABLE | CC1101_BURST, patable, NULL, sizeof(ctx->patable));
+    if (result == HAL_OK) {
+        memcpy(ctx->patable, patable, sizeof(ctx->patable));
+    }
+
+    return result;
+}
+
+/**
+ * @brief Synthesizer bands: 300-348, 387-464 and 779-928 MHz
+ */
+static bool cc1101_frequency_valid(uint32_t frequency_hz)
+{
+    uint32_t mhz = frequency_hz / 1000000UL;
+
+    return (mhz >= 300 && mhz < 348) || (mhz >= 387 && mhz < 464) || (mhz >= 779 && mhz < 928);
+}
+
+/**
+ * @brief Read a status register
+ *
+ * Values that change while being read (the FIFO byte counts) can come out
+ * corrupted, so they are read until two reads agree.
+ */
+static hal_result_t cc1101_read_status(const hal_radio_cc1101_context_t *ctx, uint8_t addr, uint8_t *value)
+{
+    uint8_t last;
+    hal_result_t result = cc1101_access(ctx, addr | CC1101_READ | CC1101_BURST, NULL, &last, 1);
+
+    while (result == HAL_OK) {
+        result = cc1101_access(ctx, addr | CC1101_READ | CC1101_BURST, NULL, value, 1);
+        if (*value == last) {
+            break;
+        }
+        last = *value;
+    }
+
+    return result;
+}
+
+/**
+ * @brief Strobe SIDLE and wait until the state machine is idle
+ */
+static hal_result_t cc1101_idle(const hal_radio_cc1101_context_t *ctx)
+{
+    hal_result_t result = cc1101_strobe(ctx, CC1101_SIDLE);
+    if (result == HAL_OK) {
+        result = cc1101_wait_state(ctx, CC1101_MARC_IDLE);
+    }
+
+    return result;
+}
+
+/**
+ * @brief Wait for the main radio state machine to reach a state
+ */
+static hal_result_t cc1101_wait_state(const hal_radio_cc1101_context_t *ctx, uint8_t marcstate)
+{
+    uint32_t start = DWT_CYCCNT;
+    uint8_t value = 0;
+    hal_result_t result = HAL_OK;
+
+    while (result == HAL_OK) {
+        result = cc1101_read_status(ctx, CC1101_MARCSTATE, &value);
+        if ((value & 0x1F) == marcstate) {
+            break;
+        }
+        if ((DWT_CYCCNT - start) / CYCLES_PER_US >= CC1101_STATE_TIMEOUT_US) {
+            result = HAL_ERROR_TIMEOUT;
+        }
+    }
+
+    return result;
+}
+
+static void cc1101_delay_us(uint32_t us)
+{
+    uint32_t start = DWT_CYCCNT;
+
+    while ((DWT_CYCCNT - start) / CYCLES_PER_US < us) {
+    }
+}
+
+/**
+ * @brief Convert an RSSI register or appended status byte to dBm
+ */
+static int8_t cc1101_rssi_dbm(uint8_t raw)
+{
+    return (int8_t)((int8_t)raw / 2 - CC1101_RSSI_OFFSET);
+}
+
+/**
+ * @brief Wait for the interrupt handlers to finish the transfer
+ * @param timeout_ms Timeout, 0 to wait forever
+ */
+static hal_result_t cc1101_wait_done(hal_radio_cc1101_context_t *ctx, uint32_t timeout_ms)
+{
+    uint64_t limit = (uint64_t)timeout_ms * (CPU_FREQUENCY_HZ / 1000UL);
+    uint64_t elapsed = 0;
+    uint32_t last = DWT_CYCCNT;
+
+    /* Accumulated so waits longer than one counter period work */
+    while (ctx->xfer != CC1101_XFER_NONE) {
+        uint32_t now = DWT_CYCCNT;
+        elapsed += (uint32_t)(now - last);
+        last = now;
+        if (timeout_ms != 0 && elapsed >= limit) {
+            return HAL_ERROR_TIMEOUT;
+        }
+    }
+
+    return HAL_OK;
+}
+
+/**
+ * @brief Load a packet for transmission; STX sends it
+ *
+ * Leaves the chip idle with the length mode set and the TX FIFO primed
+ * straight from the caller's buffer.
+ */
+static hal_result_t cc1101_prepare_tx(hal_radio_instance_t *instance, const hal_radio_packet_t *packet)
+{
+    hal_radio_cc1101_context_t *ctx = instance->hw_context;
+    bool variable = (instance->config.packet_format == HAL_RADIO_PACKET_VARIABLE_LENGTH);
+
+    if (variable && packet->length > 255) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    hal_result_t result = cc1101_idle(ctx);
+    if (result == HAL_OK) {
+        result = cc1101_strobe(ctx, CC1101_SFTX);
+    }
+    if (result != HAL_OK) {
+        return result;
+    }
+
+    ctx->variable = variable;
+    ctx->tx_data = packet->data;
+    ctx->rx_packet = NULL;
+    ctx->length = packet->length;
+    ctx->position = 0;
+    result = cc1101_set_length_mode(ctx, variable ? 255 : packet->length);
+    if (result != HAL_OK) {
+        return result;
+    }
+    result = cc1101_write(ctx, CC1101_IOCFG0, CC1101_GDO_TX_THRESHOLD);
+    if (result != HAL_OK) {
+        return result;
+    }
+
+    uint32_t room = CC1101_FIFO_SIZE;
+    if (variable) {
+        uint8_t length_byte = (uint8_t)packet->length;
+        result = cc1101_access(ctx, CC1101_FIFO, &length_byte, NULL, 1);
+        if (result != HAL_OK) {
+            return result;
+        }
+        room--;
+    }
+
+    uint32_t count = (ctx->length < room) ? ctx->length : room;
+    result = cc1101_access(ctx, CC1101_FIFO | CC1101_BURST, ctx->tx_data, NULL, count);
+    if (result != HAL_OK) {
+        return result;
+    }
+    ctx->position = count;
+    return HAL_OK;
+}
+
+/**
+ * @brief Set up reception into a packet buffer; SRX starts it
+ */
+static hal_result_t cc1101_prepare_rx(hal_radio_instance_t *instance, hal_radio_packet_t *packet)
+{
+    hal_radio_cc1101_context_t *ctx = instance->hw_context;
+
+    if (packet->data == NULL || packet->length == 0) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    hal_result_t result = cc1101_idle(ctx);
+    if (result == HAL_OK) {
+        result = cc1101_strobe(ctx, CC1101_SFRX);
+    }
+    if (result != HAL_OK) {
+        return result;
+    }
+
+    ctx->variable = (instance->config.packet_format == HAL_RADIO_PACKET_VARIABLE_LENGTH);
+    ctx->tx_data = NULL;
+    ctx->rx_packet = packet;
+    ctx->have_length = !ctx->variable;
+    ctx->length = packet->length;
+    ctx->position = 0;
+    ctx->sync_seen = false;
+
+    /* In variable mode PKTLEN is the largest length byte accepted */
+    result = cc1101_set_length_mode(ctx, ctx->variable ? ((packet->length < 255) ? packet->length : 255)
+                                                       : packet->length);
+    if (result != HAL_OK) {
+        return result;
+    }
+    cc1101_write(ctx, CC1101_IOCFG0, CC1101_GDO_RX_THRESHOLD);
+    return HAL_OK;
+}
+
+/**
+ * @brief Program PKTLEN and the length mode for a packet
+ *
+ * Lengths over 255 start in infinite mode with PKTLEN holding the length
+ * modulo 256; the FIFO handlers switch to fixed mode once fewer than 256
+ * bytes remain, so the packet ends on the right byte. Fixed lengths that
+ * are a multiple of 256 (zero included) would need PKTLEN = 0, which the
+ * chip does not accept, and are refused.
+ *
+ * @return HAL_OK on success, HAL_ERROR_INVALID_PARAM for an unrepresentable length
+ */
+static hal_result_t cc1101_set_length_mode(hal_radio_cc1101_context_t *ctx, uint32_t length)
+{
+    uint8_t mode;
+
+    if (!ctx->variable && (length & 0xFF) == 0) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    ctx->infinite = false;
+    if (ctx->variable) {
+        mode = CC1101_LENGTH_VARIABLE;
+    } else if (length > 255) {
+        mode = CC1101_LENGTH_INFINITE;
+        ctx->infinite = true;
+    } else {
+        mode = CC1101_LENGTH_FIXED;
+    }
+
+    uint8_t pktctrl1 = (ctx->shadow[CC1101_PKTCTRL1] & CC1101_PKTCTRL1_PQT_MASK) | CC1101_PKTCTRL1_APPEND;
+    uint8_t regs[3] = { (uint8_t)length, pktctrl1, (uint8_t)(ctx->pktctrl0 | mode) };
+    return cc1101_write_span(ctx, CC1101_PKTLEN, regs, sizeof(regs));
+}
+
+/**
+ * @brief Hook up the GDO interrupts and start the transfer
+ *
+ * The handlers ignore edges until the transfer is marked active, which
+ * happens after the strobe so they never share the bus with it.
+ */
+static void cc1101_start(hal_radio_instance_t *instance, cc1101_xfer_t xfer, uint8_t strobe)
+{
+    hal_radio_cc1101_context_t *ctx = instance->hw_context;
+
+    ctx->xfer_result = HAL_OK;
+    hal_gpio_enable_interrupt(ctx->gdo0_pin,
+                              (xfer == CC1101_XFER_TX) ? HAL_GPIO_TRIGGER_FALLING : HAL_GPIO_TRIGGER_RISING,
+                              cc1101_gdo0_isr, instance);
+    hal_gpio_enable_interrupt(ctx->gdo2_pin, HAL_GPIO_TRIGGER_BOTH, cc1101_gdo2_isr, instance);
+
+    cc1101_strobe(ctx, strobe);
+    instance->state = (xfer == CC1101_XFER_TX) ? HAL_RADIO_STATE_TX : HAL_RADIO_STATE_RX;
+    ctx->xfer = (uint8_t)xfer;
+}
+
+/**
+ * @brief Cancel a transfer from thread context
+ */
+static void cc1101_abort(hal_radio_instance_t *instance, uint8_t flush)
+{
+    hal_radio_cc1101_context_t *ctx = instance->hw_context;
+
+    hal_gpio_disable_interrupt(ctx->gdo0_pin);
+    hal_gpio_disable_interrupt(ctx->gdo2_pin);
+
+    if (ctx->xfer == CC1101_XFER_CAPTURE) {
+        hal_radio_capture_end(instance);
+    } else if (ctx->xfer == CC1101_XFER_SAMPLE) {
+        hal_radio_sampler_end(instance);
+    }
+
+    bool wor = ctx->wor;
+    ctx->wor = false;
+
+    /* Queued async requests are dropped without events */
+    uint32_t primask = hal_radio_lock();
+    hal_radio_timer_cancel(CC1101_TIMER_CHANNEL);
+    ctx->queue_count = 0;
+    ctx->xfer = CC1101_XFER_NONE;
+    hal_radio_unlock(primask);
+
+    cc1101_idle(ctx);
+    cc1101_strobe(ctx, flush);
+    if (wor) {
+        cc1101_wor_end(ctx);
+    }
+    instance->state = HAL_RADIO_STATE_IDLE;
+}
+
+/**
+ * @brief End a transfer from interrupt context and report it
+ */
+static void cc1101_finish(hal_radio_instance_t *instance, hal_result_t result, hal_radio_event_t event,
+                          void *data)
+{
+    hal_radio_cc1101_context_t *ctx = instance->hw_context;
+
+    hal_gpio_disable_interrupt(ctx->gdo0_pin);
+    hal_gpio_disable_interrupt(ctx->gdo2_pin);
+    ctx->xfer_result = result;
+    instance->state = HAL_RADIO_STATE_IDLE;
+
+    if (ctx->queue_count > 0) {
+        /* Turnaround runs from the end of the transfer, not of the callback */
+        uint32_t end_us = hal_radio_timer_now();
+        cc1101_queue_retire(instance, result);
+        cc1101_queue_next(instance, end_us);
+        return;
+    }
+
+    ctx->xfer = CC1101_XFER_NONE;
+
+    if (ctx->wor) {
+        if (result == HAL_OK) {
+            instance->stats.packets_received++;
+            instance->stats.last_rssi = ctx->rx_packet->rssi;
+            instance->stats.last_lqi = ctx->rx_packet->lqi;
+            if (!ctx->rx_packet->crc_ok) {
+                instance->stats.crc_errors++;
+            }
+        } else {
+            instance->stats.packets_dropped++;
+        }
+        hal_radio_notify(instance, event, data);
+        cc1101_wor_sleep(instance);
+        return;
+    }
+
+    hal_radio_notify(instance, event, data);
+}
+
+/**
+ * @brief Wake-on-radio: back to the polling sequence for the next packet
+ *
+ * The chip parks in IDLE after a packet; the caller has had the packet in
+ * its callback and the buffer is reused.
+ */
+static void cc1101_wor_sleep(hal_radio_instance_t *instance)
+{
+    hal_radio_cc1101_context_t *ctx = instance->hw_context;
+
+    ctx->rx_packet->length = ctx->wor_capacity;
+    if (cc1101_prepare_rx(instance, ctx->rx_packet) != HAL_OK) {
+        ctx->wor = false;
+        cc1101_wor_end(ctx);
+        return;
+    }
+
+    cc1101_start(instance, CC1101_XFER_RX, CC1101_SWOR);
+}
+
+/**
+ * @brief Undo the wake-on-radio settings: no RX timeout, RC oscillator off
+ */
+static void cc1101_wor_end(hal_radio_cc1101_context_t *ctx)
+{
+    uint8_t pktctrl1 = ctx->shadow[CC1101_PKTCTRL1] & (uint8_t)~CC1101_PKTCTRL1_PQT_MASK;
+
+    cc1101_write(ctx, CC1101_MCSM2, CC1101_MCSM2_RX_TIME_NONE);
+    cc1101_write(ctx, CC1101_PKTCTRL1, pktctrl1);
+    cc1101_write(ctx, CC1101_AGCCTRL1, ctx->wor_agcctrl1);
+    cc1101_write(ctx, CC1101_WORCTRL, CC1101_WORCTRL_OFF);
+}
+
+/**
+ * @brief Prepare the head request and start it now or at its deadline
+ *
+ * Requests that cannot be prepared complete with the error and the next
+ * one is tried. With nothing left the queue lets go of the chip.
+ */
+static void cc1101_queue_next(hal_radio_instance_t *instance, uint32_t reference_us)
+{
+    hal_radio_cc1101_context_t *ctx = instance->hw_context;
+
+    while (ctx->queue_count > 0) {
+        cc1101_request_t *request = &ctx->queue[ctx->queue_head];
+        hal_result_t result = request->transmit ? cc1101_prepare_tx(instance, request->packet)
+                                                : cc1101_prepare_rx(instance, request->packet);
+
+        if (result == HAL_OK) {
+            ctx->cca_attempts = 0;
+            if (request->options.delay_us == 0 && !request->options.at_time) {
+                cc1101_queue_fire(instance);
+                return;
+            }
+
+            /* Calibrate now, so the strobe at the deadline acts within microseconds */
+            cc1101_strobe(ctx, CC1101_SFSTXON);
+            ctx->phase = CC1101_PHASE_DELAY;
+
+            /* Interrupt entry varies; timed starts wake early and spin to the exact microsecond */
+            uint32_t at_us = request->options.at_time ? request->options.start_us - CC1101_SCHEDULE_LEAD_US
+                                                      : reference_us + request->options.delay_us;
+            ctx->start_late = request->options.at_time && (int32_t)(at_us - hal_radio_timer_now()) <= 0;
+            hal_radio_timer_arm(CC1101_TIMER_CHANNEL, at_us, cc1101_timer_isr, instance);
+            return;
+        }
+
+        cc1101_queue_retire(instance, result);
+    }
+
+    uint32_t primask = hal_radio_lock();
+    if (ctx->queue_count == 0) {
+        ctx->xfer = CC1101_XFER_NONE;
+    }
+    hal_radio_unlock(primask);
+
+    /* Another task submitted after the loop ended but before the lock */
+    if (ctx->xfer == CC1101_XFER_QUEUED) {
+        cc1101_queue_next(instance, reference_us);
+    }
+}
+
+/**
+ * @brief Put the prepared head request on air
+ */
+static void cc1101_queue_fire(hal_radio_instance_t *instance)
+{
+    hal_radio_cc1101_context_t *ctx = instance->hw_context;
+    const cc1101_request_t *request = &ctx->queue[ctx->queue_head];
+
+    /* The timer woke us CC1101_SCHEDULE_LEAD_US early; spin out the rest */
+    if (request->options.at_time) {
+        while ((int32_t)(hal_radio_timer_now() - request->options.start_us) < 0) {
+        }
+    }
+
+    if (request->transmit) {
+        if (request->options.listen_before_talk) {
+            /* The TX FIFO stays loaded while the receiver measures the channel */
+            cc1101_strobe(ctx, CC1101_SRX);
+            ctx->phase = CC1101_PHASE_CCA;
+            hal_radio_timer_arm(CC1101_TIMER_CHANNEL, hal_radio_timer_now() + CC1101_RSSI_SETTLE_US,
+                                cc1101_timer_isr, instance);
+            return;
+        }
+        cc1101_start(instance, CC1101_XFER_TX, CC1101_STX);
+        if (request->options.at_time) {
+            cc1101_record_jitter(instance, request->options.start_us, ctx->start_late);
+        }
+        return;
+    }
+
+    cc1101_start(instance, CC1101_XFER_RX, CC1101_SRX);
+    if (request->options.window_us != 0) {
+        ctx->phase = CC1101_PHASE_WINDOW;
+        hal_radio_timer_arm(CC1101_TIMER_CHANNEL, hal_radio_timer_now() + request->options.window_us,
+                            cc1101_timer_isr, instance);
+    }
+}
+
+/**
+ * @brief Account a timed transmission: how long after its time the strobe went out
+ */
+static void cc1101_record_jitter(hal_radio_instance_t *instance, uint32_t start_us, bool late)
+{
+    hal_radio_stats_t *stats = &instance->stats;
+    uint32_t jitter_us = hal_radio_timer_now() - start_us;
+
+    stats->scheduled_tx++;
+    if (late) {
+        stats->scheduled_late++;
+        return;
+    }
+
+    stats->tx_jitter_last_us = jitter_us;
+    stats->tx_jitter_total_us += jitter_us;
+    if (jitter_us > stats->tx_jitter_max_us) {
+        stats->tx_jitter_max_us = jitter_us;
+    }
+}
+
+/**
+ * @brief Remove the head request and report its completion
+ */
+static void cc1101_queue_retire(hal_radio_instance_t *instance, hal_result_t result)
+{
+    hal_radio_cc1101_context_t *ctx = instance->hw_context;
+    const cc1101_request_t *request = &ctx->queue[ctx->queue_head];
+    hal_radio_packet_t *packet = request->packet;
+    hal_radio_event_t event;
+
+    hal_radio_timer_cancel(CC1101_TIMER_CHANNEL);
+
+    if (request->transmit) {
+        event = HAL_RADIO_EVENT_TX_COMPLETE;
+        if (result == HAL_OK) {
+            instance->stats.packets_transmitted++;
+        }
+    } else if (result == HAL_ERROR_TIMEOUT) {
+        event = HAL_RADIO_EVENT_RX_TIMEOUT;
+    } else {
+        event = HAL_RADIO_EVENT_RX_COMPLETE;
+        if (result == HAL_OK) {
+            instance->stats.packets_received++;
+            instance->stats.last_rssi = packet->rssi;
+            instance->stats.last_lqi = packet->lqi;
+            if (!packet->crc_ok) {
+                instance->stats.crc_errors++;
+            }
+        }
+    }
+
+    ctx->completion.request = request->handle;
+    ctx->completion.result = result;
+    ctx->completion.packet = packet;
+
+    uint32_t primask = hal_radio_lock();
+    ctx->queue_head = (uint8_t)((ctx->queue_head + 1U) % HAL_RADIO_REQUEST_QUEUE);
+    ctx->queue_count--;
+    ctx->xfer = CC1101_XFER_QUEUED;
+    hal_radio_unlock(primask);
+
+    hal_radio_notify(instance, event, &ctx->completion);
+}
+
+/**
+ * @brief Deadline for the head request: turnaround over, channel check or window end
+ */
+static void cc1101_timer_isr(void *user_data)
+{
+    hal_radio_instance_t *instance = user_data;
+    hal_radio_cc1101_context_t *ctx = instance->hw_context;
+
+    if (ctx->queue_count == 0) {
+        return;
+    }
+
+    const cc1101_request_t *request = &ctx->queue[ctx->queue_head];
+
+    switch (ctx->phase) {
+        case CC1101_PHASE_DELAY:
+            cc1101_queue_fire(instance);
+            break;
+
+        case CC1101_PHASE_CCA: {
+            uint8_t raw = 0;
+            cc1101_read_status(ctx, CC1101_RSSI, &raw);
+            if (cc1101_rssi_dbm(raw) < request->options.cca_threshold_dbm) {
+                /* Straight from RX to TX; with CCA the chip silently stays in RX if the
+                 * channel turned busy after the RSSI read, so check where STX left it */
+                uint8_t marcstate = CC1101_MARC_RX;
+                cc1101_strobe(ctx, CC1101_STX);
+                cc1101_read_status(ctx, CC1101_MARCSTATE, &marcstate);
+                if ((marcstate & 0x1F) != CC1101_MARC_RX) {
+                    cc1101_start(instance, CC1101_XFER_TX, CC1101_SNOP);
+                    if (request->options.at_time) {
+                        cc1101_record_jitter(instance, request->options.start_us, ctx->start_late);
+                    }
+                    break;
+                }
+            }
+
+            if (ctx->cca_attempts < request->options.cca_retries) {
+                ctx->cca_attempts++;
+                hal_radio_timer_arm(CC1101_TIMER_CHANNEL, hal_radio_timer_now() + CC1101_CCA_BACKOFF_US +
+                                    (DWT_CYCCNT & CC1101_CCA_JITTER_MASK), cc1101_timer_isr, instance);
+            } else {
+                cc1101_idle(ctx);
+                cc1101_finish(instance, HAL_ERROR_RESOURCE_BUSY, HAL_RADIO_EVENT_TX_COMPLETE, NULL);
+            }
+            break;
+        }
+
+        case CC1101_PHASE_WINDOW:
+        default:
+            /* A packet that started inside the window is received in full */
+            if (ctx->xfer == CC1101_XFER_RX && !ctx->sync_seen) {
+                cc1101_strobe(ctx, CC1101_SIDLE);
+                cc1101_strobe(ctx, CC1101_SFRX);
+                cc1101_finish(instance, HAL_ERROR_TIMEOUT, HAL_RADIO_EVENT_RX_TIMEOUT, NULL);
+            }
+            break;
+    }
+}
+
+/**
+ * @brief Top up the TX FIFO from the caller's buffer
+ */
+static void cc1101_tx_refill(hal_radio_instance_t *instance)
+{
+    hal_radio_cc1101_context_t *ctx = instance->hw_context;
+    uint8_t txbytes;
+
+    if (cc1101_read_status(ctx, CC1101_TXBYTES, &txbytes) != HAL_OK || (txbytes & CC1101_FIFO_OVERFLOW)) {
+        /* Underflow; the end-of-packet edge reports it */
+        return;
+    }
+
+    uint32_t queued = txbytes & CC1101_FIFO_COUNT;
+    uint32_t left = ctx->length - ctx->position;
+
+    if (ctx->infinite && left + queued < 256) {
+        cc1101_write(ctx, CC1101_PKTCTRL0, ctx->pktctrl0 | CC1101_LENGTH_FIXED);
+        ctx->infinite = false;
+    }
+
+    uint32_t count = CC1101_FIFO_SIZE - queued;
+    if (count > left) {
+        count = left;
+    }
+    if (count > 0) {
+        cc1101_access(ctx, CC1101_FIFO | CC1101_BURST, &ctx->tx_data[ctx->position], NULL, count);
+        ctx->position += count;
+    }
+}
+
+/**
+ * @brief Move received bytes from the RX FIFO into the caller's buffer
+ *
+ * Until the packet ends one byte is left in the FIFO (reading the last
+ * byte while the chip writes the next one corrupts the FIFO pointers).
+ * At the end the payload is followed by the appended RSSI and LQI bytes.
+ */
+static void cc1101_rx_drain(hal_radio_instance_t *instance, bool end)
+{
+    hal_radio_cc1101_context_t *ctx = instance->hw_context;
+    hal_radio_packet_t *packet = ctx->rx_packet;
+    uint8_t rxbytes;
+
+    if (cc1101_read_status(ctx, CC1101_RXBYTES, &rxbytes) != HAL_OK) {
+        return;
+    }
+
+    if (rxbytes & CC1101_FIFO_OVERFLOW) {
+        cc1101_strobe(ctx, CC1101_SIDLE);
+        cc1101_strobe(ctx, CC1101_SFRX);
+        instance->stats.packets_dropped++;
+        cc1101_finish(instance, HAL_ERROR, HAL_RADIO_EVENT_FIFO_OVERFLOW, NULL);
+        return;
+    }
+
+    uint32_t available = rxbytes & CC1101_FIFO_COUNT;
+    if (!end) {
+        if (available <= 1) {
+            return;
+        }
+        available--;
+    }
+
+    if (!ctx->have_length) {
+        uint8_t length_byte;
+        if (available == 0) {
+            return;
+        }
+        cc1101_access(ctx, CC1101_FIFO | CC1101_READ, NULL, &length_byte, 1);
+        available--;
+        ctx->have_length = true;
+
+        /* The chip drops lengths over PKTLEN, but a zero length is not useful either */
+        if (length_byte == 0 || length_byte > packet->length) {
+            cc1101_strobe(ctx, CC1101_SIDLE);
+            cc1101_strobe(ctx, CC1101_SFRX);
+            instance->stats.packets_dropped++;
+            cc1101_finish(instance, HAL_ERROR_NO_MEMORY, HAL_RADIO_EVENT_RX_COMPLETE, NULL);
+            return;
+        }
+        ctx->length = length_byte;
+    }
+
+    uint32_t left = ctx->length - ctx->position;
+    uint32_t count = (available < left) ? available : left;
+
+    if (ctx->infinite && left - count < 256) {
+        cc1101_write(ctx, CC1101_PKTCTRL0, ctx->pktctrl0 | CC1101_LENGTH_FIXED);
+        ctx->infinite = false;
+    }
+
+    if (count > 0) {
+        cc1101_access(ctx, CC1101_FIFO | CC1101_READ | CC1101_BURST, NULL, &packet->data[ctx->position], count);
+        ctx->position += count;
+        available -= count;
+    }
+
+    if (!end) {
+        return;
+    }
+
+    uint8_t status[2];
+    if (ctx->position < ctx->length || available < sizeof(status)) {
+        /* Ended early: the chip left RX or the packet was cut short */
+        cc1101_strobe(ctx, CC1101_SFRX);
+        instance->stats.packets_dropped++;
+        cc1101_finish(instance, HAL_ERROR, HAL_RADIO_EVENT_RX_COMPLETE, NULL);
+        return;
+    }
+
+    cc1101_access(ctx, CC1101_FIFO | CC1101_READ | CC1101_BURST, NULL, status, sizeof(status));
+
+    packet->length = (uint16_t)ctx->length;
+    packet->rssi = cc1101_rssi_dbm(status[0]);
+    packet->lqi = status[1] & (uint8_t)~CC1101_LQI_CRC_OK;
+    packet->crc_ok = !instance->config.crc_enabled || (status[1] & CC1101_LQI_CRC_OK);
+
+    cc1101_finish(instance, HAL_OK, packet->crc_ok ? HAL_RADIO_EVENT_RX_COMPLETE : HAL_RADIO_EVENT_CRC_ERROR,
+                  packet);
+}
+
+/**
+ * @brief GDO0: FIFO crossed the threshold
+ */
+static void cc1101_gdo0_isr(uint32_t pin, void *user_data)
+{
+    hal_radio_instance_t *instance = user_data;
+    hal_radio_cc1101_context_t *ctx = instance->hw_context;
+
+    (void)pin;
+    if (ctx->xfer == CC1101_XFER_TX) {
+        cc1101_tx_refill(instance);
+    } else if (ctx->xfer == CC1101_XFER_RX) {
+        cc1101_rx_drain(instance, false);
+    }
+}
+
+/**
+ * @brief GDO2: sync word sent/received (rising) or packet ended (falling)
+ */
+static void cc1101_gdo2_isr(uint32_t pin, void *user_data)
+{
+    hal_radio_instance_t *instance = user_data;
+    hal_radio_cc1101_context_t *ctx = instance->hw_context;
+    hal_gpio_state_t level = HAL_GPIO_STATE_LOW;
+
+    if (ctx->xfer != CC1101_XFER_TX && ctx->xfer != CC1101_XFER_RX) {
+        return;
+    }
+
+    hal_gpio_get_pin(pin, &level);
+    if (level == HAL_GPIO_STATE_HIGH) {
+        if (ctx->xfer == CC1101_XFER_RX) {
+            ctx->sync_seen = true;
+            hal_radio_notify(instance, HAL_RADIO_EVENT_SYNC_DETECTED, NULL);
+        }
+        return;
+    }
+
+    if (ctx->xfer == CC1101_XFER_RX) {
+        cc1101_rx_drain(instance, true);
+        return;
+    }
+
+    uint8_t marcstate = 0;
+    cc1101_read_status(ctx, CC1101_MARCSTATE, &marcstate);
+    if ((marcstate & 0x1F) == CC1101_MARC_TXFIFO_UNDERFLOW || ctx->position < ctx->length) {
+        cc1101_strobe(ctx, CC1101_SIDLE);
+        cc1101_strobe(ctx, CC1101_SFTX);
+        cc1101_finish(instance, HAL_ERROR, HAL_RADIO_EVENT_FIFO_UNDERFLOW, NULL);
+        return;
+    }
+
+    cc1101_finish(instance, HAL_OK, HAL_RADIO_EVENT_TX_COMPLETE, NULL);
+}
+
+/**
+ * @brief GDO0 edge during a raw capture: time the pulse that just ended
+ */
+static void cc1101_capture_isr(uint32_t pin, void *user_data)
+{
+    hal_radio_instance_t *instance = user_data;
+    hal_radio_cc1101_context_t *ctx = instance->hw_context;
+    hal_gpio_state_t level = HAL_GPIO_STATE_LOW;
+    uint32_t duration_us = (DWT_CYCCNT - ctx->edge_cycles) / CYCLES_PER_US;
+
+    /* Whole microseconds only; the remainder carries into the next pulse */
+    ctx->edge_cycles += duration_us * CYCLES_PER_US;
+
+    hal_gpio_get_pin(pin, &level);
+    hal_radio_capture_edge(level == HAL_GPIO_STATE_LOW, duration_us);
+}
+
+/**
+ * @brief Data rate exponent and mantissa: R = (256 + M) * 2^E * f_xosc / 2^28
+ * @return DRATE_E
+ */
+static uint8_t cc1101_drate(uint32_t rate, uint8_t *mantissa)
+{
+    for (uint8_t e = 0; e < 16; e++) {
+        uint64_t divisor = (uint64_t)CC1101_XOSC_HZ << e;
+        uint64_t m = (((uint64_t)rate << 28) + divisor / 2) / divisor;
+        if (m < 512) {
+            *mantissa = (uint8_t)((m >= 256) ? m - 256 : 0);
+            return e;
+        }
+    }
+
+    *mantissa = 255;
+    return 15;
+}
+
+/**
+ * @brief Narrowest channel filter at least as wide as requested
+ *
+ * BW = f_xosc / (8 * (4 + M) * 2^E), from 58 kHz (E = 3, M = 3) to
+ * 812 kHz (E = 0, M = 0).
+ * @return CHANBW_E and CHANBW_M in MDMCFG4 position
+ */
+static uint8_t cc1101_chanbw(uint32_t bandwidth)
+{
+    for (int32_t step = 15; step >= 0; step--) {
+        uint32_t e = (uint32_t)step >> 2;
+        uint32_t m = (uint32_t)step & 3U;
+        if (CC1101_XOSC_HZ / (8UL * (4UL + m) << e) >= bandwidth) {
+            return (uint8_t)((e << 6) | (m << 4));
+        }
+    }
+
+    return 0x00;
+}
+
+/**
+ * @brief Nearest deviation: f_dev = f_xosc / 2^17 * (8 + M) * 2^E
+ * @return DEVIATN register value
+ */
+static uint8_t cc1101_deviatn(uint32_t deviation)
+{
+    for (uint8_t e = 0; e < 8; e++) {
+        uint64_t divisor = (uint64_t)CC1101_XOSC_HZ << e;
+        uint64_t m = (((uint64_t)deviation << 17) + divisor / 2) / divisor;
+        if (m < 16) {
+            return (uint8_t)((e << 4) | ((m >= 8) ? m - 8 : 0));
+        }
+    }
+
+    return 0x77;
+}
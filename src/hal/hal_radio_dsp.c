@@ -0,0 +1,209 @@
+/**
+ * @file hal_radio_dsp.c
+ * @brief Fixed-point demodulation of sampled radio baseband
+ *
+ * Pure computation with no hardware access, so the same file builds for
+ * the host: scripts/bench/dsp_bench.c runs it against sample files and
+ * scripts/dsp_reference.py is a bit-exact model of it. The samples come
+ * from the DMA sampler in hal_radio_sampler.c.
+ */
+
+#include "hal_radio_dsp.h"
+#include <stddef.h>
+#include <string.h>
+
+#if defined(__ARM_FEATURE_DSP) && __ARM_FEATURE_DSP
+#include <arm_acle.h>
+#endif
+
+#if (HAL_RADIO_DSP_TAPS & 1) != 0
+#error "HAL_RADIO_DSP_TAPS must be even"
+#endif
+
+/* Slicer hysteresis, as a fraction 2^-shift of the level span */
+#define DSP_HYSTERESIS_SHIFT        3
+
+/* Static function prototypes */
+static int32_t dsp_fir(const hal_radio_dsp_t *dsp, const int16_t *window);
+static int32_t dsp_qadd(int32_t a, int32_t b);
+static bool dsp_slice(hal_radio_dsp_t *dsp, int32_t value);
+
+hal_result_t hal_radio_dsp_init(hal_radio_dsp_t *dsp, const hal_radio_dsp_config_t *config)
+{
+    if (dsp == NULL || config == NULL || config->mode >= HAL_RADIO_DSP_MODE_MAX ||
+        config->bit_rate_bps == 0 || config->sample_rate_hz < 4U * config->bit_rate_bps ||
+        config->envelope_shift > 15 || config->decay_shift > 15 || config->clock_gain_shift > 15) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    memset(dsp, 0, sizeof(*dsp));
+    dsp->config = *config;
+    dsp->config.taps = NULL;
+
+    /* Reversed, so the filter walks taps and delay line in the same direction */
+    for (uint32_t i = 0; i < HAL_RADIO_DSP_TAPS; i++) {
+        dsp->taps.values[i] = config->taps ? config->taps[HAL_RADIO_DSP_TAPS - 1U - i]
+                                           : (int16_t)(32768 / HAL_RADIO_DSP_TAPS);
+    }
+
+    dsp->phase_step = (uint32_t)(((uint64_t)config->bit_rate_bps << 32) / config->sample_rate_hz);
+    return HAL_OK;
+}
+
+void hal_radio_dsp_reset(hal_radio_dsp_t *dsp)
+{
+    if (dsp == NULL) {
+        return;
+    }
+
+    memset(dsp->history, 0, sizeof(dsp->history));
+    dsp->position = 0;
+    dsp->envelope = 0;
+    dsp->high = 0;
+    dsp->low = 0;
+    dsp->phase = 0;
+    dsp->level = false;
+}
+
+uint32_t hal_radio_dsp_process(hal_radio_dsp_t *dsp, const int16_t *samples, uint32_t count,
+                               uint8_t *bits, uint32_t max_bits)
+{
+    uint32_t written = 0;
+
+    if (dsp == NULL || samples == NULL || (bits == NULL && max_bits != 0)) {
+        return 0;
+    }
+
+    for (uint32_t n = 0; n < count; n++) {
+        /* Twice-stored delay line: the last TAPS samples are always contiguous */
+        dsp->history[dsp->position] = samples[n];
+        dsp->history[dsp->position + HAL_RADIO_DSP_TAPS] = samples[n];
+        if (++dsp->position == HAL_RADIO_DSP_TAPS) {
+            dsp->position = 0;
+        }
+
+        int32_t value = dsp_fir(dsp, &dsp->history[dsp->position]);
+
+        if (dsp->config.mode == HAL_RADIO_DSP_OOK) {
+            int32_t magnitude = (value < 0) ? -value : value;
+            dsp->envelope = dsp_qadd(dsp->envelope, (magnitude - dsp->envelope) >> dsp->config.envelope_shift);
+            value = dsp->envelope;
+        }
+
+        bool previous = dsp->level;
+        bool level = dsp_slice(dsp, value);
+
+        /* Transitions belong on bit boundaries (phase 0): pull the clock toward them */
+        if (level != previous) {
+            dsp->phase -= (uint32_t)((int32_t)dsp->phase >> dsp->config.clock_gain_shift);
+            dsp->stats.transitions++;
+        }
+
+        /* Sample each bit mid-way, where the phase crosses one half */
+        uint32_t before = dsp->phase;
+        dsp->phase += dsp->phase_step;
+        if (before < 0x80000000UL && dsp->phase >= 0x80000000UL &&
+            dsp->high - dsp->low >= dsp->config.squelch) {
+            if (written < max_bits) {
+                uint8_t mask = (uint8_t)(0x80U >> (written & 7U));
+                if (level) {
+                    bits[written >> 3] |= mask;
+                } else {
+                    bits[written >> 3] &= (uint8_t)~mask;
+                }
+                written++;
+                dsp->stats.bits++;
+            } else {
+                dsp->stats.bits_dropped++;
+            }
+        }
+    }
+
+    dsp->stats.samples += count;
+    dsp->stats.level_high = (int16_t)dsp->high;
+    dsp->stats.level_low = (int16_t)dsp->low;
+    return written;
+}
+
+void hal_radio_dsp_get_stats(const hal_radio_dsp_t *dsp, hal_radio_dsp_stats_t *stats)
+{
+    if (dsp != NULL && stats != NULL) {
+        *stats = dsp->stats;
+    }
+}
+
+/* Static helper functions */
+
+/**
+ * @brief Filter output for the window ending at the newest sample, Q15
+ */
+static int32_t dsp_fir(const hal_radio_dsp_t *dsp, const int16_t *window)
+{
+    int32_t acc = 0;
+
+#if defined(__ARM_FEATURE_DSP) && __ARM_FEATURE_DSP
+    /* Two taps per SMLAD; the window may be halfword aligned, which LDR handles */
+    for (uint32_t k = 0; k < HAL_RADIO_DSP_TAPS; k += 2) {
+        uint32_t x;
+        uint32_t h;
+        memcpy(&x, &window[k], sizeof(x));
+        memcpy(&h, &dsp->taps.values[k], sizeof(h));
+        acc = __smlad(x, h, acc);
+    }
+#else
+    for (uint32_t k = 0; k < HAL_RADIO_DSP_TAPS; k++) {
+        acc += (int32_t)window[k] * dsp->taps.values[k];
+    }
+#endif
+
+    acc >>= 15;
+    if (acc > INT16_MAX) {
+        acc = INT16_MAX;
+    } else if (acc < INT16_MIN) {
+        acc = INT16_MIN;
+    }
+    return acc;
+}
+
+static int32_t dsp_qadd(int32_t a, int32_t b)
+{
+#if defined(__ARM_FEATURE_DSP) && __ARM_FEATURE_DSP
+    return __qadd(a, b);
+#else
+    int64_t sum = (int64_t)a + b;
+    if (sum > INT32_MAX) {
+        return INT32_MAX;
+    }
+    if (sum < INT32_MIN) {
+        return INT32_MIN;
+    }
+    return (int32_t)sum;
+#endif
+}
+
+/**
+ * @brief Track the signal's high and low levels and slice halfway between them
+ *
+ * Peaks are followed at once and relax toward the signal slowly, so the
+ * threshold follows fading and DC offset without chasing the data.
+ */
+static bool dsp_slice(hal_radio_dsp_t *dsp, int32_t value)
+{
+    if (value > dsp->high) {
+        dsp->high = value;
+    } else {
+        dsp->high = dsp_qadd(dsp->high, -((dsp->high - value) >> dsp->config.decay_shift));
+    }
+
+    if (value < dsp->low) {
+        dsp->low = value;
+    } else {
+        dsp->low = dsp_qadd(dsp->low, (value - dsp->low) >> dsp->config.decay_shift);
+    }
+
+    int32_t middle = (dsp->high + dsp->low) >> 1;
+    int32_t hysteresis = (dsp->high - dsp->low) >> DSP_HYSTERESIS_SHIFT;
+
+    dsp->level = dsp->level ? (value > middle - hysteresis) : (value > middle + hysteresis);
+    return dsp->level;
+}
@@ -0,0 +1,162 @@
+/**
+ * @file hal_radio_internal.h
+ * @brief Radio HAL Internal Definitions
+ *
+ * Shared between the radio HAL dispatcher (hal_radio.c) and the
+ * hardware-specific radio drivers, not exposed to external users.
+ */
+
+#ifndef HAL_RADIO_INTERNAL_H
+#define HAL_RADIO_INTERNAL_H
+
+#include "hal_radio.h"
+#include "hal_ipcc.h"
+
+/**
+ * @brief Radio instance structure
+ */
+typedef struct {
+    uint32_t radio_id;                      /**< Radio instance ID */
+    hal_radio_type_t type;                  /**< Radio hardware type */
+    hal_radio_config_t config;              /**< Radio configuration */
+    volatile hal_radio_state_t state;       /**< Current radio state */
+    hal_radio_stats_t stats;                /**< Radio statistics */
+    hal_radio_event_callback_t callback;    /**< Event callback function */
+    void *callback_user_data;               /**< User data for callback */
+    bool in_use;                            /**< Instance in use flag */
+    void *hw_context;                       /**< Hardware-specific context */
+} hal_radio_instance_t;
+
+/**
+ * @brief Deliver an event to the instance's callback, if any
+ *
+ * May be called from interrupt context.
+ *
+ * @param instance Radio instance
+ * @param event Event type
+ * @param data Event-specific data
+ */
+void hal_radio_notify(hal_radio_instance_t *instance, hal_radio_event_t event, void *data);
+
+/**
+ * @brief Mask interrupts around state shared with the radio interrupt handlers
+ * @return Previous PRIMASK, for hal_radio_unlock()
+ */
+#ifdef HAL_CC1101_SIMULATOR
+/* Host build (scripts/bench): the CC1101 model holds its GDO interrupts instead */
+uint32_t hal_radio_lock(void);
+void hal_radio_unlock(uint32_t primask);
+#else
+static inline uint32_t hal_radio_lock(void)
+{
+    uint32_t primask;
+    __asm volatile ("MRS %0, primask\n\tcpsid i" : "=r" (primask) : : "memory");
+    return primask;
+}
+
+static inline void hal_radio_unlock(uint32_t primask)
+{
+    __asm volatile ("MSR primask, %0" : : "r" (primask) : "memory");
+}
+#endif
+
+/* Microsecond deadline timer (hal_radio_timer.c) */
+#define HAL_RADIO_TIMER_CHANNELS    4
+
+typedef void (*hal_radio_timer_callback_t)(void *user_data);
+
+hal_result_t hal_radio_timer_init(void);
+void hal_radio_timer_deinit(void);
+uint32_t hal_radio_timer_now(void);
+void hal_radio_timer_arm(uint32_t channel, uint32_t at_us, hal_radio_timer_callback_t callback, void *user_data);
+void hal_radio_timer_cancel(uint32_t channel);
+
+/* Raw capture buffer pool (hal_radio_capture.c) */
+hal_result_t hal_radio_capture_begin(hal_radio_instance_t *instance);
+void hal_radio_capture_end(hal_radio_instance_t *instance);
+void hal_radio_capture_edge(bool high, uint32_t duration_us);
+hal_result_t hal_radio_capture_take(hal_radio_instance_t *instance, const hal_radio_capture_buffer_t **buffer);
+hal_result_t hal_radio_capture_give(hal_radio_instance_t *instance, const hal_radio_capture_buffer_t *buffer);
+hal_result_t hal_radio_capture_drain(hal_radio_instance_t *instance, hal_radio_capture_sink_t sink,
+                                     void *user_data, uint32_t *spilled);
+hal_result_t hal_radio_capture_stats(hal_radio_instance_t *instance, hal_radio_capture_stats_t *stats);
+
+/* DMA baseband sampler (hal_radio_sampler.c) */
+hal_result_t hal_radio_sampler_begin(hal_radio_instance_t *instance, uint32_t pin, uint32_t sample_rate_hz);
+void hal_radio_sampler_end(hal_radio_instance_t *instance);
+hal_result_t hal_radio_sampler_take(hal_radio_instance_t *instance, const int16_t **samples, uint32_t *count,
+                                    uint32_t *missed);
+
+/* Client arbiter (hal_radio_arbiter.c) */
+#define HAL_RADIO_CONTEXT_REGISTERS 0x2F
+
+/**
+ * @brief Radio context of an arbiter client that does not hold the radio
+ */
+typedef struct {
+    hal_radio_config_t config;
+    hal_radio_event_callback_t callback;
+    void *callback_user_data;
+    uint8_t registers[HAL_RADIO_CONTEXT_REGISTERS]; /**< Driver register shadow */
+    uint8_t patable[2];
+    uint8_t pktctrl0;
+} hal_radio_context_t;
+
+hal_result_t hal_radio_arbiter_attach(hal_radio_instance_t *instance, const hal_radio_client_config_t *config,
+                                      hal_radio_client_t *client);
+void hal_radio_arbiter_detach(hal_radio_instance_t *instance);
+void hal_radio_arbiter_service(void);
+
+/* CC1101 driver (hal_radio_cc1101.c) */
+hal_result_t cc1101_init(hal_radio_instance_t *instance);
+hal_result_t cc1101_deinit(hal_radio_instance_t *instance);
+hal_result_t cc1101_configure(hal_radio_instance_t *instance, const hal_radio_config_t *config);
+hal_result_t cc1101_apply_preset(hal_radio_instance_t *instance, hal_radio_preset_t preset,
+                                 uint32_t frequency_hz, hal_radio_config_t *config);
+hal_result_t cc1101_set_scan_plan(hal_radio_instance_t *instance, const hal_radio_scan_plan_t *plan);
+hal_result_t cc1101_hop(hal_radio_instance_t *instance, uint16_t channel);
+hal_result_t cc1101_get_rssi(hal_radio_instance_t *instance, int8_t *rssi_dbm);
+hal_result_t cc1101_sweep(hal_radio_instance_t *instance, hal_radio_sweep_point_t *points, uint16_t max_points,
+                          uint16_t *count);
+hal_result_t cc1101_transmit(hal_radio_instance_t *instance, const hal_radio_packet_t *packet);
+hal_result_t cc1101_receive(hal_radio_instance_t *instance, hal_radio_packet_t *packet, uint32_t timeout_ms);
+hal_result_t cc1101_submit(hal_radio_instance_t *instance, bool transmit, hal_radio_packet_t *packet,
+                           const hal_radio_request_options_t *options, hal_radio_request_t *request);
+hal_result_t cc1101_cancel(hal_radio_instance_t *instance, hal_radio_request_t request);
+hal_result_t cc1101_start_capture(hal_radio_instance_t *instance);
+hal_result_t cc1101_stop_capture(hal_radio_instance_t *instance);
+hal_result_t cc1101_start_sampling(hal_radio_instance_t *instance, uint32_t sample_rate_hz);
+hal_result_t cc1101_start_wor(hal_radio_instance_t *instance, const hal_radio_wor_config_t *config,
+                              hal_radio_packet_t *packet, hal_radio_wor_timing_t *timing);
+hal_result_t cc1101_set_state(hal_radio_instance_t *instance, hal_radio_state_t state);
+void cc1101_save_context(hal_radio_instance_t *instance, hal_radio_context_t *context);
+hal_result_t cc1101_restore_context(hal_radio_instance_t *instance, const hal_radio_context_t *context);
+hal_result_t cc1101_read_register(hal_radio_instance_t *instance, uint8_t reg_addr, uint8_t *value);
+hal_result_t cc1101_write_register(hal_radio_instance_t *instance, uint8_t reg_addr, uint8_t value);
+
+/* Bluetooth driver (hal_radio_bluetooth.c) */
+hal_result_t bluetooth_init(hal_radio_instance_t *instance);
+hal_result_t bluetooth_deinit(hal_radio_instance_t *instance);
+hal_result_t bluetooth_configure(hal_radio_instance_t *instance, const hal_radio_config_t *config);
+hal_result_t bluetooth_transmit(hal_radio_instance_t *instance, const hal_radio_packet_t *packet);
+hal_result_t bluetooth_receive(hal_radio_instance_t *instance, hal_radio_packet_t *packet, uint32_t timeout_ms);
+hal_result_t bluetooth_set_state(hal_radio_instance_t *instance, hal_radio_state_t state);
+hal_result_t bluetooth_set_adv_set(hal_radio_instance_t *instance, uint8_t index, const hal_radio_adv_set_t *set);
+hal_result_t bluetooth_start_advertising(hal_radio_instance_t *instance);
+hal_result_t bluetooth_stop_advertising(hal_radio_instance_t *instance);
+hal_result_t bluetooth_start_scan(hal_radio_instance_t *instance, const hal_radio_scan_config_t *config);
+hal_result_t bluetooth_stop_scan(hal_radio_instance_t *instance);
+hal_result_t bluetooth_get_stats(hal_radio_instance_t *instance, hal_radio_bluetooth_stats_t *stats);
+hal_ipcc_buffer_t *bluetooth_acl_alloc(uint8_t **payload, uint16_t *capacity);
+hal_result_t bluetooth_acl_send(hal_ipcc_buffer_t *buffer, bool start, uint16_t length);
+
+/* L2CAP credit based channels (hal_radio_l2cap.c) */
+hal_result_t hal_radio_l2cap_attach(hal_radio_instance_t *instance, const hal_radio_l2cap_config_t *config,
+                                    bool listen, hal_radio_channel_t *channel);
+void hal_radio_l2cap_detach(hal_radio_instance_t *instance);
+void hal_radio_l2cap_link_up(void);
+void hal_radio_l2cap_link_down(void);
+void hal_radio_l2cap_receive(const uint8_t *data, uint32_t length);
+void hal_radio_l2cap_pump(void);
+
+#endif /* HAL_RADIO_INTERNAL_H */
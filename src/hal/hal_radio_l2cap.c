@@ -0,0 +1,987 @@
+/**
+ * @file hal_radio_l2cap.c
+ * @brief L2CAP LE credit based channels over the BLE connection
+ *
+ * Connection-oriented channels without GATT: each SDU is cut into
+ * K-frames of at most the peer's MPS, and each K-frame costs one of the
+ * credits the peer hands out. Our side offers an MPS that fills one
+ * 251-byte link packet, so with the Data Length Extension every K-frame
+ * travels as a single link layer packet.
+ *
+ * Data moves without staging copies:
+ * - sending, the bytes are gathered from the caller's segments straight
+ *   into the mailbox buffer of each ACL fragment;
+ * - receiving, K-frame payloads are appended straight into the channel's
+ *   SDU buffer as ACL fragments arrive.
+ *
+ * An L2CAP PDU must go out in consecutive ACL fragments, so the link sends
+ * one PDU at a time: signaling first, then channels in turn, one K-frame
+ * each.
+ *
+ * A peer that sends without credits, a K-frame over our MPS or an SDU
+ * over our MTU (or longer than its own SDU length) breaks the channel: it
+ * is disconnected and reported closed, as the specification requires.
+ */
+
+#include "hal_radio_internal.h"
+#include <string.h>
+
+/* L2CAP header */
+#define L2CAP_HEADER_SIZE           4       /* PDU length, channel ID */
+#define L2CAP_SDU_LENGTH_SIZE       2       /* Leads the first K-frame of an SDU */
+#define L2CAP_CID_LE_SIGNALING      0x0005
+#define L2CAP_CID_DYNAMIC           0x0040  /* First LE dynamic channel ID */
+
+/* LE signaling */
+#define L2CAP_SIGNAL_HEADER_SIZE    4       /* Code, identifier, length */
+#define L2CAP_COMMAND_REJECT        0x01
+#define L2CAP_DISCONNECTION_REQ     0x06
+#define L2CAP_DISCONNECTION_RSP     0x07
+#define L2CAP_LE_CONNECTION_REQ     0x14
+#define L2CAP_LE_CONNECTION_RSP     0x15
+#define L2CAP_LE_FLOW_CONTROL_CREDIT 0x16
+
+/* LE credit based connection results */
+#define L2CAP_RESULT_SUCCESS        0x0000
+#define L2CAP_RESULT_BAD_PSM        0x0002
+#define L2CAP_RESULT_NO_RESOURCES   0x0004
+#define L2CAP_RESULT_CID_IN_USE     0x000A
+#define L2CAP_RESULT_BAD_PARAMETERS 0x000B
+
+/* Channel limits */
+#define L2CAP_MTU_MIN               23
+#define L2CAP_MPS_MIN               23
+#define L2CAP_MPS                   247     /* One 251-byte link packet with the L2CAP header */
+#define L2CAP_CREDITS_MAX           65535
+
+/* Outgoing signaling packets (power of two) and incoming signaling PDU limit */
+#define L2CAP_SIGNAL_QUEUE          8
+#define L2CAP_SIGNAL_DATA_MAX       16
+#define L2CAP_SIGNAL_RX_MAX         64
+
+/* HCI ACL header as delivered by the controller */
+#define L2CAP_ACL_HEADER_SIZE       4
+#define L2CAP_ACL_PB_MASK           0x3000
+#define L2CAP_ACL_PB_CONTINUE       0x1000
+
+/**
+ * @brief Channel states
+ */
+typedef enum {
+    L2CAP_STATE_IDLE = 0,                   /**< Waiting for a link to connect over */
+    L2CAP_STATE_LISTEN,                     /**< Waiting for the peer's connection request */
+    L2CAP_STATE_PENDING,                    /**< Connection request waits for room in the signaling queue */
+    L2CAP_STATE_CONNECTING,                 /**< Our connection request is out */
+    L2CAP_STATE_OPEN                        /**< Connected */
+} l2cap_state_t;
+
+/**
+ * @brief Queued SDU
+ */
+typedef struct {
+    const hal_radio_segment_t *segments;
+    uint32_t count;
+    uint32_t length;                        /**< Total bytes */
+} l2cap_sdu_t;
+
+/**
+ * @brief Credit based channel
+ */
+typedef struct {
+    hal_radio_channel_t handle;             /**< HAL_RADIO_CHANNEL_NONE if the slot is free */
+    hal_radio_instance_t *instance;
+    hal_radio_l2cap_config_t config;
+    bool listen;                            /**< Accepts rather than connects */
+    l2cap_state_t state;
+    uint16_t local_cid;
+    uint16_t remote_cid;
+    uint16_t remote_mps;
+    uint16_t tx_credits;                    /**< K-frames the peer accepts now */
+    uint16_t rx_credits;                    /**< K-frames the peer may still send */
+    uint16_t rx_credits_owed;               /**< Credits to hand back to the peer */
+    uint16_t rx_initial_credits;
+    uint8_t identifier;                     /**< Of our pending connection request */
+    hal_radio_l2cap_stats_t stats;
+
+    /* Transmit: SDU queue and position in the head SDU */
+    l2cap_sdu_t queue[HAL_RADIO_L2CAP_QUEUE];
+    uint32_t queue_head;
+    uint32_t queue_tail;
+    uint32_t tx_offset;                     /**< SDU bytes gathered */
+    uint32_t tx_segment;                    /**< Segment holding the next byte */
+    uint32_t tx_segment_offset;
+
+    /* Receive: SDU being reassembled into config.rx_buffer */
+    bool rx_in_sdu;
+    uint8_t rx_header_needed;               /**< SDU length bytes still to read */
+    uint16_t rx_sdu_length;
+    uint16_t rx_received;
+    uint16_t rx_frames;                     /**< K-frames of the SDU so far */
+} l2cap_channel_t;
+
+/**
+ * @brief Outgoing signaling packet
+ */
+typedef struct {
+    uint8_t code;
+    uint8_t identifier;
+    uint8_t length;
+    uint8_t data[L2CAP_SIGNAL_DATA_MAX];
+} l2cap_signal_t;
+
+/* Channels */
+static l2cap_channel_t l2cap_channels[HAL_RADIO_L2CAP_CHANNELS];
+static hal_radio_channel_t l2cap_next_handle = 1;
+static bool l2cap_link;                     /* A BLE connection is up */
+static uint8_t l2cap_next_identifier = 1;
+static uint32_t l2cap_turn;                 /* Channel that sends next */
+
+/* Signaling queue */
+static l2cap_signal_t l2cap_signals[L2CAP_SIGNAL_QUEUE];
+static uint32_t l2cap_signal_head;
+static uint32_t l2cap_signal_tail;
+
+/* PDU being sent: channel (NULL for none) and K-frame bytes not yet gathered */
+static l2cap_channel_t *l2cap_tx_channel;
+static uint32_t l2cap_tx_left;
+
+/* PDU being received */
+static uint16_t l2cap_rx_cid;               /* 0 when nothing is expected */
+static uint32_t l2cap_rx_left;              /* PDU bytes still to come */
+static uint8_t l2cap_rx_signal[L2CAP_SIGNAL_RX_MAX];
+static uint32_t l2cap_rx_signal_length;
+
+/* Static function prototypes */
+static l2cap_channel_t *l2cap_find(hal_radio_channel_t handle);
+static l2cap_channel_t *l2cap_find_cid(uint16_t local_cid);
+static void l2cap_start(l2cap_channel_t *channel);
+static void l2cap_opened(l2cap_channel_t *channel, uint16_t remote_cid, uint16_t mtu, uint16_t mps,
+                         uint16_t credits);
+static void l2cap_closed(l2cap_channel_t *channel);
+static void l2cap_drop_queue(l2cap_channel_t *channel);
+static void l2cap_disconnect(l2cap_channel_t *channel);
+static bool l2cap_signal(uint8_t code, uint8_t identifier, const uint8_t *data, uint8_t length);
+static bool l2cap_request(uint8_t code, const uint8_t *data, uint8_t length, uint8_t *identifier);
+static void l2cap_signal_received(const uint8_t *data, uint32_t length);
+static void l2cap_connection_request(uint8_t identifier, const uint8_t *data, uint32_t length);
+static void l2cap_connection_response(uint8_t identifier, uint16_t dcid, uint16_t mtu, uint16_t mps,
+                                      uint16_t credits, uint16_t result);
+static void l2cap_frame_received(l2cap_channel_t *channel);
+static void l2cap_payload_received(l2cap_channel_t *channel, const uint8_t *data, uint32_t length);
+static void l2cap_sdu_done(l2cap_channel_t *channel);
+static bool l2cap_send_signal(void);
+static bool l2cap_send_frame(void);
+static void l2cap_gather(l2cap_channel_t *channel, uint8_t *destination, uint32_t length);
+static void l2cap_rewind(l2cap_channel_t *channel, uint32_t offset, uint32_t segment, uint32_t segment_offset);
+static uint16_t l2cap_get16(const uint8_t *data);
+static void l2cap_put16(uint8_t *data, uint16_t value);
+
+/**
+ * @brief Add a channel, connecting or listening once a link is up
+ */
+hal_result_t hal_radio_l2cap_attach(hal_radio_instance_t *instance, const hal_radio_l2cap_config_t *config,
+                                    bool listen, hal_radio_channel_t *channel)
+{
+    if (config->psm == 0 || config->psm > 0x00FF || config->mtu < L2CAP_MTU_MIN) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    uint32_t index;
+    for (index = 0; index < HAL_RADIO_L2CAP_CHANNELS; index++) {
+        if (l2cap_channels[index].handle == HAL_RADIO_CHANNEL_NONE) {
+            break;
+        }
+        if (listen && l2cap_channels[index].listen && l2cap_channels[index].config.psm == config->psm) {
+            return HAL_ERROR_RESOURCE_BUSY;
+        }
+    }
+    if (index == HAL_RADIO_L2CAP_CHANNELS) {
+        return HAL_ERROR_NO_MEMORY;
+    }
+
+    l2cap_channel_t *entry = &l2cap_channels[index];
+    memset(entry, 0, sizeof(*entry));
+    entry->instance = instance;
+    entry->config = *config;
+    entry->listen = listen;
+    entry->local_cid = (uint16_t)(L2CAP_CID_DYNAMIC + index);
+
+    /* Enough credits for one whole SDU unless asked for more */
+    uint32_t frames = ((uint32_t)config->mtu + L2CAP_SDU_LENGTH_SIZE + L2CAP_MPS - 1) / L2CAP_MPS;
+    entry->rx_initial_credits = (uint16_t)((config->rx_credits > frames) ? config->rx_credits : frames);
+
+    entry->handle = l2cap_next_handle++;
+    if (l2cap_next_handle == HAL_RADIO_CHANNEL_NONE) {
+        l2cap_next_handle = 1;
+    }
+
+    *channel = entry->handle;
+    if (l2cap_link) {
+        l2cap_start(entry);
+    } else {
+        entry->state = listen ? L2CAP_STATE_LISTEN : L2CAP_STATE_IDLE;
+    }
+    return HAL_OK;
+}
+
+/**
+ * @brief Drop every channel of a radio that is being closed
+ */
+void hal_radio_l2cap_detach(hal_radio_instance_t *instance)
+{
+    for (uint32_t i = 0; i < HAL_RADIO_L2CAP_CHANNELS; i++) {
+        if (l2cap_channels[i].instance == instance) {
+            memset(&l2cap_channels[i], 0, sizeof(l2cap_channels[i]));
+        }
+    }
+
+    l2cap_link = false;
+    l2cap_tx_channel = NULL;
+    l2cap_rx_cid = 0;
+    l2cap_signal_head = l2cap_signal_tail = 0;
+}
+
+/**
+ * @brief A BLE connection came up: connect the connecting channels
+ */
+void hal_radio_l2cap_link_up(void)
+{
+    l2cap_link = true;
+    l2cap_tx_channel = NULL;
+    l2cap_rx_cid = 0;
+    l2cap_signal_head = l2cap_signal_tail = 0;
+
+    for (uint32_t i = 0; i < HAL_RADIO_L2CAP_CHANNELS; i++) {
+        if (l2cap_channels[i].handle != HAL_RADIO_CHANNEL_NONE) {
+            l2cap_start(&l2cap_channels[i]);
+        }
+    }
+}
+
+/**
+ * @brief The BLE connection went down: every channel closes with it
+ */
+void hal_radio_l2cap_link_down(void)
+{
+    l2cap_link = false;
+    l2cap_tx_channel = NULL;
+    l2cap_rx_cid = 0;
+
+    for (uint32_t i = 0; i < HAL_RADIO_L2CAP_CHANNELS; i++) {
+        l2cap_channel_t *channel = &l2cap_channels[i];
+        if (channel->handle != HAL_RADIO_CHANNEL_NONE && channel->state != L2CAP_STATE_IDLE &&
+            channel->state != L2CAP_STATE_LISTEN) {
+            l2cap_closed(channel);
+        }
+        if (channel->handle != HAL_RADIO_CHANNEL_NONE) {
+            channel->state = channel->listen ? L2CAP_STATE_LISTEN : L2CAP_STATE_IDLE;
+        }
+    }
+}
+
+/**
+ * @brief Take one HCI ACL packet from the controller
+ *
+ * A starting fragment begins a new PDU, discarding any unfinished one.
+ */
+void hal_radio_l2cap_receive(const uint8_t *data, uint32_t length)
+{
+    if (length < L2CAP_ACL_HEADER_SIZE) {
+        return;
+    }
+
+    uint16_t flags = (uint16_t)(l2cap_get16(data) & L2CAP_ACL_PB_MASK);
+    uint32_t payload_length = l2cap_get16(&data[2]);
+    const uint8_t *payload = &data[L2CAP_ACL_HEADER_SIZE];
+
+    if (payload_length > length - L2CAP_ACL_HEADER_SIZE) {
+        return;
+    }
+
+    if (flags != L2CAP_ACL_PB_CONTINUE) {
+        if (payload_length < L2CAP_HEADER_SIZE) {
+            l2cap_rx_cid = 0;
+            return;
+        }
+        l2cap_rx_left = l2cap_get16(payload);
+        l2cap_rx_cid = l2cap_get16(&payload[2]);
+        l2cap_rx_signal_length = 0;
+        payload += L2CAP_HEADER_SIZE;
+        payload_length -= L2CAP_HEADER_SIZE;
+
+        l2cap_channel_t *channel = l2cap_find_cid(l2cap_rx_cid);
+        if (channel != NULL) {
+            l2cap_frame_received(channel);
+        }
+    }
+
+    if (l2cap_rx_cid == 0) {
+        return;
+    }
+    if (payload_length > l2cap_rx_left) {
+        payload_length = l2cap_rx_left;
+    }
+    l2cap_rx_left -= payload_length;
+
+    if (l2cap_rx_cid == L2CAP_CID_LE_SIGNALING) {
+        if (l2cap_rx_signal_length + payload_length <= L2CAP_SIGNAL_RX_MAX) {
+            memcpy(&l2cap_rx_signal[l2cap_rx_signal_length], payload, payload_length);
+        }
+        l2cap_rx_signal_length += payload_length;
+        if (l2cap_rx_left == 0 && l2cap_rx_signal_length <= L2CAP_SIGNAL_RX_MAX) {
+            l2cap_signal_received(l2cap_rx_signal, l2cap_rx_signal_length);
+        }
+    } else {
+        l2cap_channel_t *channel = l2cap_find_cid(l2cap_rx_cid);
+        if (channel != NULL) {
+            l2cap_payload_received(channel, payload, payload_length);
+        }
+    }
+
+    if (l2cap_rx_left == 0) {
+        l2cap_rx_cid = 0;
+    }
+}
+
+/**
+ * @brief Send as much as credits and controller buffers allow
+ */
+void hal_radio_l2cap_pump(void)
+{
+    if (!l2cap_link) {
+        return;
+    }
+
+    /* Connection requests and credits owed that found the signaling queue full, if it has room now */
+    for (uint32_t i = 0; i < HAL_RADIO_L2CAP_CHANNELS; i++) {
+        l2cap_channel_t *channel = &l2cap_channels[i];
+        if (channel->state == L2CAP_STATE_PENDING) {
+            l2cap_start(channel);
+        }
+        if (channel->state == L2CAP_STATE_OPEN && channel->rx_credits_owed > 0) {
+            uint8_t data[4];
+            l2cap_put16(&data[0], channel->local_cid);
+            l2cap_put16(&data[2], channel->rx_credits_owed);
+            if (l2cap_request(L2CAP_LE_FLOW_CONTROL_CREDIT, data, sizeof(data), NULL)) {
+                channel->rx_credits += channel->rx_credits_owed;
+                channel->rx_credits_owed = 0;
+            }
+        }
+    }
+
+    while (l2cap_send_signal() || l2cap_send_frame()) {
+    }
+}
+
+hal_result_t hal_radio_l2cap_send(hal_radio_channel_t channel, const hal_radio_segment_t *segments,
+                                  uint32_t count)
+{
+    if (segments == NULL || count == 0) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    l2cap_channel_t *entry = l2cap_find(channel);
+    if (entry == NULL) {
+        return HAL_ERROR_RESOURCE_NOT_FOUND;
+    }
+    if (entry->state != L2CAP_STATE_OPEN) {
+        return HAL_ERROR_NOT_INITIALIZED;
+    }
+
+    uint32_t length = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        if (segments[i].data == NULL && segments[i].length != 0) {
+            return HAL_ERROR_INVALID_PARAM;
+        }
+        length += segments[i].length;
+    }
+    if (length > entry->stats.peer_mtu) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+    if (entry->queue_head - entry->queue_tail >= HAL_RADIO_L2CAP_QUEUE) {
+        return HAL_ERROR_RESOURCE_BUSY;
+    }
+
+    l2cap_sdu_t *sdu = &entry->queue[entry->queue_head % HAL_RADIO_L2CAP_QUEUE];
+    sdu->segments = segments;
+    sdu->count = count;
+    sdu->length = length;
+    entry->queue_head++;
+
+    hal_radio_l2cap_pump();
+    return HAL_OK;
+}
+
+hal_result_t hal_radio_l2cap_close(hal_radio_channel_t channel)
+{
+    l2cap_channel_t *entry = l2cap_find(channel);
+    if (entry == NULL) {
+        return HAL_ERROR_RESOURCE_NOT_FOUND;
+    }
+
+    if (entry->state == L2CAP_STATE_OPEN) {
+        uint8_t data[4];
+        l2cap_put16(&data[0], entry->remote_cid);
+        l2cap_put16(&data[2], entry->local_cid);
+        l2cap_request(L2CAP_DISCONNECTION_REQ, data, sizeof(data), NULL);
+    }
+
+    /* A K-frame cut short is discarded by the peer when the next PDU starts */
+    if (l2cap_tx_channel == entry) {
+        l2cap_tx_channel = NULL;
+    }
+
+    memset(entry, 0, sizeof(*entry));
+    hal_radio_l2cap_pump();
+    return HAL_OK;
+}
+
+hal_result_t hal_radio_l2cap_get_stats(hal_radio_channel_t channel, hal_radio_l2cap_stats_t *stats)
+{
+    if (stats == NULL) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    l2cap_channel_t *entry = l2cap_find(channel);
+    if (entry == NULL) {
+        return HAL_ERROR_RESOURCE_NOT_FOUND;
+    }
+
+    *stats = entry->stats;
+    stats->tx_credits = entry->tx_credits;
+    return HAL_OK;
+}
+
+/* Static helper functions */
+
+static l2cap_channel_t *l2cap_find(hal_radio_channel_t handle)
+{
+    for (uint32_t i = 0; i < HAL_RADIO_L2CAP_CHANNELS && handle != HAL_RADIO_CHANNEL_NONE; i++) {
+        if (l2cap_channels[i].handle == handle) {
+            return &l2cap_channels[i];
+        }
+    }
+    return NULL;
+}
+
+static l2cap_channel_t *l2cap_find_cid(uint16_t local_cid)
+{
+    for (uint32_t i = 0; i < HAL_RADIO_L2CAP_CHANNELS; i++) {
+        if (l2cap_channels[i].handle != HAL_RADIO_CHANNEL_NONE && l2cap_channels[i].local_cid == local_cid &&
+            l2cap_channels[i].state == L2CAP_STATE_OPEN) {
+            return &l2cap_channels[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Begin establishing a channel on a fresh link
+ *
+ * With the signaling queue full the channel waits in PENDING and the
+ * next pump tries again.
+ */
+static void l2cap_start(l2cap_channel_t *channel)
+{
+    if (channel->listen) {
+        channel->state = L2CAP_STATE_LISTEN;
+        return;
+    }
+
+    uint8_t data[10];
+    l2cap_put16(&data[0], channel->config.psm);
+    l2cap_put16(&data[2], channel->local_cid);
+    l2cap_put16(&data[4], channel->config.mtu);
+    l2cap_put16(&data[6], L2CAP_MPS);
+    l2cap_put16(&data[8], channel->rx_initial_credits);
+
+    channel->state = l2cap_request(L2CAP_LE_CONNECTION_REQ, data, sizeof(data), &channel->identifier) ?
+                     L2CAP_STATE_CONNECTING : L2CAP_STATE_PENDING;
+}
+
+/**
+ * @brief Channel is up with the peer's parameters
+ */
+static void l2cap_opened(l2cap_channel_t *channel, uint16_t remote_cid, uint16_t mtu, uint16_t mps,
+                         uint16_t credits)
+{
+    channel->state = L2CAP_STATE_OPEN;
+    channel->remote_cid = remote_cid;
+    channel->remote_mps = mps;
+    channel->tx_credits = credits;
+    channel->rx_credits = channel->rx_initial_credits;
+    channel->rx_credits_owed = 0;
+    channel->rx_in_sdu = false;
+    channel->stats.peer_mtu = mtu;
+    channel->stats.peer_mps = mps;
+
+    channel->config.callback(channel->handle, HAL_RADIO_L2CAP_OPENED, NULL, 0, channel->config.user_data);
+}
+
+/**
+ * @brief Channel is down: report it and forget queued SDUs
+ */
+static void l2cap_closed(l2cap_channel_t *channel)
+{
+    if (l2cap_tx_channel == channel) {
+        l2cap_tx_channel = NULL;
+    }
+
+    l2cap_drop_queue(channel);
+    channel->state = channel->listen ? L2CAP_STATE_LISTEN : L2CAP_STATE_IDLE;
+    channel->config.callback(channel->handle, HAL_RADIO_L2CAP_CLOSED, NULL, 0, channel->config.user_data);
+}
+
+static void l2cap_drop_queue(l2cap_channel_t *channel)
+{
+    channel->queue_tail = channel->queue_head;
+    channel->tx_offset = 0;
+    channel->tx_segment = 0;
+    channel->tx_segment_offset = 0;
+}
+
+/**
+ * @brief The peer broke the channel: ask it to disconnect, ignore the rest of the PDU, report it closed
+ */
+static void l2cap_disconnect(l2cap_channel_t *channel)
+{
+    uint8_t data[4];
+
+    l2cap_put16(&data[0], channel->remote_cid);
+    l2cap_put16(&data[2], channel->local_cid);
+    l2cap_request(L2CAP_DISCONNECTION_REQ, data, sizeof(data), NULL);
+
+    if (channel->rx_in_sdu) {
+        channel->rx_in_sdu = false;
+        channel->stats.sdus_dropped++;
+    }
+    l2cap_rx_cid = 0;
+    l2cap_closed(channel);
+}
+
+/**
+ * @brief Queue a signaling packet
+ * @return false if the queue is full
+ */
+static bool l2cap_signal(uint8_t code, uint8_t identifier, const uint8_t *data, uint8_t length)
+{
+    if (l2cap_signal_head - l2cap_signal_tail >= L2CAP_SIGNAL_QUEUE) {
+        return false;
+    }
+
+    l2cap_signal_t *signal = &l2cap_signals[l2cap_signal_head & (L2CAP_SIGNAL_QUEUE - 1)];
+    signal->code = code;
+    signal->identifier = identifier;
+    signal->length = length;
+    memcpy(signal->data, data, length);
+    l2cap_signal_head++;
+    return true;
+}
+
+/**
+ * @brief Queue a request under a fresh identifier, taken only if it is queued
+ * @param identifier Pointer to store the identifier (may be NULL)
+ * @return false if the queue is full
+ */
+static bool l2cap_request(uint8_t code, const uint8_t *data, uint8_t length, uint8_t *identifier)
+{
+    uint8_t next = l2cap_next_identifier;
+
+    if (!l2cap_signal(code, next, data, length)) {
+        return false;
+    }
+
+    /* Identifier 0 is never valid */
+    l2cap_next_identifier = (uint8_t)((next == 0xFF) ? 1 : next + 1);
+    if (identifier != NULL) {
+        *identifier = next;
+    }
+    return true;
+}
+
+/**
+ * @brief Handle a signaling PDU, which may hold several commands
+ */
+static void l2cap_signal_received(const uint8_t *data, uint32_t length)
+{
+    while (length >= L2CAP_SIGNAL_HEADER_SIZE) {
+        uint8_t code = data[0];
+        uint8_t identifier = data[1];
+        uint32_t command_length = l2cap_get16(&data[2]);
+        const uint8_t *params = &data[L2CAP_SIGNAL_HEADER_SIZE];
+
+        if (command_length > length - L2CAP_SIGNAL_HEADER_SIZE) {
+            return;
+        }
+
+        switch (code) {
+            case L2CAP_LE_CONNECTION_REQ:
+                l2cap_connection_request(identifier, params, command_length);
+                break;
+
+            case L2CAP_LE_CONNECTION_RSP:
+                for (uint32_t i = 0; i < HAL_RADIO_L2CAP_CHANNELS && command_length >= 10; i++) {
+                    l2cap_channel_t *channel = &l2cap_channels[i];
+                    if (channel->state != L2CAP_STATE_CONNECTING || channel->identifier != identifier) {
+                        continue;
+                    }
+                    uint16_t mtu = l2cap_get16(&params[2]);
+                    uint16_t mps = l2cap_get16(&params[4]);
+                    if (l2cap_get16(&params[8]) == L2CAP_RESULT_SUCCESS &&
+                        mtu >= L2CAP_MTU_MIN && mps >= L2CAP_MPS_MIN) {
+                        l2cap_opened(channel, l2cap_get16(&params[0]), mtu, mps, l2cap_get16(&params[6]));
+                    } else {
+                        l2cap_closed(channel);
+                    }
+                }
+                break;
+
+            case L2CAP_LE_FLOW_CONTROL_CREDIT:
+                if (command_length >= 4) {
+                    uint16_t cid = l2cap_get16(&params[0]);
+                    for (uint32_t i = 0; i < HAL_RADIO_L2CAP_CHANNELS; i++) {
+                        l2cap_channel_t *channel = &l2cap_channels[i];
+                        if (channel->state == L2CAP_STATE_OPEN && channel->remote_cid == cid) {
+                            uint32_t credits = (uint32_t)channel->tx_credits + l2cap_get16(&params[2]);
+                            channel->tx_credits = (uint16_t)((credits > L2CAP_CREDITS_MAX) ?
+                                                             L2CAP_CREDITS_MAX : credits);
+                        }
+                    }
+                }
+                break;
+
+            case L2CAP_DISCONNECTION_REQ:
+                if (command_length >= 4) {
+                    l2cap_channel_t *channel = l2cap_find_cid(l2cap_get16(&params[0]));
+                    l2cap_signal(L2CAP_DISCONNECTION_RSP, identifier, params, 4);
+                    if (channel != NULL) {
+                        l2cap_closed(channel);
+                    }
+                }
+                break;
+
+            case L2CAP_DISCONNECTION_RSP:
+            case L2CAP_COMMAND_REJECT:
+                break;
+
+            default: {
+                uint8_t reason[2] = { 0x00, 0x00 };     /* Command not understood */
+                l2cap_signal(L2CAP_COMMAND_REJECT, identifier, reason, sizeof(reason));
+                break;
+            }
+        }
+
+        data += L2CAP_SIGNAL_HEADER_SIZE + command_length;
+        length -= L2CAP_SIGNAL_HEADER_SIZE + command_length;
+    }
+}
+
+/**
+ * @brief Answer the peer's LE credit based connection request
+ */
+static void l2cap_connection_request(uint8_t identifier, const uint8_t *data, uint32_t length)
+{
+    if (length < 10) {
+        return;
+    }
+
+    uint16_t psm = l2cap_get16(&data[0]);
+    uint16_t scid = l2cap_get16(&data[2]);
+    uint16_t mtu = l2cap_get16(&data[4]);
+    uint16_t mps = l2cap_get16(&data[6]);
+    uint16_t credits = l2cap_get16(&data[8]);
+    l2cap_channel_t *listener = NULL;
+    bool known_psm = false;
+
+    for (uint32_t i = 0; i < HAL_RADIO_L2CAP_CHANNELS; i++) {
+        l2cap_channel_t *channel = &l2cap_channels[i];
+        if (channel->handle == HAL_RADIO_CHANNEL_NONE || !channel->listen || channel->config.psm != psm) {
+            continue;
+        }
+        known_psm = true;
+        if (channel->state == L2CAP_STATE_OPEN && channel->remote_cid == scid) {
+            l2cap_connection_response(identifier, 0, 0, 0, 0, L2CAP_RESULT_CID_IN_USE);
+            return;
+        }
+        if (channel->state == L2CAP_STATE_LISTEN && listener == NULL) {
+            listener = channel;
+        }
+    }
+
+    if (!known_psm) {
+        l2cap_connection_response(identifier, 0, 0, 0, 0, L2CAP_RESULT_BAD_PSM);
+    } else if (listener == NULL) {
+        l2cap_connection_response(identifier, 0, 0, 0, 0, L2CAP_RESULT_NO_RESOURCES);
+    } else if (mtu < L2CAP_MTU_MIN || mps < L2CAP_MPS_MIN) {
+        l2cap_connection_response(identifier, 0, 0, 0, 0, L2CAP_RESULT_BAD_PARAMETERS);
+    } else {
+        l2cap_connection_response(identifier, listener->local_cid, listener->config.mtu, L2CAP_MPS,
+                                  listener->rx_initial_credits, L2CAP_RESULT_SUCCESS);
+        l2cap_opened(listener, scid, mtu, mps, credits);
+    }
+}
+
+static void l2cap_connection_response(uint8_t identifier, uint16_t dcid, uint16_t mtu, uint16_t mps,
+                                      uint16_t credits, uint16_t result)
+{
+    uint8_t data[10];
+
+    l2cap_put16(&data[0], dcid);
+    l2cap_put16(&data[2], mtu);
+    l2cap_put16(&data[4], mps);
+    l2cap_put16(&data[6], credits);
+    l2cap_put16(&data[8], result);
+    l2cap_signal(L2CAP_LE_CONNECTION_RSP, identifier, data, sizeof(data));
+}
+
+/**
+ * @brief A K-frame starts on a channel
+ */
+static void l2cap_frame_received(l2cap_channel_t *channel)
+{
+    channel->stats.frames_received++;
+
+    /* Sending without credits or over the MPS we offered breaks the channel */
+    if (channel->rx_credits == 0 || l2cap_rx_left > L2CAP_MPS) {
+        l2cap_disconnect(channel);
+        return;
+    }
+    channel->rx_credits--;
+
+    if (!channel->rx_in_sdu) {
+        channel->rx_in_sdu = true;
+        channel->rx_header_needed = L2CAP_SDU_LENGTH_SIZE;
+        channel->rx_sdu_length = 0;
+        channel->rx_received = 0;
+        channel->rx_frames = 0;
+    }
+    channel->rx_frames++;
+}
+
+/**
+ * @brief Append K-frame bytes to the SDU being reassembled
+ */
+static void l2cap_payload_received(l2cap_channel_t *channel, const uint8_t *data, uint32_t length)
+{
+    while (length > 0 && channel->rx_header_needed > 0) {
+        channel->rx_sdu_length = (uint16_t)(channel->rx_sdu_length | (data[0] << (8 * (L2CAP_SDU_LENGTH_SIZE -
+                                                                                      channel->rx_header_needed))));
+        channel->rx_header_needed--;
+        data++;
+        length--;
+        if (channel->rx_header_needed == 0 && channel->rx_sdu_length > channel->config.mtu) {
+            l2cap_disconnect(channel);
+            return;
+        }
+    }
+
+    /* K-frames carrying more than the SDU length said also break the channel */
+    if (length > (uint32_t)channel->rx_sdu_length - channel->rx_received) {
+        l2cap_disconnect(channel);
+        return;
+    }
+    memcpy(&channel->config.rx_buffer[channel->rx_received], data, length);
+    channel->rx_received = (uint16_t)(channel->rx_received + length);
+
+    if (channel->rx_header_needed == 0 && l2cap_rx_left == 0 && channel->rx_received == channel->rx_sdu_length) {
+        l2cap_sdu_done(channel);
+    }
+}
+
+/**
+ * @brief SDU complete: deliver it and owe its credits back
+ */
+static void l2cap_sdu_done(l2cap_channel_t *channel)
+{
+    channel->rx_in_sdu = false;
+    channel->rx_credits_owed = (uint16_t)(channel->rx_credits_owed + channel->rx_frames);
+
+    channel->stats.sdus_received++;
+    channel->stats.bytes_received += channel->rx_sdu_length;
+    channel->config.callback(channel->handle, HAL_RADIO_L2CAP_RECEIVED, channel->config.rx_buffer,
+                             channel->rx_sdu_length, channel->config.user_data);
+}
+
+/**
+ * @brief Send the next signaling packet, unless a K-frame is half sent
+ * @return true if a packet went out
+ */
+static bool l2cap_send_signal(void)
+{
+    if (l2cap_tx_channel != NULL || l2cap_signal_tail == l2cap_signal_head) {
+        return false;
+    }
+
+    uint8_t *payload;
+    uint16_t capacity;
+    const l2cap_signal_t *signal = &l2cap_signals[l2cap_signal_tail & (L2CAP_SIGNAL_QUEUE - 1)];
+    uint16_t length = (uint16_t)(L2CAP_HEADER_SIZE + L2CAP_SIGNAL_HEADER_SIZE + signal->length);
+    hal_ipcc_buffer_t *buffer = bluetooth_acl_alloc(&payload, &capacity);
+
+    if (buffer == NULL) {
+        return false;
+    }
+    if (capacity < length) {
+        hal_ipcc_free(buffer);
+        return false;
+    }
+
+    l2cap_put16(&payload[0], (uint16_t)(L2CAP_SIGNAL_HEADER_SIZE + signal->length));
+    l2cap_put16(&payload[2], L2CAP_CID_LE_SIGNALING);
+    payload[4] = signal->code;
+    payload[5] = signal->identifier;
+    l2cap_put16(&payload[6], signal->length);
+    memcpy(&payload[8], signal->data, signal->length);
+
+    if (bluetooth_acl_send(buffer, true, length) != HAL_OK) {
+        return false;
+    }
+    l2cap_signal_tail++;
+    return true;
+}
+
+/**
+ * @brief Send the next ACL fragment of channel data
+ *
+ * Continues the K-frame in progress, or starts one on the next channel in
+ * turn that has data and credits.
+ *
+ * @return true if a fragment went out
+ */
+static bool l2cap_send_frame(void)
+{
+    uint8_t *payload;
+    uint16_t capacity;
+    l2cap_channel_t *channel = l2cap_tx_channel;
+    hal_ipcc_buffer_t *buffer;
+
+    if (channel != NULL) {
+        buffer = bluetooth_acl_alloc(&payload, &capacity);
+        if (buffer == NULL) {
+            return false;
+        }
+
+        uint32_t offset = channel->tx_offset;
+        uint32_t segment = channel->tx_segment;
+        uint32_t segment_offset = channel->tx_segment_offset;
+        uint16_t length = (uint16_t)((l2cap_tx_left < capacity) ? l2cap_tx_left : capacity);
+        l2cap_gather(channel, payload, length);
+        if (bluetooth_acl_send(buffer, false, length) != HAL_OK) {
+            l2cap_rewind(channel, offset, segment, segment_offset);
+            return false;
+        }
+        l2cap_tx_left -= length;
+    } else {
+        for (uint32_t i = 0; i < HAL_RADIO_L2CAP_CHANNELS && channel == NULL; i++) {
+            l2cap_channel_t *candidate = &l2cap_channels[(l2cap_turn + i) % HAL_RADIO_L2CAP_CHANNELS];
+            if (candidate->state == L2CAP_STATE_OPEN && candidate->queue_tail != candidate->queue_head &&
+                candidate->tx_credits > 0) {
+                channel = candidate;
+                l2cap_turn = (uint32_t)(candidate - l2cap_channels) + 1;
+            }
+        }
+        if (channel == NULL) {
+            return false;
+        }
+
+        buffer = bluetooth_acl_alloc(&payload, &capacity);
+        if (buffer == NULL) {
+            return false;
+        }
+
+        /* K-frame: L2CAP header, SDU length if first, then up to MPS bytes in all */
+        const l2cap_sdu_t *sdu = &channel->queue[channel->queue_tail % HAL_RADIO_L2CAP_QUEUE];
+        uint32_t header = (channel->tx_offset == 0) ? L2CAP_SDU_LENGTH_SIZE : 0;
+        uint32_t data = sdu->length - channel->tx_offset;
+        if (header + data > channel->remote_mps) {
+            data = channel->remote_mps - header;
+        }
+
+        l2cap_put16(&payload[0], (uint16_t)(header + data));
+        l2cap_put16(&payload[2], channel->remote_cid);
+        if (header != 0) {
+            l2cap_put16(&payload[L2CAP_HEADER_SIZE], (uint16_t)sdu->length);
+        }
+
+        uint32_t offset = channel->tx_offset;
+        uint32_t segment = channel->tx_segment;
+        uint32_t segment_offset = channel->tx_segment_offset;
+        uint32_t room = capacity - L2CAP_HEADER_SIZE - header;
+        uint16_t first = (uint16_t)((data < room) ? data : room);
+        l2cap_gather(channel, &payload[L2CAP_HEADER_SIZE + header], first);
+        if (bluetooth_acl_send(buffer, true, (uint16_t)(L2CAP_HEADER_SIZE + header + first)) != HAL_OK) {
+            l2cap_rewind(channel, offset, segment, segment_offset);
+            return false;
+        }
+
+        channel->tx_credits--;
+        channel->stats.frames_sent++;
+        l2cap_tx_channel = channel;
+        l2cap_tx_left = data - first;
+    }
+
+    if (l2cap_tx_left == 0) {
+        l2cap_tx_channel = NULL;
+
+        const l2cap_sdu_t *sdu = &channel->queue[channel->queue_tail % HAL_RADIO_L2CAP_QUEUE];
+        if (channel->tx_offset == sdu->length) {
+            const hal_radio_segment_t *segments = sdu->segments;
+            uint32_t length = sdu->length;
+
+            channel->queue_tail++;
+            channel->tx_offset = 0;
+            channel->tx_segment = 0;
+            channel->tx_segment_offset = 0;
+            channel->stats.sdus_sent++;
+            channel->stats.bytes_sent += length;
+            channel->config.callback(channel->handle, HAL_RADIO_L2CAP_SENT, segments, length,
+                                     channel->config.user_data);
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Copy the next bytes of the head SDU from its segments
+ */
+static void l2cap_gather(l2cap_channel_t *channel, uint8_t *destination, uint32_t length)
+{
+    const l2cap_sdu_t *sdu = &channel->queue[channel->queue_tail % HAL_RADIO_L2CAP_QUEUE];
+
+    channel->tx_offset += length;
+    while (length > 0) {
+        const hal_radio_segment_t *segment = &sdu->segments[channel->tx_segment];
+        uint32_t available = segment->length - channel->tx_segment_offset;
+        uint32_t copy = (length < available) ? length : available;
+
+        memcpy(destination, (const uint8_t *)segment->data + channel->tx_segment_offset, copy);
+        destination += copy;
+        length -= copy;
+        channel->tx_segment_offset += copy;
+        if (channel->tx_segment_offset == segment->length) {
+            channel->tx_segment++;
+            channel->tx_segment_offset = 0;
+        }
+    }
+}
+
+/**
+ * @brief Return to a gather position after a fragment could not be sent
+ */
+static void l2cap_rewind(l2cap_channel_t *channel, uint32_t offset, uint32_t segment, uint32_t segment_offset)
+{
+    channel->tx_offset = offset;
+    channel->tx_segment = segment;
+    channel->tx_segment_offset = segment_offset;
+}
+
+static uint16_t l2cap_get16(const uint8_t *data)
+{
+    return (uint16_t)(data[0] | (data[1] << 8));
+}
+
+static void l2cap_put16(uint8_t *data, uint16_t value)
+{
+    data[0] = (uint8_t)value;
+    data[1] = (uint8_t)(value >> 8);
+}
@@ -0,0 +1,203 @@
+/**
+ * @file hal_radio_sampler.c
+ * @brief DMA baseband sampler for the software demodulator
+ *
+ * TIM16 update events trigger DMA1 channel 2, which copies the GPIO port
+ * input register holding the radio's data output into a circular buffer.
+ * The half-transfer and transfer-complete interrupts mark each half
+ * ready; the consumer converts a ready half to Q15 levels in place and
+ * runs it through the demodulator (hal_radio_dsp.c) while the DMA fills
+ * the other half. No per-sample interrupt, so high sample rates cost only
+ * the demodulation itself.
+ */
+
+#include "hal_radio_internal.h"
+#include "hal_radio_dsp.h"
+#include "kernel/interrupt.h"
+#include <stddef.h>
+
+#if (HAL_RADIO_SAMPLE_BUFFER & 1) != 0
+#error "HAL_RADIO_SAMPLE_BUFFER must be even"
+#endif
+
+/* Sampling: TIM16 update -> DMAMUX1 channel 1 -> DMA1 channel 2 */
+#define SAMPLER_TIM_BASE            0x40014400UL    /* TIM16 */
+#define SAMPLER_DMA_BASE            0x40020000UL    /* DMA1 */
+#define SAMPLER_DMAMUX_BASE         0x40020800UL    /* DMAMUX1 */
+#define SAMPLER_RCC_BASE            0x58000000UL
+#define SAMPLER_GPIO_BASE           0x48000000UL    /* GPIOA, ports 0x400 apart */
+#define RCC_AHB1ENR_OFFSET          0x48
+#define RCC_AHB1ENR_DMA1EN          (1UL << 0)
+#define RCC_AHB1ENR_DMAMUX1EN       (1UL << 2)
+#define RCC_APB2ENR_OFFSET          0x60
+#define RCC_APB2ENR_TIM16EN         (1UL << 17)
+#define GPIO_PORT_STRIDE            0x400
+#define GPIO_IDR_OFFSET             0x10
+#define TIM_CR1_OFFSET              0x00
+#define TIM_DIER_OFFSET             0x0C
+#define TIM_EGR_OFFSET              0x14
+#define TIM_PSC_OFFSET              0x28
+#define TIM_ARR_OFFSET              0x2C
+#define TIM_CR1_CEN                 (1UL << 0)
+#define TIM_DIER_UDE                (1UL << 8)
+#define TIM_EGR_UG                  (1UL << 0)
+#define DMA_ISR_OFFSET              0x00
+#define DMA_IFCR_OFFSET             0x04
+#define DMA_CCR2_OFFSET             0x1C
+#define DMA_CNDTR2_OFFSET           0x20
+#define DMA_CPAR2_OFFSET            0x24
+#define DMA_CMAR2_OFFSET            0x28
+#define DMA_CCR_EN                  (1UL << 0)
+#define DMA_CCR_TCIE                (1UL << 1)
+#define DMA_CCR_HTIE                (1UL << 2)
+#define DMA_CCR_CIRC                (1UL << 5)
+#define DMA_CCR_MINC                (1UL << 7)
+#define DMA_CCR_PSIZE_16            (1UL << 8)
+#define DMA_CCR_MSIZE_16            (1UL << 10)
+#define DMA_ISR_TCIF2               (1UL << 5)
+#define DMA_ISR_HTIF2               (1UL << 6)
+#define DMA_IFCR_CGIF2              (1UL << 4)
+#define DMAMUX_C1CR_OFFSET          0x04
+#define DMAMUX_REQ_TIM16_UP         34
+
+#define SAMPLER_REG(base, offset)   (*(volatile uint32_t *)((base) + (offset)))
+
+/* Slowest rate the 16-bit timer reaches without a prescaler */
+#define SAMPLER_MIN_RATE_HZ         (CPU_FREQUENCY_HZ / 65536UL + 1UL)
+
+/* Sampler state */
+static uint16_t sampler_buffer[HAL_RADIO_SAMPLE_BUFFER];
+static hal_radio_instance_t *sampler_owner;
+static uint16_t sampler_mask;                   /* Data bit in the port input register */
+static volatile uint32_t sampler_sequence;      /* Halves completed */
+static volatile uint8_t sampler_half;           /* Half completed last */
+static uint32_t sampler_taken;                  /* Sequence of the last half taken */
+
+/* Static function prototypes */
+static void sampler_irq_handler(void);
+
+/**
+ * @brief Start sampling a GPIO into the ring at a fixed rate
+ */
+hal_result_t hal_radio_sampler_begin(hal_radio_instance_t *instance, uint32_t pin, uint32_t sample_rate_hz)
+{
+    if (sampler_owner != NULL) {
+        return HAL_ERROR_RESOURCE_BUSY;
+    }
+
+    if (sample_rate_hz < SAMPLER_MIN_RATE_HZ || sample_rate_hz > CPU_FREQUENCY_HZ / 64U) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    if (interrupt_register(IRQ_DMA1_CH2, sampler_irq_handler, IRQ_PRIORITY_NORMAL, "DMA1_CH2") != KERNEL_OK) {
+        return HAL_ERROR;
+    }
+
+    sampler_owner = instance;
+    sampler_mask = (uint16_t)(1U << (pin % 16U));
+    sampler_sequence = 0;
+    sampler_taken = 0;
+
+    SAMPLER_REG(SAMPLER_RCC_BASE, RCC_AHB1ENR_OFFSET) |= RCC_AHB1ENR_DMA1EN | RCC_AHB1ENR_DMAMUX1EN;
+    SAMPLER_REG(SAMPLER_RCC_BASE, RCC_APB2ENR_OFFSET) |= RCC_APB2ENR_TIM16EN;
+
+    SAMPLER_REG(SAMPLER_DMA_BASE, DMA_CCR2_OFFSET) &= ~DMA_CCR_EN;
+    SAMPLER_REG(SAMPLER_DMA_BASE, DMA_IFCR_OFFSET) = DMA_IFCR_CGIF2;
+    SAMPLER_REG(SAMPLER_DMAMUX_BASE, DMAMUX_C1CR_OFFSET) = DMAMUX_REQ_TIM16_UP;
+    SAMPLER_REG(SAMPLER_DMA_BASE, DMA_CPAR2_OFFSET) =
+        (uint32_t)(SAMPLER_GPIO_BASE + (pin / 16U) * GPIO_PORT_STRIDE + GPIO_IDR_OFFSET);
+    SAMPLER_REG(SAMPLER_DMA_BASE, DMA_CMAR2_OFFSET) = (uint32_t)(uintptr_t)sampler_buffer;
+    SAMPLER_REG(SAMPLER_DMA_BASE, DMA_CNDTR2_OFFSET) = HAL_RADIO_SAMPLE_BUFFER;
+    SAMPLER_REG(SAMPLER_DMA_BASE, DMA_CCR2_OFFSET) = DMA_CCR_MSIZE_16 | DMA_CCR_PSIZE_16 | DMA_CCR_MINC |
+                                                     DMA_CCR_CIRC | DMA_CCR_HTIE | DMA_CCR_TCIE | DMA_CCR_EN;
+
+    if (interrupt_enable(IRQ_DMA1_CH2) != KERNEL_OK) {
+        SAMPLER_REG(SAMPLER_DMA_BASE, DMA_CCR2_OFFSET) = 0;
+        interrupt_unregister(IRQ_DMA1_CH2);
+        sampler_owner = NULL;
+        return HAL_ERROR;
+    }
+
+    SAMPLER_REG(SAMPLER_TIM_BASE, TIM_CR1_OFFSET) = 0;
+    SAMPLER_REG(SAMPLER_TIM_BASE, TIM_PSC_OFFSET) = 0;
+    SAMPLER_REG(SAMPLER_TIM_BASE, TIM_ARR_OFFSET) = CPU_FREQUENCY_HZ / sample_rate_hz - 1U;
+    SAMPLER_REG(SAMPLER_TIM_BASE, TIM_EGR_OFFSET) = TIM_EGR_UG;
+    SAMPLER_REG(SAMPLER_TIM_BASE, TIM_DIER_OFFSET) = TIM_DIER_UDE;
+    SAMPLER_REG(SAMPLER_TIM_BASE, TIM_CR1_OFFSET) = TIM_CR1_CEN;
+    return HAL_OK;
+}
+
+/**
+ * @brief Stop sampling
+ */
+void hal_radio_sampler_end(hal_radio_instance_t *instance)
+{
+    if (instance != sampler_owner) {
+        return;
+    }
+
+    SAMPLER_REG(SAMPLER_TIM_BASE, TIM_CR1_OFFSET) = 0;
+    SAMPLER_REG(SAMPLER_TIM_BASE, TIM_DIER_OFFSET) = 0;
+    SAMPLER_REG(SAMPLER_DMA_BASE, DMA_CCR2_OFFSET) &= ~DMA_CCR_EN;
+    SAMPLER_REG(SAMPLER_DMA_BASE, DMA_IFCR_OFFSET) = DMA_IFCR_CGIF2;
+    interrupt_disable(IRQ_DMA1_CH2);
+    interrupt_unregister(IRQ_DMA1_CH2);
+    sampler_owner = NULL;
+}
+
+/**
+ * @brief Take the half of the ring completed last, converted to levels
+ *
+ * Halves completed in between are skipped and counted as missed.
+ */
+hal_result_t hal_radio_sampler_take(hal_radio_instance_t *instance, const int16_t **samples, uint32_t *count,
+                                    uint32_t *missed)
+{
+    if (instance != sampler_owner) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    uint32_t primask = hal_radio_lock();
+    uint32_t sequence = sampler_sequence;
+    uint32_t half = sampler_half;
+    hal_radio_unlock(primask);
+
+    *samples = NULL;
+    *count = 0;
+    if (missed != NULL) {
+        *missed = (sequence != sampler_taken) ? sequence - sampler_taken - 1U : 0;
+    }
+    if (sequence == sampler_taken) {
+        return HAL_OK;
+    }
+    sampler_taken = sequence;
+
+    /* Same size, converted in place: port bits become 0 / HAL_RADIO_DSP_LEVEL_HIGH */
+    uint16_t *raw = &sampler_buffer[half * (HAL_RADIO_SAMPLE_BUFFER / 2U)];
+    int16_t *levels = (int16_t *)raw;
+    for (uint32_t i = 0; i < HAL_RADIO_SAMPLE_BUFFER / 2U; i++) {
+        levels[i] = (raw[i] & sampler_mask) ? HAL_RADIO_DSP_LEVEL_HIGH : 0;
+    }
+
+    *samples = levels;
+    *count = HAL_RADIO_SAMPLE_BUFFER / 2U;
+    return HAL_OK;
+}
+
+/* Static helper functions */
+
+/**
+ * @brief DMA1 channel 2 interrupt: a half of the ring is ready
+ */
+static void sampler_irq_handler(void)
+{
+    uint32_t status = SAMPLER_REG(SAMPLER_DMA_BASE, DMA_ISR_OFFSET);
+
+    if (!(status & (DMA_ISR_HTIF2 | DMA_ISR_TCIF2))) {
+        return;
+    }
+
+    SAMPLER_REG(SAMPLER_DMA_BASE, DMA_IFCR_OFFSET) = DMA_IFCR_CGIF2;
+    sampler_half = (status & DMA_ISR_TCIF2) ? 1 : 0;
+    sampler_sequence++;
+}
@@ -0,0 +1,178 @@
+/**
+ * @file hal_radio_timer.c
+ * @brief Microsecond deadline timer for the radio drivers
+ *
+ * TIM2 runs free at 1 MHz over its full 32-bit range; each capture/compare
+ * channel is a one-shot deadline with its own callback, run from the TIM2
+ * interrupt. Times wrap every ~71 minutes and are compared wrap-safe, so
+ * deadlines must be less than half that away.
+ *
+ * The interrupt runs at the same priority as the GPIO (GDO) interrupts,
+ * so deadline callbacks and GDO handlers never preempt each other halfway
+ * through an SPI transaction.
+ */
+
+#include "hal_radio_internal.h"
+#include "kernel/interrupt.h"
+#include <stddef.h>
+
+/* TIM2 register definitions (STM32WB55 specific) */
+#define RADIO_TIM_BASE              0x40000000UL
+#define RADIO_RCC_BASE              0x58000000UL
+#define RCC_APB1ENR1_OFFSET         0x58
+#define RCC_APB1ENR1_TIM2EN         (1UL << 0)
+#define TIM_CR1_OFFSET              0x00
+#define TIM_DIER_OFFSET             0x0C
+#define TIM_SR_OFFSET               0x10
+#define TIM_EGR_OFFSET              0x14
+#define TIM_CNT_OFFSET              0x24
+#define TIM_PSC_OFFSET              0x28
+#define TIM_ARR_OFFSET              0x2C
+#define TIM_CCR_OFFSET(channel)     (0x34 + 4 * (channel))
+#define TIM_CR1_CEN                 (1UL << 0)
+#define TIM_EGR_UG                  (1UL << 0)
+#define TIM_CC_BIT(channel)         (1UL << (1 + (channel)))   /* CCxIE, CCxIF and CCxG */
+#define TIM_CC_MASK                 0x1EUL
+
+#define RADIO_TIM_REG(offset)       (*(volatile uint32_t *)(RADIO_TIM_BASE + (offset)))
+#define RADIO_RCC_REG(offset)       (*(volatile uint32_t *)(RADIO_RCC_BASE + (offset)))
+
+/* Deadline state */
+static bool timer_running = false;
+static hal_radio_timer_callback_t timer_callbacks[HAL_RADIO_TIMER_CHANNELS];
+static void *timer_user_data[HAL_RADIO_TIMER_CHANNELS];
+
+/* Static function prototypes */
+static void timer_irq_handler(void);
+
+/**
+ * @brief Start the free-running counter and install the TIM2 interrupt
+ */
+hal_result_t hal_radio_timer_init(void)
+{
+    if (timer_running) {
+        return HAL_OK;
+    }
+
+    if (interrupt_register(IRQ_TIM2, timer_irq_handler, IRQ_PRIORITY_HIGH, "TIM2") != KERNEL_OK) {
+        return HAL_ERROR;
+    }
+
+    RADIO_RCC_REG(RCC_APB1ENR1_OFFSET) |= RCC_APB1ENR1_TIM2EN;
+
+    RADIO_TIM_REG(TIM_CR1_OFFSET) = 0;
+    RADIO_TIM_REG(TIM_DIER_OFFSET) = 0;
+    RADIO_TIM_REG(TIM_PSC_OFFSET) = (CPU_FREQUENCY_HZ / 1000000UL) - 1U;
+    RADIO_TIM_REG(TIM_ARR_OFFSET) = 0xFFFFFFFFUL;
+
+    /* Load the prescaler now rather than at the first overflow */
+    RADIO_TIM_REG(TIM_EGR_OFFSET) = TIM_EGR_UG;
+    RADIO_TIM_REG(TIM_SR_OFFSET) = 0;
+    RADIO_TIM_REG(TIM_CR1_OFFSET) = TIM_CR1_CEN;
+
+    if (interrupt_enable(IRQ_TIM2) != KERNEL_OK) {
+        RADIO_TIM_REG(TIM_CR1_OFFSET) = 0;
+        interrupt_unregister(IRQ_TIM2);
+        return HAL_ERROR;
+    }
+
+    timer_running = true;
+    return HAL_OK;
+}
+
+/**
+ * @brief Stop the counter and drop every pending deadline
+ */
+void hal_radio_timer_deinit(void)
+{
+    if (!timer_running) {
+        return;
+    }
+
+    interrupt_unregister(IRQ_TIM2);
+    RADIO_TIM_REG(TIM_DIER_OFFSET) = 0;
+    RADIO_TIM_REG(TIM_CR1_OFFSET) = 0;
+    RADIO_TIM_REG(TIM_SR_OFFSET) = 0;
+
+    for (uint32_t channel = 0; channel < HAL_RADIO_TIMER_CHANNELS; channel++) {
+        timer_callbacks[channel] = NULL;
+    }
+
+    timer_running = false;
+}
+
+/**
+ * @brief Current time in microseconds
+ */
+uint32_t hal_radio_timer_now(void)
+{
+    return RADIO_TIM_REG(TIM_CNT_OFFSET);
+}
+
+/**
+ * @brief Run a callback from the timer interrupt at an absolute time
+ *
+ * Replaces any deadline pending on the channel. A deadline that has
+ * already passed fires straight away.
+ */
+void hal_radio_timer_arm(uint32_t channel, uint32_t at_us, hal_radio_timer_callback_t callback, void *user_data)
+{
+    if (channel >= HAL_RADIO_TIMER_CHANNELS || callback == NULL) {
+        return;
+    }
+
+    uint32_t primask = hal_radio_lock();
+
+    timer_callbacks[channel] = callback;
+    timer_user_data[channel] = user_data;
+    RADIO_TIM_REG(TIM_CCR_OFFSET(channel)) = at_us;
+    RADIO_TIM_REG(TIM_SR_OFFSET) = ~TIM_CC_BIT(channel);
+    RADIO_TIM_REG(TIM_DIER_OFFSET) |= TIM_CC_BIT(channel);
+
+    /* The compare only matches on equality; catch deadlines already behind the counter */
+    if ((int32_t)(at_us - RADIO_TIM_REG(TIM_CNT_OFFSET)) <= 0) {
+        RADIO_TIM_REG(TIM_EGR_OFFSET) = TIM_CC_BIT(channel);
+    }
+
+    hal_radio_unlock(primask);
+}
+
+/**
+ * @brief Drop the deadline pending on a channel, if any
+ */
+void hal_radio_timer_cancel(uint32_t channel)
+{
+    if (channel >= HAL_RADIO_TIMER_CHANNELS) {
+        return;
+    }
+
+    uint32_t primask = hal_radio_lock();
+    RADIO_TIM_REG(TIM_DIER_OFFSET) &= ~TIM_CC_BIT(channel);
+    RADIO_TIM_REG(TIM_SR_OFFSET) = ~TIM_CC_BIT(channel);
+    timer_callbacks[channel] = NULL;
+    hal_radio_unlock(primask);
+}
+
+/* Static helper functions */
+
+/**
+ * @brief TIM2 interrupt: run the callbacks of the deadlines that matched
+ */
+static void timer_irq_handler(void)
+{
+    uint32_t pending = RADIO_TIM_REG(TIM_SR_OFFSET) & RADIO_TIM_REG(TIM_DIER_OFFSET) & TIM_CC_MASK;
+
+    /* Deadlines are one-shot: disarm before running, so callbacks can re-arm */
+    RADIO_TIM_REG(TIM_SR_OFFSET) = ~pending;
+    RADIO_TIM_REG(TIM_DIER_OFFSET) &= ~pending;
+
+    for (uint32_t channel = 0; channel < HAL_RADIO_TIMER_CHANNELS; channel++) {
+        if (pending & TIM_CC_BIT(channel)) {
+            hal_radio_timer_callback_t callback = timer_callbacks[channel];
+            timer_callbacks[channel] = NULL;
+            if (callback != NULL) {
+                callback(timer_user_data[channel]);
+            }
+        }
+    }
+}
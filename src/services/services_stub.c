@@ -7,6 +7,7 @@
  */
 
 #include <stdint.h>
+#include "subghz_decoder.h"
 
 /**
  * @brief Initialize system services
@@ -20,6 +21,8 @@
  */
 void services_init(void)
 {
+    subghz_protocols_register_builtin();
+
     // Placeholder - actual implementation in task 7
     // TODO: Implement services initialization
 }
\ No newline at end of file
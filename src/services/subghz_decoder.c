@@ -0,0 +1,159 @@
+/**
+ * @file subghz_decoder.c
+ * @brief Incremental Sub-GHz protocol decoders over the raw pulse stream
+ *
+ * Per pulse the cost is one feed call per protocol still following the
+ * stream. Noise makes almost every protocol reject within a pulse or two,
+ * so between frames the active set is usually empty and a pulse costs a
+ * couple of compares.
+ */
+
+#include "subghz_decoder.h"
+#include <string.h>
+
+#if SUBGHZ_DECODER_MAX_PROTOCOLS > 32
+#error "SUBGHZ_DECODER_MAX_PROTOCOLS must fit the 32-bit active mask"
+#endif
+
+/* Protocol registry, shared by all decoder instances */
+static const subghz_protocol_t *subghz_registry[SUBGHZ_DECODER_MAX_PROTOCOLS];
+static uint32_t subghz_registry_count;
+
+/* Static function prototypes */
+static uint32_t subghz_registry_mask(void);
+static void subghz_emit(subghz_decoder_t *decoder, subghz_frame_t *frame);
+
+hal_result_t subghz_decoder_register(const subghz_protocol_t *protocol)
+{
+    if (!protocol || !protocol->name || !protocol->feed || protocol->state_size > SUBGHZ_DECODER_STATE_SIZE) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    for (uint32_t i = 0; i < subghz_registry_count; i++) {
+        if (subghz_registry[i] == protocol) {
+            return HAL_OK;
+        }
+    }
+
+    if (subghz_registry_count >= SUBGHZ_DECODER_MAX_PROTOCOLS) {
+        return HAL_ERROR_NO_MEMORY;
+    }
+
+    /* Running decoders pick the new protocol up at the next gap */
+    subghz_registry[subghz_registry_count++] = protocol;
+    return HAL_OK;
+}
+
+hal_result_t subghz_decoder_init(subghz_decoder_t *decoder, subghz_frame_callback_t callback, void *user_data)
+{
+    if (!decoder) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+
+    memset(decoder, 0, sizeof(*decoder));
+    decoder->callback = callback;
+    decoder->user_data = user_data;
+    return HAL_OK;
+}
+
+void subghz_decoder_reset(subghz_decoder_t *decoder)
+{
+    if (decoder) {
+        decoder->active = 0;
+    }
+}
+
+void subghz_decoder_feed(subghz_decoder_t *decoder, bool level, uint32_t duration_us)
+{
+    decoder->now_us += duration_us;
+    decoder->stats.pulses++;
+
+    /* Every frame sync starts after a gap: give parked protocols a fresh start */
+    if (!level && duration_us >= SUBGHZ_DECODER_GAP_US) {
+        uint32_t parked = subghz_registry_mask() & ~decoder->active;
+        for (uint32_t i = 0; parked != 0; i++, parked >>= 1) {
+            if (parked & 1U) {
+                memset(&decoder->state[i], 0, sizeof(decoder->state[i]));
+            }
+        }
+        decoder->active = subghz_registry_mask();
+    }
+
+    uint32_t pending = decoder->active;
+    for (uint32_t i = 0; pending != 0; i++, pending >>= 1) {
+        if (!(pending & 1U)) {
+            continue;
+        }
+
+        const subghz_protocol_t *protocol = subghz_registry[i];
+        subghz_frame_t frame;
+        subghz_decode_status_t status = protocol->feed(protocol, decoder->state[i].bytes, level,
+                                                       duration_us, &frame);
+        decoder->stats.protocol_steps++;
+
+        if (status == SUBGHZ_DECODE_REJECT) {
+            decoder->active &= ~(1UL << i);
+            decoder->stats.rejections++;
+        } else if (status == SUBGHZ_DECODE_FRAME) {
+            frame.protocol = protocol->name;
+            subghz_emit(decoder, &frame);
+        }
+    }
+}
+
+void subghz_decoder_feed_capture(subghz_decoder_t *decoder, const hal_radio_capture_buffer_t *buffer)
+{
+    if (!decoder || !buffer) {
+        return;
+    }
+
+    for (uint32_t i = 0; i < buffer->count; i++) {
+        int32_t edge = buffer->edges[i];
+        if (edge >= 0) {
+            subghz_decoder_feed(decoder, true, (uint32_t)edge);
+        } else {
+            subghz_decoder_feed(decoder, false, (uint32_t)-edge);
+        }
+    }
+}
+
+void subghz_decoder_get_stats(const subghz_decoder_t *decoder, subghz_decoder_stats_t *stats)
+{
+    if (decoder && stats) {
+        *stats = decoder->stats;
+    }
+}
+
+/* Static helper functions */
+
+static uint32_t subghz_registry_mask(void)
+{
+    if (subghz_registry_count >= 32) {
+        return 0xFFFFFFFFUL;
+    }
+    return (1UL << subghz_registry_count) - 1U;
+}
+
+/**
+ * @brief Count repeats of the previous frame and hand the frame to the callback
+ */
+static void subghz_emit(subghz_decoder_t *decoder, subghz_frame_t *frame)
+{
+    const subghz_frame_t *last = &decoder->last_frame;
+
+    /* Remotes send each frame several times in a burst */
+    frame->repeat = 0;
+    if (decoder->stats.frames > 0 && last->protocol == frame->protocol && last->data == frame->data &&
+        last->bits == frame->bits && decoder->now_us - decoder->last_frame_us <= SUBGHZ_DECODER_REPEAT_US &&
+        last->repeat < UINT8_MAX) {
+        frame->repeat = (uint8_t)(last->repeat + 1U);
+    }
+
+    decoder->last_frame = *frame;
+    decoder->last_frame_us = decoder->now_us;
+    decoder->stats.frames++;
+
+    if (decoder->callback) {
+        decoder->callback(frame, decoder->user_data);
+    }
+}
@@ -0,0 +1,169 @@
+/**
+ * @file subghz_decoder.h
+ * @brief Incremental Sub-GHz protocol decoders over the raw pulse stream
+ *
+ * Protocols register a small state machine that is fed one pulse at a
+ * time. A decoder instance runs every registered protocol in parallel on
+ * the same stream, so a capture is decoded while it arrives instead of
+ * after it has been buffered. A protocol that sees a pulse it cannot
+ * accept rejects it and is parked; parked protocols cost nothing per pulse
+ * and are re-armed at the next inter-frame gap, which is where every
+ * protocol's frame sync begins. Decoded frames are delivered to the
+ * instance's callback.
+ *
+ * Pulses come straight from hal_radio_capture_acquire() buffers, see
+ * subghz_decoder_feed_capture().
+ */
+
+#ifndef SUBGHZ_DECODER_H
+#define SUBGHZ_DECODER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "hal_radio.h"
+
+/* Decoder limits */
+#define SUBGHZ_DECODER_MAX_PROTOCOLS    16
+#define SUBGHZ_DECODER_STATE_SIZE       24      /**< Per-protocol state bytes */
+#define SUBGHZ_DECODER_GAP_US           2500    /**< Shortest low pulse that re-arms parked protocols */
+#define SUBGHZ_DECODER_REPEAT_US        250000  /**< Identical frames closer than this count as repeats */
+
+/**
+ * @brief Protocol feed result
+ */
+typedef enum {
+    SUBGHZ_DECODE_CONTINUE = 0,     /**< Pulse accepted, keep feeding */
+    SUBGHZ_DECODE_REJECT,           /**< Pulse cannot be part of a frame; park until the next gap */
+    SUBGHZ_DECODE_FRAME             /**< A frame was completed and written out */
+} subghz_decode_status_t;
+
+/**
+ * @brief Decoded frame
+ */
+typedef struct {
+    const char *protocol;           /**< Protocol name */
+    uint64_t data;                  /**< Frame bits, first received bit most significant */
+    uint8_t bits;                   /**< Number of valid bits in data */
+    uint8_t repeat;                 /**< Back-to-back repeats of the same frame before this one */
+    uint16_t te_us;                 /**< Measured base pulse length */
+} subghz_frame_t;
+
+struct subghz_protocol;
+
+/**
+ * @brief Feed one pulse to a protocol state machine
+ *
+ * The state starts zeroed and is zeroed again whenever the protocol is
+ * re-armed after a rejection. After returning SUBGHZ_DECODE_FRAME the
+ * protocol keeps its state, so a gap that ends one frame can start the
+ * next.
+ *
+ * @param protocol Protocol descriptor (for its parameters)
+ * @param state Protocol state, SUBGHZ_DECODER_STATE_SIZE bytes
+ * @param level true for a high pulse, false for a low one
+ * @param duration_us Pulse length in microseconds
+ * @param frame Filled in when SUBGHZ_DECODE_FRAME is returned
+ */
+typedef subghz_decode_status_t (*subghz_protocol_feed_t)(const struct subghz_protocol *protocol, void *state,
+                                                         bool level, uint32_t duration_us, subghz_frame_t *frame);
+
+/**
+ * @brief Protocol descriptor; must stay valid once registered
+ */
+typedef struct subghz_protocol {
+    const char *name;               /**< Protocol name, reported in frames */
+    subghz_protocol_feed_t feed;    /**< Pulse handler */
+    uint16_t state_size;            /**< State bytes used, at most SUBGHZ_DECODER_STATE_SIZE */
+    const void *params;             /**< Protocol timing, for decoders shared by several protocols */
+} subghz_protocol_t;
+
+/**
+ * @brief Frame callback
+ * @param frame Decoded frame, valid for the duration of the call
+ * @param user_data User data given to subghz_decoder_init()
+ */
+typedef void (*subghz_frame_callback_t)(const subghz_frame_t *frame, void *user_data);
+
+/**
+ * @brief Decoder counters
+ */
+typedef struct {
+    uint32_t pulses;                /**< Pulses fed */
+    uint32_t protocol_steps;        /**< Protocol feed calls made */
+    uint32_t rejections;            /**< Protocols parked */
+    uint32_t frames;                /**< Frames delivered */
+} subghz_decoder_stats_t;
+
+/**
+ * @brief Protocol state slot
+ */
+typedef union {
+    uint64_t align;
+    uint8_t bytes[SUBGHZ_DECODER_STATE_SIZE];
+} subghz_protocol_state_t;
+
+/**
+ * @brief Decoder instance
+ */
+typedef struct {
+    uint32_t active;                /**< Bit per registry slot still following the stream */
+    uint64_t now_us;                /**< Signal time fed so far */
+    uint64_t last_frame_us;         /**< Signal time of the last delivered frame */
+    subghz_frame_t last_frame;
+    subghz_frame_callback_t callback;
+    void *user_data;
+    subghz_decoder_stats_t stats;
+    subghz_protocol_state_t state[SUBGHZ_DECODER_MAX_PROTOCOLS];
+} subghz_decoder_t;
+
+/**
+ * @brief Add a protocol to the registry
+ * @param protocol Protocol descriptor
+ * @return HAL_OK on success, HAL_ERROR_NO_MEMORY if the registry is full
+ */
+hal_result_t subghz_decoder_register(const subghz_protocol_t *protocol);
+
+/**
+ * @brief Register the built-in protocols (Princeton, CAME, Nice FLO)
+ * @return HAL_OK on success, error code otherwise
+ */
+hal_result_t subghz_protocols_register_builtin(void);
+
+/**
+ * @brief Prepare a decoder instance
+ * @param decoder Decoder instance
+ * @param callback Frame callback (may be NULL)
+ * @param user_data User data for the callback
+ * @return HAL_OK on success, error code otherwise
+ */
+hal_result_t subghz_decoder_init(subghz_decoder_t *decoder, subghz_frame_callback_t callback, void *user_data);
+
+/**
+ * @brief Park every protocol until the next gap, e.g. after a retune
+ * @param decoder Decoder instance
+ */
+void subghz_decoder_reset(subghz_decoder_t *decoder);
+
+/**
+ * @brief Feed one pulse to every protocol still following the stream
+ * @param decoder Decoder instance
+ * @param level true for a high pulse, false for a low one
+ * @param duration_us Pulse length in microseconds
+ */
+void subghz_decoder_feed(subghz_decoder_t *decoder, bool level, uint32_t duration_us);
+
+/**
+ * @brief Feed every pulse of a capture buffer
+ * @param decoder Decoder instance
+ * @param buffer Buffer from hal_radio_capture_acquire()
+ */
+void subghz_decoder_feed_capture(subghz_decoder_t *decoder, const hal_radio_capture_buffer_t *buffer);
+
+/**
+ * @brief Copy the decoder counters
+ * @param decoder Decoder instance
+ * @param stats Receives the counters
+ */
+void subghz_decoder_get_stats(const subghz_decoder_t *decoder, subghz_decoder_stats_t *stats);
+
+#endif /* SUBGHZ_DECODER_H */
@@ -0,0 +1,284 @@
+/**
+ * @file subghz_protocols.c
+ * @brief Built-in Sub-GHz protocol decoders
+ *
+ * Fixed-code OOK remotes encode each bit as a short and a long pulse
+ * (one and three, or one and two, base periods). Two decoders cover the
+ * common layouts, with per-protocol timing in the descriptor:
+ * - High first, sync after the frame (Princeton PT2262, EV1527). The base
+ *   period varies a lot between encoder chips, so it is measured from the
+ *   first bit and later bits only have to stay consistent with it.
+ * - Low first, start bit after the gap (CAME, Nice FLO), with fixed
+ *   nominal timing.
+ */
+
+#include "subghz_decoder.h"
+
+/* Decoder steps */
+#define PWM_STEP_GAP                0   /* Waiting for the gap that re-armed us */
+#define PWM_STEP_START              1   /* Start bit */
+#define PWM_STEP_FIRST              2   /* First pulse of a bit */
+#define PWM_STEP_SECOND             3   /* Second pulse of a bit */
+
+/**
+ * @brief Timing of a high-first protocol with a trailing sync
+ */
+typedef struct {
+    uint16_t te_min_us;             /**< Shortest accepted base period */
+    uint16_t te_max_us;             /**< Longest accepted base period */
+    uint8_t bits;                   /**< Frame length */
+} pwm_sync_after_params_t;
+
+/**
+ * @brief Timing of a low-first protocol with a leading start bit
+ */
+typedef struct {
+    uint16_t te_short_us;           /**< Short pulse */
+    uint16_t te_long_us;            /**< Long pulse */
+    uint16_t te_delta_us;           /**< Accepted deviation */
+    uint8_t bits;                   /**< Frame length */
+} pwm_start_bit_params_t;
+
+/**
+ * @brief State shared by both decoders
+ */
+typedef struct {
+    uint32_t data;
+    uint32_t first_us;              /**< First pulse of the bit in progress */
+    uint32_t te_sum_us;             /**< Sum of measured base periods */
+    uint8_t bits;
+    uint8_t step;
+} pwm_state_t;
+
+/* Static function prototypes */
+static subghz_decode_status_t pwm_sync_after_feed(const subghz_protocol_t *protocol, void *state, bool level,
+                                                  uint32_t duration_us, subghz_frame_t *frame);
+static subghz_decode_status_t pwm_start_bit_feed(const subghz_protocol_t *protocol, void *state, bool level,
+                                                 uint32_t duration_us, subghz_frame_t *frame);
+static bool pwm_near(uint32_t duration_us, uint32_t nominal_us, uint32_t delta_us);
+static void pwm_restart(pwm_state_t *pwm, uint8_t step);
+static void pwm_frame(const subghz_protocol_t *protocol, const pwm_state_t *pwm, subghz_frame_t *frame);
+
+/* Protocol timing */
+static const pwm_sync_after_params_t princeton_params = { 150, 700, 24 };
+static const pwm_start_bit_params_t came_params = { 320, 640, 150, 12 };
+static const pwm_start_bit_params_t nice_flo_params = { 700, 1400, 200, 12 };
+
+/* Protocol descriptors */
+static const subghz_protocol_t princeton_protocol = {
+    "Princeton", pwm_sync_after_feed, sizeof(pwm_state_t), &princeton_params
+};
+static const subghz_protocol_t came_protocol = {
+    "CAME", pwm_start_bit_feed, sizeof(pwm_state_t), &came_params
+};
+static const subghz_protocol_t nice_flo_protocol = {
+    "Nice FLO", pwm_start_bit_feed, sizeof(pwm_state_t), &nice_flo_params
+};
+
+hal_result_t subghz_protocols_register_builtin(void)
+{
+    static const subghz_protocol_t *const builtin[] = {
+        &princeton_protocol,
+        &came_protocol,
+        &nice_flo_protocol
+    };
+
+    for (uint32_t i = 0; i < sizeof(builtin) / sizeof(builtin[0]); i++) {
+        hal_result_t result = subghz_decoder_register(builtin[i]);
+        if (result != HAL_OK) {
+            return result;
+        }
+    }
+
+    return HAL_OK;
+}
+
+/* Static helper functions */
+
+/**
+ * @brief High-first PWM: bit 0 = 1T high + 3T low, bit 1 = 3T high + 1T low
+ *
+ * A frame is complete when a short high and a gap follow the last bit; the
+ * same gap is the sync of the next repeat.
+ */
+static subghz_decode_status_t pwm_sync_after_feed(const subghz_protocol_t *protocol, void *state, bool level,
+                                                  uint32_t duration_us, subghz_frame_t *frame)
+{
+    const pwm_sync_after_params_t *params = protocol->params;
+    pwm_state_t *pwm = state;
+
+    switch (pwm->step) {
+        case PWM_STEP_GAP:
+            if (level || duration_us < SUBGHZ_DECODER_GAP_US) {
+                return SUBGHZ_DECODE_REJECT;
+            }
+            pwm_restart(pwm, PWM_STEP_FIRST);
+            return SUBGHZ_DECODE_CONTINUE;
+
+        case PWM_STEP_FIRST:
+            if (!level) {
+                /* Back-to-back gaps: the later one is the sync */
+                return (duration_us >= SUBGHZ_DECODER_GAP_US) ? SUBGHZ_DECODE_CONTINUE : SUBGHZ_DECODE_REJECT;
+            }
+            pwm->first_us = duration_us;
+            pwm->step = PWM_STEP_SECOND;
+            return SUBGHZ_DECODE_CONTINUE;
+
+        case PWM_STEP_SECOND:
+        default:
+            break;
+    }
+
+    uint32_t high_us = pwm->first_us;
+    uint32_t low_us = duration_us;
+
+    if (level) {
+        return SUBGHZ_DECODE_REJECT;
+    }
+
+    if (low_us >= SUBGHZ_DECODER_GAP_US) {
+        bool complete = (pwm->bits == params->bits && high_us * pwm->bits <= 2U * pwm->te_sum_us);
+        if (complete) {
+            pwm_frame(protocol, pwm, frame);
+        }
+        pwm_restart(pwm, PWM_STEP_FIRST);
+        return complete ? SUBGHZ_DECODE_FRAME : SUBGHZ_DECODE_CONTINUE;
+    }
+
+    if (pwm->bits >= params->bits) {
+        return SUBGHZ_DECODE_REJECT;
+    }
+
+    uint32_t te_us = (high_us + low_us) / 4U;
+    if (te_us < params->te_min_us || te_us > params->te_max_us) {
+        return SUBGHZ_DECODE_REJECT;
+    }
+
+    /* Later bits must agree with the period measured so far */
+    if (pwm->bits > 0) {
+        uint32_t average_us = pwm->te_sum_us / pwm->bits;
+        uint32_t deviation_us = (te_us > average_us) ? te_us - average_us : average_us - te_us;
+        if (deviation_us * 4U > average_us) {
+            return SUBGHZ_DECODE_REJECT;
+        }
+    }
+
+    uint32_t bit;
+    if (low_us >= 2U * high_us && low_us <= 5U * high_us) {
+        bit = 0;
+    } else if (high_us >= 2U * low_us && high_us <= 5U * low_us) {
+        bit = 1;
+    } else {
+        return SUBGHZ_DECODE_REJECT;
+    }
+
+    pwm->data = (pwm->data << 1) | bit;
+    pwm->te_sum_us += te_us;
+    pwm->bits++;
+    pwm->step = PWM_STEP_FIRST;
+    return SUBGHZ_DECODE_CONTINUE;
+}
+
+/**
+ * @brief Low-first PWM: start bit 1T high, bit 0 = 1T low + 2T high, bit 1 = 2T low + 1T high
+ *
+ * A frame is complete when the gap after the last bit arrives; the same
+ * gap precedes the start bit of the next repeat.
+ */
+static subghz_decode_status_t pwm_start_bit_feed(const subghz_protocol_t *protocol, void *state, bool level,
+                                                 uint32_t duration_us, subghz_frame_t *frame)
+{
+    const pwm_start_bit_params_t *params = protocol->params;
+    pwm_state_t *pwm = state;
+
+    switch (pwm->step) {
+        case PWM_STEP_GAP:
+            if (level || duration_us < SUBGHZ_DECODER_GAP_US) {
+                return SUBGHZ_DECODE_REJECT;
+            }
+            pwm_restart(pwm, PWM_STEP_START);
+            return SUBGHZ_DECODE_CONTINUE;
+
+        case PWM_STEP_START:
+            if (!level) {
+                /* Back-to-back gaps: the later one precedes the start bit */
+                return (duration_us >= SUBGHZ_DECODER_GAP_US) ? SUBGHZ_DECODE_CONTINUE : SUBGHZ_DECODE_REJECT;
+            }
+            if (!pwm_near(duration_us, params->te_short_us, params->te_delta_us)) {
+                return SUBGHZ_DECODE_REJECT;
+            }
+            pwm->te_sum_us = duration_us;
+            pwm->step = PWM_STEP_FIRST;
+            return SUBGHZ_DECODE_CONTINUE;
+
+        case PWM_STEP_FIRST:
+            if (level) {
+                return SUBGHZ_DECODE_REJECT;
+            }
+            if (duration_us >= SUBGHZ_DECODER_GAP_US) {
+                bool complete = (pwm->bits == params->bits);
+                if (complete) {
+                    pwm_frame(protocol, pwm, frame);
+                }
+                pwm_restart(pwm, PWM_STEP_START);
+                return complete ? SUBGHZ_DECODE_FRAME : SUBGHZ_DECODE_CONTINUE;
+            }
+            if (pwm->bits >= params->bits) {
+                return SUBGHZ_DECODE_REJECT;
+            }
+            pwm->first_us = duration_us;
+            pwm->step = PWM_STEP_SECOND;
+            return SUBGHZ_DECODE_CONTINUE;
+
+        case PWM_STEP_SECOND:
+        default:
+            break;
+    }
+
+    if (!level) {
+        return SUBGHZ_DECODE_REJECT;
+    }
+
+    uint32_t bit;
+    if (pwm_near(pwm->first_us, params->te_short_us, params->te_delta_us) &&
+        pwm_near(duration_us, params->te_long_us, params->te_delta_us)) {
+        bit = 0;
+    } else if (pwm_near(pwm->first_us, params->te_long_us, params->te_delta_us) &&
+               pwm_near(duration_us, params->te_short_us, params->te_delta_us)) {
+        bit = 1;
+    } else {
+        return SUBGHZ_DECODE_REJECT;
+    }
+
+    /* Short + long is three base periods */
+    pwm->data = (pwm->data << 1) | bit;
+    pwm->te_sum_us += (pwm->first_us + duration_us) / 3U;
+    pwm->bits++;
+    pwm->step = PWM_STEP_FIRST;
+    return SUBGHZ_DECODE_CONTINUE;
+}
+
+static bool pwm_near(uint32_t duration_us, uint32_t nominal_us, uint32_t delta_us)
+{
+    return duration_us + delta_us >= nominal_us && duration_us <= nominal_us + delta_us;
+}
+
+static void pwm_restart(pwm_state_t *pwm, uint8_t step)
+{
+    pwm->data = 0;
+    pwm->first_us = 0;
+    pwm->te_sum_us = 0;
+    pwm->bits = 0;
+    pwm->step = step;
+}
+
+static void pwm_frame(const subghz_protocol_t *protocol, const pwm_state_t *pwm, subghz_frame_t *frame)
+{
+    uint32_t periods = (protocol->feed == pwm_start_bit_feed) ? pwm->bits + 1U : pwm->bits;
+
+    frame->protocol = protocol->name;
+    frame->data = pwm->data;
+    frame->bits = pwm->bits;
+    frame->repeat = 0;
+    frame->te_us = (uint16_t)(pwm->te_sum_us / periods);
+}